@@ -0,0 +1,307 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the audio DSP kernels of framework/hal/output/hal_audio_dsp.c.
+ *
+ * The portable versions of the kernels are checked against a 64-bit reference: every 16-bit input at the speaker
+ * volume levels, the gain ramp, the word and half word paths, the stereo expansion and the saturation of the mixer.
+ * The volume sweep also compares with the float path the MQS streamer used before the Q15 kernels.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Iframework/hal/output bootloader/unit_tests/audio_dsp_test/audio_dsp_test.c \
+ *       framework/hal/output/hal_audio_dsp.c -lm -o audio_dsp_test
+ *   ./audio_dsp_test
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_audio_dsp.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_SAMPLES     65536
+#define TEST_RAMP        480
+#define TEST_MIX_STREAMS 4
+#define TEST_MIX_SAMPLES 1001
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+/* one more sample so the buffers can be used at an odd half word */
+static int16_t s_Src[TEST_SAMPLES + 2] __attribute__((aligned(4)));
+static int16_t s_Dst[TEST_SAMPLES + 2] __attribute__((aligned(4)));
+static int16_t s_Stereo[2 * TEST_SAMPLES] __attribute__((aligned(4)));
+static int16_t s_Streams[TEST_MIX_STREAMS][TEST_MIX_SAMPLES + 1] __attribute__((aligned(4)));
+static int16_t s_Mix[TEST_MIX_SAMPLES + 1] __attribute__((aligned(4)));
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static int16_t _Test_Sat16(int64_t x)
+{
+    return (int16_t)(x > 32767 ? 32767 : (x < -32768 ? -32768 : x));
+}
+
+/* Q15 product rounded to nearest, as the kernels do */
+static int16_t _Test_Q15(int64_t product)
+{
+    return _Test_Sat16((product + (1 << 14)) >> 15);
+}
+
+/* volume curve of the MQS streamer, volume 0 ~ 100 in multiples of 10 */
+static float _Test_AdaptVolume(uint32_t volume)
+{
+    volume /= 10;
+    return (-0.0018 * pow(volume, 3) + 0.028 * pow(volume, 2));
+}
+
+static void _Test_FillAllInputs(int16_t *pSrc)
+{
+    for (int i = 0; i < TEST_SAMPLES; i++)
+    {
+        pSrc[i] = (int16_t)(i - 32768);
+    }
+}
+
+static void _Test_Gain(void)
+{
+    static const int16_t gains[] = {0, 1, 16384, 23170, AUDIO_DSP_GAIN_UNITY, -1, -16384, -32768};
+    audio_dsp_gain_t gain;
+
+    for (unsigned g = 0; g < sizeof(gains) / sizeof(gains[0]); g++)
+    {
+        /* word path, then half word path on the odd sample */
+        for (int offset = 0; offset < 2; offset++)
+        {
+            _Test_FillAllInputs(&s_Src[offset]);
+            HAL_AudioDsp_GainInit(&gain, gains[g], 0);
+            HAL_AudioDsp_ApplyGain(&gain, &s_Src[offset], &s_Dst[offset], TEST_SAMPLES);
+
+            for (int i = 0; i < TEST_SAMPLES; i++)
+            {
+                int16_t expected = _Test_Q15((int64_t)s_Src[offset + i] * gains[g]);
+                if (s_Dst[offset + i] != expected)
+                {
+                    TEST_CHECK(false, "gain %d offset %d: %d gives %d, expected %d", gains[g], offset,
+                               s_Src[offset + i], s_Dst[offset + i], expected);
+                    break;
+                }
+            }
+        }
+    }
+
+    /* in place */
+    _Test_FillAllInputs(s_Src);
+    HAL_AudioDsp_GainInit(&gain, 16384, 0);
+    HAL_AudioDsp_ApplyGain(&gain, s_Src, s_Src, TEST_SAMPLES);
+    TEST_CHECK((s_Src[0] == -16384) && (s_Src[TEST_SAMPLES - 1] == 16384), "in place gain");
+}
+
+static void _Test_Volume(void)
+{
+    audio_dsp_gain_t gain;
+    int maxDiff = 0;
+
+    _Test_FillAllInputs(s_Src);
+    for (uint32_t volume = 0; volume <= 100; volume += 10)
+    {
+        float adapted = _Test_AdaptVolume(volume);
+
+        HAL_AudioDsp_GainInit(&gain, (int16_t)(adapted * AUDIO_DSP_GAIN_UNITY + 0.5f), 0);
+        HAL_AudioDsp_ApplyGain(&gain, s_Src, s_Dst, TEST_SAMPLES);
+
+        for (int i = 0; i < TEST_SAMPLES; i++)
+        {
+            int16_t old = (int16_t)(s_Src[i] * adapted);
+            int diff    = abs(s_Dst[i] - old);
+            if (diff > maxDiff)
+            {
+                maxDiff = diff;
+            }
+        }
+    }
+
+    printf("volume sweep: max difference with the float path %d LSB\n", maxDiff);
+    TEST_CHECK(maxDiff <= 1, "volume sweep differs by %d LSB from the float path", maxDiff);
+}
+
+static void _Test_Ramp(void)
+{
+    audio_dsp_gain_t gain;
+
+    for (int i = 0; i < TEST_SAMPLES; i++)
+    {
+        s_Src[i] = 32767;
+    }
+
+    /* up ramp, applied in odd sized chunks so the ramp ends inside a chunk */
+    HAL_AudioDsp_GainInit(&gain, 0, TEST_RAMP);
+    HAL_AudioDsp_GainSetTarget(&gain, AUDIO_DSP_GAIN_UNITY);
+    for (int done = 0; done < 2 * TEST_RAMP; done += 37)
+    {
+        HAL_AudioDsp_ApplyGain(&gain, &s_Src[done], &s_Dst[done], 37);
+    }
+
+    for (int i = 1; i < 2 * TEST_RAMP; i++)
+    {
+        if (s_Dst[i] < s_Dst[i - 1])
+        {
+            TEST_CHECK(false, "up ramp decreases at %d: %d after %d", i, s_Dst[i], s_Dst[i - 1]);
+            break;
+        }
+    }
+
+    TEST_CHECK(gain.rampLeft == 0, "up ramp not over after %d samples", 2 * TEST_RAMP);
+    TEST_CHECK(s_Dst[TEST_RAMP - 1] == 32766, "up ramp ends at %d", s_Dst[TEST_RAMP - 1]);
+    TEST_CHECK(s_Dst[TEST_RAMP / 2] > 16000 && s_Dst[TEST_RAMP / 2] < 16800, "up ramp is not linear: %d at half",
+               s_Dst[TEST_RAMP / 2]);
+
+    /* down ramp from the middle of the up ramp */
+    HAL_AudioDsp_GainSetTarget(&gain, 0);
+    HAL_AudioDsp_ApplyGain(&gain, s_Src, s_Dst, TEST_RAMP / 2);
+    HAL_AudioDsp_GainSetTarget(&gain, AUDIO_DSP_GAIN_UNITY);
+    HAL_AudioDsp_GainSetTarget(&gain, 0);
+    HAL_AudioDsp_ApplyGain(&gain, s_Src, s_Dst, TEST_RAMP + 1);
+    TEST_CHECK(s_Dst[TEST_RAMP] == 0, "down ramp ends at %d", s_Dst[TEST_RAMP]);
+
+    /* no ramp */
+    HAL_AudioDsp_GainInit(&gain, AUDIO_DSP_GAIN_UNITY, 0);
+    HAL_AudioDsp_GainSetTarget(&gain, 0);
+    HAL_AudioDsp_ApplyGain(&gain, s_Src, s_Dst, 1);
+    TEST_CHECK(s_Dst[0] == 0, "gain without ramp not applied immediately");
+}
+
+static void _Test_MonoToStereo(void)
+{
+    _Test_FillAllInputs(s_Src);
+
+    HAL_AudioDsp_MonoToStereo(s_Src, s_Stereo, TEST_SAMPLES, true);
+    for (int i = 0; i < TEST_SAMPLES; i++)
+    {
+        if ((s_Stereo[2 * i] != s_Src[i]) || (s_Stereo[2 * i + 1] != _Test_Sat16(-(int32_t)s_Src[i])))
+        {
+            TEST_CHECK(false, "differential stereo of %d gives %d %d", s_Src[i], s_Stereo[2 * i], s_Stereo[2 * i + 1]);
+            break;
+        }
+    }
+
+    HAL_AudioDsp_MonoToStereo(s_Src, s_Stereo, TEST_SAMPLES, false);
+    for (int i = 0; i < TEST_SAMPLES; i++)
+    {
+        if ((s_Stereo[2 * i] != s_Src[i]) || (s_Stereo[2 * i + 1] != s_Src[i]))
+        {
+            TEST_CHECK(false, "stereo of %d gives %d %d", s_Src[i], s_Stereo[2 * i], s_Stereo[2 * i + 1]);
+            break;
+        }
+    }
+}
+
+static void _Test_MixCompare(const int16_t *const *pSrcs, const int16_t *gains, uint32_t streamCount, int offset,
+                             const char *what)
+{
+    HAL_AudioDsp_Mix(pSrcs, gains, streamCount, &s_Mix[offset], TEST_MIX_SAMPLES);
+
+    for (int i = 0; i < TEST_MIX_SAMPLES; i++)
+    {
+        int64_t acc = 0;
+
+        for (uint32_t stream = 0; stream < streamCount; stream++)
+        {
+            if (pSrcs[stream] != NULL)
+            {
+                acc += (int64_t)pSrcs[stream][i] * gains[stream];
+            }
+        }
+
+        if (s_Mix[offset + i] != _Test_Q15(acc))
+        {
+            TEST_CHECK(false, "%s: sample %d gives %d, expected %d", what, i, s_Mix[offset + i], _Test_Q15(acc));
+            break;
+        }
+    }
+}
+
+static void _Test_Mix(void)
+{
+    static const int16_t unity[TEST_MIX_STREAMS] = {AUDIO_DSP_GAIN_UNITY, AUDIO_DSP_GAIN_UNITY, AUDIO_DSP_GAIN_UNITY,
+                                                    AUDIO_DSP_GAIN_UNITY};
+    static const int16_t gains[TEST_MIX_STREAMS] = {AUDIO_DSP_GAIN_UNITY, 9830, -20000, 32767};
+    const int16_t *srcs[TEST_MIX_STREAMS];
+
+    /* three full scale streams saturate instead of wrapping */
+    for (int stream = 0; stream < 3; stream++)
+    {
+        for (int i = 0; i < TEST_MIX_SAMPLES; i++)
+        {
+            s_Streams[stream][i] = (i & 1) ? -32768 : 32767;
+        }
+        srcs[stream] = s_Streams[stream];
+    }
+
+    HAL_AudioDsp_Mix(srcs, unity, 3, s_Mix, TEST_MIX_SAMPLES);
+    TEST_CHECK((s_Mix[0] == 32767) && (s_Mix[1] == -32768) && (s_Mix[TEST_MIX_SAMPLES - 1] == 32767),
+               "full scale mix gives %d %d", s_Mix[0], s_Mix[1]);
+
+    /* random streams on the word path, the half word path and with a stream missing */
+    srand(1);
+    for (int stream = 0; stream < TEST_MIX_STREAMS; stream++)
+    {
+        for (int i = 0; i < TEST_MIX_SAMPLES + 1; i++)
+        {
+            s_Streams[stream][i] = (int16_t)(rand() & 0xFFFF);
+        }
+        srcs[stream] = s_Streams[stream];
+    }
+
+    _Test_MixCompare(srcs, gains, TEST_MIX_STREAMS, 0, "aligned mix");
+    _Test_MixCompare(srcs, gains, TEST_MIX_STREAMS, 1, "unaligned output mix");
+
+    srcs[1] = &s_Streams[1][1];
+    _Test_MixCompare(srcs, gains, TEST_MIX_STREAMS, 0, "unaligned input mix");
+
+    srcs[1] = NULL;
+    _Test_MixCompare(srcs, gains, TEST_MIX_STREAMS, 0, "mix with a stream missing");
+}
+
+int main(void)
+{
+    _Test_Gain();
+    _Test_Volume();
+    _Test_Ramp();
+    _Test_MonoToStereo();
+    _Test_Mix();
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the AFE to ASR frame ring of framework/hal/voice/hal_audio_frame_ring.c.
+ *
+ * The first part drives the producer and the consumer from one thread and checks the ring state after each call:
+ * acquire before publish, cancel, overrun when the consumer is a full ring behind, frames kept with retain. The second
+ * part runs them on two threads, as the AFE and ASR tasks do, and checks that every published frame reaches the
+ * consumer once, in order and intact.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -pthread -Ibootloader/unit_tests/host_stubs -Iframework/hal/voice \
+ *       bootloader/unit_tests/audio_frame_ring_test/audio_frame_ring_test.c \
+ *       framework/hal/voice/hal_audio_frame_ring.c -o audio_frame_ring_test
+ *   ./audio_frame_ring_test
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_audio_frame_ring.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_DEPTH        4
+#define TEST_FRAME_SIZE   960
+#define TEST_STRESS_COUNT 1000000U
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+static uint8_t s_Pool[TEST_DEPTH][TEST_FRAME_SIZE];
+static volatile uint8_t s_RefCount[TEST_DEPTH];
+static uint32_t s_DataSize[TEST_DEPTH];
+
+static audio_frame_ring_t s_Ring;
+static volatile bool s_ProducerDone;
+static uint32_t s_ProducerOverruns;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static void _Test_Fill(uint8_t *frame, uint32_t seq)
+{
+    for (uint32_t i = 0; i < TEST_FRAME_SIZE; i += 4)
+    {
+        uint32_t word = seq * 2654435761U + i;
+        memcpy(&frame[i], &word, sizeof(word));
+    }
+}
+
+static bool _Test_Verify(const uint8_t *frame, uint32_t seq)
+{
+    for (uint32_t i = 0; i < TEST_FRAME_SIZE; i += 4)
+    {
+        uint32_t word;
+        memcpy(&word, &frame[i], sizeof(word));
+        if (word != seq * 2654435761U + i)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void _Test_Sequential(void)
+{
+    audio_frame_ring_stats_t stats;
+    uint8_t *frames[TEST_DEPTH];
+    uint8_t *frame;
+    uint8_t *kept;
+    uint32_t size;
+
+    TEST_CHECK(HAL_AudioFrameRing_Acquire(&s_Ring) == NULL, "acquire before init");
+    TEST_CHECK(!HAL_AudioFrameRing_Owns(&s_Ring, s_Pool[0]), "owns before init");
+
+    HAL_AudioFrameRing_Init(&s_Ring, &s_Pool[0][0], TEST_FRAME_SIZE, TEST_DEPTH, s_RefCount, s_DataSize);
+    TEST_CHECK(HAL_AudioFrameRing_Get(&s_Ring, &size) == NULL, "get on an empty ring");
+
+    /* the same frame until it is published, a cancelled frame is given again */
+    frame = HAL_AudioFrameRing_Acquire(&s_Ring);
+    TEST_CHECK(frame == s_Pool[0], "first frame is not the first of the pool");
+    TEST_CHECK(HAL_AudioFrameRing_Acquire(&s_Ring) == frame, "second acquire gives another frame");
+    HAL_AudioFrameRing_Cancel(&s_Ring);
+    TEST_CHECK(s_RefCount[0] == 0, "cancel keeps the reference");
+    TEST_CHECK(HAL_AudioFrameRing_Acquire(&s_Ring) == frame, "acquire after cancel gives another frame");
+    HAL_AudioFrameRing_Cancel(&s_Ring);
+    HAL_AudioFrameRing_Publish(&s_Ring, 1);
+    TEST_CHECK(HAL_AudioFrameRing_Get(&s_Ring, &size) == NULL, "publish without acquire");
+
+    /* fill the ring, the next acquire overruns */
+    for (uint32_t i = 0; i < TEST_DEPTH; i++)
+    {
+        frames[i] = HAL_AudioFrameRing_Acquire(&s_Ring);
+        TEST_CHECK(frames[i] == s_Pool[i], "frame %u is not frame %u of the pool", i, i);
+        if (frames[i] != NULL)
+        {
+            _Test_Fill(frames[i], i);
+        }
+        HAL_AudioFrameRing_Publish(&s_Ring, 100 + i);
+    }
+
+    TEST_CHECK(HAL_AudioFrameRing_Acquire(&s_Ring) == NULL, "acquire on a full ring");
+    HAL_AudioFrameRing_GetStats(&s_Ring, &stats);
+    TEST_CHECK((stats.published == TEST_DEPTH) && (stats.overruns == 1) && (stats.maxPending == TEST_DEPTH),
+               "full ring stats published %u overruns %u max pending %u", stats.published, stats.overruns,
+               stats.maxPending);
+
+    /* the frames come in order with their size, the first one is kept after its release */
+    kept = HAL_AudioFrameRing_Get(&s_Ring, &size);
+    TEST_CHECK((kept == frames[0]) && (size == 100), "first frame %p size %u", (void *)kept, size);
+    HAL_AudioFrameRing_Retain(&s_Ring, kept);
+    HAL_AudioFrameRing_Release(&s_Ring, kept);
+    TEST_CHECK(HAL_AudioFrameRing_Acquire(&s_Ring) == NULL, "acquire of a retained frame");
+
+    for (uint32_t i = 1; i < TEST_DEPTH; i++)
+    {
+        frame = HAL_AudioFrameRing_Get(&s_Ring, &size);
+        TEST_CHECK((frame == frames[i]) && (size == 100 + i), "frame %u out of order", i);
+        TEST_CHECK((frame != NULL) && _Test_Verify(frame, i), "frame %u corrupted", i);
+        HAL_AudioFrameRing_Release(&s_Ring, frame);
+    }
+    TEST_CHECK(HAL_AudioFrameRing_Get(&s_Ring, &size) == NULL, "get on a drained ring");
+
+    /* the retained frame is reused once released again */
+    HAL_AudioFrameRing_Release(&s_Ring, kept);
+    TEST_CHECK(HAL_AudioFrameRing_Acquire(&s_Ring) == frames[0], "released frame is not reused");
+    HAL_AudioFrameRing_Cancel(&s_Ring);
+
+    /* foreign buffers are ignored */
+    TEST_CHECK(HAL_AudioFrameRing_Owns(&s_Ring, &s_Pool[TEST_DEPTH - 1][TEST_FRAME_SIZE - 1]), "last byte not owned");
+    TEST_CHECK(!HAL_AudioFrameRing_Owns(&s_Ring, &s_Pool[0][0] + sizeof(s_Pool)), "byte after the pool owned");
+    HAL_AudioFrameRing_Release(&s_Ring, (const uint8_t *)&s_Ring);
+    HAL_AudioFrameRing_Release(&s_Ring, frames[1]);
+
+    HAL_AudioFrameRing_GetStats(&s_Ring, &stats);
+    TEST_CHECK(stats.released == TEST_DEPTH, "released %u frames, expected %u", stats.released, TEST_DEPTH);
+}
+
+static void *_Test_Producer(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t seq = 0; seq < TEST_STRESS_COUNT; seq++)
+    {
+        uint8_t *frame;
+
+        /* the AFE drops the frame on an overrun, here it waits so every sequence number is checked */
+        while ((frame = HAL_AudioFrameRing_Acquire(&s_Ring)) == NULL)
+        {
+            s_ProducerOverruns++;
+            sched_yield();
+        }
+
+        if ((seq % 7) == 3)
+        {
+            /* a frame dropped after it was filled must not reach the consumer */
+            _Test_Fill(frame, ~seq);
+            HAL_AudioFrameRing_Cancel(&s_Ring);
+            frame = HAL_AudioFrameRing_Acquire(&s_Ring);
+        }
+        _Test_Fill(frame, seq);
+        HAL_AudioFrameRing_Publish(&s_Ring, seq);
+    }
+
+    s_ProducerDone = true;
+
+    return NULL;
+}
+
+static void _Test_Threads(void)
+{
+    audio_frame_ring_stats_t stats;
+    pthread_t producer;
+    uint8_t *kept = NULL;
+    uint32_t expected = 0;
+    uint32_t keptSeq  = 0;
+
+    HAL_AudioFrameRing_Init(&s_Ring, &s_Pool[0][0], TEST_FRAME_SIZE, TEST_DEPTH, s_RefCount, s_DataSize);
+    s_ProducerDone = false;
+    pthread_create(&producer, NULL, _Test_Producer, NULL);
+
+    while (expected < TEST_STRESS_COUNT)
+    {
+        uint32_t seq;
+        uint8_t *frame = HAL_AudioFrameRing_Get(&s_Ring, &seq);
+
+        if (frame == NULL)
+        {
+            if (s_ProducerDone && (HAL_AudioFrameRing_Get(&s_Ring, &seq) == NULL))
+            {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        if ((seq != expected) || !_Test_Verify(frame, seq))
+        {
+            TEST_CHECK(false, "frame %u received as %u or corrupted", expected, seq);
+            break;
+        }
+
+        /* keep one frame of every hundred while the next ones are processed, the producer waits on it when it wraps */
+        if ((kept == NULL) && ((seq % 100) == 0))
+        {
+            HAL_AudioFrameRing_Retain(&s_Ring, frame);
+            kept    = frame;
+            keptSeq = seq;
+        }
+        else if ((kept != NULL) && (seq == keptSeq + TEST_DEPTH - 2))
+        {
+            if (!_Test_Verify(kept, keptSeq))
+            {
+                TEST_CHECK(false, "retained frame %u overwritten", keptSeq);
+            }
+            HAL_AudioFrameRing_Release(&s_Ring, kept);
+            kept = NULL;
+        }
+
+        HAL_AudioFrameRing_Release(&s_Ring, frame);
+        expected++;
+    }
+
+    pthread_join(producer, NULL);
+
+    HAL_AudioFrameRing_GetStats(&s_Ring, &stats);
+    printf("threads: %u frames, %u overruns, %u max pending\n", expected, stats.overruns, stats.maxPending);
+    TEST_CHECK(expected == TEST_STRESS_COUNT, "%u frames received, expected %u", expected, TEST_STRESS_COUNT);
+    TEST_CHECK(stats.published == TEST_STRESS_COUNT, "%u frames published", stats.published);
+    TEST_CHECK(stats.overruns == s_ProducerOverruns, "%u overruns counted, producer saw %u", stats.overruns,
+               s_ProducerOverruns);
+    TEST_CHECK(stats.maxPending <= TEST_DEPTH, "%u frames pending", stats.maxPending);
+}
+
+int main(void)
+{
+    _Test_Sequential();
+    _Test_Threads();
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the audio prompt cache of framework/hal/output/hal_audio_prompt_cache.c.
+ *
+ * The first part checks the cache step by step: disabled cache, hits and misses, eviction of the least recently used
+ * prompt, prompts kept while they play, oversized prompts and the entry limit. The second part plays random prompts of
+ * random sizes, some of them held by up to three voices, and checks after each call that the cached ranges are aligned,
+ * inside the pool and do not overlap, that no cached or playing PCM is overwritten and that a prompt is only rejected
+ * when the playing ones leave no free range large enough for it.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Ibootloader/unit_tests/host_stubs -Iframework/hal/output \
+ *       bootloader/unit_tests/audio_prompt_cache_test/audio_prompt_cache_test.c \
+ *       framework/hal/output/hal_audio_prompt_cache.c -o audio_prompt_cache_test
+ *   ./audio_prompt_cache_test
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_audio_prompt_cache.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_POOL_SIZE       4096
+#define TEST_PROMPT_COUNT    24
+#define TEST_LANGUAGE_COUNT  2
+#define TEST_MAX_PROMPT_SIZE 1500
+#define TEST_VOICES          3
+#define TEST_STRESS_COUNT    200000
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+typedef struct _test_voice
+{
+    const uint8_t *pcm;
+    int32_t promptId;
+    uint32_t language;
+    uint32_t len;
+} test_voice_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+static uint32_t s_Pool[TEST_POOL_SIZE / sizeof(uint32_t)];
+static audio_prompt_cache_t s_Cache;
+
+/* decoder output, up to the prompt larger than the pool */
+static uint8_t s_Pcm[TEST_POOL_SIZE + 1];
+static uint32_t s_PromptSize[TEST_PROMPT_COUNT][TEST_LANGUAGE_COUNT];
+static test_voice_t s_Voices[TEST_VOICES];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint8_t _Test_Sample(int32_t promptId, uint32_t language, uint32_t i)
+{
+    return (uint8_t)(promptId * 31 + language * 97 + i * 7 + (i >> 8));
+}
+
+/* decoded PCM of a prompt, in s_Pcm */
+static const uint8_t *_Test_Decode(int32_t promptId, uint32_t language, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        s_Pcm[i] = _Test_Sample(promptId, language, i);
+    }
+
+    return s_Pcm;
+}
+
+static bool _Test_Verify(const uint8_t *pcm, int32_t promptId, uint32_t language, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (pcm[i] != _Test_Sample(promptId, language, i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static const uint8_t *_Test_Put(int32_t promptId, uint32_t language, uint32_t len, bool use)
+{
+    return HAL_AudioPromptCache_Put(&s_Cache, promptId, language, _Test_Decode(promptId, language, len), len, use);
+}
+
+static uint32_t _Test_Footprint(uint32_t len)
+{
+    return (len + AUDIO_PROMPT_CACHE_ALIGN - 1) / AUDIO_PROMPT_CACHE_ALIGN * AUDIO_PROMPT_CACHE_ALIGN;
+}
+
+static void _Test_Steps(void)
+{
+    audio_prompt_cache_stats_t stats;
+    const uint8_t *pcmA;
+    const uint8_t *pcmC;
+    const uint8_t *pcm;
+    uint32_t len = 0;
+
+    /* a cache without a pool caches nothing */
+    HAL_AudioPromptCache_Init(&s_Cache, NULL, sizeof(s_Pool));
+    TEST_CHECK(_Test_Put(1, 0, 100, true) == NULL, "put in a disabled cache");
+    TEST_CHECK(HAL_AudioPromptCache_Get(&s_Cache, 1, 0, &len) == NULL, "hit in a disabled cache");
+
+    /* a hit gives the PCM which was put, a prompt is cached per language */
+    HAL_AudioPromptCache_Init(&s_Cache, (uint8_t *)s_Pool, 1000);
+    TEST_CHECK(HAL_AudioPromptCache_Get(&s_Cache, 1, 0, &len) == NULL, "hit in an empty cache");
+    pcmA = _Test_Put(1, 0, 301, false);
+    TEST_CHECK(pcmA == (uint8_t *)s_Pool, "first prompt not at the start of the pool");
+    pcm = HAL_AudioPromptCache_Get(&s_Cache, 1, 0, &len);
+    TEST_CHECK((pcm == pcmA) && (len == 301) && _Test_Verify(pcm, 1, 0, 301), "hit on the first prompt");
+    HAL_AudioPromptCache_Release(&s_Cache, pcm);
+    TEST_CHECK(HAL_AudioPromptCache_Get(&s_Cache, 1, 1, &len) == NULL, "hit on another language");
+    TEST_CHECK(!HAL_AudioPromptCache_Contains(&s_Cache, 1, 1), "another language cached");
+
+    /* the least recently used prompt is evicted, here the second one as the first one was played since */
+    TEST_CHECK(_Test_Put(2, 0, 300, false) == pcmA + _Test_Footprint(301), "second prompt not aligned after the first");
+    pcmC = _Test_Put(3, 0, 300, false);
+    TEST_CHECK(pcmC != NULL, "third prompt not cached");
+    HAL_AudioPromptCache_Release(&s_Cache, HAL_AudioPromptCache_Get(&s_Cache, 1, 0, &len));
+    TEST_CHECK(_Test_Put(4, 0, 300, false) != NULL, "fourth prompt not cached");
+    TEST_CHECK(HAL_AudioPromptCache_Contains(&s_Cache, 1, 0) && !HAL_AudioPromptCache_Contains(&s_Cache, 2, 0) &&
+                   HAL_AudioPromptCache_Contains(&s_Cache, 3, 0) && HAL_AudioPromptCache_Contains(&s_Cache, 4, 0),
+               "least recently used prompt not evicted");
+
+    /* the playing prompts are kept, a prompt needing their room is rejected without evicting anything */
+    pcmA = HAL_AudioPromptCache_Get(&s_Cache, 1, 0, &len);
+    pcmC = HAL_AudioPromptCache_Get(&s_Cache, 3, 0, &len);
+    TEST_CHECK(_Test_Put(5, 0, 500, false) == NULL, "prompt cached over the playing ones");
+    TEST_CHECK(HAL_AudioPromptCache_Contains(&s_Cache, 4, 0), "prompt evicted for a rejected one");
+    pcm = _Test_Put(5, 0, 297, true);
+    TEST_CHECK((pcm != NULL) && !HAL_AudioPromptCache_Contains(&s_Cache, 4, 0), "prompt 4 not evicted for prompt 5");
+    TEST_CHECK(_Test_Verify(pcmA, 1, 0, 301) && _Test_Verify(pcmC, 3, 0, 300), "playing prompt overwritten");
+    HAL_AudioPromptCache_Release(&s_Cache, pcmA);
+    HAL_AudioPromptCache_Release(&s_Cache, pcmC);
+    HAL_AudioPromptCache_Release(&s_Cache, pcm);
+
+    /* a prompt larger than the pool is rejected */
+    TEST_CHECK(_Test_Put(6, 0, 1001, false) == NULL, "prompt larger than the pool cached");
+    TEST_CHECK(_Test_Put(6, 0, 1000, false) == (uint8_t *)s_Pool, "prompt of the pool size not cached");
+
+    HAL_AudioPromptCache_GetStats(&s_Cache, &stats);
+    TEST_CHECK((stats.hits == 4) && (stats.misses == 2) && (stats.rejected == 2) && (stats.usedBytes == 1000),
+               "stats hits %u misses %u rejected %u used %u", stats.hits, stats.misses, stats.rejected,
+               stats.usedBytes);
+
+    /* the oldest of the small prompts is evicted once all the entries are used */
+    HAL_AudioPromptCache_Init(&s_Cache, (uint8_t *)s_Pool, sizeof(s_Pool));
+    for (int32_t id = 0; id <= AUDIO_PROMPT_CACHE_MAX_ENTRIES; id++)
+    {
+        TEST_CHECK(_Test_Put(id, 0, 10, false) != NULL, "small prompt %d not cached", id);
+    }
+    TEST_CHECK(!HAL_AudioPromptCache_Contains(&s_Cache, 0, 0) && HAL_AudioPromptCache_Contains(&s_Cache, 1, 0),
+               "oldest prompt not evicted for a free entry");
+}
+
+/* free range of len bytes in the pool once all the prompts which are not playing are evicted */
+static bool _Test_Room(uint32_t len)
+{
+    uint32_t start = 0;
+    bool moved     = true;
+
+    len = _Test_Footprint(len);
+    while (moved && (start + len <= sizeof(s_Pool)))
+    {
+        moved = false;
+        for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+        {
+            const audio_prompt_cache_entry_t *entry = &s_Cache.entries[i];
+            uint32_t slot                           = entry->slot - (uint8_t *)s_Pool;
+
+            if ((entry->len != 0) && (entry->users != 0) && (slot < start + len) &&
+                (slot + _Test_Footprint(entry->len) > start))
+            {
+                start = slot + _Test_Footprint(entry->len);
+                moved = true;
+            }
+        }
+    }
+
+    return start + len <= sizeof(s_Pool);
+}
+
+static bool _Test_Consistent(void)
+{
+    audio_prompt_cache_stats_t stats;
+    uint32_t used = 0;
+
+    for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+    {
+        const audio_prompt_cache_entry_t *entry = &s_Cache.entries[i];
+        uint32_t slot                           = entry->slot - (uint8_t *)s_Pool;
+
+        if (entry->len == 0)
+        {
+            continue;
+        }
+        used += entry->len;
+
+        if ((entry->pcm != entry->slot) || ((slot % AUDIO_PROMPT_CACHE_ALIGN) != 0) ||
+            (slot + entry->len > sizeof(s_Pool)) ||
+            !_Test_Verify(entry->pcm, entry->promptId, entry->language, entry->len))
+        {
+            TEST_CHECK(false, "prompt %d language %u at %u size %u corrupted", entry->promptId, entry->language, slot,
+                       entry->len);
+            return false;
+        }
+
+        for (uint32_t j = 0; j < i; j++)
+        {
+            const audio_prompt_cache_entry_t *other = &s_Cache.entries[j];
+
+            if ((other->len != 0) && (other->slot < entry->slot + entry->len) &&
+                (entry->slot < other->slot + other->len))
+            {
+                TEST_CHECK(false, "prompts %d and %d overlap", entry->promptId, other->promptId);
+                return false;
+            }
+        }
+    }
+
+    for (uint32_t v = 0; v < TEST_VOICES; v++)
+    {
+        const test_voice_t *voice = &s_Voices[v];
+
+        if ((voice->pcm != NULL) && !_Test_Verify(voice->pcm, voice->promptId, voice->language, voice->len))
+        {
+            TEST_CHECK(false, "prompt %d overwritten while playing", voice->promptId);
+            return false;
+        }
+    }
+
+    HAL_AudioPromptCache_GetStats(&s_Cache, &stats);
+    TEST_CHECK(stats.usedBytes == used, "%u bytes used, %u counted", used, stats.usedBytes);
+
+    return stats.usedBytes == used;
+}
+
+static void _Test_Stress(void)
+{
+    audio_prompt_cache_stats_t stats;
+
+    srand(1);
+    for (uint32_t id = 0; id < TEST_PROMPT_COUNT; id++)
+    {
+        for (uint32_t language = 0; language < TEST_LANGUAGE_COUNT; language++)
+        {
+            /* mostly short prompts, a few ones larger than a third of the pool, odd sizes */
+            s_PromptSize[id][language] = 1 + (uint32_t)rand() % (((id % 5) == 0) ? TEST_MAX_PROMPT_SIZE : 500);
+        }
+    }
+    s_PromptSize[0][0] = TEST_POOL_SIZE + 1;
+
+    HAL_AudioPromptCache_Init(&s_Cache, (uint8_t *)s_Pool, sizeof(s_Pool));
+    memset(s_Voices, 0, sizeof(s_Voices));
+
+    for (uint32_t n = 0; n < TEST_STRESS_COUNT; n++)
+    {
+        test_voice_t *voice = &s_Voices[(uint32_t)rand() % TEST_VOICES];
+        int32_t promptId    = (int32_t)((uint32_t)rand() % TEST_PROMPT_COUNT);
+        uint32_t language   = (uint32_t)rand() % TEST_LANGUAGE_COUNT;
+        uint32_t size       = s_PromptSize[promptId][language];
+        const uint8_t *pcm;
+        uint32_t len = 0;
+
+        /* the voice stops its prompt, then plays one from the cache or decodes it */
+        if (voice->pcm != NULL)
+        {
+            HAL_AudioPromptCache_Release(&s_Cache, voice->pcm);
+            voice->pcm = NULL;
+        }
+
+        pcm = HAL_AudioPromptCache_Get(&s_Cache, promptId, language, &len);
+        if (pcm == NULL)
+        {
+            bool room = (size <= sizeof(s_Pool)) && _Test_Room(size);
+
+            pcm = _Test_Put(promptId, language, size, true);
+            len = size;
+            TEST_CHECK((pcm != NULL) == room, "prompt %d language %u size %u %s", promptId, language, size,
+                       room ? "rejected" : "cached without room");
+        }
+        else
+        {
+            TEST_CHECK(len == size, "prompt %d language %u cached with size %u", promptId, language, len);
+        }
+
+        if (pcm != NULL)
+        {
+            voice->pcm      = pcm;
+            voice->promptId = promptId;
+            voice->language = language;
+            voice->len      = len;
+        }
+
+        if (!_Test_Consistent())
+        {
+            break;
+        }
+    }
+
+    for (uint32_t v = 0; v < TEST_VOICES; v++)
+    {
+        HAL_AudioPromptCache_Release(&s_Cache, s_Voices[v].pcm);
+    }
+
+    HAL_AudioPromptCache_GetStats(&s_Cache, &stats);
+    printf("stress: %u hits, %u misses, %u evictions, %u rejected, %u bytes used\n", stats.hits, stats.misses,
+           stats.evictions, stats.rejected, stats.usedBytes);
+    for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+    {
+        TEST_CHECK(s_Cache.entries[i].users == 0, "prompt %d still used", s_Cache.entries[i].promptId);
+    }
+}
+
+int main(void)
+{
+    _Test_Steps();
+    _Test_Stress();
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
@@ -0,0 +1,424 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the CRC32 of framework/hal/misc/hal_crc32.c and of the BLE wireless UART framer of
+ * framework/hal/input/hal_ble_wuart_framer.c.
+ *
+ * The CRC32 is compared with a bitwise CRC-32 (IEEE 802.3), in one go and in parts. The framer is fed with a stream of
+ * packets damaged as the LPUART link damages them: bytes lost or corrupted in the headers and the payloads, noise and
+ * fake magics between the packets, headers announcing a payload larger than the buffers. The stream is cut in random
+ * chunks. Every intact packet must be handed over once, in order and with its payload, the damaged ones never, and all
+ * the payload buffers must be free at the end.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Ibootloader/unit_tests/host_stubs -Iframework/hal -Iframework/hal/input \
+ *       bootloader/unit_tests/ble_wuart_framer_test/ble_wuart_framer_test.c \
+ *       framework/hal/input/hal_ble_wuart_framer.c framework/hal/misc/hal_crc32.c -o ble_wuart_framer_test
+ *   ./ble_wuart_framer_test
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_ble_wuart_framer.h"
+#include "hal_crc32.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* same sizes as the QN9090 driver */
+#define TEST_PACKET_MAX_SIZE 2048
+#define TEST_POOL_CNT        2
+
+#define TEST_PACKETS       20000
+#define TEST_STREAM_SIZE   (TEST_PACKETS * (BLE_WUART_HEADER_LENGTH + 600) + (1 << 20))
+#define TEST_DAMAGE_PERIOD 10
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+typedef enum _test_damage
+{
+    kTestDamage_None,
+    kTestDamage_PayloadByteLost,
+    kTestDamage_PayloadByteCorrupted,
+    kTestDamage_HeaderByteLost,
+    kTestDamage_HeaderByteCorrupted,
+    kTestDamage_Oversized,
+    kTestDamage_Dropped,
+    kTestDamage_Count,
+} test_damage_t;
+
+typedef struct _test_slot
+{
+    uint8_t refCount;
+    uint8_t data[TEST_PACKET_MAX_SIZE];
+} test_slot_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+static uint8_t *s_Stream;
+static uint32_t s_StreamLen;
+
+/* ids of the packets which must be handed over, in order */
+static uint32_t s_Expected[TEST_PACKETS];
+static uint32_t s_ExpectedCnt;
+static uint32_t s_Received;
+
+static test_slot_t s_Pool[TEST_POOL_CNT];
+/* id of the packet for which the pool is seen as exhausted */
+static uint32_t s_DenyId = UINT32_MAX;
+static bool s_Denied;
+static ble_wuart_framer_t s_Framer;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint32_t _Test_Crc32Bitwise(const uint8_t *data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320U : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+static void _Test_Crc32(void)
+{
+    static uint8_t data[4096];
+    uint32_t crc;
+
+    TEST_CHECK(HAL_Crc32_Update(0, "123456789", 9) == 0xCBF43926U, "CRC32 of the check string is %08X",
+               HAL_Crc32_Update(0, "123456789", 9));
+    TEST_CHECK(HAL_Crc32_Update(0, data, 0) == 0, "CRC32 of nothing is not 0");
+
+    srand(2);
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)rand();
+    }
+
+    for (size_t size = 0; size <= sizeof(data); size += (size < 64) ? 1 : 61)
+    {
+        uint32_t expected = _Test_Crc32Bitwise(data, size);
+
+        if (HAL_Crc32_Update(0, data, size) != expected)
+        {
+            TEST_CHECK(false, "CRC32 of %u bytes", (unsigned)size);
+            break;
+        }
+
+        /* in two parts split anywhere */
+        crc = HAL_Crc32_Update(0, data, size / 3);
+        crc = HAL_Crc32_Update(crc, &data[size / 3], size - size / 3);
+        if (crc != expected)
+        {
+            TEST_CHECK(false, "CRC32 of %u bytes in two parts", (unsigned)size);
+            break;
+        }
+    }
+}
+
+static uint32_t _Test_PayloadLen(uint32_t id)
+{
+    /* mostly short commands, some empty, some as large as a registration */
+    switch (id % 11)
+    {
+        case 0:
+            return 0;
+        case 1:
+            return TEST_PACKET_MAX_SIZE;
+        case 2:
+            return 1;
+        default:
+            return (id * 2654435761U) % 700;
+    }
+}
+
+static uint8_t _Test_PayloadByte(uint32_t id, uint32_t i)
+{
+    return (uint8_t)((id * 31 + i * 7) ^ (i >> 8));
+}
+
+static void _Test_Append(const uint8_t *data, uint32_t len)
+{
+    memcpy(&s_Stream[s_StreamLen], data, len);
+    s_StreamLen += len;
+}
+
+static void _Test_AppendNoise(void)
+{
+    /* random bytes, a part of the magic and a header with a wrong CRC */
+    static const uint8_t partialMagic[] = {0x53, 0x79, 0x53, 0x53, 0x79};
+    uint32_t header[BLE_WUART_HEADER_LENGTH / 4];
+    uint8_t noise[32];
+    uint32_t len = rand() % sizeof(noise);
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        noise[i] = (uint8_t)rand();
+    }
+    _Test_Append(noise, len);
+    _Test_Append(partialMagic, sizeof(partialMagic));
+
+    HAL_BleWuartFramer_CreateHeader((uint8_t *)header, NULL, 0, 0x11, 0xFFFF, 0);
+    ((uint8_t *)header)[20] ^= 0x01;
+    _Test_Append((const uint8_t *)header, sizeof(header));
+}
+
+static void _Test_BuildStream(void)
+{
+    static uint8_t payload[TEST_PACKET_MAX_SIZE + 1];
+    uint32_t header[BLE_WUART_HEADER_LENGTH / 4];
+    uint32_t cleanBytes = 0;
+
+    s_StreamLen   = 0;
+    s_ExpectedCnt = 0;
+
+    for (uint32_t id = 0; id < TEST_PACKETS; id++)
+    {
+        uint32_t len         = _Test_PayloadLen(id);
+        test_damage_t damage = kTestDamage_None;
+
+        /* damage one packet in TEST_DAMAGE_PERIOD, once the last damage is out of reach of a lost byte */
+        if (((rand() % TEST_DAMAGE_PERIOD) == 0) && (cleanBytes > 2 * (TEST_PACKET_MAX_SIZE + BLE_WUART_HEADER_LENGTH)))
+        {
+            damage = 1 + rand() % (kTestDamage_Count - 1);
+            if ((len == 0) && (damage <= kTestDamage_PayloadByteCorrupted))
+            {
+                damage = kTestDamage_HeaderByteCorrupted;
+            }
+        }
+
+        for (uint32_t i = 0; i < len; i++)
+        {
+            payload[i] = _Test_PayloadByte(id, i);
+        }
+
+        if (damage == kTestDamage_Oversized)
+        {
+            /* a valid header the driver can't take, the payload follows it */
+            len = TEST_PACKET_MAX_SIZE + 1;
+        }
+
+        HAL_BleWuartFramer_CreateHeader((uint8_t *)header, payload, len, (uint8_t)id, id, 0);
+
+        switch (damage)
+        {
+            case kTestDamage_PayloadByteLost:
+            {
+                uint32_t at = rand() % len;
+                memmove(&payload[at], &payload[at + 1], len - at - 1);
+                len--;
+            }
+            break;
+
+            case kTestDamage_PayloadByteCorrupted:
+                payload[rand() % len] ^= (uint8_t)(1 + rand() % 255);
+                break;
+
+            case kTestDamage_HeaderByteLost:
+            {
+                uint32_t at = rand() % BLE_WUART_HEADER_LENGTH;
+                _Test_Append((const uint8_t *)header, at);
+                _Test_Append((const uint8_t *)header + at + 1, BLE_WUART_HEADER_LENGTH - at - 1);
+            }
+            break;
+
+            case kTestDamage_HeaderByteCorrupted:
+                ((uint8_t *)header)[rand() % BLE_WUART_HEADER_LENGTH] ^= (uint8_t)(1 + rand() % 255);
+                break;
+
+            case kTestDamage_Dropped:
+                /* valid, but the framer gets no buffer for it */
+                s_DenyId = (s_DenyId == UINT32_MAX) ? id : s_DenyId;
+                break;
+
+            default:
+                break;
+        }
+
+        if (damage != kTestDamage_HeaderByteLost)
+        {
+            _Test_Append((const uint8_t *)header, BLE_WUART_HEADER_LENGTH);
+        }
+        _Test_Append(payload, len);
+
+        if ((damage == kTestDamage_None) || ((damage == kTestDamage_Dropped) && (id != s_DenyId)))
+        {
+            s_Expected[s_ExpectedCnt++] = id;
+            cleanBytes += BLE_WUART_HEADER_LENGTH + len;
+        }
+        else
+        {
+            cleanBytes = 0;
+        }
+
+        if ((rand() % 50) == 0)
+        {
+            _Test_AppendNoise();
+            cleanBytes = 0;
+        }
+    }
+}
+
+static uint8_t *_Test_Alloc(void)
+{
+    if (s_Framer.htUnit.pktId == s_DenyId)
+    {
+        s_Denied = true;
+        return NULL;
+    }
+
+    for (int i = 0; i < TEST_POOL_CNT; i++)
+    {
+        if (s_Pool[i].refCount == 0)
+        {
+            s_Pool[i].refCount = 1;
+            return s_Pool[i].data;
+        }
+    }
+
+    TEST_CHECK(false, "no free buffer for packet %u", s_Framer.htUnit.pktId);
+
+    return NULL;
+}
+
+static void _Test_Release(const uint8_t *data)
+{
+    for (int i = 0; i < TEST_POOL_CNT; i++)
+    {
+        if (data == s_Pool[i].data)
+        {
+            TEST_CHECK(s_Pool[i].refCount > 0, "buffer %d released twice", i);
+            s_Pool[i].refCount--;
+            return;
+        }
+    }
+
+    TEST_CHECK(false, "release of a foreign buffer");
+}
+
+static void _Test_Packet(uint8_t *data, hal_header_transfer_unit_t *htUnit)
+{
+    uint32_t id = htUnit->pktId;
+
+    if ((s_Received >= s_ExpectedCnt) || (id != s_Expected[s_Received]))
+    {
+        TEST_CHECK(false, "packet %u handed over, expected %u", id,
+                   (s_Received < s_ExpectedCnt) ? s_Expected[s_Received] : UINT32_MAX);
+        return;
+    }
+
+    TEST_CHECK((htUnit->pktLen == _Test_PayloadLen(id)) && (htUnit->pktType == (uint8_t)id),
+               "packet %u length %u type %u", id, htUnit->pktLen, htUnit->pktType);
+    for (uint32_t i = 0; i < htUnit->pktLen; i++)
+    {
+        if (data[i] != _Test_PayloadByte(id, i))
+        {
+            TEST_CHECK(false, "packet %u payload differs at %u", id, i);
+            break;
+        }
+    }
+
+    s_Received++;
+}
+
+static const ble_wuart_framer_ops_t s_TestOps = {
+    .alloc   = _Test_Alloc,
+    .release = _Test_Release,
+    .packet  = _Test_Packet,
+};
+
+static void _Test_Framer(unsigned seed)
+{
+    srand(seed);
+    _Test_BuildStream();
+
+    s_Received = 0;
+    s_Denied   = false;
+    HAL_BleWuartFramer_Init(&s_Framer, TEST_PACKET_MAX_SIZE, &s_TestOps);
+
+    /* the receive task takes up to 64 bytes at once */
+    for (uint32_t done = 0; done < s_StreamLen;)
+    {
+        uint32_t chunk = 1 + rand() % 64;
+        if (chunk > s_StreamLen - done)
+        {
+            chunk = s_StreamLen - done;
+        }
+
+        HAL_BleWuartFramer_Feed(&s_Framer, &s_Stream[done], chunk);
+        done += chunk;
+    }
+
+    printf("seed %u: %u bytes, %u of %u packets, %u header errors, %u data errors, %u dropped, %u discarded bytes\n",
+           seed, s_StreamLen, s_Received, TEST_PACKETS, s_Framer.headerErrors, s_Framer.dataErrors,
+           s_Framer.droppedPackets, s_Framer.discardedBytes);
+
+    TEST_CHECK(s_Received == s_ExpectedCnt, "seed %u: %u packets handed over, expected %u", seed, s_Received,
+               s_ExpectedCnt);
+    TEST_CHECK(s_Framer.packets == s_Received, "seed %u: framer counted %u packets", seed, s_Framer.packets);
+    TEST_CHECK((s_DenyId == UINT32_MAX) || (s_Denied && (s_Framer.droppedPackets == 1)),
+               "seed %u: packet %u without buffer not dropped", seed, s_DenyId);
+    TEST_CHECK(s_Framer.stage == kHALBLEWUARTPacket_Header, "seed %u: framer left in a payload", seed);
+    for (int i = 0; i < TEST_POOL_CNT; i++)
+    {
+        TEST_CHECK(s_Pool[i].refCount == 0, "seed %u: buffer %d still held", seed, i);
+    }
+
+    s_DenyId = UINT32_MAX;
+}
+
+int main(void)
+{
+    s_Stream = malloc(TEST_STREAM_SIZE);
+    if (s_Stream == NULL)
+    {
+        return 1;
+    }
+
+    _Test_Crc32();
+    for (unsigned seed = 1; seed <= 5; seed++)
+    {
+        _Test_Framer(seed);
+    }
+
+    free(s_Stream);
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
@@ -0,0 +1,529 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the camera auto exposure controller of framework/hal/camera/hal_camera_exposure.c.
+ *
+ * The measure is checked on frames of each pixel format the controller reads, over the active rect and over a face
+ * region. The controller is then run against a model of the GC2145 and of the MT9M114 with its white LED: the
+ * frames are rendered in XYUV from the scene brightness, the exposure steps and the LED, and a change reaches the
+ * frames one or two frames later. From the nominal scene and after an 8x change of the scene, between 8x darker and
+ * 8x brighter than nominal, the frames must reach the target within a bounded number of frames and stay there without
+ * hunting, a change of the scene must be acted on from its first frame, the frames must never be held back for more
+ * than CAMERA_EXPOSURE_MAX_SKIPPED frames in a row, and the LED must only be used once the sensor is at its maximum.
+ * Scenes out of the range of the actuators must leave them at their limit with the frames usable.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Ibootloader/unit_tests/host_stubs -Iframework/inc -Iframework/hal_api -Iframework/hal/camera \
+ *       bootloader/unit_tests/camera_exposure_test/camera_exposure_test.c \
+ *       framework/hal/camera/hal_camera_exposure.c -lm -o camera_exposure_test
+ *   ./camera_exposure_test
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_camera_exposure.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_WIDTH   96
+#define TEST_HEIGHT  64
+#define TEST_PADDING 16
+#define TEST_MAX_BPP 4
+/* active rect, the pixels out of it are white and must not be measured */
+#define TEST_LEFT    8
+#define TEST_TOP     4
+#define TEST_RIGHT   87
+#define TEST_BOTTOM  59
+/* luma of the nominal scene with the exposure of the device init and the LED off */
+#define TEST_NOMINAL_LUMA CAMERA_EXPOSURE_TARGET_LUMA
+/* scene brightness added by the LED at 100 % */
+#define TEST_LED_GAIN     0.25f
+/* latest frame a change of the actuators reaches */
+#define TEST_MAX_LATENCY  2
+/* frames run once the target is reached, and the distance to the tolerance they may drift by, in EV */
+#define TEST_STABLE_FRAMES 30
+#define TEST_EDGE_EV       0.05f
+#define TEST_MAX_FRAMES    100
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+/* model of a sensor and of the light of its scene */
+typedef struct _test_sensor
+{
+    const char *name;
+    camera_dev_exposure_t exposure;
+    /* darkest scene the actuators bring on target */
+    float darkest;
+    /* frames to reach the target for a change of the scene, from the first frame of the new scene */
+    uint32_t maxConvergeFrames;
+} test_sensor_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+static const test_sensor_t s_Sensors[] = {
+    {
+        .name              = "GC2145",
+        .exposure          = {.stepUpEv   = 0.322f,
+                              .stepDownEv = 0.415f,
+                              .stepsUp    = 14,
+                              .stepsDown  = 12,
+                              .light      = kCameraDevLight_None},
+        .darkest           = 1.0f / 8,
+        .maxConvergeFrames = 14,
+    },
+    {
+        .name              = "MT9M114",
+        .exposure          = {.stepUpEv   = 0.1375f,
+                              .stepDownEv = 0.152f,
+                              .stepsUp    = 16,
+                              .stepsDown  = 24,
+                              .light      = kCameraDevLight_None},
+        .darkest           = 1.0f / 4,
+        .maxConvergeFrames = 12,
+    },
+    {
+        .name              = "MT9M114 with LED",
+        .exposure          = {.stepUpEv   = 0.1375f,
+                              .stepDownEv = 0.152f,
+                              .stepsUp    = 16,
+                              .stepsDown  = 24,
+                              .light      = kCameraDevLight_White,
+                              .lightMin   = 0,
+                              .lightMax   = 30},
+        .darkest           = 1.0f / 8,
+        .maxConvergeFrames = 18,
+    },
+};
+
+static uint8_t s_Pixels[TEST_HEIGHT * (TEST_WIDTH + TEST_PADDING) * TEST_MAX_BPP];
+static camera_dev_static_config_t s_Config;
+static camera_exposure_ctrl_t s_Ctrl;
+
+/* position of the actuators seen by each of the next frames */
+static int s_FrameSteps[TEST_MAX_LATENCY + 1];
+static int s_FrameLight[TEST_MAX_LATENCY + 1];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint8_t _Test_Clamp(float luma)
+{
+    return (luma <= 0) ? 0 : ((luma >= 255) ? 255 : (uint8_t)(luma + 0.5f));
+}
+
+static void _Test_Config(int bytesPerPixel, int swapByte)
+{
+    memset(&s_Config, 0, sizeof(s_Config));
+    s_Config.width    = TEST_WIDTH;
+    s_Config.height   = TEST_HEIGHT;
+    s_Config.pitch    = (TEST_WIDTH + TEST_PADDING) * bytesPerPixel;
+    s_Config.left     = TEST_LEFT;
+    s_Config.top      = TEST_TOP;
+    s_Config.right    = TEST_RIGHT;
+    s_Config.bottom   = TEST_BOTTOM;
+    s_Config.swapByte = swapByte;
+}
+
+/* gray frame, luma left of split and luma2 right of it, white out of the active rect */
+static void _Test_RenderGray(pixel_format_t format, int swapByte, int split, uint8_t luma, uint8_t luma2)
+{
+    int bytesPerPixel;
+
+    switch (format)
+    {
+        case kPixelFormat_YUV1P444_RGB:
+        case kPixelFormat_Gray888X:
+            bytesPerPixel = 4;
+            break;
+        case kPixelFormat_RGB:
+        case kPixelFormat_BGR:
+        case kPixelFormat_Gray888:
+            bytesPerPixel = 3;
+            break;
+        case kPixelFormat_Gray:
+            bytesPerPixel = 1;
+            break;
+        default:
+            bytesPerPixel = 2;
+            break;
+    }
+
+    _Test_Config(bytesPerPixel, swapByte);
+    memset(s_Pixels, 0xFF, sizeof(s_Pixels));
+
+    for (int y = TEST_TOP; y <= TEST_BOTTOM; y++)
+    {
+        for (int x = TEST_LEFT; x <= TEST_RIGHT; x++)
+        {
+            uint8_t *pixel = &s_Pixels[y * s_Config.pitch + x * bytesPerPixel];
+            uint8_t value  = (x < split) ? luma : luma2;
+
+            switch (format)
+            {
+                case kPixelFormat_YUV1P444_RGB:
+                    pixel[0] = 0;
+                    pixel[1] = 128;
+                    pixel[2] = value;
+                    pixel[3] = 128;
+                    break;
+                case kPixelFormat_UYVY1P422_RGB:
+                case kPixelFormat_Gray16:
+                    pixel[swapByte ? 1 : 0] = (format == kPixelFormat_Gray16) ? 0xFF : 128;
+                    pixel[swapByte ? 0 : 1] = value;
+                    break;
+                case kPixelFormat_RGB565:
+                {
+                    uint16_t rgb = ((value >> 3) << 11) | ((value >> 2) << 5) | (value >> 3);
+
+                    pixel[swapByte ? 1 : 0] = rgb & 0xFF;
+                    pixel[swapByte ? 0 : 1] = rgb >> 8;
+                    break;
+                }
+                default:
+                    memset(pixel, value, bytesPerPixel);
+                    break;
+            }
+        }
+    }
+}
+
+static void _Test_Measure(void)
+{
+    static const struct
+    {
+        pixel_format_t format;
+        int swapByte;
+    } formats[] = {
+        {kPixelFormat_YUV1P444_RGB, 0},  {kPixelFormat_UYVY1P422_RGB, 0}, {kPixelFormat_UYVY1P422_RGB, 1},
+        {kPixelFormat_Gray16, 0},        {kPixelFormat_Gray16, 1},        {kPixelFormat_Gray, 0},
+        {kPixelFormat_Gray888, 0},       {kPixelFormat_Gray888X, 0},      {kPixelFormat_RGB, 0},
+        {kPixelFormat_BGR, 0},           {kPixelFormat_RGB565, 0},        {kPixelFormat_RGB565, 1},
+    };
+    static const uint8_t lumas[] = {0, 37, 110, 200, 255};
+    camera_exposure_measure_t measure;
+    camera_dev_exposure_t none = {0};
+    uint32_t samples;
+
+    HAL_CameraExposure_Init(&s_Ctrl, &none);
+    TEST_CHECK(!HAL_CameraExposure_HasActuators(&s_Ctrl), "actuators without steps and LED");
+
+    for (uint32_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+    {
+        /* the RGB565 rounding and the luma weights lose up to 8 */
+        int tolerance = (formats[f].format == kPixelFormat_RGB565) ? 8 : 1;
+
+        for (uint32_t l = 0; l < sizeof(lumas); l++)
+        {
+            uint8_t luma = lumas[l];
+
+            _Test_RenderGray(formats[f].format, formats[f].swapByte, 0, luma, luma);
+            TEST_CHECK(HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, formats[f].format, &s_Config, &measure) == 0,
+                       "format %d measure failed", formats[f].format);
+            TEST_CHECK(abs(measure.mean - luma) <= tolerance, "format %d swap %d, mean %u for %u", formats[f].format,
+                       formats[f].swapByte, measure.mean, luma);
+            TEST_CHECK(measure.histogram[measure.mean * CAMERA_EXPOSURE_HISTOGRAM_BINS / 256] == measure.samples,
+                       "format %d, %u luma samples out of the bin of the mean", formats[f].format, luma);
+            if (formats[f].format != kPixelFormat_RGB565)
+            {
+                bool clipped = (luma == 0) || (luma == 255);
+                TEST_CHECK(measure.clipped == (clipped ? 100 : 0), "format %d, %u%% clipped at %u", formats[f].format,
+                           measure.clipped, luma);
+            }
+        }
+    }
+
+    /* the luma weights of the color formats, red 200, green 100 and blue 20 */
+    _Test_RenderGray(kPixelFormat_RGB, 0, 0, 0, 0);
+    for (int i = 0; i < TEST_HEIGHT * s_Config.pitch; i += 3)
+    {
+        s_Pixels[i]     = 200;
+        s_Pixels[i + 1] = 100;
+        s_Pixels[i + 2] = 20;
+    }
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_RGB, &s_Config, &measure);
+    TEST_CHECK(measure.mean == 121, "mean %u of an RGB frame", measure.mean);
+    for (int i = 0; i < TEST_HEIGHT * s_Config.pitch; i += 3)
+    {
+        s_Pixels[i]     = 20;
+        s_Pixels[i + 2] = 200;
+    }
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_BGR, &s_Config, &measure);
+    TEST_CHECK(measure.mean == 121, "mean %u of a BGR frame", measure.mean);
+
+    /* the face region only */
+    _Test_RenderGray(kPixelFormat_Gray, 0, 48, 200, 40);
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_Gray, &s_Config, &measure);
+    samples = measure.samples;
+    TEST_CHECK((measure.mean > 40) && (measure.mean < 200), "mean %u of the active rect", measure.mean);
+    HAL_CameraExposure_SetRoi(&s_Ctrl, 56, 10, 80, 50);
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_Gray, &s_Config, &measure);
+    TEST_CHECK(measure.mean == 40, "mean %u of the face region", measure.mean);
+    TEST_CHECK((measure.samples > 0) && (measure.samples < samples), "%u samples in the face region",
+               measure.samples);
+    HAL_CameraExposure_SetRoi(&s_Ctrl, 0, 10, 40, 50);
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_Gray, &s_Config, &measure);
+    TEST_CHECK(measure.mean == 200, "mean %u of the face region across the active rect", measure.mean);
+
+    /* a face out of the active rect and an empty region measure the active rect */
+    HAL_CameraExposure_SetRoi(&s_Ctrl, TEST_RIGHT + 2, 10, TEST_RIGHT + 8, 50);
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_Gray, &s_Config, &measure);
+    TEST_CHECK(measure.samples == samples, "%u samples for a face out of the active rect", measure.samples);
+    HAL_CameraExposure_SetRoi(&s_Ctrl, 0, 0, 0, 0);
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_Gray, &s_Config, &measure);
+    TEST_CHECK(measure.samples == samples, "%u samples after the face is cleared", measure.samples);
+
+    TEST_CHECK(HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_YUV420P, &s_Config, &measure) == -1,
+               "YUV420P measured");
+}
+
+/* luma of a pixel of the scene with the actuators seen by the frame */
+static float _Test_Luma(const camera_dev_exposure_t *exposure, float scene, int steps, int light, float texture)
+{
+    float ev = (steps > 0) ? steps * exposure->stepUpEv : steps * exposure->stepDownEv;
+
+    return TEST_NOMINAL_LUMA * texture * (scene + TEST_LED_GAIN * light / 100) * exp2f(ev);
+}
+
+static void _Test_RenderScene(const camera_dev_exposure_t *exposure, float scene, int steps, int light)
+{
+    _Test_Config(4, 0);
+    memset(s_Pixels, 0, sizeof(s_Pixels));
+
+    for (int y = TEST_TOP; y <= TEST_BOTTOM; y++)
+    {
+        for (int x = TEST_LEFT; x <= TEST_RIGHT; x++)
+        {
+            /* a texture of +-25 % around the scene brightness with some sensor noise */
+            float texture = 0.75f + 0.5f * ((x * 7 + y * 13) % 32) / 31 + 0.02f * ((rand() % 5) - 2);
+
+            s_Pixels[y * s_Config.pitch + x * 4 + 2] = _Test_Clamp(_Test_Luma(exposure, scene, steps, light, texture));
+        }
+    }
+}
+
+/* run one frame of the scene, the action reaches the frame latency frames later */
+static bool _Test_Frame(const test_sensor_t *sensor, float scene, int latency, camera_exposure_measure_t *measure)
+{
+    camera_exposure_action_t action;
+    bool usable;
+
+    _Test_RenderScene(&sensor->exposure, scene, s_FrameSteps[0], s_FrameLight[0]);
+    HAL_CameraExposure_Measure(&s_Ctrl, s_Pixels, kPixelFormat_YUV1P444_RGB, &s_Config, measure);
+    usable = HAL_CameraExposure_Update(&s_Ctrl, measure, &action);
+
+    for (int i = 0; i < TEST_MAX_LATENCY; i++)
+    {
+        s_FrameSteps[i] = s_FrameSteps[i + 1];
+        s_FrameLight[i] = s_FrameLight[i + 1];
+    }
+    for (int i = latency - 1; i <= TEST_MAX_LATENCY; i++)
+    {
+        s_FrameSteps[i] += action.steps;
+        if (action.light >= 0)
+        {
+            s_FrameLight[i] = action.light;
+        }
+    }
+
+    return usable;
+}
+
+static bool _Test_OnTarget(uint8_t mean)
+{
+    return fabsf(log2f((float)CAMERA_EXPOSURE_TARGET_LUMA / ((mean != 0) ? mean : 1))) <= CAMERA_EXPOSURE_TOLERANCE_EV;
+}
+
+/* run a scene until a frame is usable and on target, return the frames it took */
+static uint32_t _Test_Converge(const test_sensor_t *sensor, float scene, int latency)
+{
+    camera_exposure_measure_t measure;
+    uint32_t heldBack = 0;
+    uint32_t adjustments;
+    uint32_t frames;
+    uint32_t reached = 0;
+    int prevSteps    = s_Ctrl.exposureSteps;
+    int prevLight    = s_Ctrl.light;
+
+    for (frames = 1; frames <= TEST_MAX_FRAMES; frames++)
+    {
+        uint32_t before = s_Ctrl.stats.adjustments;
+        bool usable     = _Test_Frame(sensor, scene, latency, &measure);
+
+        /* a new scene is acted on without waiting */
+        if ((frames == 1) && !_Test_OnTarget(measure.mean))
+        {
+            TEST_CHECK(s_Ctrl.stats.adjustments == before + 1, "%s, scene %.3f, first frame not acted on",
+                       sensor->name, scene);
+        }
+
+        /* the LED lights up once the sensor is at its maximum, and dims when the sensor darkens */
+        if (s_Ctrl.light > prevLight)
+        {
+            TEST_CHECK(s_Ctrl.exposureSteps == sensor->exposure.stepsUp, "%s, LED up to %d%% at %d steps",
+                       sensor->name, s_Ctrl.light, s_Ctrl.exposureSteps);
+        }
+        if ((s_Ctrl.exposureSteps < prevSteps) && (prevLight > sensor->exposure.lightMin))
+        {
+            TEST_CHECK(s_Ctrl.light < prevLight, "%s, sensor down to %d steps with the LED at %d%%", sensor->name,
+                       s_Ctrl.exposureSteps, s_Ctrl.light);
+        }
+        prevSteps = s_Ctrl.exposureSteps;
+        prevLight = s_Ctrl.light;
+
+        heldBack = usable ? 0 : heldBack + 1;
+        TEST_CHECK(heldBack < CAMERA_EXPOSURE_MAX_SKIPPED, "%s, scene %.3f, %u frames held back in a row",
+                   sensor->name, scene, heldBack);
+
+        if (usable && _Test_OnTarget(measure.mean))
+        {
+            reached = frames;
+            break;
+        }
+    }
+
+    /* the loop does not hunt around the target, one correction is allowed for a frame landing on the tolerance */
+    adjustments = s_Ctrl.stats.adjustments;
+    for (uint32_t i = 0; i < TEST_STABLE_FRAMES; i++)
+    {
+        float error;
+
+        _Test_Frame(sensor, scene, latency, &measure);
+        error = log2f((float)CAMERA_EXPOSURE_TARGET_LUMA / ((measure.mean != 0) ? measure.mean : 1));
+        TEST_CHECK(fabsf(error) <= CAMERA_EXPOSURE_TOLERANCE_EV + TEST_EDGE_EV,
+                   "%s, scene %.3f, frame %u after the target at %.2f EV", sensor->name, scene, i, error);
+    }
+    TEST_CHECK(s_Ctrl.stats.adjustments - adjustments <= 1, "%s, scene %.3f, %u adjustments after the target",
+               sensor->name, scene, s_Ctrl.stats.adjustments - adjustments);
+
+    return (reached != 0) ? reached : frames;
+}
+
+static void _Test_Init(const test_sensor_t *sensor)
+{
+    HAL_CameraExposure_Init(&s_Ctrl, &sensor->exposure);
+    memset(s_FrameSteps, 0, sizeof(s_FrameSteps));
+    for (int i = 0; i <= TEST_MAX_LATENCY; i++)
+    {
+        s_FrameLight[i] = s_Ctrl.light;
+    }
+}
+
+static void _Test_Control(const test_sensor_t *sensor)
+{
+    /* scenes the actuators can bring on target */
+    static const float scenes[] = {1.0f / 8, 1.0f / 4, 1.0f / 2, 1.0f, 2.0f, 4.0f, 8.0f};
+
+    TEST_CHECK(HAL_CameraExposure_HasActuators(&s_Ctrl), "%s without actuators", sensor->name);
+
+    for (int latency = 1; latency <= TEST_MAX_LATENCY; latency++)
+    {
+        uint32_t worst = 0;
+
+        for (uint32_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++)
+        {
+            float changed = (scenes[s] < 1) ? scenes[s] * 8 : scenes[s] / 8;
+            uint32_t frames;
+
+            if ((scenes[s] < sensor->darkest) || (changed < sensor->darkest))
+            {
+                continue;
+            }
+
+            /* from the nominal exposure */
+            _Test_Init(sensor);
+            frames = _Test_Converge(sensor, scenes[s], latency);
+            TEST_CHECK(frames <= sensor->maxConvergeFrames, "%s, latency %d, scene %.3f reached in %u frames",
+                       sensor->name, latency, scenes[s], frames);
+            worst = (frames > worst) ? frames : worst;
+
+            /* a change of the scene once on target */
+            frames = _Test_Converge(sensor, changed, latency);
+            TEST_CHECK(frames <= sensor->maxConvergeFrames, "%s, latency %d, change from scene %.3f in %u frames",
+                       sensor->name, latency, scenes[s], frames);
+            worst = (frames > worst) ? frames : worst;
+        }
+
+        printf("%s, latency %d: target reached within %u frames\n", sensor->name, latency, worst);
+    }
+}
+
+static void _Test_Saturation(const test_sensor_t *sensor)
+{
+    camera_exposure_measure_t measure;
+    uint32_t frames;
+
+    /* a scene too dark for the actuators, the frames are usable once they are all at their maximum */
+    _Test_Init(sensor);
+    for (frames = 1; frames <= TEST_MAX_FRAMES; frames++)
+    {
+        _Test_Frame(sensor, 1.0f / 256, 1, &measure);
+    }
+    TEST_CHECK(s_Ctrl.exposureSteps == sensor->exposure.stepsUp, "%s, %d steps in the dark", sensor->name,
+               s_Ctrl.exposureSteps);
+    if (sensor->exposure.light != kCameraDevLight_None)
+    {
+        TEST_CHECK(s_Ctrl.light == sensor->exposure.lightMax, "%s, LED at %d%% in the dark", sensor->name,
+                   s_Ctrl.light);
+    }
+    for (uint32_t i = 0; i < TEST_STABLE_FRAMES; i++)
+    {
+        TEST_CHECK(_Test_Frame(sensor, 1.0f / 256, 1, &measure), "%s, frame %u in the dark held back", sensor->name, i);
+    }
+
+    /* and too bright */
+    for (frames = 1; frames <= TEST_MAX_FRAMES; frames++)
+    {
+        _Test_Frame(sensor, 256.0f, 1, &measure);
+    }
+    TEST_CHECK(s_Ctrl.exposureSteps == -sensor->exposure.stepsDown, "%s, %d steps in a bright scene", sensor->name,
+               s_Ctrl.exposureSteps);
+    TEST_CHECK(s_Ctrl.light == sensor->exposure.lightMin, "%s, LED at %d%% in a bright scene", sensor->name,
+               s_Ctrl.light);
+    TEST_CHECK(_Test_Frame(sensor, 256.0f, 1, &measure), "%s, frame in a bright scene held back", sensor->name);
+}
+
+int main(void)
+{
+    srand(1);
+
+    _Test_Measure();
+    for (uint32_t i = 0; i < sizeof(s_Sensors) / sizeof(s_Sensors[0]); i++)
+    {
+        _Test_Init(&s_Sensors[i]);
+        _Test_Control(&s_Sensors[i]);
+        _Test_Saturation(&s_Sensors[i]);
+    }
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the display buffer queue of framework/hal/display/hal_display_buffer.c.
+ *
+ * The first part checks the calls which are refused: a second request, a blit of a buffer which was not handed out and
+ * an unsupported buffer count. The second part simulates a display controller with a 60 Hz vsync, which switches to
+ * the programmed frame at the vsync, and a producer which renders each frame in a fixed time, for 2 and 3 buffers and
+ * a range of render times. It checks that the producer never renders into the frame on the screen or the one waiting
+ * for the vsync, that every frame is shown, in order, and that the frame rate is the one the buffer count allows.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Ibootloader/unit_tests/host_stubs -Iframework/inc -Iframework/hal/display \
+ *       bootloader/unit_tests/display_buffer_test/display_buffer_test.c \
+ *       framework/hal/display/hal_display_buffer.c -o display_buffer_test
+ *   ./display_buffer_test
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hal_display_buffer.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_BUFFER_SIZE 64
+#define TEST_VSYNC_US    16667
+#define TEST_TICK_US     100
+#define TEST_DURATION_US 10000000U
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+static uint32_t s_NowUs;
+
+static uint8_t s_Buffers[DISPLAY_BUFFER_MAX_COUNT][TEST_BUFFER_SIZE];
+static display_buffer_queue_t s_Queue;
+
+/* display controller, the programmed frame is switched on at the next vsync */
+static uint8_t *s_OnScreen;
+static uint8_t *s_Programmed;
+static uint32_t s_ShownSeq;
+static uint32_t s_Switches;
+
+/* producer, the buffer it renders into and when it is done */
+static uint8_t *s_Rendering;
+static uint32_t s_RenderDoneUs;
+static uint32_t s_Seq;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+unsigned int FWK_CurrentTimeUs()
+{
+    return s_NowUs;
+}
+
+static void _Test_Program(void *frame)
+{
+    s_Programmed = frame;
+}
+
+static uint32_t _Test_Head(const uint8_t *frame)
+{
+    uint32_t seq;
+    memcpy(&seq, frame, sizeof(seq));
+    return seq;
+}
+
+static uint32_t _Test_Tail(const uint8_t *frame)
+{
+    uint32_t seq;
+    memcpy(&seq, &frame[TEST_BUFFER_SIZE - sizeof(seq)], sizeof(seq));
+    return seq;
+}
+
+static void _Test_Init(uint32_t count)
+{
+    uint8_t *buffers[DISPLAY_BUFFER_MAX_COUNT] = {s_Buffers[0], s_Buffers[1], s_Buffers[2]};
+
+    memset(s_Buffers, 0, sizeof(s_Buffers));
+    s_NowUs      = 0;
+    s_OnScreen   = s_Buffers[0];
+    s_Programmed = NULL;
+    s_ShownSeq   = 0;
+    s_Switches   = 0;
+    s_Rendering  = NULL;
+    s_Seq        = 0;
+
+    HAL_DisplayBuffer_Init(&s_Queue, "test", 0, buffers, count, _Test_Program);
+}
+
+static void _Test_StartRender(uint8_t *frame, uint32_t renderUs)
+{
+    /* the frame on the screen and the one waiting for the vsync must not be touched */
+    TEST_CHECK((frame != s_OnScreen) && (frame != s_Programmed), "buffer %d handed out at %u us while scanned out",
+               (int)((frame - s_Buffers[0]) / TEST_BUFFER_SIZE), s_NowUs);
+
+    s_Seq++;
+    memcpy(frame, &s_Seq, sizeof(s_Seq));
+    s_Rendering    = frame;
+    s_RenderDoneUs = s_NowUs + renderUs;
+}
+
+static void _Test_Vsync(uint32_t renderUs)
+{
+    void *next;
+
+    /* the frame on the screen was not written since it was switched on */
+    TEST_CHECK((_Test_Head(s_OnScreen) == s_ShownSeq) && (_Test_Tail(s_OnScreen) == s_ShownSeq),
+               "frame %u overwritten on the screen at %u us", s_ShownSeq, s_NowUs);
+
+    if (s_Programmed != NULL)
+    {
+        uint32_t seq = _Test_Head(s_Programmed);
+
+        TEST_CHECK(_Test_Tail(s_Programmed) == seq, "frame %u switched on before it was rendered", seq);
+        /* no frame is dropped, a pending frame must not be replaced by the next one */
+        TEST_CHECK(seq == s_ShownSeq + 1, "frame %u shown after frame %u", seq, s_ShownSeq);
+        s_OnScreen   = s_Programmed;
+        s_Programmed = NULL;
+        s_ShownSeq   = seq;
+        s_Switches++;
+    }
+
+    /* the eLCDIF signals every frame, with or without a switch */
+    next = HAL_DisplayBuffer_SwitchDone(&s_Queue);
+    if (next != NULL)
+    {
+        TEST_CHECK(s_Rendering == NULL, "buffer handed out at %u us while the producer renders", s_NowUs);
+        _Test_StartRender(next, renderUs);
+    }
+}
+
+static void _Test_Submit(uint32_t renderUs)
+{
+    uint8_t *frame = s_Rendering;
+    void *next;
+
+    memcpy(&frame[TEST_BUFFER_SIZE - sizeof(s_Seq)], &s_Seq, sizeof(s_Seq));
+    s_Rendering = NULL;
+
+    next = HAL_DisplayBuffer_Submit(&s_Queue, frame);
+    if (next != NULL)
+    {
+        _Test_StartRender(next, renderUs);
+    }
+}
+
+static void _Test_Refused(void)
+{
+    uint8_t *buffers[DISPLAY_BUFFER_MAX_COUNT] = {s_Buffers[0], s_Buffers[1], s_Buffers[2]};
+    display_buffer_stats_t stats;
+    uint8_t foreign[TEST_BUFFER_SIZE];
+    void *frame;
+
+    _Test_Init(2);
+
+    frame = HAL_DisplayBuffer_Request(&s_Queue);
+    TEST_CHECK(frame == s_Buffers[1], "first request does not give the buffer off the screen");
+    TEST_CHECK(HAL_DisplayBuffer_Request(&s_Queue) == NULL, "second request while the producer renders");
+    TEST_CHECK(HAL_DisplayBuffer_SwitchDone(&s_Queue) == NULL, "switch without a pending frame");
+
+    /* a buffer which was not handed out may be on the screen, it is not programmed */
+    TEST_CHECK(HAL_DisplayBuffer_Submit(&s_Queue, foreign) == NULL, "blit of a foreign buffer");
+    TEST_CHECK(HAL_DisplayBuffer_Submit(&s_Queue, s_Buffers[0]) == NULL, "blit of the buffer on the screen");
+    TEST_CHECK(s_Programmed == NULL, "refused blit programmed");
+
+    TEST_CHECK(HAL_DisplayBuffer_Submit(&s_Queue, frame) == NULL, "buffer free while the other one is on the screen");
+    TEST_CHECK(s_Programmed == frame, "blit not programmed");
+    TEST_CHECK(HAL_DisplayBuffer_SwitchDone(&s_Queue) == s_Buffers[0], "switch does not hand out the old frame");
+
+    HAL_DisplayBuffer_GetStats(&s_Queue, &stats);
+    TEST_CHECK((stats.submitted == 1) && (stats.shown == 1) && (stats.dropped == 2) && (stats.paced == 1),
+               "stats submitted %u shown %u dropped %u paced %u", stats.submitted, stats.shown, stats.dropped,
+               stats.paced);
+
+    HAL_DisplayBuffer_Init(&s_Queue, "test", 0, buffers, 1, _Test_Program);
+    TEST_CHECK(HAL_DisplayBuffer_Request(&s_Queue) == NULL, "request with a single buffer");
+    HAL_DisplayBuffer_Init(&s_Queue, "test", 0, buffers, DISPLAY_BUFFER_MAX_COUNT + 1, _Test_Program);
+    TEST_CHECK(HAL_DisplayBuffer_Submit(&s_Queue, s_Buffers[1]) == NULL, "blit with too many buffers");
+}
+
+static void _Test_Simulate(uint32_t count, uint32_t renderUs)
+{
+    display_buffer_stats_t stats;
+    uint32_t intervalUs;
+    uint32_t expected;
+    uint32_t maxLatencyUs;
+    void *frame;
+
+    _Test_Init(count);
+
+    frame = HAL_DisplayBuffer_Request(&s_Queue);
+    TEST_CHECK(frame != NULL, "no buffer for the first frame");
+    if (frame == NULL)
+    {
+        return;
+    }
+    _Test_StartRender(frame, renderUs);
+
+    for (s_NowUs = TEST_TICK_US; s_NowUs <= TEST_DURATION_US; s_NowUs += TEST_TICK_US)
+    {
+        if ((s_Rendering != NULL) && (s_NowUs >= s_RenderDoneUs))
+        {
+            _Test_Submit(renderUs);
+        }
+
+        if ((s_NowUs % TEST_VSYNC_US) < TEST_TICK_US)
+        {
+            _Test_Vsync(renderUs);
+        }
+    }
+
+    HAL_DisplayBuffer_GetStats(&s_Queue, &stats);
+
+    /* a frame takes a whole number of vsyncs with 2 buffers, with 3 the producer renders while a frame waits */
+    if (count == 2)
+    {
+        intervalUs   = ((renderUs + TEST_VSYNC_US - 1) / TEST_VSYNC_US) * TEST_VSYNC_US;
+        maxLatencyUs = TEST_VSYNC_US + TEST_TICK_US;
+    }
+    else
+    {
+        intervalUs   = (renderUs > TEST_VSYNC_US) ? renderUs : TEST_VSYNC_US;
+        maxLatencyUs = 2 * TEST_VSYNC_US + TEST_TICK_US;
+    }
+    expected = TEST_DURATION_US / intervalUs;
+
+    printf("%u buffers, render %5u us: %4u shown, %4u expected, %4u late, %4u paced, max latency %5u us\n", count,
+           renderUs, stats.shown, expected, stats.late, stats.paced, stats.maxLatencyUs);
+
+    TEST_CHECK((stats.shown == s_Switches) && (stats.dropped == 0), "shown %u switched %u dropped %u", stats.shown,
+               s_Switches, stats.dropped);
+    TEST_CHECK(stats.submitted - stats.shown < count, "%u frames submitted, %u shown", stats.submitted, stats.shown);
+    TEST_CHECK((stats.shown * 100 >= expected * 97) && (stats.shown <= expected + count),
+               "%u frames shown, expected %u", stats.shown, expected);
+    TEST_CHECK(stats.maxLatencyUs <= maxLatencyUs, "latency %u us", stats.maxLatencyUs);
+    TEST_CHECK((count == 3) || (stats.late == 0), "%u late frames with 2 buffers", stats.late);
+}
+
+int main(void)
+{
+    static const uint32_t renderUs[] = {1000, 5000, 12000, 16000, 17500, 25000, 40000, 70000};
+
+    _Test_Refused();
+
+    for (uint32_t count = 2; count <= DISPLAY_BUFFER_MAX_COUNT; count++)
+    {
+        for (uint32_t i = 0; i < sizeof(renderUs) / sizeof(renderUs[0]); i++)
+        {
+            _Test_Simulate(count, renderUs[i]);
+        }
+    }
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
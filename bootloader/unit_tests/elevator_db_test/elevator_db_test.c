@@ -0,0 +1,519 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the elevator database of elevator/cm7/source/hal_sln_elevatordb.c.
+ *
+ * The flash is a file system in memory where each save, write and remove is atomic, as with littlefs, and the power
+ * can be cut before any of them. The test checks the entries over reboots, the single read of the table at boot and
+ * the single save of an erase all, the migration of a database of the per entry layout, the rejected ids, and that a
+ * power cut at any point of a migration, an add, an update or a delete leaves a database with each entry either
+ * before or after the change.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Ibootloader/unit_tests/host_stubs -Ielevator/cm7/source \
+ *       bootloader/unit_tests/elevator_db_test/elevator_db_test.c \
+ *       elevator/cm7/source/hal_sln_elevatordb.c -o elevator_db_test
+ *   ./elevator_db_test
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fwk_flash.h"
+#include "hal_sln_elevatordb.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_MAX_FILES     (ELEVATOR_DB_MAX_SIZE + 8)
+#define TEST_MAX_FILE_SIZE 4096
+#define TEST_PATH_SIZE     32
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+typedef struct _test_file
+{
+    bool used;
+    bool dir;
+    char path[TEST_PATH_SIZE];
+    uint32_t size;
+    uint8_t data[TEST_MAX_FILE_SIZE];
+} test_file_t;
+
+/* Metadata file of the per entry layout of the versions 1 and 2, as read by hal_sln_elevatordb.c */
+typedef struct _test_legacy_metadata
+{
+    uint32_t version;
+    uint32_t count;
+    uint32_t maxCount;
+    uint16_t entrySize;
+    uint32_t bufferSize;
+    uint8_t reserved[8];
+    uint8_t map[ELEVATOR_DB_MAX_SIZE];
+} test_legacy_metadata_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+static test_file_t s_Files[TEST_MAX_FILES];
+
+/* flash operations left before the power is cut, negative to never cut it */
+static int s_CutAfter = -1;
+static bool s_PowerLost;
+
+static uint32_t s_Reads;
+static uint32_t s_Saves;
+static uint32_t s_Writes;
+static uint32_t s_Removes;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+char *itoa(int value, char *str, int base)
+{
+    (void)base;
+    sprintf(str, "%d", value);
+    return str;
+}
+
+static test_file_t *_Test_File(const char *path)
+{
+    for (uint32_t i = 0; i < TEST_MAX_FILES; i++)
+    {
+        if (s_Files[i].used && (strcmp(s_Files[i].path, path) == 0))
+        {
+            return &s_Files[i];
+        }
+    }
+
+    return NULL;
+}
+
+static test_file_t *_Test_NewFile(const char *path)
+{
+    for (uint32_t i = 0; i < TEST_MAX_FILES; i++)
+    {
+        if (!s_Files[i].used)
+        {
+            memset(&s_Files[i], 0, sizeof(test_file_t));
+            s_Files[i].used = true;
+            strncpy(s_Files[i].path, path, TEST_PATH_SIZE - 1);
+            return &s_Files[i];
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t _Test_FileCount(void)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < TEST_MAX_FILES; i++)
+    {
+        count += (s_Files[i].used && !s_Files[i].dir) ? 1 : 0;
+    }
+
+    return count;
+}
+
+/* a change to the flash, false once the power is cut */
+static bool _Test_Change(void)
+{
+    if (!s_PowerLost && (s_CutAfter == 0))
+    {
+        s_PowerLost = true;
+    }
+    else if (s_CutAfter > 0)
+    {
+        s_CutAfter--;
+    }
+
+    return !s_PowerLost;
+}
+
+sln_flash_status_t FWK_Flash_Save(const char *path, void *buf, unsigned int size)
+{
+    test_file_t *file = _Test_File(path);
+
+    if (!_Test_Change())
+    {
+        return kStatus_HAL_FlashFail;
+    }
+    if (((file == NULL) && ((file = _Test_NewFile(path)) == NULL)) || (size > TEST_MAX_FILE_SIZE))
+    {
+        return kStatus_HAL_FlashFail;
+    }
+
+    memcpy(file->data, buf, size);
+    file->size = size;
+    s_Saves++;
+
+    return kStatus_HAL_FlashSuccess;
+}
+
+sln_flash_status_t FWK_Flash_Write(const char *path, void *buf, unsigned int offset, unsigned int size)
+{
+    test_file_t *file = _Test_File(path);
+
+    if (!_Test_Change())
+    {
+        return kStatus_HAL_FlashFail;
+    }
+    if ((file == NULL) || file->dir)
+    {
+        return kStatus_HAL_FlashFileNotExist;
+    }
+    if (offset + size > TEST_MAX_FILE_SIZE)
+    {
+        return kStatus_HAL_FlashFail;
+    }
+
+    memcpy(&file->data[offset], buf, size);
+    if (offset + size > file->size)
+    {
+        file->size = offset + size;
+    }
+    s_Writes++;
+
+    return kStatus_HAL_FlashSuccess;
+}
+
+sln_flash_status_t FWK_Flash_Read(const char *path, void *buf, unsigned int offset, unsigned int *size)
+{
+    test_file_t *file = _Test_File(path);
+
+    if (s_PowerLost)
+    {
+        return kStatus_HAL_FlashFail;
+    }
+    if ((file == NULL) || file->dir)
+    {
+        return kStatus_HAL_FlashFileNotExist;
+    }
+
+    *size = (offset >= file->size) ? 0 : ((file->size - offset < *size) ? file->size - offset : *size);
+    memcpy(buf, &file->data[offset], *size);
+    s_Reads++;
+
+    return kStatus_HAL_FlashSuccess;
+}
+
+sln_flash_status_t FWK_Flash_Mkdir(const char *path)
+{
+    test_file_t *file = _Test_File(path);
+
+    if (file != NULL)
+    {
+        return s_PowerLost ? kStatus_HAL_FlashFail : kStatus_HAL_FlashDirExist;
+    }
+    if (!_Test_Change() || ((file = _Test_NewFile(path)) == NULL))
+    {
+        return kStatus_HAL_FlashFail;
+    }
+
+    file->dir = true;
+
+    return kStatus_HAL_FlashSuccess;
+}
+
+sln_flash_status_t FWK_Flash_Rm(const char *path)
+{
+    test_file_t *file = _Test_File(path);
+
+    if (!_Test_Change())
+    {
+        return kStatus_HAL_FlashFail;
+    }
+    if (file == NULL)
+    {
+        return kStatus_HAL_FlashFileNotExist;
+    }
+
+    file->used = false;
+    s_Removes++;
+
+    return kStatus_HAL_FlashSuccess;
+}
+
+static void _Test_Attr(elevator_attr_t *attr, uint16_t id, uint32_t version)
+{
+    memset(attr, 0, sizeof(elevator_attr_t));
+    attr->id       = id;
+    attr->floor    = id * 3 + version;
+    attr->language = (uint8_t)(id % 4);
+    memset(attr->reserved, (int)(id + version), sizeof(attr->reserved));
+}
+
+/* the entry as read back, or an entry filled with 0xa5 when the id is not used */
+static elevator_attr_t _Test_Get(uint16_t id)
+{
+    elevator_attr_t attr;
+
+    memset(&attr, 0xa5, sizeof(attr));
+    TEST_CHECK(g_elevatordb_ops.getWithId(id, &attr) == kElevatorDBStatus_Success, "get of id %u failed", id);
+
+    return attr;
+}
+
+static bool _Test_Is(uint16_t id, uint32_t version)
+{
+    elevator_attr_t expected;
+    elevator_attr_t attr = _Test_Get(id);
+
+    if (version == 0)
+    {
+        memset(&expected, 0xa5, sizeof(expected));
+    }
+    else
+    {
+        _Test_Attr(&expected, id, version);
+    }
+
+    return memcmp(&attr, &expected, sizeof(expected)) == 0;
+}
+
+static elevatordb_status_t _Test_Reboot(void)
+{
+    g_elevatordb_ops.deinit();
+    s_PowerLost = false;
+    s_CutAfter  = -1;
+    s_Reads     = 0;
+    s_Saves     = 0;
+    s_Writes    = 0;
+    s_Removes   = 0;
+
+    return g_elevatordb_ops.init();
+}
+
+static void _Test_Format(void)
+{
+    memset(s_Files, 0, sizeof(s_Files));
+}
+
+static void _Test_Entries(void)
+{
+    elevator_attr_t attr;
+
+    _Test_Format();
+    TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "init of an empty flash");
+    TEST_CHECK((_Test_FileCount() == 1) && (_Test_File("elevator/Table") != NULL), "table not created");
+
+    for (uint16_t id = 0; id < ELEVATOR_DB_MAX_SIZE; id += 3)
+    {
+        _Test_Attr(&attr, id, 1);
+        TEST_CHECK(g_elevatordb_ops.addWithId(id, &attr) == kElevatorDBStatus_Success, "add of id %u", id);
+    }
+    _Test_Attr(&attr, ELEVATOR_DB_MAX_SIZE, 1);
+    TEST_CHECK(g_elevatordb_ops.addWithId(ELEVATOR_DB_MAX_SIZE, &attr) == kElevatorDBStatus_Failed,
+               "add of the id past the table");
+    TEST_CHECK(g_elevatordb_ops.getWithId(ELEVATOR_DB_MAX_SIZE, &attr) == kElevatorDBStatus_Failed,
+               "get of the id past the table");
+
+    _Test_Attr(&attr, 3, 2);
+    TEST_CHECK(g_elevatordb_ops.updWithId(3, &attr) == kElevatorDBStatus_Success, "update of id 3");
+    TEST_CHECK(g_elevatordb_ops.delWithId(6) == kElevatorDBStatus_Success, "delete of id 6");
+    TEST_CHECK(_Test_FileCount() == 1, "%u files instead of the table", _Test_FileCount());
+
+    /* the whole table is read at once at boot */
+    TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "init of a saved table");
+    TEST_CHECK((s_Reads == 1) && (s_Saves == 0) && (s_Writes == 0), "boot read %u times, saved %u, written %u",
+               s_Reads, s_Saves, s_Writes);
+    for (uint16_t id = 0; id < ELEVATOR_DB_MAX_SIZE; id++)
+    {
+        uint32_t version = ((id % 3) != 0) || (id == 6) ? 0 : ((id == 3) ? 2 : 1);
+        TEST_CHECK(_Test_Is(id, version), "id %u not as saved after a reboot", id);
+    }
+
+    /* erase all is one save of the empty table */
+    TEST_CHECK(g_elevatordb_ops.delWithId(INVALID_ID) == kElevatorDBStatus_Success, "erase all");
+    TEST_CHECK((s_Saves == 1) && (s_Writes == 0) && (s_Removes == 0), "erase all saved %u, wrote %u, removed %u",
+               s_Saves, s_Writes, s_Removes);
+    TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "init after an erase all");
+    for (uint16_t id = 0; id < ELEVATOR_DB_MAX_SIZE; id++)
+    {
+        TEST_CHECK(_Test_Is(id, 0), "id %u kept by an erase all", id);
+    }
+}
+
+static void _Test_Tables(void)
+{
+    test_file_t *table;
+    uint32_t size;
+
+    /* a table of another version is reset, the caller inits again */
+    _Test_Format();
+    _Test_Reboot();
+    table = _Test_File("elevator/Table");
+    TEST_CHECK(table != NULL, "no table");
+    if (table == NULL)
+    {
+        return;
+    }
+
+    table->data[4] = ELEVATOR_DB_VERSION + 1;
+    TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_VersionMismatch, "table of another version loaded");
+    TEST_CHECK(g_elevatordb_ops.init() == kElevatorDBStatus_Success, "init after a version mismatch");
+
+    /* a truncated table is reset */
+    table       = _Test_File("elevator/Table");
+    size        = table->size;
+    table->size = size / 2;
+    TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "init of a truncated table");
+    TEST_CHECK(table->size == size, "truncated table not saved again");
+}
+
+/* a version 2 database with the given entries, one of them without its file */
+static void _Test_Legacy(void)
+{
+    test_legacy_metadata_t metadata;
+    char path[TEST_PATH_SIZE];
+
+    _Test_Format();
+    FWK_Flash_Mkdir("elevator");
+
+    memset(&metadata, 0, sizeof(metadata));
+    metadata.version   = 2;
+    metadata.maxCount  = ELEVATOR_DB_MAX_SIZE;
+    metadata.entrySize = sizeof(elevator_attr_t);
+    for (uint16_t id = 1; id < ELEVATOR_DB_MAX_SIZE; id += 7)
+    {
+        elevator_attr_t attr;
+
+        metadata.map[id] = (1 << 1) | (1 << 0);
+        metadata.count++;
+        if (id == 8)
+        {
+            continue;
+        }
+
+        _Test_Attr(&attr, id, 1);
+        sprintf(path, "elevator/%u", id);
+        FWK_Flash_Save(path, &attr, sizeof(attr));
+    }
+    FWK_Flash_Save("elevator/Metadata", &metadata, sizeof(metadata));
+}
+
+static void _Test_Migration(void)
+{
+    uint32_t changes;
+
+    _Test_Legacy();
+    TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "migration failed");
+    changes = s_Saves + s_Writes + s_Removes;
+    TEST_CHECK((_Test_FileCount() == 1) && (_Test_File("elevator/Table") != NULL), "%u files left by the migration",
+               _Test_FileCount());
+
+    /* the power is cut before each change of the migration, the next boot completes it */
+    for (uint32_t cut = 0; cut <= changes; cut++)
+    {
+        _Test_Legacy();
+        g_elevatordb_ops.deinit();
+        s_PowerLost = false;
+        s_CutAfter  = (int)cut;
+        g_elevatordb_ops.init();
+
+        TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "boot after a cut at change %u", cut);
+        TEST_CHECK((_Test_FileCount() == 1) && (_Test_File("elevator/Table") != NULL),
+                   "%u files left by a migration cut at change %u", _Test_FileCount(), cut);
+        for (uint16_t id = 0; id < ELEVATOR_DB_MAX_SIZE; id++)
+        {
+            uint32_t version = (((id % 7) == 1) && (id != 8)) ? 1 : 0;
+            TEST_CHECK(_Test_Is(id, version), "id %u lost by a migration cut at change %u", id, cut);
+        }
+    }
+}
+
+static void _Test_PowerCuts(void)
+{
+    elevator_attr_t attr;
+
+    for (uint32_t cut = 0; cut < 3; cut++)
+    {
+        bool added;
+        bool updated;
+
+        /* id 10 is added, id 20 is updated from version 1 to 2 and id 30 is deleted */
+        _Test_Format();
+        _Test_Reboot();
+        _Test_Attr(&attr, 20, 1);
+        g_elevatordb_ops.addWithId(20, &attr);
+        _Test_Attr(&attr, 30, 1);
+        g_elevatordb_ops.addWithId(30, &attr);
+
+        s_CutAfter = (int)cut;
+        _Test_Attr(&attr, 10, 1);
+        added = (g_elevatordb_ops.addWithId(10, &attr) == kElevatorDBStatus_Success);
+        TEST_CHECK(_Test_Is(10, added ? 1 : 0), "add cut at change %u %s in memory", cut, added ? "lost" : "kept");
+        TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "boot after an add cut at change %u", cut);
+        TEST_CHECK(_Test_Is(10, 0) || _Test_Is(10, 1), "add cut at change %u left a partial entry", cut);
+        TEST_CHECK(!added || _Test_Is(10, 1), "add cut at change %u lost after its success", cut);
+
+        s_CutAfter = (int)cut;
+        _Test_Attr(&attr, 20, 2);
+        updated = (g_elevatordb_ops.updWithId(20, &attr) == kElevatorDBStatus_Success);
+        TEST_CHECK(_Test_Is(20, updated ? 2 : 1), "update cut at change %u wrong in memory", cut);
+        TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "boot after an update cut at change %u", cut);
+        TEST_CHECK(_Test_Is(20, 1) || _Test_Is(20, 2), "update cut at change %u left a partial entry", cut);
+        TEST_CHECK(!updated || _Test_Is(20, 2), "update cut at change %u lost after its success", cut);
+
+        s_CutAfter = (int)cut;
+        if (g_elevatordb_ops.delWithId(30) == kElevatorDBStatus_Success)
+        {
+            TEST_CHECK(_Test_Is(30, 0), "delete cut at change %u kept in memory", cut);
+            TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "boot after a delete cut at change %u", cut);
+            TEST_CHECK(_Test_Is(30, 0), "delete cut at change %u lost after its success", cut);
+        }
+        else
+        {
+            TEST_CHECK(_Test_Is(30, 1), "failed delete cut at change %u applied in memory", cut);
+            TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "boot after a delete cut at change %u", cut);
+            TEST_CHECK(_Test_Is(30, 1), "failed delete cut at change %u applied", cut);
+        }
+
+        /* the count of the header follows the bitmap, a deleted id can be added again */
+        _Test_Attr(&attr, 30, 3);
+        g_elevatordb_ops.delWithId(30);
+        TEST_CHECK(g_elevatordb_ops.addWithId(30, &attr) == kElevatorDBStatus_Success, "add again of id 30");
+        TEST_CHECK(_Test_Reboot() == kElevatorDBStatus_Success, "boot after the add again of id 30");
+        TEST_CHECK(_Test_Is(30, 3), "id 30 added again lost after cut %u", cut);
+    }
+}
+
+int main(void)
+{
+    _Test_Entries();
+    _Test_Tables();
+    _Test_Migration();
+    _Test_PowerCuts();
+
+    g_elevatordb_ops.deinit();
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
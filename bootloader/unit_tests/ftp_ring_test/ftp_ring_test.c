@@ -0,0 +1,250 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the FTP upload ring of framework/hal/wireless/ftp_ring.c.
+ *
+ * Each upload is simulated as the FTP client drives the ring: the FTP task fills the free buffers at random times,
+ * lwftp asks for the next bytes with a random window when a buffer is filled, and the server acknowledges the sent
+ * bytes in random chunks, which may span several buffers. The test checks that the bytes are sent once, in order and
+ * intact, that the sent bytes are still intact when the server acknowledges them, so a buffer is never refilled while
+ * lwftp may send it again, and that all the buffers are free at the end of each upload.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Iframework/hal/wireless bootloader/unit_tests/ftp_ring_test/ftp_ring_test.c \
+ *       framework/hal/wireless/ftp_ring.c -o ftp_ring_test
+ *   ./ftp_ring_test
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ftp_ring.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_UPLOADS       2000
+#define TEST_MAX_FILE_SIZE (12 * FTP_RING_BUFFER_SIZE + 100)
+/* lwIP send buffer, the bytes sent and not acknowledged */
+#define TEST_SEND_WINDOW  5840
+#define TEST_MAX_SEGMENTS (TEST_SEND_WINDOW + 1)
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+/* bytes handed to lwftp and not acknowledged yet */
+typedef struct _test_segment
+{
+    const char *data;
+    uint32_t offset;
+    uint32_t len;
+} test_segment_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+static uint8_t s_Buffers[FTP_RING_BUFFER_CNT][FTP_RING_BUFFER_SIZE];
+static ftp_ring_t s_Ring;
+
+static test_segment_t s_Segments[TEST_MAX_SEGMENTS];
+static uint32_t s_SegmentHead;
+static uint32_t s_SegmentCount;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint8_t _Test_Byte(uint32_t upload, uint32_t offset)
+{
+    return (uint8_t)(upload * 13 + offset * 7 + (offset >> 10));
+}
+
+static bool _Test_Intact(const char *data, uint32_t upload, uint32_t offset, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if ((uint8_t)data[i] != _Test_Byte(upload, offset + i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint32_t _Test_Random(uint32_t max)
+{
+    return (uint32_t)rand() % (max + 1);
+}
+
+static bool _Test_Upload(uint32_t upload)
+{
+    uint32_t fileSize = _Test_Random(TEST_MAX_FILE_SIZE);
+    uint32_t produced = 0;
+    uint32_t sent     = 0;
+    uint32_t acked    = 0;
+    uint32_t unacked  = 0;
+    uint32_t freeCnt  = FTP_RING_BUFFER_CNT;
+    uint32_t filled   = 0;
+
+    /* an empty file and files ending at the end of a buffer once in a while */
+    if ((upload % 10) == 0)
+    {
+        fileSize = (upload / 10 % 4) * FTP_RING_BUFFER_SIZE;
+    }
+
+    FTP_Ring_Reset(&s_Ring);
+    s_SegmentHead  = 0;
+    s_SegmentCount = 0;
+
+    while (acked < fileSize)
+    {
+        uint32_t action = _Test_Random(2);
+
+        if ((action == 0) && (produced < fileSize) && (freeCnt > 0))
+        {
+            /* the FTP task reads the next chunk of the file */
+            uint32_t size = fileSize - produced;
+            uint8_t *buffer;
+
+            if (size > FTP_RING_BUFFER_SIZE)
+            {
+                size = FTP_RING_BUFFER_SIZE;
+            }
+
+            buffer = FTP_Ring_FillBuffer(&s_Ring);
+            for (uint32_t i = 0; i < size; i++)
+            {
+                buffer[i] = _Test_Byte(upload, produced + i);
+            }
+            FTP_Ring_Filled(&s_Ring, size);
+            produced += size;
+            freeCnt--;
+            filled++;
+        }
+        else if ((action == 1) && (sent < fileSize) && (unacked < TEST_SEND_WINDOW))
+        {
+            /* lwftp asks for the bytes fitting in the send buffer, it waits for a filled buffer at the start of one */
+            uint32_t maxlen = 1 + _Test_Random(TEST_SEND_WINDOW - unacked - 1);
+            test_segment_t *segment;
+            const char *data;
+            uint32_t len;
+
+            if (FTP_Ring_AtBufferStart(&s_Ring))
+            {
+                if (filled == 0)
+                {
+                    continue;
+                }
+                filled--;
+            }
+
+            len = FTP_Ring_Next(&s_Ring, &data, maxlen);
+            if ((len == 0) || (len > maxlen) || !_Test_Intact(data, upload, sent, len))
+            {
+                TEST_CHECK(false, "upload %u of %u bytes, %u bytes sent at offset %u for %u asked", upload, fileSize,
+                           len, sent, maxlen);
+                return false;
+            }
+
+            segment         = &s_Segments[(s_SegmentHead + s_SegmentCount) % TEST_MAX_SEGMENTS];
+            segment->data   = data;
+            segment->offset = sent;
+            segment->len    = len;
+            s_SegmentCount++;
+            sent += len;
+            unacked += len;
+        }
+        else if ((action == 2) && (unacked > 0))
+        {
+            /* the server acknowledges some of the bytes, they must still be in their buffer */
+            uint32_t len  = 1 + _Test_Random(unacked - 1);
+            uint32_t left = len;
+
+            while (left > 0)
+            {
+                test_segment_t *segment = &s_Segments[s_SegmentHead];
+                uint32_t count          = (segment->len < left) ? segment->len : left;
+
+                if (!_Test_Intact(segment->data, upload, segment->offset, segment->len))
+                {
+                    TEST_CHECK(false, "upload %u of %u bytes, bytes at offset %u overwritten before their ack", upload,
+                               fileSize, segment->offset);
+                    return false;
+                }
+
+                segment->data += count;
+                segment->offset += count;
+                segment->len -= count;
+                left -= count;
+                if (segment->len == 0)
+                {
+                    s_SegmentHead = (s_SegmentHead + 1) % TEST_MAX_SEGMENTS;
+                    s_SegmentCount--;
+                }
+            }
+
+            freeCnt += FTP_Ring_Release(&s_Ring, len);
+            acked += len;
+            unacked -= len;
+            if (freeCnt > FTP_RING_BUFFER_CNT)
+            {
+                TEST_CHECK(false, "upload %u of %u bytes, %u buffers free", upload, fileSize, freeCnt);
+                return false;
+            }
+        }
+    }
+
+    TEST_CHECK(freeCnt == FTP_RING_BUFFER_CNT, "upload %u of %u bytes, %u buffers free at the end", upload, fileSize,
+               freeCnt);
+    for (uint32_t i = 0; i < FTP_RING_BUFFER_CNT; i++)
+    {
+        TEST_CHECK(s_Ring.len[i] == 0, "upload %u of %u bytes, buffer %u not released", upload, fileSize, i);
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < FTP_RING_BUFFER_CNT; i++)
+    {
+        s_Ring.buffer[i] = s_Buffers[i];
+    }
+
+    srand(1);
+    for (uint32_t upload = 0; upload < TEST_UPLOADS; upload++)
+    {
+        if (!_Test_Upload(upload))
+        {
+            break;
+        }
+    }
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
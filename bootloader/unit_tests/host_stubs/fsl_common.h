@@ -0,0 +1,22 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host stand-in of the MCUXpresso SDK fsl_common.h for the unit tests, only what the tested modules use.
+ */
+
+#ifndef _FSL_COMMON_H_
+#define _FSL_COMMON_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif /* _FSL_COMMON_H_ */
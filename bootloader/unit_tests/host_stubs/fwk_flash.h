@@ -0,0 +1,39 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host stand-in of framework/inc/fwk_flash.h for the unit tests, the file system is provided by the test.
+ */
+
+#ifndef FWK_FLASH_H_
+#define FWK_FLASH_H_
+
+#include "fwk_platform.h"
+
+typedef enum _sln_flash_status
+{
+    kStatus_HAL_FlashSuccess = 0,
+    kStatus_HAL_FlashFail,
+    kStatus_HAL_FlashInvalidParam,
+    kStatus_HAL_FlashDirExist,
+    kStatus_HAL_FlashFileExist,
+    kStatus_HAL_FlashFileNotExist,
+} sln_flash_status_t;
+
+sln_flash_status_t FWK_Flash_Save(const char *path, void *buf, unsigned int size);
+
+sln_flash_status_t FWK_Flash_Write(const char *path, void *buf, unsigned int offset, unsigned int size);
+
+sln_flash_status_t FWK_Flash_Read(const char *path, void *buf, unsigned int offset, unsigned int *size);
+
+sln_flash_status_t FWK_Flash_Mkdir(const char *path);
+
+sln_flash_status_t FWK_Flash_Rm(const char *path);
+
+#endif /*FWK_FLASH_H_ */
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host stand-in of framework/inc/fwk_platform.h for the unit tests, the time is provided by the test.
+ */
+
+#ifndef _FWK_PLATFORM_H_
+#define _FWK_PLATFORM_H_
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned int FWK_CurrentTimeUs();
+
+/* newlib extension declared by stdlib.h on the target, defined by the tests which need it */
+char *itoa(int value, char *str, int base);
+
+#endif /* _FWK_PLATFORM_H_ */
@@ -0,0 +1,561 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host simulation of the resumable OTA download of coffee_machine/cm7/source/aws_ota_pal_resume.c.
+ *
+ * A fake MQTT stream sends the requested blocks with losses, disconnects and resets at random times. The PAL side
+ * models the NOR flash (program is a bitwise AND, erase sets 0xFF), the write-behind queue, the persisted resume record
+ * and the adaptive request window. Each run checks that the image in the bank matches the source file at the end.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Icoffee_machine/cm7/source bootloader/unit_tests/ota_resume_sim/ota_resume_sim.c \
+ *       coffee_machine/cm7/source/aws_ota_pal_resume.c -lm -o ota_resume_sim
+ *   ./ota_resume_sim [quick]
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aws_ota_pal_resume.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define SIM_BLOCK_SIZE       16384U
+#define SIM_SECTOR_SIZE      4096U
+#define SIM_ERASE_UNIT       65536U
+#define SIM_REQUEST_WAIT_MS  10000U
+#define SIM_WINDOW_LIMIT     6U
+#define SIM_EVENT_BUFFERS    (SIM_WINDOW_LIMIT + 1)
+#define SIM_WRITE_SLOTS      2
+#define SIM_SAVE_PERIOD      8
+#define SIM_RUN_LIMIT_MS     (3600U * 1000U)
+#define SIM_REBOOT_MS        3000U
+#define SIM_MAX_ARRIVALS     (1 << 16)
+#define SIM_SEEDS_PER_CONFIG 25
+
+/* flash busy time of a block program, a sector erase and a 64KB erase, in ms */
+#define SIM_PROGRAM_MS      45U
+#define SIM_SECTOR_ERASE_MS 45U
+#define SIM_UNIT_ERASE_MS   150U
+
+typedef struct
+{
+    uint32_t at;
+    uint32_t block;
+} sim_arrival_t;
+
+typedef struct
+{
+    uint32_t rttMs;
+    uint32_t blockMs;
+    double loss;
+    /* mean time between resets and disconnects, 0 for none */
+    uint32_t resetMeanMs;
+    uint32_t disconnectMeanMs;
+} sim_config_t;
+
+typedef struct
+{
+    uint32_t received;
+    uint32_t duplicates;
+    uint32_t dropped;
+    uint32_t resets;
+    uint32_t disconnects;
+    uint32_t requests;
+    uint32_t savedReceivedAgain;
+    uint32_t restored;
+} sim_stats_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static sim_config_t s_Config;
+static uint32_t s_FileSize;
+static uint32_t s_BlockCount;
+static uint32_t s_BankSize;
+static uint8_t *s_Source;
+static uint8_t *s_Flash;
+
+/* persisted resume record */
+static OtaPalResumeRecord_t s_SavedRecord;
+static bool s_SavedValid;
+
+/* PAL RAM, lost on reset */
+static OtaPalResumeRecord_t s_Record;
+static uint8_t s_ErasedMap[OTA_PAL_RESUME_BITMAP_SIZE];
+static OtaPalWindow_t s_Window;
+static uint32_t s_WriteQueue[SIM_WRITE_SLOTS];
+static uint32_t s_WriteCount;
+static uint32_t s_WriteDoneAt;
+static uint32_t s_Unsaved;
+static uint32_t s_HashedBlocks;
+
+/* OTA agent RAM, lost on reset */
+static uint8_t s_RxBitmap[OTA_PAL_RESUME_BITMAP_SIZE];
+static uint32_t s_BlocksRemaining;
+static uint32_t s_ToReceive;
+static uint32_t s_TimerAt;
+static uint32_t s_FileBytes;
+static uint32_t s_AgentBusyUntil;
+
+/* blocks on the way from the broker */
+static sim_arrival_t s_Network[SIM_MAX_ARRIVALS];
+static int s_NetworkCount;
+
+static sim_stats_t s_Stats;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static double _Sim_Random(void)
+{
+    return rand() / (double)RAND_MAX;
+}
+
+/* exponentially distributed delay, never for a mean of 0 */
+static uint32_t _Sim_Exponential(uint32_t meanMs)
+{
+    if (meanMs == 0)
+    {
+        return UINT32_MAX;
+    }
+
+    return (uint32_t)(-(double)meanMs * log(1.0 - _Sim_Random() * 0.999999)) + 1;
+}
+
+static bool _Sim_IsPending(const uint8_t *bitmap, uint32_t block)
+{
+    return (bitmap[block / 8] & (1U << (block % 8))) != 0;
+}
+
+static void _Sim_NorErase(uint32_t offset, uint32_t length)
+{
+    uint32_t address = offset;
+
+    while (address < offset + length)
+    {
+        if (((address % SIM_ERASE_UNIT) == 0) && ((offset + length - address) >= SIM_ERASE_UNIT))
+        {
+            memset(s_Flash + address, 0xFF, SIM_ERASE_UNIT);
+            address += SIM_ERASE_UNIT;
+        }
+        else
+        {
+            memset(s_Flash + address, 0xFF, SIM_SECTOR_SIZE);
+            address += SIM_SECTOR_SIZE;
+        }
+    }
+}
+
+static void _Sim_NorProgram(uint32_t offset, const uint8_t *data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        s_Flash[offset + i] &= data[i];
+    }
+}
+
+/* flash busy time of writing a block, including the erase it needs */
+static uint32_t _Sim_FlushCost(uint32_t block)
+{
+    uint8_t erasedMap[OTA_PAL_RESUME_BITMAP_SIZE];
+    uint32_t eraseOffset;
+    uint32_t eraseLength;
+    uint32_t cost = SIM_PROGRAM_MS;
+
+    memcpy(erasedMap, s_ErasedMap, sizeof(erasedMap));
+    if (otaPalResume_EraseRange(&s_Record, erasedMap, SIM_ERASE_UNIT, block * SIM_BLOCK_SIZE, &eraseOffset,
+                                &eraseLength))
+    {
+        if (eraseLength >= SIM_ERASE_UNIT)
+        {
+            cost += SIM_UNIT_ERASE_MS;
+        }
+        else
+        {
+            cost += SIM_SECTOR_ERASE_MS * ((eraseLength + SIM_SECTOR_SIZE - 1) / SIM_SECTOR_SIZE);
+        }
+    }
+
+    return cost;
+}
+
+/* write a block to the bank, a reset in the middle leaves it half programmed */
+static void _Sim_Flush(uint32_t block, bool interrupted)
+{
+    uint32_t length = otaPalResume_BlockLen(&s_Record, block);
+    uint32_t eraseOffset;
+    uint32_t eraseLength;
+
+    if (otaPalResume_EraseRange(&s_Record, s_ErasedMap, SIM_ERASE_UNIT, block * SIM_BLOCK_SIZE, &eraseOffset,
+                                &eraseLength))
+    {
+        if ((eraseOffset % SIM_SECTOR_SIZE) || (eraseOffset + eraseLength > s_BankSize))
+        {
+            printf("bad erase range 0x%x + 0x%x\n", eraseOffset, eraseLength);
+            exit(1);
+        }
+        _Sim_NorErase(eraseOffset, eraseLength);
+    }
+
+    if (interrupted)
+    {
+        _Sim_NorProgram(block * SIM_BLOCK_SIZE, s_Source + block * SIM_BLOCK_SIZE, length / 2);
+        return;
+    }
+
+    _Sim_NorProgram(block * SIM_BLOCK_SIZE, s_Source + block * SIM_BLOCK_SIZE, length);
+    otaPalResume_MarkWritten(&s_Record, block * SIM_BLOCK_SIZE);
+    while (otaPalResume_IsWritten(&s_Record, s_HashedBlocks))
+    {
+        s_HashedBlocks++;
+    }
+
+    if (++s_Unsaved >= SIM_SAVE_PERIOD)
+    {
+        s_SavedRecord = s_Record;
+        s_SavedValid  = true;
+        s_Unsaved     = 0;
+    }
+}
+
+static void _Sim_FlushFirst(void)
+{
+    _Sim_Flush(s_WriteQueue[0], false);
+    s_WriteCount--;
+    memmove(s_WriteQueue, s_WriteQueue + 1, s_WriteCount * sizeof(s_WriteQueue[0]));
+}
+
+/* request the next window of pending blocks, each one is lost with the configured probability */
+static void _Sim_Request(uint32_t now)
+{
+    uint32_t window = otaPalWindow_Get(&s_Window);
+    uint32_t count  = 0;
+
+    s_ToReceive = window;
+    s_TimerAt   = now + SIM_REQUEST_WAIT_MS;
+    s_Stats.requests++;
+
+    for (uint32_t block = 0; (block < s_BlockCount) && (count < window); block++)
+    {
+        if (_Sim_IsPending(s_RxBitmap, block))
+        {
+            if (_Sim_Random() >= s_Config.loss)
+            {
+                s_Network[s_NetworkCount].at    = now + s_Config.rttMs + count * s_Config.blockMs;
+                s_Network[s_NetworkCount].block = block;
+                s_NetworkCount++;
+            }
+            count++;
+        }
+    }
+}
+
+/* boot: the agent creates the file, the PAL restores the blocks of the persisted record */
+static void _Sim_CreateFile(uint32_t now)
+{
+    uint32_t restoredBytes = 0;
+
+    memset(s_RxBitmap, 0, sizeof(s_RxBitmap));
+    for (uint32_t block = 0; block < s_BlockCount; block++)
+    {
+        s_RxBitmap[block / 8] |= 1U << (block % 8);
+    }
+    s_BlocksRemaining = s_BlockCount;
+
+    otaPalResume_InitRecord(&s_Record, 1, s_FileSize, SIM_BLOCK_SIZE, 0, (const uint8_t *)"job-1",
+                            (const uint8_t *)"sig", 3);
+    if (s_SavedValid && otaPalResume_Matches(&s_SavedRecord, &s_Record))
+    {
+        memcpy(s_Record.written, s_SavedRecord.written, sizeof(s_Record.written));
+        s_Stats.restored += otaPalResume_Restore(&s_Record, s_RxBitmap, &s_BlocksRemaining, &restoredBytes);
+    }
+
+    memset(s_ErasedMap, 0, sizeof(s_ErasedMap));
+    s_WriteCount     = 0;
+    s_Unsaved        = 0;
+    s_HashedBlocks   = 0;
+    s_FileBytes      = restoredBytes;
+    s_NetworkCount   = 0;
+    s_AgentBusyUntil = now;
+    otaPalWindow_Init(&s_Window, SIM_WINDOW_LIMIT, SIM_REQUEST_WAIT_MS);
+
+    _Sim_Request(now);
+}
+
+/* deliver the blocks due, they are dropped while disconnected or when no OTA event buffer is free */
+static void _Sim_Deliver(uint32_t now, bool disconnected, sim_arrival_t *inbox, int *inboxCount)
+{
+    int i = 0;
+
+    while (i < s_NetworkCount)
+    {
+        if (s_Network[i].at > now)
+        {
+            i++;
+            continue;
+        }
+
+        if (disconnected || (*inboxCount >= (int)SIM_EVENT_BUFFERS))
+        {
+            s_Stats.dropped++;
+        }
+        else
+        {
+            inbox[(*inboxCount)++] = s_Network[i];
+        }
+        s_Network[i] = s_Network[--s_NetworkCount];
+    }
+}
+
+/* hand a received block to the PAL, return false if the write-behind queue is full */
+static bool _Sim_Receive(uint32_t now, uint32_t block)
+{
+    if (!_Sim_IsPending(s_RxBitmap, block))
+    {
+        s_Stats.duplicates++;
+        return true;
+    }
+
+    if (s_WriteCount == SIM_WRITE_SLOTS)
+    {
+        return false;
+    }
+
+    if (s_SavedValid && otaPalResume_IsWritten(&s_SavedRecord, block) &&
+        otaPalResume_Matches(&s_SavedRecord, &s_Record))
+    {
+        s_Stats.savedReceivedAgain++;
+    }
+
+    s_WriteQueue[s_WriteCount++] = block;
+    if (s_WriteCount == 1)
+    {
+        s_WriteDoneAt = now + _Sim_FlushCost(block);
+    }
+
+    otaPalWindow_OnBlock(&s_Window, now);
+    s_FileBytes += otaPalResume_BlockLen(&s_Record, block);
+    s_RxBitmap[block / 8] &= ~(1U << (block % 8));
+    s_BlocksRemaining--;
+    s_Stats.received++;
+
+    return true;
+}
+
+/* drain the queue and compare the bank with the source */
+static bool _Sim_Close(uint32_t now, unsigned seed, bool verbose)
+{
+    bool ok;
+
+    while (s_WriteCount)
+    {
+        _Sim_FlushFirst();
+    }
+
+    ok = (s_FileBytes == s_FileSize) && (s_HashedBlocks == s_BlockCount) && !memcmp(s_Flash, s_Source, s_FileSize);
+    if (verbose || !ok)
+    {
+        printf("seed %u: %s at %.1fs, %u blocks, rx %u dup %u drop %u, reqs %u stalls %u, resets %u disc %u, "
+               "restored %u, saved blocks received again %u, window %u rtt %u block %u\n",
+               seed, ok ? "OK" : "FAIL", now / 1000.0, s_BlockCount, s_Stats.received, s_Stats.duplicates,
+               s_Stats.dropped, s_Stats.requests, s_Window.stalls, s_Stats.resets, s_Stats.disconnects,
+               s_Stats.restored, s_Stats.savedReceivedAgain, s_Window.window, s_Window.rttMs, s_Window.blockMs);
+    }
+
+    return ok;
+}
+
+/* download one file, return the time it took in ms or -1 on failure */
+static int _Sim_Run(uint32_t fileSize, unsigned seed, bool verbose)
+{
+    sim_arrival_t inbox[SIM_EVENT_BUFFERS];
+    int inboxCount             = 0;
+    uint32_t nextReset         = _Sim_Exponential(s_Config.resetMeanMs);
+    uint32_t nextDisconnect    = _Sim_Exponential(s_Config.disconnectMeanMs);
+    uint32_t disconnectedUntil = 0;
+    uint32_t bootAt            = 0;
+    bool booted                = false;
+    int result                 = -1;
+
+    srand(seed);
+    s_FileSize   = fileSize;
+    s_BlockCount = (fileSize + SIM_BLOCK_SIZE - 1) / SIM_BLOCK_SIZE;
+    s_BankSize   = ((fileSize + SIM_ERASE_UNIT - 1) / SIM_ERASE_UNIT) * SIM_ERASE_UNIT + SIM_ERASE_UNIT;
+    s_Source     = malloc(fileSize);
+    s_Flash      = malloc(s_BankSize);
+    if ((s_Source == NULL) || (s_Flash == NULL))
+    {
+        printf("out of memory\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < fileSize; i++)
+    {
+        s_Source[i] = rand();
+    }
+    /* stale image in the bank */
+    for (uint32_t i = 0; i < s_BankSize; i++)
+    {
+        s_Flash[i] = rand();
+    }
+    s_SavedValid = false;
+    memset(&s_Stats, 0, sizeof(s_Stats));
+
+    for (uint32_t now = 0; now < SIM_RUN_LIMIT_MS; now++)
+    {
+        if (!booted)
+        {
+            if (now < bootAt)
+            {
+                continue;
+            }
+            _Sim_CreateFile(now);
+            booted     = true;
+            inboxCount = 0;
+        }
+
+        if (now >= nextReset)
+        {
+            /* the block being programmed is left half written, RAM is lost */
+            if (s_WriteCount)
+            {
+                _Sim_Flush(s_WriteQueue[0], true);
+            }
+            s_Stats.resets++;
+            booted    = false;
+            bootAt    = now + SIM_REBOOT_MS;
+            nextReset = now + _Sim_Exponential(s_Config.resetMeanMs);
+            continue;
+        }
+
+        if (now >= nextDisconnect)
+        {
+            s_Stats.disconnects++;
+            disconnectedUntil = now + 2000 + rand() % 5000;
+            nextDisconnect    = now + _Sim_Exponential(s_Config.disconnectMeanMs);
+        }
+
+        /* writer task */
+        if (s_WriteCount && (now >= s_WriteDoneAt))
+        {
+            _Sim_FlushFirst();
+            if (s_WriteCount)
+            {
+                s_WriteDoneAt = now + _Sim_FlushCost(s_WriteQueue[0]);
+            }
+        }
+
+        _Sim_Deliver(now, now < disconnectedUntil, inbox, &inboxCount);
+
+        /* OTA agent, WriteBlock waits for a free slot of the write-behind queue */
+        if (inboxCount && (now >= s_AgentBusyUntil))
+        {
+            if (!_Sim_Receive(now, inbox[0].block))
+            {
+                s_AgentBusyUntil = s_WriteDoneAt;
+            }
+            else
+            {
+                inboxCount--;
+                memmove(inbox, inbox + 1, inboxCount * sizeof(inbox[0]));
+
+                if (s_BlocksRemaining == 0)
+                {
+                    result = _Sim_Close(now, seed, verbose) ? (int)now : -1;
+                    break;
+                }
+
+                if (s_ToReceive > 1)
+                {
+                    s_ToReceive--;
+                }
+                else
+                {
+                    _Sim_Request(now);
+                }
+            }
+        }
+
+        if ((now >= s_TimerAt) && s_BlocksRemaining)
+        {
+            _Sim_Request(now);
+        }
+    }
+
+    if (s_BlocksRemaining != 0)
+    {
+        printf("seed %u: TIMEOUT\n", seed);
+    }
+
+    free(s_Source);
+    free(s_Flash);
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t fileSizes[] = {5 * 1024 * 1024 + 1234, 3 * 1024 * 1024, 200000, SIM_BLOCK_SIZE};
+    static const sim_config_t configs[] = {
+        {300, 50, 0.0, 0, 0},         {30, 50, 0.0, 0, 0},           {300, 50, 0.01, 0, 0},
+        {300, 50, 0.01, 40000, 30000}, {800, 40, 0.02, 20000, 15000}, {100, 80, 0.005, 60000, 0},
+    };
+    /* quick: only the lossy configuration, verbose on the 200000 bytes file */
+    bool quick = (argc > 1) && !strcmp(argv[1], "quick");
+    int failures = 0;
+
+    for (unsigned c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        double total = 0;
+        int runs     = 0;
+
+        if (quick && (c != 2))
+        {
+            continue;
+        }
+
+        s_Config = configs[c];
+        for (unsigned s = 0; s < sizeof(fileSizes) / sizeof(fileSizes[0]); s++)
+        {
+            for (unsigned seed = 1; seed <= SIM_SEEDS_PER_CONFIG; seed++)
+            {
+                bool verbose = quick ? (s == 2) : ((seed == 1) && (s == 0));
+                int time     = _Sim_Run(fileSizes[s], seed * 7919 + c, verbose);
+
+                if (time < 0)
+                {
+                    failures++;
+                }
+                else
+                {
+                    total += time;
+                    runs++;
+                }
+            }
+        }
+
+        printf("cfg rtt %u tb %u loss %.3f reset %u disc %u: mean %.1fs over %d runs\n", s_Config.rttMs,
+               s_Config.blockMs, s_Config.loss, s_Config.resetMeanMs, s_Config.disconnectMeanMs,
+               runs ? total / runs / 1000.0 : 0.0, runs);
+    }
+
+    printf("%d failures\n", failures);
+
+    return failures != 0;
+}
@@ -0,0 +1,430 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * Host test of the vision motion gate of framework/hal/vision/hal_vision_motion_gate.c.
+ *
+ * Scenes are rendered in each pixel format the gate reads, with sensor noise and garbage in the padding of each row.
+ * The test checks that a static scene is run for the configured frames and then throttled, that the first frame with
+ * motion is never skipped, that a change smaller than the motion ratio or a noise below the pixel threshold is not
+ * taken as motion, that the background follows a change of the lighting, that no frame is skipped while a face is
+ * present, and that the frames the gate can not check are always run.
+ *
+ * Build and run from the repository root:
+ *   gcc -O2 -Wall -Ibootloader/unit_tests/host_stubs -Iframework/inc -Iframework/hal_api -Iframework/hal/vision \
+ *       bootloader/unit_tests/vision_motion_gate_test/vision_motion_gate_test.c \
+ *       framework/hal/vision/hal_vision_motion_gate.c -o vision_motion_gate_test
+ *   ./vision_motion_gate_test
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_vision_motion_gate.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define TEST_WIDTH       64
+#define TEST_HEIGHT      48
+#define TEST_PADDING     12
+#define TEST_MAX_BPP     4
+#define TEST_STEP        4
+#define TEST_SAMPLES     VISION_MOTION_GATE_SAMPLES(TEST_WIDTH, TEST_HEIGHT, TEST_STEP)
+#define TEST_THRESHOLD   12
+#define TEST_PERMILLE    20
+#define TEST_SHIFT       3
+#define TEST_STATIC      5
+#define TEST_THROTTLE    4
+/* noise added to each pixel, the difference of two frames stays below the threshold even after the RGB565 rounding */
+#define TEST_NOISE       4
+#define TEST_SQUARE_SIZE 16
+#define TEST_SQUARE_LUMA 220
+
+#define TEST_CHECK(cond, ...)      \
+    do                             \
+    {                              \
+        if (!(cond))               \
+        {                          \
+            printf("FAIL: ");      \
+            printf(__VA_ARGS__);   \
+            printf("\n");          \
+            s_Failures++;          \
+        }                          \
+    } while (0)
+
+/* scene rendered in a frame, a textured background and an optional square */
+typedef struct _test_scene
+{
+    int brightness;
+    bool square;
+    int squareX;
+    int squareY;
+    int squareSize;
+} test_scene_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static int s_Failures;
+
+static const pixel_format_t s_Formats[] = {
+    kPixelFormat_RGB,  kPixelFormat_BGR,     kPixelFormat_Gray888,        kPixelFormat_Gray888X,
+    kPixelFormat_Gray, kPixelFormat_Depth8,  kPixelFormat_RGB565,         kPixelFormat_UYVY1P422_RGB,
+    kPixelFormat_UYVY1P422_Gray, kPixelFormat_VYUY1P422,
+};
+
+static uint8_t s_Pixels[TEST_HEIGHT * (TEST_WIDTH + TEST_PADDING) * TEST_MAX_BPP];
+static uint16_t s_Background[TEST_SAMPLES];
+static vision_frame_t s_Frame;
+static vision_motion_gate_t s_Gate;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+unsigned int FWK_CurrentTimeUs()
+{
+    return 0;
+}
+
+static int _Test_BytesPerPixel(pixel_format_t format)
+{
+    switch (format)
+    {
+        case kPixelFormat_RGB:
+        case kPixelFormat_BGR:
+        case kPixelFormat_Gray888:
+            return 3;
+        case kPixelFormat_Gray888X:
+            return 4;
+        case kPixelFormat_RGB565:
+        case kPixelFormat_UYVY1P422_RGB:
+        case kPixelFormat_UYVY1P422_Gray:
+        case kPixelFormat_VYUY1P422:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+static void _Test_Pixel(uint8_t *pixel, pixel_format_t format, int luma)
+{
+    switch (format)
+    {
+        case kPixelFormat_RGB:
+        case kPixelFormat_BGR:
+        case kPixelFormat_Gray888:
+            pixel[0] = luma;
+            pixel[1] = luma;
+            pixel[2] = luma;
+            break;
+        case kPixelFormat_Gray888X:
+            pixel[0] = luma;
+            pixel[1] = luma;
+            pixel[2] = luma;
+            pixel[3] = rand();
+            break;
+        case kPixelFormat_RGB565:
+        {
+            uint16_t rgb565 = ((luma >> 3) << 11) | ((luma >> 2) << 5) | (luma >> 3);
+            pixel[0]        = rgb565 & 0xFF;
+            pixel[1]        = rgb565 >> 8;
+            break;
+        }
+        case kPixelFormat_UYVY1P422_RGB:
+        case kPixelFormat_UYVY1P422_Gray:
+        case kPixelFormat_VYUY1P422:
+            pixel[0] = 128;
+            pixel[1] = luma;
+            break;
+        default:
+            pixel[0] = luma;
+            break;
+    }
+}
+
+static void _Test_Render(pixel_format_t format, const test_scene_t *scene)
+{
+    int bytesPerPixel = _Test_BytesPerPixel(format);
+    int pitch         = (TEST_WIDTH + TEST_PADDING) * bytesPerPixel;
+
+    /* garbage in the padding, the gate must only read the pixels */
+    for (uint32_t i = 0; i < sizeof(s_Pixels); i++)
+    {
+        s_Pixels[i] = rand();
+    }
+
+    for (int y = 0; y < TEST_HEIGHT; y++)
+    {
+        for (int x = 0; x < TEST_WIDTH; x++)
+        {
+            int luma = scene->brightness + ((x / 8 + y / 8) % 2) * 40 + (rand() % (2 * TEST_NOISE + 1)) - TEST_NOISE;
+
+            if (scene->square && (x >= scene->squareX) && (x < scene->squareX + scene->squareSize) &&
+                (y >= scene->squareY) && (y < scene->squareY + scene->squareSize))
+            {
+                luma = TEST_SQUARE_LUMA;
+            }
+            if (luma < 0)
+            {
+                luma = 0;
+            }
+            else if (luma > 255)
+            {
+                luma = 255;
+            }
+
+            _Test_Pixel(&s_Pixels[y * pitch + x * bytesPerPixel], format, luma);
+        }
+    }
+
+    memset(&s_Frame, 0, sizeof(s_Frame));
+    s_Frame.width  = TEST_WIDTH;
+    s_Frame.height = TEST_HEIGHT;
+    s_Frame.pitch  = pitch;
+    s_Frame.format = format;
+    s_Frame.data   = s_Pixels;
+}
+
+static void _Test_Init(uint16_t throttle)
+{
+    vision_motion_gate_config_t config = {
+        .step            = TEST_STEP,
+        .pixelThreshold  = TEST_THRESHOLD,
+        .motionPermille  = TEST_PERMILLE,
+        .backgroundShift = TEST_SHIFT,
+        .staticFrames    = TEST_STATIC,
+        .throttle        = throttle,
+    };
+
+    HAL_VisionMotionGate_Init(&s_Gate, &config, s_Background, TEST_SAMPLES);
+}
+
+static bool _Test_Check(pixel_format_t format, const test_scene_t *scene)
+{
+    _Test_Render(format, scene);
+
+    return HAL_VisionMotionGate_Check(&s_Gate, &s_Frame);
+}
+
+/* expected decision for the static frame staticCount of a static run */
+static bool _Test_StaticRun(uint32_t staticCount, uint16_t throttle)
+{
+    if (staticCount <= TEST_STATIC)
+    {
+        return true;
+    }
+
+    return (throttle != 0) && (((staticCount - TEST_STATIC) % throttle) == 0);
+}
+
+static void _Test_Static(pixel_format_t format)
+{
+    test_scene_t scene = {.brightness = 80};
+    vision_motion_gate_stats_t stats;
+    uint32_t skipped = 0;
+
+    _Test_Init(TEST_THROTTLE);
+
+    TEST_CHECK(_Test_Check(format, &scene), "format %d, first frame skipped", format);
+    for (uint32_t i = 1; i <= 40; i++)
+    {
+        bool expected = _Test_StaticRun(i, TEST_THROTTLE);
+        bool run      = _Test_Check(format, &scene);
+
+        TEST_CHECK(run == expected, "format %d, static frame %u %s", format, i, run ? "run" : "skipped");
+        skipped += !expected;
+    }
+
+    HAL_VisionMotionGate_GetStats(&s_Gate, &stats);
+    TEST_CHECK(stats.frameCount == 41, "format %d, %u frames counted", format, stats.frameCount);
+    TEST_CHECK(stats.motionCount == 1, "format %d, %u frames with motion in a static scene", format,
+               stats.motionCount);
+    TEST_CHECK(stats.skipCount == skipped, "format %d, %u frames skipped for %u", format, stats.skipCount, skipped);
+    TEST_CHECK(stats.maxSkipRun == TEST_THROTTLE - 1, "format %d, longest skip run of %u frames", format,
+               stats.maxSkipRun);
+
+    /* the samples reach the last columns */
+    scene.square     = true;
+    scene.squareX    = TEST_WIDTH - TEST_SQUARE_SIZE;
+    scene.squareY    = 0;
+    scene.squareSize = TEST_SQUARE_SIZE;
+    _Test_Check(format, &scene);
+    HAL_VisionMotionGate_GetStats(&s_Gate, &stats);
+    TEST_CHECK(stats.motionCount == 2, "format %d, square in the last columns not taken as motion", format);
+}
+
+static void _Test_Motion(pixel_format_t format)
+{
+    test_scene_t scene = {.brightness = 80};
+    uint32_t frames;
+
+    _Test_Init(0);
+    for (uint32_t i = 0; i <= TEST_STATIC + 3; i++)
+    {
+        _Test_Check(format, &scene);
+    }
+    TEST_CHECK(!_Test_Check(format, &scene), "format %d, static scene not skipped", format);
+
+    /* a change of one sample is below the motion ratio */
+    scene.square     = true;
+    scene.squareX    = 0;
+    scene.squareY    = TEST_HEIGHT - TEST_STEP;
+    scene.squareSize = TEST_STEP;
+    TEST_CHECK(!_Test_Check(format, &scene), "format %d, change of one sample taken as motion", format);
+
+    /* a square moving across the scene, every frame must run */
+    scene.squareSize = TEST_SQUARE_SIZE;
+    for (int x = 0; x + TEST_SQUARE_SIZE <= TEST_WIDTH; x += TEST_SQUARE_SIZE / 2)
+    {
+        scene.squareX = x;
+        scene.squareY = x % (TEST_HEIGHT - TEST_SQUARE_SIZE);
+        TEST_CHECK(_Test_Check(format, &scene), "format %d, moving square at %d skipped", format, x);
+    }
+
+    /* the square stops, it becomes part of the background and the frames are skipped again */
+    for (frames = 0; frames < 60; frames++)
+    {
+        if (!_Test_Check(format, &scene))
+        {
+            break;
+        }
+    }
+    TEST_CHECK((frames > TEST_STATIC) && (frames < 30), "format %d, %u frames run after the square stopped", format,
+               frames);
+
+}
+
+static void _Test_Lighting(pixel_format_t format)
+{
+    test_scene_t scene = {.brightness = 60};
+    vision_motion_gate_stats_t stats;
+    uint32_t frames;
+
+    _Test_Init(0);
+    for (uint32_t i = 0; i <= TEST_STATIC + 3; i++)
+    {
+        _Test_Check(format, &scene);
+    }
+
+    /* the light is turned on, the background must catch up with the new brightness */
+    scene.brightness = 100;
+    TEST_CHECK(_Test_Check(format, &scene), "format %d, change of the lighting skipped", format);
+    for (frames = 1; frames < 60; frames++)
+    {
+        if (!_Test_Check(format, &scene))
+        {
+            break;
+        }
+    }
+
+    HAL_VisionMotionGate_GetStats(&s_Gate, &stats);
+    TEST_CHECK((stats.motionCount > 1) && (stats.motionCount < 20), "format %d, %u frames with motion", format,
+               stats.motionCount);
+    TEST_CHECK(frames < 30, "format %d, %u frames run after the change of the lighting", format, frames);
+}
+
+static void _Test_Presence(void)
+{
+    test_scene_t scene = {.brightness = 80};
+    uint32_t i;
+
+    _Test_Init(TEST_THROTTLE);
+    for (i = 0; i <= TEST_STATIC + 1; i++)
+    {
+        _Test_Check(kPixelFormat_RGB, &scene);
+    }
+
+    HAL_VisionMotionGate_SetPresence(&s_Gate, true);
+    for (i = 0; i < 20; i++)
+    {
+        TEST_CHECK(_Test_Check(kPixelFormat_RGB, &scene), "static frame %u skipped with a face", i);
+    }
+
+    HAL_VisionMotionGate_SetPresence(&s_Gate, false);
+    for (i = 1; i <= 20; i++)
+    {
+        bool run = _Test_Check(kPixelFormat_RGB, &scene);
+        TEST_CHECK(run == _Test_StaticRun(i, TEST_THROTTLE), "static frame %u after the face left %s", i,
+                   run ? "run" : "skipped");
+    }
+
+    /* without throttle, all the static frames are skipped */
+    _Test_Init(0);
+    for (i = 0; i <= TEST_STATIC; i++)
+    {
+        _Test_Check(kPixelFormat_RGB, &scene);
+    }
+    for (i = 0; i < 20; i++)
+    {
+        TEST_CHECK(!_Test_Check(kPixelFormat_RGB, &scene), "static frame %u run without throttle", i);
+    }
+    TEST_CHECK(s_Gate.stats.maxSkipRun == 20, "longest skip run of %u frames", s_Gate.stats.maxSkipRun);
+}
+
+static void _Test_Unchecked(void)
+{
+    test_scene_t scene = {.brightness = 80};
+    uint32_t i;
+
+    _Test_Init(0);
+    for (i = 0; i <= TEST_STATIC + 1; i++)
+    {
+        _Test_Check(kPixelFormat_Gray, &scene);
+    }
+    TEST_CHECK(!_Test_Check(kPixelFormat_Gray, &scene), "static scene not skipped");
+
+    /* formats without luma, frames larger than the background and frames without data are always run */
+    _Test_Render(kPixelFormat_Gray16, &scene);
+    TEST_CHECK(HAL_VisionMotionGate_Check(&s_Gate, &s_Frame), "Gray16 frame skipped");
+    _Test_Render(kPixelFormat_YUV420P, &scene);
+    TEST_CHECK(HAL_VisionMotionGate_Check(&s_Gate, &s_Frame), "YUV420P frame skipped");
+    _Test_Render(kPixelFormat_Gray, &scene);
+    s_Frame.height += TEST_STEP;
+    TEST_CHECK(HAL_VisionMotionGate_Check(&s_Gate, &s_Frame), "frame larger than the background skipped");
+    _Test_Render(kPixelFormat_Gray, &scene);
+    s_Frame.data = NULL;
+    TEST_CHECK(HAL_VisionMotionGate_Check(&s_Gate, &s_Frame), "frame without data skipped");
+    TEST_CHECK(s_Gate.stats.frameCount == TEST_STATIC + 3, "%u frames counted", s_Gate.stats.frameCount);
+
+    /* the unchecked frames do not change the background */
+    TEST_CHECK(!_Test_Check(kPixelFormat_Gray, &scene), "static scene not skipped after the unchecked frames");
+
+    /* a reset drops the background, the scene has to be static again */
+    HAL_VisionMotionGate_Reset(&s_Gate);
+    for (i = 0; i <= TEST_STATIC; i++)
+    {
+        TEST_CHECK(_Test_Check(kPixelFormat_Gray, &scene), "frame %u after the reset skipped", i);
+    }
+    TEST_CHECK(!_Test_Check(kPixelFormat_Gray, &scene), "static scene not skipped after the reset");
+}
+
+int main(void)
+{
+    srand(1);
+
+    for (uint32_t i = 0; i < sizeof(s_Formats) / sizeof(s_Formats[0]); i++)
+    {
+        _Test_Static(s_Formats[i]);
+        _Test_Motion(s_Formats[i]);
+        _Test_Lighting(s_Formats[i]);
+    }
+    _Test_Presence();
+    _Test_Unchecked();
+
+    printf("%d failures\n", s_Failures);
+
+    return s_Failures != 0;
+}
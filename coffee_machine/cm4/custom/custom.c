@@ -5,6 +5,7 @@
  *      INCLUDES
  *********************/
 #include "custom.h"
+#include "custom_delta_anim.h"
 #include "lvgl/lvgl.h"
 #include <stdio.h>
 
@@ -145,17 +146,26 @@ static const char *s_StandbyHelpStr[kLanguage_Ids][4] = {
     {"Dites \"Salut NXP\"", "ou", "Appuyez sur l’écran", "Pour sélectionner votre café"},
 };
 
-static const lv_img_dsc_t *s_BrewingAnimImgs[] = {
-    &brewing_animimg_brewingf01, &brewing_animimg_brewingf03, &brewing_animimg_brewingf05, &brewing_animimg_brewingf07,
-    &brewing_animimg_brewingf09, &brewing_animimg_brewingf11, &brewing_animimg_brewingf13, &brewing_animimg_brewingf15,
-    &brewing_animimg_brewingf17, &brewing_animimg_brewingf19, &brewing_animimg_brewingf21, &brewing_animimg_brewingf23,
-    &brewing_animimg_brewingf25, &brewing_animimg_brewingf27, &brewing_animimg_brewingf29, &brewing_animimg_brewingf31};
+/* The brewing frames are stored as keyframe plus deltas, see tools/delta_anim/delta_anim_encode.py */
+#define BREWING_ANIM_FRAME_COUNT 16
+static const lv_img_dsc_t *s_BrewingAnimImgs[] = {&brewing_animimg_brewingf01};
 
 static const lv_img_dsc_t *s_StandbyAnimImgs[] = {&screen_animimg_screensaver01, &screen_animimg_screensaver02,
                                                   &screen_animimg_screensaver03, &screen_animimg_screensaver04,
                                                   &screen_animimg_screensaver05, &screen_animimg_screensaver06,
                                                   &screen_animimg_screensaver07, &screen_animimg_screensaver08};
 
+static delta_anim_t s_BrewingDeltaAnim;
+
+/* Delta stream of the brewing animation, packed by the resource build in place of brewingf03..f31 */
+lv_img_dsc_t brewing_animimg_brewing_delta = {
+    .header.always_zero = 0,
+    .header.w           = 0,
+    .header.h           = 0,
+    .data_size          = 930896,
+    .header.cf          = LV_IMG_CF_RAW,
+};
+
 #ifdef RT_PLATFORM
 void _takeLVGLMutex()
 {
@@ -492,9 +502,20 @@ void gui_set_coffee_selection(lv_ui *ui, screen_t scr)
 
 void gui_set_brewing_animation(lv_ui *ui)
 {
-    uint8_t animimg_num = sizeof(s_BrewingAnimImgs) / sizeof(lv_img_dsc_t *);
+    uint8_t animimg_num = BREWING_ANIM_FRAME_COUNT;
     LVGL_LOG("+gui_set_brewing_animation:%d\r\n", animimg_num);
-    lv_animimg_set_src(ui->brewing_animimg_brewing, (lv_img_dsc_t **)s_BrewingAnimImgs, animimg_num);
+    if ((s_BrewingDeltaAnim.frameCount != 0) ||
+        (delta_anim_load(&s_BrewingDeltaAnim, &brewing_animimg_brewingf01, brewing_animimg_brewing_delta.data) ==
+         LV_RES_OK))
+    {
+        delta_animimg_set_src(ui->brewing_animimg_brewing, &s_BrewingDeltaAnim);
+    }
+    else
+    {
+        /* Without a valid delta stream only the keyframe can be shown */
+        lv_animimg_set_src(ui->brewing_animimg_brewing, (lv_img_dsc_t **)s_BrewingAnimImgs,
+                           sizeof(s_BrewingAnimImgs) / sizeof(lv_img_dsc_t *));
+    }
     lv_animimg_set_duration(ui->brewing_animimg_brewing, animimg_num * 150);
     lv_animimg_t *brewing_animimg_brewing_ext = (lv_animimg_t *)ui->brewing_animimg_brewing;
     lv_anim_set_ready_cb(&brewing_animimg_brewing_ext->anim, gui_brewing_anim_ready_cb);
@@ -980,6 +1001,45 @@ void gui_set_algo_debuginfo(uint8_t isDetFace,
     }
 }
 
+/**
+ * @brief point the images at the layout of coffee_machine_resource.txt
+ *
+ * The generated setup_imgs() follows the GUI Guider project which still holds the brewing frames f03..f31, the
+ * resource binary replaces them by the delta stream so every image packed after it moved.
+ *
+ * @param base address of the resource images
+ */
+void custom_setup_imgs(unsigned char *base)
+{
+    brewing_animimg_brewing_delta.data                        = (base + 177600);
+    _Cafe_Latte_Black_120x120.data                            = (base + 1108544);
+    _Cafe_Latte_Selected_Black_120x120.data                   = (base + 1137344);
+    _Cappuccinno_Black_120x120.data                           = (base + 1166144);
+    _Cappuccinno_selected_Black_120x120.data                  = (base + 1194944);
+    _Espresso_Black_120x120.data                              = (base + 1223744);
+    _Espresso_Selected_Black_120x120.data                     = (base + 1252544);
+    finished_animimg_americanoAmericano_Selected_Black.data   = (base + 1281344);
+    finished_animimg_cafelatteCafe_Latte_Selected_Black.data  = (base + 1468864);
+    finished_animimg_cappccinoCappuccinno_selected_Black.data = (base + 1656384);
+    finished_animimg_espressoEspresso_Selected_Black.data     = (base + 1843904);
+    main_animimg_timeoutmain_rb_10_10.data                    = (base + 2031424);
+    _main_coffee_machine_1280x720.data                        = (base + 2031744);
+    _nxp_face_rec_300x80.data                                 = (base + 3874944);
+    _nxp_voice_rec_300x80.data                                = (base + 3922944);
+    _Selection_80x60.data                                     = (base + 3970944);
+    _Selection_Selected_80x60.data                            = (base + 3980544);
+    screen_animimg_screensaver01.data                         = (base + 3990144);
+    screen_animimg_screensaver02.data                         = (base + 4110144);
+    screen_animimg_screensaver03.data                         = (base + 4230144);
+    screen_animimg_screensaver04.data                         = (base + 4350144);
+    screen_animimg_screensaver05.data                         = (base + 4470144);
+    screen_animimg_screensaver06.data                         = (base + 4590144);
+    screen_animimg_screensaver07.data                         = (base + 4710144);
+    screen_animimg_screensaver08.data                         = (base + 4830144);
+    _Start_Black_Reshaped_270x120.data                        = (base + 4950144);
+    _unregister_75x75.data                                    = (base + 5014976);
+}
+
 /**
  * Initializes demo application
  */
@@ -86,21 +86,7 @@ LV_IMG_DECLARE(finished_animimg_americanoAmericano_Selected_Black);
 
 #include "lvgl/src/extra/widgets/animimg/lv_animimg.h"
 LV_IMG_DECLARE(brewing_animimg_brewingf01)
-LV_IMG_DECLARE(brewing_animimg_brewingf03)
-LV_IMG_DECLARE(brewing_animimg_brewingf05)
-LV_IMG_DECLARE(brewing_animimg_brewingf07)
-LV_IMG_DECLARE(brewing_animimg_brewingf09)
-LV_IMG_DECLARE(brewing_animimg_brewingf11)
-LV_IMG_DECLARE(brewing_animimg_brewingf13)
-LV_IMG_DECLARE(brewing_animimg_brewingf15)
-LV_IMG_DECLARE(brewing_animimg_brewingf17)
-LV_IMG_DECLARE(brewing_animimg_brewingf19)
-LV_IMG_DECLARE(brewing_animimg_brewingf21)
-LV_IMG_DECLARE(brewing_animimg_brewingf23)
-LV_IMG_DECLARE(brewing_animimg_brewingf25)
-LV_IMG_DECLARE(brewing_animimg_brewingf27)
-LV_IMG_DECLARE(brewing_animimg_brewingf29)
-LV_IMG_DECLARE(brewing_animimg_brewingf31)
+LV_IMG_DECLARE(brewing_animimg_brewing_delta)
 
 LV_IMG_DECLARE(screen_animimg_screensaver01)
 LV_IMG_DECLARE(screen_animimg_screensaver02)
@@ -180,6 +166,7 @@ void gui_set_algo_debuginfo(uint8_t isDetFace,
                             int recognized,
                             int id);
 
+void custom_setup_imgs(unsigned char *base);
 void custom_init(lv_ui *ui);
 
 #if defined(__cplusplus)
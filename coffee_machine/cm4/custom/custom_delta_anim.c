@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2022 NXP
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "custom_delta_anim.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#ifdef RT_PLATFORM
+#include "FreeRTOS.h"
+/* The frame sized working buffer does not fit in the LVGL pool, take it from the FreeRTOS heap */
+#define DELTA_ANIM_MALLOC pvPortMalloc
+#define DELTA_ANIM_FREE   vPortFree
+#else
+#define DELTA_ANIM_MALLOC lv_mem_alloc
+#define DELTA_ANIM_FREE   lv_mem_free
+#endif /*RT_PLATFORM*/
+
+#define DELTA_ANIM_ALIGN4(x) (((x) + 3) & ~3U)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    lv_obj_t *obj;
+    delta_anim_t *anim;
+} delta_anim_player_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static delta_anim_player_t s_DeltaAnimPlayers[DELTA_ANIM_MAX_PLAYERS];
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static uint32_t _tile_px_size(const lv_img_dsc_t *dsc)
+{
+    return (dsc->header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA) ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t);
+}
+
+static void _tile_area(const delta_anim_t *anim, uint16_t tile, lv_area_t *area)
+{
+    uint16_t tileSize = anim->stream->tileSize;
+
+    area->x1 = (tile % anim->tilesX) * tileSize;
+    area->y1 = (tile / anim->tilesX) * tileSize;
+    area->x2 = LV_MIN(area->x1 + tileSize, anim->work.header.w) - 1;
+    area->y2 = LV_MIN(area->y1 + tileSize, anim->work.header.h) - 1;
+}
+
+static void _apply_frame(lv_obj_t *obj, delta_anim_t *anim, uint16_t frame)
+{
+    const uint8_t *record = (const uint8_t *)anim->stream + anim->stream->frameOffsets[frame];
+    uint16_t tileCount    = *(const uint16_t *)record;
+    const uint16_t *tiles = (const uint16_t *)(record + sizeof(uint16_t));
+    const uint8_t *pixels = record + DELTA_ANIM_ALIGN4((tileCount + 1) * sizeof(uint16_t));
+    uint32_t pxSize       = anim->stream->pxSize;
+    uint32_t stride       = anim->work.header.w * pxSize;
+    lv_area_t bounds      = {LV_COORD_MAX, LV_COORD_MAX, LV_COORD_MIN, LV_COORD_MIN};
+    lv_area_t area;
+
+    for (uint16_t i = 0; i < tileCount; i++)
+    {
+        uint32_t rowLen;
+
+        _tile_area(anim, tiles[i], &area);
+        rowLen = lv_area_get_width(&area) * pxSize;
+
+        for (lv_coord_t y = area.y1; y <= area.y2; y++)
+        {
+            memcpy(anim->workBuf + y * stride + area.x1 * pxSize, pixels, rowLen);
+            pixels += rowLen;
+        }
+
+        if (obj == NULL)
+        {
+            continue;
+        }
+
+        if (tileCount <= DELTA_ANIM_MAX_INV_TILES)
+        {
+            /* Invalidate only the changed tile, in screen coordinates */
+            lv_area_move(&area, obj->coords.x1, obj->coords.y1);
+            lv_obj_invalidate_area(obj, &area);
+        }
+        else
+        {
+            bounds.x1 = LV_MIN(bounds.x1, area.x1);
+            bounds.y1 = LV_MIN(bounds.y1, area.y1);
+            bounds.x2 = LV_MAX(bounds.x2, area.x2);
+            bounds.y2 = LV_MAX(bounds.y2, area.y2);
+        }
+    }
+
+    if ((obj != NULL) && (tileCount > DELTA_ANIM_MAX_INV_TILES))
+    {
+        lv_area_move(&bounds, obj->coords.x1, obj->coords.y1);
+        lv_obj_invalidate_area(obj, &bounds);
+    }
+
+    anim->tilesBlitted += tileCount;
+}
+
+static delta_anim_t *_find_player(lv_obj_t *obj)
+{
+    for (int i = 0; i < DELTA_ANIM_MAX_PLAYERS; i++)
+    {
+        if (s_DeltaAnimPlayers[i].obj == obj)
+        {
+            return s_DeltaAnimPlayers[i].anim;
+        }
+    }
+
+    return NULL;
+}
+
+static void _delta_index_change(void *var, int32_t index)
+{
+    lv_obj_t *obj         = (lv_obj_t *)var;
+    lv_animimg_t *animimg = (lv_animimg_t *)obj;
+    delta_anim_t *anim    = _find_player(obj);
+    uint16_t idx;
+
+    if ((anim == NULL) || (anim->frameCount == 0))
+    {
+        return;
+    }
+
+    idx = index % anim->frameCount;
+
+    /* The anim timer may skip indices under load, walk all the deltas in between to stay consistent */
+    while (anim->curFrame != idx)
+    {
+        anim->curFrame = (anim->curFrame + 1) % anim->frameCount;
+        _apply_frame(obj, anim, anim->curFrame);
+    }
+
+    /* The working buffer is referenced in place by the image decoder, no need to set the source again */
+
+    if (animimg->exec_cb)
+    {
+        animimg->exec_cb(animimg->exec_var, (100 * idx) / anim->frameCount);
+    }
+}
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+lv_res_t delta_anim_load(delta_anim_t *anim, const lv_img_dsc_t *keyframe, const uint8_t *stream)
+{
+    const delta_anim_stream_t *header = (const delta_anim_stream_t *)stream;
+
+    if ((anim == NULL) || (keyframe == NULL) || (keyframe->data == NULL) || (stream == NULL))
+    {
+        return LV_RES_INV;
+    }
+
+    if ((((uintptr_t)stream & 3) != 0) || (header->magic != DELTA_ANIM_MAGIC) ||
+        (header->version != DELTA_ANIM_VERSION) || (header->frameCount == 0) || (header->tileSize == 0) ||
+        (header->width != keyframe->header.w) || (header->height != keyframe->header.h) ||
+        (header->pxSize != _tile_px_size(keyframe)))
+    {
+        LV_LOG_WARN("delta_anim_load: stream does not match the keyframe");
+        return LV_RES_INV;
+    }
+
+    memset(anim, 0, sizeof(delta_anim_t));
+    anim->keyframe   = keyframe;
+    anim->stream     = header;
+    anim->work       = *keyframe;
+    anim->frameCount = header->frameCount;
+    anim->tilesX     = (header->width + header->tileSize - 1) / header->tileSize;
+
+    anim->workBuf = DELTA_ANIM_MALLOC(anim->work.data_size);
+    if (anim->workBuf == NULL)
+    {
+        memset(anim, 0, sizeof(delta_anim_t));
+        return LV_RES_INV;
+    }
+    anim->work.data = anim->workBuf;
+
+    delta_anim_rewind(anim);
+
+    return LV_RES_OK;
+}
+
+void delta_anim_free(delta_anim_t *anim)
+{
+    if (anim == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < DELTA_ANIM_MAX_PLAYERS; i++)
+    {
+        if (s_DeltaAnimPlayers[i].anim == anim)
+        {
+            s_DeltaAnimPlayers[i].obj  = NULL;
+            s_DeltaAnimPlayers[i].anim = NULL;
+        }
+    }
+
+    if (anim->workBuf != NULL)
+    {
+        DELTA_ANIM_FREE(anim->workBuf);
+    }
+
+    memset(anim, 0, sizeof(delta_anim_t));
+}
+
+void delta_anim_rewind(delta_anim_t *anim)
+{
+    if ((anim == NULL) || (anim->workBuf == NULL))
+    {
+        return;
+    }
+
+    memcpy(anim->workBuf, anim->keyframe->data, anim->work.data_size);
+    anim->curFrame     = 0;
+    anim->tilesBlitted = 0;
+}
+
+void delta_animimg_set_src(lv_obj_t *obj, delta_anim_t *anim)
+{
+    lv_animimg_t *animimg = (lv_animimg_t *)obj;
+    int freeSlot          = -1;
+
+    if ((obj == NULL) || (anim == NULL) || (anim->frameCount == 0))
+    {
+        return;
+    }
+
+    for (int i = 0; i < DELTA_ANIM_MAX_PLAYERS; i++)
+    {
+        if (s_DeltaAnimPlayers[i].obj == obj)
+        {
+            freeSlot = i;
+            break;
+        }
+        else if ((freeSlot < 0) && (s_DeltaAnimPlayers[i].obj == NULL))
+        {
+            freeSlot = i;
+        }
+    }
+
+    if (freeSlot < 0)
+    {
+        LV_LOG_WARN("delta_animimg_set_src: no free player, increase DELTA_ANIM_MAX_PLAYERS");
+        return;
+    }
+
+    s_DeltaAnimPlayers[freeSlot].obj  = obj;
+    s_DeltaAnimPlayers[freeSlot].anim = anim;
+
+    animimg->dsc       = NULL;
+    animimg->pic_count = anim->frameCount;
+    lv_anim_set_values(&animimg->anim, 0, anim->frameCount);
+    lv_anim_set_exec_cb(&animimg->anim, _delta_index_change);
+
+    delta_anim_rewind(anim);
+    lv_img_set_src(obj, &anim->work);
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2022 NXP
+
+#ifndef __CUSTOM_DELTA_ANIM_H_
+#define __CUSTOM_DELTA_ANIM_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl/lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define DELTA_ANIM_MAGIC   0x4D4E4144 /* "DANM" */
+#define DELTA_ANIM_VERSION 1
+
+/* Number of animimg objects which can be driven by a delta animation at the same time */
+#ifndef DELTA_ANIM_MAX_PLAYERS
+#define DELTA_ANIM_MAX_PLAYERS 4
+#endif
+
+/* Above this number of dirty tiles a step invalidates their bounding box instead of each tile,
+ * LVGL falls back to a full screen refresh once its invalidation buffer is full */
+#ifndef DELTA_ANIM_MAX_INV_TILES
+#define DELTA_ANIM_MAX_INV_TILES 8
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*
+ * Delta stream written by tools/delta_anim/delta_anim_encode.py and stored in the resource binary.
+ * All fields are little endian and the stream must be 4 bytes aligned.
+ *
+ * Each frame record is made of:
+ *   uint16_t tileCount;
+ *   uint16_t tiles[tileCount];   dirty tile indices, row major, padded to 4 bytes
+ *   uint8_t  pixels[];           packed rows of the dirty tiles, in the same order as tiles
+ *
+ * frameOffsets[i] turns frame i-1 into frame i, frameOffsets[0] turns the last frame back into the keyframe.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t frameCount;
+    uint16_t width;
+    uint16_t height;
+    uint16_t tileSize; /* Tile edge length in pixels */
+    uint8_t pxSize;    /* Bytes per pixel */
+    uint8_t reserved;
+    uint32_t frameOffsets[]; /* Offset of each frame record from the start of the stream */
+} delta_anim_stream_t;
+
+typedef struct
+{
+    const lv_img_dsc_t *keyframe;      /* First frame, copied into the working buffer on rewind */
+    const delta_anim_stream_t *stream; /* Deltas, read in place from flash */
+    lv_img_dsc_t work;                 /* Working frame shown by the image object */
+    uint8_t *workBuf;
+    uint16_t tilesX;
+    uint16_t frameCount;
+    uint16_t curFrame;
+    uint32_t tilesBlitted; /* Number of tiles copied since the last rewind */
+} delta_anim_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * @brief Attach a precomputed delta stream to its keyframe
+ *
+ * Only the working buffer is allocated, the keyframe and the deltas are read in place.
+ *
+ * @param anim animation to fill
+ * @param keyframe first frame of the sequence
+ * @param stream delta stream of the sequence, see delta_anim_stream_t
+ * @return LV_RES_OK on success, LV_RES_INV on a stream not matching the keyframe or out of memory
+ */
+lv_res_t delta_anim_load(delta_anim_t *anim, const lv_img_dsc_t *keyframe, const uint8_t *stream);
+
+/**
+ * @brief Release the working buffer of a loaded animation
+ */
+void delta_anim_free(delta_anim_t *anim);
+
+/**
+ * @brief Restore the working buffer to the keyframe
+ */
+void delta_anim_rewind(delta_anim_t *anim);
+
+/**
+ * @brief Drive an animimg object with a loaded delta animation
+ *
+ * Duration, repeat count, ready and exec callbacks of the animimg keep working as before.
+ * Each animation step applies the deltas to the working buffer and invalidates only the changed tiles.
+ *
+ * @param obj animimg object
+ * @param anim loaded animation
+ */
+void delta_animimg_set_src(lv_obj_t *obj, delta_anim_t *anim);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __CUSTOM_DELTA_ANIM_H_ */
@@ -21,6 +21,8 @@
 #include "fwk_input_manager.h"
 #include "fwk_common.h"
 #include "fwk_log.h"
+#include "fwk_lpm_manager.h"
+#include "fwk_timer.h"
 #include "smart_tlhmi_event_descriptor.h"
 #include "hal_event_descriptor_voice.h"
 #include "hal_event_descriptor_face_rec.h"
@@ -45,6 +47,8 @@
  ******************************************************************************/
 static shell_status_t _VersionCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv);
 static shell_status_t _InfoCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv);
+static shell_status_t _LpmStatsCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv);
+static shell_status_t _TimerStatsCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv);
 static shell_status_t _ResetCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv);
 // static shell_status_t _SaveCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv);
 // static shell_status_t _AddCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv);
@@ -91,6 +95,14 @@ static SHELL_COMMAND_DEFINE(info,
                             (char *)"\r\n\"info \": get the system information\r\n",
                             _InfoCommand,
                             SHELL_IGNORE_PARAMETER_COUNT);
+static SHELL_COMMAND_DEFINE(lpm_stats,
+                            (char *)"\r\n\"lpm_stats\": get low power mode statistics\r\n",
+                            _LpmStatsCommand,
+                            SHELL_IGNORE_PARAMETER_COUNT);
+static SHELL_COMMAND_DEFINE(timer_stats,
+                            (char *)"\r\n\"timer_stats\": get framework timer statistics and active timers\r\n",
+                            _TimerStatsCommand,
+                            SHELL_IGNORE_PARAMETER_COUNT);
 static SHELL_COMMAND_DEFINE(reset,
                             (char *)"\r\n\"reset\": resets the board.\r\n",
                             _ResetCommand,
@@ -250,6 +262,8 @@ void APP_InputDev_Shell_RegisterShellCommands(shell_handle_t shellContextHandle,
 
     SHELL_RegisterCommand(shellContextHandle, SHELL_COMMAND(version));
     SHELL_RegisterCommand(shellContextHandle, SHELL_COMMAND(info));
+    SHELL_RegisterCommand(shellContextHandle, SHELL_COMMAND(lpm_stats));
+    SHELL_RegisterCommand(shellContextHandle, SHELL_COMMAND(timer_stats));
     SHELL_RegisterCommand(shellContextHandle, SHELL_COMMAND(reset));
     //    SHELL_RegisterCommand(shellContextHandle, SHELL_COMMAND(save));
     //    SHELL_RegisterCommand(shellContextHandle, SHELL_COMMAND(add));
@@ -1073,6 +1087,83 @@ static shell_status_t _InfoCommand(shell_handle_t shellContextHandle, int32_t ar
     return kStatus_SHELL_Success;
 }
 
+static shell_status_t _LpmStatsCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv)
+{
+    static const char *s_LpmModeName[kLPMMode_Invalid + 1] = {"SNVS", "STANDBY", "NONE"};
+    lpm_governor_stats_t governorStats;
+    lpm_mode_stats_t modeStats;
+    lpm_request_stats_t requestStats;
+
+    if (argc > 1)
+    {
+        SHELL_Printf(shellContextHandle, "Invalid # of parameters supplied\r\n");
+        return kStatus_SHELL_Error;
+    }
+
+    if (FWK_LpmManager_GetGovernorStats(&governorStats) == 0)
+    {
+        SHELL_Printf(shellContextHandle,
+                     "Governor: predicted idle %dms last idle %dms idle periods %d skipped %d last %s\r\n",
+                     governorStats.predictedIdleMs, governorStats.lastIdleMs, governorStats.idleCount,
+                     governorStats.shallowCount, s_LpmModeName[governorStats.lastMode]);
+        SHELL_Printf(shellContextHandle, "Transitions: prepare %dus ack timeouts %d aborted %d\r\n",
+                     governorStats.lastPrepareUs, governorStats.ackTimeoutCount, governorStats.abortCount);
+    }
+
+    for (int mode = 0; mode < kLPMMode_Invalid; mode++)
+    {
+        if (FWK_LpmManager_GetModeStats((hal_lpm_mode_t)mode, &modeStats) == 0)
+        {
+            SHELL_Printf(shellContextHandle,
+                         "Mode %s: entered %d residency %dms wake latency last %dus avg %dus max %dus "
+                         "(target residency %dms exit latency %dms)\r\n",
+                         s_LpmModeName[mode], modeStats.enterCount, modeStats.residencyMs,
+                         modeStats.lastWakeLatencyUs, modeStats.avgWakeLatencyUs, modeStats.maxWakeLatencyUs,
+                         modeStats.targetResidencyMs, modeStats.exitLatencyMs);
+        }
+    }
+
+    for (unsigned int i = 0; FWK_LpmManager_GetRequestStats(i, &requestStats) == 0; i++)
+    {
+        SHELL_Printf(shellContextHandle, "Request %s: usage %d held %d times for %dms blocked sleep %d ticks\r\n",
+                     requestStats.name, requestStats.usageCount, requestStats.holdCount, requestStats.holdTimeMs,
+                     requestStats.blockCount);
+    }
+
+    return kStatus_SHELL_Success;
+}
+
+static shell_status_t _TimerStatsCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv)
+{
+    fwk_timer_stats_t stats;
+    fwk_timer_info_t info[FWK_TIMER_MAX_COUNT];
+    int count;
+
+    if (argc > 1)
+    {
+        SHELL_Printf(shellContextHandle, "Invalid # of parameters supplied\r\n");
+        return kStatus_SHELL_Error;
+    }
+
+    if (FWK_Timer_GetStats(&stats) == 0)
+    {
+        SHELL_Printf(shellContextHandle,
+                     "Timers: active %d/%d peak %d started %d expired %d no free slot %d "
+                     "max late %d ticks max callback %dus\r\n",
+                     stats.activeCount, FWK_TIMER_MAX_COUNT, stats.peakCount, stats.startCount, stats.expireCount,
+                     stats.failCount, stats.maxLateTicks, stats.maxCallbackUs);
+    }
+
+    count = FWK_Timer_GetActive(info, FWK_TIMER_MAX_COUNT);
+    for (int i = 0; i < count; i++)
+    {
+        SHELL_Printf(shellContextHandle, "Timer %s: remaining %d ticks period %d ticks%s\r\n", info[i].name,
+                     info[i].remainingTicks, info[i].periodTicks, info[i].autoReload ? " auto reload" : "");
+    }
+
+    return kStatus_SHELL_Success;
+}
+
 static shell_status_t _ResetCommand(shell_handle_t shellContextHandle, int32_t argc, char **argv)
 {
     if (argc > 1)
@@ -117,6 +117,11 @@
 #define USE_CAMERA_MipiGc2145
 
 //#define ENABLE_CAMERA_DEV_2DSim
+/*
+ * The 2DTrace camera replays camera.trc from littlefs and runs a camera manager on the CM7.
+ * Disable the camera devices of the CM4 when it is enabled.
+ */
+//#define ENABLE_CAMERA_DEV_2DTrace
 #define ENABLE_VISIONALGO_DEV_Oasis_CoffeeMachine
 
 #define ENABLE_FLASH_DEV_Littlefs
@@ -62,6 +62,14 @@
  * the otapalconfigCODE_SIGNING_CERTIFICATE macro. */
 #include "ota_demo_config.h"
 
+#include <stdint.h>
+
+/**
+ * @brief Number of data blocks of the next request, sized by the OTA PAL from
+ * the round trip of the previous requests.
+ */
+uint32_t otaPal_GetRequestWindow( void );
+
 /**
  * @brief Log base 2 of the size of the file data block message (excluding the
  * header).
@@ -123,7 +131,19 @@
  *
  * <b>Possible values:</b> Any unsigned 32 integer value greater than 0. <br>
  */
-#define otaconfigMAX_NUM_BLOCKS_REQUEST         4U /* TODO */
+#define otaconfigMAX_NUM_BLOCKS_REQUEST         otaPal_GetRequestWindow()
+
+/**
+ * @brief The largest number of data blocks the request window can grow to.
+ *
+ * @note The PAL sizes each request from the round trip measured on the
+ * previous ones, see otaPal_GetRequestWindow. The service sends at most 128 KB
+ * per request, 8 blocks of 16 KB. Each block of the window takes an OTA data
+ * buffer.
+ *
+ * <b>Possible values:</b> Any unsigned 32 integer value greater than 0. <br>
+ */
+#define otaconfigMAX_NUM_BLOCKS_REQUEST_LIMIT   6U
 
 /**
  * @brief The maximum number of requests allowed to send without a response
@@ -156,7 +176,7 @@
  *
  * <b>Possible values:</b> Any unsigned 32 integer. <br>
  */
-#define otaconfigMAX_NUM_OTA_DATA_BUFFERS       otaconfigMAX_NUM_BLOCKS_REQUEST + 1 /* TODO */
+#define otaconfigMAX_NUM_OTA_DATA_BUFFERS       ( otaconfigMAX_NUM_BLOCKS_REQUEST_LIMIT + 1U )
 
 /**
  * @brief Flag to enable booting into updates that have an identical or lower
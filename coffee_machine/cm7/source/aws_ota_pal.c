@@ -45,8 +45,39 @@
 #include "sln_update.h"
 
 #include "task.h"
+#include "queue.h"
+#include "semphr.h"
 #include "ota_core_mqtt.h"
 
+#include "mbedtls/sha256.h"
+
+#include "aws_ota_pal_resume.h"
+
+/* Blocks copied and waiting for the writer task, the OTA agent waits for a free one when they are all in use */
+#ifndef OTA_PAL_WRITE_BEHIND_SLOTS
+#define OTA_PAL_WRITE_BEHIND_SLOTS 2
+#endif /* OTA_PAL_WRITE_BEHIND_SLOTS */
+
+/* Save the resume record every OTA_PAL_RESUME_SAVE_PERIOD blocks written, the blocks written since are received again
+ * after a reset */
+#ifndef OTA_PAL_RESUME_SAVE_PERIOD
+#define OTA_PAL_RESUME_SAVE_PERIOD 8
+#endif /* OTA_PAL_RESUME_SAVE_PERIOD */
+
+/* The first block written in an erase unit erases the whole unit */
+#if defined(ERASE_BLOCK_SUPPORT)
+#define OTA_PAL_ERASE_UNIT EXT_FLASH_ERASE_BLOCK
+#else
+#define OTA_PAL_ERASE_UNIT otaconfigFILE_BLOCK_SIZE
+#endif /* ERASE_BLOCK_SUPPORT */
+
+#define OTA_PAL_WRITER_TASK_STACK_SIZE 1024
+#define OTA_PAL_WRITER_TASK_PRIORITY   tskIDLE_PRIORITY
+
+#if (otaconfigFILE_BLOCK_SIZE % FLASH_SECTOR_SIZE) != 0
+#error "The blocks are erased sector by sector, otaconfigFILE_BLOCK_SIZE must be a multiple of FLASH_SECTOR_SIZE"
+#endif
+
 /* PAL file context structure */
 typedef struct
 {
@@ -55,7 +86,35 @@ typedef struct
     uint8_t percentage;
 } PAL_FileContext_t;
 
+/* Block handed to the writer task, a size of 0 asks the writer task to signal once the previous blocks are written */
+typedef struct
+{
+    uint32_t slot;
+    uint32_t offset;
+    uint32_t size;
+} PAL_WriteRequest_t;
+
+typedef struct
+{
+    uint8_t *slots[OTA_PAL_WRITE_BEHIND_SLOTS];
+    QueueHandle_t freeSlots;
+    QueueHandle_t pending;
+    SemaphoreHandle_t drained;
+    TaskHandle_t task;
+    /* first error of the writer task, reported on the next block or when the file is closed */
+    volatile status_t status;
+    uint32_t unsaved;
+    /* SHA256 of the blocks written from the start of the image, read back from the flash */
+    mbedtls_sha256_context sha;
+    uint32_t hashedBlocks;
+    /* blocks erased since the bank was opened */
+    uint8_t erased[OTA_PAL_RESUME_BITMAP_SIZE];
+} PAL_WriteBehind_t;
+
 static PAL_FileContext_t prvPAL_CurrentFileContext;
+static PAL_WriteBehind_t s_writeBehind;
+static OtaPalResumeRecord_t s_resumeRecord;
+static OtaPalWindow_t s_requestWindow;
 
 /* Specify the OTA signature algorithm we support on this platform. */
 const char OTA_JsonFileSignatureKey[OTA_FILE_SIG_KEY_STR_MAX_LENGTH] = "sig-sha256-rsa";
@@ -110,7 +169,7 @@ static uint8_t *prvPAL_GetCertificate(const char *pCertName)
     }
 }
 
-static OtaPalMainStatus_t prvPAL_CheckFileSignature(OtaFileContext_t *const C)
+static OtaPalMainStatus_t prvPAL_CheckFileSignature(OtaFileContext_t *const C, uint8_t *hash)
 {
     OtaPalMainStatus_t status = OtaPalSuccess;
     uint8_t *certPem      = NULL;
@@ -119,7 +178,7 @@ static OtaPalMainStatus_t prvPAL_CheckFileSignature(OtaFileContext_t *const C)
 
     if (certPem != NULL)
     {
-        if (SLN_Update_VerifyImgBank(s_imgType, C->pSignature->data, certPem) != kStatus_Success)
+        if (SLN_Update_VerifyImgHash(s_imgType, hash, C->pSignature->data, certPem) != kStatus_Success)
         {
             status = OtaPalSignatureCheckFailed;
         }
@@ -153,12 +212,250 @@ static PAL_FileContext_t *prvPAL_GetPALFileContext(OtaFileContext_t *const C)
     return PalFileContext;
 }
 
+static uint32_t prvPAL_NowMs(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static void prvPAL_SaveResumeRecord(void)
+{
+    if (s_resumeRecord.magic != OTA_PAL_RESUME_MAGIC)
+    {
+        return;
+    }
+
+    if (SLN_FLASH_FS_OK != sln_flash_fs_ops_save(OTA_RESUME_FILE_NAME, (uint8_t *)&s_resumeRecord,
+                                                 sizeof(OtaPalResumeRecord_t)))
+    {
+        LogWarn(("[OTA-NXP] Unable to save the resume record"));
+    }
+
+    s_writeBehind.unsaved = 0;
+}
+
+static void prvPAL_ClearResumeRecord(void)
+{
+    s_resumeRecord.magic = 0;
+    sln_flash_fs_ops_erase(OTA_RESUME_FILE_NAME);
+}
+
+/* Hash the blocks written right after the ones already hashed, from the flash to check what was programmed */
+static void prvPAL_HashWrittenBlocks(void)
+{
+    while (otaPalResume_IsWritten(&s_resumeRecord, s_writeBehind.hashedBlocks))
+    {
+        uint32_t addr = FLEXSPI_AMBA_BASE + s_resumeRecord.bankAddr +
+                        s_writeBehind.hashedBlocks * s_resumeRecord.blockSize;
+
+        mbedtls_sha256_update_ret(&s_writeBehind.sha, (const uint8_t *)addr,
+                                  otaPalResume_BlockLen(&s_resumeRecord, s_writeBehind.hashedBlocks));
+        s_writeBehind.hashedBlocks++;
+    }
+}
+
+static status_t prvPAL_FlushBlock(const PAL_WriteRequest_t *request)
+{
+    status_t status      = kStatus_Success;
+    uint32_t eraseOffset = 0;
+    uint32_t eraseLen    = 0;
+
+    /* The bank is not erased upfront but as the blocks come, a block received again after a reset may have been
+     * half programmed */
+    if (otaPalResume_EraseRange(&s_resumeRecord, s_writeBehind.erased, OTA_PAL_ERASE_UNIT, request->offset,
+                                &eraseOffset, &eraseLen))
+    {
+        status = SLN_Update_EraseImg(s_imgType, eraseOffset, eraseLen);
+    }
+
+    if (kStatus_Success == status)
+    {
+        status = SLN_Update_WriteImg(s_imgType, request->offset, s_writeBehind.slots[request->slot], request->size);
+    }
+
+    if (kStatus_Success == status)
+    {
+        otaPalResume_MarkWritten(&s_resumeRecord, request->offset);
+        prvPAL_HashWrittenBlocks();
+
+        if (++s_writeBehind.unsaved >= OTA_PAL_RESUME_SAVE_PERIOD)
+        {
+            prvPAL_SaveResumeRecord();
+        }
+    }
+    else
+    {
+        LogError(("[OTA-NXP] Writing the block at 0x%x failed, error %d", request->offset, status));
+    }
+
+    return status;
+}
+
+static void prvPAL_WriterTask(void *pvParameters)
+{
+    PAL_WriteRequest_t request;
+
+    for (;;)
+    {
+        if (xQueueReceive(s_writeBehind.pending, &request, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        if (request.size == 0)
+        {
+            xSemaphoreGive(s_writeBehind.drained);
+            continue;
+        }
+
+        if (kStatus_Success == s_writeBehind.status)
+        {
+            s_writeBehind.status = prvPAL_FlushBlock(&request);
+        }
+
+        xQueueSend(s_writeBehind.freeSlots, &request.slot, 0);
+    }
+}
+
+/* Wait for the writer task to write the blocks queued */
+static void prvPAL_DrainWrites(void)
+{
+    PAL_WriteRequest_t marker = {0};
+
+    if (s_writeBehind.task == NULL)
+    {
+        return;
+    }
+
+    xQueueSend(s_writeBehind.pending, &marker, portMAX_DELAY);
+    xSemaphoreTake(s_writeBehind.drained, portMAX_DELAY);
+}
+
+static void prvPAL_ReleaseWrites(void)
+{
+    prvPAL_DrainWrites();
+
+    for (uint32_t i = 0; i < OTA_PAL_WRITE_BEHIND_SLOTS; i++)
+    {
+        if (s_writeBehind.slots[i] != NULL)
+        {
+            vPortFree(s_writeBehind.slots[i]);
+            s_writeBehind.slots[i] = NULL;
+        }
+    }
+
+    mbedtls_sha256_free(&s_writeBehind.sha);
+}
+
+static OtaPalMainStatus_t prvPAL_StartWrites(void)
+{
+    if (s_writeBehind.task == NULL)
+    {
+        s_writeBehind.freeSlots = xQueueCreate(OTA_PAL_WRITE_BEHIND_SLOTS, sizeof(uint32_t));
+        s_writeBehind.pending   = xQueueCreate(OTA_PAL_WRITE_BEHIND_SLOTS + 1, sizeof(PAL_WriteRequest_t));
+        s_writeBehind.drained   = xSemaphoreCreateBinary();
+
+        if ((s_writeBehind.freeSlots == NULL) || (s_writeBehind.pending == NULL) || (s_writeBehind.drained == NULL) ||
+            (xTaskCreate(prvPAL_WriterTask, "OTA Writer Task", OTA_PAL_WRITER_TASK_STACK_SIZE, NULL,
+                         OTA_PAL_WRITER_TASK_PRIORITY, &s_writeBehind.task) != pdPASS))
+        {
+            LogError(("[OTA-NXP] Unable to create the writer task"));
+            return OtaPalRxFileCreateFailed;
+        }
+    }
+
+    /* a file left open without an abort */
+    prvPAL_ReleaseWrites();
+    xQueueReset(s_writeBehind.freeSlots);
+
+    for (uint32_t i = 0; i < OTA_PAL_WRITE_BEHIND_SLOTS; i++)
+    {
+        s_writeBehind.slots[i] = (uint8_t *)pvPortMalloc(otaconfigFILE_BLOCK_SIZE);
+        if (s_writeBehind.slots[i] == NULL)
+        {
+            LogError(("[OTA-NXP] Unable to allocate the write buffers"));
+            prvPAL_ReleaseWrites();
+            return OtaPalRxFileCreateFailed;
+        }
+
+        xQueueSend(s_writeBehind.freeSlots, &i, 0);
+    }
+
+    s_writeBehind.status       = kStatus_Success;
+    s_writeBehind.unsaved      = 0;
+    s_writeBehind.hashedBlocks = 0;
+    memset(s_writeBehind.erased, 0, sizeof(s_writeBehind.erased));
+    mbedtls_sha256_init(&s_writeBehind.sha);
+    mbedtls_sha256_starts_ret(&s_writeBehind.sha, 0);
+
+    return OtaPalSuccess;
+}
+
+/* Open the bank keeping the blocks written by an interrupted download of the same file, if any */
+static status_t prvPAL_OpenImgBank(OtaFileContext_t *const C, uint32_t *restoredBytes)
+{
+    OtaPalResumeRecord_t *saved = NULL;
+    uint32_t savedLen           = sizeof(OtaPalResumeRecord_t);
+    uint32_t restored           = 0;
+    uint32_t imgAddr            = 0;
+    status_t status             = kStatus_Fail;
+
+    *restoredBytes = 0;
+
+    saved = (OtaPalResumeRecord_t *)pvPortMalloc(sizeof(OtaPalResumeRecord_t));
+    if ((saved != NULL) &&
+        (SLN_FLASH_FS_OK == sln_flash_fs_ops_read(OTA_RESUME_FILE_NAME, (uint8_t *)saved, 0, &savedLen)) &&
+        (savedLen == sizeof(OtaPalResumeRecord_t)) && otaPalResume_Matches(saved, &s_resumeRecord))
+    {
+        status = SLN_Update_OpenImgBank(s_imgType, C->fileSize, otaPalResume_WrittenLen(saved));
+
+        /* the blocks are dropped if an image was activated since, the free bank is not the same */
+        FICA_GetNewAppStartAddr(&imgAddr);
+        if ((kStatus_Success == status) && (imgAddr == saved->bankAddr))
+        {
+            memcpy(s_resumeRecord.written, saved->written, sizeof(s_resumeRecord.written));
+            restored = otaPalResume_Restore(&s_resumeRecord, C->pRxBlockBitmap, &C->blocksRemaining, restoredBytes);
+            LogInfo(("[OTA-NXP] Resuming the download, %d blocks of %d already written", restored,
+                     s_resumeRecord.blockCount));
+        }
+        else
+        {
+            status = kStatus_Fail;
+        }
+    }
+
+    if (saved != NULL)
+    {
+        vPortFree(saved);
+    }
+
+    if (kStatus_Success != status)
+    {
+        sln_flash_fs_ops_erase(OTA_RESUME_FILE_NAME);
+        status = SLN_Update_OpenImgBank(s_imgType, C->fileSize, 0);
+    }
+
+    if (kStatus_Success == status)
+    {
+        FICA_GetNewAppStartAddr(&s_resumeRecord.bankAddr);
+    }
+
+    return status;
+}
+
 OtaPalStatus_t otaPal_Abort(OtaFileContext_t *const C)
 {
     OtaPalStatus_t result = OtaPalSuccess;
 
     LogInfo(("[OTA-NXP] Abort"));
 
+    if (prvPAL_GetPALFileContext(C) != NULL)
+    {
+        /* keep what was written, the job is resumed from there */
+        prvPAL_DrainWrites();
+        prvPAL_SaveResumeRecord();
+        prvPAL_ReleaseWrites();
+    }
+
     C->pFile = NULL;
     return OTA_PAL_COMBINE_ERR(result, 0);
 }
@@ -166,8 +463,9 @@ OtaPalStatus_t otaPal_Abort(OtaFileContext_t *const C)
 OtaPalStatus_t otaPal_CreateFileForRx(OtaFileContext_t *const C)
 {
     DEFINE_OTA_METHOD_NAME("otaPal_CreateFileForRx");
-    OtaPalStatus_t ret = OtaPalSuccess;
-    s_imgType          = FICA_IMG_TYPE_NONE;
+    OtaPalStatus_t ret     = OtaPalSuccess;
+    uint32_t restoredBytes = 0;
+    s_imgType              = FICA_IMG_TYPE_NONE;
 
     PAL_FileContext_t *PalFileContext = &prvPAL_CurrentFileContext;
 
@@ -190,13 +488,21 @@ OtaPalStatus_t otaPal_CreateFileForRx(OtaFileContext_t *const C)
         ret = OtaPalRxFileCreateFailed;
     }
 
-    /* Init FICA to be ready for the new application */
+    if ((OtaPalSuccess == ret) &&
+        !otaPalResume_InitRecord(&s_resumeRecord, s_imgType, C->fileSize, otaconfigFILE_BLOCK_SIZE, C->serverFileID,
+                                 C->pJobName, C->pSignature->data, C->pSignature->size))
+    {
+        LogError(("[%s] Too many blocks in the file: %d bytes.\r\n", OTA_METHOD_NAME, C->fileSize));
+        ret = OtaPalRxFileCreateFailed;
+    }
+
+    /* Init FICA to be ready for the new application, the blocks are erased as they are written */
     if (OtaPalSuccess == ret)
     {
-        status_t status = SLN_Update_PrepareImgBank(s_imgType, C->fileSize);
+        status_t status = prvPAL_OpenImgBank(C, &restoredBytes);
         if (kStatus_Success != status)
         {
-            LogError(("[%s] SLN_Update_PrepareImgBank failed, error %d.\r\n", OTA_METHOD_NAME, status));
+            LogError(("[%s] SLN_Update_OpenImgBank failed, error %d.\r\n", OTA_METHOD_NAME, status));
             ret = OtaPalRxFileCreateFailed;
         }
         else
@@ -206,14 +512,20 @@ OtaPalStatus_t otaPal_CreateFileForRx(OtaFileContext_t *const C)
         }
     }
 
+    if (OtaPalSuccess == ret)
+    {
+        ret = prvPAL_StartWrites();
+    }
+
     if (OtaPalSuccess == ret)
     {
         /* We don't need yet anything here, but this field
          * must not remain NULL after this function returns */
         C->pFile                   = (void *)PalFileContext;
         PalFileContext->FileXRef   = C;
-        PalFileContext->percentage = 0;
-        PalFileContext->file_size  = 0;
+        PalFileContext->file_size  = restoredBytes;
+        PalFileContext->percentage = PalFileContext->file_size / (float)C->fileSize * 100;
+        otaPalWindow_Init(&s_requestWindow, otaconfigMAX_NUM_BLOCKS_REQUEST_LIMIT, otaconfigFILE_REQUEST_WAIT_MS);
         _advertiseWiFiOTAStatus(PalFileContext->percentage);
         LogDebug(("[%s] OK.\r\n", OTA_METHOD_NAME));
     }
@@ -229,6 +541,7 @@ OtaPalStatus_t otaPal_CloseFile(OtaFileContext_t *const C)
 {
     OtaPalStatus_t result = OtaPalSuccess;
     PAL_FileContext_t *PalFileContext;
+    uint8_t hash[32]; /* SHA256 */
 
     LogDebug(("[OTA-NXP] CloseFile"));
 
@@ -238,17 +551,46 @@ OtaPalStatus_t otaPal_CloseFile(OtaFileContext_t *const C)
         return OTA_PAL_COMBINE_ERR(OtaPalFileClose, 0);
     }
 
-    if (PalFileContext->file_size != C->fileSize)
+    prvPAL_DrainWrites();
+
+    LogInfo(("[OTA-NXP] %d requests, window %d, round trip %d ms, %d ms per block, %d stalls",
+             s_requestWindow.requests, s_requestWindow.window, s_requestWindow.rttMs, s_requestWindow.blockMs,
+             s_requestWindow.stalls));
+
+    if (kStatus_Success != s_writeBehind.status)
+    {
+        LogError(("[OTA-NXP] Writing the image failed, error %d.", s_writeBehind.status));
+        result = OtaPalFileClose;
+    }
+    else if (PalFileContext->file_size != C->fileSize)
     {
         LogError(("[OTA-NXP] Actual file size %d is not as expected %d.", PalFileContext->file_size, C->fileSize));
-        return OTA_PAL_COMBINE_ERR(OtaPalFileClose, 0);
+        result = OtaPalFileClose;
+    }
+    else if (s_writeBehind.hashedBlocks != s_resumeRecord.blockCount)
+    {
+        LogError(("[OTA-NXP] Only %d blocks of %d are written.", s_writeBehind.hashedBlocks,
+                  s_resumeRecord.blockCount));
+        result = OtaPalFileClose;
     }
+    else
+    {
+        mbedtls_sha256_finish_ret(&s_writeBehind.sha, hash);
+
+        if (prvPAL_CheckFileSignature(C, hash) != OtaPalSuccess)
+        {
+            LogError(("[OTA-NXP] CheckFileSignature failed"));
+            result = OtaPalFileClose;
+        }
+    }
+
+    /* the image is complete or unusable, the next download starts over */
+    prvPAL_ClearResumeRecord();
+    prvPAL_ReleaseWrites();
 
-    result = prvPAL_CheckFileSignature(C);
     if (result != OtaPalSuccess)
     {
-        LogError(("[OTA-NXP] CheckFileSignature failed"));
-        return OTA_PAL_COMBINE_ERR(OtaPalFileClose, 0);
+        return OTA_PAL_COMBINE_ERR(result, 0);
     }
 
     _advertiseWiFiOTAStatus(100);
@@ -260,48 +602,51 @@ OtaPalStatus_t otaPal_CloseFile(OtaFileContext_t *const C)
 int16_t otaPal_WriteBlock(OtaFileContext_t *const C, uint32_t ulOffset, uint8_t *const pcData, uint32_t ulBlockSize)
 {
     DEFINE_OTA_METHOD_NAME("otaPal_WriteBlock");
-    status_t status = kStatus_Success;
-    int16_t retVal  = 0;
-
-    uint8_t *data           = pcData;
-    uint32_t data_offset    = ulOffset;
-    uint32_t data_remaining = ulBlockSize;
-
+    PAL_WriteRequest_t request;
     PAL_FileContext_t *PalFileContext;
 
     LogDebug(("[OTA-NXP] WriteBlock 0x%x : 0x%x", ulOffset, ulBlockSize));
 
     PalFileContext = prvPAL_GetPALFileContext(C);
-    if (PalFileContext == NULL)
+    if ((PalFileContext == NULL) || (ulBlockSize == 0) || (ulBlockSize > otaconfigFILE_BLOCK_SIZE))
     {
         return -1;
     }
 
-    status = SLN_Update_WriteImg(s_imgType, data_offset, data, data_remaining);
-
-    if (kStatus_Success == status)
+    if (kStatus_Success != s_writeBehind.status)
     {
-        uint32_t newPercentage = PalFileContext->file_size / (float)C->fileSize * 100;
+        LogError(("[%s] Writing a previous block failed, error %d.\r\n", OTA_METHOD_NAME, s_writeBehind.status));
+        return -1;
+    }
 
-        if (newPercentage != PalFileContext->percentage)
-        {
-            _advertiseWiFiOTAStatus(PalFileContext->percentage);
-            PalFileContext->percentage = newPercentage;
-        }
+    /* The writer task erases and programs the block, the agent goes back to receiving the next ones meanwhile */
+    xQueueReceive(s_writeBehind.freeSlots, &request.slot, portMAX_DELAY);
+    memcpy(s_writeBehind.slots[request.slot], pcData, ulBlockSize);
+    request.offset = ulOffset;
+    request.size   = ulBlockSize;
+    xQueueSend(s_writeBehind.pending, &request, portMAX_DELAY);
 
-        LogDebug(("[%s] SLN_Update_WriteImg ended with success, file size is now %d.\r\n", OTA_METHOD_NAME,
-                  PalFileContext->file_size));
+    otaPalWindow_OnBlock(&s_requestWindow, prvPAL_NowMs());
 
-        /* Update size of file received so far */
-        PalFileContext->file_size += data_remaining;
-    }
-    else
+    /* Update size of file received so far */
+    PalFileContext->file_size += ulBlockSize;
+
+    uint32_t newPercentage = PalFileContext->file_size / (float)C->fileSize * 100;
+
+    if (newPercentage != PalFileContext->percentage)
     {
-        LogError(("[%s] SLN_Update_WriteImg failed, error %d.\r\n", OTA_METHOD_NAME, status));
-        retVal = -1;
+        PalFileContext->percentage = newPercentage;
+        _advertiseWiFiOTAStatus(PalFileContext->percentage);
     }
 
-    return retVal;
+    LogDebug(("[%s] Block queued, file size is now %d.\r\n", OTA_METHOD_NAME, PalFileContext->file_size));
+
+    return 0;
+}
+
+uint32_t otaPal_GetRequestWindow(void)
+{
+    return otaPalWindow_Get(&s_requestWindow);
 }
 
 OtaPalStatus_t otaPal_ActivateNewImage(OtaFileContext_t *const C)
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+#include <string.h>
+
+#include "aws_ota_pal_resume.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define BITS_PER_BYTE 8U
+
+/* weight of a new sample in the smoothed round trip and block time, 1/8 as TCP does */
+#define WINDOW_EWMA_SHIFT 3U
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint32_t _otaPalWindow_Smooth(uint32_t average, uint32_t sample)
+{
+    if (average == 0)
+    {
+        return (sample != 0) ? sample : 1;
+    }
+
+    return (average * ((1U << WINDOW_EWMA_SHIFT) - 1) + sample + (1U << (WINDOW_EWMA_SHIFT - 1))) >> WINDOW_EWMA_SHIFT;
+}
+
+/* window for the next request, one more block than the current one until the round trip is covered */
+static uint32_t _otaPalWindow_Next(const OtaPalWindow_t *window)
+{
+    uint32_t next = window->window + 1;
+
+    if ((window->rttMs != 0) && (window->blockMs != 0))
+    {
+        uint32_t target = 1 + (OTA_PAL_WINDOW_RTT_FACTOR * window->rttMs + window->blockMs - 1) / window->blockMs;
+
+        if (target < next)
+        {
+            next = target;
+        }
+    }
+
+    if (next > window->maxWindow)
+    {
+        next = window->maxWindow;
+    }
+
+    return next;
+}
+
+bool otaPalResume_InitRecord(OtaPalResumeRecord_t *record,
+                             int32_t imgType,
+                             uint32_t fileSize,
+                             uint32_t blockSize,
+                             uint32_t serverFileId,
+                             const uint8_t *jobName,
+                             const uint8_t *signature,
+                             uint16_t signatureSize)
+{
+    uint32_t blockCount;
+
+    if ((record == NULL) || (blockSize == 0))
+    {
+        return false;
+    }
+
+    memset(record, 0, sizeof(OtaPalResumeRecord_t));
+
+    blockCount = (fileSize + blockSize - 1) / blockSize;
+    if ((blockCount == 0) || (blockCount > OTA_PAL_RESUME_BITMAP_SIZE * BITS_PER_BYTE))
+    {
+        return false;
+    }
+
+    record->magic        = OTA_PAL_RESUME_MAGIC;
+    record->imgType      = imgType;
+    record->fileSize     = fileSize;
+    record->blockSize    = blockSize;
+    record->serverFileId = serverFileId;
+    record->blockCount   = blockCount;
+
+    if (jobName != NULL)
+    {
+        strncpy((char *)record->jobName, (const char *)jobName, OTA_PAL_RESUME_JOB_NAME_SIZE - 1);
+    }
+
+    if (signature != NULL)
+    {
+        if (signatureSize > OTA_PAL_RESUME_SIGNATURE_SIZE)
+        {
+            signatureSize = OTA_PAL_RESUME_SIGNATURE_SIZE;
+        }
+
+        memcpy(record->signature, signature, signatureSize);
+        record->signatureSize = signatureSize;
+    }
+
+    return true;
+}
+
+bool otaPalResume_Matches(const OtaPalResumeRecord_t *saved, const OtaPalResumeRecord_t *current)
+{
+    if ((saved == NULL) || (current == NULL))
+    {
+        return false;
+    }
+
+    /* the job name alone is not enough, a job can be created again with the same name for another file */
+    return (saved->magic == OTA_PAL_RESUME_MAGIC) && (saved->imgType == current->imgType) &&
+           (saved->fileSize == current->fileSize) && (saved->blockSize == current->blockSize) &&
+           (saved->serverFileId == current->serverFileId) && (saved->blockCount == current->blockCount) &&
+           (saved->signatureSize == current->signatureSize) && (current->jobName[0] != '\0') &&
+           (memcmp(saved->jobName, current->jobName, OTA_PAL_RESUME_JOB_NAME_SIZE) == 0) &&
+           (memcmp(saved->signature, current->signature, current->signatureSize) == 0);
+}
+
+void otaPalResume_MarkWritten(OtaPalResumeRecord_t *record, uint32_t offset)
+{
+    uint32_t block = offset / record->blockSize;
+
+    if (block < record->blockCount)
+    {
+        record->written[block / BITS_PER_BYTE] |= (uint8_t)(1U << (block % BITS_PER_BYTE));
+    }
+}
+
+bool otaPalResume_IsWritten(const OtaPalResumeRecord_t *record, uint32_t block)
+{
+    if (block >= record->blockCount)
+    {
+        return false;
+    }
+
+    return (record->written[block / BITS_PER_BYTE] & (1U << (block % BITS_PER_BYTE))) != 0;
+}
+
+uint32_t otaPalResume_BlockLen(const OtaPalResumeRecord_t *record, uint32_t block)
+{
+    uint32_t offset = block * record->blockSize;
+
+    if (block >= record->blockCount)
+    {
+        return 0;
+    }
+
+    return (record->fileSize - offset < record->blockSize) ? record->fileSize - offset : record->blockSize;
+}
+
+uint32_t otaPalResume_WrittenLen(const OtaPalResumeRecord_t *record)
+{
+    for (uint32_t block = record->blockCount; block > 0; block--)
+    {
+        if (otaPalResume_IsWritten(record, block - 1))
+        {
+            return (block - 1) * record->blockSize + otaPalResume_BlockLen(record, block - 1);
+        }
+    }
+
+    return 0;
+}
+
+bool otaPalResume_EraseRange(const OtaPalResumeRecord_t *record,
+                             uint8_t *erased,
+                             uint32_t unitSize,
+                             uint32_t offset,
+                             uint32_t *eraseOffset,
+                             uint32_t *eraseLen)
+{
+    uint32_t block      = offset / record->blockSize;
+    uint32_t unitBlocks = unitSize / record->blockSize;
+    uint32_t first      = 0;
+    uint32_t last       = 0;
+    bool untouched      = true;
+
+    if (block >= record->blockCount)
+    {
+        return false;
+    }
+
+    if (erased[block / BITS_PER_BYTE] & (1U << (block % BITS_PER_BYTE)))
+    {
+        return false;
+    }
+
+    if (unitBlocks > 1)
+    {
+        first = block - block % unitBlocks;
+        last  = first + unitBlocks;
+        if (last > record->blockCount)
+        {
+            last = record->blockCount;
+        }
+
+        for (uint32_t i = first; i < last; i++)
+        {
+            if (otaPalResume_IsWritten(record, i))
+            {
+                untouched = false;
+                break;
+            }
+        }
+    }
+
+    if ((unitBlocks <= 1) || !untouched)
+    {
+        first = block;
+        last  = block + 1;
+    }
+
+    for (uint32_t i = first; i < last; i++)
+    {
+        erased[i / BITS_PER_BYTE] |= (uint8_t)(1U << (i % BITS_PER_BYTE));
+    }
+
+    *eraseOffset = first * record->blockSize;
+    *eraseLen    = (last - 1) * record->blockSize + otaPalResume_BlockLen(record, last - 1) - *eraseOffset;
+
+    return true;
+}
+
+uint32_t otaPalResume_Restore(OtaPalResumeRecord_t *record,
+                              uint8_t *rxBitmap,
+                              uint32_t *blocksRemaining,
+                              uint32_t *restoredBytes)
+{
+    uint32_t restored = 0;
+    uint32_t bytes    = 0;
+
+    for (uint32_t block = 0; block < record->blockCount; block++)
+    {
+        uint8_t mask = (uint8_t)(1U << (block % BITS_PER_BYTE));
+
+        if (!otaPalResume_IsWritten(record, block) || ((rxBitmap[block / BITS_PER_BYTE] & mask) == 0))
+        {
+            continue;
+        }
+
+        if (*blocksRemaining <= 1)
+        {
+            /* everything was written but the file was not closed, receive this block again to close it */
+            record->written[block / BITS_PER_BYTE] &= (uint8_t)~mask;
+            continue;
+        }
+
+        rxBitmap[block / BITS_PER_BYTE] &= (uint8_t)~mask;
+        (*blocksRemaining)--;
+        bytes += otaPalResume_BlockLen(record, block);
+        restored++;
+    }
+
+    if (restoredBytes != NULL)
+    {
+        *restoredBytes = bytes;
+    }
+
+    return restored;
+}
+
+void otaPalWindow_Init(OtaPalWindow_t *window, uint32_t maxWindow, uint32_t stallMs)
+{
+    memset(window, 0, sizeof(OtaPalWindow_t));
+
+    window->maxWindow = (maxWindow != 0) ? maxWindow : 1;
+    /* the blocks before a lost one arrive after the request, the gap to the blocks requested again is shorter */
+    window->stallMs   = stallMs / 2;
+    window->window    = (window->maxWindow > 1) ? 2 : 1;
+    window->expected  = window->window;
+}
+
+uint32_t otaPalWindow_Get(const OtaPalWindow_t *window)
+{
+    return (window->window != 0) ? window->window : 1;
+}
+
+void otaPalWindow_OnBlock(OtaPalWindow_t *window, uint32_t nowMs)
+{
+    bool started = (window->requests != 0) || (window->received != 0) || window->requestSent;
+
+    if (started && (nowMs - window->lastBlockMs >= window->stallMs))
+    {
+        /* blocks of the last request were lost, the agent timed out and requested the current window again */
+        window->stalls++;
+        window->expected    = window->window;
+        window->window      = (window->window > 1) ? window->window / 2 : 1;
+        window->received    = 0;
+        window->requestSent = false;
+    }
+
+    if (window->received == 0)
+    {
+        if (window->requestSent)
+        {
+            window->rttMs = _otaPalWindow_Smooth(window->rttMs, nowMs - window->lastBlockMs);
+        }
+
+        window->firstBlockMs = nowMs;
+    }
+
+    window->received++;
+    window->lastBlockMs = nowMs;
+    window->requestSent = false;
+
+    if (window->received >= window->expected)
+    {
+        if (window->received > 1)
+        {
+            window->blockMs =
+                _otaPalWindow_Smooth(window->blockMs, (nowMs - window->firstBlockMs) / (window->received - 1));
+        }
+
+        window->requests++;
+        window->received    = 0;
+        window->requestSent = true;
+        window->window      = _otaPalWindow_Next(window);
+        window->expected    = window->window;
+    }
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief OTA PAL download bookkeeping.
+ * The resume record keeps the identity of the file being received and a bitmap of the blocks already in the flash
+ * bank, so a job restarted after a reset or a disconnection requests only the missing blocks. The request window
+ * follows the round trip and the block rate measured on the blocks received. There is no OS or flash dependency,
+ * the PAL stores the record and feeds the timestamps.
+ */
+
+#ifndef _AWS_OTA_PAL_RESUME_H_
+#define _AWS_OTA_PAL_RESUME_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define OTA_PAL_RESUME_MAGIC          0x4F544152U /* "OTAR" */
+#define OTA_PAL_RESUME_JOB_NAME_SIZE  73U         /* OTA_JOB_ID_MAX_SIZE */
+#define OTA_PAL_RESUME_SIGNATURE_SIZE 256U        /* kOTA_MaxSignatureSize */
+#define OTA_PAL_RESUME_BITMAP_SIZE    128U        /* OTA_MAX_BLOCK_BITMAP_SIZE */
+
+/* The window is sized so the blocks of a request take OTA_PAL_WINDOW_RTT_FACTOR round trips to arrive */
+#ifndef OTA_PAL_WINDOW_RTT_FACTOR
+#define OTA_PAL_WINDOW_RTT_FACTOR 2U
+#endif /* OTA_PAL_WINDOW_RTT_FACTOR */
+
+/* Identity of the file being received and blocks of it already in the flash bank */
+typedef struct
+{
+    uint32_t magic;
+    int32_t imgType;
+    /* start of the bank the blocks were written in */
+    uint32_t bankAddr;
+    uint32_t fileSize;
+    uint32_t blockSize;
+    uint32_t serverFileId;
+    uint8_t jobName[OTA_PAL_RESUME_JOB_NAME_SIZE];
+    uint8_t signature[OTA_PAL_RESUME_SIGNATURE_SIZE];
+    uint16_t signatureSize;
+    uint16_t blockCount;
+    /* bit set for each block written in the bank, same layout as the bitmap of the OTA agent */
+    uint8_t written[OTA_PAL_RESUME_BITMAP_SIZE];
+} OtaPalResumeRecord_t;
+
+/* Request window adapted to the round trip of the data requests */
+typedef struct
+{
+    /* blocks of the next request */
+    uint32_t window;
+    uint32_t maxWindow;
+    /* a gap this long between two blocks means the agent had to request again, half the request wait */
+    uint32_t stallMs;
+    /* blocks asked and received for the current request */
+    uint32_t expected;
+    uint32_t received;
+    uint32_t firstBlockMs;
+    uint32_t lastBlockMs;
+    /* set when the last block of a request was received, the agent sends the next request right after */
+    bool requestSent;
+    /* smoothed round trip and time between two blocks of a request, 0 until measured */
+    uint32_t rttMs;
+    uint32_t blockMs;
+    /* statistics */
+    uint32_t requests;
+    uint32_t stalls;
+} OtaPalWindow_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init the record of a new file, no block written
+ * @param record record to init
+ * @param imgType image type the file is written as
+ * @param fileSize size of the file
+ * @param blockSize size of the data blocks
+ * @param serverFileId file ID in the OTA job
+ * @param jobName name of the OTA job
+ * @param signature signature of the file
+ * @param signatureSize size of the signature
+ * @return false if the file has too many blocks to be tracked
+ */
+bool otaPalResume_InitRecord(OtaPalResumeRecord_t *record,
+                             int32_t imgType,
+                             uint32_t fileSize,
+                             uint32_t blockSize,
+                             uint32_t serverFileId,
+                             const uint8_t *jobName,
+                             const uint8_t *signature,
+                             uint16_t signatureSize);
+
+/**
+ * @brief Check if a saved record is about the same file of the same job
+ * @param saved record read from the flash
+ * @param current record of the file about to be received
+ * @return true if the blocks of the saved record can be kept
+ */
+bool otaPalResume_Matches(const OtaPalResumeRecord_t *saved, const OtaPalResumeRecord_t *current);
+
+/**
+ * @brief Mark a block as written in the bank
+ * @param record record of the file
+ * @param offset offset of the block in the file
+ */
+void otaPalResume_MarkWritten(OtaPalResumeRecord_t *record, uint32_t offset);
+
+/**
+ * @brief Check if a block is written in the bank
+ * @param record record of the file
+ * @param block index of the block
+ * @return true if the block is written
+ */
+bool otaPalResume_IsWritten(const OtaPalResumeRecord_t *record, uint32_t block);
+
+/**
+ * @brief Size of a block of the file, the last one can be shorter
+ * @param record record of the file
+ * @param block index of the block
+ * @return size of the block
+ */
+uint32_t otaPalResume_BlockLen(const OtaPalResumeRecord_t *record, uint32_t block);
+
+/**
+ * @brief End of the last block written, the length of the image in the bank
+ * @param record record of the file
+ * @return length written
+ */
+uint32_t otaPalResume_WrittenLen(const OtaPalResumeRecord_t *record);
+
+/**
+ * @brief Get the range to erase before writing a block.
+ * The first block written in an erase unit erases the whole unit when none of its blocks is written yet, the next
+ * blocks of the unit need no erase. A block in a unit partly written is erased alone.
+ * @param record record of the file
+ * @param erased bitmap of the blocks erased since the bank was opened, updated
+ * @param unitSize size of the erase unit of the flash, the block is erased alone if it is not larger than a block
+ * @param offset offset of the block in the file
+ * @param eraseOffset start of the range to erase
+ * @param eraseLen length of the range to erase
+ * @return false if the block is already erased
+ */
+bool otaPalResume_EraseRange(const OtaPalResumeRecord_t *record,
+                             uint8_t *erased,
+                             uint32_t unitSize,
+                             uint32_t offset,
+                             uint32_t *eraseOffset,
+                             uint32_t *eraseLen);
+
+/**
+ * @brief Mark the written blocks as received in the bitmap of the OTA agent.
+ * One block is always left missing, the agent closes the file when it receives its last block.
+ * @param record record of the file
+ * @param rxBitmap bitmap of the OTA agent, bit set for the missing blocks
+ * @param blocksRemaining blocks the OTA agent still has to receive
+ * @param restoredBytes bytes of the blocks restored
+ * @return number of blocks restored
+ */
+uint32_t otaPalResume_Restore(OtaPalResumeRecord_t *record,
+                              uint8_t *rxBitmap,
+                              uint32_t *blocksRemaining,
+                              uint32_t *restoredBytes);
+
+/**
+ * @brief Init a request window
+ * @param window window to init
+ * @param maxWindow largest number of blocks requested at once
+ * @param stallMs time after which the OTA agent requests the blocks again
+ */
+void otaPalWindow_Init(OtaPalWindow_t *window, uint32_t maxWindow, uint32_t stallMs);
+
+/**
+ * @brief Get the number of blocks to request
+ * @param window request window
+ * @return number of blocks
+ */
+uint32_t otaPalWindow_Get(const OtaPalWindow_t *window);
+
+/**
+ * @brief Account a block received, and size the next request when it is the last block of the current one
+ * @param window request window
+ * @param nowMs time of reception, in ms
+ */
+void otaPalWindow_OnBlock(OtaPalWindow_t *window, uint32_t nowMs);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _AWS_OTA_PAL_RESUME_H_ */
@@ -24,6 +24,9 @@
 #define APP_B_SIGNING_CERT "app_b_sign_cert.dat"
 #define CRED_SIGNING_CERT  "cred_sign_cert.dat"
 
+/* Blocks of the OTA file already written, to resume an interrupted download */
+#define OTA_RESUME_FILE_NAME "ota_resume.dat"
+
 /* Save registers in case of failure */
 #define FAULT_STATUSREG_LOG_FILE_NAME "fault_statusreg_log.dat"
 
@@ -68,6 +68,19 @@ static fica_t s_fica = {0};
  */
 
 int32_t FICA_app_program_ext_init(int32_t newimgtype)
+{
+    int32_t status = FICA_app_program_ext_open(newimgtype, 0);
+
+    if (SLN_FLASH_NO_ERROR == status)
+    {
+        // Erase all pages in this App bank
+        status = FICA_Erase_Bank(s_newAppImgStartAddr, s_newAppImgMaxSize);
+    }
+
+    return status;
+}
+
+int32_t FICA_app_program_ext_open(int32_t newimgtype, uint32_t currlen)
 {
     status_t status;
     int32_t curimgtype = FICA_IMG_TYPE_NONE;
@@ -108,15 +121,14 @@ int32_t FICA_app_program_ext_init(int32_t newimgtype)
         status = FICA_get_app_img_max_size(s_newAppImgType, &s_newAppImgMaxSize);
     }
 
-    s_newAppCurrLen = 0;
-    FICA_clear_buf(s_appImgBuffer, 0xFF, FLASH_SECTOR_SIZE);
-
-    if (SLN_FLASH_NO_ERROR == status)
+    if ((SLN_FLASH_NO_ERROR == status) && (currlen > s_newAppImgMaxSize))
     {
-        // Erase all pages in this App bank
-        status = FICA_Erase_Bank(s_newAppImgStartAddr, s_newAppImgMaxSize);
+        status = SLN_FLASH_ERROR;
     }
 
+    s_newAppCurrLen = (SLN_FLASH_NO_ERROR == status) ? currlen : 0;
+    FICA_clear_buf(s_appImgBuffer, 0xFF, FLASH_SECTOR_SIZE);
+
     if (SLN_FLASH_NO_ERROR == status)
     {
         status = FICA_set_comm_flag(FICA_COMM_AIS_NAI_BIT);
@@ -125,6 +137,37 @@ int32_t FICA_app_program_ext_init(int32_t newimgtype)
     return status;
 }
 
+int32_t FICA_app_program_ext_erase(uint32_t offset, uint32_t len)
+{
+    // Only whole sectors are erased, the range must not share a sector with data already written.
+    if ((offset % EXT_FLASH_ERASE_PAGE) || (len == 0))
+        return (SLN_FLASH_ERROR);
+
+    if ((offset + len) > s_newAppImgMaxSize)
+        return (SLN_FLASH_ERROR);
+
+    for (uint32_t runaddr = offset; runaddr < (offset + len); runaddr += EXT_FLASH_ERASE_PAGE)
+    {
+#if defined(ERASE_BLOCK_SUPPORT)
+        // Use the larger erase where the range covers a whole block
+        if ((((s_newAppImgStartAddr + runaddr) % EXT_FLASH_ERASE_BLOCK) == 0) &&
+            ((offset + len - runaddr) >= EXT_FLASH_ERASE_BLOCK))
+        {
+            if (SLN_Erase_Block(s_newAppImgStartAddr + runaddr) != kStatus_Success)
+                return (SLN_FLASH_ERROR);
+
+            runaddr += EXT_FLASH_ERASE_BLOCK - EXT_FLASH_ERASE_PAGE;
+            continue;
+        }
+#endif /* ERASE_BLOCK_SUPPORT */
+
+        if (SLN_Erase_Sector(s_newAppImgStartAddr + runaddr) != kStatus_Success)
+            return (SLN_FLASH_ERROR);
+    }
+
+    return (SLN_FLASH_NO_ERROR);
+}
+
 int32_t FICA_app_program_ext_abs(uint32_t offset, uint8_t *bufptr, uint32_t writelen)
 {
     // Write the image buffer to the external flash
@@ -1253,6 +1296,19 @@ int32_t FICA_SetCurAppStartType(int32_t imgtype)
 }
 
 int32_t FICA_bank_program_ext_init(fica_img_bank_t newImgBank)
+{
+    int32_t status = FICA_bank_program_ext_open(newImgBank, 0);
+
+    if (SLN_FLASH_NO_ERROR == status)
+    {
+        // Erase all pages in this App bank
+        status = FICA_Erase_Bank(s_newAppImgStartAddr, s_newAppImgMaxSize);
+    }
+
+    return status;
+}
+
+int32_t FICA_bank_program_ext_open(fica_img_bank_t newImgBank, uint32_t currlen)
 {
     status_t status;
     int32_t curImgBank = FICA_IMG_BANK_NONE;
@@ -1288,18 +1344,17 @@ int32_t FICA_bank_program_ext_init(fica_img_bank_t newImgBank)
     }
 #endif /* ENABLE_REMAP */
 
+    if (currlen > FICA_IMG_BANK_SIZE)
+    {
+        status = SLN_FLASH_ERROR;
+    }
+
     s_newAppImgMaxSize = FICA_IMG_BANK_SIZE;
-    s_newAppCurrLen    = 0;
+    s_newAppCurrLen    = currlen;
     s_newAppImgType    = FICA_IMG_TYPE_NONE;
 
     FICA_clear_buf(s_appImgBuffer, 0xFF, FLASH_SECTOR_SIZE);
 
-    if (SLN_FLASH_NO_ERROR == status)
-    {
-        // Erase all pages in this App bank
-        status = FICA_Erase_Bank(s_newAppImgStartAddr, s_newAppImgMaxSize);
-    }
-
     if (SLN_FLASH_NO_ERROR == status)
     {
         status = FICA_set_comm_flag(FICA_COMM_AIS_NAI_BIT);
@@ -63,12 +63,40 @@ extern "C" {
  */
 int32_t FICA_bank_program_ext_init(fica_img_bank_t newImgBank);
 
+/*!
+ * @brief Same as FICA_bank_program_ext_init but the bank is not erased, used to resume an interrupted write.
+ *
+ * @param newImgBank New bank in which to write the data.
+ * @param currlen Length of the data already written in the bank.
+ * @return SLN_FLASH_NO_ERROR if operation was succesfull
+ */
+int32_t FICA_bank_program_ext_open(fica_img_bank_t newImgBank, uint32_t currlen);
+
 /*!
  * @brief Initialize the Application Program External Flash Interface
  *
  */
 int32_t FICA_app_program_ext_init(int32_t newimgtype);
 
+/*!
+ * @brief Initialize the Application Program External Flash Interface without erasing the bank.
+ * The sectors must be erased with FICA_app_program_ext_erase before they are written.
+ *
+ * @param newimgtype New image type
+ * @param currlen Length of the image already written in the bank, 0 for a new image
+ * @return SLN_FLASH_NO_ERROR if operation was succesfull
+ */
+int32_t FICA_app_program_ext_open(int32_t newimgtype, uint32_t currlen);
+
+/*!
+ * @brief Erase the sectors of the new image bank covering [offset, offset + len)
+ *
+ * @param offset Offset in the bank, must be EXT_FLASH_ERASE_PAGE aligned
+ * @param len Length to erase, rounded up to EXT_FLASH_ERASE_PAGE
+ * @return SLN_FLASH_NO_ERROR if operation was succesfull
+ */
+int32_t FICA_app_program_ext_erase(uint32_t offset, uint32_t len);
+
 /*!
  * @brief Blocking image program to external flash
  * This is part of a blocking image program, but the actual small buffer flash write is blocking
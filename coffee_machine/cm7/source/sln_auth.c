@@ -669,6 +669,49 @@ int32_t SLN_AUTH_Verify_Signature(uint8_t *vfPem, uint8_t *msg, size_t msglen, u
     return ret;
 }
 
+int32_t SLN_AUTH_Verify_Signature_Hash(uint8_t *vfPem, uint8_t *hash, uint32_t hashSize, uint8_t *msgsig)
+{
+    int32_t ret    = SLN_AUTH_OK; // SLN_AUTH return code
+    int32_t status = 0;           // mbedTLS status code
+
+    mbedtls_x509_crt_init(&s_verifCert);
+
+    if ((NULL == vfPem) || (NULL == hash) || (NULL == msgsig))
+    {
+        ret = SLN_AUTH_NULL_PTR;
+    }
+    else if (mbedtls_md_get_size(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256)) != hashSize)
+    {
+        ret = SLN_AUTH_NO_MEM;
+    }
+
+    if (SLN_AUTH_OK == ret)
+    {
+        // Parse Verification Cert
+        status = mbedtls_x509_crt_parse(&s_verifCert, vfPem, safe_strlen((char *)vfPem, MAX_CERT_LEN) + 1);
+
+        if (status)
+        {
+            configPRINTF(("ERROR: Could not parse verification certificate, -0x%X.\r\n", -status));
+            ret = SLN_AUTH_BAD_CERT;
+        }
+    }
+
+    if (SLN_AUTH_OK == ret)
+    {
+        status = mbedtls_pk_verify(&(s_verifCert.pk), MBEDTLS_MD_SHA256, hash, hashSize, msgsig, RSA_SIG_LEN);
+        if (status)
+        {
+            configPRINTF(("ERROR: Could not authenticate message, -0x%X.\r\n", -status));
+            ret = SLN_AUTH_INVALID_SIG;
+        }
+    }
+
+    mbedtls_x509_crt_free(&s_verifCert);
+
+    return ret;
+}
+
 #if UPDATER_SUPPORT_ENABLED
 int32_t SLN_AUTH_Parse_Cert(uint8_t *vfPem)
 {
@@ -93,6 +93,12 @@ int32_t SLN_AUTH_Verify_Cert(uint8_t *caPem, uint8_t *vfPem);
  */
 int32_t SLN_AUTH_Verify_Signature(uint8_t *vfPem, uint8_t *msg, size_t msglen, uint8_t *msgsig);
 
+/*!
+ * @brief Verify RSA signature against given certificate, from the SHA256 of the message
+ *
+ */
+int32_t SLN_AUTH_Verify_Signature_Hash(uint8_t *vfPem, uint8_t *hash, uint32_t hashSize, uint8_t *msgsig);
+
 /*!
  * @brief Generates the Hash for a specific message found in the memory.
  * No copy in intermediate buffer will be done.
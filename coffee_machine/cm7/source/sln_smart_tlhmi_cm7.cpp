@@ -109,6 +109,13 @@ HAL_VOICEALGO_DEV_DECLARE(Asr);
 HAL_VOICEALGO_DEV_DECLARE(Asr_VIT);
 HAL_VALGO_DEV_DECLARE(OasisCoffeeMachine);
 HAL_CAMERA_DEV_DECLARE(2DSim);
+#ifdef ENABLE_CAMERA_DEV_2DTrace
+#ifndef ENABLE_GFX_DEV_Pxp
+#error "The 2DTrace camera converts its frames with the PXP, add the fsl_pxp driver and define ENABLE_GFX_DEV_Pxp"
+#endif /* ENABLE_GFX_DEV_Pxp */
+HAL_CAMERA_DEV_DECLARE(2DTrace);
+HAL_GFX_DEV_DECLARE(Pxp);
+#endif /* ENABLE_CAMERA_DEV_2DTrace */
 /* Add new HAL device declarations here */
 
 unsigned int FWK_CurrentTimeUs();
@@ -181,6 +188,11 @@ int APP_RegisterHalDevices(void)
 #endif /* ENABLE_DSMT_ASR */
     HAL_VALGO_DEV_REGISTER(OasisCoffeeMachine, ret);
     // HAL_CAMERA_DEV_REGISTER(2DSim, ret);
+#ifdef ENABLE_CAMERA_DEV_2DTrace
+    /* replays a camera trace from littlefs, the camera manager runs on this core to feed the vision algorithm */
+    HAL_GFX_DEV_REGISTER(Pxp, ret);
+    HAL_CAMERA_DEV_REGISTER(2DTrace, ret);
+#endif /* ENABLE_CAMERA_DEV_2DTrace */
 #if defined(ENABLE_MASTER) && ENABLE_MASTER
     HAL_MULTICORE_DEV_REGISTER(MessageBuffer, ret);
 #endif /* defined(ENABLE_MASTER) && ENABLE_MASTER */
@@ -199,6 +211,9 @@ int APP_StartFramework(void)
     FWK_MANAGER_START(InputManager, INPUT_MANAGER_TASK_PRIORITY, ret);
     FWK_MANAGER_START(VoiceAlgoManager, VOICE_ALGO_MANAGER_TASK_PRIORITY, ret);
     // FWK_MANAGER_START(CameraManager, CAMERA_MANAGER_TASK_PRIORITY, ret);
+#ifdef ENABLE_CAMERA_DEV_2DTrace
+    FWK_MANAGER_START(CameraManager, CAMERA_MANAGER_TASK_PRIORITY, ret);
+#endif /* ENABLE_CAMERA_DEV_2DTrace */
 #if defined(ENABLE_MASTER) && ENABLE_MASTER
     FWK_MANAGER_START(MulticoreManager, MULTICORE_MANAGER_TASK_PRIORITY, ret);
 #endif /* defined(ENABLE_MASTER) && ENABLE_MASTER */
@@ -549,7 +549,50 @@ status_t SLN_Update_VerifyImgBank(fica_img_type_t imgType, uint8_t *imgSig, uint
 #endif /* !DISABLE_IMAGE_VERIFICATION */
 }
 
-status_t SLN_Update_PrepareImgBank(fica_img_type_t imgType, uint32_t size)
+status_t SLN_Update_VerifyImgHash(fica_img_type_t imgType, uint8_t *imgHash, uint8_t *imgSig, uint8_t *imgCert)
+{
+#if !DISABLE_IMAGE_VERIFICATION
+    status_t status    = kStatus_Success;
+    int32_t fica_error = SLN_FLASH_NO_ERROR;
+
+    if ((imgHash == NULL) || (imgSig == NULL) || (imgCert == NULL) || (imgType != s_preparedImgType))
+    {
+        status = kStatus_InvalidArgument;
+    }
+
+    if (kStatus_Success == status)
+    {
+        // Verify this certificate
+        fica_error = FICA_Verify_Certificate_From_Buffer(imgCert);
+
+        if (SLN_FLASH_NO_ERROR == fica_error)
+        {
+            fica_error = SLN_AUTH_Verify_Signature_Hash(imgCert, imgHash, SHA256_HASH_SIZE, imgSig);
+        }
+    }
+
+    if (SLN_FLASH_NO_ERROR != fica_error)
+    {
+        status = kStatus_Fail;
+    }
+
+    return status;
+
+#else
+    return kStatus_Success;
+#endif /* !DISABLE_IMAGE_VERIFICATION */
+}
+
+/**
+ * @brief Prepare FICA for an update operation, erasing the whole bank or keeping what was written
+ *
+ * @param imgType Img type for which to do the preparation
+ * @param size Size of the image. If the size of the image is not known 0 can be passed.
+ * @param erase true to erase the bank, false to leave the erase to SLN_Update_EraseImg
+ * @param writtenLen Length of the image already written in the bank when it is not erased
+ * @return
+ */
+static status_t SLN_Update_InitImgBank(fica_img_type_t imgType, uint32_t size, bool erase, uint32_t writtenLen)
 {
     int32_t flashError = SLN_FLASH_NO_ERROR;
     status_t status    = kStatus_Success;
@@ -567,7 +610,8 @@ status_t SLN_Update_PrepareImgBank(fica_img_type_t imgType, uint32_t size)
             }
             else
             {
-                flashError = FICA_app_program_ext_init(imgType);
+                flashError = erase ? FICA_app_program_ext_init(imgType) :
+                                     FICA_app_program_ext_open(imgType, writtenLen);
             }
         }
         break;
@@ -582,7 +626,8 @@ status_t SLN_Update_PrepareImgBank(fica_img_type_t imgType, uint32_t size)
             else
             {
                 // Init FICA to be ready for the new application
-                flashError = FICA_app_program_ext_init(imgType);
+                flashError = erase ? FICA_app_program_ext_init(imgType) :
+                                     FICA_app_program_ext_open(imgType, writtenLen);
             }
         }
         break;
@@ -600,14 +645,13 @@ status_t SLN_Update_PrepareImgBank(fica_img_type_t imgType, uint32_t size)
             }
             else if (SLN_FLASH_NO_ERROR == flashError)
             {
-                if (curBank == FICA_IMG_BANK_A)
+                fica_img_bank_t newBank = (curBank == FICA_IMG_BANK_A) ? FICA_IMG_BANK_B : FICA_IMG_BANK_A;
+
+                if ((curBank == FICA_IMG_BANK_A) || (curBank == FICA_IMG_BANK_B))
                 {
                     // Init FICA to be ready for the new application
-                    flashError = FICA_bank_program_ext_init(FICA_IMG_BANK_B);
-                }
-                else if (curBank == FICA_IMG_BANK_B)
-                {
-                    flashError = FICA_bank_program_ext_init(FICA_IMG_BANK_A);
+                    flashError = erase ? FICA_bank_program_ext_init(newBank) :
+                                         FICA_bank_program_ext_open(newBank, writtenLen);
                 }
             }
         }
@@ -633,6 +677,31 @@ status_t SLN_Update_PrepareImgBank(fica_img_type_t imgType, uint32_t size)
     return status;
 }
 
+status_t SLN_Update_PrepareImgBank(fica_img_type_t imgType, uint32_t size)
+{
+    return SLN_Update_InitImgBank(imgType, size, true, 0);
+}
+
+status_t SLN_Update_OpenImgBank(fica_img_type_t imgType, uint32_t size, uint32_t writtenLen)
+{
+    return SLN_Update_InitImgBank(imgType, size, false, writtenLen);
+}
+
+status_t SLN_Update_EraseImg(fica_img_type_t imgType, uint32_t offset, uint32_t size)
+{
+    if ((size == 0) || (imgType != s_preparedImgType))
+    {
+        return kStatus_InvalidArgument;
+    }
+
+    if (SLN_FLASH_NO_ERROR != FICA_app_program_ext_erase(offset, size))
+    {
+        return kStatus_Fail;
+    }
+
+    return kStatus_Success;
+}
+
 status_t SLN_Update_WriteImg(fica_img_type_t imgType, uint32_t offset, uint8_t *buffer, uint32_t size)
 {
     status_t status    = kStatus_Success;
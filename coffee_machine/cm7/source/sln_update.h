@@ -73,6 +73,18 @@ status_t SLN_Update_ParseBundle(fica_img_bank_t bundleBank);
  */
 status_t SLN_Update_VerifyImgBank(fica_img_type_t imgType, uint8_t *imgSig, uint8_t *imgCert);
 
+/*!
+ * @brief Verify the signature for the just written image, from the SHA256 of the image computed while it was written.
+ *
+ * @param imgType imgType for the application to check the signature
+ * @param imgHash SHA256 of the new img
+ * @param imgSig New img signature
+ * @param imgCert New img certification
+ * @return kStatus_InvalidArgument if imgHash, imgSig or imgCert are NULL or if imgType was not prepared
+ * kStatus_Fail if the verification failed.
+ */
+status_t SLN_Update_VerifyImgHash(fica_img_type_t imgType, uint8_t *imgHash, uint8_t *imgSig, uint8_t *imgCert);
+
 /*!
  * @brief Prepare app for update.
  * Prepare FICA for an update operation
@@ -84,6 +96,28 @@ status_t SLN_Update_VerifyImgBank(fica_img_type_t imgType, uint8_t *imgSig, uint
  */
 status_t SLN_Update_PrepareImgBank(fica_img_type_t imgType, uint32_t size);
 
+/*!
+ * @brief Prepare app for update without erasing the bank.
+ * Used to resume an interrupted update, or to erase the bank chunk by chunk with SLN_Update_EraseImg
+ * while the image is received.
+ *
+ * @param imgType Img type for which to do the preparation
+ * @param size Size of the image. If the size of the image is not known 0 can be passed.
+ * @param writtenLen Length of the image already written in the bank, 0 for a new image
+ * @return
+ */
+status_t SLN_Update_OpenImgBank(fica_img_type_t imgType, uint32_t size, uint32_t writtenLen);
+
+/*!
+ * @brief Erase a chunk of the bank opened with SLN_Update_OpenImgBank before writing it
+ *
+ * @param imgType Img type that needs to be written
+ * @param offset Offset of the chunk in the image, FLASH_SECTOR_SIZE aligned
+ * @param size Size of the chunk, rounded up to FLASH_SECTOR_SIZE
+ * @return
+ */
+status_t SLN_Update_EraseImg(fica_img_type_t imgType, uint32_t offset, uint32_t size);
+
 /*!
  * @brief Write the image in the flash. To be called only after SLN_Update_PrepareImgBank
  *
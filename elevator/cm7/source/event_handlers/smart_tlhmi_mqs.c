@@ -8,7 +8,7 @@
  */
 
 #include "board_define.h"
-#ifdef ENABLE_OUTPUT_DEV_MqsAudio
+#if defined(ENABLE_OUTPUT_DEV_MqsAudio) || defined(ENABLE_OUTPUT_DEV_MqsStreamerAudio)
 #include "stdint.h"
 #include "hal_voice_algo_asr_local.h"
 #include "hal_event_descriptor_common.h"
@@ -243,4 +243,16 @@ int APP_OutputDev_MqsAudio_InputNotifyDecode(
     }
     return 0;
 }
-#endif /* ENABLE_OUTPUT_DEV_MqsAudio */
+
+/* The prompts of LoadAudioPrompts, the MQS streamer device caches them by id */
+uint32_t APP_OutputDev_MqsAudio_GetPromptCount(void)
+{
+    return PROMPT_INVALID;
+}
+
+/* The prompts are only played on kEventID_PlayPrompt, no inference result is decoded to a prompt */
+int32_t APP_OutputDev_MqsAudio_InferCompletePromptId(output_algo_source_t source, void *inferResult)
+{
+    return -1;
+}
+#endif /* defined(ENABLE_OUTPUT_DEV_MqsAudio) || defined(ENABLE_OUTPUT_DEV_MqsStreamerAudio) */
@@ -727,6 +727,69 @@ sln_flash_fs_status_t SLN_FLASH_LITTLEFS_Update(const char *name, uint8_t *data,
     return ret;
 }
 
+sln_flash_fs_status_t SLN_FLASH_LITTLEFS_Write(const char *name, uint8_t *data, uint32_t offset, uint32_t len)
+{
+    file_meta_t file_meta;
+    sln_flash_fs_status_t ret = SLN_FLASH_FS_OK;
+    int32_t littlefs_res      = 0;
+
+    if ((name == NULL) || (data == NULL) || (len == 0))
+    {
+        return SLN_FLASH_FS_EINVAL;
+    }
+
+    if (_lock(s_LittlefsHandler.lock))
+    {
+        return SLN_FLASH_FS_ENOLOCK;
+    }
+
+    LFS_GetDefaultFileConfig(&file_meta);
+
+    /* check if the dir exists */
+    ret = LFS_CheckBasePath(name);
+
+    if (ret == SLN_FLASH_FS_OK)
+    {
+        littlefs_res = lfs_file_opencfg(&s_LittlefsHandler.lfs, &file_meta.file, name, LFS_O_WRONLY, &file_meta.cfg);
+        if (littlefs_res == LFS_ERR_NOENT)
+        {
+            ret = SLN_FLASH_FS_ENOENTRY2;
+        }
+        else if (littlefs_res < 0)
+        {
+            ret = SLN_FLASH_FS_FAIL;
+        }
+        else
+        {
+            lfs_getattr(&s_LittlefsHandler.lfs, name, ATTR_ENCRYPT, file_meta.attrs[0].buffer, file_meta.attrs[0].size);
+            if (file_meta.encryptInfo.useEncryption)
+            {
+                /* Not supported for now, the whole file is encrypted at once */
+                ret = SLN_FLASH_FS_FAIL;
+            }
+            else if (lfs_file_seek(&s_LittlefsHandler.lfs, &file_meta.file, offset, LFS_SEEK_SET) < 0)
+            {
+                ret = SLN_FLASH_FS_FAIL;
+            }
+
+            if (ret == SLN_FLASH_FS_OK)
+            {
+                ret = LFS_SaveFileContent(&file_meta, data, len);
+            }
+
+            /* the data is committed when the file is closed */
+            if ((lfs_file_close(&s_LittlefsHandler.lfs, &file_meta.file) < 0) && (ret == SLN_FLASH_FS_OK))
+            {
+                ret = SLN_FLASH_FS_FAIL;
+            }
+        }
+    }
+
+    _unlock(s_LittlefsHandler.lock);
+
+    return ret;
+}
+
 sln_flash_fs_status_t SLN_FLASH_LITTLEFS_Read(const char *name, uint8_t *data, uint32_t offset, uint32_t *len)
 {
     file_meta_t file_meta;
@@ -90,6 +90,19 @@ sln_flash_fs_status_t SLN_FLASH_LITTLEFS_Append(const char *name, uint8_t *data,
 
 sln_flash_fs_status_t SLN_FLASH_LITTLEFS_Update(const char *name, uint8_t *data, uint32_t *len);
 
+/*!
+ * @brief Overwrite part of an existing file in place, the rest of the file is kept.
+ * Not working for encrypted files
+ *
+ * @param name String name of entry/file to write into
+ * @param data Pointer to data to write
+ * @param offset Position in the file of the first byte to write
+ * @param len Length in bytes to write
+ *
+ * @returns Status of write [will fail with SLN_FLASH_FS_ENOENTRY2 if no entry]
+ */
+sln_flash_fs_status_t SLN_FLASH_LITTLEFS_Write(const char *name, uint8_t *data, uint32_t offset, uint32_t len);
+
 /*!
  * @brief Read from a named entry
  *
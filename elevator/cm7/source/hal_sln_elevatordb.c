@@ -9,6 +9,7 @@
 
 #include <FreeRTOS.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "fwk_log.h"
@@ -18,6 +19,13 @@
 
 #define ELEVATOR_DIR "elevator"
 
+/* All the entries are packed in fixed size slots of one file, after a header with the bitmap of the used slots */
+#define TABLE_FILE_NAME \
+    ELEVATOR_DIR        \
+    "/"                 \
+    "Table"
+
+/* Layout of the versions 1 and 2, one metadata file and one file per entry, migrated to the table */
 #define METADATA_FILE_NAME \
     ELEVATOR_DIR           \
     "/"                    \
@@ -27,6 +35,12 @@
     ELEVATOR_DIR          \
     "/"
 
+#define ELEVATOR_DB_MAGIC    0x54424445 /* "EDBT" */
+#define ELEVATOR_DB_MAP_SIZE ((ELEVATOR_DB_MAX_SIZE + 7) / 8)
+
+/* The files of the per entry layout are still to be removed */
+#define ELEVATOR_DB_FLAG_LEGACY_CLEANUP (1 << 0)
+
 typedef enum _mapping_bitwise
 {
     kMappingBitWise_Saved,
@@ -45,6 +59,26 @@ static elevatordb_status_t HAL_ElevatorDb_DelWithId(uint16_t id);
 static elevatordb_status_t HAL_ElevatorDb_UpdWithId(uint16_t id, elevator_attr_t *attr);
 static elevatordb_status_t HAL_ElevatorDb_GetWithId(uint16_t id, elevator_attr_t *attr);
 
+typedef struct _elevatordb_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint16_t maxCount;
+    uint16_t entrySize;
+    uint32_t flags;
+    uint8_t reserved[8];
+    /* bit id is set when the slot id is used */
+    uint8_t map[ELEVATOR_DB_MAP_SIZE];
+} elevatordb_header_t;
+
+typedef struct _elevatordb_table
+{
+    elevatordb_header_t header;
+    elevator_attr_t entries[ELEVATOR_DB_MAX_SIZE];
+} elevatordb_table_t;
+
+/* Metadata file of the per entry layout */
 typedef struct _elevatordb_metadata
 {
     uint32_t version;
@@ -65,9 +99,8 @@ const elevatordb_ops_t g_elevatordb_ops = {
     .getWithId = HAL_ElevatorDb_GetWithId,
 };
 
-static elevatordb_metadata_t s_elevatorDbMetaData;
-static uint8_t *s_pElevatorDbBuffer       = NULL;
-static SemaphoreHandle_t s_elevatorDbLock = NULL;
+static elevatordb_table_t *s_pElevatorDbTable = NULL;
+static SemaphoreHandle_t s_elevatorDbLock     = NULL;
 
 /*******************************************************************************
  * Code
@@ -108,264 +141,238 @@ static void _HAL_ElevatorDb_GeneratePathFromIndex(uint16_t id, char *path)
 
 static uint32_t _HAL_ElevatorDb_GetEntrySize(void)
 {
-    return s_elevatorDbMetaData.entrySize;
+    return s_pElevatorDbTable->header.entrySize;
 }
 
 static uint32_t _HAL_ElevatorDb_GetMaxCount(void)
 {
-    return s_elevatorDbMetaData.maxCount;
-}
-
-static uint32_t _HAL_ElevatorDb_GetBufferSize(void)
-{
-    return s_elevatorDbMetaData.bufferSize;
+    return s_pElevatorDbTable->header.maxCount;
 }
 
-static uint8_t _HAL_ElevatorDb_CheckMapFlag(uint16_t id, uint8_t bitWise)
+static uint8_t _HAL_ElevatorDb_IsUsed(uint16_t id)
 {
-    return (s_elevatorDbMetaData.map[id] & 1 << bitWise);
+    return (s_pElevatorDbTable->header.map[id / 8] & (1 << (id % 8))) != 0;
 }
 
-static void _HAL_ElevatorDb_SetMapFlag(uint16_t id, uint8_t flag)
+static void _HAL_ElevatorDb_SetUsed(uint16_t id, uint8_t used)
 {
-    if ((_HAL_ElevatorDb_CheckMapFlag(id, kMappingBitWise_Used) == NOT_USED) &&
-        ((flag & (1 << kMappingBitWise_Used)) == IN_USE))
+    if (!_HAL_ElevatorDb_IsUsed(id) && used)
     {
-        s_elevatorDbMetaData.map[id] = flag;
-        s_elevatorDbMetaData.count++;
+        s_pElevatorDbTable->header.map[id / 8] |= (1 << (id % 8));
+        s_pElevatorDbTable->header.count++;
     }
-    else if ((_HAL_ElevatorDb_CheckMapFlag(id, kMappingBitWise_Used) == IN_USE) &&
-             ((flag & (1 << kMappingBitWise_Used)) == NOT_USED))
+    else if (_HAL_ElevatorDb_IsUsed(id) && !used)
     {
-        s_elevatorDbMetaData.map[id] = flag;
-        s_elevatorDbMetaData.count--;
+        s_pElevatorDbTable->header.map[id / 8] &= ~(1 << (id % 8));
+        s_pElevatorDbTable->header.count--;
     }
 }
 
-#define _HAL_ElevatorDb_AndMapFlag(id, flag)   \
-    {                                          \
-        s_elevatorDbMetaData.map[id] &= ~flag; \
-    }
-
-#define _HAL_ElevatorDb_OrMapFlag(id, flag)   \
-    {                                         \
-        s_elevatorDbMetaData.map[id] |= flag; \
-    }
-
 static elevator_attr_t *_HAL_ElevatorDb_GetEntry(uint16_t id)
 {
-    return (elevator_attr_t *)(s_pElevatorDbBuffer + _HAL_ElevatorDb_GetEntrySize() * id);
+    return &s_pElevatorDbTable->entries[id];
 }
 
-static elevatordb_status_t _HAL_ElevatorDb_SetMetaDataDefault(void)
+static void _HAL_ElevatorDb_SetDefault(void)
 {
-    elevatordb_status_t status = kElevatorDBStatus_Success;
-
-    memset((void *)&s_elevatorDbMetaData, 0x0, sizeof(elevatordb_metadata_t));
-    s_elevatorDbMetaData.version    = ELEVATOR_DB_VERSION;
-    s_elevatorDbMetaData.maxCount   = ELEVATOR_DB_MAX_SIZE;
-    s_elevatorDbMetaData.bufferSize = sizeof(elevator_attr_t) * ELEVATOR_DB_MAX_SIZE;
-    s_elevatorDbMetaData.entrySize  = sizeof(elevator_attr_t);
-
-    return status;
+    memset(s_pElevatorDbTable, 0x0, sizeof(elevatordb_table_t));
+    s_pElevatorDbTable->header.magic     = ELEVATOR_DB_MAGIC;
+    s_pElevatorDbTable->header.version   = ELEVATOR_DB_VERSION;
+    s_pElevatorDbTable->header.maxCount  = ELEVATOR_DB_MAX_SIZE;
+    s_pElevatorDbTable->header.entrySize = sizeof(elevator_attr_t);
 }
 
-static elevatordb_status_t _HAL_ElevatorDb_SaveMetaData(void)
+/* The header and all the slots are committed together, a power loss keeps the previous table */
+static elevatordb_status_t _HAL_ElevatorDb_SaveTable(void)
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
-    sln_flash_status_t ret = FWK_Flash_Save(METADATA_FILE_NAME, &s_elevatorDbMetaData, sizeof(elevatordb_metadata_t));
+    sln_flash_status_t ret     = FWK_Flash_Save(TABLE_FILE_NAME, s_pElevatorDbTable, sizeof(elevatordb_table_t));
 
     if (kStatus_HAL_FlashSuccess != ret)
     {
-        status = kElevatorDBStatus_MetaDataFail;
+        LOGE("ElevatorDb: Failed to save the table.");
+        status = kElevatorDBStatus_Failed;
     }
 
     return status;
 }
 
-static elevatordb_status_t _HAL_ElevatorDb_SetDefault(uint8_t *pDbBuf)
+/* Rewrite one part of the table file in place */
+static elevatordb_status_t _HAL_ElevatorDb_WriteTable(uint32_t offset, uint32_t size)
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
+    sln_flash_status_t ret     = FWK_Flash_Write(TABLE_FILE_NAME, (uint8_t *)s_pElevatorDbTable + offset, offset, size);
 
-    uint32_t bufferSize = _HAL_ElevatorDb_GetBufferSize();
-    memset(pDbBuf, 0x0, bufferSize);
+    if (kStatus_HAL_FlashSuccess != ret)
+    {
+        LOGE("ElevatorDb: Failed to write the table at %d.", offset);
+        status = kElevatorDBStatus_Failed;
+    }
 
     return status;
 }
 
-static elevatordb_status_t _HAL_ElevatorDb_EraseAll(void)
+static elevatordb_status_t _HAL_ElevatorDb_SaveHeader(void)
 {
-    elevatordb_status_t status = kElevatorDBStatus_Success;
+    return _HAL_ElevatorDb_WriteTable(offsetof(elevatordb_table_t, header), sizeof(elevatordb_header_t));
+}
 
-    for (uint16_t id = 0; id < ELEVATOR_DB_MAX_SIZE; id++)
-    {
-        if ((s_elevatorDbMetaData.map[id] & (1 << kMappingBitWise_Used)) == IN_USE)
-        {
-            s_elevatorDbMetaData.map[id] &= ~(1 << kMappingBitWise_Used);
-            s_elevatorDbMetaData.count--;
+static elevatordb_status_t _HAL_ElevatorDb_SaveEntry(uint16_t id)
+{
+    return _HAL_ElevatorDb_WriteTable(offsetof(elevatordb_table_t, entries) + id * sizeof(elevator_attr_t),
+                                      sizeof(elevator_attr_t));
+}
 
-            char path[20];
-            _HAL_ElevatorDb_GeneratePathFromIndex(id, path);
-            sln_flash_status_t ret = FWK_Flash_Rm(path);
-            if (ret != kStatus_HAL_FlashSuccess && ret != kStatus_HAL_FlashFileNotExist)
-            {
-                LOGE("ElevatorDb: Failed to remove from database.");
-                continue;
-            }
-        }
-    }
+static elevatordb_status_t _HAL_ElevatorDb_EraseAll(void)
+{
+    _HAL_ElevatorDb_SetDefault();
 
-    return status;
+    return _HAL_ElevatorDb_SaveTable();
 }
 
-static elevatordb_status_t _HAL_ElevatorDb_LoadMetaData(void)
+static void _HAL_ElevatorDb_RemoveLegacy(void)
 {
-    elevatordb_status_t status = kElevatorDBStatus_Success;
-    sln_flash_status_t ret     = FWK_Flash_Mkdir(ELEVATOR_DIR);
+    elevatordb_metadata_t metadata;
+    uint32_t len           = sizeof(elevatordb_metadata_t);
+    sln_flash_status_t ret = FWK_Flash_Read(METADATA_FILE_NAME, &metadata, 0, &len);
 
-    if (ret == kStatus_HAL_FlashDirExist)
+    if (ret == kStatus_HAL_FlashSuccess)
     {
-        uint32_t len = sizeof(elevatordb_metadata_t);
-        ret          = FWK_Flash_Read(METADATA_FILE_NAME, &s_elevatorDbMetaData, 0, &len);
-        if (ret == kStatus_HAL_FlashSuccess)
+        for (uint16_t id = 0; id < ELEVATOR_DB_MAX_SIZE; id++)
         {
-            if ((s_elevatorDbMetaData.version != ELEVATOR_DB_VERSION))
+            if ((metadata.map[id] & (1 << kMappingBitWise_Used)) == IN_USE)
             {
-            	if (s_elevatorDbMetaData.version == 1)
-            	{
-            		LOGD("ElevatorDB: Version found in flash different from current version. Version is backward compatible");
-            		s_elevatorDbMetaData.version = ELEVATOR_DB_VERSION;
-            		_HAL_ElevatorDb_SaveMetaData();
-            	}
-            	else
-            	{
-                    LOGE("ElevatorDB: Version found in flash different from current version.");
-                    _HAL_ElevatorDb_EraseAll();
-                    _HAL_ElevatorDb_SetMetaDataDefault();
-                    FWK_Flash_Save(METADATA_FILE_NAME, &s_elevatorDbMetaData, sizeof(elevatordb_metadata_t));
-                    status = kElevatorDBStatus_VersionMismatch;
-            	}
+                char path[20];
+                _HAL_ElevatorDb_GeneratePathFromIndex(id, path);
+                ret = FWK_Flash_Rm(path);
+                if (ret != kStatus_HAL_FlashSuccess && ret != kStatus_HAL_FlashFileNotExist)
+                {
+                    LOGE("ElevatorDb: Failed to remove entry %d of the previous layout.", id);
+                }
             }
-
-        }
-        else
-        {
-            LOGE("ElevatorDb: Failed to open the configuration file.");
-            status = kElevatorDBStatus_MetaDataFail;
         }
     }
-    else if (ret == kStatus_HAL_FlashSuccess)
-    {
-        _HAL_ElevatorDb_SetMetaDataDefault();
-        FWK_Flash_Save(METADATA_FILE_NAME, &s_elevatorDbMetaData, sizeof(elevatordb_metadata_t));
-        LOGI("ElevatorDb: Metadata saved. Database is empty.");
-        status = kElevatorDBStatus_Success;
-    }
-    else
-    {
-        LOGE("ElevatorDb: Failed to initialise the metadata file.");
-        status = kElevatorDBStatus_MetaDataFail;
-    }
 
-    return status;
-}
-
-static elevatordb_status_t _HAL_ElevatorDb_SaveEntryData(uint16_t id)
-{
-    elevatordb_status_t status = kElevatorDBStatus_Success;
-    char path[20];
-
-    _HAL_ElevatorDb_GeneratePathFromIndex(id, path);
-    sln_flash_status_t ret = FWK_Flash_Save(path, _HAL_ElevatorDb_GetEntry(id), _HAL_ElevatorDb_GetEntrySize());
-    if (kStatus_HAL_FlashSuccess != ret)
+    /* the metadata goes last, it lists the entry files still to remove */
+    ret = FWK_Flash_Rm(METADATA_FILE_NAME);
+    if (ret != kStatus_HAL_FlashSuccess && ret != kStatus_HAL_FlashFileNotExist)
     {
-        status = kElevatorDBStatus_Failed;
+        LOGE("ElevatorDb: Failed to remove the metadata of the previous layout.");
     }
-
-    return status;
 }
 
-static elevatordb_status_t _HAL_ElevatorDb_DelEntryData(uint16_t id)
+static elevatordb_status_t _HAL_ElevatorDb_Migrate(void)
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
-    char path[20];
+    elevatordb_metadata_t metadata;
+    uint32_t len           = sizeof(elevatordb_metadata_t);
+    sln_flash_status_t ret = FWK_Flash_Read(METADATA_FILE_NAME, &metadata, 0, &len);
+
+    _HAL_ElevatorDb_SetDefault();
 
-    _HAL_ElevatorDb_GeneratePathFromIndex(id, path);
-    sln_flash_status_t ret = FWK_Flash_Rm(path);
-    if (kStatus_HAL_FlashSuccess != ret && kStatus_HAL_FlashFileNotExist != ret)
+    if (ret == kStatus_HAL_FlashFileNotExist)
     {
-        status = kElevatorDBStatus_Failed;
+        LOGI("ElevatorDb: Table saved. Database is empty.");
+        return _HAL_ElevatorDb_SaveTable();
     }
 
-    return status;
-}
-
-static elevatordb_status_t _HAL_ElevatorDb_InitMetaData(void)
-{
-    elevatordb_status_t status = kElevatorDBStatus_Success;
-
-    status = _HAL_ElevatorDb_LoadMetaData();
-
-    if ((kElevatorDBStatus_VersionMismatch != status) && (kElevatorDBStatus_Success != status))
+    if ((ret != kStatus_HAL_FlashSuccess) || ((metadata.version != 1) && (metadata.version != 2)) ||
+        (metadata.entrySize != sizeof(elevator_attr_t)))
     {
-        status = _HAL_ElevatorDb_SetMetaDataDefault();
-        if (kElevatorDBStatus_Success != _HAL_ElevatorDb_SaveMetaData())
-        {
-            LOGI("Elevator Metadata Save Fail");
-        }
+        LOGE("ElevatorDB: Version found in flash different from current version.");
+        _HAL_ElevatorDb_RemoveLegacy();
+        _HAL_ElevatorDb_SaveTable();
+        return kElevatorDBStatus_VersionMismatch;
     }
 
-    return status;
-}
+    LOGD("ElevatorDB: Migrating version %d to the table.", metadata.version);
 
-static elevatordb_status_t _HAL_ElevatorDb_Load(uint8_t *pDbBuf)
-{
-    elevatordb_status_t status = kElevatorDBStatus_Success;
-    uint32_t maxCount          = _HAL_ElevatorDb_GetMaxCount();
-    sln_flash_status_t ret     = kStatus_HAL_FlashSuccess;
-    uint8_t needUpdate         = 0;
-
-    for (int id = 0; id < maxCount; id++)
+    for (uint16_t id = 0; (id < metadata.maxCount) && (id < ELEVATOR_DB_MAX_SIZE); id++)
     {
-        if (_HAL_ElevatorDb_CheckMapFlag(id, kMappingBitWise_Used) == IN_USE)
+        if ((metadata.map[id] & (1 << kMappingBitWise_Used)) == IN_USE)
         {
             char path[20];
-            uint32_t lenEntry = _HAL_ElevatorDb_GetEntrySize();
+            uint32_t lenEntry = sizeof(elevator_attr_t);
             _HAL_ElevatorDb_GeneratePathFromIndex(id, path);
 
             ret = FWK_Flash_Read(path, _HAL_ElevatorDb_GetEntry(id), 0, &lenEntry);
-            if (ret != kStatus_HAL_FlashSuccess)
+            if (ret == kStatus_HAL_FlashSuccess)
             {
-                if (ret == kStatus_HAL_FlashFileNotExist)
-                {
-                    _HAL_ElevatorDb_SetMapFlag(id, 0);
-                    needUpdate = 1;
-                }
-                else
+                _HAL_ElevatorDb_SetUsed(id, 1);
+            }
+            else
+            {
+                memset(_HAL_ElevatorDb_GetEntry(id), 0x0, sizeof(elevator_attr_t));
+                if (ret != kStatus_HAL_FlashFileNotExist)
                 {
-                    status = kElevatorDBStatus_DbLoadFail;
+                    LOGE("ElevatorDb: Failed to migrate entry %d.", id);
                 }
             }
         }
     }
 
-    if (needUpdate)
+    /* the previous files are removed only once the table holds the entries */
+    s_pElevatorDbTable->header.flags |= ELEVATOR_DB_FLAG_LEGACY_CLEANUP;
+    status = _HAL_ElevatorDb_SaveTable();
+    if (kElevatorDBStatus_Success == status)
     {
-        _HAL_ElevatorDb_SaveMetaData();
+        _HAL_ElevatorDb_RemoveLegacy();
+        s_pElevatorDbTable->header.flags &= ~ELEVATOR_DB_FLAG_LEGACY_CLEANUP;
+        status = _HAL_ElevatorDb_SaveTable();
     }
 
     return status;
 }
 
-static elevatordb_status_t _HAL_ElevatorDb_Init(uint8_t *pDbBuf)
+static elevatordb_status_t _HAL_ElevatorDb_Load(void)
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
+    sln_flash_status_t ret     = FWK_Flash_Mkdir(ELEVATOR_DIR);
+
+    if (ret == kStatus_HAL_FlashSuccess)
+    {
+        _HAL_ElevatorDb_SetDefault();
+        _HAL_ElevatorDb_SaveTable();
+        LOGI("ElevatorDb: Table saved. Database is empty.");
+        return kElevatorDBStatus_Success;
+    }
+    else if (ret != kStatus_HAL_FlashDirExist)
+    {
+        LOGE("ElevatorDb: Failed to initialise the database directory.");
+        _HAL_ElevatorDb_SetDefault();
+        return kElevatorDBStatus_Success;
+    }
 
-    status = _HAL_ElevatorDb_Load(pDbBuf);
+    /* the whole table in one sequential read */
+    uint32_t len = sizeof(elevatordb_table_t);
+    ret          = FWK_Flash_Read(TABLE_FILE_NAME, s_pElevatorDbTable, 0, &len);
+    if (ret == kStatus_HAL_FlashFileNotExist)
+    {
+        return _HAL_ElevatorDb_Migrate();
+    }
+
+    if ((ret != kStatus_HAL_FlashSuccess) || (len != sizeof(elevatordb_table_t)) ||
+        (s_pElevatorDbTable->header.magic != ELEVATOR_DB_MAGIC))
+    {
+        LOGE("ElevatorDb: Failed to load the table.");
+        _HAL_ElevatorDb_EraseAll();
+        return kElevatorDBStatus_Success;
+    }
+
+    if ((s_pElevatorDbTable->header.version != ELEVATOR_DB_VERSION) ||
+        (s_pElevatorDbTable->header.maxCount != ELEVATOR_DB_MAX_SIZE) ||
+        (s_pElevatorDbTable->header.entrySize != sizeof(elevator_attr_t)))
+    {
+        LOGE("ElevatorDB: Version found in flash different from current version.");
+        _HAL_ElevatorDb_EraseAll();
+        return kElevatorDBStatus_VersionMismatch;
+    }
 
-    if (kElevatorDBStatus_Success != status)
+    if (s_pElevatorDbTable->header.flags & ELEVATOR_DB_FLAG_LEGACY_CLEANUP)
     {
-        _HAL_ElevatorDb_SetDefault(pDbBuf);
+        _HAL_ElevatorDb_RemoveLegacy();
+        s_pElevatorDbTable->header.flags &= ~ELEVATOR_DB_FLAG_LEGACY_CLEANUP;
+        _HAL_ElevatorDb_SaveTable();
     }
 
     return status;
@@ -375,24 +382,24 @@ static elevatordb_status_t HAL_ElevatorDb_Init(void)
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
 
-    status = _HAL_ElevatorDb_InitMetaData();
-
-    if (status != kElevatorDBStatus_Success)
+    /* kept over a second init, which follows a version mismatch */
+    if (NULL == s_pElevatorDbTable)
     {
-        return status;
+        s_pElevatorDbTable = pvPortMalloc(sizeof(elevatordb_table_t));
+
+        if (NULL == s_pElevatorDbTable)
+        {
+            LOGE("Elevator DB Entry Malloc Fail");
+            return kElevatorDBStatus_MallocFail;
+        }
     }
 
-    uint32_t maxCount             = _HAL_ElevatorDb_GetMaxCount();
-    uint32_t elevatorDbEntrySize  = sizeof(elevator_attr_t);
-    uint32_t elevatorDbBufferSize = elevatorDbEntrySize * maxCount;
-    s_pElevatorDbBuffer           = pvPortMalloc(elevatorDbBufferSize);
+    status = _HAL_ElevatorDb_Load();
 
-    if (NULL == s_pElevatorDbBuffer)
+    if (kElevatorDBStatus_VersionMismatch == status)
     {
-        LOGE("Elevator DB Entry Malloc Fail");
-        return kElevatorDBStatus_MallocFail;
+        return status;
     }
-    _HAL_ElevatorDb_Init(s_pElevatorDbBuffer);
 
     if (NULL == s_elevatorDbLock)
     {
@@ -401,8 +408,9 @@ static elevatordb_status_t HAL_ElevatorDb_Init(void)
         if (NULL == s_elevatorDbLock)
         {
             LOGE("Elevator: Failed to create DB lock semaphore");
-            vPortFree(s_pElevatorDbBuffer);
-            status = kElevatorDBStatus_LockFail;
+            vPortFree(s_pElevatorDbTable);
+            s_pElevatorDbTable = NULL;
+            status             = kElevatorDBStatus_LockFail;
         }
     }
 
@@ -413,9 +421,10 @@ static elevatordb_status_t HAL_ElevatorDb_Deinit(void)
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
 
-    if (NULL != s_pElevatorDbBuffer)
+    if (NULL != s_pElevatorDbTable)
     {
-        vPortFree(s_pElevatorDbBuffer);
+        vPortFree(s_pElevatorDbTable);
+        s_pElevatorDbTable = NULL;
     }
 
     return status;
@@ -425,7 +434,7 @@ static elevatordb_status_t HAL_ElevatorDb_AddWithId(uint16_t id, elevator_attr_t
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
 
-    if (NULL == s_pElevatorDbBuffer)
+    if (NULL == s_pElevatorDbTable)
     {
         return kElevatorDBStatus_MallocFail;
     }
@@ -436,21 +445,30 @@ static elevatordb_status_t HAL_ElevatorDb_AddWithId(uint16_t id, elevator_attr_t
     }
 
     uint32_t maxCount = _HAL_ElevatorDb_GetMaxCount();
-    if (id > maxCount)
+    if (id >= maxCount)
     {
         _HAL_ElevatorDb_Unlock();
         return kElevatorDBStatus_Failed;
     }
 
-    if (_HAL_ElevatorDb_CheckMapFlag(id, kMappingBitWise_Used) == NOT_USED)
+    if (!_HAL_ElevatorDb_IsUsed(id))
     {
-        elevator_attr_t *pCoffeeAttrEntry = _HAL_ElevatorDb_GetEntry(id);
-        memcpy(pCoffeeAttrEntry, attr, _HAL_ElevatorDb_GetEntrySize());
+        elevator_attr_t *pElevatorAttrEntry = _HAL_ElevatorDb_GetEntry(id);
+        memcpy(pElevatorAttrEntry, attr, _HAL_ElevatorDb_GetEntrySize());
 
-        _HAL_ElevatorDb_SetMapFlag(id, IN_USE);
+        /* the slot goes first, a power loss before the header is written leaves it unused */
+        status = _HAL_ElevatorDb_SaveEntry(id);
+        if (kElevatorDBStatus_Success == status)
+        {
+            _HAL_ElevatorDb_SetUsed(id, 1);
+            status = _HAL_ElevatorDb_SaveHeader();
+        }
 
-        _HAL_ElevatorDb_SaveEntryData(id);
-        _HAL_ElevatorDb_SaveMetaData();
+        if (kElevatorDBStatus_Success != status)
+        {
+            _HAL_ElevatorDb_SetUsed(id, 0);
+            memset(pElevatorAttrEntry, 0, _HAL_ElevatorDb_GetEntrySize());
+        }
     }
     else
     {
@@ -466,7 +484,7 @@ static elevatordb_status_t HAL_ElevatorDb_DelWithId(uint16_t id)
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
 
-    if (NULL == s_pElevatorDbBuffer)
+    if (NULL == s_pElevatorDbTable)
     {
         return kElevatorDBStatus_MallocFail;
     }
@@ -478,29 +496,29 @@ static elevatordb_status_t HAL_ElevatorDb_DelWithId(uint16_t id)
 
     if (id == INVALID_ID)
     {
+        /* a single write of the empty table, whatever the number of entries */
         _HAL_ElevatorDb_EraseAll();
-        _HAL_ElevatorDb_SetMetaDataDefault();
-        FWK_Flash_Save(METADATA_FILE_NAME, &s_elevatorDbMetaData, sizeof(elevatordb_metadata_t));
         _HAL_ElevatorDb_Unlock();
         return kElevatorDBStatus_Success;
     }
 
     uint32_t maxCount = _HAL_ElevatorDb_GetMaxCount();
-    if (id > maxCount)
+    if (id >= maxCount)
     {
         _HAL_ElevatorDb_Unlock();
         return kElevatorDBStatus_Failed;
     }
 
-    if (_HAL_ElevatorDb_CheckMapFlag(id, kMappingBitWise_Used) == IN_USE)
+    if (_HAL_ElevatorDb_IsUsed(id))
     {
-        elevator_attr_t *pElevatorAttrEntry = _HAL_ElevatorDb_GetEntry(id);
-        memset(pElevatorAttrEntry, 0, _HAL_ElevatorDb_GetEntrySize());
-
-        _HAL_ElevatorDb_SetMapFlag(id, NOT_USED);
+        /* only the bitmap changes, the content of an unused slot is never read */
+        _HAL_ElevatorDb_SetUsed(id, 0);
 
-        _HAL_ElevatorDb_DelEntryData(id);
-        _HAL_ElevatorDb_SaveMetaData();
+        status = _HAL_ElevatorDb_SaveHeader();
+        if (kElevatorDBStatus_Success != status)
+        {
+            _HAL_ElevatorDb_SetUsed(id, 1);
+        }
     }
 
     _HAL_ElevatorDb_Unlock();
@@ -511,7 +529,7 @@ static elevatordb_status_t HAL_ElevatorDb_UpdWithId(uint16_t id, elevator_attr_t
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
 
-    if (NULL == s_pElevatorDbBuffer)
+    if (NULL == s_pElevatorDbTable)
     {
         return kElevatorDBStatus_MallocFail;
     }
@@ -522,21 +540,23 @@ static elevatordb_status_t HAL_ElevatorDb_UpdWithId(uint16_t id, elevator_attr_t
     }
 
     uint32_t maxCount = _HAL_ElevatorDb_GetMaxCount();
-    if (id > maxCount)
+    if (id >= maxCount)
     {
         _HAL_ElevatorDb_Unlock();
         return kElevatorDBStatus_Failed;
     }
 
-    if (_HAL_ElevatorDb_CheckMapFlag(id, kMappingBitWise_Used) == IN_USE)
+    if (_HAL_ElevatorDb_IsUsed(id))
     {
         elevator_attr_t *pElevatorAttrEntry = _HAL_ElevatorDb_GetEntry(id);
+        elevator_attr_t previous            = *pElevatorAttrEntry;
         memcpy(pElevatorAttrEntry, attr, _HAL_ElevatorDb_GetEntrySize());
 
-        _HAL_ElevatorDb_SetMapFlag(id, IN_USE);
-
-        _HAL_ElevatorDb_SaveEntryData(id);
-        _HAL_ElevatorDb_SaveMetaData();
+        status = _HAL_ElevatorDb_SaveEntry(id);
+        if (kElevatorDBStatus_Success != status)
+        {
+            *pElevatorAttrEntry = previous;
+        }
     }
 
     _HAL_ElevatorDb_Unlock();
@@ -547,7 +567,7 @@ static elevatordb_status_t HAL_ElevatorDb_GetWithId(uint16_t id, elevator_attr_t
 {
     elevatordb_status_t status = kElevatorDBStatus_Success;
 
-    if (NULL == s_pElevatorDbBuffer)
+    if (NULL == s_pElevatorDbTable)
     {
         return kElevatorDBStatus_MallocFail;
     }
@@ -558,13 +578,13 @@ static elevatordb_status_t HAL_ElevatorDb_GetWithId(uint16_t id, elevator_attr_t
     }
 
     uint32_t maxCount = _HAL_ElevatorDb_GetMaxCount();
-    if (id > maxCount)
+    if (id >= maxCount)
     {
         _HAL_ElevatorDb_Unlock();
         return kElevatorDBStatus_Failed;
     }
 
-    if (_HAL_ElevatorDb_CheckMapFlag(id, kMappingBitWise_Used) == IN_USE)
+    if (_HAL_ElevatorDb_IsUsed(id))
     {
         elevator_attr_t *pElevatorAttrEntry = _HAL_ElevatorDb_GetEntry(id);
         memcpy(attr, pElevatorAttrEntry, _HAL_ElevatorDb_GetEntrySize());
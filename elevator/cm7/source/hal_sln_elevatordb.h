@@ -16,7 +16,8 @@
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
-#define ELEVATOR_DB_VERSION  2
+/* Version 3 packs all the entries in one file, the versions 1 and 2 are migrated at init */
+#define ELEVATOR_DB_VERSION  3
 #define ELEVATOR_DB_MAX_SIZE 100
 #define INVALID_ID           0xFFFF
 #define INVALID_FLOOR        0xFFFFFFFF
@@ -23,12 +23,31 @@
  * Global Vars
  ******************************************************************************/
 
+/*
+ * Input channel, a single producer/single consumer ring of chunks. The producer only writes head and the chunks it
+ * pushes, the audio processing task only writes tail and the overrun count, both run on the same core so the volatile
+ * indexes are enough to order them.
+ */
+typedef struct
+{
+    void *data[AUDIO_INPUT_CHANNEL_MAX_DEPTH];
+    uint32_t timestampUs[AUDIO_INPUT_CHANNEL_MAX_DEPTH];
+    uint32_t depth;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    /* set while a message for the pending chunks is queued, so a late task gets one message and not one per chunk */
+    volatile uint8_t notified;
+    fwk_message_t msg;
+    audio_input_stats_t stats;
+} audio_input_channel_t;
+
 typedef struct
 {
     fwk_task_data_t commonData;
     fwk_message_t audioReqMsg;
     audio_processing_dev_t *devs[MAXIMUM_AUDIO_PROCESSING_DEV]; /* registered audio procesing devices */
     fwk_message_t msgs[MAXIMUM_AUDIO_PROCESSING_DEV];           /* input messages */
+    audio_input_channel_t inputChannel;
 } audio_task_data_t;
 
 typedef struct
@@ -162,9 +181,73 @@ static int _FWK_AudioProcessing_TaskInit(fwk_task_data_t *pTaskData)
         }
     }
 
+    /* chunks pushed before the task queue existed were not notified, the next push will */
+    pAudioTaskData->inputChannel.notified = 0;
+
     return error;
 }
 
+static void _FWK_AudioProcessing_InputChannelRun(audio_task_data_t *pAudioTaskData)
+{
+    audio_input_channel_t *pChannel = &pAudioTaskData->inputChannel;
+    uint32_t valid                  = pChannel->depth - 1;
+
+    /* clear the flag first, a chunk pushed from now on sends a new message */
+    pChannel->notified = 0;
+
+    while (pChannel->tail != pChannel->head)
+    {
+        uint32_t head = pChannel->head;
+        uint32_t latency;
+        uint32_t index;
+        void *data;
+
+        /* the producer is filling the buffer of the chunk pushed depth chunks ago, older chunks are lost */
+        if ((head - pChannel->tail) > valid)
+        {
+            pChannel->stats.overruns += (head - pChannel->tail) - valid;
+            pChannel->tail = head - valid;
+        }
+
+        index   = pChannel->tail % pChannel->depth;
+        data    = pChannel->data[index];
+        latency = FWK_CurrentTimeUs() - pChannel->timestampUs[index];
+        if (latency > pChannel->stats.maxLatencyUs)
+        {
+            pChannel->stats.maxLatencyUs = latency;
+        }
+
+        for (int i = 0; i < MAXIMUM_AUDIO_PROCESSING_DEV; i++)
+        {
+            hal_audio_processing_status_t status;
+            audio_processing_dev_t *pDev = pAudioTaskData->devs[i];
+
+            if ((pDev == NULL) || (pDev->ops->run == NULL))
+            {
+                continue;
+            }
+
+            status = pDev->ops->run(pDev, data);
+            if (status != kStatus_HAL_AudioProcessingSuccess)
+            {
+                LOGE("Audio processing dev [%d] run failed error: %d", i, status);
+            }
+        }
+
+        /* the producer went around the ring while the chunk was processed */
+        if ((pChannel->head - pChannel->tail) > valid)
+        {
+            pChannel->stats.overruns++;
+        }
+        else
+        {
+            pChannel->stats.processed++;
+        }
+
+        pChannel->tail++;
+    }
+}
+
 static void _FWK_AudioProcessing_MessageHandle(fwk_message_t *pMsg, fwk_task_data_t *pTaskData)
 {
     if ((pMsg == NULL) || (pTaskData == NULL))
@@ -195,6 +278,11 @@ static void _FWK_AudioProcessing_MessageHandle(fwk_message_t *pMsg, fwk_task_dat
             }
         }
         break;
+        case kFWKMessageID_InputAudioChannel:
+        {
+            _FWK_AudioProcessing_InputChannelRun(pAudioTaskData);
+        }
+        break;
         case kFWKMessageID_InputNotify:
         {
             for (int i = 0; i < MAXIMUM_AUDIO_PROCESSING_DEV; i++)
@@ -264,6 +352,87 @@ int FWK_AudioProcessing_Start(int taskPriority)
     return error;
 }
 
+int FWK_AudioProcessing_InputChannelOpen(uint32_t depth)
+{
+    audio_input_channel_t *pChannel = &s_AudioTask.audioData.inputChannel;
+
+    if ((depth < 2) || (depth > AUDIO_INPUT_CHANNEL_MAX_DEPTH))
+    {
+        LOGE("[AudioProcessing]:Invalid input channel depth %d", depth);
+        return -1;
+    }
+
+    pChannel->depth = depth;
+    return 0;
+}
+
+int FWK_AudioProcessing_InputChannelPush(void *data, uint32_t timestampUs, uint8_t fromISR)
+{
+    audio_input_channel_t *pChannel = &s_AudioTask.audioData.inputChannel;
+    fwk_message_t *pMsg             = &pChannel->msg;
+    BaseType_t ret;
+    uint32_t index;
+    uint32_t pending;
+
+    if (pChannel->depth == 0)
+    {
+        return -1;
+    }
+
+    index                        = pChannel->head % pChannel->depth;
+    pChannel->data[index]        = data;
+    pChannel->timestampUs[index] = timestampUs;
+    pChannel->head++;
+
+    pChannel->stats.pushed++;
+    pending = pChannel->head - pChannel->tail;
+    if (pending > pChannel->stats.maxPending)
+    {
+        pChannel->stats.maxPending = pending;
+    }
+
+    if (pChannel->notified)
+    {
+        return 0;
+    }
+
+    pChannel->notified = 1;
+    pMsg->id           = kFWKMessageID_InputAudioChannel;
+    pMsg->msgInfo      = kMsgInfo_Local;
+#if FWK_SUPPORT_MULTICORE
+    pMsg->multicore.isMulticoreMessage  = 0;
+    pMsg->multicore.wasMulticoreMessage = 0;
+#endif
+    if (fromISR)
+    {
+        ret = FWK_Message_PutFromIsr(kFWKTaskID_Audio, &pMsg);
+    }
+    else
+    {
+        ret = FWK_Message_Put(kFWKTaskID_Audio, &pMsg);
+    }
+
+    if (ret != pdTRUE)
+    {
+        /* let the next push try again */
+        pChannel->notified = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+int FWK_AudioProcessing_InputChannelGetStats(audio_input_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return -1;
+    }
+
+    *stats = s_AudioTask.audioData.inputChannel.stats;
+    return 0;
+}
+
 int FWK_AudioProcessing_DeviceRegister(audio_processing_dev_t *dev)
 {
     int error = -1;
@@ -18,6 +18,10 @@
 #include "fwk_perf.h"
 #include "fwk_graphics.h"
 #include "fwk_camera_manager.h"
+#include "fwk_lpm_manager.h"
+#if FWK_SUPPORT_CAMERA_AE
+#include "hal_event_descriptor_common.h"
+#endif /* FWK_SUPPORT_CAMERA_AE */
 
 typedef struct
 {
@@ -36,6 +40,12 @@ typedef struct
     msg_payload_t vAlgoRequestFrameInfo[MAXIMUM_VISION_ALGO_DEV * kVAlgoFrameID_Count];
     /* the overlay surface */
     gfx_surface_t *pOverlaySurface;
+#if FWK_SUPPORT_CAMERA_AE
+    /* auto exposure of the camera devices */
+    camera_exposure_ctrl_t exposure[MAXIMUM_CAMERA_DEV];
+    /* format of the last frame of each camera device, tells the IR cameras from the RGB ones */
+    pixel_format_t exposureFormat[MAXIMUM_CAMERA_DEV];
+#endif /* FWK_SUPPORT_CAMERA_AE */
 } camera_task_data_t;
 
 typedef struct
@@ -115,6 +125,154 @@ static int _FWK_CameraManager_DeviceCallback(const camera_dev_t *dev,
     return 0;
 }
 
+#if FWK_SUPPORT_CAMERA_AE
+/* the LEDs belong to an output device, they are driven through its input notify */
+static void _FWK_CameraManager_SetLight(camera_dev_light_t light, int brightness)
+{
+    fwk_message_t *pMsg    = (fwk_message_t *)FWK_MALLOC(sizeof(fwk_message_t));
+    event_common_t *pEvent = (event_common_t *)FWK_MALLOC(sizeof(event_common_t));
+
+    if ((pMsg == NULL) || (pEvent == NULL))
+    {
+        LOGE("Can't allocate the light %d message", light);
+        FWK_FREE(pMsg);
+        FWK_FREE(pEvent);
+        return;
+    }
+
+    memset(pMsg, 0, sizeof(fwk_message_t));
+    memset(pEvent, 0, sizeof(event_common_t));
+    if (light == kCameraDevLight_IR)
+    {
+        pEvent->eventBase.eventId = kEventID_SetIRLedBrightness;
+        pEvent->irLed.brightness  = brightness;
+    }
+    else
+    {
+        pEvent->eventBase.eventId   = kEventID_SetWhiteLedBrightness;
+        pEvent->whiteLed.brightness = brightness;
+    }
+
+    pMsg->freeAfterConsumed         = 1;
+    pMsg->id                        = kFWKMessageID_InputNotify;
+    pMsg->payload.data              = pEvent;
+    pMsg->payload.size              = sizeof(event_common_t);
+    pMsg->payload.freeAfterConsumed = 1;
+    FWK_Message_Put(kFWKTaskID_Output, &pMsg);
+}
+
+/* measure the frame and move the actuators, return true if the frame can go to the vision algorithms */
+static bool _FWK_CameraManager_Exposure(camera_dev_t *pDev, fwk_message_t *pMsg, camera_task_data_t *pCameraTaskData)
+{
+    camera_exposure_ctrl_t *pCtrl = &pCameraTaskData->exposure[pDev->id];
+    camera_exposure_measure_t measure;
+    camera_exposure_action_t action;
+    bool usable;
+
+    pCameraTaskData->exposureFormat[pDev->id] = pMsg->payload.frame.format;
+
+    if (!HAL_CameraExposure_HasActuators(pCtrl) ||
+        (HAL_CameraExposure_Measure(pCtrl, pMsg->payload.data, pMsg->payload.frame.format, &pDev->config, &measure) !=
+         0))
+    {
+        return true;
+    }
+
+    usable = HAL_CameraExposure_Update(pCtrl, &measure, &action);
+
+    if ((action.steps != 0) && (pDev->ops->adjustExposure != NULL))
+    {
+        if (pDev->ops->adjustExposure(pDev, action.steps) != kStatus_HAL_CameraSuccess)
+        {
+            LOGE("Camera dev %d adjust exposure %d failed", pDev->id, action.steps);
+        }
+    }
+
+    if (action.light >= 0)
+    {
+        _FWK_CameraManager_SetLight(pDev->config.exposure.light, action.light);
+    }
+
+#if CAMERA_EXPOSURE_STATS_LOG_PERIOD
+    if ((pCtrl->stats.frames % CAMERA_EXPOSURE_STATS_LOG_PERIOD) == 0)
+    {
+        LOGI("Camera %s exposure: mean %d steps %d light %d usable %d skipped %d forced %d converge %d/%d frames",
+             pDev->name, pCtrl->stats.lastMean, pCtrl->stats.exposureSteps, pCtrl->stats.light, pCtrl->stats.usable,
+             pCtrl->stats.skipped, pCtrl->stats.forced, pCtrl->stats.lastConvergeFrames,
+             pCtrl->stats.maxConvergeFrames);
+    }
+#endif /* CAMERA_EXPOSURE_STATS_LOG_PERIOD */
+
+    return usable;
+}
+
+static bool _FWK_CameraManager_IsIRFormat(pixel_format_t format)
+{
+    return (format == kPixelFormat_Gray) || (format == kPixelFormat_Gray16) || (format == kPixelFormat_Gray888) ||
+           (format == kPixelFormat_Gray888X) || (format == kPixelFormat_YUV1P444_Gray) ||
+           (format == kPixelFormat_UYVY1P422_Gray);
+}
+
+static bool _FWK_CameraManager_IsRGBFormat(pixel_format_t format)
+{
+    return (format == kPixelFormat_RGB) || (format == kPixelFormat_RGB565) || (format == kPixelFormat_BGR) ||
+           (format == kPixelFormat_YUV1P444_RGB) || (format == kPixelFormat_UYVY1P422_RGB) ||
+           (format == kPixelFormat_VYUY1P422) || (format == kPixelFormat_YUV420P);
+}
+
+/*
+ * The face reported in the camera frame is measured instead of the whole frame. The event only goes to the cameras
+ * of its type, picked from the format of their frames, cameras which sent no frame yet are left alone.
+ * Only the OASIS lite3D device reports the face rect (faceAE), the 2D devices send the direction only and their
+ * cameras keep measuring the active rect.
+ */
+static void _FWK_CameraManager_ExposureNotify(camera_task_data_t *pCameraTaskData, void *data)
+{
+    event_common_t *pEvent = (event_common_t *)data;
+    bool irCamera;
+
+    if (pEvent == NULL)
+    {
+        return;
+    }
+
+    if (pEvent->eventBase.eventId == kEventID_ControlIRCamExposure)
+    {
+        irCamera = true;
+    }
+    else if (pEvent->eventBase.eventId == kEventID_ControlRGBCamExposure)
+    {
+        irCamera = false;
+    }
+    else
+    {
+        return;
+    }
+
+    for (int i = 0; i < MAXIMUM_CAMERA_DEV; i++)
+    {
+        pixel_format_t format = pCameraTaskData->exposureFormat[i];
+
+        if ((pCameraTaskData->devs[i] == NULL) ||
+            (irCamera ? !_FWK_CameraManager_IsIRFormat(format) : !_FWK_CameraManager_IsRGBFormat(format)))
+        {
+            continue;
+        }
+
+        if (pEvent->brightnessControl.enable && (pEvent->brightnessControl.type == 0))
+        {
+            HAL_CameraExposure_SetRoi(&pCameraTaskData->exposure[i], pEvent->brightnessControl.faceRect[0],
+                                      pEvent->brightnessControl.faceRect[1], pEvent->brightnessControl.faceRect[2],
+                                      pEvent->brightnessControl.faceRect[3]);
+        }
+        else
+        {
+            HAL_CameraExposure_SetRoi(&pCameraTaskData->exposure[i], 0, 0, 0, 0);
+        }
+    }
+}
+#endif /* FWK_SUPPORT_CAMERA_AE */
+
 static int _FWK_CameraManager_TaskInit(fwk_task_data_t *pTaskData)
 {
     if (pTaskData == NULL)
@@ -169,6 +327,19 @@ static int _FWK_CameraManager_TaskInit(fwk_task_data_t *pTaskData)
                 return error;
             }
         }
+
+#if FWK_SUPPORT_CAMERA_AE
+        if (pDev != NULL)
+        {
+            /* the device init restored its default exposure, the LED starts from its minimum */
+            HAL_CameraExposure_Init(&pCameraTaskData->exposure[i], &pDev->config.exposure);
+            pCameraTaskData->exposureFormat[i] = kPixelFormat_Invalid;
+            if (pDev->config.exposure.light != kCameraDevLight_None)
+            {
+                _FWK_CameraManager_SetLight(pDev->config.exposure.light, pDev->config.exposure.lightMin);
+            }
+        }
+#endif /* FWK_SUPPORT_CAMERA_AE */
     }
 
     return error;
@@ -294,6 +465,9 @@ static void _FWK_CameraManager_DisplayResponse(camera_dev_t *pDev,
             LOGI("Sending camera frame to display id #%d", pCameraTaskData->displayRequestFrameInfo[i].devId);
             FWK_Message_Put(kFWKTaskID_Display, &pDisplayResMsg);
 
+            /* the first frame shown after a wake up ends the wake-up latency */
+            FWK_LpmManager_WakeUpComplete();
+
             /* indicate the request display buffer is filled */
             pCameraTaskData->displayRequestFrameInfo[i].data = NULL;
         }
@@ -396,9 +570,10 @@ static void _FWK_CameraManager_VisionAlgoResponse(camera_dev_t *pDev,
 
             gfx_blit(&cameraSurface, &algorithmSurface, pRotate, kFlipMode_None);
 
-            fwk_message_t *pVAlgoResMsg = &pCameraTaskData->vAlgoResponseMsg[i];
-            pVAlgoResMsg->payload.data  = pCameraTaskData->vAlgoRequestFrameInfo[i].data;
-            pVAlgoResMsg->payload.devId = pCameraTaskData->vAlgoRequestFrameInfo[i].devId;
+            fwk_message_t *pVAlgoResMsg             = &pCameraTaskData->vAlgoResponseMsg[i];
+            pVAlgoResMsg->payload.data              = pCameraTaskData->vAlgoRequestFrameInfo[i].data;
+            pVAlgoResMsg->payload.devId             = pCameraTaskData->vAlgoRequestFrameInfo[i].devId;
+            pVAlgoResMsg->payload.frame.timestampUs = FWK_CurrentTimeUs();
 
 #if FWK_SUPPORT_MULTICORE
             pVAlgoResMsg->multicore.isMulticoreMessage = 1;
@@ -483,11 +658,22 @@ static void _FWK_CameraManager_MessageHandle(fwk_message_t *pMsg, fwk_task_data_
             {
                 if (pMsg->msgInfo == kMsgInfo_Local)
                 {
+#if FWK_SUPPORT_CAMERA_AE
+                    /* measure the raw frame, before the display post process */
+                    bool usable = (pDev == NULL) || _FWK_CameraManager_Exposure(pDev, pMsg, pCameraTaskData);
+#endif /* FWK_SUPPORT_CAMERA_AE */
+
                     /* handle the display response */
                     _FWK_CameraManager_DisplayResponse(pDev, pMsg, pCameraTaskData);
 
-                    /* handle the vision algorithm response */
-                    _FWK_CameraManager_VisionAlgoResponse(pDev, pMsg, pCameraTaskData);
+#if FWK_SUPPORT_CAMERA_AE
+                    /* a badly exposed frame is only displayed, the vision requests wait for the next one */
+                    if (usable)
+#endif /* FWK_SUPPORT_CAMERA_AE */
+                    {
+                        /* handle the vision algorithm response */
+                        _FWK_CameraManager_VisionAlgoResponse(pDev, pMsg, pCameraTaskData);
+                    }
 
                     /* enqueue a new camera buffer request */
                     if (pDev != NULL && pDev->ops->enqueue != NULL)
@@ -569,6 +755,10 @@ static void _FWK_CameraManager_MessageHandle(fwk_message_t *pMsg, fwk_task_data_
 
         case kFWKMessageID_InputNotify:
         {
+#if FWK_SUPPORT_CAMERA_AE
+            _FWK_CameraManager_ExposureNotify(pCameraTaskData, pMsg->payload.data);
+#endif /* FWK_SUPPORT_CAMERA_AE */
+
             for (int i = 0; i < MAXIMUM_CAMERA_DEV; i++)
             {
                 camera_dev_t *pDev = pCameraTaskData->devs[i];
@@ -601,6 +791,8 @@ static void _FWK_CameraManager_MessageHandle(fwk_message_t *pMsg, fwk_task_data_
                     pDev->ops->deinit(pDev);
                 }
             }
+
+            FWK_LpmManager_Ack(kFWKTaskID_Camera);
         }
         break;
 
@@ -707,6 +899,10 @@ int FWK_CameraManager_Start(int taskPriority)
     s_CameraTask.task.delayMs    = 1;
     s_CameraTask.task.taskStack  = s_CameraTaskStack;
     s_CameraTask.task.taskBuffer = s_CameraTaskTCBReference;
+
+    /* the camera devices are released before entering sleep */
+    FWK_LpmManager_RegisterSleepAck(kFWKTaskID_Camera);
+
     FWK_Task_Start((fwk_task_t *)&s_CameraTask.task, CAMERA_MANAGER_TASK_NAME, CAMERA_MANAGER_TASK_STACK, taskPriority);
 
     LOGD("[CameraManager]:Started");
@@ -718,6 +914,28 @@ int FWK_CameraManager_Deinit()
     return 0;
 }
 
+#if FWK_SUPPORT_CAMERA_AE
+int FWK_CameraManager_GetExposureStats(int devId, camera_exposure_stats_t *stats)
+{
+    camera_exposure_ctrl_t *pCtrl;
+
+    if ((devId < 0) || (devId >= MAXIMUM_CAMERA_DEV) || (stats == NULL))
+    {
+        return -1;
+    }
+
+    pCtrl = &s_CameraTask.cameraData.exposure[devId];
+    if (!HAL_CameraExposure_HasActuators(pCtrl))
+    {
+        return -1;
+    }
+
+    HAL_CameraExposure_GetStats(pCtrl, stats);
+
+    return 0;
+}
+#endif /* FWK_SUPPORT_CAMERA_AE */
+
 int FWK_CameraManager_DeviceRegister(camera_dev_t *dev)
 {
     int error = -1;
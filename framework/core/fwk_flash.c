@@ -59,6 +59,16 @@ sln_flash_status_t FWK_Flash_Append(const char *path, void *buf, unsigned int si
     return ret;
 }
 
+sln_flash_status_t FWK_Flash_Write(const char *path, void *buf, unsigned int offset, unsigned int size)
+{
+    sln_flash_status_t ret = kStatus_HAL_FlashFail;
+    if ((s_FlashDev != NULL) && (s_FlashDev->ops->write != NULL))
+    {
+        ret = s_FlashDev->ops->write(s_FlashDev, path, buf, offset, size);
+    }
+    return ret;
+}
+
 sln_flash_status_t FWK_Flash_Read(const char *path, void *buf, unsigned int offset, unsigned int *size)
 {
     sln_flash_status_t ret = kStatus_HAL_FlashFail;
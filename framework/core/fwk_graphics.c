@@ -97,6 +97,59 @@ int gfx_compose(
     return ret;
 }
 
+/*
+ * @brief empty a rect.
+ * @param *pRect [out]  Pointer to the rect.
+ */
+void gfx_rect_clear(gfx_rect_t *pRect)
+{
+    pRect->left   = 0;
+    pRect->top    = 0;
+    pRect->right  = -1;
+    pRect->bottom = -1;
+}
+
+/*
+ * @brief grow a rect to include an area.
+ * @param *pRect [in/out]  Pointer to the rect.
+ * @param x [in]  Left of the area.
+ * @param y [in]  Top of the area.
+ * @param w [in]  Width of the area, nothing is added if not positive.
+ * @param h [in]  Height of the area, nothing is added if not positive.
+ */
+void gfx_rect_add(gfx_rect_t *pRect, int x, int y, int w, int h)
+{
+    if ((w <= 0) || (h <= 0))
+    {
+        return;
+    }
+
+    if (gfx_rect_empty(pRect))
+    {
+        pRect->left   = x;
+        pRect->top    = y;
+        pRect->right  = x + w - 1;
+        pRect->bottom = y + h - 1;
+    }
+    else
+    {
+        pRect->left   = (x < pRect->left) ? x : pRect->left;
+        pRect->top    = (y < pRect->top) ? y : pRect->top;
+        pRect->right  = (x + w - 1 > pRect->right) ? x + w - 1 : pRect->right;
+        pRect->bottom = (y + h - 1 > pRect->bottom) ? y + h - 1 : pRect->bottom;
+    }
+}
+
+/*
+ * @brief check if a rect is empty.
+ * @param *pRect [in]  Pointer to the rect.
+ * @returns 1 if the rect has no pixel.
+ */
+int gfx_rect_empty(const gfx_rect_t *pRect)
+{
+    return (pRect->right < pRect->left) || (pRect->bottom < pRect->top);
+}
+
 int gfx_dev_register(gfx_dev_t *dev)
 {
     gGfxDev = dev;
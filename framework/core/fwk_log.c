@@ -0,0 +1,486 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief Deferred log implementation.
+ *
+ * The log macros only copy the format string pointer and the raw arguments in a binary record ring.
+ * The records are formatted and printed later by a low priority task. Each core runs its own ring.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fwk_common.h"
+#include "fwk_log.h"
+
+#if defined(LOG_ENABLE) && FWK_SUPPORT_DEFERRED_LOG
+
+#define LOG_RING_MASK  (FWK_LOG_RING_SIZE - 1)
+#define LOG_RECORD_PAD 0xFF /* level of the filler record written before wrapping around */
+#define LOG_SPEC_MAX   16
+
+typedef enum _log_arg_type
+{
+    kLogArg_None = 0,
+    kLogArg_Int,
+    kLogArg_Int64,
+    kLogArg_Double,
+    kLogArg_String,
+    kLogArg_Pointer,
+} log_arg_type_t;
+
+typedef struct _log_ring
+{
+    uint8_t buffer[FWK_LOG_RING_SIZE] __attribute__((aligned(4)));
+    volatile uint32_t head; /* written by the producers, interrupts masked */
+    volatile uint32_t tail; /* written by the log task only */
+    TaskHandle_t task;
+    int taskCreating;
+    uint32_t reportedDrops;
+    fwk_log_stats_t stats;
+} log_ring_t;
+
+static log_ring_t s_LogRing;
+static char s_LogLine[configLOGGING_MAX_MESSAGE_LENGTH];
+
+extern const char *g_coreName;
+
+/* Parse the conversion starting at the '%' of fmt. Returns the character following it. */
+static const char *_FWK_Log_ParseSpec(const char *fmt, log_arg_type_t *type, int *stars)
+{
+    int longCount = 0;
+
+    *type  = kLogArg_None;
+    *stars = 0;
+    fmt++;
+
+    /* flags, width and precision */
+    while ((*fmt != '\0') && (strchr("-+ #0123456789.*", *fmt) != NULL))
+    {
+        if (*fmt == '*')
+        {
+            (*stars)++;
+        }
+        fmt++;
+    }
+
+    /* length modifiers */
+    while ((*fmt != '\0') && (strchr("hlLqjzt", *fmt) != NULL))
+    {
+        if ((*fmt == 'l') || (*fmt == 'q') || (*fmt == 'j'))
+        {
+            longCount += (*fmt == 'l') ? 1 : 2;
+        }
+        fmt++;
+    }
+
+    switch (*fmt)
+    {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            *type = (longCount >= 2) ? kLogArg_Int64 : kLogArg_Int;
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            *type = kLogArg_Double;
+            break;
+
+        case 's':
+            *type = kLogArg_String;
+            break;
+
+        case 'p':
+            *type = kLogArg_Pointer;
+            break;
+
+        case '\0':
+            return fmt;
+
+        default:
+            /* "%%" and unsupported conversions take no argument */
+            break;
+    }
+
+    return fmt + 1;
+}
+
+static uint32_t _FWK_Log_PackArgs(const char *fmt, va_list ap, uint32_t *words)
+{
+    uint32_t count = 0;
+
+    while ((fmt = strchr(fmt, '%')) != NULL)
+    {
+        log_arg_type_t type;
+        int stars;
+
+        fmt = _FWK_Log_ParseSpec(fmt, &type, &stars);
+
+        for (int i = 0; (i < stars) && (count < FWK_LOG_MAX_ARG_WORDS); i++)
+        {
+            words[count++] = (uint32_t)va_arg(ap, int);
+        }
+
+        if (type == kLogArg_Int)
+        {
+            if (count + 1 > FWK_LOG_MAX_ARG_WORDS)
+            {
+                break;
+            }
+            words[count++] = (uint32_t)va_arg(ap, int);
+        }
+        else if (type == kLogArg_Pointer)
+        {
+            if (count + 1 > FWK_LOG_MAX_ARG_WORDS)
+            {
+                break;
+            }
+            words[count++] = (uint32_t)(uintptr_t)va_arg(ap, void *);
+        }
+        else if ((type == kLogArg_Int64) || (type == kLogArg_Double))
+        {
+            if (count + 2 > FWK_LOG_MAX_ARG_WORDS)
+            {
+                break;
+            }
+
+            if (type == kLogArg_Int64)
+            {
+                long long value = va_arg(ap, long long);
+                memcpy(&words[count], &value, sizeof(value));
+            }
+            else
+            {
+                double value = va_arg(ap, double);
+                memcpy(&words[count], &value, sizeof(value));
+            }
+            count += 2;
+        }
+        else if (type == kLogArg_String)
+        {
+            /* The string may not outlive the call, copy it */
+            const char *str = va_arg(ap, const char *);
+            uint32_t length = (str != NULL) ? strnlen(str, FWK_LOG_MAX_STRING_LENGTH) : 0;
+            uint32_t size   = (length + 1 + 3) / 4;
+
+            if (count + size > FWK_LOG_MAX_ARG_WORDS)
+            {
+                break;
+            }
+
+            words[count + size - 1] = 0;
+            if (length > 0)
+            {
+                memcpy(&words[count], str, length);
+            }
+            ((char *)&words[count])[length] = '\0';
+            count += size;
+        }
+    }
+
+    return count;
+}
+
+static uint32_t _FWK_Log_FormatRecord(const fwk_log_record_t *pRecord, char *line, uint32_t size)
+{
+    static uint32_t s_MessageNumber = 0;
+    static const char *s_LevelString[kLOGLevel_Invalid] = {"", "E", "D", "I", "V"};
+    const uint32_t *words = (const uint32_t *)(pRecord + 1);
+    const char *fmt       = pRecord->fmt;
+    uint32_t count        = 0;
+    uint32_t length;
+    int written;
+
+    written = snprintf(line, size, "[%s][%s] [%3lu] [%5lu.%3lu.%3lu] [%20s]  ", g_coreName,
+                       (pRecord->level < kLOGLevel_Invalid) ? s_LevelString[pRecord->level] : "",
+                       (unsigned long)s_MessageNumber++, (unsigned long)(pRecord->timestampUs / 1000000),
+                       (unsigned long)((pRecord->timestampUs / 1000) % 1000),
+                       (unsigned long)(pRecord->timestampUs % 1000), pRecord->taskName);
+    length  = (written > 0) ? written : 0;
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+
+    while ((*fmt != '\0') && (length < size - 1))
+    {
+        char spec[LOG_SPEC_MAX];
+        const char *specEnd;
+        log_arg_type_t type;
+        int stars;
+        int star[2] = {0};
+        uint32_t specLength;
+
+        if (*fmt != '%')
+        {
+            line[length++] = *fmt++;
+            continue;
+        }
+
+        specEnd    = _FWK_Log_ParseSpec(fmt, &type, &stars);
+        specLength = specEnd - fmt;
+        if (specLength >= LOG_SPEC_MAX)
+        {
+            specLength = LOG_SPEC_MAX - 1;
+        }
+        memcpy(spec, fmt, specLength);
+        spec[specLength] = '\0';
+        fmt              = specEnd;
+
+        for (int i = 0; i < stars; i++)
+        {
+            star[i & 1] = (count < pRecord->words) ? (int)words[count++] : 0;
+        }
+
+        written = 0;
+        if (type == kLogArg_None)
+        {
+            /* "%%" or a conversion taking no argument, such as %n, which is printed as is rather than run */
+            written = snprintf(line + length, size - length, "%s", (strcmp(spec, "%%") == 0) ? "%" : spec);
+        }
+        else if (((type == kLogArg_Int64) || (type == kLogArg_Double)) ? (count + 2 > pRecord->words)
+                                                                        : (count + 1 > pRecord->words))
+        {
+            /* Argument did not fit in the record */
+            written = snprintf(line + length, size - length, "<?>");
+        }
+        else if ((type == kLogArg_Int) || (type == kLogArg_Pointer))
+        {
+            uint32_t value = words[count++];
+            written        = (stars == 2)   ? snprintf(line + length, size - length, spec, star[0], star[1], value)
+                             : (stars == 1) ? snprintf(line + length, size - length, spec, star[0], value)
+                                            : snprintf(line + length, size - length, spec, value);
+        }
+        else if (type == kLogArg_Int64)
+        {
+            long long value;
+            memcpy(&value, &words[count], sizeof(value));
+            count += 2;
+            written = (stars == 2)   ? snprintf(line + length, size - length, spec, star[0], star[1], value)
+                      : (stars == 1) ? snprintf(line + length, size - length, spec, star[0], value)
+                                     : snprintf(line + length, size - length, spec, value);
+        }
+        else if (type == kLogArg_Double)
+        {
+            double value;
+            memcpy(&value, &words[count], sizeof(value));
+            count += 2;
+            written = (stars == 2)   ? snprintf(line + length, size - length, spec, star[0], star[1], value)
+                      : (stars == 1) ? snprintf(line + length, size - length, spec, star[0], value)
+                                     : snprintf(line + length, size - length, spec, value);
+        }
+        else if (type == kLogArg_String)
+        {
+            const char *value = (const char *)&words[count];
+            count += (strlen(value) + 1 + 3) / 4;
+            written = (stars == 2)   ? snprintf(line + length, size - length, spec, star[0], star[1], value)
+                      : (stars == 1) ? snprintf(line + length, size - length, spec, star[0], value)
+                                     : snprintf(line + length, size - length, spec, value);
+        }
+
+        if (written > 0)
+        {
+            /* snprintf returns the untruncated length */
+            length += written;
+            if (length >= size)
+            {
+                length = size - 1;
+            }
+        }
+    }
+
+    if (length > size - 3)
+    {
+        length = size - 3;
+    }
+    line[length++] = '\r';
+    line[length++] = '\n';
+    line[length]   = '\0';
+
+    return length;
+}
+
+static void _FWK_Log_Task(void *param)
+{
+    while (1)
+    {
+        uint32_t dropped = s_LogRing.stats.droppedCount;
+
+        while (s_LogRing.tail != s_LogRing.head)
+        {
+            fwk_log_record_t *pRecord = (fwk_log_record_t *)&s_LogRing.buffer[s_LogRing.tail & LOG_RING_MASK];
+
+            __DMB();
+            if (pRecord->level != LOG_RECORD_PAD)
+            {
+                _FWK_Log_FormatRecord(pRecord, s_LogLine, sizeof(s_LogLine));
+                DEBUG_CONSOLE_LOCK();
+                PRINTF("%s", s_LogLine);
+                DEBUG_CONSOLE_UNLOCK();
+            }
+
+            /* The slot can be reused by the producers from now on */
+            __DMB();
+            s_LogRing.tail += pRecord->size;
+        }
+
+        if (dropped != s_LogRing.reportedDrops)
+        {
+            snprintf(s_LogLine, sizeof(s_LogLine), "[%s] %lu log records dropped\r\n", g_coreName,
+                     (unsigned long)(dropped - s_LogRing.reportedDrops));
+            DEBUG_CONSOLE_LOCK();
+            PRINTF("%s", s_LogLine);
+            DEBUG_CONSOLE_UNLOCK();
+            s_LogRing.reportedDrops = dropped;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(FWK_LOG_FLUSH_PERIOD_MS));
+    }
+}
+
+static void _FWK_Log_StartTask(void)
+{
+    uint32_t primask;
+    int create = 0;
+
+    primask = DisableGlobalIRQ();
+    if ((s_LogRing.task == NULL) && !s_LogRing.taskCreating)
+    {
+        s_LogRing.taskCreating = 1;
+        create                 = 1;
+    }
+    EnableGlobalIRQ(primask);
+
+    if (create)
+    {
+        if (xTaskCreate(_FWK_Log_Task, "FWK_Log", FWK_LOG_TASK_STACK_SIZE, NULL, FWK_LOG_TASK_PRIORITY,
+                        &s_LogRing.task) != pdPASS)
+        {
+            PRINTF("Log task creation failed\r\n");
+        }
+    }
+}
+
+void FWK_Log_Record(uint8_t level, const char *fmt, ...)
+{
+    uint32_t words[FWK_LOG_MAX_ARG_WORDS];
+    fwk_log_record_t *pRecord;
+    uint32_t wordCount;
+    uint32_t size;
+    uint32_t offset;
+    uint32_t contiguous;
+    uint32_t pending;
+    uint32_t primask;
+    const char *taskName = "ISR";
+    va_list ap;
+
+    if (fmt == NULL)
+    {
+        return;
+    }
+
+    va_start(ap, fmt);
+    wordCount = _FWK_Log_PackArgs(fmt, ap, words);
+    va_end(ap);
+
+    if (!__get_IPSR())
+    {
+        if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+        {
+            taskName = "None";
+        }
+        else
+        {
+            taskName = pcTaskGetName(NULL);
+        }
+
+        if (s_LogRing.task == NULL)
+        {
+            _FWK_Log_StartTask();
+        }
+    }
+
+    size = sizeof(fwk_log_record_t) + wordCount * sizeof(uint32_t);
+
+    primask    = DisableGlobalIRQ();
+    offset     = s_LogRing.head & LOG_RING_MASK;
+    contiguous = FWK_LOG_RING_SIZE - offset;
+    pending    = s_LogRing.head - s_LogRing.tail;
+
+    /* Records never wrap, the end of the ring is skipped with a filler record when too short */
+    if (pending + size + ((contiguous < size) ? contiguous : 0) > FWK_LOG_RING_SIZE)
+    {
+        s_LogRing.stats.droppedCount++;
+        EnableGlobalIRQ(primask);
+        return;
+    }
+
+    if (contiguous < size)
+    {
+        pRecord        = (fwk_log_record_t *)&s_LogRing.buffer[offset];
+        pRecord->size  = contiguous;
+        pRecord->level = LOG_RECORD_PAD;
+        s_LogRing.head += contiguous;
+        offset         = 0;
+    }
+
+    pRecord              = (fwk_log_record_t *)&s_LogRing.buffer[offset];
+    pRecord->size        = size;
+    pRecord->level       = level;
+    pRecord->words       = wordCount;
+    pRecord->timestampUs = FWK_CurrentTimeUs();
+    pRecord->fmt         = fmt;
+    strncpy(pRecord->taskName, taskName, FWK_LOG_TASK_NAME_LENGTH - 1);
+    pRecord->taskName[FWK_LOG_TASK_NAME_LENGTH - 1] = '\0';
+    memcpy(pRecord + 1, words, wordCount * sizeof(uint32_t));
+
+    __DMB();
+    s_LogRing.head += size;
+
+    s_LogRing.stats.recordCount++;
+    pending = s_LogRing.head - s_LogRing.tail;
+    if (pending > s_LogRing.stats.peakUsage)
+    {
+        s_LogRing.stats.peakUsage = pending;
+    }
+    EnableGlobalIRQ(primask);
+}
+
+int FWK_Log_GetStats(fwk_log_stats_t *stats)
+{
+    uint32_t primask;
+
+    if (stats == NULL)
+    {
+        return -1;
+    }
+
+    primask = DisableGlobalIRQ();
+    *stats  = s_LogRing.stats;
+    EnableGlobalIRQ(primask);
+
+    return 0;
+}
+
+#endif /* defined(LOG_ENABLE) && FWK_SUPPORT_DEFERRED_LOG */
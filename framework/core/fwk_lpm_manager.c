@@ -18,6 +18,26 @@
 #include "fwk_lpm_manager.h"
 #include "hal_lpm_dev.h"
 
+/* Default governor parameters, a mode is only picked when the predicted idle is longer than its target residency */
+#ifndef LPM_MANAGER_STANDBY_TARGET_RESIDENCY_MS
+#define LPM_MANAGER_STANDBY_TARGET_RESIDENCY_MS 2000
+#endif /* LPM_MANAGER_STANDBY_TARGET_RESIDENCY_MS */
+
+#ifndef LPM_MANAGER_STANDBY_EXIT_LATENCY_MS
+#define LPM_MANAGER_STANDBY_EXIT_LATENCY_MS 100
+#endif /* LPM_MANAGER_STANDBY_EXIT_LATENCY_MS */
+
+#ifndef LPM_MANAGER_SNVS_TARGET_RESIDENCY_MS
+#define LPM_MANAGER_SNVS_TARGET_RESIDENCY_MS 10000
+#endif /* LPM_MANAGER_SNVS_TARGET_RESIDENCY_MS */
+
+#ifndef LPM_MANAGER_SNVS_EXIT_LATENCY_MS
+#define LPM_MANAGER_SNVS_EXIT_LATENCY_MS 3000
+#endif /* LPM_MANAGER_SNVS_EXIT_LATENCY_MS */
+
+/* Weight of the history in the moving averages, new = (old * (N - 1) + sample) / N */
+#define LPM_MANAGER_AVERAGE_WEIGHT 4
+
 typedef struct _lpm_manager
 {
     lpm_dev_t *dev;                  /* registered lpm devices */
@@ -25,6 +45,23 @@ typedef struct _lpm_manager
     hal_lpm_mode_t currentMode;      /* current sleep mode */
     fwk_message_t lpmNotifyMsg;      /* pre-enter sleep msg notify other manager */
     List_t lpmRequestList;           /* manage request list */
+
+    bool preEntering;               /* waiting for the acks of the managers or the pre-enter timeout */
+    bool devicesReleased;           /* pre-enter sleep msg sent, the managers may have released their devices */
+    uint32_t ackTasks;              /* bitmask of the tasks which ack the pre-enter sleep msg */
+    uint32_t pendingAcks;           /* bitmask of the tasks which did not ack the pre-enter sleep msg yet */
+    unsigned int transitionStartUs; /* time the pre-enter sleep msg was sent */
+
+    uint32_t allowedModes;                        /* bitmask of the modes the governor may pick */
+    uint32_t maxWakeLatencyMs;                    /* 0 means no limit */
+    unsigned int totalUsageCount;                 /* sum of the usage count of all requests */
+    unsigned int idleStartUs;                     /* time the total usage count dropped to 0 */
+    unsigned int sleepStartUs;                    /* time the current sleep mode was entered */
+    unsigned int wakeUpUs;                        /* time the board left the last sleep mode */
+    hal_lpm_mode_t sleepingMode;                  /* mode being resided in, invalid when awake */
+    hal_lpm_mode_t wakingMode;                    /* mode waiting for WakeUpComplete, invalid otherwise */
+    lpm_mode_stats_t modeStats[kLPMMode_Invalid]; /* per mode residency statistics */
+    lpm_governor_stats_t governorStats;           /* governor statistics */
 } lpm_manager_t;
 
 typedef struct
@@ -33,6 +70,10 @@ typedef struct
     char requestName[LPM_REQUEST_NAME_MAX_LENGTH];
     int8_t usageCount;
     ListItem_t requestListItem;
+    unsigned int holdStartUs;
+    uint32_t holdCount;
+    uint32_t holdTimeMs;
+    uint32_t blockCount;
 } lpm_request_item_t;
 
 lpm_manager_t s_LpmManager;
@@ -59,61 +100,327 @@ static int _FWK_LpmManager_Unlock()
     return s_LpmManager.dev->ops->unlock(s_LpmManager.dev);
 }
 
-static int _FWK_LpmManager_PreEnterSleepTimerCallback(lpm_dev_t *dev)
+/* End the residency accounting of the current sleep mode. Must be called with the lpm lock held. */
+static int _FWK_LpmManager_WakeUp(void)
 {
-    int ret = kStatus_HAL_LpmSuccess;
+    hal_lpm_mode_t mode = s_LpmManager.sleepingMode;
+
+    if (mode >= kLPMMode_Invalid)
+    {
+        return kStatus_HAL_LpmError;
+    }
+
+    s_LpmManager.wakeUpUs     = FWK_CurrentTimeUs();
+    s_LpmManager.wakingMode   = mode;
+    s_LpmManager.sleepingMode = kLPMMode_Invalid;
+    s_LpmManager.modeStats[mode].residencyMs += (s_LpmManager.wakeUpUs - s_LpmManager.sleepStartUs) / 1000;
+
+    LOGD("[LpmManager]:Wake up from mode %d after %d ms", mode,
+         (s_LpmManager.wakeUpUs - s_LpmManager.sleepStartUs) / 1000);
+
+    return kStatus_HAL_LpmSuccess;
+}
+
+static uint32_t _FWK_LpmManager_Average(uint32_t average, uint32_t sample)
+{
+    if (average == 0)
+    {
+        return sample;
+    }
+
+    return (uint32_t)((((uint64_t)average * (LPM_MANAGER_AVERAGE_WEIGHT - 1)) + sample) / LPM_MANAGER_AVERAGE_WEIGHT);
+}
 
+/* Bitmask of the framework tasks running on this core */
+static uint32_t _FWK_LpmManager_GetTasks(void)
+{
+    uint32_t tasks = 0;
+
+    for (int i = kFWKTaskID_Camera; i < kFWKTaskID_APPStart; i++)
+    {
+        if (FWK_Task_IsRegistered(i))
+        {
+            tasks |= (1U << i);
+        }
+    }
+
+    return tasks;
+}
+
+/* Send the pre-enter sleep message to the tasks, the pending acks must be armed before */
+static void _FWK_LpmManager_Notify(uint32_t tasks)
+{
+    fwk_message_t *pMsg = &s_LpmManager.lpmNotifyMsg;
+
+    pMsg->freeAfterConsumed = 0;
+    pMsg->id                = kFWKMessageID_LpmPreEnterSleep;
+
+    for (int i = kFWKTaskID_Camera; i < kFWKTaskID_APPStart; i++)
+    {
+        if (tasks & (1U << i))
+        {
+            FWK_Message_Put(i, &pMsg);
+        }
+    }
+}
+
+/* Cancel a transition before the managers were notified. Must be called with the lpm lock held. */
+static void _FWK_LpmManager_AbortSleep(void)
+{
     lpm_dev_t *pDev = s_LpmManager.dev;
-    if (pDev != NULL && pDev->ops->enterSleep != NULL)
+
+    if (!s_LpmManager.preEntering)
+    {
+        return;
+    }
+
+    if (s_LpmManager.devicesReleased)
+    {
+        /* The managers do not get their devices back, only sleep can bring the board back to a working state */
+        LOGD("[LpmManager]:Devices released, sleep is entered anyway");
+        return;
+    }
+
+    LOGD("[LpmManager]:Abort sleep, pending acks 0x%x", s_LpmManager.pendingAcks);
+    s_LpmManager.preEntering = false;
+    s_LpmManager.pendingAcks = 0;
+    s_LpmManager.governorStats.abortCount++;
+
+    if ((pDev != NULL) && (pDev->ops != NULL))
     {
         pDev->ops->stopPreEnterTimer(pDev);
-        s_LpmManager.enable = kLPMManagerStatus_SleepDisable;
-        ret                 = pDev->ops->enterSleep(pDev, s_LpmManager.currentMode);
+
+        if (s_LpmManager.enable == kLPMManagerStatus_SleepEnable)
+        {
+            /* The check timer was stopped when the transition started */
+            pDev->ops->openTimer(pDev);
+        }
+    }
+}
+
+/* Track the usage count transitions of a request. Must be called with the lpm lock held. */
+static void _FWK_LpmManager_UpdateUsage(lpm_request_item_t *pRequestItem, int8_t count)
+{
+    unsigned int currentUs = FWK_CurrentTimeUs();
+    int8_t oldCount        = pRequestItem->usageCount;
+
+    if (count < 0)
+    {
+        count = 0;
+    }
+
+    if ((oldCount <= 0) && (count > 0))
+    {
+        pRequestItem->holdStartUs = currentUs;
+        pRequestItem->holdCount++;
+    }
+    else if ((oldCount > 0) && (count <= 0))
+    {
+        pRequestItem->holdTimeMs += (currentUs - pRequestItem->holdStartUs) / 1000;
+    }
+
+    if (oldCount > 0)
+    {
+        s_LpmManager.totalUsageCount -= oldCount;
+    }
+    s_LpmManager.totalUsageCount += count;
+
+    if ((s_LpmManager.totalUsageCount == 0) && (oldCount > 0))
+    {
+        /* An idle period starts */
+        s_LpmManager.idleStartUs = currentUs;
+    }
+    else if ((s_LpmManager.totalUsageCount == (unsigned int)count) && (oldCount <= 0) && (count > 0))
+    {
+        /* The idle period ends, feed it to the predictor */
+        lpm_governor_stats_t *pGovernor = &s_LpmManager.governorStats;
+        pGovernor->lastIdleMs           = (currentUs - s_LpmManager.idleStartUs) / 1000;
+        pGovernor->predictedIdleMs      = _FWK_LpmManager_Average(pGovernor->predictedIdleMs, pGovernor->lastIdleMs);
+        pGovernor->idleCount++;
+
+        if (s_LpmManager.sleepingMode != kLPMMode_Invalid)
+        {
+            _FWK_LpmManager_WakeUp();
+        }
+        else
+        {
+            _FWK_LpmManager_AbortSleep();
+        }
+    }
+}
+
+/* Exit cost of a mode, the measured average wins over the configured value once known */
+static uint32_t _FWK_LpmManager_ExitLatencyMs(hal_lpm_mode_t mode)
+{
+    lpm_mode_stats_t *pStats = &s_LpmManager.modeStats[mode];
+    uint32_t measuredMs      = pStats->avgWakeLatencyUs / 1000;
+
+    return (measuredMs > pStats->exitLatencyMs) ? measuredMs : pStats->exitLatencyMs;
+}
+
+/* Pick the deepest allowed mode whose target residency fits the predicted idle time */
+static hal_lpm_mode_t _FWK_LpmManager_SelectMode(void)
+{
+#if FWK_SUPPORT_LPM_GOVERNOR
+    hal_lpm_mode_t selected       = kLPMMode_Invalid;
+    uint32_t selectedResidencyMs  = 0;
+    lpm_governor_stats_t *pGovern = &s_LpmManager.governorStats;
+    uint32_t elapsedMs            = (FWK_CurrentTimeUs() - s_LpmManager.idleStartUs) / 1000;
+    /* Having been idle for a while is a better hint than the history */
+    uint32_t predictedMs = (elapsedMs > pGovern->predictedIdleMs) ? elapsedMs : pGovern->predictedIdleMs;
+
+    for (int mode = 0; mode < kLPMMode_Invalid; mode++)
+    {
+        lpm_mode_stats_t *pStats = &s_LpmManager.modeStats[mode];
+
+        if (!(s_LpmManager.allowedModes & (1U << mode)))
+        {
+            continue;
+        }
+
+        if ((s_LpmManager.maxWakeLatencyMs != 0) &&
+            (_FWK_LpmManager_ExitLatencyMs((hal_lpm_mode_t)mode) > s_LpmManager.maxWakeLatencyMs))
+        {
+            continue;
+        }
+
+        if ((pStats->targetResidencyMs <= predictedMs) && (pStats->targetResidencyMs >= selectedResidencyMs))
+        {
+            selected            = (hal_lpm_mode_t)mode;
+            selectedResidencyMs = pStats->targetResidencyMs;
+        }
+    }
+
+    if (selected == kLPMMode_Invalid)
+    {
+        pGovern->shallowCount++;
     }
     else
     {
-        ret = kStatus_HAL_LpmError;
+        pGovern->lastMode = selected;
     }
 
-    return ret;
+    return selected;
+#else
+    return s_LpmManager.currentMode;
+#endif /* FWK_SUPPORT_LPM_GOVERNOR */
 }
 
-static int _FWK_LpmManager_PreEnterSleep(lpm_dev_t *dev)
+static int _FWK_LpmManager_PreEnterSleepTimerCallback(lpm_dev_t *dev)
 {
-    int ret         = kStatus_HAL_LpmSuccess;
-    lpm_dev_t *pDev = s_LpmManager.dev;
+    int ret = kStatus_HAL_LpmSuccess;
 
-    if (s_LpmManager.currentMode == kLPMMode_SNVS)
+    lpm_dev_t *pDev = s_LpmManager.dev;
+    if (pDev != NULL && pDev->ops->enterSleep != NULL)
     {
-        fwk_message_t *pMsg = (fwk_message_t *)&s_LpmManager.lpmNotifyMsg;
+        bool enter = false;
+
+        pDev->ops->stopPreEnterTimer(pDev);
+
+        /* Both the last ack and the timeout end up here, only the first one enters sleep */
+        if (_FWK_LpmManager_Lock() != kStatus_HAL_LpmSuccess)
+        {
+            return kStatus_HAL_LpmError;
+        }
 
-        if (pMsg)
+        if (s_LpmManager.preEntering)
         {
-            pMsg->freeAfterConsumed = 0;
-            pMsg->id                = kFWKMessageID_LpmPreEnterSleep;
+            enter                    = true;
+            s_LpmManager.preEntering = false;
 
-            for (int i = kFWKTaskID_Camera; i < kFWKTaskID_APPStart; i++)
+            if (s_LpmManager.pendingAcks != 0)
             {
-                /* send the lpm enter sleep to dispatcher */
-                char *taskName = NULL;
-                uint32_t taskPriority;
+                LOGE("[LpmManager]:Tasks 0x%x did not ack pre-enter sleep in time", s_LpmManager.pendingAcks);
+                s_LpmManager.governorStats.ackTimeoutCount++;
+                s_LpmManager.pendingAcks = 0;
+            }
+        }
+
+        _FWK_LpmManager_Unlock();
+
+        if (!enter)
+        {
+            return ret;
+        }
+
+        s_LpmManager.enable = kLPMManagerStatus_SleepDisable;
 
-                FWK_Task_GetInfo(i, &taskName, &taskPriority);
+        if (s_LpmManager.currentMode < kLPMMode_Invalid)
+        {
+            s_LpmManager.modeStats[s_LpmManager.currentMode].enterCount++;
+            s_LpmManager.sleepingMode = s_LpmManager.currentMode;
+            s_LpmManager.sleepStartUs = FWK_CurrentTimeUs();
+        }
 
-                if (taskName != NULL)
+        ret = pDev->ops->enterSleep(pDev, s_LpmManager.currentMode);
+        if (ret != kStatus_HAL_LpmSuccess)
+        {
+            LOGE("[LpmManager]:Enter sleep mode %d error %d", s_LpmManager.currentMode, ret);
+
+            /* The board never slept, the next transition must not take the devices as released */
+            if (_FWK_LpmManager_Lock() == kStatus_HAL_LpmSuccess)
+            {
+                s_LpmManager.devicesReleased = false;
+                if (s_LpmManager.sleepingMode < kLPMMode_Invalid)
                 {
-                    FWK_Message_Put(i, &pMsg);
+                    s_LpmManager.modeStats[s_LpmManager.sleepingMode].enterCount--;
+                    s_LpmManager.sleepingMode = kLPMMode_Invalid;
                 }
+                _FWK_LpmManager_Unlock();
             }
         }
     }
+    else
+    {
+        ret = kStatus_HAL_LpmError;
+    }
 
+    return ret;
+}
+
+/* Enter sleep on the last ack. Pended to the timer service task, where the pre-enter timeout runs too, so the
+ * manager which acked last is not the one entering sleep */
+static void _FWK_LpmManager_AckedEnterSleep(void *param1, uint32_t param2)
+{
+    _FWK_LpmManager_PreEnterSleepTimerCallback(s_LpmManager.dev);
+}
+
+static int _FWK_LpmManager_PreEnterSleep(lpm_dev_t *dev)
+{
+    int ret         = kStatus_HAL_LpmSuccess;
+    lpm_dev_t *pDev = s_LpmManager.dev;
+    uint32_t tasks  = 0;
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        return ret;
+    }
+
+    /* Sleep is entered when the pre-enter timer expires, or as soon as every manager acked the pre-enter sleep msg.
+     * A request getting busy before the managers are notified cancels the transition. */
     ret = pDev->ops->openPreEnterTimer(pDev);
     if (ret)
     {
         LOGE("Start lpm dev %d pre-enter sleep timer error %d", pDev->id, ret);
     }
 
+    s_LpmManager.preEntering       = true;
+    s_LpmManager.pendingAcks       = 0;
+    s_LpmManager.transitionStartUs = FWK_CurrentTimeUs();
+
+    if (s_LpmManager.currentMode == kLPMMode_SNVS)
+    {
+        /* All the managers release their devices concurrently, the acks are armed before the first one can come */
+        tasks                        = _FWK_LpmManager_GetTasks();
+        s_LpmManager.pendingAcks     = tasks & s_LpmManager.ackTasks;
+        s_LpmManager.devicesReleased = true;
+    }
+
+    _FWK_LpmManager_Unlock();
+
+    _FWK_LpmManager_Notify(tasks);
+
     return ret;
 }
 
@@ -124,6 +431,7 @@ static int FWK_LpmManager_TimerCallback(lpm_dev_t *dev)
     List_t *pRequestList             = &(s_LpmManager.lpmRequestList);
     lpm_request_item_t *pRequestItem = NULL;
     lpm_dev_t *pDev                  = s_LpmManager.dev;
+    bool busy                        = false;
 
     if (s_LpmManager.enable == kLPMManagerStatus_SleepEnable)
     {
@@ -138,7 +446,9 @@ static int FWK_LpmManager_TimerCallback(lpm_dev_t *dev)
             {
                 if (pRequestItem->usageCount > 0)
                 {
-                    break;
+                    /* Keep walking so every requester holding the board awake gets accounted */
+                    pRequestItem->blockCount++;
+                    busy = true;
                 }
             }
 
@@ -146,12 +456,18 @@ static int FWK_LpmManager_TimerCallback(lpm_dev_t *dev)
             pxListItem = pxNext;
         }
 
-        if (pxListItem == pxListEnd && (pRequestList->uxNumberOfItems > 0))
+        if (!busy && (pRequestList->uxNumberOfItems > 0))
         {
-            if ((pDev != NULL) && (pDev->ops != NULL) &&(pDev->ops->enterSleep != NULL))
+            if ((pDev != NULL) && (pDev->ops != NULL) && (pDev->ops->enterSleep != NULL))
             {
-                pDev->ops->stopTimer(pDev);
-                _FWK_LpmManager_PreEnterSleep(pDev);
+                hal_lpm_mode_t mode = _FWK_LpmManager_SelectMode();
+
+                if (mode != kLPMMode_Invalid)
+                {
+                    s_LpmManager.currentMode = mode;
+                    pDev->ops->stopTimer(pDev);
+                    _FWK_LpmManager_PreEnterSleep(pDev);
+                }
             }
         }
     }
@@ -165,6 +481,24 @@ int FWK_LpmManager_Init()
     s_LpmManager.enable      = kLPMManagerStatus_SleepDisable;
     s_LpmManager.currentMode = kLPMMode_Invalid;
 
+    s_LpmManager.allowedModes     = 0;
+    s_LpmManager.maxWakeLatencyMs = 0;
+    s_LpmManager.totalUsageCount  = 0;
+    s_LpmManager.idleStartUs      = FWK_CurrentTimeUs();
+    s_LpmManager.sleepingMode     = kLPMMode_Invalid;
+    s_LpmManager.wakingMode       = kLPMMode_Invalid;
+    s_LpmManager.preEntering      = false;
+    s_LpmManager.devicesReleased  = false;
+    s_LpmManager.pendingAcks      = 0;
+    memset(s_LpmManager.modeStats, 0, sizeof(s_LpmManager.modeStats));
+    memset(&s_LpmManager.governorStats, 0, sizeof(s_LpmManager.governorStats));
+    s_LpmManager.governorStats.lastMode = kLPMMode_Invalid;
+
+    s_LpmManager.modeStats[kLPMMode_STANDBY].targetResidencyMs = LPM_MANAGER_STANDBY_TARGET_RESIDENCY_MS;
+    s_LpmManager.modeStats[kLPMMode_STANDBY].exitLatencyMs     = LPM_MANAGER_STANDBY_EXIT_LATENCY_MS;
+    s_LpmManager.modeStats[kLPMMode_SNVS].targetResidencyMs    = LPM_MANAGER_SNVS_TARGET_RESIDENCY_MS;
+    s_LpmManager.modeStats[kLPMMode_SNVS].exitLatencyMs        = LPM_MANAGER_SNVS_EXIT_LATENCY_MS;
+
     vListInitialise(&s_LpmManager.lpmRequestList);
 
     return kStatus_HAL_LpmSuccess;
@@ -242,6 +576,7 @@ int FWK_LpmManager_RegisterRequestHandler(hal_lpm_request_t *req)
         return kStatus_HAL_LpmRegisterFail;
     }
 
+    memset(pRequestItem, 0, sizeof(lpm_request_item_t));
     pRequestItem->dev        = req->dev;
     pRequestItem->usageCount = 0;
     strcpy(pRequestItem->requestName, req->name);
@@ -291,6 +626,12 @@ int FWK_LpmManager_UnregisterRequestHandler(hal_lpm_request_t *req)
         return kStatus_HAL_LpmUnregisterFail;
     }
 
+    if (_FWK_LpmManager_Lock() == kStatus_HAL_LpmSuccess)
+    {
+        _FWK_LpmManager_UpdateUsage(pRequestItem, 0);
+        _FWK_LpmManager_Unlock();
+    }
+
     pRequestItem->dev        = NULL;
     pRequestItem->usageCount = 0;
     memset(pRequestItem->requestName, 0x00, sizeof(pRequestItem->requestName));
@@ -332,6 +673,7 @@ int FWK_LpmManager_RuntimeGet(hal_lpm_request_t *req)
 
         if ((pRequestItem != NULL) && (pRequestItem->dev == req->dev))
         {
+            _FWK_LpmManager_UpdateUsage(pRequestItem, pRequestItem->usageCount + 1);
             pRequestItem->usageCount++;
             break;
         }
@@ -381,6 +723,7 @@ int FWK_LpmManager_RuntimePut(hal_lpm_request_t *req)
 
         if ((pRequestItem != NULL) && (pRequestItem->dev == req->dev))
         {
+            _FWK_LpmManager_UpdateUsage(pRequestItem, pRequestItem->usageCount - 1);
             pRequestItem->usageCount--;
             break;
         }
@@ -430,6 +773,7 @@ int FWK_LpmManager_RuntimeSet(hal_lpm_request_t *req, int8_t count)
 
         if ((pRequestItem != NULL) && (pRequestItem->dev == req->dev))
         {
+            _FWK_LpmManager_UpdateUsage(pRequestItem, count);
             pRequestItem->usageCount = count;
             break;
         }
@@ -513,7 +857,9 @@ int FWK_LpmManager_SetSleepMode(hal_lpm_mode_t sleepMode)
         return kStatus_HAL_LpmError;
     }
 
-    s_LpmManager.currentMode = sleepMode;
+    /* The mode of the lpm device replaces the allowed modes, FWK_LpmManager_SetAllowedModes extends them */
+    s_LpmManager.currentMode  = sleepMode;
+    s_LpmManager.allowedModes = (sleepMode < kLPMMode_Invalid) ? (1U << sleepMode) : 0;
 
     _FWK_LpmManager_Unlock();
 
@@ -540,6 +886,11 @@ int FWK_LpmManager_EnableSleepMode(hal_lpm_manager_status_t enable)
 
     if (s_LpmManager.enable != enable)
     {
+        if (s_LpmManager.sleepingMode != kLPMMode_Invalid)
+        {
+            _FWK_LpmManager_WakeUp();
+        }
+
         if (enable)
         {
             // enable the lpm
@@ -568,18 +919,290 @@ int FWK_LpmManager_EnableSleepMode(hal_lpm_manager_status_t enable)
                 LOGE("STOP lpm dev [%d] timer error: %d", pDev->id, ret);
             }
 
-            ret = s_LpmManager.dev->ops->stopPreEnterTimer(pDev);
-
-            if (ret)
+            if (!s_LpmManager.devicesReleased)
             {
-                LOGE("STOP lpm dev [%d] PreEnterTimer error: %d", pDev->id, ret);
+                /* Once the managers released their devices, the timer is kept as the timeout of their acks */
+                ret = s_LpmManager.dev->ops->stopPreEnterTimer(pDev);
+
+                if (ret)
+                {
+                    LOGE("STOP lpm dev [%d] PreEnterTimer error: %d", pDev->id, ret);
+                }
             }
 
             s_LpmManager.enable = enable;
+            _FWK_LpmManager_AbortSleep();
+        }
+    }
+
+    _FWK_LpmManager_Unlock();
+
+    return ret;
+}
+
+int FWK_LpmManager_SetModeParams(hal_lpm_mode_t mode, uint32_t targetResidencyMs, uint32_t exitLatencyMs)
+{
+    int ret = kStatus_HAL_LpmSuccess;
+
+    if (mode >= kLPMMode_Invalid)
+    {
+        LOGE("Invalid lpm mode %d", mode);
+        return kStatus_HAL_LpmError;
+    }
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        LOGE("Lpm set mode params error[%d]", mode);
+        return kStatus_HAL_LpmError;
+    }
+
+    s_LpmManager.modeStats[mode].targetResidencyMs = targetResidencyMs;
+    s_LpmManager.modeStats[mode].exitLatencyMs     = exitLatencyMs;
+
+    _FWK_LpmManager_Unlock();
+
+    return ret;
+}
+
+int FWK_LpmManager_SetAllowedModes(uint32_t modes)
+{
+    int ret = kStatus_HAL_LpmSuccess;
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        LOGE("Lpm set allowed modes error[0x%x]", modes);
+        return kStatus_HAL_LpmError;
+    }
+
+    s_LpmManager.allowedModes = modes & ((1U << kLPMMode_Invalid) - 1);
+
+    _FWK_LpmManager_Unlock();
+
+    return ret;
+}
+
+int FWK_LpmManager_SetWakeLatencyLimit(uint32_t maxWakeLatencyMs)
+{
+    int ret = kStatus_HAL_LpmSuccess;
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        LOGE("Lpm set wake latency limit error[%d]", maxWakeLatencyMs);
+        return kStatus_HAL_LpmError;
+    }
+
+    s_LpmManager.maxWakeLatencyMs = maxWakeLatencyMs;
+
+    _FWK_LpmManager_Unlock();
+
+    return ret;
+}
+
+int FWK_LpmManager_WakeUp(void)
+{
+    int ret = kStatus_HAL_LpmSuccess;
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        return ret;
+    }
+
+    ret = _FWK_LpmManager_WakeUp();
+
+    _FWK_LpmManager_Unlock();
+
+    return ret;
+}
+
+int FWK_LpmManager_WakeUpComplete(void)
+{
+    int ret = kStatus_HAL_LpmSuccess;
+    hal_lpm_mode_t mode;
+    lpm_mode_stats_t *pStats;
+    uint32_t latencyUs;
+
+    /* Called on every displayed frame, only take the lock after a wake up */
+    if (s_LpmManager.wakingMode >= kLPMMode_Invalid)
+    {
+        return kStatus_HAL_LpmError;
+    }
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        return ret;
+    }
+
+    mode = s_LpmManager.wakingMode;
+    if (mode < kLPMMode_Invalid)
+    {
+        pStats                    = &s_LpmManager.modeStats[mode];
+        latencyUs                 = FWK_CurrentTimeUs() - s_LpmManager.wakeUpUs;
+        pStats->lastWakeLatencyUs = latencyUs;
+        pStats->avgWakeLatencyUs  = _FWK_LpmManager_Average(pStats->avgWakeLatencyUs, latencyUs);
+        if (latencyUs > pStats->maxWakeLatencyUs)
+        {
+            pStats->maxWakeLatencyUs = latencyUs;
         }
+        s_LpmManager.wakingMode = kLPMMode_Invalid;
+
+        LOGD("[LpmManager]:Wake up from mode %d completed in %d us", mode, latencyUs);
     }
 
     _FWK_LpmManager_Unlock();
 
     return ret;
 }
+
+int FWK_LpmManager_RegisterSleepAck(fwk_task_id_t taskId)
+{
+    if (taskId >= kFWKTaskID_APPStart)
+    {
+        return kStatus_HAL_LpmError;
+    }
+
+    /* Called by the managers when they start, the lpm lock may not exist yet */
+    taskENTER_CRITICAL();
+    s_LpmManager.ackTasks |= (1U << taskId);
+    taskEXIT_CRITICAL();
+
+    return kStatus_HAL_LpmSuccess;
+}
+
+int FWK_LpmManager_Ack(fwk_task_id_t taskId)
+{
+    int ret    = kStatus_HAL_LpmSuccess;
+    bool enter = false;
+    uint32_t taskMask;
+
+    if (taskId >= kFWKTaskID_APPStart)
+    {
+        return kStatus_HAL_LpmError;
+    }
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        /* No lpm device registered, nothing is waiting for the ack */
+        return ret;
+    }
+
+    taskMask = (1U << taskId);
+
+    if (s_LpmManager.preEntering && (s_LpmManager.pendingAcks & taskMask))
+    {
+        s_LpmManager.pendingAcks &= ~taskMask;
+
+        if (s_LpmManager.pendingAcks == 0)
+        {
+            s_LpmManager.governorStats.lastPrepareUs = FWK_CurrentTimeUs() - s_LpmManager.transitionStartUs;
+            enter                                    = true;
+
+            LOGD("[LpmManager]:All tasks acked pre-enter sleep in %d us", s_LpmManager.governorStats.lastPrepareUs);
+        }
+    }
+
+    _FWK_LpmManager_Unlock();
+
+    if (enter && (xTimerPendFunctionCall(_FWK_LpmManager_AckedEnterSleep, NULL, 0, 0) != pdPASS))
+    {
+        /* The timer command queue is full, the pre-enter timeout enters sleep instead */
+        LOGE("[LpmManager]:Failed to pend the sleep entry, waiting for the pre-enter timeout");
+    }
+
+    return kStatus_HAL_LpmSuccess;
+}
+
+int FWK_LpmManager_GetModeStats(hal_lpm_mode_t mode, lpm_mode_stats_t *stats)
+{
+    if ((mode >= kLPMMode_Invalid) || (stats == NULL))
+    {
+        return kStatus_HAL_LpmError;
+    }
+
+    *stats = s_LpmManager.modeStats[mode];
+
+    /* Account the ongoing residency */
+    if (s_LpmManager.sleepingMode == mode)
+    {
+        stats->residencyMs += (FWK_CurrentTimeUs() - s_LpmManager.sleepStartUs) / 1000;
+    }
+
+    return kStatus_HAL_LpmSuccess;
+}
+
+int FWK_LpmManager_GetRequestStats(unsigned int index, lpm_request_stats_t *stats)
+{
+    int ret = kStatus_HAL_LpmSuccess;
+
+    if (stats == NULL)
+    {
+        return kStatus_HAL_LpmError;
+    }
+
+    if (!listLIST_IS_INITIALISED(&s_LpmManager.lpmRequestList))
+    {
+        LOGE("Lpm list not initialised");
+        return kStatus_HAL_LpmError;
+    }
+
+    ret = _FWK_LpmManager_Lock();
+    if (ret != kStatus_HAL_LpmSuccess)
+    {
+        return ret;
+    }
+
+    ListItem_t *pxListItem, *pxNext;
+    ListItem_t const *pxListEnd;
+    lpm_request_item_t *pRequestItem = NULL;
+    List_t *pRequestList             = &s_LpmManager.lpmRequestList;
+    pxListItem                       = listGET_HEAD_ENTRY(pRequestList);
+    pxListEnd                        = listGET_END_MARKER(pRequestList);
+
+    while ((pxListItem != pxListEnd) && (index > 0))
+    {
+        pxNext     = listGET_NEXT(pxListItem);
+        pxListItem = pxNext;
+        index--;
+    }
+
+    if (pxListItem == pxListEnd)
+    {
+        ret = kStatus_HAL_LpmError;
+    }
+    else
+    {
+        pRequestItem = (lpm_request_item_t *)listGET_LIST_ITEM_OWNER(pxListItem);
+        strcpy(stats->name, pRequestItem->requestName);
+        stats->usageCount = pRequestItem->usageCount;
+        stats->holdCount  = pRequestItem->holdCount;
+        stats->holdTimeMs = pRequestItem->holdTimeMs;
+        stats->blockCount = pRequestItem->blockCount;
+
+        /* Account the ongoing hold */
+        if (pRequestItem->usageCount > 0)
+        {
+            stats->holdTimeMs += (FWK_CurrentTimeUs() - pRequestItem->holdStartUs) / 1000;
+        }
+    }
+
+    _FWK_LpmManager_Unlock();
+
+    return ret;
+}
+
+int FWK_LpmManager_GetGovernorStats(lpm_governor_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return kStatus_HAL_LpmError;
+    }
+
+    *stats = s_LpmManager.governorStats;
+
+    return kStatus_HAL_LpmSuccess;
+}
@@ -17,6 +17,7 @@
 #include "fwk_task.h"
 #include "fwk_graphics.h"
 #include "fwk_output_manager.h"
+#include "fwk_lpm_manager.h"
 
 typedef struct
 {
@@ -295,6 +296,11 @@ static void _FWK_OutputManager_MessageHandle(fwk_message_t *pMsg, fwk_task_data_
                 pMsg->payload.freeAfterConsumed = 0;
                 FWK_FREE(pMsg->payload.data);
             }
+
+            if (pMsg->id == kFWKMessageID_LpmPreEnterSleep)
+            {
+                FWK_LpmManager_Ack(kFWKTaskID_Output);
+            }
         }
         break;
 
@@ -460,6 +466,9 @@ int FWK_OutputManager_Start(int taskPriority)
     s_OutputTask.task.taskStack  = s_OutputTaskStack;
     s_OutputTask.task.taskBuffer = s_OutputTaskTCBReference;
 
+    /* the output devices are notified before entering sleep */
+    FWK_LpmManager_RegisterSleepAck(kFWKTaskID_Output);
+
     FWK_Task_Start((fwk_task_t *)&s_OutputTask.task, OUTPUT_MANAGER_TASK_NAME, OUTPUT_MANAGER_TASK_STACK, taskPriority);
 
     LOGD("[OutputManager]:Started");
@@ -28,6 +28,7 @@ typedef struct _fwk_fps_data
 #define FWK_FPS_COUNT (MAXIMUM_CAMERA_DEV + MAXIMUM_DISPLAY_DEV + MAXIMUM_VISION_ALGO_DEV)
 
 static fwk_fps_data_t s_FpsData[FWK_FPS_COUNT];
+static volatile unsigned int s_FrameEvents[FWK_FPS_COUNT][kFWKFrameEvent_Count];
 
 static int _fwk_fps_id(fwk_fps_type_t type, int id)
 {
@@ -138,4 +139,30 @@ float fwk_get_fps(fwk_fps_type_t type, int id)
 
     return fps;
 }
+
+void fwk_frame_event(fwk_fps_type_t type, int id, fwk_frame_event_t event)
+{
+    int fps_id = _fwk_fps_id(type, id);
+
+    /* no log, the events are counted from interrupts */
+    if ((fps_id >= FWK_FPS_COUNT) || (event >= kFWKFrameEvent_Count))
+    {
+        return;
+    }
+
+    s_FrameEvents[fps_id][event]++;
+}
+
+unsigned int fwk_get_frame_events(fwk_fps_type_t type, int id, fwk_frame_event_t event)
+{
+    int fps_id = _fwk_fps_id(type, id);
+
+    if ((fps_id >= FWK_FPS_COUNT) || (event >= kFWKFrameEvent_Count))
+    {
+        LOGE("Invalid frame event type \"%d\" id \"%d\" event \"%d\"", type, id, event);
+        return 0;
+    }
+
+    return s_FrameEvents[fps_id][event];
+}
 #endif /* FWK_PERF */
\ No newline at end of file
@@ -9,116 +9,409 @@
 
 /*
  * @brief Framework timer reference implementation.
+ *
+ * The timers live in a hierarchical timer wheel served by a single task. Level 0 has one slot per tick,
+ * each slot of level N covers a full turn of level N - 1. Start, stop and reset only link or unlink the
+ * timer from a slot, the service task cascades the slots of the upper levels down when level 0 wraps.
+ * The service task sleeps until the next slot which holds a timer.
  */
 
 #include <FreeRTOS.h>
 #include "fwk_timer.h"
-#include <stdio.h>
+#include <string.h>
 #include "fwk_log.h"
 #include "fwk_platform.h"
 
-static void _FWK_Timer_Callback(TimerHandle_t handle)
+#define TIMER_WHEEL_SIZE (1U << FWK_TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SIZE - 1)
+/* Longest delay the wheel can hold, longer timers are parked on the last slot and cascaded again */
+#define TIMER_WHEEL_MAX_TICKS ((1U << (FWK_TIMER_WHEEL_BITS * FWK_TIMER_WHEEL_LEVELS)) - 1)
+#define TIMER_WHEEL_NO_EVENT  0x7FFFFFFFU
+
+typedef enum _fwk_timer_state
+{
+    kTimerState_Free = 0,
+    kTimerState_Active,  /* linked in a wheel slot */
+    kTimerState_Running, /* one time timer whose callback is being called */
+} fwk_timer_state_t;
+
+typedef struct _fwk_timer_wheel
+{
+    fwk_timer_node_t slots[FWK_TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE];
+    fwk_timer_t timers[FWK_TIMER_MAX_COUNT];
+    fwk_timer_node_t *freeList;
+    uint32_t now;    /* last tick processed by the service task */
+    uint32_t wakeAt; /* tick the service task sleeps until */
+    TaskHandle_t task;
+    int initialized;
+    fwk_timer_stats_t stats;
+} fwk_timer_wheel_t;
+
+static fwk_timer_wheel_t s_TimerWheel;
+
+static void _FWK_Timer_ListInit(fwk_timer_node_t *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static int _FWK_Timer_ListEmpty(const fwk_timer_node_t *head)
+{
+    return head->next == head;
+}
+
+static void _FWK_Timer_ListAdd(fwk_timer_node_t *head, fwk_timer_node_t *node)
+{
+    node->next       = head;
+    node->prev       = head->prev;
+    head->prev->next = node;
+    head->prev       = node;
+}
+
+static void _FWK_Timer_ListDel(fwk_timer_node_t *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next       = node;
+    node->prev       = node;
+}
+
+/* Move all the nodes of a list to another, empty, list */
+static void _FWK_Timer_ListMove(fwk_timer_node_t *from, fwk_timer_node_t *to)
 {
-    if (handle == NULL)
+    if (_FWK_Timer_ListEmpty(from))
     {
-        LOGE("Timer handle is NULL");
+        _FWK_Timer_ListInit(to);
         return;
     }
 
-    fwk_timer_t **pPTimer = (fwk_timer_t **)pvTimerGetTimerID(handle);
+    to->next       = from->next;
+    to->prev       = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    _FWK_Timer_ListInit(from);
+}
 
-    if (pPTimer == NULL)
+/* Link a timer in the slot matching its expiry. Must be called in a critical section. */
+static void _FWK_Timer_Insert(fwk_timer_t *pTimer)
+{
+    uint32_t expiry = pTimer->expiry;
+    uint32_t delta  = expiry - s_TimerWheel.now;
+    int level       = 0;
+
+    if (delta > TIMER_WHEEL_MAX_TICKS)
     {
-        LOGE("Cannot get timer ID from timer handle");
-        return;
+        /* Out of range, park it on the farthest slot, it is placed again when that slot cascades */
+        expiry = s_TimerWheel.now + TIMER_WHEEL_MAX_TICKS;
+        delta  = TIMER_WHEEL_MAX_TICKS;
     }
 
-    fwk_timer_t *pTimer = *pPTimer;
+    while ((level < FWK_TIMER_WHEEL_LEVELS - 1) && (delta >= (1U << (FWK_TIMER_WHEEL_BITS * (level + 1)))))
+    {
+        level++;
+    }
 
-    if (pTimer == NULL)
+    _FWK_Timer_ListAdd(&s_TimerWheel.slots[level][(expiry >> (FWK_TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK],
+                       &pTimer->node);
+}
+
+/* Tick of the next slot holding a timer. Must be called in a critical section. */
+static uint32_t _FWK_Timer_NextEvent(void)
+{
+    uint32_t next = s_TimerWheel.now + TIMER_WHEEL_NO_EVENT;
+
+    if (s_TimerWheel.stats.activeCount == 0)
     {
-        LOGE("Cannot get timer handle");
-        return;
+        return next;
     }
 
-    if (pTimer->function)
+    for (int level = 0; level < FWK_TIMER_WHEEL_LEVELS; level++)
     {
-        pTimer->function(pTimer->arg);
+        uint32_t shift = FWK_TIMER_WHEEL_BITS * level;
+        uint32_t base  = s_TimerWheel.now >> shift;
+
+        for (uint32_t step = 1; step <= TIMER_WHEEL_SIZE; step++)
+        {
+            if (!_FWK_Timer_ListEmpty(&s_TimerWheel.slots[level][(base + step) & TIMER_WHEEL_MASK]))
+            {
+                /* Slots of the upper levels are due when they cascade, at the start of their range */
+                uint32_t tick = (base + step) << shift;
+                if ((tick - s_TimerWheel.now) < (next - s_TimerWheel.now))
+                {
+                    next = tick;
+                }
+                break;
+            }
+        }
     }
 
-    /* user might have stopped the timer manual in the callback function */
-    pTimer = *pPTimer;
-    if (pTimer == NULL)
+    return next;
+}
+
+/* Release a timer slot and clear its handle. Must be called in a critical section. */
+static void _FWK_Timer_Free(fwk_timer_t *pTimer)
+{
+    if ((pTimer->owner != NULL) && (*pTimer->owner == pTimer))
     {
-        LOGI("Timer was stopped in the callback function");
-        return;
+        *pTimer->owner = NULL;
     }
 
-    /* stop the timer for the non auto reload mode */
-    if (!pTimer->autoReload)
+    pTimer->state         = kTimerState_Free;
+    pTimer->owner         = NULL;
+    pTimer->node.next     = s_TimerWheel.freeList;
+    s_TimerWheel.freeList = &pTimer->node;
+    s_TimerWheel.stats.activeCount--;
+}
+
+static void _FWK_Timer_Dispatch(fwk_timer_node_t *expired)
+{
+    while (1)
     {
-        if (FWK_Timer_Stop(pPTimer) != 0)
+        fwk_timer_t *pTimer;
+        fwk_timer_callback_t function;
+        void *arg;
+        uint32_t lateTicks;
+        unsigned int startUs;
+        unsigned int callbackUs;
+
+        taskENTER_CRITICAL();
+        if (_FWK_Timer_ListEmpty(expired))
+        {
+            taskEXIT_CRITICAL();
+            break;
+        }
+
+        pTimer = (fwk_timer_t *)expired->next;
+        _FWK_Timer_ListDel(&pTimer->node);
+        lateTicks = xTaskGetTickCount() - pTimer->expiry;
+        function  = pTimer->function;
+        arg       = pTimer->arg;
+
+        if (pTimer->autoReload)
+        {
+            /* Re-armed before the callback so it can stop or reset itself */
+            pTimer->expiry = s_TimerWheel.now + pTimer->period;
+            _FWK_Timer_Insert(pTimer);
+        }
+        else
+        {
+            pTimer->state = kTimerState_Running;
+        }
+
+        s_TimerWheel.stats.expireCount++;
+        if (lateTicks > s_TimerWheel.stats.maxLateTicks)
+        {
+            s_TimerWheel.stats.maxLateTicks = lateTicks;
+        }
+        taskEXIT_CRITICAL();
+
+        startUs = FWK_CurrentTimeUs();
+        if (function)
+        {
+            function(arg);
+        }
+        callbackUs = FWK_CurrentTimeUs() - startUs;
+
+        taskENTER_CRITICAL();
+        /* user might have stopped, reset or restarted the timer in the callback function */
+        if (pTimer->state == kTimerState_Running)
+        {
+            _FWK_Timer_Free(pTimer);
+        }
+
+        if (callbackUs > s_TimerWheel.stats.maxCallbackUs)
         {
-            LOGE("Failed to stop timer \"%s\"", pTimer->name);
+            s_TimerWheel.stats.maxCallbackUs = callbackUs;
         }
+        taskEXIT_CRITICAL();
     }
 }
 
-int FWK_Timer_Start(
-    const char *name, int ms, int autoReload, fwk_timer_callback_t func, void *arg, fwk_timer_t **pPTimer)
+/* Process one tick: cascade the upper levels when level 0 wraps and call the expired timers */
+static void _FWK_Timer_Tick(void)
 {
-    *pPTimer = NULL;
+    fwk_timer_node_t expired;
 
-    fwk_timer_t *pTimer = (fwk_timer_t *)FWK_MALLOC(sizeof(fwk_timer_t));
+    taskENTER_CRITICAL();
+    s_TimerWheel.now++;
 
-    if (pTimer == NULL)
+    for (int level = 1; level < FWK_TIMER_WHEEL_LEVELS; level++)
     {
-        LOGE("Failed to create timer \"%s\"", name);
-        return -1;
+        uint32_t shift = FWK_TIMER_WHEEL_BITS * level;
+        fwk_timer_node_t cascade;
+
+        if (s_TimerWheel.now & ((1U << shift) - 1))
+        {
+            break;
+        }
+
+        _FWK_Timer_ListMove(&s_TimerWheel.slots[level][(s_TimerWheel.now >> shift) & TIMER_WHEEL_MASK], &cascade);
+        while (!_FWK_Timer_ListEmpty(&cascade))
+        {
+            fwk_timer_t *pTimer = (fwk_timer_t *)cascade.next;
+            _FWK_Timer_ListDel(&pTimer->node);
+            _FWK_Timer_Insert(pTimer);
+        }
     }
 
-    memset(pTimer->name, 0x0, TIMER_NAME_LENGTH);
-    sprintf(pTimer->name, name, strlen(name) < TIMER_NAME_LENGTH ? strlen(name) : TIMER_NAME_LENGTH);
-    pTimer->function   = func;
-    pTimer->arg        = arg;
-    pTimer->autoReload = autoReload;
-    pTimer->lock       = xSemaphoreCreateMutex();
+    _FWK_Timer_ListMove(&s_TimerWheel.slots[0][s_TimerWheel.now & TIMER_WHEEL_MASK], &expired);
+    taskEXIT_CRITICAL();
+
+    _FWK_Timer_Dispatch(&expired);
+}
 
-    if (pTimer->lock == NULL)
+static void _FWK_Timer_Task(void *param)
+{
+    while (1)
     {
-        LOGE("Failed to create timer lock");
+        TickType_t wait = portMAX_DELAY;
+        uint32_t target;
+
+        taskENTER_CRITICAL();
+        s_TimerWheel.wakeAt = _FWK_Timer_NextEvent();
+        if (s_TimerWheel.stats.activeCount != 0)
+        {
+            wait = s_TimerWheel.wakeAt - xTaskGetTickCount();
+            if ((int32_t)wait < 0)
+            {
+                wait = 0;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        /* Woken up earlier when a timer expiring before wakeAt is started */
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        target = xTaskGetTickCount();
+        while ((int32_t)(target - s_TimerWheel.now) > 0)
+        {
+            uint32_t next;
+
+            taskENTER_CRITICAL();
+            next = _FWK_Timer_NextEvent();
+            if ((int32_t)(next - target) > 0)
+            {
+                /* Nothing happens until target, skip the empty ticks */
+                s_TimerWheel.now = target;
+                taskEXIT_CRITICAL();
+                break;
+            }
+            s_TimerWheel.now = next - 1;
+            taskEXIT_CRITICAL();
+
+            _FWK_Timer_Tick();
+        }
     }
+}
 
-    UBaseType_t uxAutoReload = pdFALSE;
-    if (autoReload)
+static int _FWK_Timer_Init(void)
+{
+    int create = 0;
+
+    taskENTER_CRITICAL();
+    if (!s_TimerWheel.initialized)
     {
-        uxAutoReload = pdTRUE;
+        for (int level = 0; level < FWK_TIMER_WHEEL_LEVELS; level++)
+        {
+            for (uint32_t slot = 0; slot < TIMER_WHEEL_SIZE; slot++)
+            {
+                _FWK_Timer_ListInit(&s_TimerWheel.slots[level][slot]);
+            }
+        }
+
+        s_TimerWheel.freeList = NULL;
+        for (int i = FWK_TIMER_MAX_COUNT - 1; i >= 0; i--)
+        {
+            s_TimerWheel.timers[i].state     = kTimerState_Free;
+            s_TimerWheel.timers[i].node.next = s_TimerWheel.freeList;
+            s_TimerWheel.freeList            = &s_TimerWheel.timers[i].node;
+        }
+
+        s_TimerWheel.now         = xTaskGetTickCount();
+        s_TimerWheel.wakeAt      = s_TimerWheel.now + TIMER_WHEEL_NO_EVENT;
+        s_TimerWheel.initialized = 1;
+        create                   = 1;
+    }
+    taskEXIT_CRITICAL();
+
+    if (create)
+    {
+        if (xTaskCreate(_FWK_Timer_Task, "FWK_Timer", FWK_TIMER_TASK_STACK_SIZE, NULL, FWK_TIMER_TASK_PRIORITY,
+                        &s_TimerWheel.task) != pdPASS)
+        {
+            LOGE("Timer service task creation failed");
+            return -1;
+        }
     }
 
-    pTimer->handle = xTimerCreate(name, (TickType_t)pdMS_TO_TICKS(ms), uxAutoReload, pPTimer,
-                                  (TimerCallbackFunction_t)_FWK_Timer_Callback);
+    return (s_TimerWheel.task != NULL) ? 0 : -1;
+}
+
+/* Wake the service task up if the timer expires before the task would */
+static void _FWK_Timer_Notify(uint32_t expiry)
+{
+    if ((s_TimerWheel.task != NULL) && ((expiry - s_TimerWheel.now) < (s_TimerWheel.wakeAt - s_TimerWheel.now)))
+    {
+        s_TimerWheel.wakeAt = expiry;
+        xTaskNotifyGive(s_TimerWheel.task);
+    }
+}
+
+int FWK_Timer_Start(
+    const char *name, int ms, int autoReload, fwk_timer_callback_t func, void *arg, fwk_timer_t **pPTimer)
+{
+    fwk_timer_t *pTimer;
+    uint32_t ticks;
+
+    *pPTimer = NULL;
 
-    if (pTimer->handle == NULL)
+    if (_FWK_Timer_Init() != 0)
     {
         LOGE("Failed to create timer \"%s\"", name);
-        FWK_FREE(pTimer);
-        pTimer = NULL;
         return -1;
     }
 
-    if (xTimerStart(pTimer->handle, 0) == pdPASS)
+    ticks = (uint32_t)pdMS_TO_TICKS(ms);
+    if (ticks == 0)
     {
-        *pPTimer = pTimer;
-        LOGI("Timer %s started successfully", name);
+        ticks = 1;
     }
-    else
+
+    taskENTER_CRITICAL();
+    pTimer = (fwk_timer_t *)s_TimerWheel.freeList;
+    if (pTimer == NULL)
     {
-        LOGE("Failed to start timer \"%s\"", name);
-        xTimerDelete(pTimer->handle, 0);
-        FWK_FREE(pTimer);
-        pTimer = NULL;
+        s_TimerWheel.stats.failCount++;
+        taskEXIT_CRITICAL();
+        LOGE("Failed to create timer \"%s\", all %d timers are in use", name, FWK_TIMER_MAX_COUNT);
         return -1;
     }
+    s_TimerWheel.freeList = pTimer->node.next;
+
+    _FWK_Timer_ListInit(&pTimer->node);
+    strncpy(pTimer->name, name, TIMER_NAME_LENGTH - 1);
+    pTimer->name[TIMER_NAME_LENGTH - 1] = '\0';
+    pTimer->function                    = func;
+    pTimer->arg                         = arg;
+    pTimer->autoReload                  = autoReload;
+    pTimer->owner                       = pPTimer;
+    pTimer->period                      = ticks;
+    pTimer->expiry                      = xTaskGetTickCount() + ticks;
+    pTimer->state                       = kTimerState_Active;
+    _FWK_Timer_Insert(pTimer);
+
+    s_TimerWheel.stats.startCount++;
+    s_TimerWheel.stats.activeCount++;
+    if (s_TimerWheel.stats.activeCount > s_TimerWheel.stats.peakCount)
+    {
+        s_TimerWheel.stats.peakCount = s_TimerWheel.stats.activeCount;
+    }
+
+    *pPTimer = pTimer;
+    _FWK_Timer_Notify(pTimer->expiry);
+    taskEXIT_CRITICAL();
+
+    LOGV("Timer %s started successfully", name);
 
     return 0;
 }
@@ -131,29 +424,25 @@ int FWK_Timer_Reset(fwk_timer_t **pPTimer)
         return -1;
     }
 
+    taskENTER_CRITICAL();
     fwk_timer_t *pTimer = *pPTimer;
 
-    if ((pTimer != NULL) && (pTimer->handle != NULL) && (xTimerIsTimerActive(pTimer->handle)))
+    if ((pTimer != NULL) && (pTimer->state != kTimerState_Free))
     {
-        if (xTimerReset(pTimer->handle, 0) == pdPASS)
-        {
-            LOGI("Timer \"%s\" reset successfully", pTimer->name);
-            return 0;
-        }
-        else
-        {
-            LOGE("Failed to reset timer \"%s\"", pTimer->name);
-        }
+        /* A one time timer can also be re-armed from its own callback */
+        _FWK_Timer_ListDel(&pTimer->node);
+        pTimer->expiry = xTaskGetTickCount() + pTimer->period;
+        pTimer->state  = kTimerState_Active;
+        _FWK_Timer_Insert(pTimer);
+        _FWK_Timer_Notify(pTimer->expiry);
+        taskEXIT_CRITICAL();
+
+        LOGV("Timer \"%s\" reset successfully", pTimer->name);
+        return 0;
     }
+    taskEXIT_CRITICAL();
 
-    if (pTimer != NULL)
-    {
-        LOGE("Timer \"%s\" is not active", pTimer->name);
-    }
-    else
-    {
-        LOGE("pTimer does not exist");
-    }
+    LOGE("pTimer does not exist");
 
     return -1;
 }
@@ -166,87 +455,101 @@ int FWK_Timer_Stop(fwk_timer_t **pPTimer)
         return -1;
     }
 
+    taskENTER_CRITICAL();
     fwk_timer_t *pTimer = *pPTimer;
 
-    if (pTimer != NULL)
+    if ((pTimer != NULL) && (pTimer->state != kTimerState_Free))
     {
-        if (pdTRUE != xSemaphoreTake(pTimer->lock, portMAX_DELAY))
-        {
-            LOGE("timer stop lock take failed");
-        }
+        _FWK_Timer_ListDel(&pTimer->node);
+        _FWK_Timer_Free(pTimer);
+        *pPTimer = NULL;
+        taskEXIT_CRITICAL();
 
-        if (pTimer->handle != NULL)
-        {
-            if (xTimerIsTimerActive(pTimer->handle))
-            {
-                if (xTimerStop(pTimer->handle, 0) != pdPASS)
-                {
-                    LOGE("timer %s stopped failed", pTimer->name);
-                }
-            }
+        LOGV("timer 0x%x stopped successfully", pPTimer);
+        return 0;
+    }
+    taskEXIT_CRITICAL();
 
-            if (xTimerDelete(pTimer->handle, 0) == pdPASS)
-            {
-                LOGI("timer %s stopped successfully", pTimer->name);
-            }
-            else
-            {
-                LOGE("timer %s stopped failed", pTimer->name);
-            }
-        }
-        else
-        {
-            LOGE("timer had been stopped");
-        }
+    LOGE("pTimer does not exist");
+
+    return -1;
+}
 
-        LOGI("FWK_Timer_Stop free 0x%x/0x%x", pPTimer, pTimer);
+uint32_t FWK_Timer_GetRemainingTime(fwk_timer_t **pPTimer)
+{
+    uint32_t remaining = (uint32_t)-1;
 
-        SemaphoreHandle_t lock = pTimer->lock;
+    if (pPTimer == NULL)
+    {
+        LOGE("[getRemainingTime]: pPTimer does not exist");
+        return -1;
+    }
 
-        FWK_FREE(pTimer);
+    taskENTER_CRITICAL();
+    fwk_timer_t *pTimer = *pPTimer;
 
-        if (pdTRUE != xSemaphoreGive(lock))
+    if ((pTimer != NULL) && (pTimer->state == kTimerState_Active))
+    {
+        remaining = pTimer->expiry - xTaskGetTickCount();
+        if ((int32_t)remaining < 0)
         {
-            LOGE("timer stop lock give failed");
+            remaining = 0;
         }
-
-        vSemaphoreDelete(lock);
-
-        pTimer   = NULL;
-        *pPTimer = NULL;
-        return 0;
     }
-    else
+    taskEXIT_CRITICAL();
+
+    if (remaining == (uint32_t)-1)
     {
-        LOGE("pTimer does not exist");
+        LOGE("Timer is not active");
     }
 
-    return -1;
+    return remaining;
 }
 
-uint32_t FWK_Timer_GetRemainingTime(fwk_timer_t **pPTimer)
+int FWK_Timer_GetStats(fwk_timer_stats_t *stats)
 {
-    if (pPTimer == NULL)
+    if (stats == NULL)
     {
-        LOGE("[getRemainingTime]: pPTimer does not exist");
         return -1;
     }
 
-    fwk_timer_t *pTimer = *pPTimer;
+    taskENTER_CRITICAL();
+    *stats = s_TimerWheel.stats;
+    taskEXIT_CRITICAL();
 
-    if ((pTimer != NULL) && (pTimer->handle != NULL) && (xTimerIsTimerActive(pTimer->handle)))
-    {
-        return xTimerGetExpiryTime(pTimer->handle) - xTaskGetTickCount();
-    }
+    return 0;
+}
 
-    if (pTimer != NULL)
+int FWK_Timer_GetActive(fwk_timer_info_t *info, int count)
+{
+    int found = 0;
+
+    if ((info == NULL) || (count <= 0))
     {
-        LOGE("Timer \"%s\" is not active", pTimer->name);
+        return 0;
     }
-    else
+
+    taskENTER_CRITICAL();
+    for (int i = 0; (i < FWK_TIMER_MAX_COUNT) && (found < count); i++)
     {
-        LOGE("pTimer does not exist");
+        fwk_timer_t *pTimer = &s_TimerWheel.timers[i];
+
+        if (pTimer->state == kTimerState_Free)
+        {
+            continue;
+        }
+
+        memcpy(info[found].name, pTimer->name, TIMER_NAME_LENGTH);
+        info[found].remainingTicks = (pTimer->state == kTimerState_Active) ? pTimer->expiry - xTaskGetTickCount() : 0;
+        if ((int32_t)info[found].remainingTicks < 0)
+        {
+            info[found].remainingTicks = 0;
+        }
+        info[found].periodTicks = pTimer->period;
+        info[found].autoReload  = pTimer->autoReload;
+        found++;
     }
+    taskEXIT_CRITICAL();
 
-    return -1;
+    return found;
 }
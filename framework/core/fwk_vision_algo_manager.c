@@ -17,6 +17,34 @@
 #include "fwk_task.h"
 #include "fwk_perf.h"
 #include "fwk_vision_algo_manager.h"
+#include "fwk_lpm_manager.h"
+
+typedef enum _vision_algo_slot_state
+{
+    kVAlgoSlot_Free = 0,
+    kVAlgoSlot_Filling,   /* requested from the camera manager */
+    kVAlgoSlot_Ready,     /* all the frames received, waiting for run */
+    kVAlgoSlot_Inferring, /* used by run */
+} vision_algo_slot_state_t;
+
+typedef struct
+{
+    vision_algo_slot_state_t state;
+    /* bitmask of the frame types not received yet */
+    uint32_t pendingFrames;
+    /* fill time of the latest frame */
+    uint32_t timestampUs;
+    void *data[kVAlgoFrameID_Count];
+} vision_algo_frame_slot_t;
+
+typedef struct
+{
+    vision_algo_frame_slot_t slots[VISION_ALGO_FRAME_DEPTH];
+    int depth;
+    /* run failed or stopped, no new frames until the device requests them */
+    bool paused;
+    vision_algo_frame_stats_t stats;
+} vision_algo_frame_ring_t;
 
 typedef struct
 {
@@ -25,7 +53,8 @@ typedef struct
     vision_algo_dev_t *devs[MAXIMUM_VISION_ALGO_DEV];
     /* vision algorithm request frame message */
     fwk_message_t VAlgoReqMsgs[MAXIMUM_VISION_ALGO_DEV * kVAlgoFrameID_Count];
-    int frameReady[MAXIMUM_VISION_ALGO_DEV * kVAlgoFrameID_Count];
+    /* frame slots of each device */
+    vision_algo_frame_ring_t rings[MAXIMUM_VISION_ALGO_DEV];
 
 } vision_algo_task_data_t;
 
@@ -48,6 +77,214 @@ static void *s_VisionAlgoTaskStack        = NULL;
 static void *s_VisionAlgoTaskTCBReference = NULL;
 #endif
 
+static void _FWK_VisionAlgoManager_RingInit(vision_algo_task_data_t *pAlgoTaskData, int devId)
+{
+    vision_algo_dev_t *pDev         = pAlgoTaskData->devs[devId];
+    vision_algo_frame_ring_t *pRing = &pAlgoTaskData->rings[devId];
+    vision_algo_frame_slot_t slots[VISION_ALGO_FRAME_DEPTH];
+    int depth = VISION_ALGO_FRAME_DEPTH;
+
+    memset(slots, 0, sizeof(slots));
+
+    for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
+    {
+        if (pDev->data.frames[frame_index].is_supported)
+        {
+            slots[0].data[frame_index] = pDev->data.frames[frame_index].data;
+#if VISION_ALGO_FRAME_DEPTH > 1
+            /* the ring is as deep as the frame type with the fewest buffers */
+            for (int slot = 1; slot < depth; slot++)
+            {
+                if (pDev->data.frames[frame_index].ringData[slot - 1] == NULL)
+                {
+                    depth = slot;
+                    break;
+                }
+                slots[slot].data[frame_index] = pDev->data.frames[frame_index].ringData[slot - 1];
+            }
+#endif /* VISION_ALGO_FRAME_DEPTH > 1 */
+        }
+    }
+
+    /* re-init with the same buffers keeps the slots in flight, the camera may still be filling one of them */
+    bool sameBuffers = (pRing->depth == depth);
+    for (int slot = 0; sameBuffers && (slot < depth); slot++)
+    {
+        sameBuffers = (memcmp(pRing->slots[slot].data, slots[slot].data, sizeof(slots[slot].data)) == 0);
+    }
+
+    if (sameBuffers)
+    {
+        return;
+    }
+
+    /* new buffers, drop the old slots but keep the counters */
+    memcpy(pRing->slots, slots, sizeof(slots));
+    pRing->depth       = depth;
+    pRing->paused      = false;
+    pRing->stats.depth = depth;
+    LOGD("vision algo dev[%d] runs on %d frame slots", devId, pRing->depth);
+}
+
+/*
+ * Request the next frames of a device from the camera manager. The camera manager keeps one request per frame type,
+ * so only one slot is filled at a time. If no slot is free, the oldest ready slot is dropped. The inferring slot is
+ * never dropped nor refilled, a device without a free or ready slot waits for the end of its run.
+ */
+static void _FWK_VisionAlgoManager_RequestFrames(vision_algo_task_data_t *pAlgoTaskData, int devId)
+{
+    vision_algo_dev_t *pDev         = pAlgoTaskData->devs[devId];
+    vision_algo_frame_ring_t *pRing = &pAlgoTaskData->rings[devId];
+    vision_algo_frame_slot_t *pSlot = NULL;
+
+    for (int i = 0; i < pRing->depth; i++)
+    {
+        if (pRing->slots[i].state == kVAlgoSlot_Filling)
+        {
+            return;
+        }
+        else if ((pSlot == NULL) && (pRing->slots[i].state == kVAlgoSlot_Free))
+        {
+            pSlot = &pRing->slots[i];
+        }
+    }
+
+    if (pSlot == NULL)
+    {
+        for (int i = 0; i < pRing->depth; i++)
+        {
+            if ((pRing->slots[i].state == kVAlgoSlot_Ready) &&
+                ((pSlot == NULL) || ((int32_t)(pRing->slots[i].timestampUs - pSlot->timestampUs) < 0)))
+            {
+                pSlot = &pRing->slots[i];
+            }
+        }
+
+        if (pSlot == NULL)
+        {
+            return;
+        }
+        pRing->stats.dropCount++;
+    }
+
+    pSlot->state         = kVAlgoSlot_Filling;
+    pSlot->pendingFrames = 0;
+    for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
+    {
+        if (pDev->data.frames[frame_index].is_supported)
+        {
+            pSlot->pendingFrames |= (1U << frame_index);
+
+            fwk_message_t *pMsg;
+            pMsg               = &pAlgoTaskData->VAlgoReqMsgs[devId * kVAlgoFrameID_Count + frame_index];
+            pMsg->payload.data = pSlot->data[frame_index];
+            FWK_Message_Put(kFWKTaskID_Camera, &pMsg);
+        }
+    }
+}
+
+static void _FWK_VisionAlgoManager_FrameResponse(vision_algo_task_data_t *pAlgoTaskData, fwk_message_t *pMsg)
+{
+    int valgo_dev_id                = pMsg->payload.devId / kVAlgoFrameID_Count;
+    int frameId                     = pMsg->payload.devId % kVAlgoFrameID_Count;
+    vision_algo_dev_t *pDev         = pAlgoTaskData->devs[valgo_dev_id];
+    vision_algo_frame_ring_t *pRing = &pAlgoTaskData->rings[valgo_dev_id];
+    vision_algo_frame_slot_t *pSlot = NULL;
+    void *devFrames[kVAlgoFrameID_Count];
+    hal_valgo_status_t status;
+    uint32_t startUs;
+
+    if ((pDev == NULL) || (pDev->ops->run == NULL))
+    {
+        return;
+    }
+
+    for (int i = 0; i < pRing->depth; i++)
+    {
+        if ((pRing->slots[i].state == kVAlgoSlot_Filling) && (pRing->slots[i].data[frameId] == pMsg->payload.data))
+        {
+            pSlot = &pRing->slots[i];
+            break;
+        }
+    }
+
+    if (pSlot == NULL)
+    {
+        /* response to a request issued before the ring was reset */
+        return;
+    }
+
+    pSlot->timestampUs = pMsg->payload.frame.timestampUs;
+
+    pSlot->pendingFrames &= ~(1U << frameId);
+    if (pSlot->pendingFrames != 0)
+    {
+        return;
+    }
+
+    if (pRing->paused)
+    {
+        pSlot->state = kVAlgoSlot_Free;
+        return;
+    }
+
+    /* the newest frame is run, older frames still waiting are dropped */
+    for (int i = 0; i < pRing->depth; i++)
+    {
+        if (pRing->slots[i].state == kVAlgoSlot_Ready)
+        {
+            pRing->slots[i].state = kVAlgoSlot_Free;
+            pRing->stats.dropCount++;
+        }
+    }
+    /* inferring before the next request, a single slot device must not get its only buffer refilled during run */
+    pSlot->state = kVAlgoSlot_Inferring;
+
+    /* let the camera fill the next slot while this one is processed */
+    _FWK_VisionAlgoManager_RequestFrames(pAlgoTaskData, valgo_dev_id);
+
+    /* run sees the slot buffers through the device frames, the device buffers are restored afterwards */
+    for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
+    {
+        devFrames[frame_index] = pDev->data.frames[frame_index].data;
+        if (pDev->data.frames[frame_index].is_supported)
+        {
+            pDev->data.frames[frame_index].data = pSlot->data[frame_index];
+        }
+    }
+
+    startUs = FWK_CurrentTimeUs();
+    status  = pDev->ops->run(pDev, NULL);
+
+    if (pRing->stats.runCount == 0)
+    {
+        pRing->stats.startUs = startUs;
+    }
+    pRing->stats.runCount++;
+    pRing->stats.lastRunUs = FWK_CurrentTimeUs() - startUs;
+    pRing->stats.lastAgeUs = startUs - pSlot->timestampUs;
+    if (pRing->stats.lastAgeUs > pRing->stats.maxAgeUs)
+    {
+        pRing->stats.maxAgeUs = pRing->stats.lastAgeUs;
+    }
+
+    for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
+    {
+        pDev->data.frames[frame_index].data = devFrames[frame_index];
+    }
+    pSlot->state = kVAlgoSlot_Free;
+
+    if (status == kStatus_HAL_ValgoSuccess)
+    {
+        /* single slot devices request their next frame only now */
+        _FWK_VisionAlgoManager_RequestFrames(pAlgoTaskData, valgo_dev_id);
+    }
+    else
+    {
+        pRing->paused = true;
+    }
+}
+
 /*
  * vision algorithm dev callback
  */
@@ -86,7 +323,6 @@ static int _FWK_VisionAlgoManager_DeviceCallback(int devId, valgo_event_t event,
             vision_algo_dev_t *pDev = s_VisionAlgoTask.algoData.devs[devId];
             if (pDev != NULL)
             {
-                /* send the frame requests to camera manager */
                 for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
                 {
                     if (pDev->data.frames[frame_index].is_supported)
@@ -105,10 +341,12 @@ static int _FWK_VisionAlgoManager_DeviceCallback(int devId, valgo_event_t event,
                             pMsg->multicore.taskId             = kFWKTaskID_Camera;
                         }
 #endif /* FWK_SUPPORT_MULTICORE */
-
-                        FWK_Message_Put(kFWKTaskID_Camera, &pMsg);
                     }
                 }
+
+                /* send the frame requests to camera manager */
+                s_VisionAlgoTask.algoData.rings[devId].paused = false;
+                _FWK_VisionAlgoManager_RequestFrames(&s_VisionAlgoTask.algoData, devId);
             }
         }
         break;
@@ -224,7 +462,8 @@ static int _FWK_VisionAlgoManager_TaskInit(fwk_task_data_t *pTaskData)
                 continue;
             }
 
-            /* send the frame requests to camera manager */
+            _FWK_VisionAlgoManager_RingInit(pAlgoTaskData, i);
+
             for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
             {
                 if (pDev->data.frames[frame_index].is_supported)
@@ -247,17 +486,22 @@ static int _FWK_VisionAlgoManager_TaskInit(fwk_task_data_t *pTaskData)
                     pMsg->payload.frame.srcFormat = pDev->data.frames[frame_index].srcFormat;
                     pMsg->payload.data            = pDev->data.frames[frame_index].data;
 
-                    /* will request the frame only the device is configured as auto start */
+#if FWK_SUPPORT_MULTICORE
                     if (pDev->data.autoStart)
                     {
-#if FWK_SUPPORT_MULTICORE
                         pMsg->multicore.isMulticoreMessage = 1;
                         pMsg->multicore.taskId             = kFWKTaskID_Camera;
-#endif /* FWK_SUPPORT_MULTICORE */
-                        FWK_Message_Put(kFWKTaskID_Camera, &pMsg);
                     }
+#endif /* FWK_SUPPORT_MULTICORE */
                 }
             }
+
+            /* will request the frame only the device is configured as auto start */
+            if (pDev->data.autoStart)
+            {
+                /* send the frame requests to camera manager */
+                _FWK_VisionAlgoManager_RequestFrames(pAlgoTaskData, i);
+            }
         }
     }
 
@@ -276,70 +520,28 @@ static void _FWK_VisionAlgoManager_MessageHandle(fwk_message_t *pMsg, fwk_task_d
         case kFWKMessageID_VAlgoResponseFrame:
         {
             /* received one VALGO response frame */
-            int valgo_dev_id        = pMsg->payload.devId / kVAlgoFrameID_Count;
-            vision_algo_dev_t *pDev = pAlgoTaskData->devs[valgo_dev_id];
-            if ((pDev != NULL) && (pDev->ops->run != NULL))
-            {
-                int allFramesReady                             = 1;
-                pAlgoTaskData->frameReady[pMsg->payload.devId] = 1;
-                for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
-                {
-                    if ((pDev->data.frames[frame_index].is_supported) &&
-                        (pAlgoTaskData->frameReady[valgo_dev_id * kVAlgoFrameID_Count + frame_index] == 0))
-                    {
-                        allFramesReady = 0;
-                    }
-                }
-                if (allFramesReady == 0)
-                    break;
-
-                hal_valgo_status_t status;
-                status = pDev->ops->run(pDev, NULL);
-
-                for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
-                {
-                    if (pDev->data.frames[frame_index].is_supported)
-                    {
-                        pAlgoTaskData->frameReady[valgo_dev_id * kVAlgoFrameID_Count + frame_index] = 0;
-                    }
-                }
-
-                if (status == kStatus_HAL_ValgoSuccess)
-                {
-                    /* request new frames from the camera */
-                    for (int frame_index = 0; frame_index < kVAlgoFrameID_Count; frame_index++)
-                    {
-                        if (pDev->data.frames[frame_index].is_supported)
-                        {
-                            fwk_message_t *pVAlgoReqMsg;
-                            pVAlgoReqMsg =
-                                &pAlgoTaskData->VAlgoReqMsgs[valgo_dev_id * kVAlgoFrameID_Count + frame_index];
-                            pVAlgoReqMsg->id            = kFWKMessageID_VAlgoRequestFrame;
-                            pVAlgoReqMsg->payload.devId = valgo_dev_id * kVAlgoFrameID_Count + frame_index;
-#if FWK_SUPPORT_MULTICORE
-                            pVAlgoReqMsg->multicore.isMulticoreMessage = 1;
-                            pVAlgoReqMsg->multicore.taskId             = kFWKTaskID_Camera;
-#endif /* FWK_SUPPORT_MULTICORE */
-                            FWK_Message_Put(kFWKTaskID_Camera, &pVAlgoReqMsg);
-                        }
-                    }
-                }
-            }
+            _FWK_VisionAlgoManager_FrameResponse(pAlgoTaskData, pMsg);
         }
         break;
 
         case kFWKMessageID_LpmPreEnterSleep:
         {
-            vision_algo_dev_t *pDev = pAlgoTaskData->devs[0];
-            if ((pDev != NULL) && (pDev->ops->deinit != NULL))
+            /* Release every device, the wake up from sleep is a reset */
+            for (int i = 0; i < MAXIMUM_VISION_ALGO_DEV; i++)
             {
-                LOGD("DEINIT valgo dev \"%s\"", pDev->name);
-                hal_valgo_status_t status = pDev->ops->deinit(pDev);
-                if (status != kStatus_HAL_ValgoSuccess)
+                vision_algo_dev_t *pDev = pAlgoTaskData->devs[i];
+                if ((pDev != NULL) && (pDev->ops->deinit != NULL))
                 {
-                    LOGE("DEINIT valgo dev %s failed with error: %d", pDev->name, status);
+                    LOGD("DEINIT valgo dev \"%s\"", pDev->name);
+                    hal_valgo_status_t status = pDev->ops->deinit(pDev);
+                    if (status != kStatus_HAL_ValgoSuccess)
+                    {
+                        LOGE("DEINIT valgo dev %s failed with error: %d", pDev->name, status);
+                    }
                 }
             }
+
+            FWK_LpmManager_Ack(kFWKTaskID_VisionAlgo);
         }
         break;
 
@@ -422,6 +624,10 @@ int FWK_VisionAlgoManager_Start(int taskPriority)
     s_VisionAlgoTask.task.delayMs    = 1;
     s_VisionAlgoTask.task.taskStack  = s_VisionAlgoTaskStack;
     s_VisionAlgoTask.task.taskBuffer = s_VisionAlgoTaskTCBReference;
+
+    /* the vision algo devices are released before entering sleep */
+    FWK_LpmManager_RegisterSleepAck(kFWKTaskID_VisionAlgo);
+
     FWK_Task_Start((fwk_task_t *)&s_VisionAlgoTask.task, VISION_ALGO_MANAGER_TASK_NAME, VISION_ALGO_MANAGER_TASK_STACK,
                    taskPriority);
 
@@ -434,6 +640,19 @@ int FWK_VisionAlgoManager_Deinit()
     return 0;
 }
 
+int FWK_VisionAlgoManager_GetFrameStats(int devId, vision_algo_frame_stats_t *stats)
+{
+    if ((devId < 0) || (devId >= MAXIMUM_VISION_ALGO_DEV) || (s_VisionAlgoTask.algoData.devs[devId] == NULL) ||
+        (stats == NULL))
+    {
+        return -1;
+    }
+
+    *stats = s_VisionAlgoTask.algoData.rings[devId].stats;
+
+    return 0;
+}
+
 int FWK_VisionAlgoManager_DeviceRegister(vision_algo_dev_t *dev)
 {
     int error = -1;
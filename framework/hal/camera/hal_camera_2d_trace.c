@@ -0,0 +1,391 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief camera dev 2D trace replay HAL driver implementation.
+ * Replays a camera trace file from the flash filesystem, see camera_trace_header_t. The traces are packed from raw
+ * frames with tools/camera_trace/camera_trace_pack.py.
+ */
+
+#include "board_define.h"
+#ifdef ENABLE_CAMERA_DEV_2DTrace
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <stdlib.h>
+
+#include "fsl_common.h"
+
+#include "fwk_platform.h"
+#include "fwk_log.h"
+#include "fwk_flash.h"
+#include "fwk_camera_manager.h"
+#include "hal_camera_dev.h"
+
+/* the frames are sent as fast as the pipeline takes them */
+#define CAMERA_2DTRACE_REPLAY_FAST 0
+/* the frames are sent with the timing of the recording */
+#define CAMERA_2DTRACE_REPLAY_ORIGINAL 1
+
+#ifndef CAMERA_2DTRACE_TRACE_PATH
+#define CAMERA_2DTRACE_TRACE_PATH "camera.trc"
+#endif
+
+#ifndef CAMERA_2DTRACE_REPLAY_MODE
+#define CAMERA_2DTRACE_REPLAY_MODE CAMERA_2DTRACE_REPLAY_ORIGINAL
+#endif
+
+#define CAMERA_NAME            "2d_trace"
+#define CAMERA_WIDTH           640
+#define CAMERA_HEIGHT          480
+#define CAMERA_BYTES_PER_PIXEL 2
+#define CAMERA_MAX_FRAME_SIZE  (CAMERA_WIDTH * CAMERA_HEIGHT * CAMERA_BYTES_PER_PIXEL)
+/* one frame is read ahead while the camera manager consumes the other one */
+#define TRACE_FRAME_COUNT 2
+
+#define CAMERA_2DTRACE_TASK_NAME  "CameraDev2DTrace"
+#define CAMERA_2DTRACE_TASK_STACK 512
+/* a replay statistics log every CAMERA_2DTRACE_REPORT_FRAMES frames */
+#define CAMERA_2DTRACE_REPORT_FRAMES 100
+
+typedef struct _camera_2dtrace_replay
+{
+    TaskHandle_t task;
+    /* buffers which can be filled by the read ahead task */
+    SemaphoreHandle_t freeBuffers;
+    volatile bool running;
+    /* the read ahead task exits, set by the deinit */
+    volatile bool exit;
+    /* given by the read ahead task when it exits */
+    SemaphoreHandle_t stopped;
+    /* the next frame restarts the replay clock */
+    volatile bool rebase;
+    camera_trace_header_t header;
+    uint32_t frameCount;
+    uint32_t nextFrame;
+    /* next buffer to fill and next buffer to dequeue */
+    uint32_t writeIndex;
+    uint32_t readIndex;
+    pixel_format_t formats[TRACE_FRAME_COUNT];
+    /* local time of the frame with the timestamp baseTimestampUs */
+    uint32_t baseUs;
+    uint32_t baseTimestampUs;
+    /* statistics */
+    uint32_t sentCount;
+    uint32_t loopCount;
+    uint32_t lateCount;
+    uint32_t maxReadUs;
+} camera_2dtrace_replay_t;
+
+static camera_2dtrace_replay_t s_Replay;
+
+/* written by the CPU and read by the PXP, kept out of the data cache */
+AT_NONCACHEABLE_SECTION_ALIGN(static unsigned char s_Frames[TRACE_FRAME_COUNT][CAMERA_MAX_FRAME_SIZE], 64);
+
+static hal_camera_status_t _HAL_CameraDev_2DTrace_ReadFrame(uint32_t frame, camera_trace_record_t *record, void *data)
+{
+    uint32_t offset = s_Replay.header.headerSize + frame * (sizeof(camera_trace_record_t) + s_Replay.header.frameSize);
+    uint32_t size   = sizeof(camera_trace_record_t);
+
+    if (FWK_Flash_Read(CAMERA_2DTRACE_TRACE_PATH, record, offset, &size) != kStatus_HAL_FlashSuccess)
+    {
+        return kStatus_HAL_CameraError;
+    }
+
+    size = s_Replay.header.frameSize;
+    if (FWK_Flash_Read(CAMERA_2DTRACE_TRACE_PATH, data, offset + sizeof(camera_trace_record_t), &size) !=
+        kStatus_HAL_FlashSuccess)
+    {
+        return kStatus_HAL_CameraError;
+    }
+
+    return kStatus_HAL_CameraSuccess;
+}
+
+#if CAMERA_2DTRACE_REPLAY_MODE == CAMERA_2DTRACE_REPLAY_ORIGINAL
+/* Wait for the presentation time of a frame, returns false if it is already late */
+static bool _HAL_CameraDev_2DTrace_WaitTimestamp(uint32_t timestampUs)
+{
+    uint32_t nowUs = FWK_CurrentTimeUs();
+    int32_t waitUs;
+
+    if (s_Replay.rebase || (s_Replay.nextFrame == 0))
+    {
+        s_Replay.rebase          = false;
+        s_Replay.baseUs          = nowUs;
+        s_Replay.baseTimestampUs = timestampUs;
+        return true;
+    }
+
+    waitUs = (int32_t)((s_Replay.baseUs + (timestampUs - s_Replay.baseTimestampUs)) - nowUs);
+    if (waitUs < 0)
+    {
+        return false;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(waitUs / 1000));
+    return true;
+}
+#endif /* CAMERA_2DTRACE_REPLAY_MODE == CAMERA_2DTRACE_REPLAY_ORIGINAL */
+
+static void _HAL_CameraDev_2DTrace_ReadAheadTask(void *param)
+{
+    camera_dev_t *dev = (camera_dev_t *)param;
+    camera_trace_record_t record;
+    camera_event_t event;
+    uint32_t startUs;
+    uint32_t readUs;
+
+    event.eventId   = kCameraEvent_SendFrame;
+    event.eventInfo = kEventInfo_Local;
+
+    while (!s_Replay.exit)
+    {
+        xSemaphoreTake(s_Replay.freeBuffers, portMAX_DELAY);
+        while (!s_Replay.running && !s_Replay.exit)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+
+        if (s_Replay.exit)
+        {
+            break;
+        }
+
+        startUs = FWK_CurrentTimeUs();
+        if (_HAL_CameraDev_2DTrace_ReadFrame(s_Replay.nextFrame, &record, s_Frames[s_Replay.writeIndex]) !=
+            kStatus_HAL_CameraSuccess)
+        {
+            LOGE("Failed to read frame %d of \"%s\"", s_Replay.nextFrame, CAMERA_2DTRACE_TRACE_PATH);
+            s_Replay.running = false;
+            xSemaphoreGive(s_Replay.freeBuffers);
+            continue;
+        }
+
+        readUs = FWK_CurrentTimeUs() - startUs;
+        if (readUs > s_Replay.maxReadUs)
+        {
+            s_Replay.maxReadUs = readUs;
+        }
+
+#if CAMERA_2DTRACE_REPLAY_MODE == CAMERA_2DTRACE_REPLAY_ORIGINAL
+        if (!_HAL_CameraDev_2DTrace_WaitTimestamp(record.timestampUs))
+        {
+            s_Replay.lateCount++;
+        }
+#endif /* CAMERA_2DTRACE_REPLAY_MODE == CAMERA_2DTRACE_REPLAY_ORIGINAL */
+
+        if (!s_Replay.running)
+        {
+            /* stopped while reading, the frame is sent again after the restart */
+            xSemaphoreGive(s_Replay.freeBuffers);
+            continue;
+        }
+
+        s_Replay.formats[s_Replay.writeIndex] = (pixel_format_t)record.format;
+        s_Replay.writeIndex                   = (s_Replay.writeIndex + 1) % TRACE_FRAME_COUNT;
+        if (++s_Replay.nextFrame == s_Replay.frameCount)
+        {
+            s_Replay.nextFrame = 0;
+            s_Replay.loopCount++;
+        }
+
+        if (++s_Replay.sentCount % CAMERA_2DTRACE_REPORT_FRAMES == 0)
+        {
+            LOGI("2D trace: %d frames, %d loops, %d late, max read %dus", s_Replay.sentCount, s_Replay.loopCount,
+                 s_Replay.lateCount, s_Replay.maxReadUs);
+        }
+
+        if (dev->cap.callback != NULL)
+        {
+            dev->cap.callback(dev, event, dev->cap.param, 0);
+        }
+    }
+
+    xSemaphoreGive(s_Replay.stopped);
+    vTaskDelete(NULL);
+}
+
+static hal_camera_status_t HAL_CameraDev_2DTrace_Init(
+    camera_dev_t *dev, int width, int height, camera_dev_callback_t callback, void *param)
+{
+    uint32_t size = sizeof(camera_trace_header_t);
+    uint32_t fileSize;
+
+    dev->cap.callback = callback;
+    dev->cap.param    = param;
+
+    if ((FWK_Flash_Read(CAMERA_2DTRACE_TRACE_PATH, &s_Replay.header, 0, &size) != kStatus_HAL_FlashSuccess) ||
+        (FWK_Flash_Read(CAMERA_2DTRACE_TRACE_PATH, NULL, 0, &fileSize) != kStatus_HAL_FlashSuccess))
+    {
+        LOGE("Camera trace \"%s\" not found", CAMERA_2DTRACE_TRACE_PATH);
+        return kStatus_HAL_CameraError;
+    }
+
+    if ((s_Replay.header.magic != CAMERA_TRACE_MAGIC) || (s_Replay.header.version != CAMERA_TRACE_VERSION) ||
+        (s_Replay.header.frameSize > CAMERA_MAX_FRAME_SIZE) || (fileSize < s_Replay.header.headerSize) ||
+        (s_Replay.header.rotate > kCWRotateDegree_270) || (s_Replay.header.flip > kFlipMode_Both))
+    {
+        LOGE("Invalid camera trace \"%s\"", CAMERA_2DTRACE_TRACE_PATH);
+        return kStatus_HAL_CameraError;
+    }
+
+    s_Replay.frameCount =
+        (fileSize - s_Replay.header.headerSize) / (sizeof(camera_trace_record_t) + s_Replay.header.frameSize);
+    if (s_Replay.frameCount == 0)
+    {
+        LOGE("Empty camera trace \"%s\"", CAMERA_2DTRACE_TRACE_PATH);
+        return kStatus_HAL_CameraError;
+    }
+
+    /* the frames are given as recorded, with the orientation of the camera they come from */
+    dev->config.width    = s_Replay.header.width;
+    dev->config.height   = s_Replay.header.height;
+    dev->config.pitch    = s_Replay.header.pitch;
+    dev->config.right    = s_Replay.header.width - 1;
+    dev->config.bottom   = s_Replay.header.height - 1;
+    dev->config.rotate   = (cw_rotate_degree_t)s_Replay.header.rotate;
+    dev->config.flip     = (flip_mode_t)s_Replay.header.flip;
+    dev->config.swapByte = s_Replay.header.swapByte;
+
+    if (s_Replay.freeBuffers == NULL)
+    {
+        s_Replay.freeBuffers = xSemaphoreCreateCounting(TRACE_FRAME_COUNT, TRACE_FRAME_COUNT);
+        s_Replay.stopped     = xSemaphoreCreateBinary();
+        if ((s_Replay.freeBuffers == NULL) || (s_Replay.stopped == NULL))
+        {
+            LOGE("Failed to create the camera 2D trace semaphore");
+            return kStatus_HAL_CameraError;
+        }
+    }
+    else
+    {
+        /* restart from empty buffers after a deinit */
+        xQueueReset((QueueHandle_t)s_Replay.freeBuffers);
+        for (int i = 0; i < TRACE_FRAME_COUNT; i++)
+        {
+            xSemaphoreGive(s_Replay.freeBuffers);
+        }
+    }
+
+    s_Replay.nextFrame  = 0;
+    s_Replay.writeIndex = 0;
+    s_Replay.readIndex  = 0;
+
+    LOGI("Camera trace \"%s\": %dx%d, %d frames", CAMERA_2DTRACE_TRACE_PATH, s_Replay.header.width,
+         s_Replay.header.height, s_Replay.frameCount);
+
+    return kStatus_HAL_CameraSuccess;
+}
+
+static hal_camera_status_t HAL_CameraDev_2DTrace_Deinit(camera_dev_t *dev)
+{
+    s_Replay.running = false;
+
+    if (s_Replay.task != NULL)
+    {
+        /* wake the read ahead task wherever it is blocked, it exits once its flash read is over */
+        s_Replay.exit = true;
+        xSemaphoreGive(s_Replay.freeBuffers);
+        xTaskNotifyGive(s_Replay.task);
+        xSemaphoreTake(s_Replay.stopped, portMAX_DELAY);
+        s_Replay.task = NULL;
+    }
+
+    return kStatus_HAL_CameraSuccess;
+}
+
+static hal_camera_status_t HAL_CameraDev_2DTrace_Start(const camera_dev_t *dev)
+{
+    hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
+    LOGI("++HAL_CameraDev_2DTrace_Start");
+
+    s_Replay.rebase  = true;
+    s_Replay.running = true;
+    s_Replay.exit    = false;
+
+    if (s_Replay.task == NULL)
+    {
+        /* inherit calling task priority */
+        if (xTaskCreate(_HAL_CameraDev_2DTrace_ReadAheadTask, CAMERA_2DTRACE_TASK_NAME, CAMERA_2DTRACE_TASK_STACK,
+                        (void *)dev, uxTaskPriorityGet(NULL), &s_Replay.task) != pdPASS)
+        {
+            LOGE("Failed to create the camera 2D trace task");
+            s_Replay.running = false;
+            ret              = kStatus_HAL_CameraError;
+        }
+    }
+    else
+    {
+        xTaskNotifyGive(s_Replay.task);
+    }
+
+    LOGI("--HAL_CameraDev_2DTrace_Start");
+    return ret;
+}
+
+static hal_camera_status_t HAL_CameraDev_2DTrace_Enqueue(const camera_dev_t *dev, void *data)
+{
+    /* the dequeued buffer can be filled again */
+    xSemaphoreGive(s_Replay.freeBuffers);
+
+    return kStatus_HAL_CameraSuccess;
+}
+
+static hal_camera_status_t HAL_CameraDev_2DTrace_Dequeue(const camera_dev_t *dev, void **data, pixel_format_t *format)
+{
+    *data              = (void *)s_Frames[s_Replay.readIndex];
+    *format            = s_Replay.formats[s_Replay.readIndex];
+    s_Replay.readIndex = (s_Replay.readIndex + 1) % TRACE_FRAME_COUNT;
+
+    return kStatus_HAL_CameraSuccess;
+}
+
+const static camera_dev_operator_t s_CameraDev_2DTraceOps = {
+    .init        = HAL_CameraDev_2DTrace_Init,
+    .deinit      = HAL_CameraDev_2DTrace_Deinit,
+    .start       = HAL_CameraDev_2DTrace_Start,
+    .enqueue     = HAL_CameraDev_2DTrace_Enqueue,
+    .dequeue     = HAL_CameraDev_2DTrace_Dequeue,
+    .inputNotify = NULL,
+};
+
+static camera_dev_t s_CameraDev_2DTrace = {
+    .id   = 0,
+    .name = CAMERA_NAME,
+    .ops  = &s_CameraDev_2DTraceOps,
+    .config =
+        {
+            .height   = CAMERA_HEIGHT,
+            .width    = CAMERA_WIDTH,
+            .pitch    = CAMERA_WIDTH * CAMERA_BYTES_PER_PIXEL,
+            .left     = 0,
+            .top      = 0,
+            .right    = CAMERA_WIDTH - 1,
+            .bottom   = CAMERA_HEIGHT - 1,
+            .rotate   = kCWRotateDegree_0,
+            .flip     = kFlipMode_None,
+            .swapByte = 0,
+        },
+    .cap =
+        {
+
+            .callback = NULL,
+            .param    = NULL,
+        },
+};
+
+int HAL_CameraDev_2DTrace_Register()
+{
+    int error = 0;
+    LOGD("HAL_CameraDev_2DTrace_Register");
+    error = FWK_CameraManager_DeviceRegister(&s_CameraDev_2DTrace);
+    return error;
+}
+#endif /* ENABLE_CAMERA_DEV_2DTrace */
@@ -31,6 +31,7 @@
 #include "fwk_log.h"
 #include "fwk_camera_manager.h"
 #include "hal_camera_dev.h"
+#include "hal_camera_receiver.h"
 
 #define CAMERA_NAME "CSI_GC0308"
 #define CAMERA_RGB_CONTROL_FLAGS (kCAMERA_HrefActiveHigh | kCAMERA_DataLatchOnRisingEdge)
@@ -66,6 +67,8 @@ static camera_receiver_handle_t s_CameraReceiver = {
     .privateData = &s_CsiPrivateData,
 };
 
+static camera_receiver_sync_t s_CameraReceiverSync;
+
 static gc0308_resource_t gc0308Resource = {
     .i2cSendFunc       = BOARD_CSICameraI2CSend,
     .i2cReceiveFunc    = BOARD_CSICameraI2CReceive,
@@ -104,6 +107,8 @@ static void HAL_CameraDev_CsiGc0308_ReceiverCallback(camera_receiver_handle_t *h
 {
     camera_dev_t *dev = (camera_dev_t *)userData;
 
+    HAL_CameraReceiver_SyncFrameDone(&s_CameraReceiverSync);
+
     if (dev->cap.callback != NULL)
     {
         uint8_t fromISR = __get_IPSR();
@@ -145,6 +150,7 @@ hal_camera_status_t HAL_CameraDev_CsiGc0308_Init(
     _HAL_CameraDev_InitInterface();
 
     NVIC_SetPriority(CSI_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY - 1);
+    HAL_CameraReceiver_SyncInit(&s_CameraReceiverSync, dev->name, CAMERA_DEV_CsiGc0308_BUFFER_COUNT);
     CAMERA_RECEIVER_Init(&s_CameraReceiver, &cameraConfig, HAL_CameraDev_CsiGc0308_ReceiverCallback, dev);
 
     // init camera dev
@@ -178,6 +184,7 @@ hal_camera_status_t HAL_CameraDev_CsiGc0308_Start(const camera_dev_t *dev)
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGD("++HAL_CameraDev_CsiGc0308_Start");
     CAMERA_DEVICE_Start(&cameraDevice);
+    HAL_CameraReceiver_SyncStart(&s_CameraReceiverSync);
     CAMERA_RECEIVER_Start(&s_CameraReceiver);
     LOGD("--HAL_CameraDev_CsiGc0308_Start");
     return ret;
@@ -203,8 +210,13 @@ hal_camera_status_t HAL_CameraDev_CsiGc0308_Dequeue(const camera_dev_t *dev, voi
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGI("++HAL_CameraDev_CsiGc0308_Dequeue");
 
-    while (kStatus_Success != CAMERA_RECEIVER_GetFullBuffer(&s_CameraReceiver, (uint32_t *)&s_pCurrentFrameBuffer))
+    if (kStatus_Success !=
+        HAL_CameraReceiver_GetFullBuffer(&s_CameraReceiverSync, &s_CameraReceiver, (uint32_t *)&s_pCurrentFrameBuffer))
     {
+        /* no frame in time, the camera manager skips this dequeue */
+        *data = NULL;
+        LOGI("--HAL_CameraDev_CsiGc0308_Dequeue");
+        return kStatus_HAL_CameraError;
     }
 
     *data   = s_pCurrentFrameBuffer;
@@ -31,10 +31,26 @@
 #include "fwk_log.h"
 #include "fwk_camera_manager.h"
 #include "hal_camera_dev.h"
+#include "hal_camera_receiver.h"
 
 #define CAMERA_NAME             "CSI_MT9M114"
 #define CAMERA_RGB_CONTROL_FLAGS (kCAMERA_HrefActiveHigh | kCAMERA_DataLatchOnRisingEdge)
 
+/* Each exposure step of the sensor driver multiplies the exposure time by 1.1 or by 0.9, up to 3000 */
+#define CAMERA_DEV_EXPOSURE_STEP_UP_EV   0.1375f
+#define CAMERA_DEV_EXPOSURE_STEP_DOWN_EV 0.152f
+#define CAMERA_DEV_EXPOSURE_STEPS_UP     16
+#define CAMERA_DEV_EXPOSURE_STEPS_DOWN   24
+
+/* LED lighting the scene, kCameraDevLight_White when the ir_white_leds output device is enabled */
+#ifndef CAMERA_DEV_CsiMt9m114_LIGHT
+#define CAMERA_DEV_CsiMt9m114_LIGHT kCameraDevLight_None
+#endif /* CAMERA_DEV_CsiMt9m114_LIGHT */
+
+/* Brightness range of the white LED, in %, same as the ir_white_leds output device */
+#define CAMERA_DEV_LIGHT_MIN 0
+#define CAMERA_DEV_LIGHT_MAX 30
+
 //AT_NONCACHEABLE_SECTION_ALIGN(
 SDK_ALIGN(
     static uint8_t s_FrameBuffers[CAMERA_DEV_CsiMt9m114_BUFFER_COUNT][CAMERA_DEV_CsiMt9m114_HEIGHT]
@@ -68,6 +84,8 @@ static camera_receiver_handle_t s_CameraReceiver = {
     .privateData = &s_CsiPrivateData,
 };
 
+static camera_receiver_sync_t s_CameraReceiverSync;
+
 static mt9m114_resource_t s_Mt9m114Resource = {
     .i2cSendFunc       = BOARD_CSICameraI2CSend,
     .i2cReceiveFunc    = BOARD_CSICameraI2CReceive,
@@ -107,6 +125,8 @@ static void HAL_CameraDev_CsiMt9m114_ReceiverCallback(camera_receiver_handle_t *
 {
     camera_dev_t *dev = (camera_dev_t *)userData;
 
+    HAL_CameraReceiver_SyncFrameDone(&s_CameraReceiverSync);
+
     if (dev->cap.callback != NULL)
     {
         uint8_t fromISR = __get_IPSR();
@@ -148,6 +168,7 @@ static hal_camera_status_t HAL_CameraDev_CsiMt9m114_Init(
     _HAL_CameraDev_InitInterface();
 
     NVIC_SetPriority(CSI_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY - 1);
+    HAL_CameraReceiver_SyncInit(&s_CameraReceiverSync, dev->name, CAMERA_DEV_CsiMt9m114_BUFFER_COUNT);
     CAMERA_RECEIVER_Init(&s_CameraReceiver, &cameraConfig, HAL_CameraDev_CsiMt9m114_ReceiverCallback, dev);
 
     // init camera dev
@@ -173,6 +194,7 @@ static hal_camera_status_t HAL_CameraDev_CsiMt9m114_Start(const camera_dev_t *de
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGD("++HAL_CameraDev_CsiMt9m114_Start");
     CAMERA_DEVICE_Start(&cameraDevice);
+    HAL_CameraReceiver_SyncStart(&s_CameraReceiverSync);
     CAMERA_RECEIVER_Start(&s_CameraReceiver);
     LOGD("--HAL_CameraDev_CsiMt9m114_Start");
     return ret;
@@ -200,8 +222,13 @@ static hal_camera_status_t HAL_CameraDev_CsiMt9m114_Dequeue(const camera_dev_t *
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGI("++HAL_CameraDev_CsiMt9m114_Dequeue");
 
-    while (kStatus_Success != CAMERA_RECEIVER_GetFullBuffer(&s_CameraReceiver, (uint32_t *)&s_pCurrentFrameBuffer))
+    if (kStatus_Success !=
+        HAL_CameraReceiver_GetFullBuffer(&s_CameraReceiverSync, &s_CameraReceiver, (uint32_t *)&s_pCurrentFrameBuffer))
     {
+        /* no frame in time, the camera manager skips this dequeue */
+        *data = NULL;
+        LOGI("--HAL_CameraDev_CsiMt9m114_Dequeue");
+        return kStatus_HAL_CameraError;
     }
 
     *data   = s_pCurrentFrameBuffer;
@@ -211,12 +238,33 @@ static hal_camera_status_t HAL_CameraDev_CsiMt9m114_Dequeue(const camera_dev_t *
     return ret;
 }
 
-const static camera_dev_operator_t s_CameraDev_CsiMt9m114Ops = {.init        = HAL_CameraDev_CsiMt9m114_Init,
-                                                                .deinit      = HAL_CameraDev_CsiMt9m114_Deinit,
-                                                                .start       = HAL_CameraDev_CsiMt9m114_Start,
-                                                                .enqueue     = HAL_CameraDev_CsiMt9m114_Enqueue,
-                                                                .dequeue     = HAL_CameraDev_CsiMt9m114_Dequeue,
-                                                                .inputNotify = HAL_CameraDev_CsiMt9m114_InputNotify};
+static hal_camera_status_t HAL_CameraDev_CsiMt9m114_AdjustExposure(const camera_dev_t *dev, int steps)
+{
+    hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
+    int32_t direction       = (steps > 0) ? CAMERA_BRIGHTNESS_INCREASE : CAMERA_BRIGHTNESS_DECREASE;
+
+    /* the first step switches the sensor to the manual exposure */
+    for (int i = 0; i < abs(steps); i++)
+    {
+        if (kStatus_Success != CAMERA_DEVICE_Control(&cameraDevice, kCAMERA_DeviceBrightnessAdjust, direction))
+        {
+            ret = kStatus_HAL_CameraError;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+const static camera_dev_operator_t s_CameraDev_CsiMt9m114Ops = {
+    .init           = HAL_CameraDev_CsiMt9m114_Init,
+    .deinit         = HAL_CameraDev_CsiMt9m114_Deinit,
+    .start          = HAL_CameraDev_CsiMt9m114_Start,
+    .enqueue        = HAL_CameraDev_CsiMt9m114_Enqueue,
+    .dequeue        = HAL_CameraDev_CsiMt9m114_Dequeue,
+    .inputNotify    = HAL_CameraDev_CsiMt9m114_InputNotify,
+    .adjustExposure = HAL_CameraDev_CsiMt9m114_AdjustExposure,
+};
 
 static camera_dev_t s_CameraDevCsi_Mt9m114 = {
     .id   = 1,
@@ -234,6 +282,16 @@ static camera_dev_t s_CameraDevCsi_Mt9m114 = {
             .rotate   = CAMERA_DEV_CsiMt9m114_ROTATE,
             .flip     = CAMERA_DEV_CsiMt9m114_FLIP,
             .swapByte = CAMERA_DEV_CsiMt9m114_SWAPBYTE,
+            .exposure =
+                {
+                    .stepUpEv   = CAMERA_DEV_EXPOSURE_STEP_UP_EV,
+                    .stepDownEv = CAMERA_DEV_EXPOSURE_STEP_DOWN_EV,
+                    .stepsUp    = CAMERA_DEV_EXPOSURE_STEPS_UP,
+                    .stepsDown  = CAMERA_DEV_EXPOSURE_STEPS_DOWN,
+                    .light      = CAMERA_DEV_CsiMt9m114_LIGHT,
+                    .lightMin   = CAMERA_DEV_LIGHT_MIN,
+                    .lightMax   = CAMERA_DEV_LIGHT_MAX,
+                },
         },
     .cap = {.callback = NULL, .param    = NULL, },
 };
@@ -34,6 +34,7 @@
 #include "fwk_camera_manager.h"
 #include "fwk_log.h"
 #include "hal_camera_dev.h"
+#include "hal_camera_receiver.h"
 #include "hal_event_descriptor_common.h"
 
 /*******************************************************************************
@@ -100,6 +101,8 @@ static camera_receiver_handle_t s_CameraReceiver = {
     .privateData = &s_CSIPrivateData,
 };
 
+static camera_receiver_sync_t s_CameraReceiverSync;
+
 static obU1S_resource_t s_ObU1SResource = {
     .i2cSendFunc        = BOARD_3DCameraI2CSend,
     .i2cReceiveFunc     = BOARD_3DCameraI2CReceive,
@@ -129,6 +132,8 @@ static void _CameraReceiverCallback(camera_receiver_handle_t *handle, status_t s
 {
     camera_dev_t *dev = (camera_dev_t *)userData;
 
+    HAL_CameraReceiver_SyncFrameDone(&s_CameraReceiverSync);
+
     if (dev->cap.callback != NULL)
     {
         uint8_t fromISR = __get_IPSR();
@@ -194,6 +199,7 @@ static hal_camera_status_t _HAL_CameraDev_CsiOrbbecU1s_Init(camera_dev_t *dev)
     cameraConfig.framePerSec                = 30;
 
     NVIC_SetPriority(CSI_IRQn, configMAX_SYSCALL_INTERRUPT_PRIORITY - 1);
+    HAL_CameraReceiver_SyncInit(&s_CameraReceiverSync, dev->name, CAMERA_DEV_BUFFER_COUNT);
     error = CAMERA_RECEIVER_Init(&s_CameraReceiver, &cameraConfig, _CameraReceiverCallback, dev);
     if (error)
     {
@@ -279,6 +285,7 @@ static hal_camera_status_t HAL_CameraDev_CsiOrbbecU1s_Start(const camera_dev_t *
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGD("HAL_CameraDev_CsiOrbbecU1s_Start");
     CAMERA_DEVICE_Start(&s_ObU1SCameraDevice);
+    HAL_CameraReceiver_SyncStart(&s_CameraReceiverSync);
     CAMERA_RECEIVER_Start(&s_CameraReceiver);
 
     return ret;
@@ -403,8 +410,13 @@ hal_camera_status_t HAL_CameraDev_CsiOrbbecU1s_Dequeue(const camera_dev_t *dev,
 
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
 
-    while (kStatus_Success != CAMERA_RECEIVER_GetFullBuffer(&s_CameraReceiver, &s_pCurrentFrameBuffer))
+    if (kStatus_Success !=
+        HAL_CameraReceiver_GetFullBuffer(&s_CameraReceiverSync, &s_CameraReceiver, &s_pCurrentFrameBuffer))
     {
+        /* no frame in time, the camera manager skips this dequeue */
+        *data = NULL;
+        LOGI("--HAL_CameraDev_CsiOrbbecU1s_Dequeue");
+        return kStatus_HAL_CameraError;
     }
 
     *data = (void *)s_pCurrentFrameBuffer;
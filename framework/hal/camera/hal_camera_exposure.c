@@ -0,0 +1,415 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief camera auto exposure helper implementation.
+ * The error is log2(target / mean), so one unit is one EV whatever the scene. The proportional gain is 1 far from the
+ * target, the first correction then lands close to it, and lower near the target to avoid overshooting with the coarse
+ * steps of the sensors. The integral catches the errors smaller than half a step. Brightening moves the sensor first
+ * and the LED once the sensor is at its maximum, darkening dims the LED first.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "hal_camera_exposure.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Proportional gain near the target and integral gain */
+#define CAMERA_EXPOSURE_KP 0.6f
+#define CAMERA_EXPOSURE_KI 0.25f
+
+/* Error above which the whole error is corrected at once, in EV */
+#define CAMERA_EXPOSURE_JUMP_EV 1.0f
+
+/* Bound of the integral, in EV */
+#define CAMERA_EXPOSURE_INTEGRAL_MAX 1.0f
+
+/* Samples at 255 above which the mean underestimates the error, in % */
+#define CAMERA_EXPOSURE_CLIPPED_MAX 25
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static inline int _HAL_CameraExposure_Clamp(int value, int min, int max)
+{
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+static bool _HAL_CameraExposure_CanBrighten(const camera_exposure_ctrl_t *ctrl)
+{
+    const camera_dev_exposure_t *actuators = &ctrl->actuators;
+
+    return ((actuators->stepUpEv > 0) && (ctrl->exposureSteps < actuators->stepsUp)) ||
+           ((actuators->light != kCameraDevLight_None) && (ctrl->light < actuators->lightMax));
+}
+
+static bool _HAL_CameraExposure_CanDarken(const camera_exposure_ctrl_t *ctrl)
+{
+    const camera_dev_exposure_t *actuators = &ctrl->actuators;
+
+    return ((actuators->stepDownEv > 0) && (ctrl->exposureSteps > -actuators->stepsDown)) ||
+           ((actuators->light != kCameraDevLight_None) && (ctrl->light > actuators->lightMin));
+}
+
+/* smallest brightness change of the LED worth sending, in % */
+static int _HAL_CameraExposure_LightStep(const camera_exposure_ctrl_t *ctrl)
+{
+    int step = (ctrl->actuators.lightMax - ctrl->actuators.lightMin) / 10;
+
+    return (step > 0) ? step : 1;
+}
+
+/* split a change of demand EV between the sensor and the LED */
+static void _HAL_CameraExposure_Allocate(camera_exposure_ctrl_t *ctrl, float demand, camera_exposure_action_t *action)
+{
+    const camera_dev_exposure_t *actuators = &ctrl->actuators;
+    bool hasLight                          = (actuators->light != kCameraDevLight_None);
+    int light                              = ctrl->light;
+
+    if (demand > 0)
+    {
+        if ((actuators->stepUpEv > 0) && (ctrl->exposureSteps < actuators->stepsUp))
+        {
+            int steps = (int)(demand / actuators->stepUpEv + 0.5f);
+
+            steps = _HAL_CameraExposure_Clamp(steps, 0, actuators->stepsUp - ctrl->exposureSteps);
+            demand -= steps * actuators->stepUpEv;
+            action->steps = steps;
+        }
+
+        /* the LED only takes over from a sensor at its maximum */
+        if (hasLight && (light < actuators->lightMax) && (ctrl->exposureSteps + action->steps >= actuators->stepsUp) &&
+            (demand > 0))
+        {
+            int base = (light > 0) ? light : _HAL_CameraExposure_LightStep(ctrl);
+
+            light = (int)(base * exp2f(demand) + 0.5f);
+            if (light < ctrl->light + _HAL_CameraExposure_LightStep(ctrl))
+            {
+                light = ctrl->light + _HAL_CameraExposure_LightStep(ctrl);
+            }
+            action->light = _HAL_CameraExposure_Clamp(light, actuators->lightMin, actuators->lightMax);
+        }
+    }
+    else if (demand < 0)
+    {
+        if (hasLight && (light > actuators->lightMin))
+        {
+            light = (int)(light * exp2f(demand) + 0.5f);
+            if (light > ctrl->light - _HAL_CameraExposure_LightStep(ctrl))
+            {
+                light = ctrl->light - _HAL_CameraExposure_LightStep(ctrl);
+            }
+            light = _HAL_CameraExposure_Clamp(light, actuators->lightMin, actuators->lightMax);
+
+            /* the part of the demand left to the sensor */
+            demand = (light > 0) ? (demand - log2f((float)light / ctrl->light)) : 0;
+            if (demand > 0)
+            {
+                demand = 0;
+            }
+            action->light = light;
+        }
+
+        if ((actuators->stepDownEv > 0) && (ctrl->exposureSteps > -actuators->stepsDown))
+        {
+            int steps = (int)(demand / actuators->stepDownEv - 0.5f);
+
+            action->steps = _HAL_CameraExposure_Clamp(steps, -actuators->stepsDown - ctrl->exposureSteps, 0);
+        }
+    }
+
+    if (action->light == ctrl->light)
+    {
+        action->light = -1;
+    }
+}
+
+/* the target is reached, or as close as the actuators allow */
+static void _HAL_CameraExposure_Converged(camera_exposure_ctrl_t *ctrl)
+{
+    if (ctrl->converging != 0)
+    {
+        ctrl->stats.lastConvergeFrames = ctrl->converging;
+        if (ctrl->converging > ctrl->stats.maxConvergeFrames)
+        {
+            ctrl->stats.maxConvergeFrames = ctrl->converging;
+        }
+    }
+
+    ctrl->converging = 0;
+    ctrl->heldBack   = 0;
+    ctrl->integral   = 0;
+    ctrl->settle     = 0;
+    ctrl->stats.usable++;
+}
+
+void HAL_CameraExposure_Init(camera_exposure_ctrl_t *ctrl, const camera_dev_exposure_t *actuators)
+{
+    if ((ctrl == NULL) || (actuators == NULL))
+    {
+        return;
+    }
+
+    memset(ctrl, 0, sizeof(camera_exposure_ctrl_t));
+    ctrl->actuators   = *actuators;
+    ctrl->light       = (actuators->light != kCameraDevLight_None) ? actuators->lightMin : 0;
+    ctrl->stats.light = ctrl->light;
+}
+
+bool HAL_CameraExposure_HasActuators(const camera_exposure_ctrl_t *ctrl)
+{
+    if (ctrl == NULL)
+    {
+        return false;
+    }
+
+    return (ctrl->actuators.stepUpEv > 0) || (ctrl->actuators.stepDownEv > 0) ||
+           (ctrl->actuators.light != kCameraDevLight_None);
+}
+
+void HAL_CameraExposure_SetRoi(camera_exposure_ctrl_t *ctrl, int left, int top, int right, int bottom)
+{
+    if (ctrl == NULL)
+    {
+        return;
+    }
+
+    ctrl->roiLeft   = left;
+    ctrl->roiTop    = top;
+    ctrl->roiRight  = right;
+    ctrl->roiBottom = bottom;
+}
+
+int HAL_CameraExposure_Measure(const camera_exposure_ctrl_t *ctrl,
+                               const void *frame,
+                               pixel_format_t format,
+                               const camera_dev_static_config_t *config,
+                               camera_exposure_measure_t *measure)
+{
+    const uint8_t *buf = (const uint8_t *)frame;
+    uint32_t bpp;
+    uint32_t offset = 0;
+    uint32_t sum    = 0;
+    uint32_t dark   = 0;
+    uint32_t bright = 0;
+    int left, top, right, bottom;
+
+    if ((ctrl == NULL) || (frame == NULL) || (config == NULL) || (measure == NULL))
+    {
+        return -1;
+    }
+
+    switch (format)
+    {
+        case kPixelFormat_YUV1P444_RGB:
+        case kPixelFormat_YUV1P444_Gray:
+            /* XYUV8888 */
+            bpp    = 4;
+            offset = 2;
+            break;
+        case kPixelFormat_UYVY1P422_RGB:
+        case kPixelFormat_UYVY1P422_Gray:
+        case kPixelFormat_VYUY1P422:
+            bpp    = 2;
+            offset = config->swapByte ? 0 : 1;
+            break;
+        case kPixelFormat_Gray16:
+            /* most significant byte */
+            bpp    = 2;
+            offset = config->swapByte ? 0 : 1;
+            break;
+        case kPixelFormat_Gray:
+            bpp = 1;
+            break;
+        case kPixelFormat_Gray888:
+        case kPixelFormat_RGB:
+        case kPixelFormat_BGR:
+            bpp = 3;
+            break;
+        case kPixelFormat_Gray888X:
+            bpp = 4;
+            break;
+        case kPixelFormat_RGB565:
+            bpp = 2;
+            break;
+        default:
+            return -1;
+    }
+
+    left   = config->left;
+    top    = config->top;
+    right  = config->right;
+    bottom = config->bottom;
+    if (ctrl->roiRight > ctrl->roiLeft)
+    {
+        left   = (ctrl->roiLeft > left) ? ctrl->roiLeft : left;
+        top    = (ctrl->roiTop > top) ? ctrl->roiTop : top;
+        right  = (ctrl->roiRight < right) ? ctrl->roiRight : right;
+        bottom = (ctrl->roiBottom < bottom) ? ctrl->roiBottom : bottom;
+        if ((right < left) || (bottom < top))
+        {
+            /* face out of the active rect */
+            left   = config->left;
+            top    = config->top;
+            right  = config->right;
+            bottom = config->bottom;
+        }
+    }
+
+    memset(measure, 0, sizeof(camera_exposure_measure_t));
+
+    for (int y = top + CAMERA_EXPOSURE_SAMPLE_STEP / 2; y <= bottom; y += CAMERA_EXPOSURE_SAMPLE_STEP)
+    {
+        const uint8_t *line = buf + y * config->pitch;
+
+        for (int x = left + CAMERA_EXPOSURE_SAMPLE_STEP / 2; x <= right; x += CAMERA_EXPOSURE_SAMPLE_STEP)
+        {
+            const uint8_t *pixel = line + x * bpp;
+            uint32_t luma;
+
+            if (format == kPixelFormat_RGB565)
+            {
+                uint16_t rgb = config->swapByte ? ((pixel[0] << 8) | pixel[1]) : ((pixel[1] << 8) | pixel[0]);
+                uint32_t r   = (rgb >> 8) & 0xF8;
+                uint32_t g   = (rgb >> 3) & 0xFC;
+                uint32_t b   = (rgb << 3) & 0xF8;
+
+                luma = (r * 77 + g * 150 + b * 29) >> 8;
+            }
+            else if (format == kPixelFormat_RGB)
+            {
+                luma = (pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8;
+            }
+            else if (format == kPixelFormat_BGR)
+            {
+                luma = (pixel[2] * 77 + pixel[1] * 150 + pixel[0] * 29) >> 8;
+            }
+            else
+            {
+                luma = pixel[offset];
+            }
+
+            sum += luma;
+            dark += (luma == 0);
+            bright += (luma == 255);
+            measure->histogram[luma * CAMERA_EXPOSURE_HISTOGRAM_BINS / 256]++;
+            measure->samples++;
+        }
+    }
+
+    if (measure->samples != 0)
+    {
+        measure->mean    = sum / measure->samples;
+        measure->clipped = (dark + bright) * 100 / measure->samples;
+    }
+
+    return 0;
+}
+
+bool HAL_CameraExposure_Update(camera_exposure_ctrl_t *ctrl,
+                               const camera_exposure_measure_t *measure,
+                               camera_exposure_action_t *action)
+{
+    float error;
+    bool saturated;
+
+    if ((ctrl == NULL) || (measure == NULL) || (action == NULL))
+    {
+        return true;
+    }
+
+    action->steps = 0;
+    action->light = -1;
+
+    ctrl->stats.frames++;
+    ctrl->stats.lastMean = measure->mean;
+
+    error = log2f((float)CAMERA_EXPOSURE_TARGET_LUMA / ((measure->mean != 0) ? measure->mean : 1));
+    if ((measure->samples == 0) || (fabsf(error) <= CAMERA_EXPOSURE_TOLERANCE_EV))
+    {
+        _HAL_CameraExposure_Converged(ctrl);
+        return true;
+    }
+
+    saturated = (error > 0) ? !_HAL_CameraExposure_CanBrighten(ctrl) : !_HAL_CameraExposure_CanDarken(ctrl);
+    if (saturated)
+    {
+        /* nothing left to move, the frame is as good as it gets */
+        _HAL_CameraExposure_Converged(ctrl);
+        return true;
+    }
+
+    ctrl->converging++;
+
+    if (ctrl->settle != 0)
+    {
+        /* the frame may still have the previous exposure */
+        ctrl->settle--;
+    }
+    else
+    {
+        bool jump = (fabsf(error) > CAMERA_EXPOSURE_JUMP_EV) ||
+                    ((error < 0) && (measure->clipped > CAMERA_EXPOSURE_CLIPPED_MAX));
+        float demand;
+
+        ctrl->integral += CAMERA_EXPOSURE_KI * error;
+        if (ctrl->integral > CAMERA_EXPOSURE_INTEGRAL_MAX)
+        {
+            ctrl->integral = CAMERA_EXPOSURE_INTEGRAL_MAX;
+        }
+        else if (ctrl->integral < -CAMERA_EXPOSURE_INTEGRAL_MAX)
+        {
+            ctrl->integral = -CAMERA_EXPOSURE_INTEGRAL_MAX;
+        }
+
+        demand = (jump ? error : CAMERA_EXPOSURE_KP * error) + ctrl->integral;
+        _HAL_CameraExposure_Allocate(ctrl, demand, action);
+
+        if ((action->steps != 0) || (action->light >= 0))
+        {
+            ctrl->exposureSteps += action->steps;
+            if (action->light >= 0)
+            {
+                ctrl->light = action->light;
+            }
+
+            ctrl->integral = 0;
+            ctrl->settle   = CAMERA_EXPOSURE_SETTLE_FRAMES;
+            ctrl->stats.adjustments++;
+            ctrl->stats.exposureSteps = ctrl->exposureSteps;
+            ctrl->stats.light         = ctrl->light;
+        }
+    }
+
+    if (++ctrl->heldBack >= CAMERA_EXPOSURE_MAX_SKIPPED)
+    {
+        ctrl->heldBack = 0;
+        ctrl->stats.forced++;
+        return true;
+    }
+
+    ctrl->stats.skipped++;
+    return false;
+}
+
+void HAL_CameraExposure_GetStats(const camera_exposure_ctrl_t *ctrl, camera_exposure_stats_t *stats)
+{
+    if ((ctrl == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    *stats = ctrl->stats;
+}
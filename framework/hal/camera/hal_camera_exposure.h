@@ -0,0 +1,193 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief camera auto exposure helper declaration.
+ * Measures the luma of a camera frame on a sparse grid, over the whole active rect or over the face, and runs a PI
+ * controller in the EV domain which moves the exposure steps of the sensor and the brightness of the LED lighting
+ * the scene. The frames far from the target are reported as not usable, the camera manager holds them back from the
+ * vision algorithms until the loop settles. There is no OS dependency, the controller can be run against a model of
+ * the sensor on a host.
+ */
+
+#ifndef _HAL_CAMERA_EXPOSURE_H_
+#define _HAL_CAMERA_EXPOSURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_camera_dev.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Mean luma the controller drives the frames to */
+#ifndef CAMERA_EXPOSURE_TARGET_LUMA
+#define CAMERA_EXPOSURE_TARGET_LUMA 110
+#endif /* CAMERA_EXPOSURE_TARGET_LUMA */
+
+/* Distance to the target, in EV, within which a frame is usable and nothing is changed */
+#ifndef CAMERA_EXPOSURE_TOLERANCE_EV
+#define CAMERA_EXPOSURE_TOLERANCE_EV 0.3f
+#endif /* CAMERA_EXPOSURE_TOLERANCE_EV */
+
+/* Frames ignored after a change, the sensors apply a new exposure one or two frames later */
+#ifndef CAMERA_EXPOSURE_SETTLE_FRAMES
+#define CAMERA_EXPOSURE_SETTLE_FRAMES 2
+#endif /* CAMERA_EXPOSURE_SETTLE_FRAMES */
+
+/* Consecutive frames held back after which a frame is usable anyway, so the recognition never starves */
+#ifndef CAMERA_EXPOSURE_MAX_SKIPPED
+#define CAMERA_EXPOSURE_MAX_SKIPPED 8
+#endif /* CAMERA_EXPOSURE_MAX_SKIPPED */
+
+/* Distance between two luma samples, in pixels, in both directions */
+#ifndef CAMERA_EXPOSURE_SAMPLE_STEP
+#define CAMERA_EXPOSURE_SAMPLE_STEP 8
+#endif /* CAMERA_EXPOSURE_SAMPLE_STEP */
+
+/* Log the exposure statistics every CAMERA_EXPOSURE_STATS_LOG_PERIOD frames, 0 to disable */
+#ifndef CAMERA_EXPOSURE_STATS_LOG_PERIOD
+#define CAMERA_EXPOSURE_STATS_LOG_PERIOD 0
+#endif /* CAMERA_EXPOSURE_STATS_LOG_PERIOD */
+
+#define CAMERA_EXPOSURE_HISTOGRAM_BINS 16
+
+typedef struct _camera_exposure_measure
+{
+    /* mean luma of the samples */
+    uint8_t mean;
+    /* samples at 0 or 255, in % */
+    uint8_t clipped;
+    uint32_t samples;
+    uint16_t histogram[CAMERA_EXPOSURE_HISTOGRAM_BINS];
+} camera_exposure_measure_t;
+
+/* Changes to apply to the actuators after a frame */
+typedef struct _camera_exposure_action
+{
+    /* adjustExposure steps, positive to brighten the frames */
+    int steps;
+    /* new brightness of the LED in %, -1 to leave it */
+    int light;
+} camera_exposure_action_t;
+
+typedef struct _camera_exposure_stats
+{
+    /* frames measured */
+    uint32_t frames;
+    /* frames handed to the vision algorithms */
+    uint32_t usable;
+    /* frames held back while the loop settles */
+    uint32_t skipped;
+    /* frames held back too long and handed over anyway */
+    uint32_t forced;
+    /* frames after which the actuators were moved */
+    uint32_t adjustments;
+    uint8_t lastMean;
+    /* current position of the actuators */
+    int exposureSteps;
+    int light;
+    /* frames between the loss of the target and the next usable frame */
+    uint32_t lastConvergeFrames;
+    uint32_t maxConvergeFrames;
+} camera_exposure_stats_t;
+
+typedef struct _camera_exposure_ctrl
+{
+    camera_dev_exposure_t actuators;
+    /* region measured in the camera frame, empty for the active rect */
+    int roiLeft;
+    int roiTop;
+    int roiRight;
+    int roiBottom;
+    /* adjustExposure steps from the init exposure */
+    int exposureSteps;
+    int light;
+    /* integral of the error, in EV */
+    float integral;
+    /* frames left before measuring again after a change */
+    uint32_t settle;
+    /* consecutive frames held back, and frames since the target was lost */
+    uint32_t heldBack;
+    uint32_t converging;
+    camera_exposure_stats_t stats;
+} camera_exposure_ctrl_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init a controller for the actuators of a camera device
+ * @param ctrl controller to init
+ * @param actuators exposure steps and LED of the camera device
+ */
+void HAL_CameraExposure_Init(camera_exposure_ctrl_t *ctrl, const camera_dev_exposure_t *actuators);
+
+/**
+ * @brief Check if a controller has anything to move
+ * @param ctrl controller of the camera device
+ * @return true if the device has exposure steps or a LED
+ */
+bool HAL_CameraExposure_HasActuators(const camera_exposure_ctrl_t *ctrl);
+
+/**
+ * @brief Set the region measured, usually the face found by the recognition
+ * @param ctrl controller of the camera device
+ * @param left left of the region in the camera frame
+ * @param top top of the region in the camera frame
+ * @param right right of the region in the camera frame, right <= left to measure the whole active rect
+ * @param bottom bottom of the region in the camera frame
+ */
+void HAL_CameraExposure_SetRoi(camera_exposure_ctrl_t *ctrl, int left, int top, int right, int bottom);
+
+/**
+ * @brief Measure the luma of a frame on a sparse grid
+ * @param ctrl controller of the camera device, for the region to measure
+ * @param frame frame buffer
+ * @param format pixel format of the frame
+ * @param config geometry of the frame
+ * @param measure result of the measure
+ * @return 0 on success, -1 if the pixel format has no luma
+ */
+int HAL_CameraExposure_Measure(const camera_exposure_ctrl_t *ctrl,
+                               const void *frame,
+                               pixel_format_t format,
+                               const camera_dev_static_config_t *config,
+                               camera_exposure_measure_t *measure);
+
+/**
+ * @brief Run the controller on the measure of a frame
+ * @param ctrl controller of the camera device
+ * @param measure measure of the frame
+ * @param action changes to apply to the actuators before the next frame
+ * @return true if the frame is exposed well enough for the vision algorithms
+ */
+bool HAL_CameraExposure_Update(camera_exposure_ctrl_t *ctrl,
+                               const camera_exposure_measure_t *measure,
+                               camera_exposure_action_t *action);
+
+/**
+ * @brief Get the statistics of a controller
+ * @param ctrl controller of the camera device
+ * @param stats statistics
+ */
+void HAL_CameraExposure_GetStats(const camera_exposure_ctrl_t *ctrl, camera_exposure_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_CAMERA_EXPOSURE_H_ */
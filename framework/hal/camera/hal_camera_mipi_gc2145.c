@@ -33,6 +33,7 @@
 #include "fwk_log.h"
 #include "fwk_camera_manager.h"
 #include "hal_camera_dev.h"
+#include "hal_camera_receiver.h"
 
 /*******************************************************************************
  * Prototypes
@@ -61,6 +62,12 @@ void BOARD_MIPICameraPullResetPin(bool pullUp);
 #define CAMERA_DEV_CONTROL_FLAGS (kCAMERA_HrefActiveHigh | kCAMERA_DataLatchOnRisingEdge)
 #define CAMERA_MIPI_CSI_LANE     GC2145MIPI_LANE_NUM
 
+/* Each exposure step of the sensor driver multiplies the exposure time by 1.25 or by 0.75, from 0x96 up to 0xFFF */
+#define CAMERA_DEV_EXPOSURE_STEP_UP_EV   0.322f
+#define CAMERA_DEV_EXPOSURE_STEP_DOWN_EV 0.415f
+#define CAMERA_DEV_EXPOSURE_STEPS_UP     14
+#define CAMERA_DEV_EXPOSURE_STEPS_DOWN   12
+
 #define DEMO_CSI_CLK_FREQ          (CLOCK_GetFreqFromObs(CCM_OBS_BUS_CLK_ROOT))
 #define DEMO_MIPI_CSI2_UI_CLK_FREQ (CLOCK_GetFreqFromObs(CCM_OBS_CSI2_UI_CLK_ROOT))
 
@@ -86,6 +93,8 @@ static camera_receiver_handle_t s_CameraReceiver = {
     .privateData = &s_CsiPrivateData,
 };
 
+static camera_receiver_sync_t s_CameraReceiverSync;
+
 static gc2145_resource_t gc2145Resource = {
     .i2cSendFunc      = BOARD_MIPICameraI2CSend,
     .i2cReceiveFunc   = BOARD_MIPICameraI2CReceive,
@@ -105,6 +114,8 @@ static void _CameraReceiverCallback(camera_receiver_handle_t *handle, status_t s
 {
     camera_dev_t *dev = (camera_dev_t *)userData;
 
+    HAL_CameraReceiver_SyncFrameDone(&s_CameraReceiverSync);
+
     if (dev->cap.callback != NULL)
     {
         uint8_t fromISR = __get_IPSR();
@@ -320,6 +331,7 @@ static hal_camera_status_t HAL_CameraDev_MipiGc2145_Init(
     cameraConfig.framePerSec                = CAMERA_DEV_FRAME_RATE;
 
     NVIC_SetPriority(CSI_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY - 1);
+    HAL_CameraReceiver_SyncInit(&s_CameraReceiverSync, dev->name, CAMERA_DEV_MipiGc2145_BUFFER_COUNT);
     CAMERA_RECEIVER_Init(&s_CameraReceiver, &cameraConfig, _CameraReceiverCallback, dev);
 
     MipiGc2145_InitMipiCsi();
@@ -355,6 +367,7 @@ static hal_camera_status_t HAL_CameraDev_MipiGc2145_Start(const camera_dev_t *de
 {
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGD("++HAL_CameraDev_MipiGc2145_Start");
+    HAL_CameraReceiver_SyncStart(&s_CameraReceiverSync);
     CAMERA_RECEIVER_Start(&s_CameraReceiver);
     LOGD("--HAL_CameraDev_MipiGc2145_Start");
     return ret;
@@ -383,9 +396,13 @@ static hal_camera_status_t HAL_CameraDev_MipiGc2145_Dequeue(const camera_dev_t *
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGI("++HAL_CameraDev_MipiGc2145_Dequeue");
 
-    // get one frame
-    while (kStatus_Success != CAMERA_RECEIVER_GetFullBuffer(&s_CameraReceiver, (uint32_t *)&s_pCurrentFrameBuffer))
+    if (kStatus_Success !=
+        HAL_CameraReceiver_GetFullBuffer(&s_CameraReceiverSync, &s_CameraReceiver, (uint32_t *)&s_pCurrentFrameBuffer))
     {
+        /* no frame in time, the camera manager skips this dequeue */
+        *data = NULL;
+        LOGI("--HAL_CameraDev_MipiGc2145_Dequeue");
+        return kStatus_HAL_CameraError;
     }
 
     *data   = s_pCurrentFrameBuffer;
@@ -394,13 +411,32 @@ static hal_camera_status_t HAL_CameraDev_MipiGc2145_Dequeue(const camera_dev_t *
     return ret;
 }
 
+static hal_camera_status_t HAL_CameraDev_MipiGc2145_AdjustExposure(const camera_dev_t *dev, int steps)
+{
+    hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
+    int32_t direction       = (steps > 0) ? CAMERA_BRIGHTNESS_INCREASE : CAMERA_BRIGHTNESS_DECREASE;
+
+    /* the first step turns the AEC of the sensor off */
+    for (int i = 0; i < abs(steps); i++)
+    {
+        if (kStatus_Success != CAMERA_DEVICE_Control(&cameraDevice, kCAMERA_DeviceBrightnessAdjust, direction))
+        {
+            ret = kStatus_HAL_CameraError;
+            break;
+        }
+    }
+
+    return ret;
+}
+
 const static camera_dev_operator_t camera_dev_mipi_gc2145_ops = {
-    .init        = HAL_CameraDev_MipiGc2145_Init,
-    .deinit      = HAL_CameraDev_MipiGc2145_Deinit,
-    .start       = HAL_CameraDev_MipiGc2145_Start,
-    .enqueue     = HAL_CameraDev_MipiGc2145_Enqueue,
-    .dequeue     = HAL_CameraDev_MipiGc2145_Dequeue,
-    .inputNotify = NULL,
+    .init           = HAL_CameraDev_MipiGc2145_Init,
+    .deinit         = HAL_CameraDev_MipiGc2145_Deinit,
+    .start          = HAL_CameraDev_MipiGc2145_Start,
+    .enqueue        = HAL_CameraDev_MipiGc2145_Enqueue,
+    .dequeue        = HAL_CameraDev_MipiGc2145_Dequeue,
+    .inputNotify    = NULL,
+    .adjustExposure = HAL_CameraDev_MipiGc2145_AdjustExposure,
 };
 
 static camera_dev_t camera_dev_mipi_gc2145 = {
@@ -419,6 +455,14 @@ static camera_dev_t camera_dev_mipi_gc2145 = {
             .rotate   = CAMERA_DEV_MipiGc2145_ROTATE,
             .flip     = CAMERA_DEV_MipiGc2145_FLIP,
             .swapByte = CAMERA_DEV_MipiGc2145_SWAPBYTE,
+            .exposure =
+                {
+                    .stepUpEv   = CAMERA_DEV_EXPOSURE_STEP_UP_EV,
+                    .stepDownEv = CAMERA_DEV_EXPOSURE_STEP_DOWN_EV,
+                    .stepsUp    = CAMERA_DEV_EXPOSURE_STEPS_UP,
+                    .stepsDown  = CAMERA_DEV_EXPOSURE_STEPS_DOWN,
+                    .light      = kCameraDevLight_None,
+                },
         },
     .cap = {.callback = NULL, .param = NULL},
 };
@@ -34,6 +34,7 @@
 #include "fwk_camera_manager.h"
 #include "fwk_log.h"
 #include "hal_camera_dev.h"
+#include "hal_camera_receiver.h"
 
 /*******************************************************************************
  * Definitions
@@ -85,11 +86,12 @@ status_t BOARD_3DCameraI2CReceive(
 SDK_ALIGN(
     static uint8_t s_FrameBuffer[CAMERA_DEV_BUFFER_COUNT][CAMERA_DEV_HEIGHT][CAMERA_DEV_WIDTH * CAMERA_BYTES_PER_PIXEL],
     CAMERA_DEV_BUFFER_ALIGN);
-SDK_ALIGN(static uint8_t s_TempBuffer[CAMERA_DEV_HEIGHT][CAMERA_DEV_WIDTH * CAMERA_BYTES_PER_PIXEL],
-          CAMERA_DEV_BUFFER_ALIGN);
 SDK_ALIGN(static uint8_t s_DepthBuffer[CAMERA_DEV_HEIGHT][CAMERA_DEV_WIDTH * CAMERA_BYTES_PER_PIXEL],
           CAMERA_DEV_BUFFER_ALIGN);
 
+/* first line of the frame shifted, enough to detect the mode without shifting the whole frame */
+SDK_ALIGN(static uint16_t s_FirstLine[CAMERA_DEV_WIDTH], 4);
+
 static uint32_t *s_pCurrentFrameBuffer = 0;
 
 /* Camera connect to CSI. */
@@ -106,6 +108,8 @@ static camera_receiver_handle_t s_CameraReceiver = {
     .privateData = &s_CSIPrivateData,
 };
 
+static camera_receiver_sync_t s_CameraReceiverSync;
+
 static obU1S_resource_t s_ObU1SResource = {
     .i2cSendFunc        = BOARD_3DCameraI2CSend,
     .i2cReceiveFunc     = BOARD_3DCameraI2CReceive,
@@ -127,6 +131,8 @@ static void _CameraReceiverCallback(camera_receiver_handle_t *handle, status_t s
 {
     camera_dev_t *dev = (camera_dev_t *)userData;
 
+    HAL_CameraReceiver_SyncFrameDone(&s_CameraReceiverSync);
+
     if (dev->cap.callback != NULL)
     {
         uint8_t fromISR = __get_IPSR();
@@ -344,6 +350,7 @@ static hal_camera_status_t HAL_CameraDev_MipiOrbbecU1s_Init(
     cameraConfig.framePerSec                = 30;
 
     NVIC_SetPriority(CSI_IRQn, configMAX_SYSCALL_INTERRUPT_PRIORITY - 1);
+    HAL_CameraReceiver_SyncInit(&s_CameraReceiverSync, dev->name, CAMERA_DEV_BUFFER_COUNT);
     CAMERA_RECEIVER_Init(&s_CameraReceiver, &cameraConfig, _CameraReceiverCallback, dev);
 
     BOARD_Init3DMipiCsi();
@@ -377,6 +384,7 @@ static hal_camera_status_t HAL_CameraDev_MipiOrbbec_U1s_Start(const camera_dev_t
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGD("HAL_CameraDev_MipiOrbbec_U1s_Start");
     CAMERA_DEVICE_Start(&s_ObU1SCameraDevice);
+    HAL_CameraReceiver_SyncStart(&s_CameraReceiverSync);
     CAMERA_RECEIVER_Start(&s_CameraReceiver);
 
     return ret;
@@ -399,25 +407,35 @@ static hal_camera_status_t HAL_CameraDev_MipiOrbbecU1s_Enqueue(const camera_dev_
     return ret;
 }
 
+/*
+ * Shift two pixels per word, four words per iteration. dst can be src, each word is read before it is written.
+ * The width must be a multiple of 8.
+ */
 static void HAL_CameraDev_MipiOrbbecU1s_DataLeftShift2Bits(uint16_t *src, uint16_t *dst, int w, int h)
 {
     uint32_t *src32 = (uint32_t *)src;
     uint32_t *dst32 = (uint32_t *)dst;
+    uint32_t fill   = 0;
     w >>= 1;
     // left shift 2bits, and fill a11 to 1 from the second line.
-    for (int j = 0; j < w; j += 2)
-    {
-        dst32[j]     = (src32[j] & 0xFFFF3FFFUL) << 2;
-        dst32[j + 1] = (src32[j + 1] & 0xFFFF3FFFUL) << 2;
-    }
-    for (int i = 1; i < h; i++)
+    for (int i = 0; i < h; i++)
     {
-        int base_idx = i * w;
-        for (int j = 0; j < w; j += 2)
+        for (int j = 0; j < w; j += 4)
         {
-            dst32[base_idx + j]     = ((src32[base_idx + j] & 0xFFFF3FFFUL) << 2) | 0x08000800;
-            dst32[base_idx + j + 1] = ((src32[base_idx + j + 1] & 0xFFFF3FFFUL) << 2) | 0x08000800;
+            uint32_t p0 = src32[j];
+            uint32_t p1 = src32[j + 1];
+            uint32_t p2 = src32[j + 2];
+            uint32_t p3 = src32[j + 3];
+
+            dst32[j]     = ((p0 & 0xFFFF3FFFUL) << 2) | fill;
+            dst32[j + 1] = ((p1 & 0xFFFF3FFFUL) << 2) | fill;
+            dst32[j + 2] = ((p2 & 0xFFFF3FFFUL) << 2) | fill;
+            dst32[j + 3] = ((p3 & 0xFFFF3FFFUL) << 2) | fill;
         }
+
+        src32 += w;
+        dst32 += w;
+        fill = 0x08000800;
     }
 }
 
@@ -429,16 +447,31 @@ static hal_camera_status_t HAL_CameraDev_MipiOrbbecU1s_Dequeue(const camera_dev_
 
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
 
-    while (kStatus_Success != CAMERA_RECEIVER_GetFullBuffer(&s_CameraReceiver, &s_pCurrentFrameBuffer))
+    if (kStatus_Success !=
+        HAL_CameraReceiver_GetFullBuffer(&s_CameraReceiverSync, &s_CameraReceiver, &s_pCurrentFrameBuffer))
     {
+        /* no frame in time, the camera manager skips this dequeue */
+        *data = NULL;
+        LOGI("--HAL_CameraDev_MipiOrbbecU1s_Dequeue");
+        return kStatus_HAL_CameraError;
     }
-    // shift data 0b' 0000 0000 a9:a2  to 0b' 0000 x0a9:a200
-    HAL_CameraDev_MipiOrbbecU1s_DataLeftShift2Bits((uint16_t *)s_pCurrentFrameBuffer, (uint16_t *)s_TempBuffer,
-                                                   CAMERA_DEV_WIDTH, CAMERA_DEV_HEIGHT);
-    if (MODE_DEPTH == parseFirstLine((uint16_t *)s_TempBuffer))
+
+    // shift data 0b' 0000 0000 a9:a2  to 0b' 0000 x0a9:a200, only the first line is needed to detect the mode
+    HAL_CameraDev_MipiOrbbecU1s_DataLeftShift2Bits((uint16_t *)s_pCurrentFrameBuffer, s_FirstLine, CAMERA_DEV_WIDTH, 1);
+    if (MODE_DEPTH == parseFirstLine(s_FirstLine))
     {
-        OrbbecDevice_shift9_2ToDepth((uint16_t *)s_TempBuffer, (uint16_t *)s_DepthBuffer, CAMERA_DEV_WIDTH,
+        /* the raw frame is not used once converted, shift it in place */
+        HAL_CameraDev_MipiOrbbecU1s_DataLeftShift2Bits((uint16_t *)s_pCurrentFrameBuffer,
+                                                       (uint16_t *)s_pCurrentFrameBuffer, CAMERA_DEV_WIDTH,
+                                                       CAMERA_DEV_HEIGHT);
+        OrbbecDevice_shift9_2ToDepth((uint16_t *)s_pCurrentFrameBuffer, (uint16_t *)s_DepthBuffer, CAMERA_DEV_WIDTH,
                                      CAMERA_DEV_HEIGHT);
+#if defined(__DCACHE_PRESENT) && __DCACHE_PRESENT
+        /* drop the shifted lines from the cache before the buffer goes back to the DMA, a later eviction would
+         * overwrite the next frame */
+        SCB_InvalidateDCache_by_Addr(s_pCurrentFrameBuffer,
+                                     CAMERA_DEV_HEIGHT * CAMERA_DEV_WIDTH * CAMERA_BYTES_PER_PIXEL);
+#endif
         *data   = (void *)s_DepthBuffer;
         *format = kPixelFormat_Depth16;
         LOGI("3D_depth");
@@ -33,6 +33,7 @@
 #include "fwk_log.h"
 #include "fwk_camera_manager.h"
 #include "hal_camera_dev.h"
+#include "hal_camera_receiver.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -89,6 +90,8 @@ camera_receiver_handle_t cameraReceiver = {
     .privateData = &csiPrivateData,
 };
 
+static camera_receiver_sync_t s_CameraReceiverSync;
+
 static ov5640_resource_t ov5640Resource = {
     .i2cSendFunc      = BOARD_MIPICameraI2CSend,
     .i2cReceiveFunc   = BOARD_MIPICameraI2CReceive,
@@ -312,6 +315,7 @@ hal_camera_status_t HAL_CameraDev_MipiOv5640_Init(
     cameraConfig.framePerSec                = CAMERA_DEV_FRAME_RATE;
 
     NVIC_SetPriority(CSI_IRQn, configMAX_SYSCALL_INTERRUPT_PRIORITY - 1);
+    HAL_CameraReceiver_SyncInit(&s_CameraReceiverSync, dev->name, CAMERA_DEV_MipiOv5640_BUFFER_COUNT);
     CAMERA_RECEIVER_Init(&cameraReceiver, &cameraConfig, HAL_CameraDev_MipiOv5640_ReceiverCallback, NULL);
 
     MipiOv5640_InitMipiCsi();
@@ -347,6 +351,7 @@ hal_camera_status_t HAL_CameraDev_MipiOv5640_Start(const camera_dev_t *dev)
 {
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGD("++HAL_CameraDev_MipiOv5640_Start");
+    HAL_CameraReceiver_SyncStart(&s_CameraReceiverSync);
     CAMERA_RECEIVER_Start(&cameraReceiver);
     LOGD("--HAL_CameraDev_MipiOv5640_Start");
     return ret;
@@ -359,9 +364,13 @@ hal_camera_status_t HAL_CameraDev_MipiOv5640_Dequeue(const camera_dev_t *dev, vo
     hal_camera_status_t ret = kStatus_HAL_CameraSuccess;
     LOGI("++HAL_CameraDev_MipiOv5640_Dequeue");
 
-    // get one frame
-    while (kStatus_Success != CAMERA_RECEIVER_GetFullBuffer(&cameraReceiver, &gCurrentBufferAddr))
+    if (kStatus_Success !=
+        HAL_CameraReceiver_GetFullBuffer(&s_CameraReceiverSync, &cameraReceiver, &gCurrentBufferAddr))
     {
+        /* no frame in time, the camera manager skips this dequeue */
+        *data = NULL;
+        LOGI("--HAL_CameraDev_MipiOv5640_Dequeue");
+        return kStatus_HAL_CameraError;
     }
 
     *data   = (void *)gCurrentBufferAddr;
@@ -417,6 +426,8 @@ static camera_dev_t camera_dev_mipi_ov5640 = {
 
 void HAL_CameraDev_MipiOv5640_ReceiverCallback(camera_receiver_handle_t *handle, status_t status, void *userData)
 {
+    HAL_CameraReceiver_SyncFrameDone(&s_CameraReceiverSync);
+
     if (camera_dev_mipi_ov5640.cap.callback != NULL)
     {
         uint8_t fromISR = __get_IPSR();
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief camera receiver helper implementation.
+ * The semaphore counts the frames completed by the receiver, it can't go above the number of buffers. A frame can be
+ * found full before its completion is counted, so the receiver queue is always checked first and the semaphore is
+ * only used to wait.
+ */
+
+#include <string.h>
+
+#include "task.h"
+
+#include "fwk_log.h"
+#include "fwk_platform.h"
+#include "hal_camera_receiver.h"
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+void HAL_CameraReceiver_SyncInit(camera_receiver_sync_t *sync, const char *name, uint32_t bufferCount)
+{
+    if (sync == NULL)
+    {
+        return;
+    }
+
+    if (sync->frameDone == NULL)
+    {
+        sync->frameDone = xSemaphoreCreateCounting(bufferCount, 0);
+        if (sync->frameDone == NULL)
+        {
+            LOGE("Camera %s receiver semaphore creation failed, dequeue will poll", name);
+        }
+    }
+
+    while ((sync->frameDone != NULL) && (xSemaphoreTake(sync->frameDone, 0) == pdTRUE))
+    {
+    }
+
+    sync->name           = name;
+    sync->lastFrameUs    = 0;
+    sync->lastActivityUs = FWK_CurrentTimeUs();
+    sync->stalled        = 0;
+    memset(&sync->stats, 0, sizeof(sync->stats));
+    sync->stats.minIntervalUs = UINT32_MAX;
+}
+
+void HAL_CameraReceiver_SyncStart(camera_receiver_sync_t *sync)
+{
+    if (sync == NULL)
+    {
+        return;
+    }
+
+    sync->lastFrameUs    = 0;
+    sync->lastActivityUs = FWK_CurrentTimeUs();
+    sync->stalled        = 0;
+}
+
+void HAL_CameraReceiver_SyncFrameDone(camera_receiver_sync_t *sync)
+{
+    if ((sync == NULL) || (sync->frameDone == NULL))
+    {
+        return;
+    }
+
+    sync->stats.framesDone++;
+
+    if (__get_IPSR())
+    {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+        /* the count is saturated when the camera manager is behind, the frames are still in the receiver queue */
+        xSemaphoreGiveFromISR(sync->frameDone, &higherPriorityTaskWoken);
+        portYIELD_FROM_ISR(higherPriorityTaskWoken);
+    }
+    else
+    {
+        xSemaphoreGive(sync->frameDone);
+    }
+}
+
+static void _HAL_CameraReceiver_FrameDequeued(camera_receiver_sync_t *sync)
+{
+    uint32_t now = FWK_CurrentTimeUs();
+
+    if (sync->stalled)
+    {
+        LOGI("Camera %s receiver recovered after %d ms", sync->name, (now - sync->lastActivityUs) / 1000);
+        sync->stalled = 0;
+    }
+
+    if (sync->lastFrameUs != 0)
+    {
+        uint32_t interval = now - sync->lastFrameUs;
+
+        sync->stats.lastIntervalUs = interval;
+        if (interval < sync->stats.minIntervalUs)
+        {
+            sync->stats.minIntervalUs = interval;
+        }
+        if (interval > sync->stats.maxIntervalUs)
+        {
+            sync->stats.maxIntervalUs = interval;
+        }
+    }
+
+    sync->lastFrameUs    = now;
+    sync->lastActivityUs = now;
+    sync->stats.framesDequeued++;
+
+#if CAMERA_RECEIVER_STATS_LOG_PERIOD
+    if ((sync->stats.framesDequeued % CAMERA_RECEIVER_STATS_LOG_PERIOD) == 0)
+    {
+        LOGI("Camera %s: done %d dequeued %d interval %d/%d/%d us timeouts %d stalls %d", sync->name,
+             sync->stats.framesDone, sync->stats.framesDequeued, sync->stats.minIntervalUs, sync->stats.lastIntervalUs,
+             sync->stats.maxIntervalUs, sync->stats.timeouts, sync->stats.stalls);
+    }
+#endif /* CAMERA_RECEIVER_STATS_LOG_PERIOD */
+}
+
+static void _HAL_CameraReceiver_CheckStall(camera_receiver_sync_t *sync)
+{
+    uint32_t elapsedMs = (FWK_CurrentTimeUs() - sync->lastActivityUs) / 1000;
+
+    sync->stats.timeouts++;
+    if ((!sync->stalled) && (elapsedMs >= CAMERA_RECEIVER_STALL_TIMEOUT_MS))
+    {
+        LOGE("Camera %s receiver stalled, no frame for %d ms", sync->name, elapsedMs);
+        sync->stalled = 1;
+        sync->stats.stalls++;
+    }
+}
+
+status_t HAL_CameraReceiver_GetFullBuffer(camera_receiver_sync_t *sync,
+                                          camera_receiver_handle_t *receiver,
+                                          uint32_t *buffer)
+{
+    TickType_t timeout = pdMS_TO_TICKS(CAMERA_RECEIVER_DEQUEUE_TIMEOUT_MS);
+    TickType_t start   = xTaskGetTickCount();
+
+    if ((sync == NULL) || (receiver == NULL) || (buffer == NULL))
+    {
+        return kStatus_InvalidArgument;
+    }
+
+    while (kStatus_Success != CAMERA_RECEIVER_GetFullBuffer(receiver, buffer))
+    {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+
+        if (elapsed >= timeout)
+        {
+            _HAL_CameraReceiver_CheckStall(sync);
+            return kStatus_Timeout;
+        }
+
+        if (sync->frameDone != NULL)
+        {
+            xSemaphoreTake(sync->frameDone, timeout - elapsed);
+        }
+        else
+        {
+            vTaskDelay(1);
+        }
+    }
+
+    /* the completion of this frame may still be counted, the next wait checks the receiver queue first anyway */
+    if (sync->frameDone != NULL)
+    {
+        xSemaphoreTake(sync->frameDone, 0);
+    }
+
+    _HAL_CameraReceiver_FrameDequeued(sync);
+
+    return kStatus_Success;
+}
+
+void HAL_CameraReceiver_GetStats(const camera_receiver_sync_t *sync, camera_receiver_stats_t *stats)
+{
+    if ((sync == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    *stats = sync->stats;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief camera receiver helper declaration.
+ * The receiver callback of a camera device signals each completed frame, the dequeue blocks until a full buffer is
+ * available instead of polling the receiver, so the camera manager task gives the CPU away while the DMA fills the
+ * frame. The interval between frames is tracked and a sensor which stops delivering frames is reported as stalled.
+ */
+
+#ifndef _HAL_CAMERA_RECEIVER_H_
+#define _HAL_CAMERA_RECEIVER_H_
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#include "fsl_camera_receiver.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Time a dequeue waits for a frame before giving up */
+#ifndef CAMERA_RECEIVER_DEQUEUE_TIMEOUT_MS
+#define CAMERA_RECEIVER_DEQUEUE_TIMEOUT_MS 200
+#endif /* CAMERA_RECEIVER_DEQUEUE_TIMEOUT_MS */
+
+/* Time without any frame after which the sensor is considered stalled */
+#ifndef CAMERA_RECEIVER_STALL_TIMEOUT_MS
+#define CAMERA_RECEIVER_STALL_TIMEOUT_MS 1000
+#endif /* CAMERA_RECEIVER_STALL_TIMEOUT_MS */
+
+/* Log the frame statistics every CAMERA_RECEIVER_STATS_LOG_PERIOD frames, 0 to disable */
+#ifndef CAMERA_RECEIVER_STATS_LOG_PERIOD
+#define CAMERA_RECEIVER_STATS_LOG_PERIOD 0
+#endif /* CAMERA_RECEIVER_STATS_LOG_PERIOD */
+
+typedef struct _camera_receiver_stats
+{
+    /* frames completed by the receiver */
+    uint32_t framesDone;
+    /* frames handed to the camera manager */
+    uint32_t framesDequeued;
+    /* dequeues which got no frame within CAMERA_RECEIVER_DEQUEUE_TIMEOUT_MS */
+    uint32_t timeouts;
+    /* times the sensor stopped delivering frames for CAMERA_RECEIVER_STALL_TIMEOUT_MS */
+    uint32_t stalls;
+    /* interval between the last two dequeued frames and its extremes, in us */
+    uint32_t lastIntervalUs;
+    uint32_t minIntervalUs;
+    uint32_t maxIntervalUs;
+} camera_receiver_stats_t;
+
+typedef struct _camera_receiver_sync
+{
+    const char *name;
+    SemaphoreHandle_t frameDone;
+    /* time of the last dequeued frame, 0 before the first one */
+    uint32_t lastFrameUs;
+    /* time of the last frame or of the start, used to detect a stall */
+    uint32_t lastActivityUs;
+    uint8_t stalled;
+    camera_receiver_stats_t stats;
+} camera_receiver_sync_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init the synchronization of a camera receiver
+ * @param sync synchronization to init
+ * @param name name of the camera device, used in the logs
+ * @param bufferCount number of frame buffers submitted to the receiver
+ */
+void HAL_CameraReceiver_SyncInit(camera_receiver_sync_t *sync, const char *name, uint32_t bufferCount);
+
+/**
+ * @brief Reset the stall detection, to be called when the receiver starts
+ * @param sync synchronization of the receiver
+ */
+void HAL_CameraReceiver_SyncStart(camera_receiver_sync_t *sync);
+
+/**
+ * @brief Signal a completed frame, called from the receiver callback, in interrupt or task context
+ * @param sync synchronization of the receiver
+ */
+void HAL_CameraReceiver_SyncFrameDone(camera_receiver_sync_t *sync);
+
+/**
+ * @brief Get a full buffer from the receiver, blocking until one is available
+ * @param sync synchronization of the receiver
+ * @param receiver camera receiver
+ * @param buffer address of the full buffer
+ * @return kStatus_Success, kStatus_Timeout if no frame was completed within CAMERA_RECEIVER_DEQUEUE_TIMEOUT_MS
+ */
+status_t HAL_CameraReceiver_GetFullBuffer(camera_receiver_sync_t *sync,
+                                          camera_receiver_handle_t *receiver,
+                                          uint32_t *buffer);
+
+/**
+ * @brief Get the frame statistics of a receiver
+ * @param sync synchronization of the receiver
+ * @param stats statistics
+ */
+void HAL_CameraReceiver_GetStats(const camera_receiver_sync_t *sync, camera_receiver_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_CAMERA_RECEIVER_H_ */
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief display buffer queue implementation.
+ * The producer holds at most one buffer, it is only asked for a new frame once the previous one was blitted. The
+ * states are changed by the display task and by the vsync interrupt, always with the interrupts masked.
+ */
+
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "fwk_log.h"
+#include "fwk_perf.h"
+#include "fwk_platform.h"
+#include "hal_display_buffer.h"
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint32_t _HAL_DisplayBuffer_Find(const display_buffer_queue_t *queue, display_buffer_state_t state)
+{
+    uint32_t index;
+
+    for (index = 0; index < queue->count; index++)
+    {
+        if (queue->state[index] == state)
+        {
+            break;
+        }
+    }
+
+    return index;
+}
+
+static uint32_t _HAL_DisplayBuffer_Index(const display_buffer_queue_t *queue, const void *frame)
+{
+    uint32_t index;
+
+    for (index = 0; index < queue->count; index++)
+    {
+        if (queue->buffers[index] == frame)
+        {
+            break;
+        }
+    }
+
+    return index;
+}
+
+/* hand a free buffer to the producer, or remember that it waits for one */
+static void *_HAL_DisplayBuffer_Take(display_buffer_queue_t *queue)
+{
+    uint32_t index;
+
+    if (_HAL_DisplayBuffer_Find(queue, kDisplayBufferState_Rendering) < queue->count)
+    {
+        return NULL;
+    }
+
+    index = _HAL_DisplayBuffer_Find(queue, kDisplayBufferState_Free);
+    if (index >= queue->count)
+    {
+        if (!queue->waiting)
+        {
+            queue->waiting = 1;
+            queue->stats.paced++;
+        }
+        return NULL;
+    }
+
+    queue->state[index] = kDisplayBufferState_Rendering;
+
+    return queue->buffers[index];
+}
+
+void HAL_DisplayBuffer_Init(display_buffer_queue_t *queue,
+                            const char *name,
+                            int devId,
+                            uint8_t *const *buffers,
+                            uint32_t count,
+                            display_buffer_program_t program)
+{
+    if ((queue == NULL) || (buffers == NULL) || (program == NULL))
+    {
+        return;
+    }
+
+    /* a zero count leaves the queue unusable, the requests and the blits are then ignored */
+    memset(queue, 0, sizeof(display_buffer_queue_t));
+    if ((count < 2) || (count > DISPLAY_BUFFER_MAX_COUNT))
+    {
+        LOGE("Display %s unsupported buffer count %d", name, count);
+        return;
+    }
+
+    queue->name    = name;
+    queue->devId   = devId;
+    queue->count   = count;
+    queue->program = program;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        queue->buffers[i] = buffers[i];
+        queue->state[i]   = kDisplayBufferState_Free;
+    }
+
+    queue->state[0] = kDisplayBufferState_OnScreen;
+}
+
+void *HAL_DisplayBuffer_Request(display_buffer_queue_t *queue)
+{
+    void *frame;
+
+    if ((queue == NULL) || (queue->count == 0))
+    {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL();
+    frame = _HAL_DisplayBuffer_Take(queue);
+    taskEXIT_CRITICAL();
+
+    return frame;
+}
+
+void *HAL_DisplayBuffer_Submit(display_buffer_queue_t *queue, void *frame)
+{
+    uint32_t index;
+    void *next;
+
+    if ((queue == NULL) || (queue->count == 0))
+    {
+        return NULL;
+    }
+
+    index = _HAL_DisplayBuffer_Index(queue, frame);
+
+    taskENTER_CRITICAL();
+    if ((index >= queue->count) || (queue->state[index] != kDisplayBufferState_Rendering))
+    {
+        /* not rendered into a buffer handed out by the queue, it may be scanned out already */
+        queue->stats.dropped++;
+        fwk_frame_event(kFWKFPSType_Display, queue->devId, kFWKFrameEvent_Dropped);
+    }
+    else
+    {
+        queue->submitUs[index] = FWK_CurrentTimeUs();
+        queue->stats.submitted++;
+
+        if (_HAL_DisplayBuffer_Find(queue, kDisplayBufferState_Pending) < queue->count)
+        {
+            /* programming it now would replace the pending frame before it is shown */
+            queue->state[index] = kDisplayBufferState_Queued;
+            queue->stats.late++;
+            fwk_frame_event(kFWKFPSType_Display, queue->devId, kFWKFrameEvent_Late);
+        }
+        else
+        {
+            queue->state[index] = kDisplayBufferState_Pending;
+            queue->program(frame);
+        }
+    }
+
+    next = _HAL_DisplayBuffer_Take(queue);
+    taskEXIT_CRITICAL();
+
+#if DISPLAY_BUFFER_STATS_LOG_PERIOD
+    if ((queue->stats.submitted % DISPLAY_BUFFER_STATS_LOG_PERIOD) == 0)
+    {
+        LOGI("Display %s: submitted %d shown %d dropped %d late %d paced %d latency %d/%d us", queue->name,
+             queue->stats.submitted, queue->stats.shown, queue->stats.dropped, queue->stats.late, queue->stats.paced,
+             queue->stats.lastLatencyUs, queue->stats.maxLatencyUs);
+    }
+#endif /* DISPLAY_BUFFER_STATS_LOG_PERIOD */
+
+    return next;
+}
+
+void *HAL_DisplayBuffer_SwitchDone(display_buffer_queue_t *queue)
+{
+    UBaseType_t savedInterruptStatus;
+    uint32_t pending;
+    uint32_t queued;
+    void *next = NULL;
+
+    if ((queue == NULL) || (queue->count == 0))
+    {
+        return NULL;
+    }
+
+    savedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    pending = _HAL_DisplayBuffer_Find(queue, kDisplayBufferState_Pending);
+    if (pending < queue->count)
+    {
+        uint32_t latency = FWK_CurrentTimeUs() - queue->submitUs[pending];
+
+        for (uint32_t i = 0; i < queue->count; i++)
+        {
+            if (queue->state[i] == kDisplayBufferState_OnScreen)
+            {
+                queue->state[i] = kDisplayBufferState_Free;
+            }
+        }
+
+        queue->state[pending] = kDisplayBufferState_OnScreen;
+        queue->stats.shown++;
+        queue->stats.lastLatencyUs = latency;
+        if (latency > queue->stats.maxLatencyUs)
+        {
+            queue->stats.maxLatencyUs = latency;
+        }
+
+        queued = _HAL_DisplayBuffer_Find(queue, kDisplayBufferState_Queued);
+        if (queued < queue->count)
+        {
+            queue->state[queued] = kDisplayBufferState_Pending;
+            queue->program(queue->buffers[queued]);
+        }
+
+        if (queue->waiting)
+        {
+            queue->waiting = 0;
+            next           = _HAL_DisplayBuffer_Take(queue);
+        }
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedInterruptStatus);
+
+    return next;
+}
+
+void HAL_DisplayBuffer_GetStats(const display_buffer_queue_t *queue, display_buffer_stats_t *stats)
+{
+    if ((queue == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    *stats = queue->stats;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief display buffer queue declaration.
+ * Tracks the frame buffers of a display controller which scans out of one buffer while the camera manager renders
+ * into another. A buffer is handed to the producer only once it has been switched off the screen, and a rendered
+ * buffer is programmed to the controller only when no other one waits for the vsync, so a frame is never overwritten
+ * while it is scanned out and the producer is paced to the panel refresh. With three buffers, the producer renders the
+ * next frame while the previous one waits for the vsync.
+ */
+
+#ifndef _HAL_DISPLAY_BUFFER_H_
+#define _HAL_DISPLAY_BUFFER_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Maximum number of buffers of a display, 2 for double buffering and 3 for triple buffering */
+#define DISPLAY_BUFFER_MAX_COUNT 3
+
+/* Log the buffer statistics every DISPLAY_BUFFER_STATS_LOG_PERIOD frames, 0 to disable */
+#ifndef DISPLAY_BUFFER_STATS_LOG_PERIOD
+#define DISPLAY_BUFFER_STATS_LOG_PERIOD 0
+#endif /* DISPLAY_BUFFER_STATS_LOG_PERIOD */
+
+typedef enum _display_buffer_state
+{
+    /* available for the producer */
+    kDisplayBufferState_Free = 0,
+    /* handed to the producer, being rendered */
+    kDisplayBufferState_Rendering,
+    /* rendered, waits for the previous frame to reach the screen */
+    kDisplayBufferState_Queued,
+    /* programmed to the controller, switched on at the next vsync */
+    kDisplayBufferState_Pending,
+    /* scanned out by the controller */
+    kDisplayBufferState_OnScreen,
+} display_buffer_state_t;
+
+/* Program the address of the next frame to the display controller, called with the interrupts masked */
+typedef void (*display_buffer_program_t)(void *frame);
+
+typedef struct _display_buffer_stats
+{
+    /* frames blitted by the producer */
+    uint32_t submitted;
+    /* frames switched on the screen */
+    uint32_t shown;
+    /* frames blitted which were not rendered into a buffer of the queue, never shown */
+    uint32_t dropped;
+    /* frames which waited an extra vsync behind the previous one */
+    uint32_t late;
+    /* requests of the producer deferred to the vsync, as no buffer was free */
+    uint32_t paced;
+    /* time between the blit and the switch on the screen, in us */
+    uint32_t lastLatencyUs;
+    uint32_t maxLatencyUs;
+} display_buffer_stats_t;
+
+typedef struct _display_buffer_queue
+{
+    const char *name;
+    /* id of the display device, used for the frame events of fwk_perf */
+    int devId;
+    uint8_t *buffers[DISPLAY_BUFFER_MAX_COUNT];
+    volatile uint8_t state[DISPLAY_BUFFER_MAX_COUNT];
+    /* time of the blit of each buffer */
+    uint32_t submitUs[DISPLAY_BUFFER_MAX_COUNT];
+    uint8_t count;
+    /* the producer asked for a buffer while none was free */
+    volatile uint8_t waiting;
+    display_buffer_program_t program;
+    display_buffer_stats_t stats;
+} display_buffer_queue_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init the buffer queue of a display, the first buffer is the one on the screen
+ * @param queue buffer queue to init
+ * @param name name of the display device, used in the logs
+ * @param devId id of the display device
+ * @param buffers frame buffers of the display
+ * @param count number of frame buffers, 2 or 3
+ * @param program function programming the next frame to the display controller
+ */
+void HAL_DisplayBuffer_Init(display_buffer_queue_t *queue,
+                            const char *name,
+                            int devId,
+                            uint8_t *const *buffers,
+                            uint32_t count,
+                            display_buffer_program_t program);
+
+/**
+ * @brief Get a buffer for the producer, in task context
+ * @param queue buffer queue of the display
+ * @return the buffer to render into, NULL if none is free, the buffer is then returned by the next switch
+ */
+void *HAL_DisplayBuffer_Request(display_buffer_queue_t *queue);
+
+/**
+ * @brief Queue a rendered frame to the display and get the next buffer for the producer, in task context
+ * @param queue buffer queue of the display
+ * @param frame frame rendered by the producer
+ * @return the buffer to render into, NULL if none is free, the buffer is then returned by the next switch
+ */
+void *HAL_DisplayBuffer_Submit(display_buffer_queue_t *queue, void *frame);
+
+/**
+ * @brief Signal the vsync of the display controller, in interrupt context
+ * The pending frame is now on the screen and the previous one is released.
+ * @param queue buffer queue of the display
+ * @return the buffer to hand to a waiting producer, NULL if no producer waits or no frame was pending
+ */
+void *HAL_DisplayBuffer_SwitchDone(display_buffer_queue_t *queue);
+
+/**
+ * @brief Get the buffer statistics of a display
+ * @param queue buffer queue of the display
+ * @param stats statistics
+ */
+void HAL_DisplayBuffer_GetStats(const display_buffer_queue_t *queue, display_buffer_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_DISPLAY_BUFFER_H_ */
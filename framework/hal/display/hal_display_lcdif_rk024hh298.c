@@ -21,6 +21,7 @@
 
 #include "fwk_log.h"
 #include "fwk_display_manager.h"
+#include "hal_display_buffer.h"
 #include "hal_display_dev.h"
 #include "hal_event_descriptor_common.h"
 #include "./icons/nxp_logo_240x86.h"
@@ -29,7 +30,12 @@
 #define DISPLAY_WIDTH              240
 #define DISPLAY_HEIGHT             320
 #define DISPLAY_BYTES_PER_PIXEL    2
-#define DISPLAY_FRAME_BUFFER_COUNT 2
+
+/* 3 for triple buffering, the next frame is rendered while the previous one waits for the vsync */
+#ifndef DISPLAY_DEV_LcdifRk024hh298_BUFFER_COUNT
+#define DISPLAY_DEV_LcdifRk024hh298_BUFFER_COUNT 2
+#endif /* DISPLAY_DEV_LcdifRk024hh298_BUFFER_COUNT */
+#define DISPLAY_FRAME_BUFFER_COUNT DISPLAY_DEV_LcdifRk024hh298_BUFFER_COUNT
 
 #define DISPLAY_HSW 10
 #define DISPLAY_HFP 10
@@ -62,9 +68,8 @@ status_t board_elcdif_rk024hh298_spi_send(uint8_t *txBuff, uint8_t txSize);
 AT_NONCACHEABLE_SECTION_ALIGN(
     static uint8_t s_FrameBuffers[DISPLAY_FRAME_BUFFER_COUNT][DISPLAY_HEIGHT][DISPLAY_WIDTH * DISPLAY_BYTES_PER_PIXEL],
     32);
-static uint8_t *s_pCurrentFrameBuffer = NULL;
-static bool s_NewBufferSet            = 0;
-static int8_t s_LCDFramesNum          = 0;
+static display_buffer_queue_t s_DisplayBufferQueue;
+static int8_t s_LCDFramesNum = 0;
 
 static void HAL_DisplayDev_LcdifRk024hh298_WriteCommand(uint8_t cmd)
 {
@@ -106,6 +111,11 @@ static void BOARD_InitDisplayInterface(void)
     VIDEO_MUX->VID_MUX_CTRL.CLR = VIDEO_MUX_VID_MUX_CTRL_PARA_LCD_SEL_MASK;
 }
 
+static void _ELCDIF_ProgramFrameBuffer(void *frame)
+{
+    ELCDIF_SetNextBufferAddr(DISPLAY_LCDIF_BASE, (uint32_t)frame);
+}
+
 static void _ELCDIF_Init(void)
 {
     memcpy((void *)&s_FrameBuffers[0] + DISPLAY_WIDTH * ((DISPLAY_HEIGHT - NXP_LOGO_H) / 2) * DISPLAY_BYTES_PER_PIXEL,
@@ -138,11 +148,20 @@ hal_display_status_t HAL_DisplayDev_LcdifRk024hh2_Init(
     display_dev_t *dev, int width, int height, display_dev_callback_t callback, void *param)
 {
     hal_display_status_t ret = kStatus_HAL_DisplaySuccess;
+    uint8_t *buffers[DISPLAY_FRAME_BUFFER_COUNT];
     LOGD("++display_dev_init");
 
+    /* the first buffer shows the logo until the first camera frame */
+    for (int i = 0; i < DISPLAY_FRAME_BUFFER_COUNT; i++)
+    {
+        buffers[i] = (uint8_t *)s_FrameBuffers[i];
+    }
+    HAL_DisplayBuffer_Init(&s_DisplayBufferQueue, DISPLAY_NAME, dev->id, buffers, DISPLAY_FRAME_BUFFER_COUNT,
+                           _ELCDIF_ProgramFrameBuffer);
+
     dev->cap.width       = width;
     dev->cap.height      = height;
-    dev->cap.frameBuffer = (void *)&s_FrameBuffers[1];
+    dev->cap.frameBuffer = HAL_DisplayBuffer_Request(&s_DisplayBufferQueue);
     dev->cap.callback    = callback;
 
     BOARD_InitElcdifRk024hh298Resource();
@@ -185,13 +204,17 @@ hal_display_status_t HAL_DisplayDev_LcdifRk024hh2_Start(const display_dev_t *dev
 hal_display_status_t HAL_DisplayDev_LcdifRk024hh2_Blit(const display_dev_t *dev, void *frame, int width, int height)
 {
     hal_display_status_t ret = kStatus_HAL_DisplayNonBlocking;
+    void *next;
     LOGI("++display_dev_blit");
 
     if (frame != NULL)
     {
-        s_NewBufferSet        = true;
-        s_pCurrentFrameBuffer = frame;
-        ELCDIF_SetNextBufferAddr(DISPLAY_LCDIF_BASE, (uint32_t)frame);
+        /* the frame is switched on at the next frame done, the next buffer is requested when one is switched off */
+        next = HAL_DisplayBuffer_Submit(&s_DisplayBufferQueue, frame);
+        if ((next != NULL) && (dev->cap.callback != NULL))
+        {
+            dev->cap.callback(dev, kDisplayEvent_RequestFrame, next, 0);
+        }
     }
 
     LOGI("--display_dev_blit");
@@ -233,7 +256,6 @@ static hal_display_status_t HAL_DisplayDev_LcdifRk024hh2_InputNotify(const displ
     {
         event_common_t event             = *(event_common_t *)data;
         s_DisplayDev_Lcdif.cap.srcFormat = event.displayOutput.displayOutputSource;
-        s_NewBufferSet                   = true;
         if (eventBase.respond != NULL)
         {
             eventBase.respond(eventBase.eventId, &event.displayOutput, event_response_status, true);
@@ -279,23 +301,14 @@ void DISPLAY_LCDIF_IRQHandler(void)
         }
     }
 
-    if (intStatus & kELCDIF_CurFrameDone && s_NewBufferSet == true)
+    if (intStatus & kELCDIF_CurFrameDone)
     {
-        if (s_DisplayDev_Lcdif.cap.callback != NULL)
-        {
-            s_NewBufferSet  = false;
-            uint8_t fromISR = __get_IPSR();
+        /* the next buffer address was loaded, the pending frame is on the screen */
+        void *next = HAL_DisplayBuffer_SwitchDone(&s_DisplayBufferQueue);
 
-            if (s_pCurrentFrameBuffer == (uint8_t *)&s_FrameBuffers[0])
-            {
-                s_DisplayDev_Lcdif.cap.callback(&s_DisplayDev_Lcdif, kDisplayEvent_RequestFrame, &s_FrameBuffers[1],
-                                                fromISR);
-            }
-            else if (s_pCurrentFrameBuffer == (uint8_t *)&s_FrameBuffers[1])
-            {
-                s_DisplayDev_Lcdif.cap.callback(&s_DisplayDev_Lcdif, kDisplayEvent_RequestFrame, &s_FrameBuffers[0],
-                                                fromISR);
-            }
+        if ((next != NULL) && (s_DisplayDev_Lcdif.cap.callback != NULL))
+        {
+            s_DisplayDev_Lcdif.cap.callback(&s_DisplayDev_Lcdif, kDisplayEvent_RequestFrame, next, __get_IPSR());
         }
     }
 }
@@ -21,6 +21,7 @@
 #include "fwk_log.h"
 #include "fwk_message.h"
 #include "fwk_display_manager.h"
+#include "hal_display_buffer.h"
 #include "hal_display_dev.h"
 
 #if 0
@@ -89,7 +90,8 @@ AT_NONCACHEABLE_SECTION_ALIGN(
 
 static volatile bool s_newFrameShown = false;
 static dc_fb_info_t s_fbInfo;
-static volatile uint8_t s_lcdActiveFbIdx;
+static display_buffer_queue_t s_DisplayBufferQueue;
+static display_dev_t s_DisplayDev_Lcdif;
 
 #include "fsl_soc_src.h"
 
@@ -107,10 +109,23 @@ static void BOARD_ResetDisplayMix(void)
     }
 }
 
+static void DISPLAY_ProgramFrameBuffer(void *frame)
+{
+    g_dc.ops->setFrameBuffer(&g_dc, 0, frame);
+}
+
 static void DISPLAY_BufferSwitchOffCallback(void *param, void *switchOffBuffer)
 {
+    void *next;
+
     s_newFrameShown = true;
-    s_lcdActiveFbIdx ^= 1;
+
+    /* the pending frame is on the screen, the switched off buffer can be rendered again */
+    next = HAL_DisplayBuffer_SwitchDone(&s_DisplayBufferQueue);
+    if ((next != NULL) && (s_DisplayDev_Lcdif.cap.callback != NULL))
+    {
+        s_DisplayDev_Lcdif.cap.callback(&s_DisplayDev_Lcdif, kDisplayEvent_RequestFrame, next, __get_IPSR());
+    }
 }
 
 static void DISPLAY_InitDisplay(void)
@@ -138,9 +153,9 @@ static void DISPLAY_InitDisplay(void)
 
     g_dc.ops->setCallback(&g_dc, 0, DISPLAY_BufferSwitchOffCallback, NULL);
 
-    s_lcdActiveFbIdx = 0;
-    s_newFrameShown  = false;
-    g_dc.ops->setFrameBuffer(&g_dc, 0, s_LcdBuffer[s_lcdActiveFbIdx]);
+    /* the first buffer is on the screen, see HAL_DisplayBuffer_Init */
+    s_newFrameShown = false;
+    g_dc.ops->setFrameBuffer(&g_dc, 0, s_LcdBuffer[0]);
 
     /* For the DBI interface display, application must wait for the first
      * frame buffer sent to the panel.
@@ -149,6 +164,7 @@ static void DISPLAY_InitDisplay(void)
     {
         while (s_newFrameShown == false)
         {
+            vTaskDelay(1);
         }
     }
 
@@ -161,13 +177,22 @@ hal_display_status_t HAL_DisplayDev_Lcdifv2Rk055ah_Init(
     display_dev_t *dev, int width, int height, display_dev_callback_t callback, void *param)
 {
     hal_display_status_t ret = kStatus_HAL_DisplaySuccess;
+    uint8_t *buffers[DISPLAY_DEV_Lcdifv2Rk055ah_BUFFER_COUNT];
     LOGD("++HAL_DisplayDev_Lcdifv2Rk055ah_Init");
 
     memset(s_LcdBuffer, 0x0, sizeof(s_LcdBuffer));
 
+    for (int i = 0; i < DISPLAY_DEV_Lcdifv2Rk055ah_BUFFER_COUNT; i++)
+    {
+        buffers[i] = (uint8_t *)s_LcdBuffer[i];
+    }
+    HAL_DisplayBuffer_Init(&s_DisplayBufferQueue, DISPLAY_NAME, dev->id, buffers,
+                           DISPLAY_DEV_Lcdifv2Rk055ah_BUFFER_COUNT, DISPLAY_ProgramFrameBuffer);
+
     dev->cap.width       = width;
     dev->cap.height      = height;
-    dev->cap.frameBuffer = (void *)s_LcdBuffer[0];
+    dev->cap.frameBuffer = HAL_DisplayBuffer_Request(&s_DisplayBufferQueue);
+    dev->cap.callback    = callback;
 
     BOARD_ResetDisplayMix();
     LOGD("--HAL_DisplayDev_Lcdifv2Rk055ah_Init");
@@ -191,10 +216,18 @@ hal_display_status_t HAL_DisplayDev_Lcdifv2Rk055ah_Start(const display_dev_t *de
 
 hal_display_status_t HAL_DisplayDev_Lcdifv2Rk055ah_Blit(const display_dev_t *dev, void *frame, int width, int height)
 {
-    hal_display_status_t ret = kStatus_HAL_DisplaySuccess;
+    hal_display_status_t ret = kStatus_HAL_DisplayNonBlocking;
+    void *next;
     LOGI("++HAL_DisplayDev_Lcdifv2Rk055ah_Blit");
     // draw_welcome(frame);
-    g_dc.ops->setFrameBuffer(&g_dc, 0, frame);
+
+    /* the frame is switched on at the next vsync, the next buffer is requested when one is switched off */
+    next = HAL_DisplayBuffer_Submit(&s_DisplayBufferQueue, frame);
+    if ((next != NULL) && (dev->cap.callback != NULL))
+    {
+        dev->cap.callback(dev, kDisplayEvent_RequestFrame, next, 0);
+    }
+
     LOGI("--HAL_DisplayDev_Lcdifv2Rk055ah_Blit");
     return ret;
 }
@@ -79,6 +79,7 @@ static void _LvglTask(void *param)
     g_LvglInitialized = true;
 
     setup_imgs((unsigned char *)APP_LVGL_IMGS_BASE);
+    custom_setup_imgs((unsigned char *)APP_LVGL_IMGS_BASE);
 #if AQT_TEST
     gui_set_standby();
 #else
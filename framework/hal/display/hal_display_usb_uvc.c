@@ -47,24 +47,58 @@
 /*******************************************************************************
  * Defines
  ******************************************************************************/
-#define CLIP(X) ((X) > 255 ? 255 : (X) < 0 ? 0 : X)
-
 #define DISPLAY_NAME "usb_uvc"
 
 #define RGB565_RED   0xf800
 #define RGB565_GREEN 0x07e0
 #define RGB565_BLUE  0x001f
 
-uint16_t colors[] = {RGB565_RED, RGB565_GREEN, RGB565_BLUE};
-uint16_t *rgb565iamge;
+/*
+ * BT.601 RGB to YUV coefficients in Q8, two of them packed per word for the dual 16-bit multiply accumulate.
+ * The low half is applied to R and the high half to G, B is handled separately.
+ */
+#define UVC_COEF_PAIR(r, g) ((uint32_t)(uint16_t)(int16_t)(r) | ((uint32_t)(uint16_t)(int16_t)(g) << 16))
+#define UVC_Y_RG            UVC_COEF_PAIR(66, 129)
+#define UVC_U_RG            UVC_COEF_PAIR(-38, -74)
+#define UVC_V_RG            UVC_COEF_PAIR(112, -94)
+#define UVC_Y_B             25
+#define UVC_U_B             112
+#define UVC_V_B             (-18)
+
+/* acc + rg.low * coef.low + rg.high * coef.high, with signed 16-bit halves */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define UVC_DOT2(rg, coef, acc) ((int32_t)__SMLAD((rg), (coef), (uint32_t)(acc)))
+#else
+#define UVC_DOT2(rg, coef, acc)                                  \
+    ((acc) + (int16_t)((rg)&0xFFFF) * (int16_t)((coef)&0xFFFF) + \
+     (int16_t)((rg) >> 16) * (int16_t)((coef) >> 16))
+#endif
 
-// RGB -> YUV
-#define RGB2Y(R, G, B) CLIP(((66 * (R) + 129 * (G) + 25 * (B) + 128) >> 8) + 16)
-#define RGB2U(R, G, B) CLIP(((-38 * (R)-74 * (G) + 112 * (B) + 128) >> 8) + 128)
-#define RGB2V(R, G, B) CLIP(((112 * (R)-94 * (G)-18 * (B) + 128) >> 8) + 128)
+/*
+ * LCD input frame buffer is RGB565, converted by PXP.
+ * With DISPLAY_USB_UVC_PXP_OUTPUT the PXP writes the UYVY frame streamed over USB instead, which removes the CPU
+ * conversion. The PXP blends the RGB565 overlay without color space conversion in that mode, so it needs a camera
+ * only preview without overlay.
+ */
+#ifndef DISPLAY_USB_UVC_PXP_OUTPUT
+#define DISPLAY_USB_UVC_PXP_OUTPUT 0
+#endif
 
-/* LCD input frame buffer is RGB565, converted by PXP. */
+#if DISPLAY_USB_UVC_PXP_OUTPUT
+#define DISPLAY_USB_BUFFER_COUNT 1
+#else
 #define DISPLAY_USB_BUFFER_COUNT 2
+#endif
+
+#define DISPLAY_USB_FRAME_SIZE                                                                                \
+    (USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_HEIGHT * USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_WIDTH * \
+     USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_DATA_BITS)
+
+/*
+ * Room kept in front of each frame for the payload header of the first packet. The headers of the next packets are
+ * written over the tail of the packet sent before, so the USB controller sends the packets straight from the frame.
+ */
+#define DISPLAY_USB_HEADER_ROOM FRAME_BUFFER_ALIGN
 
 #define DEBUG_UVC 0
 
@@ -108,13 +142,17 @@ usb_device_class_config_struct_t g_UsbDeviceVideoConfig[1] = {{
 
 /*TODO Camera needs to be scaled */
 AT_NONCACHEABLE_SECTION_ALIGN(
-    static uint8_t s_usbBuffer[DISPLAY_USB_BUFFER_COUNT][USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_HEIGHT]
-                              [USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_WIDTH *
-                               USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_DATA_BITS],
+    static uint8_t s_usbBuffer[DISPLAY_USB_BUFFER_COUNT][DISPLAY_USB_HEADER_ROOM + DISPLAY_USB_FRAME_SIZE],
     FRAME_BUFFER_ALIGN);
 
+/* frame being streamed */
+static uint8_t *s_StreamFrame = &s_usbBuffer[DISPLAY_USB_BUFFER_COUNT - 1][DISPLAY_USB_HEADER_ROOM];
+
 static SemaphoreHandle_t s_DisplayFull, s_DisplayEmpty;
 
+/* the last packet of the frame is prepared, the frame is released once this packet is sent */
+static volatile uint8_t s_StreamFrameReleasePending = 0U;
+
 const static display_dev_operator_t s_DisplayDev_UsbUVCOps = {
     .init        = HAL_DisplayDev_UsbUvc_Init,
     .deinit      = HAL_DisplayDev_UsbUvc_Uninit,
@@ -135,50 +173,70 @@ static display_dev_t s_DisplayDev_UsbUVC = {.id   = 0,
                                                     .right     = USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_WIDTH - 1,
                                                     .bottom    = USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_HEIGHT - 1,
                                                     .rotate    = 0,
+#if DISPLAY_USB_UVC_PXP_OUTPUT
+                                                    .format    = kPixelFormat_UYVY1P422_RGB,
+#else
                                                     .format    = kPixelFormat_RGB565,
+#endif
                                                     .srcFormat = kPixelFormat_UYVY1P422_RGB,
                                                     .frameBuffer = NULL,
                                                     .callback    = NULL,
                                                     .param       = NULL}};
 
-static void RGB5652YUV(uint16_t source1, uint16_t source2, uint16_t *dest1, uint16_t *dest2)
+#if !DISPLAY_USB_UVC_PXP_OUTPUT
+/* Convert two RGB565 pixels to U, Y0, V, Y1, the chroma is the one of the average of the two pixels */
+static inline uint32_t _HAL_DisplayDev_UsbUvc_RGB565ToUYVY(uint32_t pixels)
 {
-    uint8_t R, G, B, Y0, Y1, U0, V0, U1, V1;
-    R      = ((source1 & RGB565_RED) >> 11) << 3;
-    G      = ((source1 & RGB565_GREEN) >> 5) << 2;
-    B      = ((source1 & RGB565_BLUE)) << 3;
-    Y0     = RGB2Y(R, G, B);
-    U0     = RGB2U(R, G, B);
-    V0     = RGB2V(R, G, B);
-    R      = ((source2 & RGB565_RED) >> 11) << 3;
-    G      = ((source2 & RGB565_GREEN) >> 5) << 2;
-    B      = ((source2 & RGB565_BLUE)) << 3;
-    Y1     = RGB2Y(R, G, B);
-    U1     = RGB2U(R, G, B);
-    V1     = RGB2V(R, G, B);
-    U0     = (U0 + U1) / 2;
-    V0     = (V0 + V1) / 2;
-    *dest2 = (Y1 << 8) | V0;
-    *dest1 = (Y0 << 8) | U0;
+    uint32_t rg0 = ((pixels >> 8) & 0xF8) | ((pixels << 13) & 0xFC0000);
+    uint32_t rg1 = ((pixels >> 24) & 0xF8) | ((pixels >> 3) & 0xFC0000);
+    int32_t b0   = (pixels << 3) & 0xF8;
+    int32_t b1   = (pixels >> 13) & 0xF8;
+    uint32_t rg  = rg0 + rg1;
+    int32_t b    = b0 + b1;
+    int32_t y0   = (UVC_DOT2(rg0, UVC_Y_RG, UVC_Y_B * b0 + 128) >> 8) + 16;
+    int32_t y1   = (UVC_DOT2(rg1, UVC_Y_RG, UVC_Y_B * b1 + 128) >> 8) + 16;
+    int32_t u    = (UVC_DOT2(rg, UVC_U_RG, UVC_U_B * b + 256) >> 9) + 128;
+    int32_t v    = (UVC_DOT2(rg, UVC_V_RG, UVC_V_B * b + 256) >> 9) + 128;
+
+    /* BT.601 keeps the results in the 16..240 range, no clipping needed */
+    return (uint32_t)u | ((uint32_t)y0 << 8) | ((uint32_t)v << 16) | ((uint32_t)y1 << 24);
 }
 
-static void ConvertRGB2YUV(uint16_t *sourceLcdBuffer, uint16_t *destLcdBuffer, int width, int height)
+static void _HAL_DisplayDev_UsbUvc_ConvertRGB565ToUYVY(const uint32_t *pSrc, uint32_t *pDst, int width, int height)
 {
-    int line, col;
+    /* one word holds two pixels */
+    int count = (width / 2) * height;
 
-    for (line = 0; line < height; line++)
-        for (col = 0; col < width - 1; col = col + 2)
-        {
 #if DEBUG_UVC
-            RGB5652YUV(RGB565_RED, RGB565_RED, (destLcdBuffer + line * width + col),
-                       (destLcdBuffer + line * width + col + 1));
+    uint32_t red = _HAL_DisplayDev_UsbUvc_RGB565ToUYVY((RGB565_RED << 16) | RGB565_RED);
+    while (count--)
+    {
+        *pDst++ = red;
+    }
 #else
+    while (count >= 4)
+    {
+        uint32_t p0 = pSrc[0];
+        uint32_t p1 = pSrc[1];
+        uint32_t p2 = pSrc[2];
+        uint32_t p3 = pSrc[3];
+
+        pDst[0] = _HAL_DisplayDev_UsbUvc_RGB565ToUYVY(p0);
+        pDst[1] = _HAL_DisplayDev_UsbUvc_RGB565ToUYVY(p1);
+        pDst[2] = _HAL_DisplayDev_UsbUvc_RGB565ToUYVY(p2);
+        pDst[3] = _HAL_DisplayDev_UsbUvc_RGB565ToUYVY(p3);
+        pSrc += 4;
+        pDst += 4;
+        count -= 4;
+    }
 
-            RGB5652YUV(*(sourceLcdBuffer + line * width + col), *(sourceLcdBuffer + line * width + col + 1),
-                       (destLcdBuffer + line * width + col), (destLcdBuffer + line * width + col + 1));
+    for (; count > 0; count--)
+    {
+        *pDst++ = _HAL_DisplayDev_UsbUvc_RGB565ToUYVY(*pSrc++);
+    }
 #endif
-        }
 }
+#endif /* !DISPLAY_USB_UVC_PXP_OUTPUT */
 
 /* Prepare next transfer payload */
 static void USB_DeviceVideoPrepareVideoData(void)
@@ -186,6 +244,9 @@ static void USB_DeviceVideoPrepareVideoData(void)
     usb_device_video_mjpeg_payload_header_struct_t *payloadHeader;
     uint32_t maxPacketSize;
 
+    /* packets without data are sent from the image buffer */
+    s_UsbDeviceVideoVirtualCamera.imageBuffer = s_ImageBuffer;
+
     payloadHeader = (usb_device_video_mjpeg_payload_header_struct_t *)&s_UsbDeviceVideoVirtualCamera.imageBuffer[0];
     memset(payloadHeader, 0, sizeof(usb_device_video_mjpeg_payload_header_struct_t));
     payloadHeader->bHeaderLength                = sizeof(usb_device_video_mjpeg_payload_header_struct_t);
@@ -205,6 +266,22 @@ static void USB_DeviceVideoPrepareVideoData(void)
             USB_LONG_FROM_LITTLE_ENDIAN_DATA(s_UsbDeviceVideoVirtualCamera.commitStruct->dwMaxPayloadTransferSize);
     }
 
+    if (s_StreamFrameReleasePending)
+    {
+        /* called from the transfer complete of the last packet, the frame is not read by the USB controller anymore */
+        s_StreamFrameReleasePending = 0U;
+
+        // Frame send
+        xSemaphoreGiveFromISR(s_DisplayEmpty, NULL);
+
+        // Tell Display manager that the frame was sent
+        if (s_DisplayDev_UsbUVC.cap.callback != NULL)
+        {
+            uint8_t fromISR = __get_IPSR();
+            s_DisplayDev_UsbUVC.cap.callback(&s_DisplayDev_UsbUVC, kDisplayEvent_RequestFrame, NULL, fromISR);
+        }
+    }
+
     if (s_UsbDeviceVideoVirtualCamera.waitForNewInterval)
     {
         if (xSemaphoreTakeFromISR(s_DisplayFull, NULL) == pdFALSE)
@@ -232,14 +309,10 @@ static void USB_DeviceVideoPrepareVideoData(void)
         }
     }
 
-    if (s_UsbDeviceVideoVirtualCamera.imageIndex < USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_HEIGHT *
-                                                       USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_WIDTH *
-                                                       USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_DATA_BITS)
+    if (s_UsbDeviceVideoVirtualCamera.imageIndex < DISPLAY_USB_FRAME_SIZE)
     {
-        uint32_t sendLength = USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_HEIGHT *
-                                  USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_WIDTH *
-                                  USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_DATA_BITS -
-                              s_UsbDeviceVideoVirtualCamera.imageIndex;
+        uint32_t sendLength = DISPLAY_USB_FRAME_SIZE - s_UsbDeviceVideoVirtualCamera.imageIndex;
+        uint8_t *pPacket;
         maxPacketSize -= sizeof(usb_device_video_mjpeg_payload_header_struct_t);
 
         if (sendLength > maxPacketSize)
@@ -247,29 +320,21 @@ static void USB_DeviceVideoPrepareVideoData(void)
             sendLength = maxPacketSize;
         }
 
-        /* TODO */
-        /* If frames are in a not cached area try without memcpy or try to invalidate cache before*/
-
-        memcpy((&s_UsbDeviceVideoVirtualCamera.imageBuffer[0] + sizeof(usb_device_video_mjpeg_payload_header_struct_t)),
-               (uint8_t *)((uint8_t *)s_usbBuffer[1] + s_UsbDeviceVideoVirtualCamera.imageIndex), sendLength);
-        s_UsbDeviceVideoVirtualCamera.imageBuffer = (uint8_t *)payloadHeader;
+        /*
+         * The frame is in a non cacheable area, the header is written in front of the packet data, over the tail of
+         * the previous packet which is already sent, and the packet goes out of the frame without any copy.
+         */
+        pPacket = s_StreamFrame + s_UsbDeviceVideoVirtualCamera.imageIndex -
+                  sizeof(usb_device_video_mjpeg_payload_header_struct_t);
+        memcpy(pPacket, payloadHeader, sizeof(usb_device_video_mjpeg_payload_header_struct_t));
+        s_UsbDeviceVideoVirtualCamera.imageBuffer = pPacket;
         s_UsbDeviceVideoVirtualCamera.imageIndex += sendLength;
         s_UsbDeviceVideoVirtualCamera.imageBufferLength += sendLength;
 
-        if (s_UsbDeviceVideoVirtualCamera.imageIndex >=
-            (USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_HEIGHT * USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_WIDTH *
-             USB_VIDEO_VIRTUAL_CAMERA_UNCOMPRESSED_FRAME_DATA_BITS))
+        if (s_UsbDeviceVideoVirtualCamera.imageIndex >= DISPLAY_USB_FRAME_SIZE)
         {
-            // Frame send
-            xSemaphoreGiveFromISR(s_DisplayEmpty, NULL);
-
-            // Tell Display manager that the frame was sent
-            if (s_DisplayDev_UsbUVC.cap.callback != NULL)
-            {
-                uint8_t fromISR = __get_IPSR();
-                s_DisplayDev_UsbUVC.cap.callback(&s_DisplayDev_UsbUVC, kDisplayEvent_RequestFrame, NULL, fromISR);
-            }
-
+            /* the packet is still to be sent from the frame, the next Blit must not write it yet */
+            s_StreamFrameReleasePending                      = 1U;
             s_UsbDeviceVideoVirtualCamera.waitForNewInterval = 1U;
         }
     }
@@ -598,7 +663,7 @@ static usb_status_t USB_DeviceCallback(usb_device_handle handle, uint32_t event,
             USB_DeviceVideoApplicationSetDefault();
             s_UsbDeviceVideoVirtualCamera.attach               = 0U;
             s_UsbDeviceVideoVirtualCamera.currentConfiguration = 0U;
-#if (defined(USB_DEVICE_CONFIG_EHCI) && (USB_DEVICE_CONFIG_EHCI > 0U)) || \
+#if (defined(USB_DEVICE_CONFIG_EHCI) && (USB_DEVICE_CONFIG_EHCI > 0U)) ||            \
     (defined(USB_DEVICE_CONFIG_LPCIP3511HS) && (USB_DEVICE_CONFIG_LPCIP3511HS > 0U))
 
             /* Get USB speed to configure the device, including max packet size and interval of the endpoints. */
@@ -712,7 +777,7 @@ static hal_display_status_t HAL_DisplayDev_UsbUvc_Init(
     hal_display_status_t ret = kStatus_HAL_DisplaySuccess;
     dev->cap.width           = width;
     dev->cap.height          = height;
-    dev->cap.frameBuffer     = (void *)s_usbBuffer[0];
+    dev->cap.frameBuffer     = (void *)&s_usbBuffer[0][DISPLAY_USB_HEADER_ROOM];
     dev->cap.callback        = callback;
 
     s_DisplayFull  = xSemaphoreCreateCounting(1, 0);
@@ -771,7 +836,12 @@ static hal_display_status_t HAL_DisplayDev_UsbUvc_Blit(const display_dev_t *dev,
     }
     else
     {
-        ConvertRGB2YUV((uint16_t *)frame, (uint16_t *)s_usbBuffer[1], width, height);
+#if DISPLAY_USB_UVC_PXP_OUTPUT
+        /* the PXP already wrote the UYVY frame */
+        s_StreamFrame = (uint8_t *)frame;
+#else
+        _HAL_DisplayDev_UsbUvc_ConvertRGB565ToUYVY((uint32_t *)frame, (uint32_t *)s_StreamFrame, width, height);
+#endif
         xSemaphoreGive(s_DisplayFull);
         LOGI("Time after conversion = %d", Time_Current());
         ret = kStatus_HAL_DisplayNonBlocking;
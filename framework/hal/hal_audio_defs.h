@@ -22,9 +22,14 @@
 #define AUDIO_PCM_SAMPLE_SIZE_BYTES    (4U) /* 32bit depth */
 #define AUDIO_PCM_SAMPLE_COUNT         (AUDIO_PCM_SINGLE_CH_SMPL_COUNT * AUDIO_PDM_MIC_COUNT)
 #define AUDIO_PCM_BUFFER_SIZE          (AUDIO_PCM_SAMPLE_COUNT * AUDIO_PCM_SAMPLE_SIZE_BYTES)
-#define AUDIO_PCM_BUFFER_COUNT         (2U)
 #define AUDIO_PCM_SAMPLE_RATE          (16000U) /*!< Sample rate 16kHz */
 
+/* Number of microphone DMA buffers, each one holds 10 ms. The audio processing task can be late by
+ * AUDIO_PCM_BUFFER_COUNT - 1 buffers before samples are lost. */
+#ifndef AUDIO_PCM_BUFFER_COUNT
+#define AUDIO_PCM_BUFFER_COUNT (4U)
+#endif /* AUDIO_PCM_BUFFER_COUNT */
+
 /*******************************************************************************
  * AFE / ASR Definitions
  ******************************************************************************/
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief CRC32 declaration.
+ * CRC32 of the transfer units exchanged with the host tools and the BLE firmware. Start from 0 and update with each
+ * part of the data, the result is the standard CRC-32 (IEEE 802.3) of the whole data.
+ */
+
+#ifndef _HAL_CRC32_H_
+#define _HAL_CRC32_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Update a CRC32 with more data
+ * @param crc CRC32 of the previous data, 0 for the first part
+ * @param data data to add
+ * @param size size of the data in bytes
+ * @return the CRC32 including data
+ */
+uint32_t HAL_Crc32_Update(uint32_t crc, const void *data, size_t size);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_CRC32_H_ */
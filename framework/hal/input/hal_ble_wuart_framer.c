@@ -0,0 +1,246 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief BLE wireless UART framer implementation.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "fwk_log.h"
+#include "hal_ble_wuart_framer.h"
+#include "hal_crc32.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static const uint8_t TU_MAGIC[] = {0x53, 0x79, 0x4c};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static int _HAL_BleWuartFramer_ParseHeader(ble_wuart_framer_t *framer)
+{
+    uint8_t *headerBuf                  = framer->header;
+    hal_header_transfer_unit_t *pHtUnit = &framer->htUnit;
+    uint32_t crc_res                    = 0;
+
+    /* transfer magic */
+    if (memcmp(headerBuf, TU_MAGIC, sizeof(TU_MAGIC)) != 0)
+    {
+        LOGD("HEADER PACKET PARSE FAILED: magic.");
+        return -1;
+    }
+    memcpy(pHtUnit->tuMagic, headerBuf, 3);
+
+    /* packet type */
+    pHtUnit->pktType = headerBuf[3];
+
+    /* packet length */
+    pHtUnit->pktLen = *((uint32_t *)(headerBuf + 4));
+
+    /* packet id */
+    pHtUnit->pktId = *((uint32_t *)(headerBuf + 8));
+
+    /* packet crc */
+    pHtUnit->pktCrc = *((uint32_t *)(headerBuf + 12));
+
+    /* packet reserved */
+    pHtUnit->reserved = *((uint32_t *)(headerBuf + 16));
+
+    /* transfer unit crc */
+    pHtUnit->tuCrc = *((uint32_t *)(headerBuf + 20));
+    crc_res        = HAL_Crc32_Update(0, headerBuf, BLE_WUART_HEADER_LENGTH - 4);
+    if (crc_res != pHtUnit->tuCrc)
+    {
+        LOGD("HEADER PACKET PARSE FAILED: CRC32.");
+        return -1;
+    }
+
+    /* the payload has to fit in a packet buffer */
+    if (pHtUnit->pktLen > framer->maxPacketSize)
+    {
+        LOGD("HEADER PACKET PARSE FAILED: length %d.", pHtUnit->pktLen);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Drop the first bytes of the header buffer until it starts with the transfer unit magic. */
+static void _HAL_BleWuartFramer_Resync(ble_wuart_framer_t *framer, uint32_t drop)
+{
+    while (framer->headerLen > 0)
+    {
+        uint32_t cmpLen = (framer->headerLen < sizeof(TU_MAGIC)) ? framer->headerLen : sizeof(TU_MAGIC);
+
+        if ((drop == 0) && (memcmp(framer->header, TU_MAGIC, cmpLen) == 0))
+        {
+            break;
+        }
+
+        drop = 0;
+        framer->headerLen--;
+        framer->discardedBytes++;
+        memmove(framer->header, framer->header + 1, framer->headerLen);
+    }
+}
+
+static void _HAL_BleWuartFramer_HeaderComplete(ble_wuart_framer_t *framer)
+{
+    if (_HAL_BleWuartFramer_ParseHeader(framer) != 0)
+    {
+        /* the magic was part of the payload or the header is corrupted, look for the next magic in it */
+        framer->headerErrors++;
+        _HAL_BleWuartFramer_Resync(framer, 1);
+        return;
+    }
+
+    framer->headerLen = 0;
+    framer->dataLen   = 0;
+    framer->dataCrc   = 0;
+    framer->payload   = framer->ops->alloc();
+    framer->stage     = kHALBLEWUARTPacket_Data;
+    if (framer->payload == NULL)
+    {
+        /* all the buffers are held, drop the packet but stay in sync with the stream */
+        LOGE("[BleWirelessUartTask]: no free packet slot, packet %d dropped.", framer->htUnit.pktId);
+        framer->droppedPackets++;
+        framer->stage = kHALBLEWUARTPacket_Skip;
+    }
+}
+
+static void _HAL_BleWuartFramer_DataComplete(ble_wuart_framer_t *framer)
+{
+    uint8_t *payload = framer->payload;
+
+    framer->payload = NULL;
+    framer->stage   = kHALBLEWUARTPacket_Header;
+
+    if (payload == NULL)
+    {
+        return;
+    }
+
+    if (framer->dataCrc == framer->htUnit.pktCrc)
+    {
+        framer->packets++;
+        framer->ops->packet(payload, &framer->htUnit);
+    }
+    else
+    {
+        /* Bytes were lost, the payload may hold the start of the following packets, from its first byte when the whole
+         * payload was lost. Parse it again as headers, the buffer is still held so the packets found in it get another
+         * buffer. */
+        LOGD("DATA PACKET PARSE FAILED[%d].", framer->htUnit.pktLen);
+        framer->dataErrors++;
+        HAL_BleWuartFramer_Feed(framer, payload, framer->dataLen);
+    }
+
+    framer->ops->release(payload);
+}
+
+void HAL_BleWuartFramer_Init(ble_wuart_framer_t *framer, uint32_t maxPacketSize, const ble_wuart_framer_ops_t *ops)
+{
+    memset(framer, 0, sizeof(ble_wuart_framer_t));
+    framer->stage         = kHALBLEWUARTPacket_Header;
+    framer->maxPacketSize = maxPacketSize;
+    framer->ops           = ops;
+}
+
+void HAL_BleWuartFramer_Feed(ble_wuart_framer_t *framer, const uint8_t *data, uint32_t len)
+{
+    while (len > 0)
+    {
+        switch (framer->stage)
+        {
+            case kHALBLEWUARTPacket_Header:
+            {
+                framer->header[framer->headerLen++] = *data++;
+                len--;
+
+                _HAL_BleWuartFramer_Resync(framer, 0);
+                if (framer->headerLen == BLE_WUART_HEADER_LENGTH)
+                {
+                    _HAL_BleWuartFramer_HeaderComplete(framer);
+                }
+            }
+            break;
+
+            case kHALBLEWUARTPacket_Data:
+            case kHALBLEWUARTPacket_Skip:
+            {
+                uint32_t count = framer->htUnit.pktLen - framer->dataLen;
+                if (count > len)
+                {
+                    count = len;
+                }
+
+                if (framer->payload != NULL)
+                {
+                    memcpy(&framer->payload[framer->dataLen], data, count);
+                    framer->dataCrc = HAL_Crc32_Update(framer->dataCrc, data, count);
+                }
+                framer->dataLen += count;
+                data += count;
+                len -= count;
+            }
+            break;
+
+            default:
+                framer->stage = kHALBLEWUARTPacket_Header;
+                break;
+        }
+
+        /* a packet without payload is complete with its header */
+        if ((framer->stage != kHALBLEWUARTPacket_Header) && (framer->dataLen == framer->htUnit.pktLen))
+        {
+            _HAL_BleWuartFramer_DataComplete(framer);
+        }
+    }
+}
+
+void HAL_BleWuartFramer_CreateHeader(
+    uint8_t *header, const uint8_t *data, uint32_t len, uint8_t type, uint32_t pktId, uint32_t result)
+{
+    uint32_t crc_res = 0;
+
+    /* transfer magic */
+    memcpy(header, TU_MAGIC, sizeof(TU_MAGIC));
+
+    /* packet type */
+    header[3] = type;
+
+    /* packet length */
+    *((uint32_t *)(header + 4)) = len;
+
+    /* packet id */
+    *((uint32_t *)(header + 8)) = pktId;
+
+    if (len > 0)
+    {
+        /* packet crc */
+        crc_res                      = HAL_Crc32_Update(0, data, len);
+        *((uint32_t *)(header + 12)) = crc_res;
+    }
+    else
+    {
+        *((uint32_t *)(header + 12)) = 0;
+    }
+
+    /* packet reserved */
+    *((uint32_t *)(header + 16)) = result;
+
+    /* transfer unit crc */
+    crc_res                      = HAL_Crc32_Update(0, header, BLE_WUART_HEADER_LENGTH - 4);
+    *((uint32_t *)(header + 20)) = crc_res;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief BLE wireless UART framer declaration.
+ * Transfer units exchanged with the QN9090 BLE firmware: a 24 bytes header starting with the transfer unit magic and
+ * ending with its CRC32, followed by the payload whose CRC32 is in the header. The framer is fed with the bytes as they
+ * are received, resynchronizes on the next magic after lost or corrupted bytes and hands over the packets as they are
+ * found.
+ */
+
+#ifndef _HAL_BLE_WUART_FRAMER_H_
+#define _HAL_BLE_WUART_FRAMER_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define BLE_WUART_HEADER_LENGTH 24
+
+typedef enum _hal_ble_wuart_packet_t
+{
+    kHALBLEWUARTPacket_Header,
+    kHALBLEWUARTPacket_Data,
+    kHALBLEWUARTPacket_Skip,
+} hal_ble_wuart_packet_t;
+
+typedef struct _hal_header_transfer_unit_t
+{
+    uint8_t tuMagic[3];
+    uint8_t pktType;
+    uint32_t pktLen;
+    uint32_t pktId;
+    uint32_t pktCrc;
+    uint32_t tuCrc;
+    uint32_t reserved;
+} hal_header_transfer_unit_t;
+
+typedef struct _ble_wuart_framer_ops
+{
+    /* buffer of maxPacketSize bytes for the next payload, NULL drops the packet */
+    uint8_t *(*alloc)(void);
+    /* the framer is done with a payload buffer */
+    void (*release)(const uint8_t *data);
+    /* packet with a valid payload, the payload is only valid during the call unless the owner of the buffer keeps it */
+    void (*packet)(uint8_t *data, hal_header_transfer_unit_t *htUnit);
+} ble_wuart_framer_ops_t;
+
+typedef struct _ble_wuart_framer
+{
+    uint8_t stage;
+    uint8_t header[BLE_WUART_HEADER_LENGTH];
+    uint32_t headerLen;
+    hal_header_transfer_unit_t htUnit;
+    uint8_t *payload;
+    uint32_t maxPacketSize;
+    /* payload bytes received or skipped, and the CRC32 of the received ones */
+    uint32_t dataLen;
+    uint32_t dataCrc;
+    const ble_wuart_framer_ops_t *ops;
+
+    /* statistics */
+    uint32_t packets;
+    uint32_t headerErrors;
+    uint32_t dataErrors;
+    uint32_t droppedPackets;
+    uint32_t discardedBytes;
+} ble_wuart_framer_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init a framer
+ * @param framer framer to init
+ * @param maxPacketSize largest payload accepted, the size of the buffers given by ops->alloc
+ * @param ops payload buffers and packet handler
+ */
+void HAL_BleWuartFramer_Init(ble_wuart_framer_t *framer, uint32_t maxPacketSize, const ble_wuart_framer_ops_t *ops);
+
+/**
+ * @brief Run the framer on received bytes, the complete packets are handed over as they are found
+ * @param framer framer to feed
+ * @param data received bytes
+ * @param len number of bytes
+ */
+void HAL_BleWuartFramer_Feed(ble_wuart_framer_t *framer, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Build the header of a transfer unit
+ * @param header BLE_WUART_HEADER_LENGTH bytes, word aligned
+ * @param data payload
+ * @param len size of the payload
+ * @param type packet type
+ * @param pktId packet id
+ * @param result value of the reserved field, the result of a response
+ */
+void HAL_BleWuartFramer_CreateHeader(
+    uint8_t *header, const uint8_t *data, uint32_t len, uint8_t type, uint32_t pktId, uint32_t result);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_BLE_WUART_FRAMER_H_ */
@@ -27,6 +27,7 @@
 #include "fwk_input_manager.h"
 #include "fwk_output_manager.h"
 #include "fwk_lpm_manager.h"
+#include "hal_ble_wuart_framer.h"
 #include "hal_event_descriptor_face_rec.h"
 #include "hal_input_dev.h"
 #include "hal_smart_lock_config.h"
@@ -41,11 +42,19 @@
 
 #define BLE_WUART_QUEUE_LENGTH 5
 
-#define BLE_WUART_HEADER_LENGTH 24
 #define BLE_WUART_READY         "BLE-READY_"
 #define BLE_WUART_CONNECTED     "BLE-CONNECTED_"
 
-#define BLE_WUART_MINI_TRANS_UINT 24
+/* Largest payload accepted, a remote registration carries a name and a face feature */
+#ifndef BLE_WUART_PACKET_MAX_SIZE
+#define BLE_WUART_PACKET_MAX_SIZE 2048
+#endif /* BLE_WUART_PACKET_MAX_SIZE */
+
+/* One packet being received plus one held by a remote registration in progress */
+#define BLE_WUART_PACKET_POOL_CNT 2
+
+/* Bytes taken from the LPUART ring buffer at once */
+#define BLE_WUART_RX_CHUNK_SIZE 64
 
 typedef enum _hal_ble_connection_status_t
 {
@@ -65,12 +74,6 @@ typedef enum _hal_ble_wuart_status_t
     kHALBLEWUARTStatus_PacketShort,
 } hal_ble_wuart_status_t;
 
-typedef enum _hal_ble_wuart_packet_t
-{
-    kHALBLEWUARTPacket_Header,
-    kHALBLEWUARTPacket_Data,
-} hal_ble_wuart_packet_t;
-
 typedef struct _hal_ble_wuart_response_t
 {
     union
@@ -79,17 +82,6 @@ typedef struct _hal_ble_wuart_response_t
     };
 } hal_ble_wuart_response_t;
 
-typedef struct _hal_header_transfer_unit_t
-{
-    uint8_t tuMagic[3];
-    uint8_t pktType;
-    uint32_t pktLen;
-    uint32_t pktId;
-    uint32_t pktCrc;
-    uint32_t tuCrc;
-    uint32_t reserved;
-} hal_header_transfer_unit_t;
-
 typedef enum _hal_transfer_packet_type_t
 {
     AUTHENTICATION_REQ = 0,
@@ -119,8 +111,6 @@ typedef enum _hal_transfer_packet_type_t
     FIRMWARE_RESPONSE = 0xff,
 } hal_ble_transfer_packet_type_t;
 
-static const uint8_t TU_MAGIC[] = {0x53, 0x79, 0x4c};
-
 typedef enum _hal_wuart_ack_reserved_t
 {
     BLE_WUART_ACK_SUCCESS   = 0,
@@ -128,15 +118,12 @@ typedef enum _hal_wuart_ack_reserved_t
     BLE_WUART_ACK_ERROR     = -1, // 0xffffffffff
 } hal_wuart_ack_reserved_t;
 
-typedef struct _hal_ble_wuart_transfer_t
+typedef struct _hal_ble_wuart_packet_slot_t
 {
-    uint8_t *nibbleBuf;
-    uint8_t *packetBuf;
-    int nibbleLen;
-    int packetLen;
-    int readOffset;
-    uint8_t stage;
-} hal_ble_wuart_transfer_t;
+    /* held by the framer while the payload is received, and by the events pointing to the payload */
+    uint8_t refCount;
+    uint8_t data[BLE_WUART_PACKET_MAX_SIZE];
+} hal_ble_wuart_packet_slot_t;
 
 /*******************************************************************************
  * Prototypes
@@ -171,9 +158,11 @@ static uint8_t s_LpuartRingBuffer[512];
 static uint8_t s_QN9090IsConnected    = kHALBLEConnectionStatus_Invalid;
 static uint8_t s_QN9090MacAddress[18] = {0}; // ble mac address xx:xx:xx:xx:xx:xx
 
-static uint8_t s_BLEWUARTNibbleBuffer[BLE_WUART_MINI_TRANS_UINT];
-static hal_ble_wuart_transfer_t s_BLEWUARTTransfer;
-static hal_header_transfer_unit_t s_HeaderTransferUnit = {0};
+static hal_ble_wuart_packet_slot_t s_BLEWUARTPacketPool[BLE_WUART_PACKET_POOL_CNT];
+static uint8_t s_BLEWUARTRxChunk[BLE_WUART_RX_CHUNK_SIZE];
+static ble_wuart_framer_t s_BLEWUARTFramer;
+/* payload of the remote registration in progress */
+static const uint8_t *volatile s_BLEWUARTRegData = NULL;
 static event_face_rec_t s_BLEWUARTEvent;
 static input_event_t s_InputEvent;
 
@@ -209,9 +198,10 @@ static output_dev_t s_OutputDev_BLEWUARTQN9090 = {
 
 static hal_lpm_request_t s_LpmReq = {.dev = &s_InputDev_BLEWUARTQN9090, .name = "s_InputDev_BLEWUARTQN9090"};
 
-static uint32_t table[0x100];
 static uint32_t s_pckID;
 
+static void SLN_BLEWUARTPacketRelease(const uint8_t *data);
+
 static int HAL_InputDev_BleWuartQn9090_Respond(uint32_t eventId,
                                                void *response,
                                                event_status_t status,
@@ -298,7 +288,8 @@ static int HAL_InputDev_BleWuartQn9090_Respond(uint32_t eventId,
                 SLN_BLEWUARTSendPacket(NULL, 0, REGISTRATION_RES, s_pckID, BLE_WUART_ACK_ERROR);
             }
 
-            vPortFree(s_BLEWUARTEvent.remoteReg.regData);
+            SLN_BLEWUARTPacketRelease(s_BLEWUARTRegData);
+            s_BLEWUARTRegData = NULL;
 
             s_BLEWUARTEvent.remoteReg.regData      = NULL;
             s_BLEWUARTEvent.remoteReg.dataLen      = 0;
@@ -313,39 +304,63 @@ static int HAL_InputDev_BleWuartQn9090_Respond(uint32_t eventId,
     return 0;
 }
 
-static uint32_t crc32_for_byte(uint32_t r)
+static uint8_t *SLN_BLEWUARTPacketAlloc(void)
 {
-    for (int j = 0; j < 8; ++j)
+    hal_ble_wuart_packet_slot_t *slot = NULL;
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < BLE_WUART_PACKET_POOL_CNT; i++)
     {
-        r = (r & 1 ? 0 : (uint32_t)0xEDB88320L) ^ r >> 1;
+        if (s_BLEWUARTPacketPool[i].refCount == 0)
+        {
+            slot           = &s_BLEWUARTPacketPool[i];
+            slot->refCount = 1;
+            break;
+        }
     }
+    taskEXIT_CRITICAL();
 
-    return r ^ (uint32_t)0xFF000000L;
+    return (slot != NULL) ? slot->data : NULL;
 }
 
-static void crc32(const void *data, size_t numBytes, uint32_t *crc)
+static hal_ble_wuart_packet_slot_t *SLN_BLEWUARTPacketSlot(const uint8_t *data)
 {
-    memset(table, 0x00, sizeof(table));
-
-    if (!*table)
+    for (int i = 0; i < BLE_WUART_PACKET_POOL_CNT; i++)
     {
-        for (size_t i = 0; i < 0x100; ++i)
+        if (data == s_BLEWUARTPacketPool[i].data)
         {
-            table[i] = crc32_for_byte(i);
+            return &s_BLEWUARTPacketPool[i];
         }
     }
 
-    for (size_t i = 0; i < numBytes; ++i)
+    return NULL;
+}
+
+/* Keep a payload after the packet is dispatched, until SLN_BLEWUARTPacketRelease. */
+static void SLN_BLEWUARTPacketRetain(const uint8_t *data)
+{
+    hal_ble_wuart_packet_slot_t *slot = SLN_BLEWUARTPacketSlot(data);
+
+    if (slot != NULL)
     {
-        *crc = table[(uint8_t)*crc ^ ((uint8_t *)data)[i]] ^ *crc >> 8;
+        taskENTER_CRITICAL();
+        slot->refCount++;
+        taskEXIT_CRITICAL();
     }
 }
 
-static void LOGD_HEX(uint8_t *data, int len)
+static void SLN_BLEWUARTPacketRelease(const uint8_t *data)
 {
-    for (int i = 0; i < len; i++)
+    hal_ble_wuart_packet_slot_t *slot = SLN_BLEWUARTPacketSlot(data);
+
+    if (slot != NULL)
     {
-        LOGD("0x%2x ", data[i]);
+        taskENTER_CRITICAL();
+        if (slot->refCount > 0)
+        {
+            slot->refCount--;
+        }
+        taskEXIT_CRITICAL();
     }
 }
 
@@ -374,43 +389,6 @@ uint8_t SLN_BLEWUARTIsConnected()
     return s_QN9090IsConnected;
 }
 
-static void SLN_BLEWUARTCreateHeader(
-    uint8_t *htUnit, uint8_t *data, uint32_t len, uint8_t type, uint32_t pktId, uint32_t result)
-{
-    uint32_t crc_res = 0;
-
-    /* transfer magic */
-    memcpy(htUnit, TU_MAGIC, sizeof(TU_MAGIC));
-
-    /* packet type */
-    htUnit[3] = type;
-
-    /* packet length */
-    *((uint32_t *)(htUnit + 4)) = len;
-
-    /* packet id */
-    *((uint32_t *)(htUnit + 8)) = pktId;
-
-    if (len > 0)
-    {
-        /* packet crc */
-        crc32(data, len, &crc_res);
-        *((uint32_t *)(htUnit + 12)) = crc_res;
-    }
-    else
-    {
-        *((uint32_t *)(htUnit + 12)) = 0;
-    }
-
-    /* packet reserved */
-    *((uint32_t *)(htUnit + 16)) = result;
-
-    /* transfer unit crc */
-    crc_res = 0;
-    crc32(htUnit, BLE_WUART_HEADER_LENGTH - 4, &crc_res);
-    *((uint32_t *)(htUnit + 20)) = crc_res;
-}
-
 static hal_ble_wuart_status_t SLN_BLEWUARTSendPacket(
     uint8_t *data, uint32_t len, uint8_t type, uint32_t pktId, uint32_t result)
 {
@@ -418,7 +396,7 @@ static hal_ble_wuart_status_t SLN_BLEWUARTSendPacket(
 
     uint8_t htUnit[BLE_WUART_HEADER_LENGTH] = {0};
 
-    SLN_BLEWUARTCreateHeader(htUnit, data, len, type, pktId, result);
+    HAL_BleWuartFramer_CreateHeader(htUnit, data, len, type, pktId, result);
 
     LPUART_RTOS_Send(&s_LpuartRTOSHandle, htUnit, BLE_WUART_HEADER_LENGTH);
 
@@ -430,54 +408,9 @@ static hal_ble_wuart_status_t SLN_BLEWUARTSendPacket(
     return status;
 }
 
-static hal_ble_wuart_status_t SLN_BLEWUARTParseHeader(uint8_t *headerBuf, hal_header_transfer_unit_t *pHtUnit)
-{
-    hal_ble_wuart_status_t status = kHALBLEWUARTStatus_Success;
-    uint32_t crc_res              = 0;
-
-    /* transfer magic */
-    if (memcmp(headerBuf, TU_MAGIC, sizeof(TU_MAGIC)) != 0)
-    {
-        return kHALBLEWUARTStatus_TUMagicError;
-    }
-    memcpy(pHtUnit->tuMagic, headerBuf, 3);
-
-    /* packet type */
-    pHtUnit->pktType = headerBuf[3];
-
-    /* packet length */
-    pHtUnit->pktLen = *((uint32_t *)(headerBuf + 4));
-
-    /* packet id */
-    pHtUnit->pktId = *((uint32_t *)(headerBuf + 8));
-
-    /* packet crc */
-    pHtUnit->pktCrc = *((uint32_t *)(headerBuf + 12));
-
-    /* packet reserved */
-    pHtUnit->reserved = *((uint32_t *)(headerBuf + 16));
-
-    /* transfer unit crc */
-    pHtUnit->tuCrc = *((uint32_t *)(headerBuf + 20));
-    crc32(headerBuf, BLE_WUART_HEADER_LENGTH - 4, &crc_res);
-    if (crc_res != pHtUnit->tuCrc)
-    {
-        return kHALBLEWUARTStatus_TUCRC32Error;
-    }
-
-    return status;
-}
-
-static hal_ble_wuart_status_t SLN_BLEWUARTParseData(uint8_t *dataBuf, hal_header_transfer_unit_t *pHtUnit)
+/* The payload CRC is checked by the framer. The payload is only valid during the call, unless it is retained. */
+static void SLN_BLEWUARTParseData(uint8_t *dataBuf, hal_header_transfer_unit_t *pHtUnit)
 {
-    hal_ble_wuart_status_t status = kHALBLEWUARTStatus_Success;
-    uint32_t crc_res              = 0;
-    crc32(dataBuf, pHtUnit->pktLen, &crc_res);
-    if (crc_res != pHtUnit->pktCrc)
-    {
-        return kHALBLEWUARTStatus_PacketCRC32Error;
-    }
-
     s_pckID = pHtUnit->pktId;
     /* handle all kinds of packet type */
     switch (pHtUnit->pktType)
@@ -491,9 +424,9 @@ static hal_ble_wuart_status_t SLN_BLEWUARTParseData(uint8_t *dataBuf, hal_header
             }
             else
             {
-                uint8_t *pPassword = pvPortMalloc(pHtUnit->pktLen);
-                HAL_OutputDev_SmartLockConfig_GetPassword(pPassword);
-                if (memcmp(dataBuf, pPassword, pHtUnit->pktLen) == 0)
+                uint8_t password[sizeof(((smart_lock_config_t *)0)->password)];
+                HAL_OutputDev_SmartLockConfig_GetPassword(password);
+                if (memcmp(dataBuf, password, pHtUnit->pktLen) == 0)
                 {
                     SLN_BLEWUARTSendPacket(NULL, 0, AUTHENTICATION_RES, pHtUnit->pktId, BLE_WUART_ACK_SUCCESS);
                 }
@@ -501,8 +434,6 @@ static hal_ble_wuart_status_t SLN_BLEWUARTParseData(uint8_t *dataBuf, hal_header
                 {
                     SLN_BLEWUARTSendPacket(NULL, 0, AUTHENTICATION_RES, pHtUnit->pktId, BLE_WUART_ACK_ERROR);
                 }
-
-                vPortFree(pPassword);
             }
         }
         break;
@@ -532,40 +463,41 @@ static hal_ble_wuart_status_t SLN_BLEWUARTParseData(uint8_t *dataBuf, hal_header
         {
             uint32_t receiverList = 1 << kFWKTaskID_VisionAlgo;
 
-            s_BLEWUARTEvent.eventBase.eventId = kEventFaceRecID_AddUserRemote;
-            s_BLEWUARTEvent.eventBase.respond = HAL_InputDev_BleWuartQn9090_Respond;
-
-            if (pHtUnit->reserved == 0)
+            if (s_BLEWUARTRegData != NULL)
             {
-                s_BLEWUARTEvent.remoteReg.isReRegister = 0;
+                /* the event of the registration in progress is left untouched */
+                LOGE("[ERROR]: BleWirelessUartTask REGISTRATION_REQ while a registration is in progress.\r\n");
+                SLN_BLEWUARTSendPacket(NULL, 0, REGISTRATION_RES, pHtUnit->pktId, BLE_WUART_ACK_ERROR);
             }
-            else
+            else if (s_InputDev_BLEWUARTQN9090.cap.callback != NULL)
             {
-                s_BLEWUARTEvent.remoteReg.isReRegister = 1;
-            }
-
-            s_BLEWUARTEvent.remoteReg.dataLen = pHtUnit->pktLen;
-            s_BLEWUARTEvent.remoteReg.regData = pvPortMalloc(pHtUnit->pktLen);
+                uint8_t fromISR = __get_IPSR();
 
-            if (s_BLEWUARTEvent.remoteReg.regData != NULL)
-            {
-                memcpy(s_BLEWUARTEvent.remoteReg.regData, dataBuf, pHtUnit->pktLen);
+                s_BLEWUARTEvent.eventBase.eventId = kEventFaceRecID_AddUserRemote;
+                s_BLEWUARTEvent.eventBase.respond = HAL_InputDev_BleWuartQn9090_Respond;
 
-                uint8_t fromISR = __get_IPSR();
-                if (s_InputDev_BLEWUARTQN9090.cap.callback != NULL)
+                if (pHtUnit->reserved == 0)
                 {
-                    /* Build input_event */
-                    s_InputEvent.eventId                  = kInputEventID_Recv;
-                    s_InputEvent.size                     = sizeof(event_face_rec_t);
-                    s_InputEvent.u.inputData.data         = &s_BLEWUARTEvent;
-                    s_InputEvent.u.inputData.copy         = 0;
-                    s_InputEvent.u.inputData.receiverList = receiverList;
-                    s_InputDev_BLEWUARTQN9090.cap.callback(&s_InputDev_BLEWUARTQN9090, &s_InputEvent, fromISR);
+                    s_BLEWUARTEvent.remoteReg.isReRegister = 0;
                 }
-            }
-            else
-            {
-                LOGE("[ERROR]: BleWirelessUartTask REGISTRATION_REQ malloc buffer error.\r\n");
+                else
+                {
+                    s_BLEWUARTEvent.remoteReg.isReRegister = 1;
+                }
+
+                /* the registration data is passed by reference, the payload is released by the respond callback */
+                SLN_BLEWUARTPacketRetain(dataBuf);
+                s_BLEWUARTRegData                 = dataBuf;
+                s_BLEWUARTEvent.remoteReg.dataLen = pHtUnit->pktLen;
+                s_BLEWUARTEvent.remoteReg.regData = (remote_reg_data_t *)dataBuf;
+
+                /* Build input_event */
+                s_InputEvent.eventId                  = kInputEventID_Recv;
+                s_InputEvent.size                     = sizeof(event_face_rec_t);
+                s_InputEvent.u.inputData.data         = &s_BLEWUARTEvent;
+                s_InputEvent.u.inputData.copy         = 0;
+                s_InputEvent.u.inputData.receiverList = receiverList;
+                s_InputDev_BLEWUARTQN9090.cap.callback(&s_InputDev_BLEWUARTQN9090, &s_InputEvent, fromISR);
             }
         }
         break;
@@ -801,84 +733,53 @@ static hal_ble_wuart_status_t SLN_BLEWUARTParseData(uint8_t *dataBuf, hal_header
         default:
             break;
     }
-
-    return status;
 }
 
+static const ble_wuart_framer_ops_t s_BLEWUARTFramerOps = {
+    .alloc   = SLN_BLEWUARTPacketAlloc,
+    .release = SLN_BLEWUARTPacketRelease,
+    .packet  = SLN_BLEWUARTParseData,
+};
+
 static void SLN_BLEWUARTMsgHandle(void *param)
 {
     LOGD("[BleWirelessUartTask] start.");
 
-    hal_ble_wuart_status_t status = kHALBLEWUARTStatus_PacketValid;
-
-    size_t n = 0;
-
-    hal_ble_wuart_transfer_t *transfer = param;
+    ble_wuart_framer_t *framer    = param;
+    lpuart_handle_t *lpuartHandle = (lpuart_handle_t *)s_LpuartRTOSHandle.t_state;
 
     /* press wakeup pin sync ble latest connection status. */
     SLN_BLEWUARTPressWakePin();
 
-    LPUART_RTOS_Receive(&s_LpuartRTOSHandle, transfer->nibbleBuf, BLE_WUART_HEADER_LENGTH, &n);
-
     while (1)
     {
-        switch (transfer->stage)
+        size_t n     = 0;
+        size_t avail = 0;
+
+        /* wait for one byte, then take the bytes already in the ring buffer without waiting for a whole packet */
+        if (LPUART_RTOS_Receive(&s_LpuartRTOSHandle, s_BLEWUARTRxChunk, 1, &n) != kStatus_Success)
         {
-            case kHALBLEWUARTPacket_Header:
-            {
-                status = SLN_BLEWUARTParseHeader(transfer->nibbleBuf, &s_HeaderTransferUnit);
-                LOGD("HEADER_PACKET: ");
+            /* bytes were lost, the framer resynchronizes on the next valid header */
+            continue;
+        }
 
-                if (status == kHALBLEWUARTStatus_Success)
-                {
-                    transfer->readOffset = 0;
-                    transfer->stage      = kHALBLEWUARTPacket_Data;
-                    transfer->packetBuf  = pvPortMalloc(s_HeaderTransferUnit.pktLen);
-                    if (transfer->packetBuf == NULL)
-                    {
-                    }
-
-                    transfer->packetLen = s_HeaderTransferUnit.pktLen;
-                    LPUART_RTOS_Receive(&s_LpuartRTOSHandle, transfer->packetBuf, transfer->packetLen, &n);
-                    LOGD("HEADER PACKET PARSE SUCCESSFUL[%d].", transfer->packetLen);
-                }
-                else
-                {
-                    LPUART_RTOS_Receive(&s_LpuartRTOSHandle, transfer->nibbleBuf, BLE_WUART_HEADER_LENGTH, &n);
-                    LOGD("HEADER PACKET PARSE FAILED[%d].", transfer->packetLen);
-                    LOGD_HEX(transfer->nibbleBuf, BLE_WUART_HEADER_LENGTH);
-                }
-            }
-            break;
+        avail = LPUART_TransferGetRxRingBufferLength(s_LpuartRTOSHandle.base, lpuartHandle);
+        if (avail > sizeof(s_BLEWUARTRxChunk) - 1)
+        {
+            avail = sizeof(s_BLEWUARTRxChunk) - 1;
+        }
 
-            case kHALBLEWUARTPacket_Data:
+        n = 1;
+        if (avail > 0)
+        {
+            size_t received = 0;
+            if (LPUART_RTOS_Receive(&s_LpuartRTOSHandle, &s_BLEWUARTRxChunk[1], avail, &received) == kStatus_Success)
             {
-                status = SLN_BLEWUARTParseData(transfer->packetBuf, &s_HeaderTransferUnit);
-                LOGD("DATA_PACKET: ");
-
-                if (status == kHALBLEWUARTStatus_Success)
-                {
-                    LOGD("DATA PACKET PARSE SUCCESSFUL[%d].", transfer->packetLen);
-                }
-                else
-                {
-                    LOGD("DATA PACKET PARSE FAILED[%d].", transfer->packetLen);
-                    LOGD_HEX(transfer->packetBuf, s_HeaderTransferUnit.pktLen);
-                }
-
-                vPortFree(transfer->packetBuf);
-                memset(&s_HeaderTransferUnit, 0x00, sizeof(s_HeaderTransferUnit));
-                memset(transfer->nibbleBuf, 0x0, transfer->nibbleLen);
-                transfer->stage = kHALBLEWUARTPacket_Header;
-
-                /* prepare next count of data need received, it will block task.*/
-                LPUART_RTOS_Receive(&s_LpuartRTOSHandle, transfer->nibbleBuf, BLE_WUART_HEADER_LENGTH, &n);
+                n += received;
             }
-            break;
-
-            default:
-                break;
         }
+
+        HAL_BleWuartFramer_Feed(framer, s_BLEWUARTRxChunk, n);
     }
 }
 
@@ -926,16 +827,11 @@ static hal_input_status_t HAL_InputDev_BleWuartQn9090_Start(const input_dev_t *d
 {
     hal_input_status_t status = kStatus_HAL_InputSuccess;
 
-    s_BLEWUARTTransfer.nibbleBuf  = s_BLEWUARTNibbleBuffer;
-    s_BLEWUARTTransfer.nibbleLen  = sizeof(s_BLEWUARTNibbleBuffer);
-    s_BLEWUARTTransfer.packetBuf  = NULL;
-    s_BLEWUARTTransfer.packetLen  = 0;
-    s_BLEWUARTTransfer.readOffset = 0;
-    s_BLEWUARTTransfer.stage      = kHALBLEWUARTPacket_Header;
+    HAL_BleWuartFramer_Init(&s_BLEWUARTFramer, BLE_WUART_PACKET_MAX_SIZE, &s_BLEWUARTFramerOps);
 
     s_BLEWUARTEvent.eventBase.respond = NULL;
 
-    if (xTaskCreate(SLN_BLEWUARTMsgHandle, BLE_WUART_TASK_NAME, BLE_WUART_TASK_STACK, &s_BLEWUARTTransfer,
+    if (xTaskCreate(SLN_BLEWUARTMsgHandle, BLE_WUART_TASK_NAME, BLE_WUART_TASK_STACK, &s_BLEWUARTFramer,
                     BLE_WUART_TASK_PRIORITY, NULL) != pdPASS)
     {
         LOGE("[BleWirelessUart] Task creation failed!.");
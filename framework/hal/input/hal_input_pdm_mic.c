@@ -15,6 +15,8 @@
 #include "fsl_dmamux.h"
 
 #include "fwk_log.h"
+#include "fwk_platform.h"
+#include "fwk_audio_processing.h"
 #include "fwk_input_manager.h"
 #include "hal_event_descriptor_voice.h"
 #include "hal_input_dev.h"
@@ -50,21 +52,16 @@ static void pdmCallback(PDM_Type *base, pdm_edma_handle_t *handle, status_t stat
  ******************************************************************************/
 AT_NONCACHEABLE_SECTION_ALIGN_DTC(static pdm_edma_handle_t s_pdmRxHandle, 4);
 AT_NONCACHEABLE_SECTION_ALIGN_DTC(static edma_handle_t s_pdmDmaHandle, 4);
-AT_NONCACHEABLE_SECTION_ALIGN_DTC(static edma_tcd_t s_edmaTcd_0[2], 32U);
+AT_NONCACHEABLE_SECTION_ALIGN_DTC(static edma_tcd_t s_edmaTcd_0[AUDIO_PCM_BUFFER_COUNT], 32U);
 AT_NONCACHEABLE_SECTION_ALIGN_DTC(static pcm_input_t s_pcmStream, 4);
 
-pdm_edma_transfer_t pdmXfer[2] = {
-    {
-        .data         = (uint8_t *)s_pcmStream,
-        .dataSize     = AUDIO_PCM_BUFFER_SIZE,
-        .linkTransfer = &pdmXfer[1],
-    },
-    {
-        .data         = (uint8_t *)&s_pcmStream[AUDIO_PCM_BUFFER_COUNT - 1],
-        .dataSize     = AUDIO_PCM_BUFFER_SIZE,
-        .linkTransfer = &pdmXfer[0]
-    },
-};
+/* loop of AUDIO_PCM_BUFFER_COUNT transfers, linked at init */
+pdm_edma_transfer_t pdmXfer[AUDIO_PCM_BUFFER_COUNT];
+
+/* one event per buffer, valid in the audio processing task until the DMA comes back to the buffer */
+static event_voice_t s_pcmEvents[AUDIO_PCM_BUFFER_COUNT];
+/* buffer the DMA completes next */
+static volatile uint8_t s_pcmStreamIdx = 0;
 
 static const pdm_config_t pdmConfig = {
     .enableDoze        = false,
@@ -77,8 +74,6 @@ static const pdm_channel_config_t channelConfig = {
     .gain       = kPDM_DfOutputGain2,
 };
 
-static event_voice_t event;
-
 /*
  * AUDIO PLL setting: Frequency = Fref * (DIV_SELECT + NUM / DENOM) / (2^POST)
  *                              = 24 * (32 + 77/100)  / 2
@@ -134,8 +129,24 @@ hal_input_status_t input_dev_pdm_mic_init(input_dev_t *dev, input_dev_callback_t
     /* Setup PDM */
     PDM_Init(MIC_PDM, &pdmConfig);
 
+    for (uint32_t i = 0; i < AUDIO_PCM_BUFFER_COUNT; i++)
+    {
+        pdmXfer[i].data         = (uint8_t *)s_pcmStream[i];
+        pdmXfer[i].dataSize     = AUDIO_PCM_BUFFER_SIZE;
+        pdmXfer[i].linkTransfer = &pdmXfer[(i + 1) % AUDIO_PCM_BUFFER_COUNT];
+
+        s_pcmEvents[i].event_base.eventId    = AUDIO_IN;
+        s_pcmEvents[i].audio_in.audio_stream = s_pcmStream[i];
+    }
+
+    /* the chunks go straight to the audio processing task, not through the input manager */
+    if (FWK_AudioProcessing_InputChannelOpen(AUDIO_PCM_BUFFER_COUNT) != 0)
+    {
+        return kStatus_HAL_InputError;
+    }
+
     PDM_TransferCreateHandleEDMA(MIC_PDM, &s_pdmRxHandle, pdmCallback, NULL, &s_pdmDmaHandle);
-    PDM_TransferInstallEDMATCDMemory(&s_pdmRxHandle, s_edmaTcd_0, 2);
+    PDM_TransferInstallEDMATCDMemory(&s_pdmRxHandle, s_edmaTcd_0, AUDIO_PCM_BUFFER_COUNT);
     PDM_TransferSetChannelConfigEDMA(MIC_PDM, &s_pdmRxHandle, MIC_PDM_ENABLE_CHANNEL_LEFT, &channelConfig);
     PDM_TransferSetChannelConfigEDMA(MIC_PDM, &s_pdmRxHandle, MIC_PDM_ENABLE_CHANNEL_RIGHT, &channelConfig);
     if (PDM_SetSampleRateConfig(MIC_PDM, MIC_PDM_CLK_FREQ, AUDIO_PCM_SAMPLE_RATE) != kStatus_Success)
@@ -159,6 +170,7 @@ hal_input_status_t input_dev_pdm_mic_start(const input_dev_t *dev)
 
     PDM_Reset(MIC_PDM);
 
+    s_pcmStreamIdx = 0;
     PDM_TransferReceiveEDMA(MIC_PDM, &s_pdmRxHandle, pdmXfer);
 
     return error;
@@ -190,24 +202,17 @@ const static input_dev_operator_t input_dev_pdm_mic_ops = {
 };
 
 static input_dev_t input_dev_pdm_mic = {.id = 1, .ops = &input_dev_pdm_mic_ops, .cap = {.callback = NULL}};
-static input_event_t input_dev_event;
 
 static void pdmCallback(PDM_Type *base, pdm_edma_handle_t *handle, status_t status, void *userData)
 {
-    static volatile uint8_t pingPongIdx = 0;
+    uint8_t idx             = s_pcmStreamIdx;
+    event_voice_t *pcmEvent = &s_pcmEvents[idx];
 
-    /* Callback sends message to input_manager to forward to audio */
-    if (input_dev_pdm_mic.cap.callback != NULL)
-    {
-        uint8_t fromISR             = __get_IPSR();
-        event.event_base.eventId    = AUDIO_IN;
-        event.audio_in.audio_stream = (int32_t *)&s_pcmStream[pingPongIdx];
-        input_dev_event.u.audioData = &event;
-        input_dev_event.eventId     = kInputEventID_AudioRecv;
+    /* the audio processing task counts the chunks overwritten before it could run them */
+    pcmEvent->audio_in.timestampUs = FWK_CurrentTimeUs();
+    FWK_AudioProcessing_InputChannelPush(pcmEvent, pcmEvent->audio_in.timestampUs, __get_IPSR());
 
-        input_dev_pdm_mic.cap.callback(&input_dev_pdm_mic, &input_dev_event, fromISR);
-    }
-    pingPongIdx = pingPongIdx ? 0 : 1;
+    s_pcmStreamIdx = (idx + 1) % AUDIO_PCM_BUFFER_COUNT;
 }
 
 int HAL_InputDev_PdmMic_Register()
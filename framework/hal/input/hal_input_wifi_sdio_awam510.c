@@ -559,6 +559,20 @@ static int _HAL_InputDev_WiFiAWAM510_Init(fwk_task_data_t *arg)
     return 0;
 }
 
+#if ENABLE_FTP_CLIENT
+static void _ftpUploadDone(void *arg, status_t status)
+{
+    if (status == kStatus_Success)
+    {
+        LOGD("FTP upload done.");
+    }
+    else
+    {
+        LOGE("FTP upload failed.");
+    }
+}
+#endif /* ENABLE_FTP_CLIENT */
+
 static void _HAL_InputDev_WiFiAWAM510_MessageHandler(fwk_message_t *pMsg, fwk_task_data_t *pTaskData)
 {
     if (pMsg == NULL)
@@ -665,24 +679,27 @@ static void _HAL_InputDev_WiFiAWAM510_MessageHandler(fwk_message_t *pMsg, fwk_ta
 #if ENABLE_FTP_CLIENT
         case kWiFi_FTPClient:
         {
-            if (s_WiFiState == kWiFi_State_Connected)
+            h264_result_t *pResult = (h264_result_t *)pMsg->raw.data;
+            if (pResult->recordedDataAddress == NULL)
             {
-                ftp_session_handle_t handle = FTP_ConnectBlocking();
-                if (handle != NULL)
-                {
-                    char remote_path[25];
-                    char current_time[8];
-                    h264_result_t result = *(h264_result_t *)pMsg->raw.data;
-                    itoa(FWK_CurrentTimeUs() / 1000, current_time, 10);
-                    strcpy(remote_path, "VIZN3D/rec");
-                    strcat(remote_path, current_time);
-                    strcat(remote_path, ".h264");
-                    FTP_StoreBlocking(handle, remote_path, (char *)result.recordedDataAddress, result.recordedDataSize);
-                    FTP_DisconnectBlocking(handle);
-                }
-                else
+                /* Recordings streamed to the file system have no clip in memory to upload. */
+                LOGD("No recorded clip in memory to upload.");
+            }
+            else if (s_WiFiState == kWiFi_State_Connected)
+            {
+                /* The FTP task uploads the clip, the WiFi task is free for the next requests */
+                ftp_store_job_t job = {0};
+                char current_time[8];
+                itoa(FWK_CurrentTimeUs() / 1000, current_time, 10);
+                strcpy(job.remotePath, "VIZN3D/rec");
+                strcat(job.remotePath, current_time);
+                strcat(job.remotePath, ".h264");
+                job.dataSource = (const char *)pResult->recordedDataAddress;
+                job.len        = pResult->recordedDataSize;
+                job.done       = _ftpUploadDone;
+                if (FTP_StoreAsync(&job) != kStatus_Success)
                 {
-                    LOGE("Not connected to the server. Can't start FTP client.");
+                    LOGE("Can't start FTP upload.");
                 }
             }
             else
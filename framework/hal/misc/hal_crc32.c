@@ -0,0 +1,70 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief CRC32 implementation.
+ * The table folds the initial and final inversions of the CRC-32 in, so a CRC starting from 0 needs no final step.
+ */
+
+#include "hal_crc32.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static const uint32_t s_Crc32Table[0x100] = {
+    0xD202EF8DU, 0xA505DF1BU, 0x3C0C8EA1U, 0x4B0BBE37U, 0xD56F2B94U, 0xA2681B02U, 0x3B614AB8U, 0x4C667A2EU,
+    0xDCD967BFU, 0xABDE5729U, 0x32D70693U, 0x45D03605U, 0xDBB4A3A6U, 0xACB39330U, 0x35BAC28AU, 0x42BDF21CU,
+    0xCFB5FFE9U, 0xB8B2CF7FU, 0x21BB9EC5U, 0x56BCAE53U, 0xC8D83BF0U, 0xBFDF0B66U, 0x26D65ADCU, 0x51D16A4AU,
+    0xC16E77DBU, 0xB669474DU, 0x2F6016F7U, 0x58672661U, 0xC603B3C2U, 0xB1048354U, 0x280DD2EEU, 0x5F0AE278U,
+    0xE96CCF45U, 0x9E6BFFD3U, 0x0762AE69U, 0x70659EFFU, 0xEE010B5CU, 0x99063BCAU, 0x000F6A70U, 0x77085AE6U,
+    0xE7B74777U, 0x90B077E1U, 0x09B9265BU, 0x7EBE16CDU, 0xE0DA836EU, 0x97DDB3F8U, 0x0ED4E242U, 0x79D3D2D4U,
+    0xF4DBDF21U, 0x83DCEFB7U, 0x1AD5BE0DU, 0x6DD28E9BU, 0xF3B61B38U, 0x84B12BAEU, 0x1DB87A14U, 0x6ABF4A82U,
+    0xFA005713U, 0x8D076785U, 0x140E363FU, 0x630906A9U, 0xFD6D930AU, 0x8A6AA39CU, 0x1363F226U, 0x6464C2B0U,
+    0xA4DEAE1DU, 0xD3D99E8BU, 0x4AD0CF31U, 0x3DD7FFA7U, 0xA3B36A04U, 0xD4B45A92U, 0x4DBD0B28U, 0x3ABA3BBEU,
+    0xAA05262FU, 0xDD0216B9U, 0x440B4703U, 0x330C7795U, 0xAD68E236U, 0xDA6FD2A0U, 0x4366831AU, 0x3461B38CU,
+    0xB969BE79U, 0xCE6E8EEFU, 0x5767DF55U, 0x2060EFC3U, 0xBE047A60U, 0xC9034AF6U, 0x500A1B4CU, 0x270D2BDAU,
+    0xB7B2364BU, 0xC0B506DDU, 0x59BC5767U, 0x2EBB67F1U, 0xB0DFF252U, 0xC7D8C2C4U, 0x5ED1937EU, 0x29D6A3E8U,
+    0x9FB08ED5U, 0xE8B7BE43U, 0x71BEEFF9U, 0x06B9DF6FU, 0x98DD4ACCU, 0xEFDA7A5AU, 0x76D32BE0U, 0x01D41B76U,
+    0x916B06E7U, 0xE66C3671U, 0x7F6567CBU, 0x0862575DU, 0x9606C2FEU, 0xE101F268U, 0x7808A3D2U, 0x0F0F9344U,
+    0x82079EB1U, 0xF500AE27U, 0x6C09FF9DU, 0x1B0ECF0BU, 0x856A5AA8U, 0xF26D6A3EU, 0x6B643B84U, 0x1C630B12U,
+    0x8CDC1683U, 0xFBDB2615U, 0x62D277AFU, 0x15D54739U, 0x8BB1D29AU, 0xFCB6E20CU, 0x65BFB3B6U, 0x12B88320U,
+    0x3FBA6CADU, 0x48BD5C3BU, 0xD1B40D81U, 0xA6B33D17U, 0x38D7A8B4U, 0x4FD09822U, 0xD6D9C998U, 0xA1DEF90EU,
+    0x3161E49FU, 0x4666D409U, 0xDF6F85B3U, 0xA868B525U, 0x360C2086U, 0x410B1010U, 0xD80241AAU, 0xAF05713CU,
+    0x220D7CC9U, 0x550A4C5FU, 0xCC031DE5U, 0xBB042D73U, 0x2560B8D0U, 0x52678846U, 0xCB6ED9FCU, 0xBC69E96AU,
+    0x2CD6F4FBU, 0x5BD1C46DU, 0xC2D895D7U, 0xB5DFA541U, 0x2BBB30E2U, 0x5CBC0074U, 0xC5B551CEU, 0xB2B26158U,
+    0x04D44C65U, 0x73D37CF3U, 0xEADA2D49U, 0x9DDD1DDFU, 0x03B9887CU, 0x74BEB8EAU, 0xEDB7E950U, 0x9AB0D9C6U,
+    0x0A0FC457U, 0x7D08F4C1U, 0xE401A57BU, 0x930695EDU, 0x0D62004EU, 0x7A6530D8U, 0xE36C6162U, 0x946B51F4U,
+    0x19635C01U, 0x6E646C97U, 0xF76D3D2DU, 0x806A0DBBU, 0x1E0E9818U, 0x6909A88EU, 0xF000F934U, 0x8707C9A2U,
+    0x17B8D433U, 0x60BFE4A5U, 0xF9B6B51FU, 0x8EB18589U, 0x10D5102AU, 0x67D220BCU, 0xFEDB7106U, 0x89DC4190U,
+    0x49662D3DU, 0x3E611DABU, 0xA7684C11U, 0xD06F7C87U, 0x4E0BE924U, 0x390CD9B2U, 0xA0058808U, 0xD702B89EU,
+    0x47BDA50FU, 0x30BA9599U, 0xA9B3C423U, 0xDEB4F4B5U, 0x40D06116U, 0x37D75180U, 0xAEDE003AU, 0xD9D930ACU,
+    0x54D13D59U, 0x23D60DCFU, 0xBADF5C75U, 0xCDD86CE3U, 0x53BCF940U, 0x24BBC9D6U, 0xBDB2986CU, 0xCAB5A8FAU,
+    0x5A0AB56BU, 0x2D0D85FDU, 0xB404D447U, 0xC303E4D1U, 0x5D677172U, 0x2A6041E4U, 0xB369105EU, 0xC46E20C8U,
+    0x72080DF5U, 0x050F3D63U, 0x9C066CD9U, 0xEB015C4FU, 0x7565C9ECU, 0x0262F97AU, 0x9B6BA8C0U, 0xEC6C9856U,
+    0x7CD385C7U, 0x0BD4B551U, 0x92DDE4EBU, 0xE5DAD47DU, 0x7BBE41DEU, 0x0CB97148U, 0x95B020F2U, 0xE2B71064U,
+    0x6FBF1D91U, 0x18B82D07U, 0x81B17CBDU, 0xF6B64C2BU, 0x68D2D988U, 0x1FD5E91EU, 0x86DCB8A4U, 0xF1DB8832U,
+    0x616495A3U, 0x1663A535U, 0x8F6AF48FU, 0xF86DC419U, 0x660951BAU, 0x110E612CU, 0x88073096U, 0xFF000000U,
+};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+uint32_t HAL_Crc32_Update(uint32_t crc, const void *data, size_t size)
+{
+    const uint8_t *pData = (const uint8_t *)data;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = s_Crc32Table[(uint8_t)crc ^ pData[i]] ^ (crc >> 8);
+    }
+
+    return crc;
+}
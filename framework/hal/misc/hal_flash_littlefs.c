@@ -240,6 +240,33 @@ static sln_flash_status_t _lfs_appendHandler(
     return ret;
 }
 
+static sln_flash_status_t _lfs_seekWriteHandler(
+    const flash_dev_t *dev, const char *path, void *buf, unsigned int offset, unsigned int size)
+{
+    int ret = kStatus_HAL_FlashSuccess;
+    sln_flash_fs_status_t status;
+
+    if ((dev == NULL) || (path == NULL) || (buf == NULL) || (size == 0))
+    {
+        return kStatus_HAL_FlashInvalidParam;
+    }
+
+    status = SLN_FLASH_LITTLEFS_Write(path, buf, offset, size);
+
+    if (status == SLN_FLASH_FS_ENOENTRY2)
+    {
+        LOGE("Littlefs File %s doesn't exist", path);
+        ret = kStatus_HAL_FlashFileNotExist;
+    }
+    else if (status != SLN_FLASH_FS_OK)
+    {
+        LOGE("Failed to write file %s at %d, error %d", path, offset, status);
+        ret = kStatus_HAL_FlashFail;
+    }
+
+    return ret;
+}
+
 static sln_flash_status_t _lfs_readHandler(
     const flash_dev_t *dev, const char *path, void *buf, unsigned int offset, unsigned int *size)
 {
@@ -303,6 +330,7 @@ const static flash_dev_operator_t s_FlashDev_LittlefsOps = {
     .rm      = _lfs_rmHandler,
     .rename  = _lfs_renameHandler,
     .cleanup = _lfs_cleanupHandler,
+    .write   = _lfs_seekWriteHandler,
 };
 
 static flash_dev_t s_FlashDev_Littlefs = {
@@ -991,6 +991,52 @@ int HAL_GfxDev_Pxp_DrawPicture(const gfx_dev_t *dev,
     return error;
 }
 
+/*
+ * @brief get the part of the overlay surface to compose.
+ * The content bounds of the surface clipped to it, the left aligned down, else the whole surface.
+ *
+ * @param *pOverlay [in] Pointer to overlay surface, locked.
+ * @param *pRect [out] Window in the overlay surface.
+ */
+static void _HAL_GfxDev_Pxp_OverlayWindow(const gfx_surface_t *pOverlay, gfx_rect_t *pRect)
+{
+    pRect->left   = 0;
+    pRect->top    = 0;
+    pRect->right  = pOverlay->right - pOverlay->left;
+    pRect->bottom = pOverlay->bottom - pOverlay->top;
+
+    if ((pOverlay->pContent == NULL) || gfx_rect_empty(pOverlay->pContent))
+    {
+        return;
+    }
+
+    if (pOverlay->pContent->left > pRect->left)
+    {
+        pRect->left = pOverlay->pContent->left & ~(GFX_PXP_OVERLAY_LEFT_ALIGN - 1);
+    }
+    if (pOverlay->pContent->top > pRect->top)
+    {
+        pRect->top = pOverlay->pContent->top;
+    }
+    if (pOverlay->pContent->right < pRect->right)
+    {
+        pRect->right = pOverlay->pContent->right;
+    }
+    if (pOverlay->pContent->bottom < pRect->bottom)
+    {
+        pRect->bottom = pOverlay->pContent->bottom;
+    }
+
+    if (gfx_rect_empty(pRect))
+    {
+        /* nothing drawn inside the surface, compose a single transparent pixel */
+        pRect->left   = 0;
+        pRect->top    = 0;
+        pRect->right  = 0;
+        pRect->bottom = 0;
+    }
+}
+
 /*
  * @brief compose the source surface to the destination surface.
  *
@@ -1016,6 +1062,8 @@ static int HAL_GfxDev_Pxp_ComposeInternal(const gfx_dev_t *dev,
     pxp_as_buffer_config_t *pAsBufferConfig         = &s_GfxPxpHandle.asBufferConfig;
     pxp_as_blend_config_t *pAsBlendConfig           = &s_GfxPxpHandle.asBlendConfig;
     pxp_output_buffer_config_t *pOutputBufferConfig = &s_GfxPxpHandle.outputBufferConfig;
+    gfx_rect_t asRect;
+    uint32_t asOffset;
 
     if ((dev == NULL) || (pSrc == NULL) || (pOverlay == NULL) || (pDst == NULL))
     {
@@ -1035,9 +1083,17 @@ static int HAL_GfxDev_Pxp_ComposeInternal(const gfx_dev_t *dev,
         return error;
     }
 
-    /* AS config. */
+    // lock overlay surface to avoid conflict with ui drawing on overlay surface, its content bounds included
+    if (pOverlay->lock)
+    {
+        xSemaphoreTake(pOverlay->lock, portMAX_DELAY);
+    }
+
+    /* AS config, only the drawn part of the overlay is fetched, the rest is transparent anyway. */
+    _HAL_GfxDev_Pxp_OverlayWindow(pOverlay, &asRect);
+    asOffset = asRect.top * pOverlay->pitch + asRect.left * GFX_PXP_OVERLAY_BYTES_PER_PIXEL;
     pAsBufferConfig->pixelFormat = kPXP_AsPixelFormatRGB565;
-    pAsBufferConfig->bufferAddr  = (uint32_t)pOverlay->buf;
+    pAsBufferConfig->bufferAddr  = (uint32_t)pOverlay->buf + asOffset;
     pAsBufferConfig->pitchBytes  = pOverlay->pitch;
     pAsBlendConfig->alpha        = 0xF0U; /* Don't care. */
     pAsBlendConfig->invertAlpha  = false; /* Don't care. */
@@ -1045,13 +1101,18 @@ static int HAL_GfxDev_Pxp_ComposeInternal(const gfx_dev_t *dev,
     pAsBlendConfig->ropMode      = kPXP_RopMaskAs;
     PXP_SetAlphaSurfaceBufferConfig(PXP_DEV, pAsBufferConfig);
     PXP_SetAlphaSurfaceBlendConfig(PXP_DEV, pAsBlendConfig);
-    PXP_SetAlphaSurfacePosition(PXP_DEV, pOverlay->left, pOverlay->top, pOverlay->right, pOverlay->bottom);
+    PXP_SetAlphaSurfacePosition(PXP_DEV, pOverlay->left + asRect.left, pOverlay->top + asRect.top,
+                                pOverlay->left + asRect.right, pOverlay->top + asRect.bottom);
     PXP_SetAlphaSurfaceOverlayColorKey(PXP_DEV, 0x0, 0x0);
     PXP_EnableAlphaSurfaceOverlayColorKey(PXP_DEV, true);
 
     // setup input buffer configuration
     if (init_input_buffer(pPsBufferConfig, pSrc) == -1)
     {
+        if (pOverlay->lock)
+        {
+            xSemaphoreGive(pOverlay->lock);
+        }
         _HAL_GfxDev_Pxp_Unlock();
         return -1;
     }
@@ -1062,6 +1123,10 @@ static int HAL_GfxDev_Pxp_ComposeInternal(const gfx_dev_t *dev,
     // setup the output buffer configuration
     if (init_output_buffer(pOutputBufferConfig, pDst) == -1)
     {
+        if (pOverlay->lock)
+        {
+            xSemaphoreGive(pOverlay->lock);
+        }
         _HAL_GfxDev_Pxp_Unlock();
         return -1;
     }
@@ -1077,12 +1142,6 @@ static int HAL_GfxDev_Pxp_ComposeInternal(const gfx_dev_t *dev,
         PXP_EnableCsc1(PXP_DEV, false);
     }
 
-    // lock overlay surface to avoid conflict with ui drawing on overlay surface
-    if (pOverlay->lock)
-    {
-        xSemaphoreTake(pOverlay->lock, portMAX_DELAY);
-    }
-
     // start the pxp operation
     PXP_Start(PXP_DEV);
 
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief audio DSP kernels implementation.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hal_audio_dsp.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+/*
+ * The DSP extension of the Cortex-M7 multiplies one half word of each operand in a single cycle and saturates without
+ * branches. The portable versions give the same results.
+ */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#define AUDIO_DSP_SAT16(x)         __SSAT((x), 16)
+#define AUDIO_DSP_MUL_BB(a, b)     ((int32_t)__SMULBB((a), (b)))
+#define AUDIO_DSP_MUL_TB(a, b)     ((int32_t)__SMULTB((a), (b)))
+#define AUDIO_DSP_PACK(low, high)  __PKHBT((low), (high), 16)
+#else
+#define AUDIO_DSP_SAT16(x)         ((x) > 32767 ? 32767 : ((x) < -32768 ? -32768 : (x)))
+#define AUDIO_DSP_MUL_BB(a, b)     ((int32_t)(int16_t)(a) * (int16_t)(b))
+#define AUDIO_DSP_MUL_TB(a, b)     ((int32_t)(int16_t)((uint32_t)(a) >> 16) * (int16_t)(b))
+#define AUDIO_DSP_PACK(low, high)  (((uint32_t)(low)&0xFFFF) | ((uint32_t)(high) << 16))
+#endif
+
+/* Q15 product rounded to nearest, the macros evaluate their arguments more than once */
+#define AUDIO_DSP_Q15_ROUND(x) (((x) + (1 << 14)) >> 15)
+
+/* Saturation of a 64-bit accumulator, clamped to the 32-bit range before the 16-bit saturation */
+#define AUDIO_DSP_SAT32_64(x) ((x) > INT32_MAX ? INT32_MAX : ((x) < INT32_MIN ? INT32_MIN : (int32_t)(x)))
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void HAL_AudioDsp_GainInit(audio_dsp_gain_t *gain, int16_t gainQ15, uint32_t rampSamples)
+{
+    if (gain == NULL)
+    {
+        return;
+    }
+
+    gain->current     = (int32_t)gainQ15 << 16;
+    gain->target      = gainQ15;
+    gain->step        = 0;
+    gain->rampLeft    = 0;
+    gain->rampSamples = rampSamples;
+}
+
+void HAL_AudioDsp_GainSetTarget(audio_dsp_gain_t *gain, int16_t gainQ15)
+{
+    if (gain == NULL)
+    {
+        return;
+    }
+
+    gain->target = gainQ15;
+    if (gain->rampSamples == 0)
+    {
+        gain->current  = (int32_t)gainQ15 << 16;
+        gain->rampLeft = 0;
+    }
+    else
+    {
+        gain->step     = (((int32_t)gainQ15 << 16) - gain->current) / (int32_t)gain->rampSamples;
+        gain->rampLeft = gain->rampSamples;
+    }
+}
+
+void HAL_AudioDsp_ApplyGain(audio_dsp_gain_t *gain, const int16_t *pSrc, int16_t *pDst, uint32_t count)
+{
+    int32_t g;
+    int32_t product;
+
+    if ((gain == NULL) || (pSrc == NULL) || (pDst == NULL))
+    {
+        return;
+    }
+
+    /* ramp one sample at a time */
+    while ((gain->rampLeft > 0) && (count > 0))
+    {
+        gain->current += gain->step;
+        if (--gain->rampLeft == 0)
+        {
+            gain->current = (int32_t)gain->target << 16;
+        }
+
+        g       = gain->current >> 16;
+        product = AUDIO_DSP_Q15_ROUND(*pSrc++ * g);
+        *pDst++ = AUDIO_DSP_SAT16(product);
+        count--;
+    }
+
+    /* constant gain, two samples per word when both buffers are word aligned */
+    g = gain->target;
+    if ((((uintptr_t)pSrc | (uintptr_t)pDst) & 3) == 0)
+    {
+        const uint32_t *pSrc32 = (const uint32_t *)pSrc;
+        uint32_t *pDst32       = (uint32_t *)pDst;
+
+        for (; count >= 2; count -= 2)
+        {
+            uint32_t in  = *pSrc32++;
+            int32_t low  = AUDIO_DSP_SAT16(AUDIO_DSP_Q15_ROUND(AUDIO_DSP_MUL_BB(in, g)));
+            int32_t high = AUDIO_DSP_SAT16(AUDIO_DSP_Q15_ROUND(AUDIO_DSP_MUL_TB(in, g)));
+
+            *pDst32++ = AUDIO_DSP_PACK(low, high);
+        }
+
+        pSrc = (const int16_t *)pSrc32;
+        pDst = (int16_t *)pDst32;
+    }
+
+    for (; count > 0; count--)
+    {
+        product = AUDIO_DSP_Q15_ROUND(*pSrc++ * g);
+        *pDst++ = AUDIO_DSP_SAT16(product);
+    }
+}
+
+void HAL_AudioDsp_MonoToStereo(const int16_t *pSrc, int16_t *pDst, uint32_t count, bool invertRight)
+{
+    if ((pSrc == NULL) || (pDst == NULL))
+    {
+        return;
+    }
+
+    /* each mono sample gives one stereo word */
+    uint32_t *pDst32 = (uint32_t *)pDst;
+
+    if (invertRight)
+    {
+        for (; count > 0; count--)
+        {
+            int32_t sample = *pSrc++;
+            *pDst32++      = AUDIO_DSP_PACK(sample, AUDIO_DSP_SAT16(-sample));
+        }
+    }
+    else
+    {
+        for (; count > 0; count--)
+        {
+            int32_t sample = *pSrc++;
+            *pDst32++      = AUDIO_DSP_PACK(sample, sample);
+        }
+    }
+}
+
+void HAL_AudioDsp_Mix(
+    const int16_t *const *pSrcs, const int16_t *gainsQ15, uint32_t streamCount, int16_t *pDst, uint32_t count)
+{
+    uint32_t i = 0;
+
+    if ((pSrcs == NULL) || (gainsQ15 == NULL) || (pDst == NULL))
+    {
+        return;
+    }
+
+    /*
+     * Each Q30 product reaches 2^30 at full scale, a few streams overflow 32 bits: the products are summed on 64 bits,
+     * which the Cortex-M7 does in a single multiply accumulate long.
+     */
+
+    /* two samples of each stream per word when all the buffers are word aligned */
+    uintptr_t alignment = (uintptr_t)pDst;
+    for (uint32_t stream = 0; stream < streamCount; stream++)
+    {
+        alignment |= (uintptr_t)pSrcs[stream];
+    }
+
+    if ((alignment & 3) == 0)
+    {
+        for (; i + 1 < count; i += 2)
+        {
+            int64_t low  = 0;
+            int64_t high = 0;
+
+            for (uint32_t stream = 0; stream < streamCount; stream++)
+            {
+                if (pSrcs[stream] != NULL)
+                {
+                    uint32_t in = *(const uint32_t *)&pSrcs[stream][i];
+                    low += AUDIO_DSP_MUL_BB(in, gainsQ15[stream]);
+                    high += AUDIO_DSP_MUL_TB(in, gainsQ15[stream]);
+                }
+            }
+
+            int32_t low32  = AUDIO_DSP_SAT32_64(AUDIO_DSP_Q15_ROUND(low));
+            int32_t high32 = AUDIO_DSP_SAT32_64(AUDIO_DSP_Q15_ROUND(high));
+
+            *(uint32_t *)&pDst[i] = AUDIO_DSP_PACK(AUDIO_DSP_SAT16(low32), AUDIO_DSP_SAT16(high32));
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        int64_t acc = 0;
+        int32_t acc32;
+
+        for (uint32_t stream = 0; stream < streamCount; stream++)
+        {
+            if (pSrcs[stream] != NULL)
+            {
+                acc += pSrcs[stream][i] * gainsQ15[stream];
+            }
+        }
+
+        acc32   = AUDIO_DSP_SAT32_64(AUDIO_DSP_Q15_ROUND(acc));
+        pDst[i] = AUDIO_DSP_SAT16(acc32);
+    }
+}
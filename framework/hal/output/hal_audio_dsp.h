@@ -0,0 +1,98 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief audio DSP kernels declaration.
+ * Fixed point kernels used on the speaker path: Q15 gain with a volume ramp, mono to stereo expansion and a mixer of
+ * several mono streams. All the samples are 16-bit signed PCM, the results are saturated.
+ */
+
+#ifndef _HAL_AUDIO_DSP_H_
+#define _HAL_AUDIO_DSP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+/* Unity gain in Q15 */
+#define AUDIO_DSP_GAIN_UNITY 32767
+
+typedef struct _audio_dsp_gain
+{
+    /* current gain, Q15 with 16 more fractional bits so the ramp can move by less than one Q15 step per sample */
+    int32_t current;
+    /* gain reached at the end of the ramp, Q15 */
+    int16_t target;
+    /* change of current per sample while ramping */
+    int32_t step;
+    /* samples left in the ramp */
+    uint32_t rampLeft;
+    /* length of a full ramp in samples */
+    uint32_t rampSamples;
+} audio_dsp_gain_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init a gain stage
+ * @param gain gain to init
+ * @param gainQ15 initial gain in Q15
+ * @param rampSamples number of samples over which a new target is reached, 0 to apply it immediately
+ */
+void HAL_AudioDsp_GainInit(audio_dsp_gain_t *gain, int16_t gainQ15, uint32_t rampSamples);
+
+/**
+ * @brief Set a new gain, reached linearly over rampSamples samples to avoid zipper noise
+ * @param gain gain to update
+ * @param gainQ15 new gain in Q15
+ */
+void HAL_AudioDsp_GainSetTarget(audio_dsp_gain_t *gain, int16_t gainQ15);
+
+/**
+ * @brief Apply a gain to a buffer of samples
+ * @param gain gain to apply, the ramp advances by count samples
+ * @param pSrc input samples
+ * @param pDst output samples, can be pSrc
+ * @param count number of samples
+ */
+void HAL_AudioDsp_ApplyGain(audio_dsp_gain_t *gain, const int16_t *pSrc, int16_t *pDst, uint32_t count);
+
+/**
+ * @brief Expand mono samples to interleaved stereo
+ * @param pSrc mono samples
+ * @param pDst stereo samples, 2 * count samples, word aligned
+ * @param count number of mono samples
+ * @param invertRight true to write the opposite of the sample on the right channel, for differential outputs
+ */
+void HAL_AudioDsp_MonoToStereo(const int16_t *pSrc, int16_t *pDst, uint32_t count, bool invertRight);
+
+/**
+ * @brief Mix mono streams
+ * @param pSrcs input streams, a NULL stream is skipped
+ * @param gainsQ15 gain of each stream in Q15
+ * @param streamCount number of streams
+ * @param pDst mixed samples
+ * @param count number of samples
+ */
+void HAL_AudioDsp_Mix(
+    const int16_t *const *pSrcs, const int16_t *gainsQ15, uint32_t streamCount, int16_t *pDst, uint32_t count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_AUDIO_DSP_H_ */
@@ -0,0 +1,347 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief audio prompt cache implementation.
+ * The entries are changed with the interrupts masked, the PCM is copied outside of the critical sections. An entry being
+ * filled has a size and a range of the pool but no PCM yet, it is neither returned nor evicted.
+ */
+
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "hal_audio_prompt_cache.h"
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+#define AUDIO_PROMPT_CACHE_FOOTPRINT(len) (((len) + AUDIO_PROMPT_CACHE_ALIGN - 1) & ~(AUDIO_PROMPT_CACHE_ALIGN - 1))
+
+static bool _HAL_AudioPromptCache_Evictable(const audio_prompt_cache_entry_t *entry)
+{
+    return (entry->pcm != NULL) && (entry->users == 0);
+}
+
+/* first free range of len bytes in the pool, the evictable entries are taken as free with skipEvictable */
+static uint8_t *_HAL_AudioPromptCache_FindRange(const audio_prompt_cache_t *cache, uint32_t len, bool skipEvictable)
+{
+    uint8_t *start = cache->pool;
+    uint8_t *end   = cache->pool + cache->budget;
+
+    len = AUDIO_PROMPT_CACHE_FOOTPRINT(len);
+    while ((uint32_t)(end - start) >= len)
+    {
+        uint8_t *next = NULL;
+
+        /* move past the entries overlapping the range */
+        for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+        {
+            const audio_prompt_cache_entry_t *entry = &cache->entries[i];
+            uint8_t *entryEnd                       = entry->slot + AUDIO_PROMPT_CACHE_FOOTPRINT(entry->len);
+
+            if ((entry->len == 0) || (skipEvictable && _HAL_AudioPromptCache_Evictable(entry)))
+            {
+                continue;
+            }
+
+            if ((entry->slot < start + len) && (entryEnd > start) && ((next == NULL) || (entryEnd > next)))
+            {
+                next = entryEnd;
+            }
+        }
+
+        if (next == NULL)
+        {
+            return start;
+        }
+        start = next;
+    }
+
+    return NULL;
+}
+
+static audio_prompt_cache_entry_t *_HAL_AudioPromptCache_Find(audio_prompt_cache_t *cache,
+                                                              int32_t promptId,
+                                                              uint32_t language)
+{
+    for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+    {
+        audio_prompt_cache_entry_t *entry = &cache->entries[i];
+
+        if ((entry->len != 0) && (entry->promptId == promptId) && (entry->language == language))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/* least recently used entry which can be evicted, NULL if all of them are free, being filled or playing */
+static audio_prompt_cache_entry_t *_HAL_AudioPromptCache_Victim(audio_prompt_cache_t *cache)
+{
+    audio_prompt_cache_entry_t *victim = NULL;
+
+    for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+    {
+        audio_prompt_cache_entry_t *entry = &cache->entries[i];
+
+        if (_HAL_AudioPromptCache_Evictable(entry) &&
+            ((victim == NULL) || ((int32_t)(entry->lastUse - victim->lastUse) < 0)))
+        {
+            victim = entry;
+        }
+    }
+
+    return victim;
+}
+
+static audio_prompt_cache_entry_t *_HAL_AudioPromptCache_FreeEntry(audio_prompt_cache_t *cache)
+{
+    for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+    {
+        if (cache->entries[i].len == 0)
+        {
+            return &cache->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* reserve an entry and a range of the pool for len bytes, evicting the least recently used prompts */
+static audio_prompt_cache_entry_t *_HAL_AudioPromptCache_Reserve(audio_prompt_cache_t *cache, uint32_t len)
+{
+    audio_prompt_cache_entry_t *entry = NULL;
+    uint8_t *slot                     = NULL;
+    bool freeEntry                    = false;
+
+    /* give up before evicting anything if the playing prompts leave no room */
+    for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+    {
+        if ((cache->entries[i].len == 0) || _HAL_AudioPromptCache_Evictable(&cache->entries[i]))
+        {
+            freeEntry = true;
+        }
+    }
+
+    if (!freeEntry || (_HAL_AudioPromptCache_FindRange(cache, len, true) == NULL))
+    {
+        return NULL;
+    }
+
+    while (1)
+    {
+        audio_prompt_cache_entry_t *victim;
+
+        if (entry == NULL)
+        {
+            entry = _HAL_AudioPromptCache_FreeEntry(cache);
+        }
+        slot = _HAL_AudioPromptCache_FindRange(cache, len, false);
+        if ((entry != NULL) && (slot != NULL))
+        {
+            break;
+        }
+
+        victim = _HAL_AudioPromptCache_Victim(cache);
+        cache->stats.usedBytes -= victim->len;
+        cache->stats.evictions++;
+        memset(victim, 0, sizeof(audio_prompt_cache_entry_t));
+    }
+
+    entry->slot = slot;
+    return entry;
+}
+
+void HAL_AudioPromptCache_Init(audio_prompt_cache_t *cache, uint8_t *pool, uint32_t size)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+
+    memset(cache, 0, sizeof(audio_prompt_cache_t));
+    cache->pool   = pool;
+    cache->budget = (pool != NULL) ? size : 0;
+}
+
+const uint8_t *HAL_AudioPromptCache_Get(audio_prompt_cache_t *cache,
+                                        int32_t promptId,
+                                        uint32_t language,
+                                        uint32_t *len)
+{
+    audio_prompt_cache_entry_t *entry;
+    const uint8_t *pcm = NULL;
+
+    if ((cache == NULL) || (len == NULL))
+    {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL();
+    entry = _HAL_AudioPromptCache_Find(cache, promptId, language);
+    if ((entry != NULL) && (entry->pcm != NULL))
+    {
+        entry->users++;
+        entry->lastUse = ++cache->useCounter;
+        pcm            = entry->pcm;
+        *len           = entry->len;
+        cache->stats.hits++;
+    }
+    else
+    {
+        cache->stats.misses++;
+    }
+    taskEXIT_CRITICAL();
+
+    return pcm;
+}
+
+bool HAL_AudioPromptCache_Contains(audio_prompt_cache_t *cache, int32_t promptId, uint32_t language)
+{
+    bool found;
+
+    if (cache == NULL)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    found = (_HAL_AudioPromptCache_Find(cache, promptId, language) != NULL);
+    taskEXIT_CRITICAL();
+
+    return found;
+}
+
+const uint8_t *HAL_AudioPromptCache_Put(audio_prompt_cache_t *cache,
+                                        int32_t promptId,
+                                        uint32_t language,
+                                        const uint8_t *pcm,
+                                        uint32_t len,
+                                        bool use)
+{
+    audio_prompt_cache_entry_t *entry = NULL;
+    uint8_t *copy                     = NULL;
+    bool cached                       = false;
+
+    if ((cache == NULL) || (cache->budget == 0) || (pcm == NULL) || (len == 0))
+    {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL();
+    entry = _HAL_AudioPromptCache_Find(cache, promptId, language);
+    if (entry != NULL)
+    {
+        /* cached meanwhile, or being cached by another task */
+        cached = true;
+        if ((entry->pcm != NULL) && use)
+        {
+            entry->users++;
+            entry->lastUse = ++cache->useCounter;
+            copy           = entry->pcm;
+        }
+    }
+    else if (len <= cache->budget)
+    {
+        entry = _HAL_AudioPromptCache_Reserve(cache, len);
+        if (entry != NULL)
+        {
+            entry->promptId = promptId;
+            entry->language = language;
+            entry->len      = len;
+            entry->users    = use ? 1 : 0;
+            entry->lastUse  = ++cache->useCounter;
+            cache->stats.usedBytes += len;
+        }
+    }
+
+    if ((entry == NULL) && !cached)
+    {
+        cache->stats.rejected++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (cached || (entry == NULL))
+    {
+        return copy;
+    }
+
+    /* the range is reserved, nothing else writes to it */
+    memcpy(entry->slot, pcm, len);
+
+    taskENTER_CRITICAL();
+    entry->pcm = entry->slot;
+    copy       = entry->pcm;
+    taskEXIT_CRITICAL();
+
+    return copy;
+}
+
+void HAL_AudioPromptCache_Release(audio_prompt_cache_t *cache, const uint8_t *pcm)
+{
+    if ((cache == NULL) || (pcm == NULL))
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < AUDIO_PROMPT_CACHE_MAX_ENTRIES; i++)
+    {
+        if ((cache->entries[i].pcm == pcm) && (cache->entries[i].users != 0))
+        {
+            cache->entries[i].users--;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+void HAL_AudioPromptCache_RecordFirstSample(audio_prompt_cache_t *cache, bool hit, uint32_t latencyUs)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if (hit)
+    {
+        cache->stats.lastHitFirstSampleUs = latencyUs;
+        if (latencyUs > cache->stats.maxHitFirstSampleUs)
+        {
+            cache->stats.maxHitFirstSampleUs = latencyUs;
+        }
+    }
+    else
+    {
+        cache->stats.lastMissFirstSampleUs = latencyUs;
+        if (latencyUs > cache->stats.maxMissFirstSampleUs)
+        {
+            cache->stats.maxMissFirstSampleUs = latencyUs;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+void HAL_AudioPromptCache_GetStats(const audio_prompt_cache_t *cache, audio_prompt_cache_stats_t *stats)
+{
+    if ((cache == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *stats = cache->stats;
+    taskEXIT_CRITICAL();
+}
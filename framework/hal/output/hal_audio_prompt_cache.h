@@ -0,0 +1,161 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief audio prompt cache declaration.
+ * Keeps the decoded PCM of the recently played prompts, keyed by prompt id and language, so a prompt played again
+ * does not go through the decoder. The PCM is copied to a pool given by the caller, the least recently used prompts
+ * which are not playing are evicted until the pool has a free range large enough for a new one.
+ */
+
+#ifndef _HAL_AUDIO_PROMPT_CACHE_H_
+#define _HAL_AUDIO_PROMPT_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Maximum number of prompts kept in a cache */
+#ifndef AUDIO_PROMPT_CACHE_MAX_ENTRIES
+#define AUDIO_PROMPT_CACHE_MAX_ENTRIES (16)
+#endif /* AUDIO_PROMPT_CACHE_MAX_ENTRIES */
+
+/* Alignment of the PCM in the pool */
+#define AUDIO_PROMPT_CACHE_ALIGN (4)
+
+typedef struct _audio_prompt_cache_entry
+{
+    /* decoded PCM, NULL while the entry is free or being filled */
+    uint8_t *pcm;
+    /* range of the pool reserved for the PCM, set before it is filled */
+    uint8_t *slot;
+    /* size of the PCM in bytes, 0 when the entry is free */
+    uint32_t len;
+    int32_t promptId;
+    uint32_t language;
+    /* voices playing the PCM, the entry is only evicted when it is 0 */
+    uint32_t users;
+    /* value of the use counter of the cache at the last lookup */
+    uint32_t lastUse;
+} audio_prompt_cache_entry_t;
+
+typedef struct _audio_prompt_cache_stats
+{
+    /* prompts played from the cache */
+    uint32_t hits;
+    /* prompts which had to be decoded */
+    uint32_t misses;
+    /* prompts evicted to make room for another one */
+    uint32_t evictions;
+    /* decoded prompts which could not be cached, too large or no room left by the playing ones */
+    uint32_t rejected;
+    /* bytes of PCM in the cache */
+    uint32_t usedBytes;
+    /* time between the play request and the first sample mixed, in us */
+    uint32_t lastHitFirstSampleUs;
+    uint32_t maxHitFirstSampleUs;
+    uint32_t lastMissFirstSampleUs;
+    uint32_t maxMissFirstSampleUs;
+} audio_prompt_cache_stats_t;
+
+typedef struct _audio_prompt_cache
+{
+    audio_prompt_cache_entry_t entries[AUDIO_PROMPT_CACHE_MAX_ENTRIES];
+    /* pool holding the PCM and its size in bytes, 0 disables the cache */
+    uint8_t *pool;
+    uint32_t budget;
+    uint32_t useCounter;
+    audio_prompt_cache_stats_t stats;
+} audio_prompt_cache_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init an empty cache
+ * @param cache cache to init
+ * @param pool memory holding the cached PCM, aligned on AUDIO_PROMPT_CACHE_ALIGN, NULL to disable the cache
+ * @param size size of the pool in bytes, 0 to disable the cache
+ */
+void HAL_AudioPromptCache_Init(audio_prompt_cache_t *cache, uint8_t *pool, uint32_t size);
+
+/**
+ * @brief Look up the PCM of a prompt, a hit must be released once played
+ * @param cache cache of the prompts
+ * @param promptId id of the prompt
+ * @param language language of the prompt
+ * @param len size of the PCM in bytes
+ * @return the cached PCM, NULL on a miss
+ */
+const uint8_t *HAL_AudioPromptCache_Get(audio_prompt_cache_t *cache,
+                                        int32_t promptId,
+                                        uint32_t language,
+                                        uint32_t *len);
+
+/**
+ * @brief Check if the PCM of a prompt is cached, without counting a hit or a miss
+ * @param cache cache of the prompts
+ * @param promptId id of the prompt
+ * @param language language of the prompt
+ * @return true if the prompt is cached or being cached
+ */
+bool HAL_AudioPromptCache_Contains(audio_prompt_cache_t *cache, int32_t promptId, uint32_t language);
+
+/**
+ * @brief Copy the decoded PCM of a prompt to the cache
+ * @param cache cache of the prompts
+ * @param promptId id of the prompt
+ * @param language language of the prompt
+ * @param pcm decoded PCM
+ * @param len size of the PCM in bytes
+ * @param use true to take a reference on the cached PCM, which must then be released once played
+ * @return the cached PCM, NULL if it could not be cached
+ */
+const uint8_t *HAL_AudioPromptCache_Put(audio_prompt_cache_t *cache,
+                                        int32_t promptId,
+                                        uint32_t language,
+                                        const uint8_t *pcm,
+                                        uint32_t len,
+                                        bool use);
+
+/**
+ * @brief Release the PCM returned by HAL_AudioPromptCache_Get or HAL_AudioPromptCache_Put, once played
+ * @param cache cache of the prompts
+ * @param pcm cached PCM
+ */
+void HAL_AudioPromptCache_Release(audio_prompt_cache_t *cache, const uint8_t *pcm);
+
+/**
+ * @brief Record the time to the first sample of a prompt
+ * @param cache cache of the prompts
+ * @param hit true if the prompt was played from the cache
+ * @param latencyUs time between the play request and the first sample mixed, in us
+ */
+void HAL_AudioPromptCache_RecordFirstSample(audio_prompt_cache_t *cache, bool hit, uint32_t latencyUs);
+
+/**
+ * @brief Get the statistics of a cache
+ * @param cache cache of the prompts
+ * @param stats statistics
+ */
+void HAL_AudioPromptCache_GetStats(const audio_prompt_cache_t *cache, audio_prompt_cache_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_AUDIO_PROMPT_CACHE_H_ */
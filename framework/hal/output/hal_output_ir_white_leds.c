@@ -311,6 +311,27 @@ static hal_output_status_t HAL_OutputDev_IrWhiteLeds_InputNotify(const output_de
         }
         break;
 
+        case kEventID_GetWhiteLedBrightness:
+        {
+            white_led_event_t whiteLedBrightness;
+            whiteLedBrightness.brightness = s_OutputDev_IrWhiteLeds.configs[kLEDType_White].value;
+            _HAL_OutputDev_IrWhiteLeds_Response(eventBase, &whiteLedBrightness, eventResponse, true);
+        }
+        break;
+
+        case kEventID_SetWhiteLedBrightness:
+        {
+            /* also sent by the camera manager auto exposure */
+            event_common_t event = *(event_common_t *)data;
+            error                = set_led_brightness(kLEDType_White, event.whiteLed.brightness);
+            if (!error)
+            {
+                s_OutputDev_IrWhiteLeds.configs[kLEDType_White].value = event.whiteLed.brightness;
+                _HAL_OutputDev_IrWhiteLeds_Response(eventBase, &event.whiteLed.brightness, eventResponse, true);
+            }
+        }
+        break;
+
         default:
             return error;
             break;
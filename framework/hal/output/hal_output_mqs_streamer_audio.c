@@ -35,6 +35,8 @@
 #include "hal_event_descriptor_voice.h"
 #include "smart_tlhmi_event_descriptor.h"
 #include "hal_output_dev.h"
+#include "hal_audio_dsp.h"
+#include "hal_audio_prompt_cache.h"
 
 #include "app_config.h"
 
@@ -81,6 +83,43 @@ struct _pcm_rtos_t
 /* PROMPTS_AUDIO_CHUNK_SIZE = 1600 * 2 => 100ms at 16KHz/16bit/mono */
 #define PROMPTS_AUDIO_CHUNK_MS   (100)
 #define PROMPTS_AUDIO_CHUNK_SIZE (PROMPTS_AUDIO_CHUNK_MS * PROMPTS_AUDIO_CHUNK_SIZE_1MS)
+#define PROMPTS_AUDIO_CHUNK_SAMPLES (PROMPTS_AUDIO_CHUNK_SIZE / 2)
+
+/* Number of prompts which can play at the same time, over the music or over each other */
+#ifndef MQS_MIXER_VOICE_CNT
+#define MQS_MIXER_VOICE_CNT (2)
+#endif /* MQS_MIXER_VOICE_CNT */
+
+/* Gain of the music while a prompt plays over it, in Q15 */
+#ifndef MQS_MIXER_DUCK_GAIN
+#define MQS_MIXER_DUCK_GAIN (AUDIO_DSP_GAIN_UNITY / 2)
+#endif /* MQS_MIXER_DUCK_GAIN */
+
+/* Volume changes are ramped over MQS_VOLUME_RAMP_MS to avoid clicks */
+#define MQS_VOLUME_RAMP_MS (20)
+
+/* The music is ducked and restored over MQS_MIXER_DUCK_RAMP_MS */
+#ifndef MQS_MIXER_DUCK_RAMP_MS
+#define MQS_MIXER_DUCK_RAMP_MS (50)
+#endif /* MQS_MIXER_DUCK_RAMP_MS */
+
+#define MQS_PROMPT_TASK_NAME       "MqsPrompt"
+#define MQS_PROMPT_TASK_STACK_SIZE (1024)
+
+/* Bytes of SDRAM kept for the decoded PCM of the recently played prompts, 0 to decode them each time.
+ * Only worth it when APP_OutputDev_MqsAudio_InputNotifyDecode runs a real decoder, raw PCM prompts mapped from
+ * flash would just be copied to the SDRAM */
+#ifndef MQS_PROMPT_CACHE_SIZE
+#define MQS_PROMPT_CACHE_SIZE 0
+#endif /* MQS_PROMPT_CACHE_SIZE */
+
+/* The prompts are warmed up once the music stops, its decoder runs on the same core */
+#define MQS_PROMPT_WARMUP_RETRY_MS (1000)
+
+/* Log the prompt cache statistics every MQS_PROMPT_STATS_LOG_PERIOD prompts, 0 to disable */
+#ifndef MQS_PROMPT_STATS_LOG_PERIOD
+#define MQS_PROMPT_STATS_LOG_PERIOD 0
+#endif /* MQS_PROMPT_STATS_LOG_PERIOD */
 
 #if !AMP_LOOPBACK_DISABLED
 /* MQS_FEEDBACK_CHUNK_SIZE should be PROMPTS_AUDIO_CHUNK_SIZE because prompt audio and Mics are 16KHz
@@ -95,6 +134,8 @@ extern "C" {
 #endif
 void BOARD_InitMqsResource(void);
 int HAL_OutputDev_MqsAudio_Register();
+void HAL_OutputDev_MqsAudio_WarmupPrompts(void);
+void HAL_OutputDev_MqsAudio_GetPromptStats(audio_prompt_cache_stats_t *stats);
 static hal_output_status_t HAL_OutputDev_MqsAudio_Init(output_dev_t *dev, output_dev_callback_t callback);
 static hal_output_status_t HAL_OutputDev_MqsAudio_Start(const output_dev_t *dev);
 static status_t _GetVolume(char *valueToString);
@@ -127,6 +168,49 @@ volatile bool g_MQSPlaying = false;
  */
 static uint8_t asrEnabled = true;
 
+/* Prompt played by the mixer, a voice is free when remaining is 0 */
+typedef struct _mqs_mixer_voice
+{
+    const int16_t *data;
+    uint32_t remaining;
+    int32_t promptId;
+    uint8_t asrEnabled;
+    /* PCM taken from the prompt cache, released when the prompt ends */
+    const uint8_t *cached;
+    /* time of the play request */
+    uint32_t requestUs;
+    uint8_t cacheHit;
+    /* the first sample was mixed */
+    uint8_t started;
+} mqs_mixer_voice_t;
+
+static mqs_mixer_voice_t s_MqsMixerVoices[MQS_MIXER_VOICE_CNT];
+SDK_ALIGN(static int16_t s_MqsMixBuffer[PROMPTS_AUDIO_CHUNK_SAMPLES], 4);
+
+static audio_prompt_cache_t s_MqsPromptCache;
+#if MQS_PROMPT_CACHE_SIZE > 0
+__attribute__((section(".bss.$BOARD_SDRAM"), aligned(AUDIO_PROMPT_CACHE_ALIGN))) static uint8_t
+    s_MqsPromptCachePool[MQS_PROMPT_CACHE_SIZE];
+#define MQS_PROMPT_CACHE_POOL s_MqsPromptCachePool
+#else
+#define MQS_PROMPT_CACHE_POOL NULL
+#endif /* MQS_PROMPT_CACHE_SIZE > 0 */
+/* next prompt to decode in the background for the current language, -1 when the warmup is done */
+static volatile int32_t s_MqsWarmupPromptId = -1;
+
+/* Volume applied to the mixed samples, updated when the configured volume changes */
+static audio_dsp_gain_t s_MqsGain;
+static uint32_t s_MqsGainVolume;
+
+/* Gain of the music, ramped down while a prompt plays over it */
+static audio_dsp_gain_t s_MqsDuckGain;
+static bool s_MqsDucked;
+SDK_ALIGN(static int16_t s_MqsDuckBuffer[PROMPTS_AUDIO_CHUNK_SAMPLES], 4);
+
+/* Serializes the chunks written by the streamer and by the prompt task */
+static SemaphoreHandle_t s_MqsWriteLock;
+static TaskHandle_t s_MqsPromptTaskHandle;
+
 static AT_NONCACHEABLE_SECTION_ALIGN(pcm_rtos_t pcmHandle, 4);
 static STREAMER_T *streamer;
 
@@ -185,9 +269,8 @@ static output_dev_t s_OutputDev_MqsAudio = {
     .cap.callback = NULL,
 };
 
-static void _AdjustVolumeMonoToStereo(int16_t *src_mono, int16_t *dst_stereo, uint32_t sample_cnt);
+static bool _MqsWriteChunk(pcm_rtos_t *pcm, const int16_t *music, uint32_t sampleCnt);
 #if !AMP_LOOPBACK_DISABLED
-static void _AdjustVolumeMonoToMono(int16_t *src_mono, int16_t *dst_mono, uint32_t sample_cnt);
 static void _SpeakerToAfeNotify(int16_t *buffer, uint32_t length);
 #endif /* AMP_LOOPBACK_DISABLED */
 
@@ -209,6 +292,19 @@ __attribute__((weak)) int APP_OutputDev_MqsAudio_InputNotifyDecode(
     return 0;
 }
 
+/* Number of prompts decoded by APP_OutputDev_MqsAudio_InputNotifyDecode, their ids go from 0 to count - 1 */
+__attribute__((weak)) uint32_t APP_OutputDev_MqsAudio_GetPromptCount(void)
+{
+    return 0;
+}
+
+/* Id of the prompt APP_OutputDev_MqsAudio_InferCompleteDecode would decode, -1 if the result plays no known prompt */
+__attribute__((weak)) int32_t APP_OutputDev_MqsAudio_InferCompletePromptId(output_algo_source_t source,
+                                                                            void *inferResult)
+{
+    return -1;
+}
+
 static void _SendTrackEvent(event_smart_tlhmi_t *trackInfoEvent, event_info_t eventInfo)
 {
     output_event_t output_event = {0};
@@ -575,20 +671,12 @@ void streamer_pcm_rx_close(pcm_rtos_t *pcm)
 
 int streamer_pcm_write(pcm_rtos_t *pcm, uint8_t *data, uint32_t size)
 {
-    bool statusOk                      = true;
-    status_t transferStatus            = kStatus_Success;
-    static uint8_t mqsAudioPoolSlotIdx = 0;
-
     if (pcm->justLoadMetadata == true)
     {
         streamer_set_state(streamer, 0, STATE_PAUSED, false);
         return 0;
     }
 
-#if !AMP_LOOPBACK_DISABLED
-    static uint8_t mqsFeedbackPoolSlotIdx = 0;
-#endif /* !AMP_LOOPBACK_DISABLED */
-
 #if !AMP_LOOPBACK_DISABLED
     if (asrEnabled == 0)
     {
@@ -598,49 +686,9 @@ int streamer_pcm_write(pcm_rtos_t *pcm, uint8_t *data, uint32_t size)
     g_MQSPlaying = true;
 #endif /* AMP_LOOPBACK_DISABLED */
 
-    /* A new slot should be available in one PROMPTS_AUDIO_CHUNK_MS.
-     * In case there is no empty slot in two PROMPTS_AUDIO_CHUNK_MS, something is wrong. */
-    if (xSemaphoreTake(pcmHandle.MqsSemFreeSlots, (TickType_t)(2 * PROMPTS_AUDIO_CHUNK_MS)) != pdTRUE)
-    {
-        LOGE("[MQS] Playing Failed, played %d samples (%d ms)", size / 2, (size / PROMPTS_AUDIO_CHUNK_MS));
-        statusOk = false;
-    }
-
     assert(size <= PROMPTS_AUDIO_CHUNK_SIZE);
 
-    if (statusOk == true)
-    {
-        _AdjustVolumeMonoToStereo((int16_t *)data, (int16_t *)s_MqsStreamPool[mqsAudioPoolSlotIdx], size / 2);
-
-#if !AMP_LOOPBACK_DISABLED
-        if (asrEnabled == 1)
-        {
-            _AdjustVolumeMonoToMono((int16_t *)(data), (int16_t *)(s_MqsAfeFeedback[mqsFeedbackPoolSlotIdx]), size / 2);
-        }
-#endif /* !AMP_LOOPBACK_DISABLED */
-
-        pcm->saiTx.data     = s_MqsStreamPool[mqsAudioPoolSlotIdx];
-        pcm->saiTx.dataSize = size << 1;
-
-        /* Play this chunk */
-        transferStatus = SAI_TransferSendEDMA(MQS_SAI, &pcm->saiTxHandle, &pcm->saiTx);
-        if (transferStatus != kStatus_Success)
-        {
-            LOGE("[MQS] SAI_TransferSendEDMA failed %d for %d samples", transferStatus, pcm->saiTx.dataSize);
-            statusOk = false;
-        }
-
-#if !AMP_LOOPBACK_DISABLED
-        if (asrEnabled == 1)
-        {
-            /* Notify AFE in order to perform AEC */
-            _SpeakerToAfeNotify((int16_t *)s_MqsAfeFeedback[mqsFeedbackPoolSlotIdx], size / 2);
-            mqsFeedbackPoolSlotIdx = (mqsFeedbackPoolSlotIdx + 1) % MQS_FEEDBACK_CHUNK_CNT;
-        }
-#endif /* !AMP_LOOPBACK_DISABLED */
-
-        mqsAudioPoolSlotIdx = (mqsAudioPoolSlotIdx + 1) % MQS_AUDIO_CHUNK_CNT;
-    }
+    _MqsWriteChunk(pcm, (const int16_t *)data, size / 2);
 
     return 0;
 }
@@ -691,83 +739,550 @@ static float _AdaptVolume(uint32_t volume)
     return (-0.0018 * pow(volume, 3) + 0.028 * pow(volume, 2));
 }
 
+#if !AMP_LOOPBACK_DISABLED
+static void _SpeakerToAfeNotify(int16_t *buffer, uint32_t length)
+{
+    event_voice_t feedbackEvent = {0};
+    output_event_t output_event = {0};
+
+    if (s_OutputDev_MqsAudio.cap.callback != NULL)
+    {
+        output_event.eventId   = kOutputEvent_SpeakerToAfeFeedback;
+        output_event.data      = &feedbackEvent;
+        output_event.copy      = 1;
+        output_event.size      = sizeof(feedbackEvent);
+        output_event.eventInfo = kEventInfo_Local;
+
+        feedbackEvent.event_base.eventId         = SPEAKER_TO_AFE_FEEDBACK;
+        feedbackEvent.speaker_audio.start_time   = FWK_CurrentTimeUs();
+        feedbackEvent.speaker_audio.audio_stream = buffer;
+        feedbackEvent.speaker_audio.audio_length = length;
+
+        s_OutputDev_MqsAudio.cap.callback(s_OutputDev_MqsAudio.id, output_event, 0);
+    }
+}
+#endif /* !AMP_LOOPBACK_DISABLED */
+
+/* Q15 gain of the volume curve */
+static int16_t _VolumeToGain(uint32_t volume)
+{
+    return (int16_t)(_AdaptVolume(volume) * AUDIO_DSP_GAIN_UNITY + 0.5f);
+}
+
+static void _PromptDoneNotify(int32_t promptId)
+{
+    static event_common_t s_PlayPromptDoneEvent;
+    output_event_t output_event = {0};
+
+    if (s_OutputDev_MqsAudio.cap.callback != NULL)
+    {
+        output_event.eventId   = kOutputEvent_OutputInputNotify;
+        output_event.data      = &s_PlayPromptDoneEvent;
+        output_event.copy      = 1;
+        output_event.size      = sizeof(s_PlayPromptDoneEvent);
+        output_event.eventInfo = kEventInfo_DualCore;
+
+        s_PlayPromptDoneEvent.eventBase.eventId = kEventID_PlayPromptDone;
+        s_PlayPromptDoneEvent.data              = (void *)promptId;
+
+        s_OutputDev_MqsAudio.cap.callback(s_OutputDev_MqsAudio.id, output_event, 0);
+    }
+}
+
+/* cached is set when the buffer comes from the prompt cache, hit when it was found there without decoding */
+static bool _MqsMixerAddVoice(int32_t promptId,
+                              const uint8_t *buffer,
+                              uint32_t size,
+                              uint8_t asrEnabled,
+                              bool cached,
+                              bool hit,
+                              uint32_t requestUs)
+{
+    bool added = false;
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < MQS_MIXER_VOICE_CNT; i++)
+    {
+        if (s_MqsMixerVoices[i].remaining == 0)
+        {
+            s_MqsMixerVoices[i].data       = (const int16_t *)buffer;
+            s_MqsMixerVoices[i].promptId   = promptId;
+            s_MqsMixerVoices[i].asrEnabled = asrEnabled;
+            s_MqsMixerVoices[i].cached     = cached ? buffer : NULL;
+            s_MqsMixerVoices[i].requestUs  = requestUs;
+            s_MqsMixerVoices[i].cacheHit   = hit;
+            s_MqsMixerVoices[i].started    = 0;
+            s_MqsMixerVoices[i].remaining  = size / 2;
+            added                          = true;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return added;
+}
+
+/* Record the time to the first sample of the prompts starting in this chunk */
+static void _MqsPromptFirstSample(const uint32_t *requestUs, const bool *hit, uint32_t count)
+{
+    uint32_t now = FWK_CurrentTimeUs();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        HAL_AudioPromptCache_RecordFirstSample(&s_MqsPromptCache, hit[i], now - requestUs[i]);
+    }
+
+#if MQS_PROMPT_STATS_LOG_PERIOD
+    static uint32_t s_PromptCount = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if ((++s_PromptCount % MQS_PROMPT_STATS_LOG_PERIOD) == 0)
+        {
+            audio_prompt_cache_stats_t stats;
+            uint32_t lookups;
+
+            HAL_AudioPromptCache_GetStats(&s_MqsPromptCache, &stats);
+            lookups = stats.hits + stats.misses;
+            LOGI("[MQS] Prompt cache: hits %d/%d (%d%%) evictions %d rejected %d used %d bytes", stats.hits, lookups,
+                 (lookups != 0) ? (stats.hits * 100 / lookups) : 0, stats.evictions, stats.rejected,
+                 stats.usedBytes);
+            LOGI("[MQS] Prompt first sample: hit %d/%d us miss %d/%d us", stats.lastHitFirstSampleUs,
+                 stats.maxHitFirstSampleUs, stats.lastMissFirstSampleUs, stats.maxMissFirstSampleUs);
+        }
+    }
+#endif /* MQS_PROMPT_STATS_LOG_PERIOD */
+}
+
+/* Returns true while a prompt is playing, asrPaused is set if one of them asked to pause the ASR */
+static bool _MqsMixerIsActive(bool *asrPaused)
+{
+    bool active = false;
+
+    *asrPaused = false;
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < MQS_MIXER_VOICE_CNT; i++)
+    {
+        if (s_MqsMixerVoices[i].remaining != 0)
+        {
+            active = true;
+            if (s_MqsMixerVoices[i].asrEnabled == 0)
+            {
+                *asrPaused = true;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return active;
+}
+
 /*!
- * Expand audio mono to stereo in difference. And adjust the volume simultaneously.
- *
+ * Mix the music with the playing prompts. The music is ducked while a prompt plays over it and is NULL when only the
+ * prompts are played. Called with s_MqsWriteLock held.
  */
-static void _AdjustVolumeMonoToStereo(int16_t *src_mono, int16_t *dst_stereo, uint32_t sample_cnt)
+static void _MqsMix(const int16_t *music, int16_t *mix, uint32_t sampleCnt)
 {
-    uint32_t i;
-    float volume;
+    const int16_t *srcs[MQS_MIXER_VOICE_CNT + 1];
+    int16_t gains[MQS_MIXER_VOICE_CNT + 1];
+    uint32_t remaining[MQS_MIXER_VOICE_CNT];
+    bool playing[MQS_MIXER_VOICE_CNT];
+    int32_t donePrompts[MQS_MIXER_VOICE_CNT];
+    const uint8_t *doneCached[MQS_MIXER_VOICE_CNT];
+    uint32_t requestUs[MQS_MIXER_VOICE_CNT];
+    bool hit[MQS_MIXER_VOICE_CNT];
+    uint32_t startCnt = 0;
+    uint32_t doneCnt  = 0;
+    uint32_t offset  = 0;
+    bool prompting   = false;
+
+    /* new prompts only take free voices, the playing ones are only advanced here */
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < MQS_MIXER_VOICE_CNT; i++)
+    {
+        remaining[i] = s_MqsMixerVoices[i].remaining;
+        playing[i]   = (remaining[i] != 0);
+        srcs[i + 1]  = playing[i] ? s_MqsMixerVoices[i].data : NULL;
+        gains[i + 1] = AUDIO_DSP_GAIN_UNITY;
+
+        if (playing[i])
+        {
+            prompting = true;
+            if (!s_MqsMixerVoices[i].started)
+            {
+                s_MqsMixerVoices[i].started = 1;
+                requestUs[startCnt]         = s_MqsMixerVoices[i].requestUs;
+                hit[startCnt++]             = s_MqsMixerVoices[i].cacheHit;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
 
-    /* The volume is decreased by multiplying the samples with values between 0 and 1 */
-    volume = _AdaptVolume(s_OutputDev_MqsAudio.configs[kMQSConfigs_Volume].value);
+    if (startCnt != 0)
+    {
+        _MqsPromptFirstSample(requestUs, hit, startCnt);
+    }
 
-    for (i = 0; i < sample_cnt; i++)
+    if (prompting != s_MqsDucked)
     {
-        *dst_stereo       = (*src_mono) * volume;
-        *(dst_stereo + 1) = -(*dst_stereo);
+        s_MqsDucked = prompting;
+        HAL_AudioDsp_GainSetTarget(&s_MqsDuckGain, prompting ? MQS_MIXER_DUCK_GAIN : AUDIO_DSP_GAIN_UNITY);
+    }
 
-        dst_stereo += 2;
-        src_mono++;
+    /* the ramp only advances with the music, it resumes from where it stopped when the music comes back */
+    if (music != NULL)
+    {
+        HAL_AudioDsp_ApplyGain(&s_MqsDuckGain, music, s_MqsDuckBuffer, sampleCnt);
+        music = s_MqsDuckBuffer;
+    }
+
+    srcs[0]  = music;
+    gains[0] = AUDIO_DSP_GAIN_UNITY;
+
+    /* mix up to the end of the chunk or of the shortest prompt */
+    while (offset < sampleCnt)
+    {
+        uint32_t segment = sampleCnt - offset;
+
+        for (uint32_t i = 0; i < MQS_MIXER_VOICE_CNT; i++)
+        {
+            if ((srcs[i + 1] != NULL) && (remaining[i] < segment))
+            {
+                segment = remaining[i];
+            }
+        }
+
+        HAL_AudioDsp_Mix(srcs, gains, MQS_MIXER_VOICE_CNT + 1, &mix[offset], segment);
+
+        offset += segment;
+        if (srcs[0] != NULL)
+        {
+            srcs[0] += segment;
+        }
+
+        for (uint32_t i = 0; i < MQS_MIXER_VOICE_CNT; i++)
+        {
+            if (srcs[i + 1] != NULL)
+            {
+                srcs[i + 1] += segment;
+                remaining[i] -= segment;
+                if (remaining[i] == 0)
+                {
+                    srcs[i + 1] = NULL;
+                }
+            }
+        }
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < MQS_MIXER_VOICE_CNT; i++)
+    {
+        if (playing[i])
+        {
+            s_MqsMixerVoices[i].data      = srcs[i + 1];
+            s_MqsMixerVoices[i].remaining = remaining[i];
+            if (remaining[i] == 0)
+            {
+                doneCached[doneCnt]    = s_MqsMixerVoices[i].cached;
+                donePrompts[doneCnt++] = s_MqsMixerVoices[i].promptId;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint32_t i = 0; i < doneCnt; i++)
+    {
+        HAL_AudioPromptCache_Release(&s_MqsPromptCache, doneCached[i]);
+        _PromptDoneNotify(donePrompts[i]);
     }
 }
 
+/*!
+ * Mix a chunk, apply the volume, expand it to the differential stereo of the MQS and play it.
+ * The mono mix is also sent to the AFE as speaker feedback.
+ */
+static bool _MqsWriteChunk(pcm_rtos_t *pcm, const int16_t *music, uint32_t sampleCnt)
+{
+    static uint8_t mqsAudioPoolSlotIdx = 0;
+#if !AMP_LOOPBACK_DISABLED
+    static uint8_t mqsFeedbackPoolSlotIdx = 0;
+#endif /* !AMP_LOOPBACK_DISABLED */
+    bool statusOk           = true;
+    status_t transferStatus = kStatus_Success;
+    uint32_t volume         = s_OutputDev_MqsAudio.configs[kMQSConfigs_Volume].value;
+
+    xSemaphoreTake(s_MqsWriteLock, portMAX_DELAY);
+
+    /* A new slot should be available in one PROMPTS_AUDIO_CHUNK_MS.
+     * In case there is no empty slot in two PROMPTS_AUDIO_CHUNK_MS, something is wrong. */
+    if (xSemaphoreTake(pcm->MqsSemFreeSlots, (TickType_t)(2 * PROMPTS_AUDIO_CHUNK_MS)) != pdTRUE)
+    {
+        LOGE("[MQS] Playing Failed, played %d samples (%d ms)", sampleCnt,
+             (sampleCnt * 2 / PROMPTS_AUDIO_CHUNK_SIZE_1MS));
+        statusOk = false;
+    }
+
+    if (statusOk == true)
+    {
+        if (volume != s_MqsGainVolume)
+        {
+            s_MqsGainVolume = volume;
+            HAL_AudioDsp_GainSetTarget(&s_MqsGain, _VolumeToGain(volume));
+        }
+
+        _MqsMix(music, s_MqsMixBuffer, sampleCnt);
+        HAL_AudioDsp_ApplyGain(&s_MqsGain, s_MqsMixBuffer, s_MqsMixBuffer, sampleCnt);
+        HAL_AudioDsp_MonoToStereo(s_MqsMixBuffer, (int16_t *)s_MqsStreamPool[mqsAudioPoolSlotIdx], sampleCnt, true);
+
+#if !AMP_LOOPBACK_DISABLED
+        if (asrEnabled == 1)
+        {
+            memcpy(s_MqsAfeFeedback[mqsFeedbackPoolSlotIdx], s_MqsMixBuffer, sampleCnt * sizeof(int16_t));
+        }
+#endif /* !AMP_LOOPBACK_DISABLED */
+
+        pcm->saiTx.data     = s_MqsStreamPool[mqsAudioPoolSlotIdx];
+        pcm->saiTx.dataSize = sampleCnt * 2 * sizeof(int16_t);
+
+        /* Play this chunk */
+        transferStatus = SAI_TransferSendEDMA(MQS_SAI, &pcm->saiTxHandle, &pcm->saiTx);
+        if (transferStatus != kStatus_Success)
+        {
+            LOGE("[MQS] SAI_TransferSendEDMA failed %d for %d samples", transferStatus, pcm->saiTx.dataSize);
+            statusOk = false;
+        }
+
 #if !AMP_LOOPBACK_DISABLED
-static void _AdjustVolumeMonoToMono(int16_t *src_mono, int16_t *dst_mono, uint32_t sample_cnt)
+        if (asrEnabled == 1)
+        {
+            /* Notify AFE in order to perform AEC */
+            _SpeakerToAfeNotify((int16_t *)s_MqsAfeFeedback[mqsFeedbackPoolSlotIdx], sampleCnt);
+            mqsFeedbackPoolSlotIdx = (mqsFeedbackPoolSlotIdx + 1) % MQS_FEEDBACK_CHUNK_CNT;
+        }
+#endif /* !AMP_LOOPBACK_DISABLED */
+
+        mqsAudioPoolSlotIdx = (mqsAudioPoolSlotIdx + 1) % MQS_AUDIO_CHUNK_CNT;
+    }
+
+    xSemaphoreGive(s_MqsWriteLock);
+
+    return statusOk;
+}
+
+/*!
+ * Decode the next prompt of the current language to the cache. The warmup stops once all the prompts are cached or
+ * when it starts evicting the prompts it cached.
+ */
+static void _MqsPromptWarmup(void)
 {
-    uint32_t i;
-    float volume;
+    static event_common_t s_WarmupEvent;
+    audio_prompt_cache_stats_t before;
+    audio_prompt_cache_stats_t after;
+    uint8_t *audioBuffer = NULL;
+    uint32_t audioLen    = 0;
+    int32_t promptId;
 
-    volume = _AdaptVolume(s_OutputDev_MqsAudio.configs[kMQSConfigs_Volume].value);
+    taskENTER_CRITICAL();
+    promptId = s_MqsWarmupPromptId;
+    if ((promptId >= 0) && ((uint32_t)promptId + 1 < APP_OutputDev_MqsAudio_GetPromptCount()))
+    {
+        s_MqsWarmupPromptId = promptId + 1;
+    }
+    else
+    {
+        s_MqsWarmupPromptId = -1;
+    }
+    taskEXIT_CRITICAL();
 
-    for (i = 0; i < sample_cnt; i++)
+    if ((promptId < 0) || HAL_AudioPromptCache_Contains(&s_MqsPromptCache, promptId, s_Language))
     {
-        /* The volume is decreased by multiplying the samples with values between 0 and 1 */
-        *dst_mono = (*src_mono) * volume;
+        return;
+    }
 
-        dst_mono++;
-        src_mono++;
+    memset(&s_WarmupEvent, 0, sizeof(s_WarmupEvent));
+    s_WarmupEvent.eventBase.eventId = kEventID_PlayPrompt;
+    s_WarmupEvent.promptInfo.id     = promptId;
+
+    APP_OutputDev_MqsAudio_InputNotifyDecode(&s_OutputDev_MqsAudio, &s_WarmupEvent, (void *)&audioBuffer, &audioLen,
+                                             s_Language);
+    if (audioBuffer != NULL && audioLen != 0)
+    {
+        HAL_AudioPromptCache_GetStats(&s_MqsPromptCache, &before);
+        HAL_AudioPromptCache_Put(&s_MqsPromptCache, promptId, s_Language, audioBuffer, audioLen, false);
+        HAL_AudioPromptCache_GetStats(&s_MqsPromptCache, &after);
+
+        if ((after.evictions != before.evictions) || (after.rejected != before.rejected))
+        {
+            LOGD("[MQS] Prompt cache full, warmup stopped at prompt %d", promptId);
+            s_MqsWarmupPromptId = -1;
+        }
     }
 }
 
-static void _SpeakerToAfeNotify(int16_t *buffer, uint32_t length)
+/*!
+ * Plays the prompts when no music is playing. While the music plays, its chunks carry the prompts.
+ */
+static void _MqsPromptTask(void *param)
 {
-    event_voice_t feedbackEvent = {0};
-    output_event_t output_event = {0};
+    while (1)
+    {
+        bool ampEnabled  = false;
+        bool asrPaused   = false;
+        bool pausedByMix = false;
+        TickType_t wait  = portMAX_DELAY;
 
-    if (s_OutputDev_MqsAudio.cap.callback != NULL)
+        if ((s_MqsWarmupPromptId >= 0) && (streamer != NULL))
+        {
+            PipelineState curState = STATE_NULL;
+            streamer_get_state(streamer, 0, &curState, false);
+            wait = (curState == STATE_PLAYING) ? MQS_PROMPT_WARMUP_RETRY_MS : 0;
+        }
+
+        if (ulTaskNotifyTake(pdTRUE, wait) == 0)
+        {
+            if (wait == 0)
+            {
+                _MqsPromptWarmup();
+            }
+            continue;
+        }
+
+        while (_MqsMixerIsActive(&asrPaused))
+        {
+            PipelineState curState = STATE_NULL;
+            streamer_get_state(streamer, 0, &curState, false);
+
+            if (asrPaused)
+            {
+                g_MQSPlaying = true;
+                pausedByMix  = true;
+            }
+
+            if ((curState == STATE_PLAYING) && (pcmHandle.justLoadMetadata == false))
+            {
+                vTaskDelay(PROMPTS_AUDIO_CHUNK_MS);
+                continue;
+            }
+
+            if (ampEnabled == false)
+            {
+                /* Enable output of Audio amplifier */
+                GPIO_PinWrite(BOARD_MQS_OE_GPIO_PORT, BOARD_MQS_OE_GPIO_PIN, 1);
+                ampEnabled = true;
+            }
+
+            if (_MqsWriteChunk(&pcmHandle, NULL, PROMPTS_AUDIO_CHUNK_SAMPLES) == false)
+            {
+                break;
+            }
+        }
+
+        if (ampEnabled)
+        {
+            PipelineState curState = STATE_NULL;
+
+            /* Let the queued chunks play out */
+            vTaskDelay(PROMPTS_AUDIO_CHUNK_MS * MQS_AUDIO_CHUNK_CNT);
+
+            streamer_get_state(streamer, 0, &curState, false);
+            if (curState != STATE_PLAYING)
+            {
+                /* Disable output of Audio amplifier */
+                GPIO_PinWrite(BOARD_MQS_OE_GPIO_PORT, BOARD_MQS_OE_GPIO_PIN, 0);
+            }
+        }
+
+        if (pausedByMix)
+        {
+            g_MQSPlaying = false;
+        }
+    }
+}
+
+void HAL_OutputDev_MqsAudio_WarmupPrompts(void)
+{
+    if ((s_MqsPromptCache.budget == 0) || (s_MqsPromptTaskHandle == NULL) ||
+        (APP_OutputDev_MqsAudio_GetPromptCount() == 0))
     {
-        output_event.eventId   = kOutputEvent_SpeakerToAfeFeedback;
-        output_event.data      = &feedbackEvent;
-        output_event.copy      = 1;
-        output_event.size      = sizeof(feedbackEvent);
-        output_event.eventInfo = kEventInfo_Local;
+        return;
+    }
 
-        feedbackEvent.event_base.eventId         = SPEAKER_TO_AFE_FEEDBACK;
-        feedbackEvent.speaker_audio.start_time   = FWK_CurrentTimeUs();
-        feedbackEvent.speaker_audio.audio_stream = buffer;
-        feedbackEvent.speaker_audio.audio_length = length;
+    s_MqsWarmupPromptId = 0;
+    xTaskNotifyGive(s_MqsPromptTaskHandle);
+}
 
-        s_OutputDev_MqsAudio.cap.callback(s_OutputDev_MqsAudio.id, output_event, 0);
+void HAL_OutputDev_MqsAudio_GetPromptStats(audio_prompt_cache_stats_t *stats)
+{
+    HAL_AudioPromptCache_GetStats(&s_MqsPromptCache, stats);
+}
+
+/* Play a prompt, cached is the PCM taken from the prompt cache if any, released once the prompt ends */
+static hal_output_status_t _MqsPlayPrompt(int32_t promptId,
+                                          uint8_t asrEnabled,
+                                          const uint8_t *audio,
+                                          uint32_t len,
+                                          const uint8_t *cached,
+                                          bool hit,
+                                          uint32_t requestUs)
+{
+    hal_output_status_t error = kStatus_HAL_OutputSuccess;
+
+    if (_MqsMixerAddVoice(promptId, audio, len, asrEnabled, cached != NULL, hit, requestUs))
+    {
+        xTaskNotifyGive(s_MqsPromptTaskHandle);
+    }
+    else
+    {
+        HAL_AudioPromptCache_Release(&s_MqsPromptCache, cached);
+        LOGE("[MQS] No free voice to play prompt %d", promptId);
+        error = kStatus_HAL_OutputError;
     }
+
+    return error;
 }
-#endif /* !AMP_LOOPBACK_DISABLED */
 
 static hal_output_status_t HAL_OutputDev_MqsAudio_InferComplete(const output_dev_t *dev,
                                                                 output_algo_source_t source,
                                                                 void *inferResult)
 {
-    hal_output_status_t error = kStatus_HAL_OutputSuccess;
-    uint8_t *audioBuffer      = NULL;
-    uint32_t audioLen         = 0;
+    hal_output_status_t error  = kStatus_HAL_OutputSuccess;
+    const uint8_t *audioBuffer = NULL;
+    const uint8_t *cached      = NULL;
+    uint32_t audioLen          = 0;
+    uint32_t requestUs         = FWK_CurrentTimeUs();
+    int32_t promptId           = APP_OutputDev_MqsAudio_InferCompletePromptId(source, inferResult);
+    bool hit                   = false;
+
+    if (promptId >= 0)
+    {
+        cached = HAL_AudioPromptCache_Get(&s_MqsPromptCache, promptId, s_Language, &audioLen);
+        hit    = (cached != NULL);
+    }
+
+    if (!hit)
+    {
+        APP_OutputDev_MqsAudio_InferCompleteDecode(source, inferResult, (void *)&audioBuffer, &audioLen);
+        if ((promptId >= 0) && (audioBuffer != NULL) && (audioLen != 0))
+        {
+            /* played from the cached copy, the decoder may reuse its buffer for the next prompt */
+            cached = HAL_AudioPromptCache_Put(&s_MqsPromptCache, promptId, s_Language, audioBuffer, audioLen, true);
+        }
+    }
+
+    if (cached != NULL)
+    {
+        audioBuffer = cached;
+    }
 
-    APP_OutputDev_MqsAudio_InferCompleteDecode(source, inferResult, (void *)&audioBuffer, &audioLen);
     if (audioBuffer != NULL && audioLen != 0)
     {
-        int promptId       = (int)((event_common_t *)inferResult)->promptInfo.id;
         uint8_t asrEnabled = ((event_common_t *)inferResult)->promptInfo.asrEnabled;
-        // MQS_SOUND_PLAY_FUNC(promptId, audioBuffer, audioLen, asrEnabled);
+        if (promptId < 0)
+        {
+            /* prompts the application can not identify before decoding are not cached */
+            promptId = (int32_t)((event_common_t *)inferResult)->promptInfo.id;
+        }
+        error = _MqsPlayPrompt(promptId, asrEnabled, audioBuffer, audioLen, cached, hit, requestUs);
     }
 
     return error;
@@ -823,6 +1338,38 @@ static hal_output_status_t HAL_OutputDev_MqsAudio_InputNotify(const output_dev_t
             eventBase.respond(kEventID_SetSpeakerVolume, &event.speakerVolume, eventResponseStatus, true);
         }
     }
+    else if (eventBase.eventId == SET_MULTILINGUAL_CONFIG)
+    {
+        event_voice_t *pVoiceEvent = (event_voice_t *)data;
+        s_Language                 = pVoiceEvent->set_multilingual_config.languages;
+        LOGD("[MQS]: Set language %d", s_Language);
+
+        /* the prompts of the previous language are evicted as the new ones are played */
+        HAL_OutputDev_MqsAudio_WarmupPrompts();
+    }
+    else if (eventBase.eventId == kEventID_PlayPrompt)
+    {
+        const uint8_t *cached = NULL;
+        uint32_t requestUs    = FWK_CurrentTimeUs();
+        int32_t promptId      = (int32_t)((event_common_t *)data)->promptInfo.id;
+        uint8_t asrEnabled    = ((event_common_t *)data)->promptInfo.asrEnabled;
+
+        cached = HAL_AudioPromptCache_Get(&s_MqsPromptCache, promptId, s_Language, &audioLen);
+        if (cached != NULL)
+        {
+            error = _MqsPlayPrompt(promptId, asrEnabled, cached, audioLen, cached, true, requestUs);
+        }
+        else
+        {
+            APP_OutputDev_MqsAudio_InputNotifyDecode(dev, data, (void *)&audioBuffer, &audioLen, s_Language);
+            if (audioBuffer != NULL && audioLen != 0)
+            {
+                cached = HAL_AudioPromptCache_Put(&s_MqsPromptCache, promptId, s_Language, audioBuffer, audioLen, true);
+                error  = _MqsPlayPrompt(promptId, asrEnabled, (cached != NULL) ? cached : audioBuffer, audioLen, cached,
+                                        false, requestUs);
+            }
+        }
+    }
     else if (eventBase.eventId == kEventID_StreamerStop)
     {
         streamer_set_state(streamer, 0, STATE_NULL, true);
@@ -920,10 +1467,34 @@ static hal_output_status_t HAL_OutputDev_MqsAudio_Start(const output_dev_t *dev)
         }
     }
 
+    if (error == kStatus_HAL_OutputSuccess)
+    {
+        s_MqsWriteLock = xSemaphoreCreateMutex();
+        if (s_MqsWriteLock == NULL)
+        {
+            LOGE("HAL_OutputDev_MqsAudio_Start failed - xSemaphoreCreateMutex");
+            error = kStatus_HAL_OutputError;
+        }
+    }
+
     if (error == kStatus_HAL_OutputSuccess)
     {
         /* TODO: Update 'HAL_OutputDev_SmartLockConfig_Get...' function to be one getter/setter */
         s_OutputDev_MqsAudio.configs[kMQSConfigs_Volume].value = 10;
+
+        s_MqsGainVolume = s_OutputDev_MqsAudio.configs[kMQSConfigs_Volume].value;
+        HAL_AudioDsp_GainInit(&s_MqsGain, _VolumeToGain(s_MqsGainVolume),
+                              MQS_VOLUME_RAMP_MS * PROMPTS_AUDIO_CHUNK_SIZE_1MS / 2);
+        s_MqsDucked = false;
+        HAL_AudioDsp_GainInit(&s_MqsDuckGain, AUDIO_DSP_GAIN_UNITY,
+                              MQS_MIXER_DUCK_RAMP_MS * PROMPTS_AUDIO_CHUNK_SIZE_1MS / 2);
+
+        if (xTaskCreate(_MqsPromptTask, MQS_PROMPT_TASK_NAME, MQS_PROMPT_TASK_STACK_SIZE, NULL,
+                        uxTaskPriorityGet(NULL), &s_MqsPromptTaskHandle) != pdPASS)
+        {
+            LOGE("HAL_OutputDev_MqsAudio_Start failed - xTaskCreate");
+            error = kStatus_HAL_OutputError;
+        }
     }
     /* Create message process thread */
     thread_attr.tpriority = OSA_PRIORITY_HIGH + 1;
@@ -962,6 +1533,9 @@ static hal_output_status_t HAL_OutputDev_MqsAudio_Start(const output_dev_t *dev)
     prop.val  = s_OutputDev_MqsAudio.configs[kMQSConfigs_Volume].value;
     streamer_set_property(streamer, prop, true);
 
+    /* decode the prompts of the default language before they are first played */
+    HAL_OutputDev_MqsAudio_WarmupPrompts();
+
     return error;
 }
 
@@ -986,6 +1560,8 @@ static hal_output_status_t HAL_OutputDev_MqsAudio_Init(output_dev_t *dev, output
     hal_output_status_t error = kStatus_HAL_OutputSuccess;
 
     dev->cap.callback = callback;
+    HAL_AudioPromptCache_Init(&s_MqsPromptCache, MQS_PROMPT_CACHE_POOL, MQS_PROMPT_CACHE_SIZE);
+
     /* Initialize OSA*/
     OSA_Init();
 
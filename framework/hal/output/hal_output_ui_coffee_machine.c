@@ -171,8 +171,20 @@ typedef enum _wake_up_source
 static char *s_Icons[ICON_INVALID];
 static int s_GuiderColor[FACE_REC_INDICATOR_INVALID] = {RGB565_BLUE, RGB565_GREEN, RGB565_RED};
 
+/* what is drawn on an overlay surface, to skip the redraws that change no pixel */
+typedef struct _ui_overlay_state
+{
+    int guideColor;    /* -1 until drawn */
+    char *pFaceIcon;   /* NULL until drawn */
+    int progressWidth; /* width of the progress bar foreground, -1 until the bar is drawn */
+} ui_overlay_state_t;
+
 static gfx_surface_t s_UiSurface;
 static gfx_surface_t s_VirtualFaceSurface;
+/* bounds of the guide rect and progress bar, the camera preview is composed with this part of the overlay only */
+static gfx_rect_t s_UiContent;
+static ui_overlay_state_t s_UiState          = {-1, NULL, -1};
+static ui_overlay_state_t s_VirtualFaceState = {-1, NULL, -1};
 
 SDK_ALIGN(static char s_AsBuffer[UI_BUFFER_WIDTH * UI_BUFFER_HEIGHT * UI_BUFFER_BPP], 32);
 SDK_ALIGN(static char s_VirtualFaceBuffer[UI_BUFFER_WIDTH * UI_BUFFER_HEIGHT * UI_BUFFER_BPP], 32);
@@ -324,10 +336,11 @@ void LoadIcons(void *base)
 
 static void _DrawVirtualFaceIcon(gfx_surface_t *pSurface, char *pIcon)
 {
-    if (pIcon)
+    if (pIcon && (pIcon != s_VirtualFaceState.pFaceIcon))
     {
         int x = (UI_BUFFER_WIDTH - VIRTUAL_FACE_W) / 2;
         gfx_drawPicture(&s_VirtualFaceSurface, x, 0, VIRTUAL_FACE_W, VIRTUAL_FACE_H, 0xFFFF, pIcon);
+        s_VirtualFaceState.pFaceIcon = pIcon;
     }
 }
 
@@ -340,6 +353,12 @@ static void _DrawGuideRect(int color)
     int y = (UI_BUFFER_HEIGHT - h) / 2;
     int l = 100 / UI_SCALE_W;
     int d = 4 / UI_SCALE_W;
+
+    if (color == s_UiState.guideColor)
+    {
+        return;
+    }
+
     gfx_drawRect(&s_UiSurface, x, y, l, d, color);
     gfx_drawRect(&s_UiSurface, x, y, d, l, color);
     gfx_drawRect(&s_UiSurface, x + w - l, y, l, d, color);
@@ -348,6 +367,8 @@ static void _DrawGuideRect(int color)
     gfx_drawRect(&s_UiSurface, x, y + h - l, d, l, color);
     gfx_drawRect(&s_UiSurface, x + w - l, y + h, l, d, color);
     gfx_drawRect(&s_UiSurface, x + w, y + h - l, d, l, color);
+    gfx_rect_add(&s_UiContent, x, y, w + d, h + d);
+    s_UiState.guideColor = color;
 }
 
 static void _DrawProgressBar(preview_mode_t previewMode, float percent)
@@ -355,22 +376,48 @@ static void _DrawProgressBar(preview_mode_t previewMode, float percent)
     /* process bar background */
     int x = (UI_BUFFER_WIDTH - PROCESS_BAR_BG_W / UI_SCALE_W) / 2;
     int y;
+    int fgX;
+    int fgWidth = (int)(PROCESS_BAR_FG_W * percent);
     gfx_surface_t *pSurface;
+    ui_overlay_state_t *pState;
     if (previewMode == PREVIEW_MODE_CAMERA)
     {
         y        = (UI_BUFFER_HEIGHT + UI_GUIDE_RECT_H / UI_SCALE_H) / 2 + 36;
         pSurface = &s_UiSurface;
+        pState   = &s_UiState;
     }
     else
     {
         y        = (UI_BUFFER_HEIGHT + VIRTUAL_FACE_H) / 2;
         pSurface = &s_VirtualFaceSurface;
+        pState   = &s_VirtualFaceState;
+    }
+    fgX = x + UI_MAINWINDOW_PROCESS_FG_X_OFFSET;
+
+    if (fgWidth == pState->progressWidth)
+    {
+        return;
     }
-    gfx_drawPicture(pSurface, x, y, PROCESS_BAR_BG_W, PROCESS_BAR_BG_H, 0xFFFF, s_Icons[ICON_PROGRESS_BAR]);
 
-    /* process bar foreground */
-    gfx_drawRect(pSurface, x + UI_MAINWINDOW_PROCESS_FG_X_OFFSET, y + UI_MAINWINDOW_PROCESS_FG_Y_OFFSET,
-                 (int)(PROCESS_BAR_FG_W * percent), PROCESS_BAR_FG_H, RGB565_NXPBLUE);
+    if ((pState->progressWidth >= 0) && (fgWidth > pState->progressWidth))
+    {
+        /* the bar grew, only the new part of the foreground is drawn */
+        gfx_drawRect(pSurface, fgX + pState->progressWidth, y + UI_MAINWINDOW_PROCESS_FG_Y_OFFSET,
+                     fgWidth - pState->progressWidth, PROCESS_BAR_FG_H, RGB565_NXPBLUE);
+    }
+    else
+    {
+        gfx_drawPicture(pSurface, x, y, PROCESS_BAR_BG_W, PROCESS_BAR_BG_H, 0xFFFF, s_Icons[ICON_PROGRESS_BAR]);
+
+        /* process bar foreground */
+        gfx_drawRect(pSurface, fgX, y + UI_MAINWINDOW_PROCESS_FG_Y_OFFSET, fgWidth, PROCESS_BAR_FG_H, RGB565_NXPBLUE);
+    }
+
+    if (pSurface == &s_UiSurface)
+    {
+        gfx_rect_add(&s_UiContent, x, y, PROCESS_BAR_BG_W, PROCESS_BAR_BG_H);
+    }
+    pState->progressWidth = fgWidth;
 }
 
 static void _DrawPreviewUI(preview_mode_t previewMode,
@@ -973,6 +1020,8 @@ static hal_output_status_t HAL_OutputDev_UiCoffeeMachine_Init(output_dev_t *dev,
     s_UiSurface.format = kPixelFormat_RGB565;
     s_UiSurface.buf    = s_AsBuffer;
     s_UiSurface.lock   = xSemaphoreCreateMutex();
+    gfx_rect_clear(&s_UiContent);
+    s_UiSurface.pContent = &s_UiContent;
 
     s_FaceRecProgressTimer =
         xTimerCreate("FaceRecProgress", (TickType_t)pdMS_TO_TICKS(FACE_REC_UPDATE_INTERVAL), pdTRUE,
@@ -32,7 +32,11 @@
 #define BENCHMARK_IR_FRAME_WIDTH          480
 #define BENCHMARK_IR_FRAME_BYTE_PER_PIXEL 3
 
-#define BENCHMARK_FRAME_COUNT 2
+/* IR frame plus one RGB frame per vision algo frame slot */
+#define BENCHMARK_FRAME_COUNT (1 + VISION_ALGO_FRAME_DEPTH)
+
+/* Frames between two frame rate reports */
+#define BENCHMARK_REPORT_FRAMES 100
 
 AT_FB_SHMEM_SECTION_ALIGN(static uint8_t s_InputFrames[BENCHMARK_FRAME_COUNT][BENCHMARK_RGB_FRAME_HEIGHT]
                                                       [BENCHMARK_RGB_FRAME_WIDTH * BENCHMARK_RGB_FRAME_BYTE_PER_PIXEL],
@@ -62,6 +66,12 @@ static hal_valgo_status_t HAL_VisionAlgoDev_Benchmark_Init(vision_algo_dev_t *de
     dev->data.frames[kVAlgoFrameID_RGB].format    = kPixelFormat_BGR;
     dev->data.frames[kVAlgoFrameID_RGB].srcFormat = kPixelFormat_UYVY1P422_RGB;
     dev->data.frames[kVAlgoFrameID_RGB].data      = s_InputFrames[0];
+#if VISION_ALGO_FRAME_DEPTH > 1
+    for (int i = 1; i < VISION_ALGO_FRAME_DEPTH; i++)
+    {
+        dev->data.frames[kVAlgoFrameID_RGB].ringData[i - 1] = s_InputFrames[1 + i];
+    }
+#endif /* VISION_ALGO_FRAME_DEPTH > 1 */
 
     dev->data.frames[kVAlgoFrameID_IR].height       = BENCHMARK_IR_FRAME_HEIGHT;
     dev->data.frames[kVAlgoFrameID_IR].width        = BENCHMARK_IR_FRAME_WIDTH;
@@ -97,6 +107,19 @@ static hal_valgo_status_t HAL_VisionAlgoDev_Benchmark_Run(const vision_algo_dev_
     int frameSize = BENCHMARK_RGB_FRAME_HEIGHT * BENCHMARK_RGB_FRAME_WIDTH * BENCHMARK_RGB_FRAME_BYTE_PER_PIXEL;
     memset(dev->data.frames[kVAlgoFrameID_RGB].data, 0, frameSize);
 
+    vision_algo_frame_stats_t stats;
+    if ((FWK_VisionAlgoManager_GetFrameStats(dev->id, &stats) == 0) && (stats.runCount > 0) &&
+        ((stats.runCount % BENCHMARK_REPORT_FRAMES) == 0))
+    {
+        uint32_t elapsedMs = (FWK_CurrentTimeUs() - stats.startUs) / 1000;
+        if (elapsedMs > 0)
+        {
+            uint32_t fps100 = (uint32_t)((uint64_t)stats.runCount * 100000 / elapsedMs);
+            LOGI("[Benchmark] %d slots: %d.%02d fps, frame age %dus (max %dus), %d dropped", stats.depth, fps100 / 100,
+                 fps100 % 100, stats.lastAgeUs, stats.maxAgeUs, stats.dropCount);
+        }
+    }
+
     return ret;
 }
 
@@ -15,7 +15,9 @@
 
 #include "board_define.h"
 #ifdef ENABLE_VISIONALGO_DEV_H264Recording
+#include "fwk_flash.h"
 #include "fwk_log.h"
+#include "fwk_platform.h"
 #include "fwk_sln_platform.h"
 #include "fwk_vision_algo_manager.h"
 #include "fwk_perf.h"
@@ -30,8 +32,41 @@
 #define H264_RECORDING_MAX_FRAME_RATE 30
 #define H264_RECORDING_TARGET_BITRATE 500000
 
+/* Stream the recording to the file system instead of keeping it in the SDRAM clip region */
+#ifndef H264_RECORDING_TO_FLASH
+#define H264_RECORDING_TO_FLASH 0
+#endif /* H264_RECORDING_TO_FLASH */
+
 /* the maximum recording duration in ms*/
+#ifndef RECORDING_MAX_DURATION
+#if H264_RECORDING_TO_FLASH
+#define RECORDING_MAX_DURATION 600000
+#else
 #define RECORDING_MAX_DURATION 60000
+#endif /* H264_RECORDING_TO_FLASH */
+#endif /* RECORDING_MAX_DURATION */
+
+#if H264_RECORDING_TO_FLASH
+/*
+ * The encoded frames are gathered in one of two chunks while the writer task flushes the other one to the sink, so the
+ * encoder never waits for the flash. A frame which doesn't fit while both chunks are in use is dropped, and so are the
+ * frames up to the next keyframe as they can't be decoded without it.
+ * The recording is split in segments which start on a keyframe. The segments are reused in turn, so the recording
+ * keeps the last H264_RECORDING_SEGMENT_CNT segments. Each segment has an index of its keyframe offsets.
+ * The segments of the previous recording are removed when a recording starts, the sequence numbers restart from 0 and
+ * the leftover segments would otherwise be taken for the newest ones.
+ */
+#define H264_RECORDING_DIR                  "rec"
+#define H264_RECORDING_CHUNK_SIZE           (32 * 1024)
+#define H264_RECORDING_SEGMENT_MAX_SIZE     (1024 * 1024)
+#define H264_RECORDING_SEGMENT_MAX_DURATION 20000
+#define H264_RECORDING_SEGMENT_CNT          8
+#define H264_RECORDING_KEYFRAME_INDEX_CNT   64
+#define H264_RECORDING_PATH_LEN             24
+
+#define H264_RECORDING_WRITER_TASK_NAME       "RecWriter"
+#define H264_RECORDING_WRITER_TASK_STACK_SIZE 1024
+#endif /* H264_RECORDING_TO_FLASH */
 
 /* H264 CLIP REGION START ADDRESS, need to align with the definition in the MCUXpresso MCU Setting */
 extern void __base_BOARD_SDRAM_H264_CLIP(void);
@@ -53,6 +88,67 @@ typedef enum _h264_recording_state
     kH264RecordingState_Invalid
 } h264_recording_state_t;
 
+#if H264_RECORDING_TO_FLASH
+/* Destination of the recorded segments */
+typedef struct _h264_recording_sink
+{
+    /* append size bytes to a segment, the segment is truncated first when offset is 0 */
+    int (*write)(unsigned int segment, unsigned int offset, const void *buf, unsigned int size);
+    /* the segment is complete, keyframes holds the offset of each keyframe in it */
+    int (*close)(unsigned int segment, unsigned int sequence, const uint32_t *keyframes, unsigned int keyframeCnt);
+    /* remove a segment and its keyframe index, a segment which doesn't exist is not an error */
+    int (*remove)(unsigned int segment);
+} h264_recording_sink_t;
+
+typedef struct _h264_recording_chunk
+{
+    uint8_t *data;
+    unsigned int size;
+    unsigned int segment;
+    /* offset of the chunk in its segment */
+    unsigned int offset;
+    /* the chunk ends its segment, the keyframe index is written after it */
+    bool last;
+    unsigned int sequence;
+    unsigned int keyframeCnt;
+    uint32_t keyframes[H264_RECORDING_KEYFRAME_INDEX_CNT];
+    /* set while the writer task owns the chunk */
+    volatile bool busy;
+} h264_recording_chunk_t;
+
+typedef struct _h264_recording_stream
+{
+    h264_recording_chunk_t chunks[2];
+    h264_recording_chunk_t *active;
+    const h264_recording_sink_t *sink;
+    QueueHandle_t writerQueue;
+    SemaphoreHandle_t chunkFree;
+
+    /* segment being filled, its size including the active chunk and its keyframe index */
+    unsigned int segment;
+    unsigned int sequence;
+    unsigned int segmentSize;
+    unsigned int segmentStartUs;
+    unsigned int keyframeCnt;
+    uint32_t keyframes[H264_RECORDING_KEYFRAME_INDEX_CNT];
+
+    /* state of the frame being saved */
+    bool frameStarted;
+    bool frameDropped;
+    bool frameInActive;
+    unsigned int frameStartSize;
+    bool waitKeyframe;
+
+    volatile bool sinkError;
+
+    /* statistics of the recording */
+    unsigned int framesSaved;
+    unsigned int framesDropped;
+    volatile unsigned int bytesWritten;
+    volatile unsigned int writeTimeUs;
+} h264_recording_stream_t;
+#endif /* H264_RECORDING_TO_FLASH */
+
 typedef struct _h264_recording_param
 {
     h264_recording_state_t state;
@@ -71,10 +167,16 @@ typedef struct _h264_recording_param
     vision_algo_dev_t *dev;
 
     vision_algo_result_t result;
+
+#if H264_RECORDING_TO_FLASH
+    h264_recording_stream_t stream;
+#endif /* H264_RECORDING_TO_FLASH */
 } h264_recording_param_t;
 
 static h264_recording_param_t s_H264RecordingParam;
 
+static void _Recording_NotifyStop(void);
+
 static void _Recording_RequestFrame(const vision_algo_dev_t *dev)
 {
     /* Build Valgo event */
@@ -124,8 +226,371 @@ static void _Recording_NotifyStop(void)
     s_H264RecordingParam.dev->cap.callback(s_H264RecordingParam.dev->id, valgo_event, fromISR);
 }
 
+#if H264_RECORDING_TO_FLASH
+static void _Recording_SegmentPath(char *path, unsigned int segment, const char *ext)
+{
+    snprintf(path, H264_RECORDING_PATH_LEN, H264_RECORDING_DIR "/seg%u.%s", segment, ext);
+}
+
+static int _Recording_FlashWrite(unsigned int segment, unsigned int offset, const void *buf, unsigned int size)
+{
+    char path[H264_RECORDING_PATH_LEN];
+
+    _Recording_SegmentPath(path, segment, "h264");
+    return FWK_Flash_Append(path, (void *)buf, size, offset == 0);
+}
+
+static int _Recording_FlashClose(unsigned int segment,
+                                 unsigned int sequence,
+                                 const uint32_t *keyframes,
+                                 unsigned int keyframeCnt)
+{
+    char path[H264_RECORDING_PATH_LEN];
+    uint32_t index[2 + H264_RECORDING_KEYFRAME_INDEX_CNT];
+
+    /* the sequence number gives the order of the segments, the oldest one is overwritten first */
+    index[0] = sequence;
+    index[1] = keyframeCnt;
+    memcpy(&index[2], keyframes, keyframeCnt * sizeof(uint32_t));
+
+    _Recording_SegmentPath(path, segment, "idx");
+    return FWK_Flash_Save(path, index, (2 + keyframeCnt) * sizeof(uint32_t));
+}
+
+static int _Recording_FlashRemove(unsigned int segment)
+{
+    char path[H264_RECORDING_PATH_LEN];
+    sln_flash_status_t status;
+
+    _Recording_SegmentPath(path, segment, "h264");
+    status = FWK_Flash_Rm(path);
+    if ((status == kStatus_HAL_FlashSuccess) || (status == kStatus_HAL_FlashFileNotExist))
+    {
+        _Recording_SegmentPath(path, segment, "idx");
+        status = FWK_Flash_Rm(path);
+    }
+
+    return ((status == kStatus_HAL_FlashSuccess) || (status == kStatus_HAL_FlashFileNotExist)) ? 0 : status;
+}
+
+static const h264_recording_sink_t s_H264RecordingFlashSink = {
+    .write  = _Recording_FlashWrite,
+    .close  = _Recording_FlashClose,
+    .remove = _Recording_FlashRemove,
+};
+
+static void _Recording_WriterTask(void *param)
+{
+    h264_recording_stream_t *stream = (h264_recording_stream_t *)param;
+    h264_recording_chunk_t *chunk;
+
+    while (1)
+    {
+        if (xQueueReceive(stream->writerQueue, &chunk, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        if (!stream->sinkError)
+        {
+            uint32_t startUs = FWK_CurrentTimeUs();
+            int error        = 0;
+
+            if (chunk->size > 0)
+            {
+                error = stream->sink->write(chunk->segment, chunk->offset, chunk->data, chunk->size);
+            }
+
+            if ((error == 0) && chunk->last)
+            {
+                error = stream->sink->close(chunk->segment, chunk->sequence, chunk->keyframes, chunk->keyframeCnt);
+            }
+
+            stream->writeTimeUs += FWK_CurrentTimeUs() - startUs;
+            stream->bytesWritten += chunk->size;
+
+            if (error != 0)
+            {
+                LOGE("Recording:[ERROR]:failed to write segment %d [%d]", chunk->segment, error);
+                stream->sinkError = true;
+            }
+        }
+
+        chunk->size = 0;
+        chunk->last = false;
+        chunk->busy = false;
+        xSemaphoreGive(stream->chunkFree);
+    }
+}
+
+static hal_valgo_status_t _Recording_StreamInit(h264_recording_stream_t *stream)
+{
+    memset(stream, 0, sizeof(h264_recording_stream_t));
+    stream->sink = &s_H264RecordingFlashSink;
+
+    for (int i = 0; i < 2; i++)
+    {
+        stream->chunks[i].data = pvPortMalloc(H264_RECORDING_CHUNK_SIZE);
+        if (stream->chunks[i].data == NULL)
+        {
+            LOGE("Unable to allocate memory for the recording chunks.");
+            return kStatus_HAL_ValgoMallocError;
+        }
+    }
+
+    stream->writerQueue = xQueueCreate(2, sizeof(h264_recording_chunk_t *));
+    stream->chunkFree   = xSemaphoreCreateBinary();
+    if ((stream->writerQueue == NULL) || (stream->chunkFree == NULL))
+    {
+        LOGE("Unable to create the recording writer queue.");
+        return kStatus_HAL_ValgoMallocError;
+    }
+
+    if (xTaskCreate(_Recording_WriterTask, H264_RECORDING_WRITER_TASK_NAME, H264_RECORDING_WRITER_TASK_STACK_SIZE,
+                    stream, uxTaskPriorityGet(NULL), NULL) != pdPASS)
+    {
+        LOGE("Unable to create the recording writer task.");
+        return kStatus_HAL_ValgoMallocError;
+    }
+
+    return kStatus_HAL_ValgoSuccess;
+}
+
+static void _Recording_StreamStart(h264_recording_stream_t *stream)
+{
+    sln_flash_status_t status = FWK_Flash_Mkdir(H264_RECORDING_DIR);
+    if ((status != kStatus_HAL_FlashSuccess) && (status != kStatus_HAL_FlashDirExist))
+    {
+        LOGE("Recording:[ERROR]:failed to create \"%s\" [%d]", H264_RECORDING_DIR, status);
+    }
+
+    /* the writer task is idle between two recordings, the sink can be used from here */
+    for (unsigned int segment = 0; segment < H264_RECORDING_SEGMENT_CNT; segment++)
+    {
+        int error = stream->sink->remove(segment);
+        if (error != 0)
+        {
+            LOGE("Recording:[ERROR]:failed to remove segment %d [%d]", segment, error);
+        }
+    }
+
+    stream->active         = &stream->chunks[0];
+    stream->active->size   = 0;
+    stream->segment        = 0;
+    stream->sequence       = 0;
+    stream->segmentSize    = 0;
+    stream->segmentStartUs = FWK_CurrentTimeUs();
+    stream->keyframeCnt    = 0;
+    stream->frameStarted   = false;
+    stream->waitKeyframe   = true;
+    stream->sinkError      = false;
+    stream->framesSaved    = 0;
+    stream->framesDropped  = 0;
+    stream->bytesWritten   = 0;
+    stream->writeTimeUs    = 0;
+}
+
+/* Hand the active chunk to the writer task and continue in the other one. Without wait, fails if the writer task still
+ * holds the other chunk. */
+static bool _Recording_StreamFlush(h264_recording_stream_t *stream, bool last, bool wait)
+{
+    h264_recording_chunk_t *chunk = stream->active;
+    h264_recording_chunk_t *next  = (chunk == &stream->chunks[0]) ? &stream->chunks[1] : &stream->chunks[0];
+
+    while (next->busy)
+    {
+        if (!wait)
+        {
+            return false;
+        }
+        xSemaphoreTake(stream->chunkFree, portMAX_DELAY);
+    }
+
+    chunk->segment  = stream->segment;
+    chunk->offset   = stream->segmentSize - chunk->size;
+    chunk->last     = last;
+    chunk->sequence = stream->sequence;
+    if (last)
+    {
+        chunk->keyframeCnt = stream->keyframeCnt;
+        memcpy(chunk->keyframes, stream->keyframes, stream->keyframeCnt * sizeof(uint32_t));
+    }
+    chunk->busy = true;
+    xQueueSend(stream->writerQueue, &chunk, portMAX_DELAY);
+
+    next->size     = 0;
+    stream->active = next;
+    if (last)
+    {
+        stream->segment        = (stream->segment + 1) % H264_RECORDING_SEGMENT_CNT;
+        stream->sequence       = stream->sequence + 1;
+        stream->segmentSize    = 0;
+        stream->segmentStartUs = FWK_CurrentTimeUs();
+        stream->keyframeCnt    = 0;
+    }
+
+    return true;
+}
+
+/* True when the buffer holds an IDR slice or a sequence parameter set, the encoder emits both for a keyframe. */
+static bool _Recording_IsKeyframe(const uint8_t *pData, unsigned int size)
+{
+    for (unsigned int i = 0; i + 3 < size; i++)
+    {
+        if ((pData[i] == 0) && (pData[i + 1] == 0) && (pData[i + 2] == 1))
+        {
+            uint8_t nalType = pData[i + 3] & 0x1F;
+            if ((nalType == 5) || (nalType == 7))
+            {
+                return true;
+            }
+            i += 2;
+        }
+    }
+
+    return false;
+}
+
+static void _Recording_StreamDropFrame(h264_recording_stream_t *stream)
+{
+    if (!stream->frameDropped)
+    {
+        stream->frameDropped = true;
+        stream->framesDropped++;
+        /* the following frames reference this one */
+        stream->waitKeyframe = true;
+    }
+}
+
+static void _Recording_StreamSaveFrame(h264_recording_stream_t *stream, const void *pFrame, unsigned int size)
+{
+    const uint8_t *pData = (const uint8_t *)pFrame;
+
+    if (stream->frameDropped)
+    {
+        return;
+    }
+
+    if (!stream->frameStarted)
+    {
+        bool keyframe = _Recording_IsKeyframe(pData, size);
+        unsigned int elapsedMs;
+
+        stream->frameStarted = true;
+
+        if (stream->waitKeyframe && !keyframe)
+        {
+            _Recording_StreamDropFrame(stream);
+            return;
+        }
+
+        /* a new segment starts on a keyframe so it can be decoded on its own */
+        elapsedMs = (FWK_CurrentTimeUs() - stream->segmentStartUs) / 1000;
+        if (keyframe && (stream->segmentSize > 0) &&
+            ((stream->segmentSize >= H264_RECORDING_SEGMENT_MAX_SIZE) ||
+             (elapsedMs >= H264_RECORDING_SEGMENT_MAX_DURATION)))
+        {
+            if (!_Recording_StreamFlush(stream, true, false))
+            {
+                _Recording_StreamDropFrame(stream);
+                return;
+            }
+        }
+
+        if (keyframe)
+        {
+            if (stream->keyframeCnt < H264_RECORDING_KEYFRAME_INDEX_CNT)
+            {
+                stream->keyframes[stream->keyframeCnt++] = stream->segmentSize;
+            }
+            stream->waitKeyframe = false;
+        }
+
+        stream->frameInActive  = true;
+        stream->frameStartSize = stream->active->size;
+    }
+
+    while (size > 0)
+    {
+        unsigned int space = H264_RECORDING_CHUNK_SIZE - stream->active->size;
+        unsigned int len   = (size < space) ? size : space;
+
+        if (space == 0)
+        {
+            /* the start of the frame is already out when it spans chunks, the writer has to be waited for */
+            if (!_Recording_StreamFlush(stream, false, !stream->frameInActive))
+            {
+                /* remove the start of the frame and its keyframe entry */
+                unsigned int removed = stream->active->size - stream->frameStartSize;
+
+                stream->active->size = stream->frameStartSize;
+                stream->segmentSize -= removed;
+                if ((stream->keyframeCnt > 0) && (stream->keyframes[stream->keyframeCnt - 1] == stream->segmentSize))
+                {
+                    stream->keyframeCnt--;
+                }
+                _Recording_StreamDropFrame(stream);
+                return;
+            }
+            stream->frameInActive = false;
+            continue;
+        }
+
+        memcpy(&stream->active->data[stream->active->size], pData, len);
+        stream->active->size += len;
+        stream->segmentSize += len;
+        pData += len;
+        size -= len;
+    }
+}
+
+static void _Recording_StreamFrameEnd(h264_recording_stream_t *stream)
+{
+    if (stream->frameStarted && !stream->frameDropped)
+    {
+        stream->framesSaved++;
+    }
+
+    stream->frameStarted = false;
+    stream->frameDropped = false;
+
+    if (stream->sinkError)
+    {
+        LOGD("Recording:[STOP]:write error");
+        stream->sinkError = false;
+        _Recording_NotifyStop();
+    }
+}
+
+static void _Recording_StreamStop(h264_recording_stream_t *stream)
+{
+    unsigned int throughput = 0;
+
+    /* close the last segment unless it is empty, and wait for the writer task to be done with both chunks */
+    if (stream->segmentSize > 0)
+    {
+        _Recording_StreamFlush(stream, true, true);
+    }
+    while (stream->chunks[0].busy || stream->chunks[1].busy)
+    {
+        xSemaphoreTake(stream->chunkFree, portMAX_DELAY);
+    }
+
+    if (stream->writeTimeUs > 0)
+    {
+        throughput = (unsigned int)(((uint64_t)stream->bytesWritten * 1000) / stream->writeTimeUs);
+    }
+
+    LOGD("Recording:[STOP]:%d segments, %d bytes, %d frames, %d dropped, %d KB/s", stream->sequence,
+         stream->bytesWritten, stream->framesSaved, stream->framesDropped, throughput);
+}
+#endif /* H264_RECORDING_TO_FLASH */
+
 static void _Recording_SaveFrame(const void *pFrame, unsigned int size)
 {
+#if H264_RECORDING_TO_FLASH
+    _Recording_StreamSaveFrame(&s_H264RecordingParam.stream, pFrame, size);
+#else
     if (s_H264RecordingParam.info.size + size < H264_CLIP_REGION_TOTAL_SIZE)
     {
         unsigned char *pStart = (unsigned char *)s_H264RecordingParam.info.start + s_H264RecordingParam.info.size;
@@ -138,6 +603,7 @@ static void _Recording_SaveFrame(const void *pFrame, unsigned int size)
         LOGD("Recording:[STOP]:out of space");
         _Recording_NotifyStop();
     }
+#endif /* H264_RECORDING_TO_FLASH */
 }
 
 static void _Recording_TimerCallback(void *arg)
@@ -167,6 +633,9 @@ static hal_valgo_status_t _Recording_Record(const vision_algo_dev_t *dev)
             LOGE("ERROR:OpenH264_EncodeSave [%d]", encError);
             ret = kStatus_HAL_ValgoInitError;
         }
+#if H264_RECORDING_TO_FLASH
+        _Recording_StreamFrameEnd(&s_H264RecordingParam.stream);
+#endif /* H264_RECORDING_TO_FLASH */
     }
 
     fwk_fps(kFWKFPSType_VAlgo, dev->id);
@@ -199,6 +668,9 @@ static hal_valgo_status_t _Recording_Start(const vision_algo_dev_t *dev)
     s_H264RecordingParam.encoderState = kH264RecordingState_Start;
     s_H264RecordingParam.state        = kH264RecordingState_Recording;
     s_H264RecordingParam.info.size    = 0;
+#if H264_RECORDING_TO_FLASH
+    _Recording_StreamStart(&s_H264RecordingParam.stream);
+#endif /* H264_RECORDING_TO_FLASH */
 
     /* Notify the recording result */
     s_H264RecordingParam.result.h264Recording.state = kRecordingState_Start;
@@ -225,9 +697,17 @@ static hal_valgo_status_t _Recording_Stop(const vision_algo_dev_t *dev)
         }
         s_H264RecordingParam.encoderState = kH264RecordingState_Stop;
 
-        /* Notify the recording result */
-        result->h264Recording.recordedDataSize    = s_H264RecordingParam.info.size;
+#if H264_RECORDING_TO_FLASH
+        /* the recording is in the segment files, there is no clip in memory */
+        _Recording_StreamStop(&s_H264RecordingParam.stream);
+        s_H264RecordingParam.info.size            = s_H264RecordingParam.stream.bytesWritten;
+        result->h264Recording.recordedDataAddress = NULL;
+#else
         result->h264Recording.recordedDataAddress = (uint8_t *)s_H264RecordingParam.info.start;
+#endif /* H264_RECORDING_TO_FLASH */
+
+        /* Notify the recording result */
+        result->h264Recording.recordedDataSize = s_H264RecordingParam.info.size;
         result->h264Recording.state               = kRecordingState_Stop;
 
         _Recording_NotifyResult(dev, &(s_H264RecordingParam.result));
@@ -277,6 +757,14 @@ static hal_valgo_status_t HAL_VisionAlgoDev_H264Recording_Init(vision_algo_dev_t
         ret = kStatus_HAL_ValgoMallocError;
     }
 
+#if H264_RECORDING_TO_FLASH
+    if (ret == kStatus_HAL_ValgoSuccess)
+    {
+        s_H264RecordingParam.info.start = 0;
+        ret                             = _Recording_StreamInit(&s_H264RecordingParam.stream);
+    }
+#endif /* H264_RECORDING_TO_FLASH */
+
     return ret;
 }
 
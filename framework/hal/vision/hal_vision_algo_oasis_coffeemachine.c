@@ -25,6 +25,7 @@
 #include "fwk_profiler.h"
 #include "fwk_lpm_manager.h"
 #include "fwk_timer.h"
+#include "hal_vision_motion_gate.h"
 
 #include "hal_lpm_dev.h"
 #include "hal_vision_algo.h"
@@ -48,6 +49,43 @@
 #define OASIS_COFFEEMACHINE_DEBUG_OPTION false
 #endif
 
+/* skip the face detection while the scene is static and empty */
+#ifndef OASIS_COFFEEMACHINE_MOTION_GATE
+#define OASIS_COFFEEMACHINE_MOTION_GATE 0
+#endif
+
+/* RGB frame buffers in fb_sh_mem, 2 lets the camera fill the next frame while OASIS runs but needs another
+ * OASIS_RGB_FRAME_SIZE of fb_sh_mem */
+#ifndef OASIS_RGB_FRAME_DEPTH
+#define OASIS_RGB_FRAME_DEPTH 1
+#endif
+
+#if OASIS_RGB_FRAME_DEPTH > VISION_ALGO_FRAME_DEPTH
+#error "OASIS_RGB_FRAME_DEPTH exceeds VISION_ALGO_FRAME_DEPTH"
+#endif
+
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+#ifndef OASIS_MOTION_GATE_STEP
+#define OASIS_MOTION_GATE_STEP 8
+#endif
+
+#ifndef OASIS_MOTION_GATE_PIXEL_THRESHOLD
+#define OASIS_MOTION_GATE_PIXEL_THRESHOLD 16
+#endif
+
+#ifndef OASIS_MOTION_GATE_MOTION_PERMILLE
+#define OASIS_MOTION_GATE_MOTION_PERMILLE 10
+#endif
+
+#ifndef OASIS_MOTION_GATE_STATIC_FRAMES
+#define OASIS_MOTION_GATE_STATIC_FRAMES 30
+#endif
+
+#ifndef OASIS_MOTION_GATE_THROTTLE
+#define OASIS_MOTION_GATE_THROTTLE 10
+#endif
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
+
 /*******************************************************************************
  * Defines
  ******************************************************************************/
@@ -64,6 +102,15 @@
 #define OASIS_LOGV(...)
 #endif
 
+#define OASIS_RGB_FRAME_SIZE (OASIS_RGB_FRAME_HEIGHT * OASIS_RGB_FRAME_WIDTH * OASIS_RGB_FRAME_BYTE_PER_PIXEL)
+
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+#define OASIS_MOTION_GATE_SAMPLES \
+    VISION_MOTION_GATE_SAMPLES(OASIS_RGB_FRAME_WIDTH, OASIS_RGB_FRAME_HEIGHT, OASIS_MOTION_GATE_STEP)
+/* frames between two motion gate reports in debug mode */
+#define OASIS_MOTION_GATE_REPORT_FRAMES 300
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
+
 typedef struct _oasis_param
 {
     OASISLTInitPara_t config;
@@ -87,12 +134,17 @@ static uint16_t s_faceId                    = -1;
 static uint16_t s_blockingList              = 0;
 static unsigned int s_debugOption           = OASIS_COFFEEMACHINE_DEBUG_OPTION;
 
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+static vision_motion_gate_t s_OasisMotionGate;
+static uint16_t s_OasisMotionGateBackground[OASIS_MOTION_GATE_SAMPLES];
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
+
 #if OASIS_STATIC_MEM_BUFFER
 __attribute__((section(".bss.$SRAM_OCRAM_CACHED"), aligned(64))) uint8_t g_OasisMemPool[OASIS_STATIC_MEM_POOL];
 #endif
 
-AT_FB_SHMEM_SECTION_ALIGN(
-    uint8_t s_OasisRgbFrameBuffer[OASIS_RGB_FRAME_HEIGHT * OASIS_RGB_FRAME_WIDTH * OASIS_RGB_FRAME_BYTE_PER_PIXEL], 64);
+/* One buffer per vision algo frame slot */
+AT_FB_SHMEM_SECTION_ALIGN(uint8_t s_OasisRgbFrameBuffer[OASIS_RGB_FRAME_DEPTH][OASIS_RGB_FRAME_SIZE], 64);
 
 /*******************************************************************************
  * Prototypes
@@ -665,6 +717,10 @@ static oasis_status_t _oasis_start(const vision_algo_dev_t *receiver)
         s_OasisCoffeeMachine.currRunFlag = s_OasisCoffeeMachine.prevRunFlag;
         s_OasisCoffeeMachine.prevRunFlag = OASIS_RUN_FLAG_STOP;
         _oasis_start_registration(&s_OasisCoffeeMachine);
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+        /* the first frames after a start always run the detection */
+        HAL_VisionMotionGate_Reset(&s_OasisMotionGate);
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
 
         return kOasis_Success;
     }
@@ -807,7 +863,13 @@ static hal_valgo_status_t HAL_VisionAlgoDev_OasisCoffeeMachine_Init(vision_algo_
     dev->data.frames[kVAlgoFrameID_RGB].flip         = kFlipMode_None;
     dev->data.frames[kVAlgoFrameID_RGB].format       = kPixelFormat_BGR;
     dev->data.frames[kVAlgoFrameID_RGB].srcFormat    = OASIS_RGB_FRAME_SRC_FORMAT;
-    dev->data.frames[kVAlgoFrameID_RGB].data         = s_OasisRgbFrameBuffer;
+    dev->data.frames[kVAlgoFrameID_RGB].data         = s_OasisRgbFrameBuffer[0];
+#if OASIS_RGB_FRAME_DEPTH > 1
+    for (int i = 1; i < OASIS_RGB_FRAME_DEPTH; i++)
+    {
+        dev->data.frames[kVAlgoFrameID_RGB].ringData[i - 1] = s_OasisRgbFrameBuffer[i];
+    }
+#endif /* OASIS_RGB_FRAME_DEPTH > 1 */
 
     // init the RGB frame
     s_OasisCoffeeMachine.frames[OASISLT_INT_FRAME_IDX_RGB].height = OASIS_RGB_FRAME_HEIGHT;
@@ -948,6 +1010,18 @@ static hal_valgo_status_t HAL_VisionAlgoDev_OasisCoffeeMachine_Init(vision_algo_
     _oasis_start_registration(&s_OasisCoffeeMachine);
 
     OASIS_LOGD("[OASIS]:Init ok");
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+    vision_motion_gate_config_t gateConfig = {
+        .step            = OASIS_MOTION_GATE_STEP,
+        .pixelThreshold  = OASIS_MOTION_GATE_PIXEL_THRESHOLD,
+        .motionPermille  = OASIS_MOTION_GATE_MOTION_PERMILLE,
+        .backgroundShift = 3,
+        .staticFrames    = OASIS_MOTION_GATE_STATIC_FRAMES,
+        .throttle        = OASIS_MOTION_GATE_THROTTLE,
+    };
+    HAL_VisionMotionGate_Init(&s_OasisMotionGate, &gateConfig, s_OasisMotionGateBackground, OASIS_MOTION_GATE_SAMPLES);
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
+
     OASIS_LOGI("--HAL_VisionAlgoDev_OasisCoffeeMachine_Init");
     return ret;
 }
@@ -975,16 +1049,47 @@ static hal_valgo_status_t HAL_VisionAlgoDev_OasisCoffeeMachine_Run(const vision_
         memset(&s_OasisCoffeeMachine.result, 0, sizeof(s_OasisCoffeeMachine.result));
         s_OasisCoffeeMachine.result.id = kVisionAlgoID_OasisLite;
 
-        FWK_Profiler_ClearEvents();
-
-        int oasis_ret = OASISLT_run_extend(s_OasisCoffeeMachine.pframes, s_OasisCoffeeMachine.currRunFlag,
-                                           s_OasisCoffeeMachine.config.minFace, &s_OasisCoffeeMachine);
-        if (oasis_ret)
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+        if (!HAL_VisionMotionGate_Check(&s_OasisMotionGate, &dev->data.frames[kVAlgoFrameID_RGB]))
         {
-            OASIS_LOGE("OASISLT_run_extend failed with error: %d", oasis_ret);
+            /* Static and empty scene, report the same "no face" result the detection would give */
+            s_OasisCoffeeMachine.result.oasisLite.face_id           = -1;
+            s_OasisCoffeeMachine.result.oasisLite.debug_info.faceID = INVALID_FACE_ID;
+        }
+        else
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
+        {
+            FWK_Profiler_ClearEvents();
+
+            /* The manager hands over a different frame slot on each run */
+            s_OasisCoffeeMachine.frames[OASISLT_INT_FRAME_IDX_RGB].data = dev->data.frames[kVAlgoFrameID_RGB].data;
+
+            int oasis_ret = OASISLT_run_extend(s_OasisCoffeeMachine.pframes, s_OasisCoffeeMachine.currRunFlag,
+                                               s_OasisCoffeeMachine.config.minFace, &s_OasisCoffeeMachine);
+            if (oasis_ret)
+            {
+                OASIS_LOGE("OASISLT_run_extend failed with error: %d", oasis_ret);
+            }
+
+            FWK_Profiler_Log();
+
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+            HAL_VisionMotionGate_SetPresence(&s_OasisMotionGate, s_OasisCoffeeMachine.result.oasisLite.face_count > 0);
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
         }
 
-        FWK_Profiler_Log();
+#if OASIS_COFFEEMACHINE_MOTION_GATE
+        if (s_debugOption)
+        {
+            vision_motion_gate_stats_t gateStats;
+            HAL_VisionMotionGate_GetStats(&s_OasisMotionGate, &gateStats);
+            if ((gateStats.frameCount % OASIS_MOTION_GATE_REPORT_FRAMES) == 0)
+            {
+                OASIS_LOGD("[OASIS] Motion gate: skipped %d/%d frames, max skip run %d, check %dus",
+                           gateStats.skipCount, gateStats.frameCount, gateStats.maxSkipRun, gateStats.lastCheckUs);
+            }
+        }
+#endif /* OASIS_COFFEEMACHINE_MOTION_GATE */
 
         /* Take decision regarding the inference results */
         _process_inference_result(&s_OasisCoffeeMachine);
@@ -602,11 +602,13 @@ static void _oasis_adjustBrightness(uint8_t frameIdx, uint8_t direction, void *u
 {
     OASIS_LOGV("++_oasis_adjustBrightness");
 
+#if !FWK_SUPPORT_CAMERA_AE
     event_common_t eventCamExposure;
     eventCamExposure.brightnessControl.enable    = true;
     eventCamExposure.brightnessControl.direction = direction;
     eventCamExposure.eventBase.eventId           = kEventID_ControlRGBCamExposure;
     _oasis_dev_camera_exposure_control(s_OasisHomePanel.dev, &eventCamExposure);
+#endif /* !FWK_SUPPORT_CAMERA_AE */
 
     OASIS_LOGV("--_oasis_adjustBrightness");
 }
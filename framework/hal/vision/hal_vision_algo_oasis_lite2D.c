@@ -510,11 +510,13 @@ static int _oasis_lite_UpdateFace(
  * exposure level. frame_idx: which frame needs to be adjusted on, OASISLT_INT_FRAME_IDX_RGB or OASISLT_INT_FRAME_IDX_IR
  * ? direction: 1: up, need to increase brightness;  0: down, need to reduce brightness. For GC0308, we can combine
  * camera exposure and led pwm to adjust rgb face brightness. For MT9M114, only use pwm to adjust rgb face brightness.
+ * With FWK_SUPPORT_CAMERA_AE the camera manager owns the exposure and the LEDs, the requests of the library are ignored.
  */
 static void _oasis_lite_AdjustBrightness(uint8_t frameIdx, uint8_t direction, void *userData)
 {
     OASIS_LOGD("++_oasis_lite_AdjustBrightness");
 
+#if !FWK_SUPPORT_CAMERA_AE
     if (frameIdx == OASISLT_INT_FRAME_IDX_IR)
     {
         event_common_t eventIRLed;
@@ -539,6 +541,7 @@ static void _oasis_lite_AdjustBrightness(uint8_t frameIdx, uint8_t direction, vo
         _oasis_lite_dev_camera_exposure_control(s_OasisLite.dev, &eventRGBCam);
 #endif
     }
+#endif /* !FWK_SUPPORT_CAMERA_AE */
 
     OASIS_LOGD("--_oasis_lite_AdjustBrightness");
 }
@@ -880,6 +883,7 @@ static void _oasis_lite_check_timeout(oasis_lite_result_t *result, uint8_t *time
 
 static void _oasis_lite_reset_brightness(void)
 {
+#if !FWK_SUPPORT_CAMERA_AE
     event_common_t eventIRLed;
     eventIRLed.brightnessControl.enable = false;
     eventIRLed.eventBase.eventId        = kEventID_ControlIRLedBrightness;
@@ -896,6 +900,7 @@ static void _oasis_lite_reset_brightness(void)
     _oasis_lite_dev_camera_exposure_control(s_OasisLite.dev, &eventRGBCam);
 
     LOGD("Set to default pwm and/or exposure when processing is finished or timeout.");
+#endif /* !FWK_SUPPORT_CAMERA_AE */
 }
 
 static void _process_inference_result(oasis_lite_param_t *pParam)
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief vision motion gate implementation.
+ */
+
+#include <string.h>
+
+#include "fwk_platform.h"
+#include "hal_vision_motion_gate.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+typedef enum _motion_gate_luma
+{
+    kMotionGateLuma_None = 0,
+    kMotionGateLuma_RGB888, /* (c0 + 2 * c1 + c2) / 4, same result for RGB and BGR */
+    kMotionGateLuma_RGB565,
+    kMotionGateLuma_Y8,
+    kMotionGateLuma_UYVY, /* Y is the second byte of each pixel */
+} motion_gate_luma_t;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static motion_gate_luma_t _HAL_VisionMotionGate_LumaType(pixel_format_t format, int *bytesPerPixel)
+{
+    switch (format)
+    {
+        case kPixelFormat_RGB:
+        case kPixelFormat_BGR:
+        case kPixelFormat_Gray888:
+            *bytesPerPixel = 3;
+            return kMotionGateLuma_RGB888;
+        case kPixelFormat_Gray888X:
+            *bytesPerPixel = 4;
+            return kMotionGateLuma_RGB888;
+        case kPixelFormat_RGB565:
+            *bytesPerPixel = 2;
+            return kMotionGateLuma_RGB565;
+        case kPixelFormat_Gray:
+        case kPixelFormat_Depth8:
+            *bytesPerPixel = 1;
+            return kMotionGateLuma_Y8;
+        case kPixelFormat_UYVY1P422_RGB:
+        case kPixelFormat_UYVY1P422_Gray:
+        case kPixelFormat_VYUY1P422:
+            *bytesPerPixel = 2;
+            return kMotionGateLuma_UYVY;
+        default:
+            *bytesPerPixel = 0;
+            return kMotionGateLuma_None;
+    }
+}
+
+static inline uint8_t _HAL_VisionMotionGate_Luma(const uint8_t *pixel, motion_gate_luma_t type)
+{
+    switch (type)
+    {
+        case kMotionGateLuma_RGB888:
+            return (pixel[0] + 2 * pixel[1] + pixel[2]) >> 2;
+        case kMotionGateLuma_RGB565:
+        {
+            /* green carries most of the luma, 6 bits */
+            uint16_t rgb565 = pixel[0] | (pixel[1] << 8);
+            return (rgb565 >> 3) & 0xFC;
+        }
+        case kMotionGateLuma_UYVY:
+            return pixel[1];
+        default:
+            return pixel[0];
+    }
+}
+
+void HAL_VisionMotionGate_Init(vision_motion_gate_t *gate,
+                               const vision_motion_gate_config_t *config,
+                               uint16_t *background,
+                               uint32_t sampleCount)
+{
+    if ((gate == NULL) || (config == NULL))
+    {
+        return;
+    }
+
+    memset(gate, 0, sizeof(vision_motion_gate_t));
+    gate->config      = *config;
+    gate->background  = background;
+    gate->sampleCount = sampleCount;
+
+    if (gate->config.step == 0)
+    {
+        gate->config.step = 1;
+    }
+}
+
+void HAL_VisionMotionGate_Reset(vision_motion_gate_t *gate)
+{
+    if (gate == NULL)
+    {
+        return;
+    }
+
+    gate->hasBackground = false;
+    gate->staticCount   = 0;
+    gate->skipRun       = 0;
+}
+
+bool HAL_VisionMotionGate_Check(vision_motion_gate_t *gate, const vision_frame_t *frame)
+{
+    motion_gate_luma_t lumaType;
+    int bytesPerPixel;
+    uint32_t startUs;
+    uint32_t cols;
+    uint32_t rows;
+    uint32_t changed = 0;
+    uint16_t *pBackground;
+    bool motion;
+    bool run;
+
+    if ((gate == NULL) || (gate->background == NULL) || (frame == NULL) || (frame->data == NULL))
+    {
+        return true;
+    }
+
+    lumaType = _HAL_VisionMotionGate_LumaType(frame->format, &bytesPerPixel);
+    cols     = frame->width / gate->config.step;
+    rows     = frame->height / gate->config.step;
+    if ((lumaType == kMotionGateLuma_None) || (cols * rows == 0) || (cols * rows > gate->sampleCount))
+    {
+        return true;
+    }
+
+    startUs     = FWK_CurrentTimeUs();
+    pBackground = gate->background;
+
+    for (uint32_t y = 0; y < rows; y++)
+    {
+        const uint8_t *pRow = (const uint8_t *)frame->data + y * gate->config.step * frame->pitch;
+
+        for (uint32_t x = 0; x < cols; x++, pBackground++)
+        {
+            int32_t luma = _HAL_VisionMotionGate_Luma(pRow + x * gate->config.step * bytesPerPixel, lumaType) << 8;
+
+            if (gate->hasBackground)
+            {
+                int32_t diff = luma - *pBackground;
+                if ((diff > (gate->config.pixelThreshold << 8)) || (-diff > (gate->config.pixelThreshold << 8)))
+                {
+                    changed++;
+                }
+                *pBackground = *pBackground + (diff / (1 << gate->config.backgroundShift));
+            }
+            else
+            {
+                *pBackground = luma;
+            }
+        }
+    }
+
+    if (gate->hasBackground)
+    {
+        motion = (changed * 1000 > (uint32_t)gate->config.motionPermille * cols * rows);
+    }
+    else
+    {
+        /* nothing to compare the first frame with */
+        gate->hasBackground = true;
+        motion              = true;
+    }
+
+    gate->stats.frameCount++;
+    if (motion)
+    {
+        gate->stats.motionCount++;
+    }
+
+    if (motion || gate->presence)
+    {
+        gate->staticCount = 0;
+        run               = true;
+    }
+    else if (++gate->staticCount <= gate->config.staticFrames)
+    {
+        run = true;
+    }
+    else
+    {
+        run = (gate->config.throttle != 0) &&
+              (((gate->staticCount - gate->config.staticFrames) % gate->config.throttle) == 0);
+    }
+
+    if (run)
+    {
+        gate->skipRun = 0;
+    }
+    else
+    {
+        gate->stats.skipCount++;
+        if (++gate->skipRun > gate->stats.maxSkipRun)
+        {
+            gate->stats.maxSkipRun = gate->skipRun;
+        }
+    }
+
+    gate->stats.lastCheckUs = FWK_CurrentTimeUs() - startUs;
+
+    return run;
+}
+
+void HAL_VisionMotionGate_SetPresence(vision_motion_gate_t *gate, bool presence)
+{
+    if (gate == NULL)
+    {
+        return;
+    }
+
+    gate->presence = presence;
+}
+
+void HAL_VisionMotionGate_GetStats(const vision_motion_gate_t *gate, vision_motion_gate_stats_t *stats)
+{
+    if ((gate == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    *stats = gate->stats;
+}
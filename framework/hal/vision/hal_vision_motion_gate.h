@@ -0,0 +1,121 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief vision motion gate declaration.
+ * Cheap pre-filter run ahead of a vision algorithm. It compares a downsampled luma image of the frame with a running
+ * background model and tells the algorithm when the scene has been static and empty long enough to skip frames.
+ */
+
+#ifndef _HAL_VISION_MOTION_GATE_H_
+#define _HAL_VISION_MOTION_GATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_valgo_dev.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+/* Number of background samples needed for a frame size and a sampling step */
+#define VISION_MOTION_GATE_SAMPLES(width, height, step) (((width) / (step)) * ((height) / (step)))
+
+typedef struct _vision_motion_gate_config
+{
+    /* one luma sample is taken every step pixels, in both directions */
+    uint8_t step;
+    /* absolute luma difference above which a sample is counted as changed */
+    uint8_t pixelThreshold;
+    /* changed samples, in per mille of all the samples, above which the frame has motion */
+    uint16_t motionPermille;
+    /* background update rate, the model moves by 1/2^backgroundShift of the difference each frame */
+    uint8_t backgroundShift;
+    /* static frames without a face before the gate starts skipping */
+    uint16_t staticFrames;
+    /* once skipping, run one frame every throttle frames, 0 to skip all the static frames */
+    uint16_t throttle;
+} vision_motion_gate_config_t;
+
+typedef struct _vision_motion_gate_stats
+{
+    uint32_t frameCount;  /* frames checked by the gate */
+    uint32_t skipCount;   /* frames for which the algorithm was skipped */
+    uint32_t motionCount; /* frames with motion */
+    uint32_t maxSkipRun;  /* longest run of consecutive skipped frames, the worst added detection latency */
+    uint32_t lastCheckUs; /* time spent in the last check */
+} vision_motion_gate_stats_t;
+
+typedef struct _vision_motion_gate
+{
+    vision_motion_gate_config_t config;
+    /* background model, luma in 8.8 fixed point */
+    uint16_t *background;
+    uint32_t sampleCount;
+    bool hasBackground;
+    /* the last algorithm run found a face */
+    bool presence;
+    uint32_t staticCount;
+    uint32_t skipRun;
+    vision_motion_gate_stats_t stats;
+} vision_motion_gate_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init a motion gate
+ * @param gate gate to init
+ * @param config gate configuration
+ * @param background buffer for the background model
+ * @param sampleCount number of entries in background, see VISION_MOTION_GATE_SAMPLES
+ */
+void HAL_VisionMotionGate_Init(vision_motion_gate_t *gate,
+                               const vision_motion_gate_config_t *config,
+                               uint16_t *background,
+                               uint32_t sampleCount);
+
+/**
+ * @brief Forget the background model, the next frames are run until the scene is static again
+ * @param gate gate to reset
+ */
+void HAL_VisionMotionGate_Reset(vision_motion_gate_t *gate);
+
+/**
+ * @brief Check a frame and update the background model
+ * @param gate gate to use
+ * @param frame frame about to be given to the algorithm
+ * @return true if the algorithm has to run on this frame, false if it can be skipped
+ */
+bool HAL_VisionMotionGate_Check(vision_motion_gate_t *gate, const vision_frame_t *frame);
+
+/**
+ * @brief Tell the gate whether the last algorithm run found a face. Frames are never skipped while a face is present.
+ * @param gate gate to update
+ * @param presence true if a face was found
+ */
+void HAL_VisionMotionGate_SetPresence(vision_motion_gate_t *gate, bool presence);
+
+/**
+ * @brief Get the statistics of a gate
+ * @param gate gate to query
+ * @param stats pointer to the statistics to fill
+ */
+void HAL_VisionMotionGate_GetStats(const vision_motion_gate_t *gate, vision_motion_gate_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_VISION_MOTION_GATE_H_ */
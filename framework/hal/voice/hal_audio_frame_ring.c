@@ -0,0 +1,211 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief audio frame ring implementation.
+ * The producer only writes head and the reference count of a frame nobody holds, the consumer only writes tail and
+ * the reference counts of the frames it holds, so no lock is needed. The barriers order the frame data with the
+ * indexes.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "fsl_common.h"
+#include "hal_audio_frame_ring.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+audio_frame_ring_t g_AsrFrameRing;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static uint32_t _HAL_AudioFrameRing_Index(const audio_frame_ring_t *ring, const uint8_t *frame)
+{
+    if ((frame < ring->pool) || (frame >= ring->pool + ring->frameSize * ring->depth))
+    {
+        return ring->depth;
+    }
+
+    return (uint32_t)(frame - ring->pool) / ring->frameSize;
+}
+
+void HAL_AudioFrameRing_Init(audio_frame_ring_t *ring,
+                             uint8_t *pool,
+                             uint32_t frameSize,
+                             uint32_t depth,
+                             volatile uint8_t *refCount,
+                             uint32_t *dataSize)
+{
+    if ((ring == NULL) || (pool == NULL) || (refCount == NULL) || (dataSize == NULL))
+    {
+        return;
+    }
+
+    memset(ring, 0, sizeof(audio_frame_ring_t));
+    ring->pool      = pool;
+    ring->frameSize = frameSize;
+    ring->refCount  = refCount;
+    ring->dataSize  = dataSize;
+
+    for (uint32_t i = 0; i < depth; i++)
+    {
+        refCount[i] = 0;
+        dataSize[i] = 0;
+    }
+
+    /* a zero depth marks the ring as not initialized for the consumer */
+    __DMB();
+    ring->depth = depth;
+}
+
+uint8_t *HAL_AudioFrameRing_Acquire(audio_frame_ring_t *ring)
+{
+    uint32_t index;
+
+    if ((ring == NULL) || (ring->depth == 0))
+    {
+        return NULL;
+    }
+
+    index = ring->head % ring->depth;
+    if (!ring->acquired)
+    {
+        /* the consumer still holds the frame written depth frames ago */
+        if (ring->refCount[index] != 0)
+        {
+            ring->stats.overruns++;
+            return NULL;
+        }
+
+        /* read the data only after the consumer released it */
+        __DMB();
+        ring->refCount[index] = 1;
+        ring->acquired        = 1;
+    }
+
+    return &ring->pool[index * ring->frameSize];
+}
+
+void HAL_AudioFrameRing_Cancel(audio_frame_ring_t *ring)
+{
+    if ((ring == NULL) || (!ring->acquired))
+    {
+        return;
+    }
+
+    ring->refCount[ring->head % ring->depth] = 0;
+    ring->acquired                           = 0;
+}
+
+void HAL_AudioFrameRing_Publish(audio_frame_ring_t *ring, uint32_t size)
+{
+    uint32_t pending;
+
+    if ((ring == NULL) || (!ring->acquired))
+    {
+        return;
+    }
+
+    /* the reference taken in acquire is handed over to the consumer */
+    ring->dataSize[ring->head % ring->depth] = size;
+    ring->acquired                           = 0;
+    __DMB();
+    ring->head++;
+
+    ring->stats.published++;
+    pending = ring->head - ring->tail;
+    if (pending > ring->stats.maxPending)
+    {
+        ring->stats.maxPending = pending;
+    }
+}
+
+uint8_t *HAL_AudioFrameRing_Get(audio_frame_ring_t *ring, uint32_t *size)
+{
+    uint32_t index;
+
+    if ((ring == NULL) || (ring->depth == 0) || (ring->tail == ring->head))
+    {
+        return NULL;
+    }
+
+    /* read the data only after it was published */
+    __DMB();
+    index = ring->tail % ring->depth;
+    if (size != NULL)
+    {
+        *size = ring->dataSize[index];
+    }
+    ring->tail++;
+
+    return &ring->pool[index * ring->frameSize];
+}
+
+void HAL_AudioFrameRing_Retain(audio_frame_ring_t *ring, const uint8_t *frame)
+{
+    uint32_t index;
+
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    index = _HAL_AudioFrameRing_Index(ring, frame);
+    if ((index < ring->depth) && (ring->refCount[index] != 0))
+    {
+        ring->refCount[index]++;
+    }
+}
+
+void HAL_AudioFrameRing_Release(audio_frame_ring_t *ring, const uint8_t *frame)
+{
+    uint32_t index;
+
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    index = _HAL_AudioFrameRing_Index(ring, frame);
+    if ((index < ring->depth) && (ring->refCount[index] != 0))
+    {
+        /* the processing of the frame must be done before the producer can reuse it */
+        __DMB();
+        ring->refCount[index]--;
+        if (ring->refCount[index] == 0)
+        {
+            ring->stats.released++;
+        }
+    }
+}
+
+bool HAL_AudioFrameRing_Owns(const audio_frame_ring_t *ring, const void *frame)
+{
+    if ((ring == NULL) || (ring->depth == 0))
+    {
+        return false;
+    }
+
+    return _HAL_AudioFrameRing_Index(ring, (const uint8_t *)frame) < ring->depth;
+}
+
+void HAL_AudioFrameRing_GetStats(const audio_frame_ring_t *ring, audio_frame_ring_stats_t *stats)
+{
+    if ((ring == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    *stats = ring->stats;
+}
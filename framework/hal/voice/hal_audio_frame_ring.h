@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief audio frame ring declaration.
+ * Single producer/single consumer ring of fixed size audio frames. The producer fills a frame in place and publishes
+ * it, the consumer processes it in place and releases it. Each frame is reference counted so the consumer can keep a
+ * frame longer than its turn in the ring. When the consumer falls behind by more than the depth of the ring, the
+ * producer can't acquire a frame and the overrun is counted.
+ */
+
+#ifndef _HAL_AUDIO_FRAME_RING_H_
+#define _HAL_AUDIO_FRAME_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+typedef struct _audio_frame_ring_stats
+{
+    /* frames published by the producer */
+    uint32_t published;
+    /* frames released by the consumer */
+    uint32_t released;
+    /* frames the producer couldn't acquire because the consumer was too far behind */
+    uint32_t overruns;
+    /* highest number of frames waiting for the consumer */
+    uint32_t maxPending;
+} audio_frame_ring_stats_t;
+
+typedef struct _audio_frame_ring
+{
+    uint8_t *pool;
+    uint32_t frameSize;
+    uint32_t depth;
+    /* per frame reference count and size of the published data, depth entries each */
+    volatile uint8_t *refCount;
+    uint32_t *dataSize;
+    /* number of frames published and taken since init, the difference is the number of pending frames */
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    /* true while the producer holds the frame at head */
+    uint8_t acquired;
+    audio_frame_ring_stats_t stats;
+} audio_frame_ring_t;
+
+/* ASR input ring, filled by the audio processing device and drained by the ASR device */
+extern audio_frame_ring_t g_AsrFrameRing;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Init a ring
+ * @param ring ring to init
+ * @param pool depth * frameSize bytes of frames
+ * @param frameSize size of a frame in bytes
+ * @param depth number of frames
+ * @param refCount depth reference counts
+ * @param dataSize depth data sizes
+ */
+void HAL_AudioFrameRing_Init(audio_frame_ring_t *ring,
+                             uint8_t *pool,
+                             uint32_t frameSize,
+                             uint32_t depth,
+                             volatile uint8_t *refCount,
+                             uint32_t *dataSize);
+
+/**
+ * @brief Get the next frame to fill, producer side
+ * @param ring ring to use
+ * @return the frame, the same one until it is published or cancelled, NULL if it is still used by the consumer
+ */
+uint8_t *HAL_AudioFrameRing_Acquire(audio_frame_ring_t *ring);
+
+/**
+ * @brief Give up the acquired frame without publishing it, producer side
+ * @param ring ring to use
+ */
+void HAL_AudioFrameRing_Cancel(audio_frame_ring_t *ring);
+
+/**
+ * @brief Make the acquired frame available to the consumer, producer side
+ * @param ring ring to use
+ * @param size size of the data in the frame, passed to the consumer
+ */
+void HAL_AudioFrameRing_Publish(audio_frame_ring_t *ring, uint32_t size);
+
+/**
+ * @brief Take the oldest published frame, consumer side. The frame must be released once processed.
+ * @param ring ring to use
+ * @param size size of the data in the frame
+ * @return the frame, NULL if no frame is pending
+ */
+uint8_t *HAL_AudioFrameRing_Get(audio_frame_ring_t *ring, uint32_t *size);
+
+/**
+ * @brief Keep a taken frame after it is released once more, consumer side
+ * @param ring ring to use
+ * @param frame frame to keep
+ */
+void HAL_AudioFrameRing_Retain(audio_frame_ring_t *ring, const uint8_t *frame);
+
+/**
+ * @brief Drop a reference to a frame, consumer side. The frame is reused once it has no reference left.
+ * @param ring ring to use
+ * @param frame frame to release
+ */
+void HAL_AudioFrameRing_Release(audio_frame_ring_t *ring, const uint8_t *frame);
+
+/**
+ * @brief Check if a buffer is a frame of a ring
+ * @param ring ring to check
+ * @param frame buffer to check
+ * @return true if the buffer is one of the frames of the ring
+ */
+bool HAL_AudioFrameRing_Owns(const audio_frame_ring_t *ring, const void *frame);
+
+/**
+ * @brief Get the statistics of a ring
+ * @param ring ring to read
+ * @param stats statistics
+ */
+void HAL_AudioFrameRing_GetStats(const audio_frame_ring_t *ring, audio_frame_ring_stats_t *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _HAL_AUDIO_FRAME_RING_H_ */
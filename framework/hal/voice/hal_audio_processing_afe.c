@@ -16,6 +16,7 @@
 #include "hal_audio_processing_dev.h"
 #include "hal_audio_defs.h"
 #include "hal_event_descriptor_voice.h"
+#include "hal_audio_frame_ring.h"
 #include "sln_afe.h"
 
 /*******************************************************************************
@@ -26,7 +27,12 @@
 #define AFE_INPUT_AMP_SAMPLE_BYTES 2
 #define AFE_OUTPUT_SAMPLE_BYTES    2
 #define ASR_INPUT_SAMPLE_BYTES     2
-#define ASR_INPUT_CYCLE_SLOTS      4
+
+/* Number of ASR frames (ASR_INPUT_FRAMES AFE cycles each) ASR can fall behind before the audio is dropped.
+ * The frames live in DTC, the default keeps the footprint of the previous 4 slot buffer. */
+#ifndef ASR_FRAME_RING_DEPTH
+#define ASR_FRAME_RING_DEPTH 4
+#endif /* ASR_FRAME_RING_DEPTH */
 
 #if !AMP_LOOPBACK_DISABLED
 /* Defines used to sync microphones with speaker */
@@ -78,7 +84,14 @@ typedef struct _sln_speaker_feedback
 static AT_NONCACHEABLE_SECTION_ALIGN_DTC(uint8_t s_afeExternalMemory[AFE_MEM_SIZE_2MICS], 4);
 
 AT_NONCACHEABLE_SECTION_ALIGN_DTC(static uint8_t s_afeMicIn[AFE_INPUT_MIC_BUFFER_SIZE], 4);
-AT_NONCACHEABLE_SECTION_ALIGN_DTC(static uint8_t s_asrInput[ASR_INPUT_CYCLE_SLOTS][ASR_INPUT_BUFFER_SLOTS][ASR_INPUT_BUFFER_SIZE], 4);
+AT_NONCACHEABLE_SECTION_ALIGN_DTC(static uint8_t s_asrFramePool[ASR_FRAME_RING_DEPTH][ASR_INPUT_BUFFER_SLOTS][ASR_INPUT_BUFFER_SIZE], 4);
+static volatile uint8_t s_asrFrameRefCount[ASR_FRAME_RING_DEPTH];
+static uint32_t s_asrFrameDataSize[ASR_FRAME_RING_DEPTH];
+
+/* ASR frame being filled, its number of AFE cycles already stored and whether the ring was full for this frame */
+static uint8_t *s_asrFrame    = NULL;
+static uint8_t s_accSamples   = 0;
+static bool s_asrFrameDropped = false;
 
 static volatile uint32_t s_utteranceLength = 0;
 
@@ -109,12 +122,14 @@ volatile uint32_t s_afeDataProcessed = 0;
  ******************************************************************************/
 
 static void _convertMicDataForAfe(int32_t *src, void *dst);
+static uint8_t *_getAsrFrame(void);
 static uint8_t _forwardDataToAsr(const audio_processing_dev_t *dev, void *afeCleanOut, void *afeAmp);
 
 #if !AMP_LOOPBACK_DISABLED
 static void _addSpeakerFeedback(int16_t *buffer, uint32_t length, uint32_t timeUs);
 static uint32_t _consumeSpeakerFeedback(int16_t *dst, uint32_t length);
-static int16_t *_getSpeakerFeedback(void);
+static int16_t *_getSpeakerFeedbackBuffer(void);
+static int16_t *_getSpeakerFeedback(int16_t *afeAmpIn);
 #endif /* !AMP_LOOPBACK_DISABLED */
 
 #if ENABLE_OUTPUT_DEV_AudioDump == 1
@@ -163,7 +178,34 @@ static void _convertMicDataForAfe(int32_t *src, void *dst)
 }
 
 /**
- * @brief Store chunks of clean audio in a bigger buffer. Once accumulated enough chunks, send them to ASR.
+ * @brief Get the ASR frame collecting the current AFE cycles. The frame is acquired from the ASR ring on first use.
+ *
+ * @return Pointer to the frame, NULL while the speaker plays prompts or if ASR is too far behind.
+ */
+static uint8_t *_getAsrFrame(void)
+{
+    if ((s_asrFrame == NULL) && (s_asrFrameDropped == false) && (g_MQSPlaying == false))
+    {
+        s_asrFrame = HAL_AudioFrameRing_Acquire(&g_AsrFrameRing);
+        if (s_asrFrame == NULL)
+        {
+            LOGE("ASR failed to process AFE data in time! %d != %d, %d frames dropped", s_afeDataGenerated,
+                 s_afeDataProcessed, g_AsrFrameRing.stats.overruns);
+            s_asrFrameDropped = true;
+        }
+        else if (s_accSamples != 0)
+        {
+            /* Started in the middle of a frame, the previous cycles are silence */
+            memset(s_asrFrame, 0, s_accSamples * AFE_OUTPUT_BUFFER_SIZE);
+        }
+    }
+
+    return s_asrFrame;
+}
+
+/**
+ * @brief Store chunks of clean audio in an ASR frame of the ring. Once accumulated enough chunks, publish the frame to
+ * ASR.
  *
  * @param dev Pointer to the current device.
  * @param afeCleanOut Chunk to be stored.
@@ -173,42 +215,60 @@ static void _convertMicDataForAfe(int32_t *src, void *dst)
  */
 static uint8_t _forwardDataToAsr(const audio_processing_dev_t *dev, void *afeCleanOut, void *afeAmp)
 {
-    static uint8_t s_accSamples = 0;
-    static uint8_t s_slotIdx    = 0;
-    static bool s_dirtySamples  = false;
-
     uint32_t dataToSendSize = (ASR_INPUT_BUFFER_SIZE / ASR_INPUT_SAMPLE_BYTES);
+    uint8_t *asrFrame       = NULL;
 
     if (g_MQSPlaying == true)
     {
         dataToSendSize = 0;
+        if (s_asrFrame != NULL)
+        {
+            HAL_AudioFrameRing_Cancel(&g_AsrFrameRing);
+            s_asrFrame = NULL;
+        }
     }
-#if SELF_WAKE_UP_PROTECTION
     else
+    {
+        asrFrame = _getAsrFrame();
+    }
+
+#if SELF_WAKE_UP_PROTECTION
+    if (dataToSendSize != 0)
     {
         static uint32_t s_afeAmpClear = 0;
 
+        uint8_t *asrSpeaker = NULL;
+        if (asrFrame != NULL)
+        {
+            asrSpeaker = &asrFrame[ASR_INPUT_BUFFER_SIZE + s_accSamples * AFE_OUTPUT_BUFFER_SIZE];
+        }
+
         if (afeAmp != NULL)
         {
-            memcpy(&s_asrInput[s_slotIdx][1][s_accSamples * AFE_OUTPUT_BUFFER_SIZE], afeAmp, AFE_OUTPUT_BUFFER_SIZE);
+            /* The speaker feedback is normally already read in the frame */
+            if ((asrSpeaker != NULL) && (afeAmp != asrSpeaker))
+            {
+                memcpy(asrSpeaker, afeAmp, AFE_OUTPUT_BUFFER_SIZE);
+            }
             dataToSendSize *= 2;
-            s_afeAmpClear   = ASR_SPEAKER_PADDING_SILENCE_1S;
+            s_afeAmpClear = ASR_SPEAKER_PADDING_SILENCE_1S;
         }
         else if (s_afeAmpClear > 0)
         {
-            memset(&s_asrInput[s_slotIdx][1][s_accSamples * AFE_OUTPUT_BUFFER_SIZE], 0, AFE_OUTPUT_BUFFER_SIZE);
+            if (asrSpeaker != NULL)
+            {
+                memset(asrSpeaker, 0, AFE_OUTPUT_BUFFER_SIZE);
+            }
             dataToSendSize *= 2;
             s_afeAmpClear--;
         }
     }
 #endif /* SELF_WAKE_UP_PROTECTION */
 
-    if (dataToSendSize != 0)
+    if (asrFrame != NULL)
     {
-        s_dirtySamples = true;
-
         /* Pass output of AFE to wake word */
-        memcpy(&s_asrInput[s_slotIdx][0][s_accSamples * AFE_OUTPUT_BUFFER_SIZE], afeCleanOut, AFE_OUTPUT_BUFFER_SIZE);
+        memcpy(&asrFrame[s_accSamples * AFE_OUTPUT_BUFFER_SIZE], afeCleanOut, AFE_OUTPUT_BUFFER_SIZE);
 
         /* If we've accumulated enough audio, send it to ASR */
         if (s_accSamples == (ASR_INPUT_FRAMES - 1))
@@ -216,33 +276,32 @@ static uint8_t _forwardDataToAsr(const audio_processing_dev_t *dev, void *afeCle
             if (dev->cap.callback != NULL)
             {
                 audio_processing_event_t audio_processing = {0};
-                if ((s_afeDataGenerated - s_afeDataProcessed) > (ASR_INPUT_CYCLE_SLOTS - 2))
-                {
-                    LOGE("ASR failed to process AFE data in time! %d != %d", s_afeDataGenerated, s_afeDataProcessed);
-                }
+
+                HAL_AudioFrameRing_Publish(&g_AsrFrameRing, dataToSendSize);
                 s_afeDataGenerated++;
 
                 audio_processing.eventId   = kAudioProcessingEvent_Done;
                 audio_processing.eventInfo = kEventInfo_Local;
-                audio_processing.data      = s_asrInput[s_slotIdx];
+                audio_processing.data      = asrFrame;
                 audio_processing.size      = dataToSendSize;
                 audio_processing.copy      = 0;
 
                 dev->cap.callback(dev, audio_processing, 0);
-                s_slotIdx = (s_slotIdx + 1) % ASR_INPUT_CYCLE_SLOTS;
             }
-        }
-    }
-    else
-    {
-        if (s_dirtySamples)
-        {
-            s_dirtySamples = false;
-            memset(s_asrInput[s_slotIdx], 0, ASR_INPUT_BUFFER_SIZE);
+            else
+            {
+                HAL_AudioFrameRing_Cancel(&g_AsrFrameRing);
+            }
+
+            s_asrFrame = NULL;
         }
     }
 
     s_accSamples = (s_accSamples + 1) % ASR_INPUT_FRAMES;
+    if (s_accSamples == 0)
+    {
+        s_asrFrameDropped = false;
+    }
 
     return s_accSamples;
 }
@@ -328,18 +387,39 @@ static uint32_t _consumeSpeakerFeedback(int16_t *dst, uint32_t length)
     return dataPlayed;
 }
 
+/**
+ * @brief  Get the buffer where to read speaker's audio chunk. When ASR also checks the speaker's audio for self wake
+ * up, the chunk is read straight into the ASR frame.
+ *
+ * @return Pointer to the buffer.
+ */
+static int16_t *_getSpeakerFeedbackBuffer(void)
+{
+    int16_t *afeAmpIn = (int16_t *)s_afeAmpIn;
+
+#if SELF_WAKE_UP_PROTECTION
+    uint8_t *asrFrame = _getAsrFrame();
+    if (asrFrame != NULL)
+    {
+        afeAmpIn = (int16_t *)&asrFrame[ASR_INPUT_BUFFER_SIZE + s_accSamples * AFE_OUTPUT_BUFFER_SIZE];
+    }
+#endif /* SELF_WAKE_UP_PROTECTION */
+
+    return afeAmpIn;
+}
+
 /**
  * @brief  Get speaker's audio chunk from feedback buffer in order to be used by AFE for AEC.
  *
+ * @param  afeAmpIn Pointer to the buffer where to read speaker's audio chunk.
+ *
  * @return Pointer to the buffer containing feedback data from Speaker.
  */
-static int16_t *_getSpeakerFeedback(void)
+static int16_t *_getSpeakerFeedback(int16_t *afeAmpIn)
 {
     static int32_t speakerTotalDelayUs = 0;
     static uint32_t speakerDelayedUs   = 0;
 
-    int16_t *afeAmpIn = (int16_t *)s_afeAmpIn;
-
     if (s_speakerState == kSpeakerFeedbackFirstPacket)
     {
         uint32_t currentTime = FWK_CurrentTimeUs();
@@ -579,6 +659,9 @@ hal_audio_processing_status_t audio_processing_afe_init(audio_processing_dev_t *
         error = kStatus_HAL_AudioProcessingError;
     }
 
+    HAL_AudioFrameRing_Init(&g_AsrFrameRing, (uint8_t *)s_asrFramePool, sizeof(s_asrFramePool[0]), ASR_FRAME_RING_DEPTH,
+                            s_asrFrameRefCount, s_asrFrameDataSize);
+
     return error;
 }
 
@@ -642,7 +725,7 @@ hal_audio_processing_status_t audio_processing_afe_run(const audio_processing_de
         _convertMicDataForAfe(event.audio_in.audio_stream, afeMicIn);
 
 #if !AMP_LOOPBACK_DISABLED
-        afeAmpIn = _getSpeakerFeedback();
+        afeAmpIn = _getSpeakerFeedback(_getSpeakerFeedbackBuffer());
 #endif /* !AMP_LOOPBACK_DISABLED */
 
         /* Run mic streams through AFE */
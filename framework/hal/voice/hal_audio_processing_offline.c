@@ -17,6 +17,7 @@
 #include "fwk_platform.h"
 #include "hal_audio_processing_dev.h"
 #include "hal_audio_defs.h"
+#include "hal_crc32.h"
 #include "hal_event_descriptor_voice.h"
 
 #include "fwk_output_manager.h"
@@ -147,7 +148,6 @@ typedef struct _hal_header_transfer_unit_t
 
 static uint32_t s_pckID;
 static uint32_t s_pckIndex;
-static uint32_t table[0x100];
 
 static const uint8_t TU_MAGIC[] = {0x53, 0x79, 0x4c};
 
@@ -182,34 +182,6 @@ static _system_reset(void)
     __NVIC_SystemReset();
 }
 
-static uint32_t crc32_for_byte(uint32_t r)
-{
-    for (int j = 0; j < 8; ++j)
-    {
-        r = (r & 1 ? 0 : (uint32_t)0xEDB88320L) ^ r >> 1;
-    }
-
-    return r ^ (uint32_t)0xFF000000L;
-}
-
-static void crc32(const void *data, size_t numBytes, uint32_t *crc)
-{
-    memset(table, 0x00, sizeof(table));
-
-    if (!*table)
-    {
-        for (size_t i = 0; i < 0x100; ++i)
-        {
-            table[i] = crc32_for_byte(i);
-        }
-    }
-
-    for (size_t i = 0; i < numBytes; ++i)
-    {
-        *crc = table[(uint8_t)*crc ^ ((uint8_t *)data)[i]] ^ *crc >> 8;
-    }
-}
-
 static hal_afe_audio_usb_status_t SLN_AFEAUDIOUSBParseHeader(uint8_t *headerBuf, hal_header_transfer_unit_t *pHtUnit)
 {
     hal_afe_audio_usb_status_t status = kHALAFEAUDIOUSBStatus_Success;
@@ -239,7 +211,7 @@ static hal_afe_audio_usb_status_t SLN_AFEAUDIOUSBParseHeader(uint8_t *headerBuf,
 
     /* transfer unit crc */
     pHtUnit->tuCrc = *((uint32_t *)(headerBuf + 20));
-    crc32(headerBuf, AFE_AUDIO_USB_HEADER_LENGTH - 4, &crc_res);
+    crc_res = HAL_Crc32_Update(crc_res, headerBuf, AFE_AUDIO_USB_HEADER_LENGTH - 4);
     if (crc_res != pHtUnit->tuCrc)
     {
         return kHALAFEAUDIOUSBStatus_TUCRC32Error;
@@ -268,7 +240,7 @@ static void SLN_AFEAUDIOUSBCreateHeader(
     if (len > 0)
     {
         /* packet crc */
-        crc32(data, len, &crc_res);
+        crc_res = HAL_Crc32_Update(crc_res, data, len);
         *((uint32_t *)(htUnit + 12)) = crc_res;
     }
     else
@@ -281,7 +253,7 @@ static void SLN_AFEAUDIOUSBCreateHeader(
 
     /* transfer unit crc */
     crc_res = 0;
-    crc32(htUnit, AFE_AUDIO_USB_HEADER_LENGTH - 4, &crc_res);
+    crc_res = HAL_Crc32_Update(crc_res, htUnit, AFE_AUDIO_USB_HEADER_LENGTH - 4);
     *((uint32_t *)(htUnit + 20)) = crc_res;
 }
 
@@ -310,7 +282,7 @@ static hal_afe_audio_usb_status_t SLN_AFEAUDIOUSBParseData(uint8_t *dataBuf, hal
 {
     hal_afe_audio_usb_status_t status = kHALAFEAUDIOUSBStatus_Success;
     uint32_t crc_res                  = 0;
-    crc32(dataBuf, pHtUnit->pktLen, &crc_res);
+    crc_res = HAL_Crc32_Update(crc_res, dataBuf, pHtUnit->pktLen);
     if (crc_res != pHtUnit->pktCrc)
     {
         return kHALAFEAUDIOUSBStatus_TUCRC32Error;
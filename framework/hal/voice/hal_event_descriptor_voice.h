@@ -39,6 +39,8 @@ typedef enum _event_voice_id
 typedef struct _audio_in_event
 {
     int32_t *audio_stream;
+    /* time in us at which the microphones completed the chunk */
+    uint32_t timestampUs;
 } audio_in_event_t;
 
 typedef struct _audio_out_event
@@ -13,8 +13,10 @@
 
 #include "fwk_log.h"
 #include "fwk_message.h"
+#include "fwk_platform.h"
 #include "fwk_voice_algo_manager.h"
 #include "hal_event_descriptor_voice.h"
+#include "hal_audio_frame_ring.h"
 
 /* local voice includes */
 #include "IndexCommands.h"
@@ -40,6 +42,58 @@
 #define CN_WAKE_WORD_MEMPOOL_SIZE (105 * 1024)
 #define COMMAND_MEMPOOL_SIZE      (150 * 1024)
 
+/* Languages which can be enabled at runtime. A language set to 0 is rejected by the multilingual config and takes no
+ * room in the WW arena. */
+#ifndef ASR_WW_LANGUAGE_EN
+#define ASR_WW_LANGUAGE_EN 1
+#endif /* ASR_WW_LANGUAGE_EN */
+
+#ifndef ASR_WW_LANGUAGE_CN
+#define ASR_WW_LANGUAGE_CN 1
+#endif /* ASR_WW_LANGUAGE_CN */
+
+#ifndef ASR_WW_LANGUAGE_DE
+#define ASR_WW_LANGUAGE_DE 1
+#endif /* ASR_WW_LANGUAGE_DE */
+
+#ifndef ASR_WW_LANGUAGE_FR
+#define ASR_WW_LANGUAGE_FR 1
+#endif /* ASR_WW_LANGUAGE_FR */
+
+#define ASR_WW_LANGUAGES                                                               \
+    ((ASR_WW_LANGUAGE_EN ? ASR_ENGLISH : 0) | (ASR_WW_LANGUAGE_CN ? ASR_CHINESE : 0) | \
+     (ASR_WW_LANGUAGE_DE ? ASR_GERMAN : 0) | (ASR_WW_LANGUAGE_FR ? ASR_FRENCH : 0))
+
+/* The wake word engines of the enabled languages share one arena. Each engine takes what SLN_ASR_LOCAL_Verify reports
+ * for its model instead of a fixed pool, the arena is sized for all the languages above enabled at once. With the four
+ * languages enabled this is the total of the former fixed pools, a product saves OCRAM only by disabling languages. */
+#ifndef ASR_WW_ARENA_SIZE
+#define ASR_WW_ARENA_LANGUAGES_SIZE                                                            \
+    ((ASR_WW_LANGUAGE_EN + ASR_WW_LANGUAGE_DE + ASR_WW_LANGUAGE_FR) * WAKE_WORD_MEMPOOL_SIZE + \
+     ASR_WW_LANGUAGE_CN * CN_WAKE_WORD_MEMPOOL_SIZE)
+#if (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW)
+#define ASR_WW_ARENA_SIZE (2 * ASR_WW_ARENA_LANGUAGES_SIZE)
+#else
+#define ASR_WW_ARENA_SIZE (ASR_WW_ARENA_LANGUAGES_SIZE)
+#endif /* (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW) */
+#endif /* ASR_WW_ARENA_SIZE */
+
+#if (ASR_WW_LANGUAGE_EN + ASR_WW_LANGUAGE_CN + ASR_WW_LANGUAGE_DE + ASR_WW_LANGUAGE_FR) == 0
+#error "At least one ASR_WW_LANGUAGE_xx must be enabled"
+#endif
+
+#define ASR_WW_ARENA_ALIGN 8
+
+/* Score added to a language each time its wake word is confirmed. All the scores lose a quarter on each detection, so
+ * the language used lately is evaluated first. This only picks the winner when several languages detect on the same
+ * frame: every engine still processes the frames without a detection, so the order saves no CPU. */
+#define ASR_WW_HIT_SCORE 1024
+
+/* Period of the per language wake word statistics log, in frames. 0 disables the log. */
+#ifndef ASR_WW_STATS_LOG_PERIOD
+#define ASR_WW_STATS_LOG_PERIOD 0
+#endif /* ASR_WW_STATS_LOG_PERIOD */
+
 /* Groups: base, ww, voice commands etc. */
 #define NUM_GROUPS (3 + CMD_MODELS_COUNT)
 
@@ -71,18 +125,9 @@ typedef enum _cmd_state
 /*******************************************************************************
  * Variables
  ******************************************************************************/
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangEn[WAKE_WORD_MEMPOOL_SIZE], 8);
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangCn[CN_WAKE_WORD_MEMPOOL_SIZE], 8);
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangDe[WAKE_WORD_MEMPOOL_SIZE], 8);
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangFr[WAKE_WORD_MEMPOOL_SIZE], 8);
+AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWW[ASR_WW_ARENA_SIZE], ASR_WW_ARENA_ALIGN);
 AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolCmd[COMMAND_MEMPOOL_SIZE], 8);
 
-#if (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW)
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangEnSelfWake[WAKE_WORD_MEMPOOL_SIZE], 8);
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangCnSelfWake[CN_WAKE_WORD_MEMPOOL_SIZE], 8);
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangDeSelfWake[WAKE_WORD_MEMPOOL_SIZE], 8);
-AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolWLangFrSelfWake[WAKE_WORD_MEMPOOL_SIZE], 8);
-#endif /* (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW) */
 #if (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_VC)
 AT_CACHEABLE_SECTION_ALIGN_OCRAM(static uint8_t s_memPoolCmdSelfWake[COMMAND_MEMPOOL_SIZE], 8);
 #endif /* (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_VC) */
@@ -99,6 +144,25 @@ typedef struct _asr_voice_param
 
 static asr_voice_param_t s_AsrEngine;
 
+/* Bytes of s_memPoolWW given to the wake word engines since the last initialization */
+static uint32_t s_memPoolWWUsed = 0;
+
+typedef struct _asr_ww_stats
+{
+    /* decayed count of confirmed wake words */
+    uint32_t score;
+    /* frames processed and time spent in the engine, since the last log */
+    uint32_t frames;
+    uint32_t timeUs;
+} asr_ww_stats_t;
+
+/* Statistics of each wake word engine, same index as s_AsrEngine.infWW */
+static asr_ww_stats_t s_wwStats[MAX_INTERFACES_WW];
+
+/* Wake word engines of the real languages, highest score first. The self wake up engines run on their own. */
+static struct asr_inference_engine *s_wwSchedule[MAX_NUM_LANGUAGES];
+static uint32_t s_wwScheduleCnt = 0;
+
 static void voice_algo_asr_result_notify(asr_inference_result_t *result, uint32_t utteranceLength);
 static void voice_algo_asr_run_notify(hal_valgo_status_t status);
 
@@ -373,7 +437,8 @@ static uint32_t install_inference_engine(asr_voice_control_t *pAsrCtrl,
 {
     sln_asr_local_states_t status = kAsrLocalSuccess;
 
-    if (pAsrCtrl && pInfEngine && lang && infType && addrMemPool && sizeMemPool)
+    /* Wake word engines get their memory from s_memPoolWW once their model is known. */
+    if (pAsrCtrl && pInfEngine && lang && infType && ((addrMemPool && sizeMemPool) || (infType == ASR_WW)))
     {
         pInfEngine->iWhoAmI_inf  = infType;
         pInfEngine->iWhoAmI_lang = lang;
@@ -460,6 +525,130 @@ static void reset_inference_handler(struct asr_inference_engine *p)
     SLN_ASR_LOCAL_Reset(p->handler);
 }
 
+/*!
+ * @brief Give a WW engine the memory its model needs from the shared wake word arena.
+ */
+static void alloc_inference_memory(struct asr_inference_engine *p)
+{
+    int32_t mem_usage;
+    uint32_t size;
+
+    p->memPool     = NULL;
+    p->memPoolSize = 0;
+
+    mem_usage = SLN_ASR_LOCAL_Verify(p->addrGroup[0], (unsigned char **)&p->addrGroup[1], 1, k_nMaxTime);
+    if (mem_usage <= 0)
+    {
+        LOGE("Could not verify the WW model of language %d!\r\n", p->iWhoAmI_lang);
+        return;
+    }
+
+    size = ((uint32_t)mem_usage + ASR_WW_ARENA_ALIGN - 1) & ~(ASR_WW_ARENA_ALIGN - 1);
+    if (size > ASR_WW_ARENA_SIZE - s_memPoolWWUsed)
+    {
+        LOGE("Memory size %d for WW exceeds the memory left in the WW arena %d!\r\n", mem_usage,
+             ASR_WW_ARENA_SIZE - s_memPoolWWUsed);
+        return;
+    }
+
+    p->memPool     = &s_memPoolWW[s_memPoolWWUsed];
+    p->memPoolSize = size;
+    s_memPoolWWUsed += size;
+}
+
+/*!
+ * @brief Sort the WW engines of the real languages by score, the stable sort keeps the install order on equal scores.
+ */
+static void sort_WW_schedule(void)
+{
+    for (uint32_t i = 1; i < s_wwScheduleCnt; i++)
+    {
+        struct asr_inference_engine *pInf = s_wwSchedule[i];
+        uint32_t score                    = s_wwStats[pInf - s_AsrEngine.infWW].score;
+        uint32_t j                        = i;
+
+        while ((j > 0) && (s_wwStats[s_wwSchedule[j - 1] - s_AsrEngine.infWW].score < score))
+        {
+            s_wwSchedule[j] = s_wwSchedule[j - 1];
+            j--;
+        }
+        s_wwSchedule[j] = pInf;
+    }
+}
+
+/*!
+ * @brief Build the evaluation order of the WW engines of the real languages.
+ */
+static void init_WW_schedule(asr_voice_control_t *pAsrCtrl)
+{
+    struct asr_inference_engine *pInf;
+
+    s_wwScheduleCnt = 0;
+    for (pInf = pAsrCtrl->infEngineWW; pInf != NULL; pInf = pInf->next)
+    {
+        /* Skip fake languages and the engines left without memory. */
+        if ((pInf->iWhoAmI_lang < LAST_LANGUAGE) && (pInf->memPool != NULL) &&
+            (s_wwScheduleCnt < MAX_NUM_LANGUAGES))
+        {
+            s_wwSchedule[s_wwScheduleCnt++] = pInf;
+        }
+    }
+
+    sort_WW_schedule();
+}
+
+/*!
+ * @brief Move the language of a confirmed wake word up in the evaluation order.
+ */
+static void update_WW_schedule(asr_language_t lang)
+{
+    for (uint32_t i = 0; i < MAX_INTERFACES_WW; i++)
+    {
+        s_wwStats[i].score -= s_wwStats[i].score >> 2;
+    }
+
+    for (uint32_t i = 0; i < s_wwScheduleCnt; i++)
+    {
+        if (s_wwSchedule[i]->iWhoAmI_lang == lang)
+        {
+            s_wwStats[s_wwSchedule[i] - s_AsrEngine.infWW].score += ASR_WW_HIT_SCORE;
+            break;
+        }
+    }
+
+    sort_WW_schedule();
+}
+
+#if ASR_WW_STATS_LOG_PERIOD
+/*!
+ * @brief Log the average time spent per frame in each WW engine.
+ */
+static void log_WW_stats(asr_voice_control_t *pAsrCtrl)
+{
+    static uint32_t s_framesCnt = 0;
+    struct asr_inference_engine *pInf;
+
+    if (++s_framesCnt < ASR_WW_STATS_LOG_PERIOD)
+    {
+        return;
+    }
+    s_framesCnt = 0;
+
+    for (pInf = pAsrCtrl->infEngineWW; pInf != NULL; pInf = pInf->next)
+    {
+        asr_ww_stats_t *pStats = &s_wwStats[pInf - s_AsrEngine.infWW];
+
+        if (pStats->frames != 0)
+        {
+            LOGD("[ASR] WW lang %d: %d frames, %d [us] per frame, score %d", pInf->iWhoAmI_lang, pStats->frames,
+                 pStats->timeUs / pStats->frames, pStats->score);
+        }
+        pStats->frames = 0;
+        pStats->timeUs = 0;
+    }
+}
+#endif /* ASR_WW_STATS_LOG_PERIOD */
+
 /*!
  * @brief Initialize WW inference engine from the installed language models.
  *  After, pInfEngine should be a linked list of the installed languages.
@@ -485,11 +674,18 @@ static void init_WW_engine(asr_voice_control_t *pAsrCtrl, asr_inference_t infTyp
         pInfEngine->addrGroup[1]   = pLang->addrGroup[idx];            // language model's wake word group
         pInfEngine->addrGroupMapID = pLang->addrGroupMapID[idx_mapID]; // language model's wake word mapID group
 
-        verify_inference_handler(pInfEngine); // verify inference handler, checking mem pool size
-        set_inference_handler(pInfEngine);    // set inf engine to ww mode for each language.
+        alloc_inference_memory(pInfEngine); // take the memory the model needs from the WW arena
+        if (pInfEngine->memPool != NULL)
+        {
+            set_inference_handler(pInfEngine); // set inf engine to ww mode for each language.
+        }
 
         pInfEngine = pInfEngine->next; // the end of pInfEngine->next should be NULL.
     }
+
+    LOGD("[ASR] WW arena: %d of %d bytes used", s_memPoolWWUsed, ASR_WW_ARENA_SIZE);
+
+    init_WW_schedule(pAsrCtrl);
 }
 
 /*!
@@ -536,7 +732,10 @@ static void set_WW_engine(asr_voice_control_t *pAsrCtrl)
 
     for (pInf = pAsrCtrl->infEngineWW; pInf != NULL; pInf = pInf->next)
     {
-        set_inference_handler(pInf);
+        if (pInf->memPool != NULL)
+        {
+            set_inference_handler(pInf);
+        }
     }
 }
 
@@ -549,7 +748,10 @@ static void reset_WW_engine(asr_voice_control_t *pAsrCtrl)
 
     for (pInf = pAsrCtrl->infEngineWW; pInf != NULL; pInf = pInf->next)
     {
-        reset_inference_handler(pInf);
+        if (pInf->handler != NULL)
+        {
+            reset_inference_handler(pInf);
+        }
     }
 }
 
@@ -629,6 +831,23 @@ static int asr_process_audio_buffer(void *handler, int16_t *audBuff, uint16_t bu
     return status;
 }
 
+/*!
+ * @brief Run a WW engine on a frame and account the time spent in it.
+ */
+static int asr_process_WW_buffer(struct asr_inference_engine *pInf, int16_t *audBuff)
+{
+    asr_ww_stats_t *pStats = &s_wwStats[pInf - s_AsrEngine.infWW];
+    uint32_t startUs       = FWK_CurrentTimeUs();
+    int status;
+
+    status = asr_process_audio_buffer(pInf->handler, audBuff, NUM_SAMPLES_AFE_OUTPUT, pInf->iWhoAmI_inf);
+
+    pStats->timeUs += FWK_CurrentTimeUs() - startUs;
+    pStats->frames++;
+
+    return status;
+}
+
 static char *asr_get_string_by_id(struct asr_inference_engine *pInfEngine, int32_t id)
 {
     return pInfEngine->idToKeyword[id];
@@ -669,17 +888,19 @@ static void initialize_asr(void)
 {
     asr_language_t lang[MAX_NUM_LANGUAGES] = {UNDEFINED_LANGUAGE};
 
-    /* Check enabled languages. lang[i] equal to 0 means language is disabled. */
-    lang[0] = s_AsrEngine.voiceConfig.multilingual & ASR_ENGLISH;
-    lang[1] = s_AsrEngine.voiceConfig.multilingual & ASR_CHINESE;
-    lang[2] = s_AsrEngine.voiceConfig.multilingual & ASR_GERMAN;
-    lang[3] = s_AsrEngine.voiceConfig.multilingual & ASR_FRENCH;
+    /* Check enabled languages. lang[i] equal to 0 means language is disabled.
+     * A saved config may still list a language the WW arena is not sized for. */
+    lang[0] = s_AsrEngine.voiceConfig.multilingual & ASR_WW_LANGUAGES & ASR_ENGLISH;
+    lang[1] = s_AsrEngine.voiceConfig.multilingual & ASR_WW_LANGUAGES & ASR_CHINESE;
+    lang[2] = s_AsrEngine.voiceConfig.multilingual & ASR_WW_LANGUAGES & ASR_GERMAN;
+    lang[3] = s_AsrEngine.voiceConfig.multilingual & ASR_WW_LANGUAGES & ASR_FRENCH;
 
     /* Reset ASR modules.
      * NULL to ensure the end of linked list. */
     s_AsrEngine.voiceControl.langModel    = NULL;
     s_AsrEngine.voiceControl.infEngineWW  = NULL;
     s_AsrEngine.voiceControl.infEngineCMD = NULL;
+    s_memPoolWWUsed                       = 0;
 
     /* Install enabled languages. */
     install_language(&s_AsrEngine.voiceControl, &s_AsrEngine.langModel[3], lang[3], (unsigned char *)&oob_demo_fr_begin,
@@ -692,14 +913,10 @@ static void initialize_asr(void)
                      NUM_GROUPS);
 
     /* Install enabled languages' Wake Words. */
-    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[3], lang[3], ASR_WW, ww_fr, s_memPoolWLangFr,
-                             WAKE_WORD_MEMPOOL_SIZE);
-    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[2], lang[2], ASR_WW, ww_de, s_memPoolWLangDe,
-                             WAKE_WORD_MEMPOOL_SIZE);
-    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[1], lang[1], ASR_WW, ww_cn, s_memPoolWLangCn,
-                             CN_WAKE_WORD_MEMPOOL_SIZE);
-    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[0], lang[0], ASR_WW, ww_en, s_memPoolWLangEn,
-                             WAKE_WORD_MEMPOOL_SIZE);
+    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[3], lang[3], ASR_WW, ww_fr, NULL, 0);
+    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[2], lang[2], ASR_WW, ww_de, NULL, 0);
+    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[1], lang[1], ASR_WW, ww_cn, NULL, 0);
+    install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[0], lang[0], ASR_WW, ww_en, NULL, 0);
 
     /* Install English Voice Commands.
      * Reconfigure Voice Commands to appropriate language after Wake Word in that language is uttered. */
@@ -723,17 +940,13 @@ static void initialize_asr(void)
 #if (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW)
     /* Install enabled languages' Wake Words self wake up protection mechanism. */
     install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[MAX_NUM_LANGUAGES + 3],
-                             get_self_protection_language(lang[3]), ASR_WW, ww_fr, s_memPoolWLangFrSelfWake,
-                             WAKE_WORD_MEMPOOL_SIZE);
+                             get_self_protection_language(lang[3]), ASR_WW, ww_fr, NULL, 0);
     install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[MAX_NUM_LANGUAGES + 2],
-                             get_self_protection_language(lang[2]), ASR_WW, ww_de, s_memPoolWLangDeSelfWake,
-                             WAKE_WORD_MEMPOOL_SIZE);
+                             get_self_protection_language(lang[2]), ASR_WW, ww_de, NULL, 0);
     install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[MAX_NUM_LANGUAGES + 1],
-                             get_self_protection_language(lang[1]), ASR_WW, ww_cn, s_memPoolWLangCnSelfWake,
-                             CN_WAKE_WORD_MEMPOOL_SIZE);
+                             get_self_protection_language(lang[1]), ASR_WW, ww_cn, NULL, 0);
     install_inference_engine(&s_AsrEngine.voiceControl, &s_AsrEngine.infWW[MAX_NUM_LANGUAGES + 0],
-                             get_self_protection_language(lang[0]), ASR_WW, ww_en, s_memPoolWLangEnSelfWake,
-                             WAKE_WORD_MEMPOOL_SIZE);
+                             get_self_protection_language(lang[0]), ASR_WW, ww_en, NULL, 0);
 #endif /* (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW) */
 
 #if (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_VC)
@@ -787,16 +1000,16 @@ static const bool isLanguageSupported(asr_language_t language)
     switch (language)
     {
         case ASR_ENGLISH:
-            supported = true;
+            supported = ASR_WW_LANGUAGE_EN;
             break;
         case ASR_CHINESE:
-            supported = true;
+            supported = ASR_WW_LANGUAGE_CN;
             break;
         case ASR_GERMAN:
-            supported = true;
+            supported = ASR_WW_LANGUAGE_DE;
             break;
         case ASR_FRENCH:
-            supported = true;
+            supported = ASR_WW_LANGUAGE_FR;
             break;
 
         default:
@@ -813,7 +1026,7 @@ static bool isMultilingualSupported(asr_language_t language)
 
     for (uint8_t i = 0; i < (sizeof(asr_language_t) * 8); i++)
     {
-        asr_language_t lang = ((1 < i) & language);
+        asr_language_t lang = ((1U << i) & language);
         if (lang != 0)
         {
             if (isLanguageSupported(lang) == false)
@@ -935,9 +1148,9 @@ hal_valgo_status_t voice_algo_dev_asr_init(voice_algo_dev_t *dev, valgo_dev_call
 }
 
 /*!
- * @brief ASR main task
+ * @brief Run the recognition on one frame of clean audio, optionally followed by the speaker feedback
  */
-hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *data)
+static hal_valgo_status_t _voice_algo_asr_process(const voice_algo_dev_t *dev, void *audioData, uint32_t audioSize)
 {
     hal_valgo_status_t status = kStatus_HAL_ValgoSuccess;
     struct asr_inference_engine *pInfWW;
@@ -945,23 +1158,22 @@ hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *dat
     int16_t *cleanSound   = NULL;
     int16_t *speakerSound = NULL;
 
-    msg_payload_t *audioIn = (msg_payload_t *)data;
-    if ((audioIn->data != NULL) && (audioIn->size == NUM_SAMPLES_AFE_OUTPUT))
+    if ((audioData != NULL) && (audioSize == NUM_SAMPLES_AFE_OUTPUT))
     {
-        cleanSound   = audioIn->data;
+        cleanSound   = audioData;
         speakerSound = NULL;
     }
 #if SELF_WAKE_UP_PROTECTION
-    else if ((audioIn->data != NULL) && (audioIn->size == (NUM_SAMPLES_AFE_OUTPUT * 2)))
+    else if ((audioData != NULL) && (audioSize == (NUM_SAMPLES_AFE_OUTPUT * 2)))
     {
-        cleanSound   = audioIn->data;
-        speakerSound = &(((int16_t *)audioIn->data)[NUM_SAMPLES_AFE_OUTPUT]);
+        cleanSound   = audioData;
+        speakerSound = &(((int16_t *)audioData)[NUM_SAMPLES_AFE_OUTPUT]);
     }
 #endif /* SELF_WAKE_UP_PROTECTION */
     else
     {
         status = kStatus_HAL_ValgoError;
-        LOGE("[ASR] Received invalid audio packet: addr=0x%X, size=%d", (uint32_t)audioIn->data, audioIn->size);
+        LOGE("[ASR] Received invalid audio packet: addr=0x%X, size=%d", (uint32_t)audioData, audioSize);
     }
 
     if (status == kStatus_HAL_ValgoSuccess)
@@ -985,13 +1197,12 @@ hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *dat
                  * Skip actual languages. Example: Process ASR_ENGLISH_SELF, but skip ASR_ENGLISH. */
                 for (pInfWW = s_AsrEngine.voiceControl.infEngineWW; pInfWW != NULL; pInfWW = pInfWW->next)
                 {
-                    if (pInfWW->iWhoAmI_lang < LAST_LANGUAGE)
+                    if ((pInfWW->iWhoAmI_lang < LAST_LANGUAGE) || (pInfWW->handler == NULL))
                     {
                         continue;
                     }
 
-                    if (asr_process_audio_buffer(pInfWW->handler, speakerSound, NUM_SAMPLES_AFE_OUTPUT,
-                                                 pInfWW->iWhoAmI_inf) == kAsrLocalDetected)
+                    if (asr_process_WW_buffer(pInfWW, speakerSound) == kAsrLocalDetected)
                     {
                         s_cmdName = asr_get_string_by_id(pInfWW, s_AsrEngine.voiceControl.result.keywordID[0]);
                         s_cmdLang = pInfWW->iWhoAmI_lang;
@@ -1005,16 +1216,12 @@ hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *dat
 #endif /* (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW) */
 
             /* Wake Word detection. Check all enabled languages, but stop on first match.
-             * Skip fake languages. Example: Process ASR_ENGLISH, but skip ASR_ENGLISH_SELF. */
-            for (pInfWW = s_AsrEngine.voiceControl.infEngineWW; pInfWW != NULL; pInfWW = pInfWW->next)
+             * The schedule only holds actual languages, the most used one first. */
+            for (uint32_t i = 0; i < s_wwScheduleCnt; i++)
             {
-                if (pInfWW->iWhoAmI_lang >= LAST_LANGUAGE)
-                {
-                    continue;
-                }
+                pInfWW = s_wwSchedule[i];
 
-                if (asr_process_audio_buffer(pInfWW->handler, cleanSound, NUM_SAMPLES_AFE_OUTPUT,
-                                             pInfWW->iWhoAmI_inf) == kAsrLocalDetected)
+                if (asr_process_WW_buffer(pInfWW, cleanSound) == kAsrLocalDetected)
                 {
                     s_cmdName   = asr_get_string_by_id(pInfWW, s_AsrEngine.voiceControl.result.keywordID[0]);
                     s_cmdLang   = pInfWW->iWhoAmI_lang;
@@ -1039,6 +1246,7 @@ hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *dat
                      s_cmdDetails.cmdMapID, cmdConfirmedDelayMs);
 
                 s_AsrEngine.voiceConfig.currentLanguage = s_cmdLang;
+                update_WW_schedule(s_cmdLang);
 
                 /* Send Feedback to AFE regarding detected Wake Word length.
                  * Based on this feedback, AFE calibrates itself for a better performance. */
@@ -1058,6 +1266,10 @@ hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *dat
             }
 #endif /* (SELF_WAKE_UP_PROTECTION & SELF_WAKE_UP_WW) */
 
+#if ASR_WW_STATS_LOG_PERIOD
+            log_WW_stats(&s_AsrEngine.voiceControl);
+#endif /* ASR_WW_STATS_LOG_PERIOD */
+
 #if ENABLE_OUTPUT_DEV_AudioDump == 2
             _forwardDataToAudioDump(dev, cleanSound, NUM_SAMPLES_AFE_OUTPUT * SAMPLE_SIZE_AFE_OUTPUT, speakerSound,
                                     NUM_SAMPLES_AFE_OUTPUT * SAMPLE_SIZE_AFE_OUTPUT);
@@ -1168,6 +1380,33 @@ hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *dat
     return status;
 }
 
+/*!
+ * @brief ASR main task
+ */
+hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *data)
+{
+    hal_valgo_status_t status = kStatus_HAL_ValgoSuccess;
+    msg_payload_t *audioIn    = (msg_payload_t *)data;
+    uint32_t audioSize        = 0;
+    uint8_t *asrFrame;
+
+    /* input which doesn't come from the ring, such as the offline audio processing, is in the message */
+    if (!HAL_AudioFrameRing_Owns(&g_AsrFrameRing, audioIn->data))
+    {
+        return _voice_algo_asr_process(dev, audioIn->data, audioIn->size);
+    }
+
+    /* Frames published in the ring by AFE are processed in place, in order. The message only tells frames are ready,
+     * all the pending ones are processed so a frame whose message got lost isn't left behind in the ring. */
+    while ((asrFrame = HAL_AudioFrameRing_Get(&g_AsrFrameRing, &audioSize)) != NULL)
+    {
+        status = _voice_algo_asr_process(dev, asrFrame, audioSize);
+        HAL_AudioFrameRing_Release(&g_AsrFrameRing, asrFrame);
+    }
+
+    return status;
+}
+
 hal_valgo_status_t voice_algo_dev_input_notify(const voice_algo_dev_t *dev, void *data)
 {
     hal_valgo_status_t error = kStatus_HAL_ValgoSuccess;
@@ -15,6 +15,7 @@
 #include "fwk_message.h"
 #include "fwk_voice_algo_manager.h"
 #include "hal_event_descriptor_voice.h"
+#include "hal_audio_frame_ring.h"
 #include "PL_platformTypes_CortexM.h"
 #include "hal_audio_defs.h"
 #include "VIT.h"
@@ -667,9 +668,9 @@ cmd_state_t confirmDetectedCommand(bool realCmdDetected, bool fakeCmdDetected, v
 }
 
 /*!
- * @brief ASR main task
+ * @brief Run the recognition on one frame of clean audio, optionally followed by the speaker feedback
  */
-static hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *data)
+static hal_valgo_status_t _voice_algo_asr_process(const voice_algo_dev_t *dev, void *audioData, uint32_t audioSize)
 {
     hal_valgo_status_t status = kStatus_HAL_ValgoSuccess;
     VIT_ReturnStatus_en VIT_Status;
@@ -686,23 +687,22 @@ static hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, vo
     bool realCmdDetected                                = false;
     bool fakeCmdDetected                                = false;
 
-    msg_payload_t *audioIn = (msg_payload_t *)data;
-    if ((audioIn->data != NULL) && (audioIn->size == NUM_SAMPLES_AFE_OUTPUT))
+    if ((audioData != NULL) && (audioSize == NUM_SAMPLES_AFE_OUTPUT))
     {
-        cleanSound   = audioIn->data;
+        cleanSound   = audioData;
         speakerSound = NULL;
     }
 #if SELF_WAKE_UP_PROTECTION
-    else if ((audioIn->data != NULL) && (audioIn->size == (NUM_SAMPLES_AFE_OUTPUT * 2)))
+    else if ((audioData != NULL) && (audioSize == (NUM_SAMPLES_AFE_OUTPUT * 2)))
     {
-        cleanSound   = audioIn->data;
-        speakerSound = &(((int16_t *)audioIn->data)[NUM_SAMPLES_AFE_OUTPUT]);
+        cleanSound   = audioData;
+        speakerSound = &(((int16_t *)audioData)[NUM_SAMPLES_AFE_OUTPUT]);
     }
 #endif /* SELF_WAKE_UP_PROTECTION */
     else
     {
         status = kStatus_HAL_ValgoError;
-        LOGE("[ASR] Received invalid audio packet: addr=0x%X, size=%d", (uint32_t)audioIn->data, audioIn->size);
+        LOGE("[ASR] Received invalid audio packet: addr=0x%X, size=%d", (uint32_t)audioData, audioSize);
     }
 
     if (status == kStatus_HAL_ValgoSuccess)
@@ -847,6 +847,34 @@ static hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, vo
 
         s_afeDataProcessed++;
     }
+
+    return status;
+}
+
+/*!
+ * @brief ASR main task
+ */
+static hal_valgo_status_t voice_algo_dev_asr_run(const voice_algo_dev_t *dev, void *data)
+{
+    hal_valgo_status_t status = kStatus_HAL_ValgoSuccess;
+    msg_payload_t *audioIn    = (msg_payload_t *)data;
+    uint32_t audioSize        = 0;
+    uint8_t *asrFrame;
+
+    /* input which doesn't come from the ring, such as the offline audio processing, is in the message */
+    if (!HAL_AudioFrameRing_Owns(&g_AsrFrameRing, audioIn->data))
+    {
+        return _voice_algo_asr_process(dev, audioIn->data, audioIn->size);
+    }
+
+    /* Frames published in the ring by AFE are processed in place, in order. The message only tells frames are ready,
+     * all the pending ones are processed so a frame whose message got lost isn't left behind in the ring. */
+    while ((asrFrame = HAL_AudioFrameRing_Get(&g_AsrFrameRing, &audioSize)) != NULL)
+    {
+        status = _voice_algo_asr_process(dev, asrFrame, audioSize);
+        HAL_AudioFrameRing_Release(&g_AsrFrameRing, asrFrame);
+    }
+
     return status;
 }
 
@@ -13,9 +13,13 @@
 #include "fwk_flash.h"
 #include "fwk_log.h"
 #include "ftp_client_api.h"
+#include "ftp_ring.h"
 #include "lwftp.h"
 #include "FreeRTOS.h"
 #include "event_groups.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
 
 typedef enum _ftp_state
 {
@@ -25,12 +29,27 @@ typedef enum _ftp_state
     kFTP_Store,
     kFTP_StoreFail,
     kFTP_Storing,
+    kFTP_BufferFree,
 } ftp_state_t;
 
 #define FTP_STORE_TIMEOUT_MS   20000
 #define FTP_CONNECT_TIMEOUT_MS 30000
 #define ENCRYPTED_FILE         0
 
+/* The control connection of the FTP task is closed after this long without upload */
+#ifndef FTP_IDLE_TIMEOUT_MS
+#define FTP_IDLE_TIMEOUT_MS 10000
+#endif /* FTP_IDLE_TIMEOUT_MS */
+
+#define FTP_JOB_QUEUE_LENGTH 4
+
+/* Longest the data connection waits for the FTP task to fill a buffer of the ring, see ftp_ring.h */
+#define FTP_RING_WAIT_MS 1000
+
+#define FTP_TASK_NAME     "FTP"
+#define FTP_TASK_STACK    1024
+#define FTP_TASK_PRIORITY 3
+
 #define FTP_INFO_DIR "wifi_info"
 
 #define FTP_INFO_FILE \
@@ -44,6 +63,53 @@ static bool s_ftpInit = false;
 static ftp_state_t s_state;
 static char *s_pFileSource;
 static uint32_t s_fileSize, s_fileOffset;
+static volatile uint32_t s_fileAcked;
+
+static QueueHandle_t s_ftpJobQueue;
+static ftp_ring_t s_ring;
+static SemaphoreHandle_t s_ringFree;
+static SemaphoreHandle_t s_ringFilled;
+static volatile bool s_ringAbort;
+
+static status_t _FTP_AsyncInit(void);
+
+/* Next bytes of the buffer being sent, 0 once the whole file was sent */
+static uint32_t _FTP_RingNext(const char **pptr, uint32_t maxlen)
+{
+    uint32_t len = 0;
+
+    if (s_fileOffset < s_fileSize)
+    {
+        if (FTP_Ring_AtBufferStart(&s_ring))
+        {
+            if (xSemaphoreTake(s_ringFilled, pdMS_TO_TICKS(FTP_RING_WAIT_MS)) != pdTRUE)
+            {
+                /* Ends the file early, the store fails on the size check */
+                LOGE("FTP store, no data to send at offset %d", s_fileOffset);
+                return 0;
+            }
+
+            if (s_ringAbort)
+            {
+                return 0;
+            }
+        }
+
+        len = FTP_Ring_Next(&s_ring, pptr, maxlen);
+    }
+
+    return len;
+}
+
+/* Give back to the FTP task the buffers acknowledged by the server */
+static void _FTP_RingRelease(uint32_t len)
+{
+    for (uint32_t freed = FTP_Ring_Release(&s_ring, len); freed > 0; freed--)
+    {
+        xSemaphoreGive(s_ringFree);
+        xEventGroupSetBits(s_ftpEvent, 1 << kFTP_BufferFree);
+    }
+}
 
 static uint32_t _FTP_DataSourceCallback(void *arg, const char **pptr, uint32_t maxlen)
 {
@@ -53,13 +119,20 @@ static uint32_t _FTP_DataSourceCallback(void *arg, const char **pptr, uint32_t m
     if (pptr)
     {
         LOGD("FTP store, offset %d", s_fileOffset);
-        len = s_fileSize - s_fileOffset;
-        if (len > maxlen)
+        if (s_pFileSource != NULL)
         {
-            len = maxlen;
-        }
+            len = s_fileSize - s_fileOffset;
+            if (len > maxlen)
+            {
+                len = maxlen;
+            }
 
-        *pptr = (s_pFileSource + s_fileOffset);
+            *pptr = (s_pFileSource + s_fileOffset);
+        }
+        else
+        {
+            len = _FTP_RingNext(pptr, maxlen);
+        }
 
         s_fileOffset += len;
         if (len != 0)
@@ -67,6 +140,14 @@ static uint32_t _FTP_DataSourceCallback(void *arg, const char **pptr, uint32_t m
             xEventGroupSetBits(s_ftpEvent, 1 << kFTP_Storing);
         }
     }
+    else
+    {
+        s_fileAcked += maxlen;
+        if (s_pFileSource == NULL)
+        {
+            _FTP_RingRelease(maxlen);
+        }
+    }
 
     return len;
 }
@@ -289,6 +370,11 @@ status_t FTP_Init(void)
         status = kStatus_Fail;
     }
 
+    if (status == kStatus_Success)
+    {
+        status = _FTP_AsyncInit();
+    }
+
     if (status == kStatus_Fail)
     {
         vEventGroupDelete(s_ftpEvent);
@@ -361,77 +447,307 @@ ftp_session_handle_t FTP_ConnectBlocking(void)
     return handle;
 }
 
+static void _FTP_RingDeinit(void)
+{
+    for (int i = 0; i < FTP_RING_BUFFER_CNT; i++)
+    {
+        if (s_ring.buffer[i] != NULL)
+        {
+            vPortFree(s_ring.buffer[i]);
+            s_ring.buffer[i] = NULL;
+        }
+    }
+}
+
+/* Fill the next free buffer, the FTP task owns it until it is given to the data connection */
+static status_t _FTP_RingFill(const ftp_store_job_t *job, uint32_t *produced)
+{
+    uint32_t size = s_fileSize - *produced;
+    if (size > FTP_RING_BUFFER_SIZE)
+    {
+        size = FTP_RING_BUFFER_SIZE;
+    }
+
+    if (job->read(job->arg, *produced, FTP_Ring_FillBuffer(&s_ring), size) != size)
+    {
+        LOGE("FTP read failed at offset %d", *produced);
+        return kStatus_Fail;
+    }
+
+    FTP_Ring_Filled(&s_ring, size);
+    *produced += size;
+    xSemaphoreGive(s_ringFilled);
+
+    return kStatus_Success;
+}
+
+/* Reset the ring for a new upload and fill the first buffer before the data connection is opened */
+static status_t _FTP_RingStart(const ftp_store_job_t *job, uint32_t *produced)
+{
+    for (int i = 0; i < FTP_RING_BUFFER_CNT; i++)
+    {
+        if (s_ring.buffer[i] == NULL)
+        {
+            s_ring.buffer[i] = pvPortMalloc(FTP_RING_BUFFER_SIZE);
+            if (s_ring.buffer[i] == NULL)
+            {
+                LOGE("Failed to allocate the FTP buffers");
+                _FTP_RingDeinit();
+                return kStatus_Fail;
+            }
+        }
+    }
+
+    /* A failed upload can leave buffers in the data connection */
+    s_ringAbort = false;
+    while (xSemaphoreTake(s_ringFilled, 0) == pdTRUE)
+    {
+    }
+    while (xSemaphoreTake(s_ringFree, 0) == pdTRUE)
+    {
+    }
+    for (int i = 0; i < FTP_RING_BUFFER_CNT; i++)
+    {
+        xSemaphoreGive(s_ringFree);
+    }
+
+    FTP_Ring_Reset(&s_ring);
+    *produced = 0;
+
+    if ((s_fileSize != 0) && (xSemaphoreTake(s_ringFree, 0) == pdTRUE))
+    {
+        return _FTP_RingFill(job, produced);
+    }
+
+    return kStatus_Success;
+}
+
+static status_t _FTP_Store(lwftp_session_t *ftpSession, const char *remotePath, const ftp_store_job_t *job)
+{
+    status_t status   = kStatus_Success;
+    uint32_t produced = 0;
+    err_t error;
+
+    s_state                 = kFTP_Store;
+    s_pFileSource           = (char *)job->dataSource;
+    s_fileSize              = job->len;
+    s_fileOffset            = 0;
+    s_fileAcked             = 0;
+    ftpSession->data_source = _FTP_DataSourceCallback;
+    ftpSession->done_fn     = _FTP_StoreCallback;
+    ftpSession->remote_path = remotePath;
+    xEventGroupClearBits(s_ftpEvent,
+                         (1 << kFTP_Store) | (1 << kFTP_StoreFail) | (1 << kFTP_Storing) | (1 << kFTP_BufferFree));
+
+    if (s_pFileSource == NULL)
+    {
+        status = _FTP_RingStart(job, &produced);
+    }
+    else
+    {
+        produced = s_fileSize;
+    }
+
+    if (status == kStatus_Success)
+    {
+        error = lwftp_store(ftpSession);
+        if (error != LWFTP_RESULT_INPROGRESS)
+        {
+            LOGE("lwftp_store failed (%d)", error);
+            status = kStatus_Fail;
+        }
+    }
+
+    while (status == kStatus_Success)
+    {
+        /* Read the next chunk while the previous ones are sent */
+        if ((produced < s_fileSize) && (xSemaphoreTake(s_ringFree, 0) == pdTRUE))
+        {
+            status = _FTP_RingFill(job, &produced);
+            continue;
+        }
+
+        EventBits_t bits = xEventGroupWaitBits(
+            s_ftpEvent, ((1 << kFTP_Store) | (1 << kFTP_StoreFail) | (1 << kFTP_Storing) | (1 << kFTP_BufferFree)),
+            pdTRUE, pdFALSE, pdMS_TO_TICKS(FTP_STORE_TIMEOUT_MS));
+
+        if ((bits & (1 << kFTP_StoreFail)) != 0)
+        {
+            status = kStatus_Fail;
+        }
+        else if ((bits & (1 << kFTP_Store)) != 0)
+        {
+            break;
+        }
+        else if ((bits & ((1 << kFTP_Storing) | (1 << kFTP_BufferFree))) != 0)
+        {
+            LOGD("Still sending..")
+            s_state = kFTP_Storing;
+            if (job->progress != NULL)
+            {
+                job->progress(job->arg, s_fileAcked, s_fileSize);
+            }
+        }
+        else
+        {
+            /* If no activity detected. Abort */
+            LOGE("FTP store timeout");
+            status = kStatus_Fail;
+        }
+    }
+
+    if ((status == kStatus_Success) && (s_fileOffset != s_fileSize))
+    {
+        LOGE("FTP store ended at offset %d of %d", s_fileOffset, s_fileSize);
+        status = kStatus_Fail;
+    }
+
+    if (status == kStatus_Fail)
+    {
+        if (s_pFileSource == NULL)
+        {
+            /* Don't let the data connection wait for a buffer which won't be filled */
+            s_ringAbort = true;
+            xSemaphoreGive(s_ringFilled);
+        }
+        ftpSession->done_fn = NULL;
+        lwftp_close(ftpSession);
+        s_state = kFTP_Disconected;
+    }
+    else
+    {
+        s_state = kFTP_Connected;
+        if (job->progress != NULL)
+        {
+            job->progress(job->arg, s_fileSize, s_fileSize);
+        }
+    }
+
+    return status;
+}
+
 status_t FTP_StoreBlocking(ftp_session_handle_t sessionHandler, const char *remotePath, char *dataSource, uint32_t len)
 {
-    lwftp_session_t *ftpSession;
     status_t status = kStatus_Success;
 
-    if ((sessionHandler == NULL) || (remotePath == NULL))
+    if ((sessionHandler == NULL) || (remotePath == NULL) || (dataSource == NULL))
     {
         status = kStatus_InvalidArgument;
     }
 
     if (status == kStatus_Success)
     {
-        ftpSession = (lwftp_session_t *)sessionHandler;
         if (s_state == kFTP_Connected)
         {
-            err_t error;
-            s_state                 = kFTP_Store;
-            s_pFileSource           = dataSource;
-            s_fileSize              = len;
-            ftpSession->data_source = _FTP_DataSourceCallback;
-            ftpSession->done_fn     = _FTP_StoreCallback;
-            ftpSession->remote_path = remotePath;
-            xEventGroupClearBits(s_ftpEvent, (1 << kFTP_Store) | (1 << kFTP_StoreFail) | (1 << kFTP_Storing));
-            error = lwftp_store(ftpSession);
-            if (error != LWFTP_RESULT_INPROGRESS)
-            {
-                LOGE("lwftp_store failed (%d)", error);
-                status = kStatus_Fail;
-            }
-            else
+            ftp_store_job_t job = {.dataSource = dataSource, .len = len};
+            status              = _FTP_Store((lwftp_session_t *)sessionHandler, remotePath, &job);
+        }
+    }
+    return status;
+}
+
+static void _FTP_Task(void *arg)
+{
+    ftp_session_handle_t handle = NULL;
+    ftp_store_job_t job;
+
+    while (1)
+    {
+        if (xQueueReceive(s_ftpJobQueue, &job,
+                          (handle != NULL) ? pdMS_TO_TICKS(FTP_IDLE_TIMEOUT_MS) : portMAX_DELAY) != pdTRUE)
+        {
+            LOGD("FTP idle, disconnect");
+            FTP_DisconnectBlocking(handle);
+            handle = NULL;
+            _FTP_RingDeinit();
+            continue;
+        }
+
+        status_t status = kStatus_Fail;
+        /* The server may have closed a control connection kept from a previous upload, then nothing was sent on it.
+         * Connect again once. */
+        for (int attempt = 0; (attempt < 2) && (status != kStatus_Success); attempt++)
+        {
+            bool reused = (handle != NULL);
+            if (handle == NULL)
             {
-                while (status != kStatus_Fail)
-                {
-                    EventBits_t bits = xEventGroupWaitBits(
-                        s_ftpEvent, ((1 << kFTP_Store) | (1 << kFTP_StoreFail) | (1 << kFTP_Storing)), pdTRUE, pdFALSE,
-                        pdMS_TO_TICKS(FTP_STORE_TIMEOUT_MS));
-
-                    if ((bits & (1 << kFTP_StoreFail)) != 0)
-                    {
-                        status = kStatus_Fail;
-                    }
-                    else if ((bits & (1 << kFTP_Storing)) != 0)
-                    {
-                        LOGI("Still sending..")
-                        s_state = kFTP_Storing;
-                    }
-                    else if ((bits & (1 << kFTP_Store)) != 0)
-                    {
-                        break;
-                    }
-                    else
-                    {
-                        /* If no activity detected. Abort */
-                        LOGE("FTP store timeout");
-                        status = kStatus_Fail;
-                    }
-                }
+                handle = FTP_ConnectBlocking();
             }
 
-            if (status == kStatus_Fail)
+            if (handle == NULL)
             {
-                ftpSession->done_fn = NULL;
-                lwftp_close(ftpSession);
-                s_state = kFTP_Disconected;
+                LOGE("Not connected to the server. Can't store %s", job.remotePath);
+                break;
             }
-            else
+
+            status = _FTP_Store((lwftp_session_t *)handle, job.remotePath, &job);
+            if (status != kStatus_Success)
             {
-                s_state = kFTP_Connected;
+                /* The session was closed */
+                handle = NULL;
+                if (!reused || (s_fileAcked != 0))
+                {
+                    break;
+                }
             }
         }
+
+        if (job.done != NULL)
+        {
+            job.done(job.arg, status);
+        }
+    }
+}
+
+static status_t _FTP_AsyncInit(void)
+{
+    s_ftpJobQueue = xQueueCreate(FTP_JOB_QUEUE_LENGTH, sizeof(ftp_store_job_t));
+    s_ringFree    = xSemaphoreCreateCounting(FTP_RING_BUFFER_CNT, 0);
+    s_ringFilled  = xSemaphoreCreateCounting(FTP_RING_BUFFER_CNT, 0);
+    if ((s_ftpJobQueue != NULL) && (s_ringFree != NULL) && (s_ringFilled != NULL) &&
+        (xTaskCreate(_FTP_Task, FTP_TASK_NAME, FTP_TASK_STACK, NULL, FTP_TASK_PRIORITY, NULL) == pdPASS))
+    {
+        return kStatus_Success;
+    }
+
+    LOGE("Failed to create the FTP task");
+    if (s_ftpJobQueue != NULL)
+    {
+        vQueueDelete(s_ftpJobQueue);
+        s_ftpJobQueue = NULL;
+    }
+    if (s_ringFree != NULL)
+    {
+        vSemaphoreDelete(s_ringFree);
+        s_ringFree = NULL;
+    }
+    if (s_ringFilled != NULL)
+    {
+        vSemaphoreDelete(s_ringFilled);
+        s_ringFilled = NULL;
+    }
+
+    return kStatus_Fail;
+}
+
+status_t FTP_StoreAsync(const ftp_store_job_t *job)
+{
+    status_t status = kStatus_Success;
+
+    if ((job == NULL) || (job->remotePath[0] == '\0') || ((job->dataSource == NULL) && (job->read == NULL)))
+    {
+        status = kStatus_InvalidArgument;
+    }
+    else if (!s_ftpInit)
+    {
+        status = kStatus_Fail;
+    }
+    else if (xQueueSend(s_ftpJobQueue, job, 0) != pdTRUE)
+    {
+        LOGE("FTP upload queue full, %s dropped", job->remotePath);
+        status = kStatus_Fail;
     }
+
     return status;
 }
 
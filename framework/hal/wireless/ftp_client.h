@@ -10,8 +10,9 @@
 #ifndef FTP_CLIENT_H_
 #define FTP_CLIENT_H_
 
-#define FTP_USER_LENGTH     63
-#define FTP_PASSWORD_LENGTH 63
+#define FTP_USER_LENGTH        63
+#define FTP_PASSWORD_LENGTH    63
+#define FTP_REMOTE_PATH_LENGTH 64
 
 /**
  * @brief The FTP USER structure
@@ -15,6 +15,49 @@
 
 typedef void *ftp_session_handle_t;
 
+/**
+ * @brief Read the next chunk of an upload, called from the FTP task.
+ * The file can be read or encoded here while the previous chunks are sent.
+ *
+ * @param arg Argument of the upload
+ * @param offset Offset of the chunk in the file
+ * @param buffer Buffer to fill
+ * @param size Size of the chunk
+ * @return Number of bytes read, less than size aborts the upload
+ */
+typedef uint32_t (*ftp_read_callback_t)(void *arg, uint32_t offset, uint8_t *buffer, uint32_t size);
+
+/**
+ * @brief Progress of an upload, called from the FTP task
+ *
+ * @param arg Argument of the upload
+ * @param sent Bytes acknowledged by the server
+ * @param len Length of the file
+ */
+typedef void (*ftp_progress_callback_t)(void *arg, uint32_t sent, uint32_t len);
+
+/**
+ * @brief End of an upload, called from the FTP task
+ *
+ * @param arg Argument of the upload
+ * @param status kStatus_Success if the whole file was stored
+ */
+typedef void (*ftp_done_callback_t)(void *arg, status_t status);
+
+/**
+ * @brief An upload queued with FTP_StoreAsync
+ */
+typedef struct _ftp_store_job
+{
+    char remotePath[FTP_REMOTE_PATH_LENGTH]; /**< Remote path at which to save the file */
+    const char *dataSource;                  /**< File in memory, sent in place. NULL to get it through read */
+    uint32_t len;                            /**< Length of the file */
+    ftp_read_callback_t read;                /**< Read the file chunk by chunk when dataSource is NULL */
+    ftp_progress_callback_t progress;        /**< Optional */
+    ftp_done_callback_t done;                /**< Optional */
+    void *arg;                               /**< Argument of the callbacks */
+} ftp_store_job_t;
+
 /**
  * @brief Set server info
  *
@@ -83,6 +126,16 @@ ftp_session_handle_t FTP_ConnectBlocking(void);
  */
 status_t FTP_StoreBlocking(ftp_session_handle_t sessionHandler, const char *remotePath, char *dataSource, uint32_t len);
 
+/**
+ * @brief Queue an upload to the server specified by saved server_info.
+ * The uploads are stored one after the other by the FTP task on the same control connection, which is closed when
+ * no upload is queued for FTP_IDLE_TIMEOUT_MS. Not to be used while a session of the blocking API is open.
+ *
+ * @param job Upload to queue, copied. dataSource must stay valid until the done callback
+ * @return kStatus_Success if the upload was queued, kStatus_Fail if the queue is full
+ */
+status_t FTP_StoreAsync(const ftp_store_job_t *job);
+
 /**
  * @brief Disconnect from a connected server
  *
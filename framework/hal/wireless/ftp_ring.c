@@ -0,0 +1,83 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief FTP upload ring implementation.
+ */
+
+#include <stddef.h>
+
+#include "ftp_ring.h"
+
+void FTP_Ring_Reset(ftp_ring_t *ring)
+{
+    for (int i = 0; i < FTP_RING_BUFFER_CNT; i++)
+    {
+        ring->len[i] = 0;
+    }
+
+    ring->fill       = 0;
+    ring->send       = 0;
+    ring->sendOffset = 0;
+    ring->ack        = 0;
+    ring->ackOffset  = 0;
+}
+
+uint8_t *FTP_Ring_FillBuffer(ftp_ring_t *ring)
+{
+    return ring->buffer[ring->fill];
+}
+
+void FTP_Ring_Filled(ftp_ring_t *ring, uint32_t len)
+{
+    ring->len[ring->fill] = len;
+    ring->fill            = (ring->fill + 1) % FTP_RING_BUFFER_CNT;
+}
+
+bool FTP_Ring_AtBufferStart(const ftp_ring_t *ring)
+{
+    return ring->sendOffset == 0;
+}
+
+uint32_t FTP_Ring_Next(ftp_ring_t *ring, const char **pptr, uint32_t maxlen)
+{
+    uint32_t len = ring->len[ring->send] - ring->sendOffset;
+
+    if (len > maxlen)
+    {
+        len = maxlen;
+    }
+
+    *pptr = (const char *)(ring->buffer[ring->send] + ring->sendOffset);
+
+    ring->sendOffset += len;
+    if (ring->sendOffset == ring->len[ring->send])
+    {
+        ring->send       = (ring->send + 1) % FTP_RING_BUFFER_CNT;
+        ring->sendOffset = 0;
+    }
+
+    return len;
+}
+
+uint32_t FTP_Ring_Release(ftp_ring_t *ring, uint32_t len)
+{
+    uint32_t freed = 0;
+
+    ring->ackOffset += len;
+    while ((ring->len[ring->ack] != 0) && (ring->ackOffset >= ring->len[ring->ack]))
+    {
+        ring->ackOffset -= ring->len[ring->ack];
+        ring->len[ring->ack] = 0;
+        ring->ack            = (ring->ack + 1) % FTP_RING_BUFFER_CNT;
+        freed++;
+    }
+
+    return freed;
+}
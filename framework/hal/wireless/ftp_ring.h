@@ -0,0 +1,93 @@
+/*
+ * Copyright 2022 NXP.
+ * This software is owned or controlled by NXP and may only be used strictly in accordance with the
+ * license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+ * activating and/or otherwise using the software, you are agreeing that you have read, and that you
+ * agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+ * applicable license terms, then you may not retain, install, activate or otherwise use the software.
+ */
+
+/*
+ * @brief FTP upload ring declaration.
+ * Uploads read through a callback are sent from a ring of buffers. The FTP task fills the free buffers while the data
+ * connection sends the filled ones. lwftp sends the buffers in place, so a buffer is free again only once the server
+ * acknowledged all of it. The ring only keeps the positions, the caller signals the filled and the free buffers.
+ */
+
+#ifndef FTP_RING_H_
+#define FTP_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FTP_RING_BUFFER_CNT  4
+#define FTP_RING_BUFFER_SIZE (4 * 1024)
+
+typedef struct _ftp_ring
+{
+    uint8_t *buffer[FTP_RING_BUFFER_CNT];
+    /* bytes filled in each buffer, 0 while it is free */
+    uint32_t len[FTP_RING_BUFFER_CNT];
+    /* next buffer to fill */
+    uint32_t fill;
+    /* buffer being sent and the bytes of it already sent */
+    uint32_t send;
+    uint32_t sendOffset;
+    /* oldest buffer not acknowledged and the bytes of it already acknowledged */
+    uint32_t ack;
+    uint32_t ackOffset;
+} ftp_ring_t;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Reset the ring for a new upload, all the buffers are free
+ * @param ring ring of the upload
+ */
+void FTP_Ring_Reset(ftp_ring_t *ring);
+
+/**
+ * @brief Get the next buffer to fill, to be called only when a buffer is free
+ * @param ring ring of the upload
+ * @return buffer of FTP_RING_BUFFER_SIZE bytes
+ */
+uint8_t *FTP_Ring_FillBuffer(ftp_ring_t *ring);
+
+/**
+ * @brief Hand the buffer returned by FTP_Ring_FillBuffer to the data connection
+ * @param ring ring of the upload
+ * @param len bytes filled in the buffer, 1 to FTP_RING_BUFFER_SIZE
+ */
+void FTP_Ring_Filled(ftp_ring_t *ring, uint32_t len);
+
+/**
+ * @brief Check if the next bytes to send start a new buffer, which must then be filled before FTP_Ring_Next
+ * @param ring ring of the upload
+ * @return true at the start of a buffer
+ */
+bool FTP_Ring_AtBufferStart(const ftp_ring_t *ring);
+
+/**
+ * @brief Get the next bytes to send, from the filled buffer being sent
+ * @param ring ring of the upload
+ * @param pptr start of the bytes to send
+ * @param maxlen maximum number of bytes
+ * @return number of bytes to send
+ */
+uint32_t FTP_Ring_Next(ftp_ring_t *ring, const char **pptr, uint32_t maxlen);
+
+/**
+ * @brief Account the bytes acknowledged by the server
+ * @param ring ring of the upload
+ * @param len number of bytes acknowledged
+ * @return number of buffers which are free again
+ */
+uint32_t FTP_Ring_Release(ftp_ring_t *ring, uint32_t len);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* FTP_RING_H_ */
@@ -104,8 +104,33 @@ typedef struct _camera_dev_operator
     hal_camera_status_t (*postProcess)(const camera_dev_t *dev, void **data, pixel_format_t *format);
     /* input notify */
     hal_camera_status_t (*inputNotify)(const camera_dev_t *dev, void *data);
+    /* change the exposure by a number of steps, positive to brighten the frames, see camera_dev_exposure_t */
+    hal_camera_status_t (*adjustExposure)(const camera_dev_t *dev, int steps);
 } camera_dev_operator_t;
 
+/*! @brief Light of the scene of a camera, driven by the camera manager auto exposure */
+typedef enum _camera_dev_light
+{
+    kCameraDevLight_None = 0,
+    kCameraDevLight_IR,
+    kCameraDevLight_White,
+} camera_dev_light_t;
+
+/*! @brief Actuators of the camera manager auto exposure, all zero when the device controls its own exposure */
+typedef struct
+{
+    /* brightness change of one adjustExposure step up and down, in EV (log2 of the ratio) */
+    float stepUpEv;
+    float stepDownEv;
+    /* adjustExposure steps available above and below the exposure set by the device init */
+    int stepsUp;
+    int stepsDown;
+    /* LED lighting the scene and its brightness range, in % */
+    camera_dev_light_t light;
+    uint8_t lightMin;
+    uint8_t lightMax;
+} camera_dev_exposure_t;
+
 /*! @brief Structure that characterize the camera device. */
 typedef struct
 {
@@ -124,6 +149,8 @@ typedef struct
     flip_mode_t flip;
     /* swap byte per two bytes */
     int swapByte;
+    /* auto exposure actuators */
+    camera_dev_exposure_t exposure;
 } camera_dev_static_config_t;
 
 typedef struct
@@ -134,6 +161,39 @@ typedef struct
     void *param;
 } camera_dev_private_capability_t;
 
+/*
+ * Camera trace file, written by tools/camera_trace/camera_trace_pack.py and replayed by the 2d_trace camera device.
+ * The header is followed by one record per frame, each record is immediately followed by the frameSize bytes of the
+ * frame. All the records have the same size so frame N starts at headerSize + N * (sizeof(record) + frameSize).
+ */
+#define CAMERA_TRACE_MAGIC   0x43525443 /* "CTRC" */
+#define CAMERA_TRACE_VERSION 2
+
+typedef struct _camera_trace_header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint16_t width;
+    uint16_t height;
+    uint16_t pitch;
+    /* cw_rotate_degree_t and flip_mode_t of the camera the frames come from */
+    uint8_t rotate;
+    uint8_t flip;
+    uint32_t frameSize;
+    /* swap byte per two bytes */
+    uint8_t swapByte;
+    uint8_t reserved[3];
+} camera_trace_header_t;
+
+typedef struct _camera_trace_record
+{
+    /* capture time of the frame, relative to the first frame of the trace */
+    uint32_t timestampUs;
+    /* pixel_format_t of the frame */
+    uint32_t format;
+} camera_trace_record_t;
+
 /*! @brief Attributes of a camera device. */
 struct _camera_dev
 {
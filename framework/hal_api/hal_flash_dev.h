@@ -66,6 +66,8 @@ typedef struct _flash_dev_operator
     sln_flash_status_t (*rm)(const flash_dev_t *dev, const char *path);
     sln_flash_status_t (*rename)(const flash_dev_t *dev, const char *oldPath, const char *newPath);
     sln_flash_status_t (*cleanup)(const flash_dev_t *dev, unsigned int timeout_ms);
+    sln_flash_status_t (*write)(
+        const flash_dev_t *dev, const char *path, void *buf, unsigned int offset, unsigned int size);
 } flash_dev_operator_t;
 
 /*! @brief Attributes of a flash device */
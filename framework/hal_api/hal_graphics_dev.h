@@ -36,6 +36,14 @@
         }                                                           \
     }
 
+typedef struct _gfx_rect
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+} gfx_rect_t;
+
 typedef struct _gfx_surface
 {
     int height;
@@ -50,6 +58,9 @@ typedef struct _gfx_surface
     pixel_format_t format;
     void *buf;
     void *lock; /*the structure is determined by hal and set to null if not use in hal*/
+    /* overlay surface only: bounds of the drawn pixels, the rest is transparent. Updated under the lock by the owner of
+     * the surface, the whole surface is composed if NULL or empty */
+    gfx_rect_t *pContent;
 } gfx_surface_t;
 
 typedef enum _gfx_rotate_target
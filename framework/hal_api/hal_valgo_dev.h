@@ -146,6 +146,10 @@ typedef struct _vision_frame
     /* the source pixel format of the requested frame */
     pixel_format_t srcFormat;
     void *data;
+#if VISION_ALGO_FRAME_DEPTH > 1
+    /* extra buffers of the same size as data, the manager overlaps capture and run when they are set */
+    void *ringData[VISION_ALGO_FRAME_DEPTH - 1];
+#endif /* VISION_ALGO_FRAME_DEPTH > 1 */
 } vision_frame_t;
 
 typedef struct
@@ -16,6 +16,20 @@
  * Definitions
  ******************************************************************************/
 
+/* Maximum number of buffers an input channel producer can cycle through */
+#ifndef AUDIO_INPUT_CHANNEL_MAX_DEPTH
+#define AUDIO_INPUT_CHANNEL_MAX_DEPTH 8
+#endif /* AUDIO_INPUT_CHANNEL_MAX_DEPTH */
+
+typedef struct _audio_input_stats
+{
+    uint32_t pushed;       /* chunks pushed by the producer */
+    uint32_t processed;    /* chunks run through the audio processing devices */
+    uint32_t overruns;     /* chunks overwritten by the producer before or while they were processed */
+    uint32_t maxPending;   /* highest number of chunks waiting for the audio processing task */
+    uint32_t maxLatencyUs; /* longest time between the push of a chunk and the start of its processing */
+} audio_input_stats_t;
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -42,6 +56,34 @@ int FWK_AudioProcessing_DeviceRegister(audio_processing_dev_t *dev);
  */
 int FWK_AudioProcessing_Start(int taskPriority);
 
+/**
+ * @brief Open the input channel. The channel hands the audio chunks of a producer, typically a microphone DMA
+ * interrupt, straight to the audio processing task without going through the input manager.
+ * The producer cycles through depth buffers, so a chunk is overwritten depth - 1 chunks after it was pushed.
+ *
+ * @param depth number of buffers of the producer, from 2 to AUDIO_INPUT_CHANNEL_MAX_DEPTH
+ * @return int Return 0 if the channel was opened
+ */
+int FWK_AudioProcessing_InputChannelOpen(uint32_t depth);
+
+/**
+ * @brief Push a chunk to the input channel, from the producer interrupt or task
+ *
+ * @param data chunk passed to the run operator of the audio processing devices
+ * @param timestampUs time in us at which the chunk was completed
+ * @param fromISR 1 when called from an interrupt
+ * @return int Return 0 if successful
+ */
+int FWK_AudioProcessing_InputChannelPush(void *data, uint32_t timestampUs, uint8_t fromISR);
+
+/**
+ * @brief Get the statistics of the input channel
+ *
+ * @param stats pointer to the statistics to fill
+ * @return int Return 0 if successful
+ */
+int FWK_AudioProcessing_InputChannelGetStats(audio_input_stats_t *stats);
+
 /**
  * @brief Deinit Audio Processing manager
  *
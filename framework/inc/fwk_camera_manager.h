@@ -15,6 +15,9 @@
 #define _FWK_CAMERA_MANAGER_H_
 
 #include "hal_camera_dev.h"
+#if FWK_SUPPORT_CAMERA_AE
+#include "camera/hal_camera_exposure.h"
+#endif /* FWK_SUPPORT_CAMERA_AE */
 
 #if defined(__cplusplus)
 extern "C" {
@@ -40,6 +43,16 @@ int FWK_CameraManager_DeviceRegister(camera_dev_t *dev);
  */
 int FWK_CameraManager_Start(int taskPriority);
 
+#if FWK_SUPPORT_CAMERA_AE
+/**
+ * @brief Get the statistics of the auto exposure of a camera device
+ * @param devId id of the camera device
+ * @param stats pointer to the statistics to fill
+ * @return int Return 0 if successful, -1 if the device has no exposure actuators
+ */
+int FWK_CameraManager_GetExposureStats(int devId, camera_exposure_stats_t *stats);
+#endif /* FWK_SUPPORT_CAMERA_AE */
+
 /**
  * @brief Deinit CameraManager
  * @return int Return 0 if the deinit process was successful
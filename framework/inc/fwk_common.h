@@ -245,6 +245,11 @@ typedef enum _event_info
 #define MAXIMUM_VOICE_ALGO_DEV       1
 #define MAXIMUM_AUDIO_PROCESSING_DEV 1
 
+/* Frame slots of a vision algo dev, the camera fills one slot while the algorithm runs on another */
+#ifndef VISION_ALGO_FRAME_DEPTH
+#define VISION_ALGO_FRAME_DEPTH 2
+#endif /* VISION_ALGO_FRAME_DEPTH */
+
 #define MAXIMUM_CONFIGS_PER_DEVICE 5
 
 #define FROM_ISR_TRUE  1
@@ -310,4 +315,19 @@ typedef struct _framework_request
 #define FWK_SUPPORT_ASYNC_CAMERA_INIT 1
 #endif /* FWK_SUPPORT_ASYNC_CAMERA_INIT */
 
+#ifndef FWK_SUPPORT_LPM_GOVERNOR
+#define FWK_SUPPORT_LPM_GOVERNOR 0
+#endif /* FWK_SUPPORT_LPM_GOVERNOR */
+
+/* LOGI/LOGD/LOGV formatted by a low priority task. %s arguments are truncated to FWK_LOG_MAX_STRING_LENGTH and
+ * arguments beyond FWK_LOG_MAX_ARG_WORDS print as <?> */
+#ifndef FWK_SUPPORT_DEFERRED_LOG
+#define FWK_SUPPORT_DEFERRED_LOG 0
+#endif /* FWK_SUPPORT_DEFERRED_LOG */
+
+/* camera manager auto exposure driving the exposure of the sensors and the LEDs, instead of the vision algorithms */
+#ifndef FWK_SUPPORT_CAMERA_AE
+#define FWK_SUPPORT_CAMERA_AE 0
+#endif /* FWK_SUPPORT_CAMERA_AE */
+
 #endif /*_FWK_COMMON_H_*/
@@ -60,6 +60,16 @@ sln_flash_status_t FWK_Flash_Save(const char *path, void *buf, unsigned int size
  */
 sln_flash_status_t FWK_Flash_Append(const char *path, void *buf, unsigned int size, bool overwrite);
 
+/**
+ * @brief Overwrite part of an existing file in place, the rest of the file is kept.
+ * @param path Path of the file in the file system
+ * @param buf  Buffer which contains the data that is going to be written
+ * @param offset Position in the file of the first byte to write
+ * @param size Size of the buffer
+ * @return the status of write operation
+ */
+sln_flash_status_t FWK_Flash_Write(const char *path, void *buf, unsigned int offset, unsigned int size);
+
 /**
  * @brief Read from a file
  * @param path Path of the file in the file system
@@ -29,6 +29,9 @@ int gfx_drawPicture(gfx_surface_t *pOverlay, int x, int y, int w, int h, int alp
 int gfx_drawText(gfx_surface_t *pOverlay, int x, int y, int textColor, int bgColor, int type, const char *pText);
 int gfx_compose(
     gfx_surface_t *pSrc, gfx_surface_t *pOverlay, gfx_surface_t *pDst, gfx_rotate_config_t *pRotate, flip_mode_t flip);
+void gfx_rect_clear(gfx_rect_t *pRect);
+void gfx_rect_add(gfx_rect_t *pRect, int x, int y, int w, int h);
+int gfx_rect_empty(const gfx_rect_t *pRect);
 
 #if defined(__cplusplus)
 }
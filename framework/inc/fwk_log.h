@@ -45,85 +45,167 @@ extern "C" {
 #define DEBUG_CONSOLE_UNLOCK()
 #endif
 
+/* Compile time log level of a module. Define it before including fwk_log.h, calls above it are compiled out. */
+#ifndef FWK_LOG_LEVEL
+#define FWK_LOG_LEVEL kLOGLevel_Verbose
+#endif /* FWK_LOG_LEVEL */
+
+#if FWK_SUPPORT_DEFERRED_LOG
+/* Size in bytes of the record ring, must be a power of 2 */
+#ifndef FWK_LOG_RING_SIZE
+#define FWK_LOG_RING_SIZE 4096
+#endif /* FWK_LOG_RING_SIZE */
+
+/* Maximum number of 32 bit argument words stored in a record, 64 bit values take 2 words */
+#ifndef FWK_LOG_MAX_ARG_WORDS
+#define FWK_LOG_MAX_ARG_WORDS 16
+#endif /* FWK_LOG_MAX_ARG_WORDS */
+
+/* %s arguments are copied in the record, longer strings are truncated */
+#ifndef FWK_LOG_MAX_STRING_LENGTH
+#define FWK_LOG_MAX_STRING_LENGTH 23
+#endif /* FWK_LOG_MAX_STRING_LENGTH */
+
+/* Task names are copied in the record, they may be deleted before the record is printed */
+#ifndef FWK_LOG_TASK_NAME_LENGTH
+#define FWK_LOG_TASK_NAME_LENGTH 20
+#endif /* FWK_LOG_TASK_NAME_LENGTH */
+
+#ifndef FWK_LOG_TASK_PRIORITY
+#define FWK_LOG_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif /* FWK_LOG_TASK_PRIORITY */
+
+#ifndef FWK_LOG_TASK_STACK_SIZE
+#define FWK_LOG_TASK_STACK_SIZE 512
+#endif /* FWK_LOG_TASK_STACK_SIZE */
+
+/* Period at which the log task formats the pending records */
+#ifndef FWK_LOG_FLUSH_PERIOD_MS
+#define FWK_LOG_FLUSH_PERIOD_MS 20
+#endif /* FWK_LOG_FLUSH_PERIOD_MS */
+
+/*! @brief Header of a binary log record, followed by the argument words */
+typedef struct _fwk_log_record
+{
+    uint16_t size;                           /* record size in bytes including the header */
+    uint8_t level;                           /* log_level_t of the record */
+    uint8_t words;                           /* number of argument words */
+    uint32_t timestampUs;                    /* time of the call */
+    const char *fmt;                         /* format string, its address is the record ID when decoding on the host */
+    char taskName[FWK_LOG_TASK_NAME_LENGTH]; /* calling task */
+} fwk_log_record_t;
+
+/*! @brief Statistics of the deferred log */
+typedef struct _fwk_log_stats
+{
+    uint32_t recordCount;  /* records written to the ring */
+    uint32_t droppedCount; /* records dropped because the ring was full */
+    uint32_t peakUsage;    /* highest number of bytes pending in the ring */
+} fwk_log_stats_t;
+
+/**
+ * @brief Store a log record in the ring without formatting it. Safe to call from interrupts.
+ * The format string must stay valid (string literal), %s arguments are copied.
+ * @param level log level of the record
+ * @param fmt printf like format string
+ */
+void FWK_Log_Record(uint8_t level, const char *fmt, ...);
+
+/**
+ * @brief Get the statistics of the deferred log
+ * @param stats pointer to the statistics to fill
+ * @return 0 express success, -1 express fail
+ */
+int FWK_Log_GetStats(fwk_log_stats_t *stats);
+
+#define FWK_LOG_OUTPUT(level, fmt, args...)     FWK_Log_Record(level, fmt, ##args)
+#define FWK_LOG_OUTPUT_ISR(level, fmt, args...) FWK_Log_Record(level, fmt, ##args)
+#else
+#define FWK_LOG_OUTPUT(level, fmt, args...)   \
+    {                                         \
+        if ((level) == kLOGLevel_Debug)       \
+        {                                     \
+            vLoggingPrintfDebug(fmt, ##args); \
+        }                                     \
+        else                                  \
+        {                                     \
+            vLoggingPrintfInfo(fmt, ##args);  \
+        }                                     \
+    }
+#define FWK_LOG_OUTPUT_ISR(level, fmt, args...) \
+    {                                           \
+        PRINTF(fmt, ##args);                    \
+        PRINTF("\r\n");                         \
+    }
+#endif /* FWK_SUPPORT_DEFERRED_LOG */
+
+#define FWK_LOG_ENABLED(level) ((FWK_LOG_LEVEL >= (level)) && (FWK_Config_GetLogLevel() >= (level)))
+
 #ifndef LOGISRV
-#define LOGISRV(fmt, args...)                              \
-    {                                                      \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Verbose) \
-        {                                                  \
-            {                                              \
-                PRINTF(fmt, ##args);                       \
-                PRINTF("\r\n");                            \
-            }                                              \
-        }                                                  \
+#define LOGISRV(fmt, args...)                                   \
+    {                                                           \
+        if (FWK_LOG_ENABLED(kLOGLevel_Verbose))                 \
+        {                                                       \
+            FWK_LOG_OUTPUT_ISR(kLOGLevel_Verbose, fmt, ##args); \
+        }                                                       \
     }
 #endif /* LOGISRV */
 
 #ifndef LOGV
-#define LOGV(fmt, args...)                                 \
-    {                                                      \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Verbose) \
-        {                                                  \
-            {                                              \
-                vLoggingPrintfInfo(fmt, ##args);           \
-            }                                              \
-        }                                                  \
+#define LOGV(fmt, args...)                                  \
+    {                                                       \
+        if (FWK_LOG_ENABLED(kLOGLevel_Verbose))             \
+        {                                                   \
+            FWK_LOG_OUTPUT(kLOGLevel_Verbose, fmt, ##args); \
+        }                                                   \
     }
 #endif
 
 #ifndef LOGISRD
-#define LOGISRD(fmt, args...)                            \
-    {                                                    \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Debug) \
-        {                                                \
-            {                                            \
-                PRINTF(fmt, ##args);                     \
-                PRINTF("\r\n");                          \
-            }                                            \
-        }                                                \
+#define LOGISRD(fmt, args...)                                 \
+    {                                                         \
+        if (FWK_LOG_ENABLED(kLOGLevel_Debug))                 \
+        {                                                     \
+            FWK_LOG_OUTPUT_ISR(kLOGLevel_Debug, fmt, ##args); \
+        }                                                     \
     }
 #endif /* LOGISRD */
 
 #ifndef LOGD
-#define LOGD(fmt, args...)                               \
-    {                                                    \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Debug) \
-        {                                                \
-            {                                            \
-                vLoggingPrintfDebug(fmt, ##args);        \
-            }                                            \
-        }                                                \
+#define LOGD(fmt, args...)                                \
+    {                                                     \
+        if (FWK_LOG_ENABLED(kLOGLevel_Debug))             \
+        {                                                 \
+            FWK_LOG_OUTPUT(kLOGLevel_Debug, fmt, ##args); \
+        }                                                 \
     }
 #endif
 
 #ifndef LOGISRI
-#define LOGISRI(fmt, args...)                           \
-    {                                                   \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Info) \
-        {                                               \
-            {                                           \
-                PRINTF(fmt, ##args);                    \
-                PRINTF("\r\n");                         \
-            }                                           \
-        }                                               \
+#define LOGISRI(fmt, args...)                                \
+    {                                                        \
+        if (FWK_LOG_ENABLED(kLOGLevel_Info))                 \
+        {                                                    \
+            FWK_LOG_OUTPUT_ISR(kLOGLevel_Info, fmt, ##args); \
+        }                                                    \
     }
 #endif /* LOGISRI */
 
 #ifndef LOGI
-#define LOGI(fmt, args...)                              \
-    {                                                   \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Info) \
-        {                                               \
-            {                                           \
-                vLoggingPrintfInfo(fmt, ##args);        \
-            }                                           \
-        }                                               \
+#define LOGI(fmt, args...)                               \
+    {                                                    \
+        if (FWK_LOG_ENABLED(kLOGLevel_Info))             \
+        {                                                \
+            FWK_LOG_OUTPUT(kLOGLevel_Info, fmt, ##args); \
+        }                                                \
     }
 #endif
 
+/* Errors are always printed synchronously so they are not lost on a crash */
 #ifndef LOGISRE
 #define LOGISRE(fmt, args...)                                                       \
     {                                                                               \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Error)                            \
+        if (FWK_LOG_ENABLED(kLOGLevel_Error))                                       \
         {                                                                           \
             {                                                                       \
                 PRINTF("%s:%d: In function \"%s\":", __FILE__, __LINE__, __func__); \
@@ -139,7 +221,7 @@ extern "C" {
 #ifndef LOGE
 #define LOGE(fmt, args...)                                                                       \
     {                                                                                            \
-        if (FWK_Config_GetLogLevel() >= kLOGLevel_Error)                                         \
+        if (FWK_LOG_ENABLED(kLOGLevel_Error))                                                    \
         {                                                                                        \
             {                                                                                    \
                 vLoggingPrintfError("%s:%d: In function \"%s\":", __FILE__, __LINE__, __func__); \
@@ -14,8 +14,44 @@
 #ifndef _FWK_LPM_MANAGER_H_
 #define _FWK_LPM_MANAGER_H_
 
+#include "fwk_message.h"
 #include "hal_lpm_dev.h"
 
+/*! @brief Residency statistics and governor parameters of a low power mode */
+typedef struct _lpm_mode_stats
+{
+    uint32_t enterCount;        /* number of times the mode was entered */
+    uint32_t residencyMs;       /* total time spent in the mode */
+    uint32_t lastWakeLatencyUs; /* wake-up to first frame latency of the last exit */
+    uint32_t avgWakeLatencyUs;  /* moving average of the wake-up latency */
+    uint32_t maxWakeLatencyUs;  /* worst wake-up latency seen */
+    uint32_t targetResidencyMs; /* minimum predicted idle time for the governor to pick the mode */
+    uint32_t exitLatencyMs;     /* expected wake-up cost of the mode */
+} lpm_mode_stats_t;
+
+/*! @brief Statistics of a low power mode requester */
+typedef struct _lpm_request_stats
+{
+    char name[LPM_REQUEST_NAME_MAX_LENGTH];
+    int8_t usageCount;   /* current usage count */
+    uint32_t holdCount;  /* number of times the request went from idle to busy */
+    uint32_t holdTimeMs; /* total time the request was busy */
+    uint32_t blockCount; /* number of timer ticks on which the request prevented sleep */
+} lpm_request_stats_t;
+
+/*! @brief Statistics of the low power mode governor */
+typedef struct _lpm_governor_stats
+{
+    uint32_t predictedIdleMs; /* moving average of the idle periods */
+    uint32_t lastIdleMs;      /* length of the last completed idle period */
+    uint32_t idleCount;       /* number of completed idle periods */
+    uint32_t shallowCount;    /* ticks on which sleep was skipped because the predicted idle was too short */
+    hal_lpm_mode_t lastMode;  /* last mode picked by the governor */
+    uint32_t lastPrepareUs;   /* pre-enter notification to last manager ack */
+    uint32_t ackTimeoutCount; /* transitions which hit the pre-enter timeout before all managers acked */
+    uint32_t abortCount;      /* transitions cancelled by a new request before entering sleep */
+} lpm_governor_stats_t;
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -63,6 +99,83 @@ int FWK_LpmManager_SetSleepMode(hal_lpm_mode_t sleepMode);
  */
 int FWK_LpmManager_EnableSleepMode(hal_lpm_manager_status_t enable);
 
+/**
+ * @brief Configure the governor parameters of a low power mode
+ * @param mode low power mode to configure
+ * @param targetResidencyMs minimum predicted idle time to make entering the mode worth it
+ * @param exitLatencyMs expected wake-up cost of the mode, replaced by the measured average once known
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_SetModeParams(hal_lpm_mode_t mode, uint32_t targetResidencyMs, uint32_t exitLatencyMs);
+
+/**
+ * @brief Configure the set of low power modes the governor may pick. FWK_LpmManager_SetSleepMode resets it to its mode.
+ * @param modes bitmask of (1 << hal_lpm_mode_t), only modes supported by the lpm device must be set
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_SetAllowedModes(uint32_t modes);
+
+/**
+ * @brief Configure the maximum wake-up latency the governor may trade for lower power
+ * @param maxWakeLatencyMs modes with a higher exit latency are never picked, 0 for no limit
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_SetWakeLatencyLimit(uint32_t maxWakeLatencyMs);
+
+/**
+ * @brief Notify the low power manager that the board left the current sleep mode. Ends the residency accounting.
+ * Called implicitly by the first RuntimeGet or EnableSleepMode after entering sleep.
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_WakeUp(void);
+
+/**
+ * @brief Notify the low power manager that the board is fully operational again.
+ * Called by the camera manager when it sends the first frame to the display after a wake up.
+ * Records the wake-up latency of the last sleep mode.
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_WakeUpComplete(void);
+
+/**
+ * @brief Declare a manager task which acknowledges kFWKMessageID_LpmPreEnterSleep with FWK_LpmManager_Ack.
+ * Called by the manager when it starts. Tasks which did not register are notified but not waited for.
+ * @param taskId task of the manager
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_RegisterSleepAck(fwk_task_id_t taskId);
+
+/**
+ * @brief Acknowledge kFWKMessageID_LpmPreEnterSleep. Called by a registered manager once it released its devices.
+ * Sleep is entered as soon as every registered manager acknowledged, the pre-enter timer is only kept as a timeout.
+ * @param taskId task which handled the message
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_Ack(fwk_task_id_t taskId);
+
+/**
+ * @brief Get the residency statistics of a low power mode
+ * @param mode low power mode
+ * @param stats pointer to the statistics to fill
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_GetModeStats(hal_lpm_mode_t mode, lpm_mode_stats_t *stats);
+
+/**
+ * @brief Get the statistics of a registered requester
+ * @param index position of the requester in the request list
+ * @param stats pointer to the statistics to fill
+ * @return int Return 0 if successful, error if index is out of range
+ */
+int FWK_LpmManager_GetRequestStats(unsigned int index, lpm_request_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the governor
+ * @param stats pointer to the statistics to fill
+ * @return int Return 0 if successful
+ */
+int FWK_LpmManager_GetGovernorStats(lpm_governor_stats_t *stats);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -61,6 +61,9 @@ typedef enum _fwk_message_id
     kFWKMessageID_Raw,
     /* audio streams dump message AFE triggering */
     kFWKMessageID_AudioDump,
+    /* audio input channel has DMA buffers ready, sent once until the audio task drains the ring of the channel.
+     * Appended to keep the IDs shared with the other core */
+    kFWKMessageID_InputAudioChannel,
     kFWKMessageID_Invalid,
 
 } fwk_message_id_t;
@@ -86,6 +89,8 @@ typedef struct
     pixel_format_t format;
     /* the source pixel format of the requested frame */
     pixel_format_t srcFormat;
+    /* time in us at which the frame was filled, set in the responses */
+    uint32_t timestampUs;
 } frame_msg_payload_t;
 
 /*! @brief Structure of a graphics message */
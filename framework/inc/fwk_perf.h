@@ -25,6 +25,16 @@ typedef enum _fwk_fps_type
     kFWKFPSType_Count
 } fwk_fps_type_t;
 
+/* The frame events counted per device */
+typedef enum _fwk_frame_event
+{
+    /* a frame produced for the device was never used */
+    kFWKFrameEvent_Dropped = 0,
+    /* a frame was used later than it could have been */
+    kFWKFrameEvent_Late = 1,
+    kFWKFrameEvent_Count
+} fwk_frame_event_t;
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -38,10 +48,18 @@ float fwk_fps_reset(fwk_fps_type_t type, int id);
 
 /* get the current fps of the device */
 float fwk_get_fps(fwk_fps_type_t type, int id);
+
+/* count a frame event of the device, can be called from an interrupt */
+void fwk_frame_event(fwk_fps_type_t type, int id, fwk_frame_event_t event);
+
+/* get the number of frame events of the device */
+unsigned int fwk_get_frame_events(fwk_fps_type_t type, int id, fwk_frame_event_t event);
 #else
 #define fwk_fps(x, y)
 #define fwk_fps_reset(x, y)
 #define fwk_get_fps(x, y)
+#define fwk_frame_event(x, y, z)
+#define fwk_get_frame_events(x, y, z) (0)
 #endif
 
 #if defined(__cplusplus)
@@ -23,24 +23,78 @@ extern "C" {
 
 #define TIMER_NAME_LENGTH 32
 
+/* Number of preallocated timer slots, FWK_Timer_Start fails once all of them are in use */
+#ifndef FWK_TIMER_MAX_COUNT
+#define FWK_TIMER_MAX_COUNT 24
+#endif /* FWK_TIMER_MAX_COUNT */
+
+/* The wheel has FWK_TIMER_WHEEL_LEVELS levels of 2^FWK_TIMER_WHEEL_BITS slots, one slot of level 0 is one tick */
+#ifndef FWK_TIMER_WHEEL_BITS
+#define FWK_TIMER_WHEEL_BITS 5
+#endif /* FWK_TIMER_WHEEL_BITS */
+
+#ifndef FWK_TIMER_WHEEL_LEVELS
+#define FWK_TIMER_WHEEL_LEVELS 4
+#endif /* FWK_TIMER_WHEEL_LEVELS */
+
+#ifndef FWK_TIMER_TASK_PRIORITY
+#define FWK_TIMER_TASK_PRIORITY configTIMER_TASK_PRIORITY
+#endif /* FWK_TIMER_TASK_PRIORITY */
+
+#ifndef FWK_TIMER_TASK_STACK_SIZE
+#define FWK_TIMER_TASK_STACK_SIZE configTIMER_TASK_STACK_DEPTH
+#endif /* FWK_TIMER_TASK_STACK_SIZE */
+
 typedef void (*fwk_timer_callback_t)(void *arg);
 
+typedef struct _fwk_timer_node
+{
+    struct _fwk_timer_node *next;
+    struct _fwk_timer_node *prev;
+} fwk_timer_node_t;
+
 typedef struct _fwk_timer
 {
-    TimerHandle_t handle;
+    fwk_timer_node_t node;     /* link in a wheel slot or in the free list, must stay first */
+    struct _fwk_timer **owner; /* handle pointer cleared when the timer is stopped */
     fwk_timer_callback_t function;
-    SemaphoreHandle_t lock;
-    char name[TIMER_NAME_LENGTH];
     void *arg;
+    uint32_t period; /* in ticks */
+    uint32_t expiry; /* absolute tick */
+    uint8_t state;
+    char name[TIMER_NAME_LENGTH];
     int autoReload;
 } fwk_timer_t;
 
+/*! @brief Statistics of the timer service */
+typedef struct _fwk_timer_stats
+{
+    uint32_t activeCount;   /* timers currently started */
+    uint32_t peakCount;     /* highest number of timers started at the same time */
+    uint32_t startCount;    /* successful FWK_Timer_Start calls */
+    uint32_t expireCount;   /* callbacks dispatched */
+    uint32_t failCount;     /* FWK_Timer_Start calls which found no free slot */
+    uint32_t maxLateTicks;  /* worst delay between the expiry and the dispatch of a callback */
+    uint32_t maxCallbackUs; /* longest callback */
+} fwk_timer_stats_t;
+
+/*! @brief Snapshot of an active timer */
+typedef struct _fwk_timer_info
+{
+    char name[TIMER_NAME_LENGTH];
+    uint32_t remainingTicks;
+    uint32_t periodTicks;
+    int autoReload;
+} fwk_timer_info_t;
+
 /**
  * int FWK_Timer_Start(const char* name, int ms, int autoReload, fwk_timer_callback_t func, void* arg, fwk_timer_t**
  * pPTimer);
- * creates and starts a one time timer. It will malloc memory for the handle(fwk_timer_t*) of
- * the timer inside this function. When the timer expires, it will free memory automatically after
- * callback function. If the timer still active and want to stop it, please call FWK_Timer_Stop
+ * creates and starts a timer. The handle(fwk_timer_t*) is taken from a pool of FWK_TIMER_MAX_COUNT
+ * preallocated slots, no memory is allocated. When a one time timer expires, the slot is released
+ * automatically after the callback function and the handle is cleared. If the timer still active and
+ * want to stop it, please call FWK_Timer_Stop.
+ * All the callbacks are called from a single timer service task.
  * @param[in] name A readable text name that is assigned to the timer. This is done to assist debugging.
  * @param[in] ms The period(millisecond) of the timer
  * @param[in] autoReload The auto reload flag of the timer
@@ -66,7 +120,7 @@ int FWK_Timer_Reset(fwk_timer_t **pPTimer);
 /**
  * int FWK_Timer_Stop(fwk_timer_t* timer);
  * stop and delete a timer that was previously created using the FWK_Timer_Start() API function
- * Inside this function, it will free the memory allocated in FWK_Timer_Start()
+ * Inside this function, it will release the slot taken in FWK_Timer_Start() and clear the handle
  * @param timer The address pointer records the pointer of the timer struct
  * @return 0 express success, -1 express fail
  */
@@ -79,6 +133,21 @@ int FWK_Timer_Stop(fwk_timer_t **pPTimer);
  */
 uint32_t FWK_Timer_GetRemainingTime(fwk_timer_t **pPTimer);
 
+/**
+ * @brief get the statistics of the timer service
+ * @param stats pointer to the statistics to fill
+ * @return 0 express success, -1 express fail
+ */
+int FWK_Timer_GetStats(fwk_timer_stats_t *stats);
+
+/**
+ * @brief get a snapshot of the active timers
+ * @param info array to fill
+ * @param count number of elements in info
+ * @return number of active timers copied into info
+ */
+int FWK_Timer_GetActive(fwk_timer_info_t *info, int count);
+
 #if defined(__cplusplus)
 }
 #endif
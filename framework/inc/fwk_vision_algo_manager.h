@@ -20,6 +20,18 @@
 extern "C" {
 #endif
 
+/*! @brief Frame ring statistics of a vision algorithm device */
+typedef struct _vision_algo_frame_stats
+{
+    uint32_t depth;     /* frame slots in use, 1 when the device runs on a single buffer */
+    uint32_t runCount;  /* frames processed by run */
+    uint32_t dropCount; /* ready frames dropped for a newer one */
+    uint32_t startUs;   /* start time of the first run, for the frame rate */
+    uint32_t lastRunUs; /* duration of the last run */
+    uint32_t lastAgeUs; /* time between the fill of the last frame and the start of its run */
+    uint32_t maxAgeUs;  /* highest frame age */
+} vision_algo_frame_stats_t;
+
 /**
  * @brief Init internal structures for VisionAlgo manager.
  * @return int Return 0 if the init process was successful
@@ -46,6 +58,14 @@ int FWK_VisionAlgoManager_Start(int taskPriority);
  */
 int FWK_VisionAlgoManager_Deinit();
 
+/**
+ * @brief Get the frame ring statistics of a vision algorithm device
+ * @param devId id of the device assigned during the registration
+ * @param stats pointer to the statistics to fill
+ * @return int Return 0 if the device exists
+ */
+int FWK_VisionAlgoManager_GetFrameStats(int devId, vision_algo_frame_stats_t *stats);
+
 #if defined(__cplusplus)
 }
 #endif
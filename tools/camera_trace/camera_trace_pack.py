@@ -0,0 +1,82 @@
+#! /usr/bin/env python3
+'''
+Copyright 2022 NXP.
+This software is owned or controlled by NXP and may only be used strictly in accordance with the
+license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+activating and/or otherwise using the software, you are agreeing that you have read, and that you
+agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+applicable license terms, then you may not retain, install, activate or otherwise use the software.
+'''
+
+# Pack raw camera frames into a camera trace file replayed by the 2d_trace camera device.
+#
+# The layout is camera_trace_header_t followed by one camera_trace_record_t plus the frame data per frame, see
+# framework/hal_api/hal_camera_dev.h. The rotation, flip and byte swap are the ones of the camera the frames were
+# captured with, the camera manager applies them as it does for the live camera.
+#
+# Usage:
+#   camera_trace_pack.py -o camera.trc -W 640 -H 480 -f UYVY1P422_RGB --fps 30 --rotate 90 frame000.raw frame001.raw ...
+
+import argparse
+import struct
+import sys
+
+CAMERA_TRACE_MAGIC = 0x43525443  # "CTRC"
+CAMERA_TRACE_VERSION = 2
+HEADER_FORMAT = '<IHHHHHBBIB3x'
+RECORD_FORMAT = '<II'
+
+# pixel_format_t of framework/inc/fwk_common.h, in order, with the bytes per pixel of the raw camera formats
+PIXEL_FORMATS = [
+    ('RGB', 3), ('RGB565', 2), ('BGR', 3), ('Gray888', 3), ('Gray888X', 4), ('Gray', 1), ('Gray16', 2),
+    ('YUV1P444_RGB', 3), ('YUV1P444_Gray', 3), ('UYVY1P422_RGB', 2), ('UYVY1P422_Gray', 2), ('VYUY1P422', 2),
+    ('Depth16', 2), ('Depth8', 1),
+]
+
+ROTATIONS = {0: 0, 90: 1, 180: 2, 270: 3}
+FLIPS = {'none': 0, 'horizontal': 1, 'vertical': 2, 'both': 3}
+
+# CAMERA_MAX_FRAME_SIZE of the 2d_trace camera device
+MAX_FRAME_SIZE = 640 * 480 * 2
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pack raw camera frames into a camera trace file')
+    parser.add_argument('-o', '--output', required=True, help='trace file to write')
+    parser.add_argument('-W', '--width', type=int, required=True, help='frame width in pixels')
+    parser.add_argument('-H', '--height', type=int, required=True, help='frame height in pixels')
+    parser.add_argument('-f', '--format', required=True, choices=[name for name, _ in PIXEL_FORMATS],
+                        help='pixel format of the frames')
+    parser.add_argument('-p', '--pitch', type=int, help='bytes per line, width * bytes per pixel by default')
+    parser.add_argument('--fps', type=float, default=30.0, help='capture rate of the frames')
+    parser.add_argument('--rotate', type=int, default=0, choices=sorted(ROTATIONS), help='clockwise rotation')
+    parser.add_argument('--flip', default='none', choices=sorted(FLIPS), help='flip mode')
+    parser.add_argument('--swap-byte', action='store_true', help='swap the bytes of each 16 bit word')
+    parser.add_argument('frames', nargs='+', help='raw frame files, in capture order')
+    args = parser.parse_args()
+
+    format_id = [name for name, _ in PIXEL_FORMATS].index(args.format)
+    pitch = args.pitch if args.pitch else args.width * PIXEL_FORMATS[format_id][1]
+    frame_size = pitch * args.height
+    if frame_size > MAX_FRAME_SIZE:
+        sys.exit('ERROR: %d bytes frames, the 2d_trace camera takes up to %d' % (frame_size, MAX_FRAME_SIZE))
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    header = struct.pack(HEADER_FORMAT, CAMERA_TRACE_MAGIC, CAMERA_TRACE_VERSION, header_size, args.width,
+                         args.height, pitch, ROTATIONS[args.rotate], FLIPS[args.flip], frame_size, int(args.swap_byte))
+
+    with open(args.output, 'wb') as out:
+        out.write(header)
+        for index, path in enumerate(args.frames):
+            with open(path, 'rb') as f:
+                data = f.read()
+            if len(data) != frame_size:
+                sys.exit('ERROR: %s has %d bytes, expected %d' % (path, len(data), frame_size))
+            out.write(struct.pack(RECORD_FORMAT, int(index * 1000000 / args.fps), format_id))
+            out.write(data)
+
+    print('%s: %d frames of %dx%d %s' % (args.output, len(args.frames), args.width, args.height, args.format))
+
+
+if __name__ == '__main__':
+    main()
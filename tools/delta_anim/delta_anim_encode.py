@@ -0,0 +1,151 @@
+#! /usr/bin/env python3
+'''
+Copyright 2022 NXP.
+This software is owned or controlled by NXP and may only be used strictly in accordance with the
+license terms that accompany it. By expressly accepting such terms or by downloading, installing,
+activating and/or otherwise using the software, you are agreeing that you have read, and that you
+agree to comply with and are bound by, such license terms. If you do not agree to be bound by the
+applicable license terms, then you may not retain, install, activate or otherwise use the software.
+'''
+
+# Encode a GUI-Guider animation frame sequence into a keyframe plus per frame dirty tile deltas.
+#
+# The output is an image source file in the GUI-Guider format, so the resource build tool packs it into the
+# resource binary like any other image. The application shows the first frame of the sequence as keyframe and
+# applies the deltas from flash, see coffee_machine/cm4/custom/custom_delta_anim.h for the stream layout.
+#
+# Usage:
+#   delta_anim_encode.py -o brewing_animimg_brewing_delta.c brewing_animimg_brewingf01.c brewing_animimg_brewingf03.c ...
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+DELTA_ANIM_MAGIC = 0x4D4E4144  # "DANM"
+DELTA_ANIM_VERSION = 1
+DEFAULT_TILE_SIZE = 10
+
+SWAP_BLOCKS = ['LV_COLOR_16_SWAP == 0', 'LV_COLOR_16_SWAP != 0']
+BYTES_PER_LINE = 25
+
+
+def parse_image(path):
+    ''' Return the width, height and the pixels of both color swap variants of a GUI-Guider image file '''
+    with open(path, 'r') as f:
+        text = f.read()
+
+    width = re.search(r'\.header\.w\s*=\s*(\d+)', text)
+    height = re.search(r'\.header\.h\s*=\s*(\d+)', text)
+    if (width is None) or (height is None):
+        sys.exit('ERROR: no image size in %s' % path)
+
+    blocks = []
+    for swap in SWAP_BLOCKS:
+        match = re.search(r'#if LV_COLOR_DEPTH == 16 && ' + re.escape(swap) + r'(.*?)#endif', text, re.S)
+        if match is None:
+            sys.exit('ERROR: no "%s" pixels in %s' % (swap, path))
+        body = re.sub(r'/\*.*?\*/', '', match.group(1), flags=re.S)
+        blocks.append(bytes(int(value, 16) for value in re.findall(r'0x([0-9a-fA-F]{2})', body)))
+
+    return int(width.group(1)), int(height.group(1)), blocks
+
+
+def tile_rows(width, height, tile_size, px_size, tile):
+    ''' Yield the offset and length of each row of a tile in a frame '''
+    tiles_x = (width + tile_size - 1) // tile_size
+    x1 = (tile % tiles_x) * tile_size
+    y1 = (tile // tiles_x) * tile_size
+    x2 = min(x1 + tile_size, width)
+    y2 = min(y1 + tile_size, height)
+
+    for y in range(y1, y2):
+        yield (y * width + x1) * px_size, (x2 - x1) * px_size
+
+
+def align4(data):
+    return data + bytes((4 - len(data) % 4) % 4)
+
+
+def encode(frames, width, height, tile_size, px_size):
+    ''' Encode one color swap variant, frames[i] turns frame i-1 into frame i and frames[0] closes the loop '''
+    tiles_x = (width + tile_size - 1) // tile_size
+    tiles_y = (height + tile_size - 1) // tile_size
+    count = len(frames)
+    records = []
+
+    for i in range(count):
+        prev = frames[(i + count - 1) % count]
+        cur = frames[i]
+        dirty = []
+        pixels = bytearray()
+
+        for tile in range(tiles_x * tiles_y):
+            rows = list(tile_rows(width, height, tile_size, px_size, tile))
+            if any(prev[offset:offset + length] != cur[offset:offset + length] for offset, length in rows):
+                dirty.append(tile)
+                for offset, length in rows:
+                    pixels += cur[offset:offset + length]
+
+        record = struct.pack('<H', len(dirty)) + struct.pack('<%dH' % len(dirty), *dirty)
+        records.append(align4(align4(record) + bytes(pixels)))
+
+    header = struct.pack('<IHHHHHBB', DELTA_ANIM_MAGIC, DELTA_ANIM_VERSION, count, width, height, tile_size,
+                         px_size, 0)
+    offset = len(header) + 4 * count
+    offsets = []
+    for record in records:
+        offsets.append(offset)
+        offset += len(record)
+
+    return header + struct.pack('<%dI' % count, *offsets) + b''.join(records)
+
+
+def write_source(path, name, streams):
+    with open(path, 'w') as f:
+        f.write('/*\n * Copyright 2022 NXP\n * SPDX-License-Identifier: MIT\n */\n\n')
+        f.write('/* Generated by tools/delta_anim/delta_anim_encode.py, do not edit */\n\n')
+        f.write('#include "lvgl/lvgl.h"\n\n')
+        f.write('#ifndef LV_ATTRIBUTE_MEM_ALIGN\n#define LV_ATTRIBUTE_MEM_ALIGN\n#endif\n\n')
+        f.write('const LV_ATTRIBUTE_MEM_ALIGN uint8_t %s_map[] = {\n' % name)
+        for swap, stream in zip(SWAP_BLOCKS, streams):
+            f.write('#if LV_COLOR_DEPTH == 16 && %s\n' % swap)
+            for i in range(0, len(stream), BYTES_PER_LINE):
+                f.write('  ' + ', '.join('0x%02x' % value for value in stream[i:i + BYTES_PER_LINE]) + ',\n')
+            f.write('#endif\n')
+        f.write('};\n\n')
+        f.write('const lv_img_dsc_t %s = {\n' % name)
+        f.write('  .header.always_zero = 0,\n  .header.w = 0,\n  .header.h = 0,\n')
+        f.write('  .data_size = %d,\n' % len(streams[0]))
+        f.write('  .header.cf = LV_IMG_CF_RAW,\n')
+        f.write('  .data = %s_map,\n};\n' % name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Encode an animation into a keyframe plus dirty tile deltas')
+    parser.add_argument('-o', '--output', required=True, help='image source file to write')
+    parser.add_argument('-t', '--tile-size', type=int, default=DEFAULT_TILE_SIZE, help='tile edge length in pixels')
+    parser.add_argument('frames', nargs='+', help='GUI-Guider image source files, the first one is the keyframe')
+    args = parser.parse_args()
+
+    images = [parse_image(path) for path in args.frames]
+    width, height, _ = images[0]
+    px_size = len(images[0][2][0]) // (width * height)
+
+    for path, (w, h, blocks) in zip(args.frames, images):
+        if (w, h) != (width, height) or any(len(block) != width * height * px_size for block in blocks):
+            sys.exit('ERROR: %s does not match the keyframe' % path)
+
+    streams = [encode([blocks[variant] for _, _, blocks in images], width, height, args.tile_size, px_size)
+               for variant in range(len(SWAP_BLOCKS))]
+
+    name = os.path.splitext(os.path.basename(args.output))[0]
+    write_source(args.output, name, streams)
+
+    print('%s: %d frames, %d bytes of deltas vs %d bytes of frames' %
+          (name, len(images), len(streams[0]), len(images) * width * height * px_size))
+
+
+if __name__ == '__main__':
+    main()